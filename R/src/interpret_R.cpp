@@ -753,6 +753,7 @@ SEXP CreateBooster_R(
       AccelerationFlags_ALL,
       "log_loss",
       nullptr,
+      0,
       &boosterHandle
    );
    if(Error_None != err || nullptr == boosterHandle) {
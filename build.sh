@@ -198,6 +198,34 @@ copy_asm_files() {
    fi
 }
 
+build_benchmark() {
+   l8_compiler="$1"
+   l8_compiler_args_sanitized="$2"
+   l8_lib_file="$3"
+   l8_obj_path_unsanitized="$4"
+   l8_bin_path_unsanitized="$5"
+   l8_bin_file="$6"
+   l8_benchmark="$7"
+
+   if [ $l8_benchmark -ne 0 ]; then 
+      printf "%s\n" "Compiling $l8_bin_file with $l8_compiler"
+      l8_lib_file_body="${l8_lib_file%.*}"
+      l8_lib_file_body="${l8_lib_file_body#lib}"
+      l8_staging_path_sanitized=`sanitize "$staging_path_unsanitized"`
+      g_log_file_unsanitized="$l8_obj_path_unsanitized/${l8_bin_file}_build_log.txt"
+
+      g_all_object_files_sanitized=""
+      g_compile_out_full=""
+
+      make_paths "$l8_obj_path_unsanitized" "$l8_bin_path_unsanitized"
+      compile_directory "$l8_compiler" "$l8_compiler_args_sanitized" "$src_path_unsanitized/benchmarks" "$l8_obj_path_unsanitized" 0
+      link_file "$l8_compiler" "-l$l8_lib_file_body -L$l8_staging_path_sanitized $benchmark_link_args $l8_compiler_args_sanitized" "$l8_bin_path_unsanitized" "$l8_bin_file"
+      printf "%s\n" "$g_compile_out_full"
+      printf "%s\n" "$g_compile_out_full" > "$g_log_file_unsanitized"
+      copy_bin_files "$l8_bin_path_unsanitized" "$l8_bin_file" "$staging_path_unsanitized"
+   fi
+}
+
 
 g_is_updated=0
 
@@ -213,6 +241,7 @@ release_arm=0
 debug_arm=0
 
 is_asm=0
+is_benchmark=0
 is_extra_debugging=0
 asan=""
 
@@ -250,6 +279,10 @@ for arg in "$@"; do
       is_asm=1
    fi
 
+   if [ "$arg" = "-benchmark" ]; then
+      is_benchmark=1
+   fi
+
    if [ "$arg" = "-extra_debugging" ]; then
       is_extra_debugging=1
    fi
@@ -328,13 +361,17 @@ if [ $is_conda -eq 1 ]; then
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/CutUniform.cpp" -o "$tmp_path/CutUniform.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/CutWinsorized.cpp" -o "$tmp_path/CutWinsorized.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/dataset_shared.cpp" -o "$tmp_path/dataset_shared.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/model_shared.cpp" -o "$tmp_path/model_shared.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/DataSetBoosting.cpp" -o "$tmp_path/DataSetBoosting.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/DataSetInteraction.cpp" -o "$tmp_path/DataSetInteraction.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/DetermineLinkFunction.cpp" -o "$tmp_path/DetermineLinkFunction.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/debug_ebm.cpp" -o "$tmp_path/debug_ebm.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/Discretize.cpp" -o "$tmp_path/Discretize.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/float_string.cpp" -o "$tmp_path/float_string.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/Term.cpp" -o "$tmp_path/Term.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/GenerateTermUpdate.cpp" -o "$tmp_path/GenerateTermUpdate.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/GradientSampling.cpp" -o "$tmp_path/GradientSampling.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/HarmonizeTensor.cpp" -o "$tmp_path/HarmonizeTensor.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/InitializeGradientsAndHessians.cpp" -o "$tmp_path/InitializeGradientsAndHessians.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/InteractionCore.cpp" -o "$tmp_path/InteractionCore.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/InteractionShell.cpp" -o "$tmp_path/InteractionShell.o"
@@ -347,10 +384,13 @@ if [ $is_conda -eq 1 ]; then
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/RandomDeterministic.cpp" -o "$tmp_path/RandomDeterministic.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/random.cpp" -o "$tmp_path/random.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/sampling.cpp" -o "$tmp_path/sampling.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/ScratchArena.cpp" -o "$tmp_path/ScratchArena.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/InnerBag.cpp" -o "$tmp_path/InnerBag.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/Tensor.cpp" -o "$tmp_path/Tensor.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/TensorTotalsBuild.cpp" -o "$tmp_path/TensorTotalsBuild.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/TermInnerBag.cpp" -o "$tmp_path/TermInnerBag.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/ThreadPool.cpp" -o "$tmp_path/ThreadPool.o"
+   ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/Timeline.cpp" -o "$tmp_path/Timeline.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/unzoned/logging.cpp" -o "$tmp_path/logging.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/unzoned/unzoned.cpp" -o "$tmp_path/unzoned.o"
    ${CXX} -c ${CPPFLAGS} ${CXXFLAGS} ${extras} "$code_path/compute/cpu_ebm/cpu_64.cpp" -o "$tmp_path/cpu_64.o"
@@ -366,13 +406,17 @@ if [ $is_conda -eq 1 ]; then
    "$tmp_path/CutUniform.o" \
    "$tmp_path/CutWinsorized.o" \
    "$tmp_path/dataset_shared.o" \
+   "$tmp_path/model_shared.o" \
    "$tmp_path/DataSetBoosting.o" \
    "$tmp_path/DataSetInteraction.o" \
    "$tmp_path/DetermineLinkFunction.o" \
    "$tmp_path/debug_ebm.o" \
    "$tmp_path/Discretize.o" \
+   "$tmp_path/float_string.o" \
    "$tmp_path/Term.o" \
    "$tmp_path/GenerateTermUpdate.o" \
+   "$tmp_path/GradientSampling.o" \
+   "$tmp_path/HarmonizeTensor.o" \
    "$tmp_path/InitializeGradientsAndHessians.o" \
    "$tmp_path/InteractionCore.o" \
    "$tmp_path/InteractionShell.o" \
@@ -385,10 +429,13 @@ if [ $is_conda -eq 1 ]; then
    "$tmp_path/RandomDeterministic.o" \
    "$tmp_path/random.o" \
    "$tmp_path/sampling.o" \
+   "$tmp_path/ScratchArena.o" \
    "$tmp_path/InnerBag.o" \
    "$tmp_path/Tensor.o" \
    "$tmp_path/TensorTotalsBuild.o" \
    "$tmp_path/TermInnerBag.o" \
+   "$tmp_path/ThreadPool.o" \
+   "$tmp_path/Timeline.o" \
    "$tmp_path/logging.o" \
    "$tmp_path/unzoned.o" \
    "$tmp_path/cpu_64.o" \
@@ -442,7 +489,19 @@ main_args="$main_args -I$src_path_sanitized/unzoned"
 main_args="$main_args -I$src_path_sanitized/bridge"
 main_args="$main_args -I$src_path_sanitized"
 
+# the benchmark links to libebm like any other consumer, so it gets none of the export or wrap flags
+benchmark_args="-std=c++11"
+benchmark_args="$benchmark_args -Wall -Wextra"
+benchmark_args="$benchmark_args -Wold-style-cast"
+benchmark_args="$benchmark_args -Wshadow"
+benchmark_args="$benchmark_args -Wformat=2"
+benchmark_args="$benchmark_args -Wno-format-nonliteral"
+benchmark_args="$benchmark_args -pthread"
+benchmark_args="$benchmark_args -DNDEBUG -O3"
+benchmark_args="$benchmark_args -I$src_path_sanitized/inc"
+
 link_args=""
+benchmark_link_args=""
 
 os_type=`uname`
 
@@ -461,6 +520,10 @@ if [ "$os_type" = "Linux" ]; then
    link_args="$link_args -static-libstdc++"
    link_args="$link_args -shared"
 
+   benchmark_link_args="$benchmark_link_args -Wl,-rpath,'\$ORIGIN/'"
+   benchmark_link_args="$benchmark_link_args -static-libgcc"
+   benchmark_link_args="$benchmark_link_args -static-libstdc++"
+
    printf "%s\n" "Creating initial directories"
    [ -d "$staging_path_unsanitized" ] || mkdir -p "$staging_path_unsanitized"
    ret_code=$?
@@ -491,6 +554,7 @@ if [ "$os_type" = "Linux" ]; then
       printf "%s\n" "$g_compile_out_full" > "$g_log_file_unsanitized"
       copy_bin_files "$bin_path_unsanitized" "$bin_file" "$staging_path_unsanitized"
       copy_asm_files "$obj_path_unsanitized" "$bld_path_unsanitized" "$staging_path_unsanitized/$bin_file" "linux_default_release" "$is_asm"
+      build_benchmark "$cpp_compiler" "$benchmark_args" "$bin_file" "$obj_path_unsanitized/benchmark" "$bin_path_unsanitized" "libebm_benchmark" "$is_benchmark"
    fi
 
    if [ $release_64 -eq 1 ]; then
@@ -518,6 +582,7 @@ if [ "$os_type" = "Linux" ]; then
       printf "%s\n" "$g_compile_out_full" > "$g_log_file_unsanitized"
       copy_bin_files "$bin_path_unsanitized" "$bin_file" "$staging_path_unsanitized"
       copy_asm_files "$obj_path_unsanitized" "$bld_path_unsanitized" "$staging_path_unsanitized/$bin_file" "linux_64_release" "$is_asm"
+      build_benchmark "$cpp_compiler" "$benchmark_args -m64" "$bin_file" "$obj_path_unsanitized/benchmark" "$bin_path_unsanitized" "libebm_linux_x64_benchmark" "$is_benchmark"
    fi
 
    if [ $debug_64 -eq 1 ]; then
@@ -611,6 +676,8 @@ elif [ "$os_type" = "Darwin" ]; then
 
    link_args="$link_args -dynamiclib"
 
+   benchmark_link_args="$benchmark_link_args -Wl,-rpath,@loader_path"
+
    printf "%s\n" "Creating initial directories"
    [ -d "$staging_path_unsanitized" ] || mkdir -p "$staging_path_unsanitized"
    ret_code=$?
@@ -640,6 +707,7 @@ elif [ "$os_type" = "Darwin" ]; then
       printf "%s\n" "$g_compile_out_full" > "$g_log_file_unsanitized"
       copy_bin_files "$bin_path_unsanitized" "$bin_file" "$staging_path_unsanitized"
       copy_asm_files "$obj_path_unsanitized" "$bld_path_unsanitized" "$staging_path_unsanitized/$bin_file" "mac_64_release" "$is_asm"
+      build_benchmark "$cpp_compiler" "$benchmark_args" "$bin_file" "$obj_path_unsanitized/benchmark" "$bin_path_unsanitized" "libebm_benchmark" "$is_benchmark"
    fi
 
    if [ $release_64 -eq 1 ]; then
@@ -666,6 +734,7 @@ elif [ "$os_type" = "Darwin" ]; then
       printf "%s\n" "$g_compile_out_full" > "$g_log_file_unsanitized"
       copy_bin_files "$bin_path_unsanitized" "$bin_file" "$staging_path_unsanitized"
       copy_asm_files "$obj_path_unsanitized" "$bld_path_unsanitized" "$staging_path_unsanitized/$bin_file" "mac_64_release" "$is_asm"
+      build_benchmark "$cpp_compiler" "$benchmark_args -target x86_64-apple-macos10.12 -m64" "$bin_file" "$obj_path_unsanitized/benchmark" "$bin_path_unsanitized" "libebm_mac_x64_benchmark" "$is_benchmark"
    fi
 
    if [ $debug_64 -eq 1 ]; then
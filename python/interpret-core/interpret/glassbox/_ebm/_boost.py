@@ -42,6 +42,11 @@ def boost(
     experimental_params=None,
 ):
     try:
+        if isinstance(dataset, str):
+            # a path written by Native.write_dataset_file, which lets workers share one mapped copy
+            dataset = Native.get_native_singleton().map_dataset_file(dataset)
+            create_booster_flags |= Native.CreateBoosterFlags_CheckedDataSet
+
         step_idx = 0
         with Booster(
             dataset,
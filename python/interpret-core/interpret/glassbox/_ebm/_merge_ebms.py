@@ -21,7 +21,7 @@ from ._utils import (
 _log = logging.getLogger(__name__)
 
 
-def _harmonize_tensor(
+def _harmonize_projection(
     new_feature_idxs,
     new_bounds,
     new_bins,
@@ -29,9 +29,11 @@ def _harmonize_tensor(
     old_bounds,
     old_bins,
     old_mapping,
-    old_tensor,
-    bin_evidence_weight,
 ):
+    # Works out, one axis at a time, which old bins each new bin draws from and what
+    # fraction of the old bin's weight it covers.  The tensors themselves are
+    # expanded in native code by _harmonize_tensors, which is the part that grows
+    # with the product of the bin counts.
     # TODO: don't pass in new_bound and old_bounds.  We use the bounds to proportion
     # weights at the tail ends of the graphs, but the problem with that is that
     # you can have outliers that'll stretch the weight very thin.  If you have an
@@ -67,17 +69,6 @@ def _harmonize_tensor(
         old_feature_idxs[old_idx] = -1  # in case we have duplicate feature idxs
         axes.append(old_idx)
 
-    if bin_evidence_weight is not None:
-        bin_evidence_weight = bin_evidence_weight.transpose(tuple(axes))
-
-    n_multiclasses = 1
-    if len(axes) != old_tensor.ndim:
-        # multiclass. The last dimension always stays put
-        axes.append(len(axes))
-        n_multiclasses = old_tensor.shape[-1]
-
-    old_tensor = old_tensor.transpose(tuple(axes))
-
     mapping = []
     lookups = []
     percentages = []
@@ -214,68 +205,69 @@ def _harmonize_tensor(
         percentages.append(percentage)
 
     new_shape = tuple(len(lookup) for lookup in lookups)
-    n_cells = np.prod(new_shape)
-
-    if n_multiclasses > 1:
-        # for multiclass we need to add another dimension for the scores of each class
-        new_shape += (n_multiclasses,)
-
-    lookups.reverse()
-    percentages.reverse()
-    mapping.reverse()
-
-    # now we need to inflate it
-    intermediate_shape = (n_cells, n_multiclasses) if n_multiclasses > 1 else n_cells
-    new_tensor = np.empty(intermediate_shape, np.float64)
-    for cell_idx in range(n_cells):
-        remainder = cell_idx
-        old_reversed_bin_idxs = []
-        frac = 1.0
-        for lookup, percentage in zip(lookups, percentages):
-            n_bins = len(lookup)
-            new_bin_idx = remainder % n_bins
-            remainder //= n_bins
-            old_reversed_bin_idxs.append(lookup[new_bin_idx])
-            frac *= percentage[new_bin_idx]
-
-        cell_map = [
-            map_bins[bin_idx]
-            for map_bins, bin_idx in zip(mapping, old_reversed_bin_idxs)
-        ]
-        n_cells2 = np.prod([len(x) for x in cell_map])
-        val = 0 if n_multiclasses == 1 else np.zeros(n_multiclasses, np.float64)
-        total_weight = 0.0
-        for cell2_idx in range(n_cells2):
-            remainder2 = cell2_idx
-            old_reversed_bin2_idxs = []
-            for lookup2 in cell_map:
-                n_bins2 = len(lookup2)
-                new_bin2_idx = remainder2 % n_bins2
-                remainder2 //= n_bins2
-                old_reversed_bin2_idxs.append(lookup2[new_bin2_idx])
-            update = old_tensor[tuple(reversed(old_reversed_bin2_idxs))]
-            if n_cells2 == 1:
-                # if there's just one cell, which is typical, don't
-                # incur the floating point loss in precision
-                val = update
-            else:
-                if bin_evidence_weight is not None:
-                    evidence_weight = bin_evidence_weight[
-                        tuple(reversed(old_reversed_bin2_idxs))
-                    ]
-                    update *= evidence_weight
-                    total_weight += evidence_weight
-                val += update
-        if bin_evidence_weight is None:
-            # we're doing a bin weight and NOT a score tensor
-            val *= frac
-        elif total_weight != 0.0:
-            # we're doing scores and we need to take a weighted average
-            # but if the total_weight is zero then val should be zero and
-            # our update should still be zero, which it already is
-            val = val / total_weight
-        new_tensor[cell_idx] = val
-    return new_tensor.reshape(new_shape)
+
+    # flatten the old bins of every new bin, dimension by dimension, into the layout
+    # that HarmonizeTensors expects.  A lookup of -1 means the unknown bin, which is
+    # the last item in the mapping.
+    old_bin_offsets = [0]
+    old_bin_idxs = []
+    for lookup, map_bins in zip(lookups, mapping):
+        for old_idx in lookup:
+            old_bin_idxs.extend(map_bins[old_idx])
+            old_bin_offsets.append(len(old_bin_idxs))
+
+    return (
+        tuple(axes),
+        new_shape,
+        np.array(old_bin_offsets, np.int64),
+        np.array(old_bin_idxs, np.int64),
+        np.array(list(chain.from_iterable(percentages)), np.float64),
+    )
+
+
+def _harmonize_tensors(projections, old_tensors, bin_evidence_weights):
+    # Re-bins each old tensor onto the new grid described by its projection from
+    # _harmonize_projection.  All the projections need to target the same new grid,
+    # which lets native code process the tensors from all the models in parallel.
+    # If bin_evidence_weights is None we are re-binning weights, which get split by
+    # the percentages.  Otherwise we are re-binning scores, and when a new bin covers
+    # more than one old bin its score is the average weighted by the bin weights.
+
+    if len(projections) == 0:
+        return []
+
+    new_shape = projections[0][1]
+    n_scores = 1
+    if len(new_shape) != old_tensors[0].ndim:
+        # multiclass. The last dimension always stays put
+        n_scores = old_tensors[0].shape[-1]
+
+    if bin_evidence_weights is None:
+        bin_evidence_weights = [None] * len(old_tensors)
+
+    transposed_tensors = []
+    transposed_weights = []
+    for (axes, _, _, _, _), old_tensor, bin_evidence_weight in zip(
+        projections, old_tensors, bin_evidence_weights
+    ):
+        tensor_axes = axes if n_scores == 1 else (*axes, len(axes))
+        transposed_tensors.append(
+            np.ascontiguousarray(old_tensor.transpose(tensor_axes), np.float64)
+        )
+        if bin_evidence_weight is not None:
+            bin_evidence_weight = np.ascontiguousarray(
+                bin_evidence_weight.transpose(axes), np.float64
+            )
+        transposed_weights.append(bin_evidence_weight)
+
+    native = Native.get_native_singleton()
+    return native.harmonize_tensors(
+        new_shape,
+        n_scores,
+        [projection[2:] for projection in projections],
+        transposed_tensors,
+        transposed_weights,
+    )
 
 
 def merge_ebms(models):
@@ -664,13 +656,11 @@ def merge_ebms(models):
         # use and then it would make something that is consistent across all of these disparate sources
         # of information.  Hopefully, the user hasn't edited the model in a way that creates no solution.
 
-        bin_weight_percentages = []
-        for model_idx, model, fg_dict, model_weight in zip(
-            count(), models, fg_dicts, model_weights
-        ):
+        projections = {}
+        for model_idx, model, fg_dict in zip(count(), models, fg_dicts):
             term_idx = fg_dict.get(sorted_fg)
             if term_idx is not None:
-                fixed_tensor = _harmonize_tensor(
+                projections[model_idx] = _harmonize_projection(
                     sorted_fg,
                     ebm.feature_bounds_,
                     ebm.bins_,
@@ -678,10 +668,27 @@ def merge_ebms(models):
                     old_bounds[model_idx],
                     old_bins[model_idx],
                     old_mapping[model_idx],
-                    model.bin_weights_[term_idx],
-                    None,
                 )
-                bin_weight_percentages.append(fixed_tensor * model_weight)
+
+        # re-bin the weights of this term from all the models in one native call
+        harmonized_bin_weights = dict(
+            zip(
+                projections.keys(),
+                _harmonize_tensors(
+                    list(projections.values()),
+                    [
+                        models[model_idx].bin_weights_[fg_dicts[model_idx][sorted_fg]]
+                        for model_idx in projections
+                    ],
+                    None,
+                ),
+            )
+        )
+
+        bin_weight_percentages = [
+            harmonized_bin_weights[model_idx] * model_weights[model_idx]
+            for model_idx in projections
+        ]
 
         # use this when we don't have a term in a model as a reasonable
         # set of guesses for the distribution of the weight of the model
@@ -692,50 +699,44 @@ def merge_ebms(models):
         if n_classes > 2:
             additive_shape = (*list(additive_shape), n_classes)
 
+        bag_projections = []
+        bag_tensors = []
+        bag_evidence_weights = []
+        for model_idx, projection in projections.items():
+            model = models[model_idx]
+            term_idx = fg_dicts[model_idx][sorted_fg]
+            n_outer_bags = -1
+            if hasattr(model, "bagged_scores_"):
+                if len(model.bagged_scores_) > 0:
+                    n_outer_bags = len(model.bagged_scores_[0])
+            for bag_idx in range(n_outer_bags):
+                bag_projections.append(projection)
+                bag_tensors.append(model.bagged_scores_[term_idx][bag_idx])
+                # we use these to weigh distribution of scores for mulple bins
+                bag_evidence_weights.append(model.bin_weights_[term_idx])
+
+        # re-bin the bagged scores of this term from all the models in one native call
+        harmonized_bagged_scores = iter(
+            _harmonize_tensors(bag_projections, bag_tensors, bag_evidence_weights)
+        )
+
         new_bin_weights = []
         new_bagged_scores = []
-        for model_idx, model, fg_dict, model_weight in zip(
-            count(), models, fg_dicts, model_weights
-        ):
+        for model_idx, model, model_weight in zip(count(), models, model_weights):
             n_outer_bags = -1
             if hasattr(model, "bagged_scores_"):
                 if len(model.bagged_scores_) > 0:
                     n_outer_bags = len(model.bagged_scores_[0])
 
-            term_idx = fg_dict.get(sorted_fg)
-            if term_idx is None:
+            if model_idx not in projections:
                 new_bin_weights.append(model_weight * bin_weight_percentages)
                 new_bagged_scores.extend(
                     n_outer_bags * [np.zeros(additive_shape, np.float64)]
                 )
             else:
-                harmonized_bin_weights = _harmonize_tensor(
-                    sorted_fg,
-                    ebm.feature_bounds_,
-                    ebm.bins_,
-                    model.term_features_[term_idx],
-                    old_bounds[model_idx],
-                    old_bins[model_idx],
-                    old_mapping[model_idx],
-                    model.bin_weights_[term_idx],
-                    None,
-                )
-                new_bin_weights.append(harmonized_bin_weights)
-                for bag_idx in range(n_outer_bags):
-                    harmonized_bagged_scores = _harmonize_tensor(
-                        sorted_fg,
-                        ebm.feature_bounds_,
-                        ebm.bins_,
-                        model.term_features_[term_idx],
-                        old_bounds[model_idx],
-                        old_bins[model_idx],
-                        old_mapping[model_idx],
-                        model.bagged_scores_[term_idx][bag_idx],
-                        model.bin_weights_[
-                            term_idx
-                        ],  # we use these to weigh distribution of scores for mulple bins
-                    )
-                    new_bagged_scores.append(harmonized_bagged_scores)
+                new_bin_weights.append(harmonized_bin_weights[model_idx])
+                for _ in range(n_outer_bags):
+                    new_bagged_scores.append(next(harmonized_bagged_scores))
         ebm.bin_weights_.append(np.sum(new_bin_weights, axis=0))
         ebm.bagged_scores_.append(np.array(new_bagged_scores, np.float64))
 
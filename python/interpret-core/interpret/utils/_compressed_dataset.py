@@ -60,8 +60,13 @@ def bin_native(
         # y could be a slice that has a stride.  We need contiguous for caling into C
         y = y.copy()
 
-    n_bytes = native.measure_dataset_header(len(requests), n_weights, 1)
-    for (feature_idx, feature_bins), (_, X_col, _, bad) in zip(
+    # read every column once and discretize the continuous columns together in one
+    # native call so that they can be binned in parallel
+    columns = []
+    continuous_idxs = []
+    continuous_cols = []
+    continuous_cuts = []
+    for (_, feature_bins), (_, X_col, _, bad) in zip(
         responses,
         unify_columns(X, requests, feature_names_in, feature_types_in, None, False),
     ):
@@ -74,17 +79,34 @@ def bin_native(
             # X_col could be a slice that has a stride.  We need contiguous for caling into C
             X_col = X_col.copy()
 
+        if not isinstance(feature_bins, dict):
+            # continuous feature
+            continuous_idxs.append(len(columns))
+            continuous_cols.append(X_col)
+            continuous_cuts.append(feature_bins)
+
+        columns.append([X_col, bad])
+
+    if len(continuous_idxs) != 0:
+        bin_indexes = native.discretize_many(continuous_cols, continuous_cuts)
+        for i, X_col in zip(continuous_idxs, bin_indexes):
+            columns[i][0] = X_col
+    del continuous_cols
+
+    n_bins_list = []
+    n_bytes = native.measure_dataset_header(len(requests), n_weights, 1)
+    for (feature_idx, feature_bins), (X_col, bad) in zip(responses, columns):
         if isinstance(feature_bins, dict):
             # categorical feature
             n_bins = 2 if len(feature_bins) == 0 else (max(feature_bins.values()) + 2)
         else:
             # continuous feature
-            X_col = native.discretize(X_col, feature_bins)
             n_bins = len(feature_bins) + 3
 
         if bad is not None:
             X_col[bad != _none_ndarray] = n_bins - 1
 
+        n_bins_list.append(n_bins)
         n_bytes += native.measure_feature(
             n_bins,
             np.count_nonzero(X_col) != len(X_col),
@@ -109,30 +131,7 @@ def bin_native(
 
     native.fill_dataset_header(len(requests), n_weights, 1, dataset)
 
-    for (feature_idx, feature_bins), (_, X_col, _, bad) in zip(
-        responses,
-        unify_columns(X, requests, feature_names_in, feature_types_in, None, False),
-    ):
-        if n_samples != len(X_col):
-            msg = "The columns of X are mismatched in the number of of samples"
-            _log.error(msg)
-            raise ValueError(msg)
-
-        if not X_col.flags.c_contiguous:
-            # X_col could be a slice that has a stride.  We need contiguous for caling into C
-            X_col = X_col.copy()
-
-        if isinstance(feature_bins, dict):
-            # categorical feature
-            n_bins = 2 if len(feature_bins) == 0 else (max(feature_bins.values()) + 2)
-        else:
-            # continuous feature
-            X_col = native.discretize(X_col, feature_bins)
-            n_bins = len(feature_bins) + 3
-
-        if bad is not None:
-            X_col[bad != _none_ndarray] = n_bins - 1
-
+    for (feature_idx, _), (X_col, bad), n_bins in zip(responses, columns, n_bins_list):
         native.fill_feature(
             n_bins,
             np.count_nonzero(X_col) != len(X_col),
@@ -27,6 +27,9 @@ class Native:
     CreateBoosterFlags_Default = 0x00000000
     CreateBoosterFlags_DifferentialPrivacy = 0x00000001
     CreateBoosterFlags_DisableApprox = 0x00000002
+    CreateBoosterFlags_PoissonBags = 0x00000008
+    CreateBoosterFlags_HugePages = 0x00000010
+    CreateBoosterFlags_CheckedDataSet = 0x00000020
 
     # TermBoostFlags
     TermBoostFlags_Default = 0x00000000
@@ -41,6 +44,7 @@ class Native:
     CreateInteractionFlags_Default = 0x00000000
     CreateInteractionFlags_DifferentialPrivacy = 0x00000001
     CreateInteractionFlags_DisableApprox = 0x00000002
+    CreateInteractionFlags_CheckedDataSet = 0x00000008
 
     # CalcInteractionFlags
     CalcInteractionFlags_Default = 0x00000000
@@ -57,12 +61,41 @@ class Native:
     AccelerationFlags_GPU = AccelerationFlags_Nvidia
     AccelerationFlags_ALL = 0xFFFFFFFF
 
+    # ThreadPoolFlags
+    ThreadPoolFlags_Default = 0x00000000
+    ThreadPoolFlags_PinCores = 0x00000001
+    ThreadPoolFlags_SpreadNodes = 0x00000002
+
     # Tasks
     Task_Ranking = -3
     Task_Regression = -2
     Task_Unknown = -1
     # for Task_Classification use the # of classes or 0 if unknown
 
+    # BoosterStats
+    BoosterStat_BinSums = 0
+    BoosterStat_TensorTotals = 1
+    BoosterStat_Partition = 2
+    BoosterStat_ApplyUpdate = 3
+    BoosterStat_Validation = 4
+    BoosterStat_BestModelCopy = 5
+    BoosterStat_COUNT = 6
+
+    BoosterStatZone_cpu_64 = 0
+    BoosterStatZone_avx2 = 1
+    BoosterStatZone_avx512f = 2
+    BoosterStatZone_COUNT = 3
+
+    BoosterStatItem_Calls = 0
+    BoosterStatItem_Nanoseconds = 1
+    BoosterStatItem_Bytes = 2
+    BoosterStatItem_COUNT = 3
+
+    ScratchStat_PeakBytes = 0
+    ScratchStat_ReservedBytes = 1
+    ScratchStat_Blocks = 2
+    ScratchStat_COUNT = 3
+
     # TraceLevel
     _Trace_Off = 0
     _Trace_Error = 1
@@ -73,6 +106,10 @@ class Native:
     _native = None
     # if we supported win32 32-bit functions then this would need to be WINFUNCTYPE
     _LogCallbackType = ct.CFUNCTYPE(None, ct.c_int32, ct.c_char_p)
+    _ParallelTaskType = ct.CFUNCTYPE(ct.c_int32, ct.c_void_p, ct.c_int64)
+    _ParallelForType = ct.CFUNCTYPE(
+        ct.c_int32, ct.c_void_p, ct.c_int64, _ParallelTaskType, ct.c_void_p
+    )
 
     def __init__(self):
         # Do not call "Native()".  Call "Native.get_native_singleton()" instead
@@ -214,6 +251,63 @@ class Native:
 
         self._unsafe.SetTraceLevel(trace_level)
 
+    def start_timeline(self):
+        self._unsafe.StartTimeline()
+
+    def stop_timeline(self):
+        self._unsafe.StopTimeline()
+
+    def get_timeline_json(self):
+        n_bytes = self._unsafe.MeasureTimelineJson()
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureTimelineJson")
+
+        json_buf = ct.create_string_buffer(n_bytes)
+        return_code = self._unsafe.FillTimelineJson(n_bytes, json_buf)
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillTimelineJson")
+
+        return json_buf.value.decode("ascii")
+
+    def set_thread_pool(
+        self, n_threads=0, pin_cores=False, numa_node=-1, spread_nodes=False
+    ):
+        flags = Native.ThreadPoolFlags_Default
+        if pin_cores:
+            flags |= Native.ThreadPoolFlags_PinCores
+        if spread_nodes:
+            flags |= Native.ThreadPoolFlags_SpreadNodes
+        return_code = self._unsafe.SetThreadPool(n_threads, flags, numa_node)
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "SetThreadPool")
+
+    def set_parallel_for(self, executor=None):
+        # executor is a concurrent.futures.Executor that runs the native tasks,
+        # or None to return to the native worker pool
+        if executor is None:
+            # a default constructed ctypes function pointer is null
+            parallel_for_func = self._ParallelForType()
+        else:
+
+            def parallel_for(callback_context, n_tasks, task, task_context):
+                try:
+                    return_codes = executor.map(
+                        lambda i: task(task_context, i), range(n_tasks)
+                    )
+                    return next((code for code in return_codes if code), 0)
+                except Exception:  # pragma: no cover
+                    return -2  # Error_UnexpectedInternal
+
+            parallel_for_func = self._ParallelForType(parallel_for)
+
+        return_code = self._unsafe.SetParallelForCallback(parallel_for_func, None)
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "SetParallelForCallback")
+
+        # it's critical that we keep a reference to the ctypes callback,
+        # otherwise it will be garbage collected while native code uses it
+        self._parallel_for_func = parallel_for_func
+
     def clean_float(self, val):
         # the EBM spec does not allow subnormal floats to be in the model definition, so flush them to zero
         val_array = np.array([val], np.float64)
@@ -347,6 +441,24 @@ class Native:
 
         return random_numbers
 
+    def generate_gaussian_random_parallel(self, rng, stddev, count):
+        # Item i comes from its own counter based stream, so the result is the same
+        # for any thread pool, and rng advances by one draw regardless of count.
+        random_numbers = np.empty(count, dtype=np.float64, order="C")
+        return_code = self._unsafe.GenerateGaussianRandomParallel(
+            Native._make_pointer(rng, np.ubyte, is_null_allowed=True),
+            stddev,
+            count,
+            Native._make_pointer(random_numbers, np.float64),
+        )
+
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(
+                return_code, "GenerateGaussianRandomParallel"
+            )
+
+        return random_numbers
+
     def shuffle(self, rng, vals):
         return_code = self._unsafe.Shuffle(
             Native._make_pointer(rng, np.ubyte, is_null_allowed=True),
@@ -396,7 +508,8 @@ class Native:
 
         return impurities
 
-    def purify(self, scores, weights, tolerance, is_randomized):
+    @staticmethod
+    def _check_purify_params(tolerance, is_randomized):
         if np.isnan(tolerance) or tolerance < 0.0 or tolerance >= 1.0:
             msg = (
                 f"tolerance must be between 0.0 and less than 1.0, but is {tolerance}."
@@ -407,6 +520,11 @@ class Native:
             msg = "is_randomized must be True or False."
             raise Exception(msg)
 
+    @staticmethod
+    def _make_purify_buffers(scores, weights):
+        # returns the shapes, the impurity buffer to pass into Purify, and the intercept.
+        # The impurity buffer is None for single dimensional tensors.
+        # n_tensor is 0 if the tensor is empty.
         shape_all = scores.shape
         shape_classless = scores.shape
         n_multi_scores = 1
@@ -421,23 +539,59 @@ class Native:
 
         intercept = np.zeros(n_multi_scores, np.float64)
 
+        n_tensor = 1
+        for n_bins in shape_classless:
+            n_tensor *= n_bins
+
         impurity = None
-        if len(shape_classless) >= 2:
-            n_tensor = 1
+        if len(shape_classless) >= 2 and n_tensor != 0:
+            n_impurity_scores = 0
             for n_bins in shape_classless:
-                n_tensor *= n_bins
+                n_impurity_scores += n_tensor // n_bins
+            n_impurity_scores *= n_multi_scores
+            impurity = np.empty(n_impurity_scores, np.float64)
 
+        return shape_all, shape_classless, n_multi_scores, n_tensor, impurity, intercept
+
+    @staticmethod
+    def _split_impurities(
+        impurity, shape_all, shape_classless, n_multi_scores, n_tensor
+    ):
+        impurities = []
+        if len(shape_classless) >= 2:
             if n_tensor == 0:
                 return [
                     np.zeros(shape_all[:i] + shape_all[i + 1 :], np.float64)
                     for i in range(len(shape_classless) - 1, -1, -1)
-                ], intercept
+                ]
+
+            base_idx = 0
+            for exclude_idx in range(len(shape_classless) - 1, -1, -1):
+                count = n_tensor // shape_classless[exclude_idx]
+                count *= n_multi_scores
+                impure_shape = list(shape_all)
+                del impure_shape[exclude_idx]
+                impurities.append(
+                    impurity[base_idx : base_idx + count].reshape(tuple(impure_shape))
+                )
+                base_idx += count
+        return impurities
+
+    def purify(self, scores, weights, tolerance, is_randomized):
+        Native._check_purify_params(tolerance, is_randomized)
+
+        shape_all, shape_classless, n_multi_scores, n_tensor, impurity, intercept = (
+            Native._make_purify_buffers(scores, weights)
+        )
+
+        if n_tensor == 0 and len(shape_classless) >= 2:
+            return (
+                Native._split_impurities(
+                    impurity, shape_all, shape_classless, n_multi_scores, n_tensor
+                ),
+                intercept,
+            )
 
-            n_impurity_scores = 0
-            for n_bins in shape_classless:
-                n_impurity_scores += n_tensor // n_bins
-            n_impurity_scores *= n_multi_scores
-            impurity = np.empty(n_impurity_scores, np.float64)
         shape_array = np.array(tuple(reversed(shape_classless)), np.int64)
 
         is_multiclass_normalization = True
@@ -458,21 +612,185 @@ class Native:
         if return_code:  # pragma: no cover
             raise Native._get_native_exception(return_code, "Purify")
 
-        impurities = []
-        if len(shape_classless) >= 2:
-            base_idx = 0
-            for exclude_idx in range(len(shape_classless) - 1, -1, -1):
-                count = n_tensor // shape_classless[exclude_idx]
-                count *= n_multi_scores
-                impure_shape = list(shape_all)
-                del impure_shape[exclude_idx]
-                impurities.append(
-                    impurity[base_idx : base_idx + count].reshape(tuple(impure_shape))
-                )
-                base_idx += count
-
+        impurities = Native._split_impurities(
+            impurity, shape_all, shape_classless, n_multi_scores, n_tensor
+        )
         return impurities, intercept
 
+    def purify_many(
+        self, scores_list, weights_list, tolerance, is_randomized, max_iterations=0
+    ):
+        # purifies each scores tensor in place.  This runs serially unless
+        # set_thread_pool or set_parallel_for was called.  All the tensors need the
+        # same number of multiclass scores.  Returns a list of (impurities, intercept)
+        # tuples like purify returns, the number of purification sweeps made over each
+        # tensor, and whether each tensor converged before reaching max_iterations.
+        # A max_iterations of 0 means no limit.
+        Native._check_purify_params(tolerance, is_randomized)
+
+        if len(scores_list) != len(weights_list):
+            msg = "scores_list and weights_list must have the same length."
+            raise ValueError(msg)
+
+        n_tensors = len(scores_list)
+        buffers = [
+            Native._make_purify_buffers(scores, weights)
+            for scores, weights in zip(scores_list, weights_list)
+        ]
+
+        # empty tensors have nothing to purify, so we keep them out of the native call
+        native_idxs = [i for i, buffer in enumerate(buffers) if buffer[3] != 0]
+
+        iterations = np.zeros(n_tensors, np.int64)
+        converged = np.ones(n_tensors, np.bool_)
+        if len(native_idxs) != 0:
+            n_multi_scores = buffers[native_idxs[0]][2]
+            if any(buffers[i][2] != n_multi_scores for i in native_idxs):
+                msg = "all the tensors must have the same number of multiclass scores."
+                raise ValueError(msg)
+
+            shape_arrays = [
+                np.array(tuple(reversed(buffers[i][1])), np.int64) for i in native_idxs
+            ]
+            count_dimensions = np.array(
+                [len(buffers[i][1]) for i in native_idxs], np.int64
+            )
+            dimension_lengths = np.array(
+                [Native._make_pointer(a, np.int64) for a in shape_arrays], np.uintp
+            )
+            weights_ptrs = np.array(
+                [
+                    Native._make_pointer(weights_list[i], np.float64, None)
+                    for i in native_idxs
+                ],
+                np.uintp,
+            )
+            scores_ptrs = np.array(
+                [
+                    Native._make_pointer(scores_list[i], np.float64, None)
+                    for i in native_idxs
+                ],
+                np.uintp,
+            )
+            impurity_ptrs = np.array(
+                [
+                    Native._make_pointer(
+                        buffers[i][4], np.float64, is_null_allowed=True
+                    )
+                    or 0
+                    for i in native_idxs
+                ],
+                np.uintp,
+            )
+            intercept_ptrs = np.array(
+                [Native._make_pointer(buffers[i][5], np.float64) for i in native_idxs],
+                np.uintp,
+            )
+            native_iterations = np.empty(len(native_idxs), np.int64)
+            native_converged = np.empty(len(native_idxs), np.int32)
+
+            return_code = self._unsafe.PurifyMany(
+                tolerance,
+                is_randomized,
+                True,
+                n_multi_scores,
+                max_iterations,
+                len(native_idxs),
+                Native._make_pointer(count_dimensions, np.int64),
+                Native._make_pointer(dimension_lengths, np.uintp),
+                Native._make_pointer(weights_ptrs, np.uintp),
+                Native._make_pointer(scores_ptrs, np.uintp),
+                Native._make_pointer(impurity_ptrs, np.uintp),
+                Native._make_pointer(intercept_ptrs, np.uintp),
+                Native._make_pointer(native_iterations, np.int64),
+                Native._make_pointer(native_converged, np.int32),
+            )
+            if return_code:  # pragma: no cover
+                raise Native._get_native_exception(return_code, "PurifyMany")
+
+            iterations[native_idxs] = native_iterations
+            converged[native_idxs] = native_converged != 0
+
+        results = [
+            (
+                Native._split_impurities(
+                    impurity, shape_all, shape_classless, n_multi, n_tensor
+                ),
+                intercept,
+            )
+            for shape_all, shape_classless, n_multi, n_tensor, impurity, intercept in (
+                buffers
+            )
+        ]
+        return results, iterations, converged
+
+    def harmonize_tensors(
+        self, new_shape, n_scores, projections, old_tensors, old_bin_weights
+    ):
+        # re-bins each old tensor onto the grid new_shape, serially unless
+        # set_thread_pool or set_parallel_for was called.  Each projection is a tuple
+        # of (old_bin_offsets, old_bin_idxs, percentages) as described for
+        # HarmonizeTensors.  The old tensors and old_bin_weights need to be C
+        # contiguous with their dimensions in the same order as new_shape, and
+        # old_bin_weights can hold None for tensors that are weights themselves.
+        n_tensors = len(old_tensors)
+        if len(projections) != n_tensors or len(old_bin_weights) != n_tensors:
+            msg = "projections, old_tensors, and old_bin_weights must have the same length."
+            raise ValueError(msg)
+
+        shape = tuple(new_shape)
+        if n_scores != 1:
+            shape = (*shape, n_scores)
+        tensors = [np.empty(shape, np.float64) for _ in range(n_tensors)]
+        if n_tensors == 0:
+            return tensors
+
+        n_dims = len(new_shape)
+        for old_tensor in old_tensors:
+            if old_tensor.ndim != n_dims + (0 if n_scores == 1 else 1):
+                msg = "old_tensors must have the same number of dimensions as new_shape."
+                raise ValueError(msg)
+
+        bin_counts = np.array(new_shape, np.int64)
+        old_bin_counts = [
+            np.array(old_tensor.shape[:n_dims], np.int64) for old_tensor in old_tensors
+        ]
+
+        def pointers(arrays, dtype, ndim=1):
+            return np.array(
+                [
+                    Native._make_pointer(a, dtype, ndim, is_null_allowed=True) or 0
+                    for a in arrays
+                ],
+                np.uintp,
+            )
+
+        old_bin_counts_ptrs = pointers(old_bin_counts, np.int64)
+        old_bin_offsets_ptrs = pointers([p[0] for p in projections], np.int64)
+        old_bin_idxs_ptrs = pointers([p[1] for p in projections], np.int64)
+        percentages_ptrs = pointers([p[2] for p in projections], np.float64)
+        old_tensor_ptrs = pointers(old_tensors, np.float64, None)
+        old_bin_weights_ptrs = pointers(old_bin_weights, np.float64, None)
+        tensor_ptrs = pointers(tensors, np.float64, None)
+
+        return_code = self._unsafe.HarmonizeTensors(
+            n_scores,
+            n_dims,
+            Native._make_pointer(bin_counts, np.int64),
+            n_tensors,
+            Native._make_pointer(old_bin_counts_ptrs, np.uintp),
+            Native._make_pointer(old_bin_offsets_ptrs, np.uintp),
+            Native._make_pointer(old_bin_idxs_ptrs, np.uintp),
+            Native._make_pointer(percentages_ptrs, np.uintp),
+            Native._make_pointer(old_tensor_ptrs, np.uintp),
+            Native._make_pointer(old_bin_weights_ptrs, np.uintp),
+            Native._make_pointer(tensor_ptrs, np.uintp),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "HarmonizeTensors")
+
+        return tensors
+
     def get_histogram_cut_count(self, X_col):
         return self._unsafe.GetHistogramCutCount(
             X_col.shape[0], Native._make_pointer(X_col, np.float64)
@@ -512,6 +830,122 @@ class Native:
 
         return cuts[: count_cuts.value]
 
+    def cut_quantile_many(self, X_cols, min_samples_bin, is_rounded, max_cuts):
+        # X_cols is a list of contiguous float64 columns that all have the same length.
+        # min_samples_bin, is_rounded, and max_cuts can be per-column sequences or scalars
+        n_features = len(X_cols)
+        n_samples = 0 if n_features == 0 else X_cols[0].shape[0]
+        if any(col.shape[0] != n_samples for col in X_cols):
+            msg = "all columns must have the same number of samples"
+            raise ValueError(msg)
+        cols = np.array(
+            [Native._make_pointer(col, np.float64) for col in X_cols], dtype=np.uintp
+        )
+        min_samples_bin = np.broadcast_to(
+            np.asarray(min_samples_bin, np.int64), n_features
+        ).copy()
+        is_rounded = np.broadcast_to(np.asarray(is_rounded, np.int32), n_features).copy()
+        max_cuts = np.broadcast_to(np.asarray(max_cuts, np.int64), n_features).copy()
+
+        cut_offsets = np.empty(n_features + 1, dtype=np.int64, order="C")
+        cuts = np.empty(np.sum(max_cuts), dtype=np.float64, order="C")
+        return_code = self._unsafe.CutQuantileMany(
+            n_features,
+            n_samples,
+            Native._make_pointer(cols, np.uintp),
+            Native._make_pointer(min_samples_bin, np.int64),
+            Native._make_pointer(is_rounded, np.int32),
+            Native._make_pointer(max_cuts, np.int64),
+            Native._make_pointer(cut_offsets, np.int64),
+            Native._make_pointer(cuts, np.float64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CutQuantileMany")
+
+        return [
+            cuts[cut_offsets[i] : cut_offsets[i + 1]].copy() for i in range(n_features)
+        ]
+
+    def discretize_many(self, X_cols, cuts_list):
+        # returns an (n_features, n_samples) array of bin indexes
+        n_features = len(X_cols)
+        n_samples = 0 if n_features == 0 else X_cols[0].shape[0]
+        if any(col.shape[0] != n_samples for col in X_cols):
+            msg = "all columns must have the same number of samples"
+            raise ValueError(msg)
+        cols = np.array(
+            [Native._make_pointer(col, np.float64) for col in X_cols], dtype=np.uintp
+        )
+        cut_offsets = np.zeros(n_features + 1, dtype=np.int64)
+        np.cumsum([len(cuts) for cuts in cuts_list], out=cut_offsets[1:])
+        cuts = np.concatenate([np.empty(0, np.float64), *cuts_list]).astype(
+            np.float64, copy=False
+        )
+
+        bin_indexes = np.empty((n_features, n_samples), dtype=np.int64, order="C")
+        return_code = self._unsafe.DiscretizeMany(
+            n_features,
+            n_samples,
+            Native._make_pointer(cols, np.uintp),
+            Native._make_pointer(cut_offsets, np.int64),
+            Native._make_pointer(cuts, np.float64),
+            Native._make_pointer(bin_indexes, np.int64, 2),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "DiscretizeMany")
+
+        return bin_indexes
+
+    def make_quantile_sketch(self, items_per_level):
+        n_bytes = self._unsafe.MeasureQuantileSketch(items_per_level)
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureQuantileSketch")
+
+        sketch = np.empty(n_bytes, dtype=np.ubyte, order="C")
+        return_code = self._unsafe.InitQuantileSketch(
+            items_per_level, n_bytes, Native._make_pointer(sketch, np.ubyte)
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "InitQuantileSketch")
+
+        return sketch
+
+    def add_quantile_sketch(self, sketch, X_col):
+        return_code = self._unsafe.AddQuantileSketch(
+            X_col.shape[0],
+            Native._make_pointer(X_col, np.float64),
+            Native._make_pointer(sketch, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "AddQuantileSketch")
+
+    def merge_quantile_sketch(self, sketch_in_out, sketch):
+        return_code = self._unsafe.MergeQuantileSketch(
+            Native._make_pointer(sketch, np.ubyte),
+            Native._make_pointer(sketch_in_out, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "MergeQuantileSketch")
+
+    def cut_quantile_sketch(self, sketch, min_samples_bin, is_rounded, max_cuts):
+        if max_cuts < 0:
+            msg = f"max_cuts can't be negative: {max_cuts}."
+            raise Exception(msg)
+
+        cuts = np.empty(max_cuts, dtype=np.float64, order="C")
+        count_cuts = ct.c_int64(max_cuts)
+        return_code = self._unsafe.CutQuantileSketch(
+            Native._make_pointer(sketch, np.ubyte),
+            min_samples_bin,
+            is_rounded,
+            ct.byref(count_cuts),
+            Native._make_pointer(cuts, np.float64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CutQuantileSketch")
+
+        return cuts[: count_cuts.value]
+
     def cut_winsorized(self, X_col, max_cuts):
         if max_cuts < 0:
             msg = f"max_cuts can't be negative: {max_cuts}."
@@ -577,6 +1011,33 @@ class Native:
 
         return bin_indexes
 
+    def floats_to_string(self, vals):
+        n_chars = max(1, len(vals) * self._unsafe.GetCountCharactersPerFloat())
+        buffer = ct.create_string_buffer(n_chars)
+
+        return_code = self._unsafe.FloatsToString(
+            len(vals),
+            Native._make_pointer(vals, np.float64, None),
+            buffer,
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FloatsToString")
+
+        return buffer.value.decode("ascii")
+
+    def string_to_floats(self, text, n_vals):
+        vals = np.empty(n_vals, np.float64, order="C")
+
+        return_code = self._unsafe.StringToFloats(
+            text.encode("ascii"),
+            n_vals,
+            Native._make_pointer(vals, np.float64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "StringToFloats")
+
+        return vals
+
     def measure_dataset_header(self, n_features, n_weights, n_targets):
         n_bytes = self._unsafe.MeasureDataSetHeader(n_features, n_weights, n_targets)
         if n_bytes < 0:  # pragma: no cover
@@ -690,6 +1151,43 @@ class Native:
         if return_code:  # pragma: no cover
             raise Native._get_native_exception(return_code, "CheckDataSet")
 
+    def fill_dataset_file_header(self, dataset):
+        header = np.empty(self._unsafe.MeasureDataSetFileHeader(), np.ubyte)
+        return_code = self._unsafe.FillDataSetFileHeader(
+            dataset.nbytes,
+            Native._make_pointer(dataset, np.ubyte),
+            header.nbytes,
+            Native._make_pointer(header, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillDataSetFileHeader")
+        return header
+
+    def check_dataset_file(self, dataset_file, verify_checksum=False):
+        offset = ct.c_int64(0)
+        return_code = self._unsafe.CheckDataSetFile(
+            dataset_file.nbytes,
+            Native._make_pointer(dataset_file, np.ubyte),
+            verify_checksum,
+            ct.byref(offset),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CheckDataSetFile")
+        return offset.value
+
+    def write_dataset_file(self, path, dataset):
+        # the header records that the dataset passed CheckDataSet, so readers do not rescan it
+        header = self.fill_dataset_file_header(dataset)
+        with open(path, "wb") as f:
+            f.write(header.data)
+            f.write(dataset.data)
+
+    def map_dataset_file(self, path, verify_checksum=False):
+        # every process that maps the file shares the same physical pages through the page cache
+        dataset_file = np.memmap(path, dtype=np.ubyte, mode="r")
+        offset = self.check_dataset_file(dataset_file, verify_checksum)
+        return dataset_file[offset:]
+
     def extract_dataset_header(self, dataset):
         n_samples = ct.c_int64(-1)
         n_features = ct.c_int64(-1)
@@ -749,6 +1247,187 @@ class Native:
 
         return class_counts
 
+    def measure_model_header(self, n_features, n_terms):
+        n_bytes = self._unsafe.MeasureModelHeader(n_features, n_terms)
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureModelHeader")
+        return n_bytes
+
+    def measure_model_cuts(self, n_cuts):
+        n_bytes = self._unsafe.MeasureModelCuts(n_cuts)
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureModelCuts")
+        return n_bytes
+
+    def measure_model_categories(self, n_categories, n_bytes_strings):
+        n_bytes = self._unsafe.MeasureModelCategories(n_categories, n_bytes_strings)
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureModelCategories")
+        return n_bytes
+
+    def measure_model_term(self, n_scores, dimension_lengths, has_weights):
+        n_bytes = self._unsafe.MeasureModelTerm(
+            n_scores,
+            len(dimension_lengths),
+            Native._make_pointer(dimension_lengths, np.int64),
+            has_weights,
+        )
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureModelTerm")
+        return n_bytes
+
+    def fill_model_header(self, n_features, n_terms, n_scores, model):
+        return_code = self._unsafe.FillModelHeader(
+            n_features,
+            n_terms,
+            n_scores,
+            model.nbytes,
+            Native._make_pointer(model, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillModelHeader")
+
+    def fill_model_cuts(self, cuts, model):
+        return_code = self._unsafe.FillModelCuts(
+            len(cuts),
+            Native._make_pointer(cuts, np.float64),
+            model.nbytes,
+            Native._make_pointer(model, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillModelCuts")
+
+    def fill_model_categories(self, bin_indexes, strings, model):
+        # strings is a bytes object holding one null terminated UTF-8 string per category
+        strings = np.frombuffer(strings, np.ubyte)
+        return_code = self._unsafe.FillModelCategories(
+            len(bin_indexes),
+            Native._make_pointer(bin_indexes, np.int64),
+            len(strings),
+            Native._make_pointer(strings, np.ubyte),
+            model.nbytes,
+            Native._make_pointer(model, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillModelCategories")
+
+    def fill_model_term(
+        self, n_scores, feature_indexes, dimension_lengths, scores, bin_weights, model
+    ):
+        return_code = self._unsafe.FillModelTerm(
+            n_scores,
+            len(feature_indexes),
+            Native._make_pointer(feature_indexes, np.int64),
+            Native._make_pointer(dimension_lengths, np.int64),
+            Native._make_pointer(scores, np.float64, None),
+            Native._make_pointer(bin_weights, np.float64, None, is_null_allowed=True),
+            model.nbytes,
+            Native._make_pointer(model, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillModelTerm")
+
+    def check_model(self, model):
+        # model can be a read-only view, eg: np.frombuffer(mmap.mmap(...), np.ubyte)
+        return_code = self._unsafe.CheckModel(
+            model.nbytes,
+            Native._make_pointer(model, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CheckModel")
+
+    def extract_model_header(self, model):
+        n_features = ct.c_int64(-1)
+        n_terms = ct.c_int64(-1)
+        n_scores = ct.c_int64(-1)
+
+        return_code = self._unsafe.ExtractModelHeader(
+            Native._make_pointer(model, np.ubyte),
+            ct.byref(n_features),
+            ct.byref(n_terms),
+            ct.byref(n_scores),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "ExtractModelHeader")
+
+        return n_features.value, n_terms.value, n_scores.value
+
+    def extract_model_feature(self, model, feature_idx):
+        # returns either a float64 view of the cuts, or a dict of category strings
+        # to bin indexes.  The cuts are not copied.
+        is_nominal = ct.c_int32(0)
+        n_items = ct.c_int64(-1)
+        offset_items = ct.c_int64(-1)
+        n_bytes_strings = ct.c_int64(-1)
+        offset_strings = ct.c_int64(-1)
+
+        return_code = self._unsafe.ExtractModelFeature(
+            Native._make_pointer(model, np.ubyte),
+            feature_idx,
+            ct.byref(is_nominal),
+            ct.byref(n_items),
+            ct.byref(offset_items),
+            ct.byref(n_bytes_strings),
+            ct.byref(offset_strings),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "ExtractModelFeature")
+
+        start = offset_items.value
+        end = start + n_items.value * 8
+        if not is_nominal.value:
+            return model[start:end].view(np.float64)
+
+        bins = model[start:end].view(np.int64)
+        start = offset_strings.value
+        end = start + n_bytes_strings.value
+        strings = model[start:end].tobytes().split(b"\0")[:-1]
+        return {s.decode("utf-8"): int(b) for s, b in zip(strings, bins)}
+
+    def extract_model_term(self, model, term_idx):
+        # returns views over the model memory: (feature_indexes, scores, bin_weights)
+        # scores is shaped by the dimension lengths, with a trailing dimension
+        # when there are multiple scores.  bin_weights is None if not stored.
+        n_dimensions = ct.c_int64(-1)
+        n_tensor_bins = ct.c_int64(-1)
+        offset_feature_indexes = ct.c_int64(-1)
+        offset_dimension_lengths = ct.c_int64(-1)
+        offset_scores = ct.c_int64(-1)
+        offset_bin_weights = ct.c_int64(-1)
+
+        return_code = self._unsafe.ExtractModelTerm(
+            Native._make_pointer(model, np.ubyte),
+            term_idx,
+            ct.byref(n_dimensions),
+            ct.byref(n_tensor_bins),
+            ct.byref(offset_feature_indexes),
+            ct.byref(offset_dimension_lengths),
+            ct.byref(offset_scores),
+            ct.byref(offset_bin_weights),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "ExtractModelTerm")
+
+        _, _, n_scores = self.extract_model_header(model)
+
+        start = offset_feature_indexes.value
+        feature_indexes = model[start : start + n_dimensions.value * 8].view(np.int64)
+        start = offset_dimension_lengths.value
+        shape = tuple(model[start : start + n_dimensions.value * 8].view(np.int64))
+
+        start = offset_scores.value
+        end = start + n_tensor_bins.value * n_scores * 8
+        scores = model[start:end].view(np.float64)
+        scores = scores.reshape(shape if n_scores == 1 else (*shape, n_scores))
+
+        bin_weights = None
+        if offset_bin_weights.value != 0:
+            start = offset_bin_weights.value
+            end = start + n_tensor_bins.value * 8
+            bin_weights = model[start:end].view(np.float64).reshape(shape)
+
+        return feature_indexes, scores, bin_weights
+
     def sample_without_replacement(
         self, rng, count_training_samples, count_validation_samples
     ):
@@ -973,6 +1652,7 @@ class Native:
         self.approximates = True
 
         self._log_callback_func = None
+        self._parallel_for_func = None
         self._unsafe = ct.cdll.LoadLibrary(Native._get_ebm_lib_path(debug=is_debug))
 
         self._unsafe.SetLogCallback.argtypes = [
@@ -987,6 +1667,41 @@ class Native:
         ]
         self._unsafe.SetTraceLevel.restype = None
 
+        self._unsafe.StartTimeline.argtypes = []
+        self._unsafe.StartTimeline.restype = None
+
+        self._unsafe.StopTimeline.argtypes = []
+        self._unsafe.StopTimeline.restype = None
+
+        self._unsafe.MeasureTimelineJson.argtypes = []
+        self._unsafe.MeasureTimelineJson.restype = ct.c_int64
+
+        self._unsafe.FillTimelineJson.argtypes = [
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # char * jsonOut
+            ct.c_char_p,
+        ]
+        self._unsafe.FillTimelineJson.restype = ct.c_int32
+
+        self._unsafe.SetThreadPool.argtypes = [
+            # int64_t countThreads
+            ct.c_int64,
+            # int32_t flags
+            ct.c_int32,
+            # int64_t numaNode
+            ct.c_int64,
+        ]
+        self._unsafe.SetThreadPool.restype = ct.c_int32
+
+        self._unsafe.SetParallelForCallback.argtypes = [
+            # ErrorEbm (* ParallelForFunction)(void * callbackContext, int64_t countTasks, ParallelTaskFunction task, void * taskContext) parallelFor
+            self._ParallelForType,
+            # void * callbackContext
+            ct.c_void_p,
+        ]
+        self._unsafe.SetParallelForCallback.restype = ct.c_int32
+
         self._unsafe.CleanFloats.argtypes = [
             # int64_t count
             ct.c_int64,
@@ -1070,12 +1785,24 @@ class Native:
         ]
         self._unsafe.GenerateGaussianRandom.restype = ct.c_int32
 
-        self._unsafe.Shuffle.argtypes = [
+        self._unsafe.GenerateGaussianRandomParallel.argtypes = [
             # void * rng
             ct.c_void_p,
+            # double stddev
+            ct.c_double,
             # int64_t count
             ct.c_int64,
-            # int64_t * randomOut
+            # double * randomOut
+            ct.c_void_p,
+        ]
+        self._unsafe.GenerateGaussianRandomParallel.restype = ct.c_int32
+
+        self._unsafe.Shuffle.argtypes = [
+            # void * rng
+            ct.c_void_p,
+            # int64_t count
+            ct.c_int64,
+            # int64_t * randomOut
             ct.c_void_p,
         ]
         self._unsafe.Shuffle.restype = ct.c_int32
@@ -1120,6 +1847,64 @@ class Native:
         ]
         self._unsafe.Purify.restype = ct.c_int32
 
+        self._unsafe.PurifyMany.argtypes = [
+            # double tolerance
+            ct.c_double,
+            # int32_t isRandomized
+            ct.c_int32,
+            # int32_t isMulticlassNormalization
+            ct.c_int32,
+            # int64_t countMultiScores
+            ct.c_int64,
+            # int64_t countIterationsMax
+            ct.c_int64,
+            # int64_t countTensors
+            ct.c_int64,
+            # int64_t * countDimensions
+            ct.c_void_p,
+            # int64_t ** dimensionLengths
+            ct.c_void_p,
+            # double ** weights
+            ct.c_void_p,
+            # double ** scoresInOut
+            ct.c_void_p,
+            # double ** impuritiesOut
+            ct.c_void_p,
+            # double ** interceptOut
+            ct.c_void_p,
+            # int64_t * iterationsOut
+            ct.c_void_p,
+            # int32_t * isConvergedOut
+            ct.c_void_p,
+        ]
+        self._unsafe.PurifyMany.restype = ct.c_int32
+
+        self._unsafe.HarmonizeTensors.argtypes = [
+            # int64_t countScores
+            ct.c_int64,
+            # int64_t countDimensions
+            ct.c_int64,
+            # int64_t * binCounts
+            ct.c_void_p,
+            # int64_t countTensors
+            ct.c_int64,
+            # int64_t ** oldBinCounts
+            ct.c_void_p,
+            # int64_t ** oldBinOffsets
+            ct.c_void_p,
+            # int64_t ** oldBinIndexes
+            ct.c_void_p,
+            # double ** percentages
+            ct.c_void_p,
+            # double ** oldTensors
+            ct.c_void_p,
+            # double ** oldBinWeights
+            ct.c_void_p,
+            # double ** tensorsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.HarmonizeTensors.restype = ct.c_int32
+
         self._unsafe.GetHistogramCutCount.argtypes = [
             # int64_t countSamples
             ct.c_int64,
@@ -1156,6 +1941,74 @@ class Native:
         ]
         self._unsafe.CutQuantile.restype = ct.c_int32
 
+        self._unsafe.CutQuantileMany.argtypes = [
+            # int64_t countFeatures
+            ct.c_int64,
+            # int64_t countSamples
+            ct.c_int64,
+            # double ** featureCols
+            ct.c_void_p,
+            # int64_t * minSamplesBin
+            ct.c_void_p,
+            # int32_t * isRounded
+            ct.c_void_p,
+            # int64_t * countCutsMax
+            ct.c_void_p,
+            # int64_t * cutOffsetsOut
+            ct.c_void_p,
+            # double * cutsLowerBoundInclusiveOut
+            ct.c_void_p,
+        ]
+        self._unsafe.CutQuantileMany.restype = ct.c_int32
+
+        self._unsafe.MeasureQuantileSketch.argtypes = [
+            # int64_t countItemsPerLevel
+            ct.c_int64,
+        ]
+        self._unsafe.MeasureQuantileSketch.restype = ct.c_int64
+
+        self._unsafe.InitQuantileSketch.argtypes = [
+            # int64_t countItemsPerLevel
+            ct.c_int64,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * sketchOut
+            ct.c_void_p,
+        ]
+        self._unsafe.InitQuantileSketch.restype = ct.c_int32
+
+        self._unsafe.AddQuantileSketch.argtypes = [
+            # int64_t countSamples
+            ct.c_int64,
+            # double * featureVals
+            ct.c_void_p,
+            # void * sketchInOut
+            ct.c_void_p,
+        ]
+        self._unsafe.AddQuantileSketch.restype = ct.c_int32
+
+        self._unsafe.MergeQuantileSketch.argtypes = [
+            # void * sketch
+            ct.c_void_p,
+            # void * sketchInOut
+            ct.c_void_p,
+        ]
+        self._unsafe.MergeQuantileSketch.restype = ct.c_int32
+
+        self._unsafe.CutQuantileSketch.argtypes = [
+            # void * sketch
+            ct.c_void_p,
+            # int64_t minSamplesBin
+            ct.c_int64,
+            # int32_t isRounded
+            ct.c_int32,
+            # int64_t * countCutsInOut
+            ct.POINTER(ct.c_int64),
+            # double * cutsLowerBoundInclusiveOut
+            ct.c_void_p,
+        ]
+        self._unsafe.CutQuantileSketch.restype = ct.c_int32
+
         self._unsafe.CutWinsorized.argtypes = [
             # int64_t countSamples
             ct.c_int64,
@@ -1200,6 +2053,45 @@ class Native:
         ]
         self._unsafe.Discretize.restype = ct.c_int32
 
+        self._unsafe.DiscretizeMany.argtypes = [
+            # int64_t countFeatures
+            ct.c_int64,
+            # int64_t countSamples
+            ct.c_int64,
+            # double ** featureCols
+            ct.c_void_p,
+            # int64_t * cutOffsets
+            ct.c_void_p,
+            # double * cutsLowerBoundInclusive
+            ct.c_void_p,
+            # int64_t * binIndexesOut
+            ct.c_void_p,
+        ]
+        self._unsafe.DiscretizeMany.restype = ct.c_int32
+
+        self._unsafe.GetCountCharactersPerFloat.argtypes = []
+        self._unsafe.GetCountCharactersPerFloat.restype = ct.c_int64
+
+        self._unsafe.FloatsToString.argtypes = [
+            # int64_t countFloats
+            ct.c_int64,
+            # double * vals
+            ct.c_void_p,
+            # char * strOut
+            ct.c_char_p,
+        ]
+        self._unsafe.FloatsToString.restype = ct.c_int32
+
+        self._unsafe.StringToFloats.argtypes = [
+            # char * str
+            ct.c_char_p,
+            # int64_t countFloats
+            ct.c_int64,
+            # double * valsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.StringToFloats.restype = ct.c_int32
+
         self._unsafe.MeasureDataSetHeader.argtypes = [
             # int64_t countFeatures
             ct.c_int64,
@@ -1324,6 +2216,96 @@ class Native:
         ]
         self._unsafe.FillRegressionTarget.restype = ct.c_int32
 
+        self._unsafe.CreateDataSetBuilder.argtypes = [
+            # int64_t countFeatures
+            ct.c_int64,
+            # int64_t * binCounts
+            ct.c_void_p,
+            # int32_t * nominals
+            ct.c_void_p,
+            # int64_t countWeights
+            ct.c_int64,
+            # int64_t countTargets
+            ct.c_int64,
+            # int64_t * classCounts
+            ct.c_void_p,
+            # int64_t countSamplesHint
+            ct.c_int64,
+            # DataSetBuilderHandle * dataSetBuilderHandleOut
+            ct.POINTER(ct.c_void_p),
+        ]
+        self._unsafe.CreateDataSetBuilder.restype = ct.c_int32
+
+        self._unsafe.AppendFeatureBins.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t indexFeature
+            ct.c_int64,
+            # int64_t countSamples
+            ct.c_int64,
+            # int64_t * binIndexes
+            ct.c_void_p,
+        ]
+        self._unsafe.AppendFeatureBins.restype = ct.c_int32
+
+        self._unsafe.AppendWeights.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t indexWeight
+            ct.c_int64,
+            # int64_t countSamples
+            ct.c_int64,
+            # double * weights
+            ct.c_void_p,
+        ]
+        self._unsafe.AppendWeights.restype = ct.c_int32
+
+        self._unsafe.AppendClassificationTargets.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t indexTarget
+            ct.c_int64,
+            # int64_t countSamples
+            ct.c_int64,
+            # int64_t * targets
+            ct.c_void_p,
+        ]
+        self._unsafe.AppendClassificationTargets.restype = ct.c_int32
+
+        self._unsafe.AppendRegressionTargets.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t indexTarget
+            ct.c_int64,
+            # int64_t countSamples
+            ct.c_int64,
+            # double * targets
+            ct.c_void_p,
+        ]
+        self._unsafe.AppendRegressionTargets.restype = ct.c_int32
+
+        self._unsafe.MeasureDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+        ]
+        self._unsafe.MeasureDataSetBuilder.restype = ct.c_int64
+
+        self._unsafe.FillDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * fillMem
+            ct.c_void_p,
+        ]
+        self._unsafe.FillDataSetBuilder.restype = ct.c_int32
+
+        self._unsafe.FreeDataSetBuilder.argtypes = [
+            # void * dataSetBuilderHandle
+            ct.c_void_p
+        ]
+        self._unsafe.FreeDataSetBuilder.restype = None
+
         self._unsafe.CheckDataSet.argtypes = [
             # int64_t countBytesAllocated
             ct.c_int64,
@@ -1332,6 +2314,33 @@ class Native:
         ]
         self._unsafe.CheckDataSet.restype = ct.c_int32
 
+        self._unsafe.MeasureDataSetFileHeader.argtypes = []
+        self._unsafe.MeasureDataSetFileHeader.restype = ct.c_int64
+
+        self._unsafe.FillDataSetFileHeader.argtypes = [
+            # int64_t countBytesDataSet
+            ct.c_int64,
+            # void * dataSet
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * fillMem
+            ct.c_void_p,
+        ]
+        self._unsafe.FillDataSetFileHeader.restype = ct.c_int32
+
+        self._unsafe.CheckDataSetFile.argtypes = [
+            # int64_t countBytesFile
+            ct.c_int64,
+            # void * dataSetFile
+            ct.c_void_p,
+            # int32_t isVerifyChecksum
+            ct.c_int32,
+            # int64_t * offsetDataSetOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.CheckDataSetFile.restype = ct.c_int32
+
         self._unsafe.ExtractDataSetHeader.argtypes = [
             # void * dataSet
             ct.c_void_p,
@@ -1376,6 +2385,160 @@ class Native:
         ]
         self._unsafe.ExtractTargetClasses.restype = ct.c_int32
 
+        self._unsafe.MeasureModelHeader.argtypes = [
+            # int64_t countFeatures
+            ct.c_int64,
+            # int64_t countTerms
+            ct.c_int64,
+        ]
+        self._unsafe.MeasureModelHeader.restype = ct.c_int64
+
+        self._unsafe.MeasureModelCuts.argtypes = [
+            # int64_t countCuts
+            ct.c_int64,
+        ]
+        self._unsafe.MeasureModelCuts.restype = ct.c_int64
+
+        self._unsafe.MeasureModelCategories.argtypes = [
+            # int64_t countCategories
+            ct.c_int64,
+            # int64_t countBytesStrings
+            ct.c_int64,
+        ]
+        self._unsafe.MeasureModelCategories.restype = ct.c_int64
+
+        self._unsafe.MeasureModelTerm.argtypes = [
+            # int64_t countScores
+            ct.c_int64,
+            # int64_t countDimensions
+            ct.c_int64,
+            # int64_t * dimensionLengths
+            ct.c_void_p,
+            # int32_t hasWeights
+            ct.c_int32,
+        ]
+        self._unsafe.MeasureModelTerm.restype = ct.c_int64
+
+        self._unsafe.FillModelHeader.argtypes = [
+            # int64_t countFeatures
+            ct.c_int64,
+            # int64_t countTerms
+            ct.c_int64,
+            # int64_t countScores
+            ct.c_int64,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * fillMem
+            ct.c_void_p,
+        ]
+        self._unsafe.FillModelHeader.restype = ct.c_int32
+
+        self._unsafe.FillModelCuts.argtypes = [
+            # int64_t countCuts
+            ct.c_int64,
+            # double * cuts
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * fillMem
+            ct.c_void_p,
+        ]
+        self._unsafe.FillModelCuts.restype = ct.c_int32
+
+        self._unsafe.FillModelCategories.argtypes = [
+            # int64_t countCategories
+            ct.c_int64,
+            # int64_t * binIndexes
+            ct.c_void_p,
+            # int64_t countBytesStrings
+            ct.c_int64,
+            # char * strings
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * fillMem
+            ct.c_void_p,
+        ]
+        self._unsafe.FillModelCategories.restype = ct.c_int32
+
+        self._unsafe.FillModelTerm.argtypes = [
+            # int64_t countScores
+            ct.c_int64,
+            # int64_t countDimensions
+            ct.c_int64,
+            # int64_t * featureIndexes
+            ct.c_void_p,
+            # int64_t * dimensionLengths
+            ct.c_void_p,
+            # double * scores
+            ct.c_void_p,
+            # double * binWeights
+            ct.c_void_p,
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * fillMem
+            ct.c_void_p,
+        ]
+        self._unsafe.FillModelTerm.restype = ct.c_int32
+
+        self._unsafe.CheckModel.argtypes = [
+            # int64_t countBytesAllocated
+            ct.c_int64,
+            # void * model
+            ct.c_void_p,
+        ]
+        self._unsafe.CheckModel.restype = ct.c_int32
+
+        self._unsafe.ExtractModelHeader.argtypes = [
+            # void * model
+            ct.c_void_p,
+            # int64_t * countFeaturesOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countTermsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countScoresOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.ExtractModelHeader.restype = ct.c_int32
+
+        self._unsafe.ExtractModelFeature.argtypes = [
+            # void * model
+            ct.c_void_p,
+            # int64_t indexFeature
+            ct.c_int64,
+            # int32_t * isNominalOut
+            ct.POINTER(ct.c_int32),
+            # int64_t * countItemsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * offsetItemsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countBytesStringsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * offsetStringsOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.ExtractModelFeature.restype = ct.c_int32
+
+        self._unsafe.ExtractModelTerm.argtypes = [
+            # void * model
+            ct.c_void_p,
+            # int64_t indexTerm
+            ct.c_int64,
+            # int64_t * countDimensionsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * countTensorBinsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * offsetFeatureIndexesOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * offsetDimensionLengthsOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * offsetScoresOut
+            ct.POINTER(ct.c_int64),
+            # int64_t * offsetBinWeightsOut
+            ct.POINTER(ct.c_int64),
+        ]
+        self._unsafe.ExtractModelTerm.restype = ct.c_int32
+
         self._unsafe.SampleWithoutReplacement.argtypes = [
             # void * rng
             ct.c_void_p,
@@ -1438,6 +2601,32 @@ class Native:
         ]
         self._unsafe.GetLinkFunctionStr.restype = ct.c_char_p
 
+        self._unsafe.MeasureBooster.argtypes = [
+            # void * dataSet
+            ct.c_void_p,
+            # int8_t * bag
+            ct.c_void_p,
+            # int64_t countTerms
+            ct.c_int64,
+            # int64_t * dimensionCounts
+            ct.c_void_p,
+            # int64_t * featureIndexes
+            ct.c_void_p,
+            # int64_t countInnerBags
+            ct.c_int64,
+            # CreateBoosterFlags flags
+            ct.c_int32,
+            # AccelerationFlags acceleration
+            ct.c_int32,
+            # char * objective
+            ct.c_char_p,
+            # double * experimentalParams
+            ct.c_void_p,
+            # int64_t maxBytes
+            ct.c_int64,
+        ]
+        self._unsafe.MeasureBooster.restype = ct.c_int64
+
         self._unsafe.CreateBooster.argtypes = [
             # void * rng
             ct.c_void_p,
@@ -1463,6 +2652,8 @@ class Native:
             ct.c_char_p,
             # double * experimentalParams
             ct.c_void_p,
+            # int64_t maxBytes
+            ct.c_int64,
             # BoosterHandle * boosterHandleOut
             ct.POINTER(ct.c_void_p),
         ]
@@ -1504,6 +2695,18 @@ class Native:
         ]
         self._unsafe.GenerateTermUpdate.restype = ct.c_int32
 
+        self._unsafe.SetGradientSampling.argtypes = [
+            # void * rng
+            ct.c_void_p,
+            # void * boosterHandle
+            ct.c_void_p,
+            # double topFraction
+            ct.c_double,
+            # double otherFraction
+            ct.c_double,
+        ]
+        self._unsafe.SetGradientSampling.restype = ct.c_int32
+
         self._unsafe.GetTermUpdateSplits.argtypes = [
             # void * boosterHandle
             ct.c_void_p,
@@ -1562,6 +2765,28 @@ class Native:
         ]
         self._unsafe.GetCurrentTermScores.restype = ct.c_int32
 
+        self._unsafe.GetBoosterStats.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # int32_t isReset
+            ct.c_int32,
+            # uint64_t * termStatsOut
+            ct.c_void_p,
+            # uint64_t * zoneStatsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.GetBoosterStats.restype = ct.c_int32
+
+        self._unsafe.GetBoosterScratchStats.argtypes = [
+            # void * boosterHandle
+            ct.c_void_p,
+            # int32_t isReset
+            ct.c_int32,
+            # uint64_t * scratchStatsOut
+            ct.c_void_p,
+        ]
+        self._unsafe.GetBoosterScratchStats.restype = ct.c_int32
+
         self._unsafe.CreateInteractionDetector.argtypes = [
             # void * dataSet
             ct.c_void_p,
@@ -1615,6 +2840,117 @@ class Native:
         self._unsafe.CalcInteractionStrength.restype = ct.c_int32
 
 
+class DataSetBuilder(AbstractContextManager):
+    """Builds the native dataset from chunks of samples without holding entire columns."""
+
+    def __init__(self, bin_counts, nominals, n_weights, class_counts, n_samples_hint=0):
+        """Initializes internal wrapper for the EBM C dataset builder.
+
+        Args:
+            bin_counts: number of bins per feature including the missing and unknown bins
+            nominals: True for each nominal feature
+            n_weights: number of weight columns (0 or 1)
+            class_counts: number of classes per target, or Native.Task_Regression
+            n_samples_hint: expected number of samples, or 0 if unknown
+        """
+
+        self.bin_counts = np.array(bin_counts, np.int64)
+        self.nominals = np.array(nominals, np.int32)
+        self.n_weights = n_weights
+        self.class_counts = np.array(class_counts, np.int64)
+        self.n_samples_hint = n_samples_hint
+
+    def __enter__(self):
+        native = Native.get_native_singleton()
+
+        builder_handle = ct.c_void_p(0)
+        return_code = native._unsafe.CreateDataSetBuilder(
+            len(self.bin_counts),
+            Native._make_pointer(self.bin_counts, np.int64),
+            Native._make_pointer(self.nominals, np.int32),
+            self.n_weights,
+            len(self.class_counts),
+            Native._make_pointer(self.class_counts, np.int64),
+            self.n_samples_hint,
+            ct.byref(builder_handle),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "CreateDataSetBuilder")
+
+        self._builder_handle = builder_handle.value
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        """Deallocates the C builder."""
+        builder_handle = getattr(self, "_builder_handle", None)
+        if builder_handle:
+            native = Native.get_native_singleton()
+            self._builder_handle = None
+            native._unsafe.FreeDataSetBuilder(builder_handle)
+
+    def append_feature_bins(self, feature_idx, bin_indexes):
+        native = Native.get_native_singleton()
+        return_code = native._unsafe.AppendFeatureBins(
+            self._builder_handle,
+            feature_idx,
+            len(bin_indexes),
+            Native._make_pointer(bin_indexes, np.int64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "AppendFeatureBins")
+
+    def append_weights(self, weights, weight_idx=0):
+        native = Native.get_native_singleton()
+        return_code = native._unsafe.AppendWeights(
+            self._builder_handle,
+            weight_idx,
+            len(weights),
+            Native._make_pointer(weights, np.float64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "AppendWeights")
+
+    def append_targets(self, targets, target_idx=0):
+        native = Native.get_native_singleton()
+        if targets.dtype == np.float64:
+            return_code = native._unsafe.AppendRegressionTargets(
+                self._builder_handle,
+                target_idx,
+                len(targets),
+                Native._make_pointer(targets, np.float64),
+            )
+        else:
+            return_code = native._unsafe.AppendClassificationTargets(
+                self._builder_handle,
+                target_idx,
+                len(targets),
+                Native._make_pointer(targets, np.int64),
+            )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "AppendTargets")
+
+    def build(self):
+        """Returns the finished dataset in the same format as the Measure/Fill functions."""
+        native = Native.get_native_singleton()
+
+        n_bytes = native._unsafe.MeasureDataSetBuilder(self._builder_handle)
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureDataSetBuilder")
+
+        dataset = np.empty(n_bytes, np.ubyte)  # joblib loky doesn't support RawArray
+        return_code = native._unsafe.FillDataSetBuilder(
+            self._builder_handle,
+            dataset.nbytes,
+            Native._make_pointer(dataset, np.ubyte),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "FillDataSetBuilder")
+        return dataset
+
+
 class Booster(AbstractContextManager):
     """Lightweight wrapper for EBM C boosting code."""
 
@@ -1629,6 +2965,7 @@ class Booster(AbstractContextManager):
         create_booster_flags,
         objective,
         experimental_params,
+        max_bytes=0,
     ):
         """Initializes internal wrapper for EBM C code.
 
@@ -1643,6 +2980,7 @@ class Booster(AbstractContextManager):
             n_inner_bags: number of inner bags.
             rng: native random number generator
             experimental_params: unused data that can be passed into the native layer for debugging
+            max_bytes: memory budget for the native booster in bytes, or 0 for no budget
         """
 
         self.dataset = dataset
@@ -1654,13 +2992,12 @@ class Booster(AbstractContextManager):
         self.create_booster_flags = create_booster_flags
         self.objective = objective
         self.experimental_params = experimental_params
+        self.max_bytes = max_bytes
 
         # start off with an invalid _term_idx
         self._term_idx = -1
 
-    def __enter__(self):
-        _log.info("Booster allocation start")
-
+    def _term_arrays(self):
         if self.objective is None or len(self.objective.strip()) == 0:
             msg = "objective must be specified"
             _log.error(msg)
@@ -1672,6 +3009,41 @@ class Booster(AbstractContextManager):
             dimension_counts[term_idx] = len(feature_idxs)
             feature_indexes.extend(feature_idxs)
         feature_indexes = np.array(feature_indexes, ct.c_int64)
+        return dimension_counts, feature_indexes
+
+    def measure(self):
+        """Returns the bytes that entering this booster would allocate in native code."""
+        dimension_counts, feature_indexes = self._term_arrays()
+
+        native = Native.get_native_singleton()
+
+        flags = self.create_booster_flags
+        if not native.approximates:
+            flags |= Native.CreateBoosterFlags_DisableApprox
+
+        n_bytes = native._unsafe.MeasureBooster(
+            Native._make_pointer(self.dataset, np.ubyte),
+            Native._make_pointer(self.bag, np.int8, is_null_allowed=True),
+            len(dimension_counts),
+            Native._make_pointer(dimension_counts, np.int64),
+            Native._make_pointer(feature_indexes, np.int64),
+            self.n_inner_bags,
+            flags,
+            native.acceleration,
+            self.objective.encode("ascii"),
+            Native._make_pointer(
+                self.experimental_params, np.float64, is_null_allowed=True
+            ),
+            self.max_bytes,
+        )
+        if n_bytes < 0:  # pragma: no cover
+            raise Native._get_native_exception(n_bytes, "MeasureBooster")
+        return n_bytes
+
+    def __enter__(self):
+        _log.info("Booster allocation start")
+
+        dimension_counts, feature_indexes = self._term_arrays()
 
         native = Native.get_native_singleton()
 
@@ -1755,6 +3127,7 @@ class Booster(AbstractContextManager):
             Native._make_pointer(
                 self.experimental_params, np.float64, is_null_allowed=True
             ),
+            self.max_bytes,
             ct.byref(booster_handle),
         )
         if return_code:  # pragma: no cover
@@ -1780,6 +3153,27 @@ class Booster(AbstractContextManager):
 
         _log.info("Deallocation boosting end")
 
+    def set_gradient_sampling(self, rng, top_fraction, other_fraction):
+        """Bins only a sample of the training set on each boosting step (GOSS).
+
+        Args:
+            rng: native random number generator, or None
+            top_fraction: Fraction of samples with the largest gradients that are always kept.
+            other_fraction: Fraction of all samples drawn at random from the rest and upweighted.
+                top_fraction + other_fraction >= 1.0 turns sampling off.
+        """
+
+        native = Native.get_native_singleton()
+
+        return_code = native._unsafe.SetGradientSampling(
+            Native._make_pointer(rng, np.ubyte, is_null_allowed=True),
+            self._booster_handle,
+            top_fraction,
+            other_fraction,
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "SetGradientSampling")
+
     def generate_term_update(
         self,
         rng,
@@ -1958,6 +3352,74 @@ class Booster(AbstractContextManager):
 
         return term_scores
 
+    def get_stats(self, reset=False):
+        """Returns the hot-path counters accumulated since the booster was created or last reset.
+
+        Args:
+            reset: Zero the counters after reading them.
+
+        Returns:
+            A tuple (term_stats, zone_stats) of uint64 arrays with shapes
+            (n_terms, BoosterStat_COUNT, BoosterStatItem_COUNT) and
+            (BoosterStatZone_COUNT, BoosterStat_COUNT, BoosterStatItem_COUNT).
+            The last axis holds the calls, nanoseconds, and bytes.
+        """
+
+        native = Native.get_native_singleton()
+
+        term_stats = np.zeros(
+            (
+                len(self.term_features),
+                Native.BoosterStat_COUNT,
+                Native.BoosterStatItem_COUNT,
+            ),
+            np.uint64,
+        )
+        zone_stats = np.zeros(
+            (
+                Native.BoosterStatZone_COUNT,
+                Native.BoosterStat_COUNT,
+                Native.BoosterStatItem_COUNT,
+            ),
+            np.uint64,
+        )
+
+        return_code = native._unsafe.GetBoosterStats(
+            self._booster_handle,
+            1 if reset else 0,
+            Native._make_pointer(term_stats, np.uint64, 3),
+            Native._make_pointer(zone_stats, np.uint64, 3),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "GetBoosterStats")
+
+        return term_stats, zone_stats
+
+    def get_scratch_stats(self, reset=False):
+        """Returns the scratch memory counters of the boosting steps since the booster was created or last reset.
+
+        Args:
+            reset: Restart the peak and block counters after reading them.
+
+        Returns:
+            A uint64 array of ScratchStat_COUNT items with the peak bytes that one step used,
+            the bytes held between steps, and the number of times the memory was allocated.
+        """
+
+        native = Native.get_native_singleton()
+
+        scratch_stats = np.zeros(Native.ScratchStat_COUNT, np.uint64)
+
+        return_code = native._unsafe.GetBoosterScratchStats(
+            self._booster_handle,
+            1 if reset else 0,
+            Native._make_pointer(scratch_stats, np.uint64),
+        )
+        if return_code:  # pragma: no cover
+            raise Native._get_native_exception(return_code, "GetBoosterScratchStats")
+
+        return scratch_stats
+
     def _get_term_update_splits_dimension(self, dimension_index):
         native = Native.get_native_singleton()
 
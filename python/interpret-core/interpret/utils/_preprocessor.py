@@ -29,7 +29,7 @@ _log = logging.getLogger(__name__)
 _none_list = [None]
 
 
-def _cut_continuous(native, X_col, processing, binning, max_bins, min_samples_bin):
+def _resolve_processing(processing, binning):
     # called under: fit
 
     if (
@@ -42,6 +42,13 @@ def _cut_continuous(native, X_col, processing, binning, max_bins, min_samples_bi
             _log.error(msg)
             raise ValueError(msg)
         processing = binning
+    return processing
+
+
+def _cut_continuous(native, X_col, processing, binning, max_bins, min_samples_bin):
+    # called under: fit
+
+    processing = _resolve_processing(processing, binning)
 
     if processing == "quantile":
         # one bin for missing, one bin for unknown, and # of cuts is one less again
@@ -67,6 +74,41 @@ def _cut_continuous(native, X_col, processing, binning, max_bins, min_samples_bi
     return cuts
 
 
+def _cut_continuous_many(
+    native, X_cols, processings, binning, max_bins, min_samples_bin
+):
+    # called under: fit
+
+    # the quantile features are cut together in one native call so that they can be
+    # cut in parallel
+    processings = [_resolve_processing(p, binning) for p in processings]
+    quantile_idxs = [
+        i
+        for i, processing in enumerate(processings)
+        if isinstance(processing, str)
+        and processing in ("quantile", "rounded_quantile")
+    ]
+
+    cuts_list = _none_list * len(X_cols)
+    if len(quantile_idxs) != 0:
+        quantile_cuts = native.cut_quantile_many(
+            [X_cols[i] for i in quantile_idxs],
+            min_samples_bin,
+            [int(processings[i] == "rounded_quantile") for i in quantile_idxs],
+            max_bins - 3,
+        )
+        for i, cuts in zip(quantile_idxs, quantile_cuts):
+            cuts_list[i] = cuts
+
+    for i, (X_col, processing) in enumerate(zip(X_cols, processings)):
+        if cuts_list[i] is None:
+            cuts_list[i] = _cut_continuous(
+                native, X_col, processing, binning, max_bins, min_samples_bin
+            )
+
+    return cuts_list
+
+
 class EBMPreprocessor(BaseEstimator, TransformerMixin):
     """Transformer that preprocesses data to be ready before EBM."""
 
@@ -219,6 +261,9 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
         rng = native.create_rng(normalize_seed(self.random_state))
         is_privacy_bounds_warning = False
         is_privacy_types_warning = False
+        continuous_idxs = []
+        continuous_cols = []
+        continuous_processings = []
         for feature_idx, (feature_type_in, X_col, categories, bad) in enumerate(
             unify_columns(
                 X,
@@ -306,46 +351,17 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
                     )
                     feature_bin_weights.append(0)
                     feature_bin_weights = np.array(feature_bin_weights, np.float64)
+                    bins[feature_idx] = cuts
+                    bin_weights[feature_idx] = feature_bin_weights
                 else:
+                    # cut and discretize these after the loop so that all the
+                    # features go to the native code together
                     min_feature_val = np.nanmin(X_col)
                     max_feature_val = np.nanmax(X_col)
-                    cuts = _cut_continuous(
-                        native,
-                        X_col,
-                        feature_type_given,
-                        self.binning,
-                        max_bins,
-                        self.min_samples_bin,
-                    )
-                    bin_indexes = native.discretize(X_col, cuts)
-                    feature_bin_weights = np.bincount(
-                        bin_indexes, weights=sample_weight, minlength=len(cuts) + 3
-                    )
-                    feature_bin_weights = feature_bin_weights.astype(
-                        np.float64, copy=False
-                    )
+                    continuous_idxs.append(feature_idx)
+                    continuous_cols.append(X_col)
+                    continuous_processings.append(feature_type_given)
 
-                    n_cuts = native.get_histogram_cut_count(X_col)
-                    histogram_cuts = native.cut_uniform(X_col, n_cuts)
-                    bin_indexes = native.discretize(X_col, histogram_cuts)
-                    feature_histogram_weights = np.bincount(
-                        bin_indexes,
-                        weights=sample_weight,
-                        minlength=len(histogram_cuts) + 3,
-                    )
-                    feature_histogram_weights = feature_histogram_weights.astype(
-                        np.float64, copy=False
-                    )
-
-                    histogram_weights[feature_idx] = feature_histogram_weights
-
-                    n_missing = len(X_col)
-                    X_col = X_col[~np.isnan(X_col)]
-                    n_missing = n_missing - len(X_col)
-                    missing_val_counts[feature_idx] = n_missing
-                    unique_val_counts[feature_idx] = len(np.unique(X_col))
-
-                bins[feature_idx] = cuts
                 feature_bounds[(feature_idx, 0)] = min_feature_val
                 feature_bounds[(feature_idx, 1)] = max_feature_val
             else:
@@ -418,7 +434,53 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
                     )
                     unique_val_counts[feature_idx] = len(categories)
                 bins[feature_idx] = categories
-            bin_weights[feature_idx] = feature_bin_weights
+                bin_weights[feature_idx] = feature_bin_weights
+
+        if len(continuous_idxs) != 0:
+            cuts_list = _cut_continuous_many(
+                native,
+                continuous_cols,
+                continuous_processings,
+                self.binning,
+                max_bins,
+                self.min_samples_bin,
+            )
+            histogram_cuts_list = [
+                native.cut_uniform(X_col, native.get_histogram_cut_count(X_col))
+                for X_col in continuous_cols
+            ]
+            # the bins and the histogram bins are discretized in one native call
+            all_bin_indexes = native.discretize_many(
+                continuous_cols + continuous_cols, cuts_list + histogram_cuts_list
+            )
+            n_continuous = len(continuous_idxs)
+            for i, (feature_idx, X_col, cuts, histogram_cuts) in enumerate(
+                zip(continuous_idxs, continuous_cols, cuts_list, histogram_cuts_list)
+            ):
+                feature_bin_weights = np.bincount(
+                    all_bin_indexes[i], weights=sample_weight, minlength=len(cuts) + 3
+                )
+                feature_bin_weights = feature_bin_weights.astype(np.float64, copy=False)
+
+                feature_histogram_weights = np.bincount(
+                    all_bin_indexes[n_continuous + i],
+                    weights=sample_weight,
+                    minlength=len(histogram_cuts) + 3,
+                )
+                feature_histogram_weights = feature_histogram_weights.astype(
+                    np.float64, copy=False
+                )
+
+                histogram_weights[feature_idx] = feature_histogram_weights
+
+                n_missing = len(X_col)
+                X_col = X_col[~np.isnan(X_col)]
+                n_missing = n_missing - len(X_col)
+                missing_val_counts[feature_idx] = n_missing
+                unique_val_counts[feature_idx] = len(np.unique(X_col))
+
+                bins[feature_idx] = cuts
+                bin_weights[feature_idx] = feature_bin_weights
 
         if is_privacy_bounds_warning:
             warn(
@@ -472,6 +534,9 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
             cols = unify_columns(
                 X, requests, self.feature_names_in_, self.feature_types_in_, None, False
             )
+            continuous_idxs = []
+            continuous_cols = []
+            continuous_cuts = []
             for feature_idx, bins, (_, X_col, _, _) in zip(count(), self.bins_, cols):
                 if n_samples != len(X_col):
                     msg = "The columns of X are mismatched in the number of of samples"
@@ -479,13 +544,16 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
                     raise ValueError(msg)
 
                 if not isinstance(bins, dict):
-                    # continuous feature
+                    # continuous feature.  Discretized together after the loop
 
                     if not X_col.flags.c_contiguous:
                         # X_col could be a slice that has a stride.  We need contiguous for caling into C
                         X_col = X_col.copy()
 
-                    X_col = native.discretize(X_col, bins)
+                    continuous_idxs.append(feature_idx)
+                    continuous_cols.append(X_col)
+                    continuous_cuts.append(bins)
+                    continue
 
                 if np.count_nonzero(X_col) != len(X_col):
                     msg = "missing values in X not supported in transform"
@@ -494,6 +562,16 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
 
                 X_binned[:, feature_idx] = X_col
 
+            if len(continuous_idxs) != 0:
+                bin_indexes = native.discretize_many(continuous_cols, continuous_cuts)
+                for feature_idx, X_col in zip(continuous_idxs, bin_indexes):
+                    if np.count_nonzero(X_col) != len(X_col):
+                        msg = "missing values in X not supported in transform"
+                        _log.error(msg)
+                        raise ValueError(msg)
+
+                    X_binned[:, feature_idx] = X_col
+
         return X_binned
 
     def fit_transform(self, X, y=None, sample_weight=None):
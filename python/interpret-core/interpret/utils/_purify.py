@@ -64,16 +64,20 @@ def purify(scores, weights, tolerance=0.0, is_randomized=True):
         scores.shape[-1] if scores.ndim != weights.ndim else 1, np.float64
     )
     for n_dimensions in range(n_dim, 1, -1):
-        for dims in range(n_possible):
-            items = prev_level[dims]
-            if items is None:
-                continue
-            level_scores, level_weights = items
+        # the tensors within a level are independent, so purify them together
+        level_dims = [
+            dims for dims in range(n_possible) if prev_level[dims] is not None
+        ]
+        level_results, _, _ = native.purify_many(
+            [prev_level[dims][0] for dims in level_dims],
+            [prev_level[dims][1] for dims in level_dims],
+            tolerance,
+            is_randomized,
+        )
+        for dims, (level_impurities, level_intercept) in zip(level_dims, level_results):
+            level_scores, level_weights = prev_level[dims]
             prev_level[dims] = None
 
-            level_impurities, level_intercept = native.purify(
-                level_scores, level_weights, tolerance, is_randomized
-            )
             intercept += level_intercept
             if dims != 0:
                 # do not insert the original score tensor into the impurities
@@ -102,15 +106,16 @@ def purify(scores, weights, tolerance=0.0, is_randomized=True):
         next_level = prev_level
         prev_level = temp
 
-    for dims in range(n_possible):
-        items = prev_level[dims]
-        if items is None:
-            continue
-        level_scores, level_weights = items
+    level_dims = [dims for dims in range(n_possible) if prev_level[dims] is not None]
+    level_results, _, _ = native.purify_many(
+        [prev_level[dims][0] for dims in level_dims],
+        [prev_level[dims][1] for dims in level_dims],
+        tolerance,
+        is_randomized,
+    )
+    for dims, (_, level_intercept) in zip(level_dims, level_results):
+        level_scores, level_weights = prev_level[dims]
 
-        _, level_intercept = native.purify(
-            level_scores, level_weights, tolerance, is_randomized
-        )
         intercept += level_intercept
 
         if dims != 0:
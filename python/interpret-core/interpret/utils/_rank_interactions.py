@@ -11,7 +11,7 @@ of the interaction of all pairs of features in a dataset.
 
 import heapq
 
-from ._native import InteractionDetector
+from ._native import InteractionDetector, Native
 
 
 def rank_interactions(
@@ -34,6 +34,11 @@ def rank_interactions(
     n_output_interactions=0,
 ):
     try:
+        if isinstance(dataset, str):
+            # a path written by Native.write_dataset_file, which lets workers share one mapped copy
+            dataset = Native.get_native_singleton().map_dataset_file(dataset)
+            create_interaction_flags |= Native.CreateInteractionFlags_CheckedDataSet
+
         interaction_strengths = []
         with InteractionDetector(
             dataset,
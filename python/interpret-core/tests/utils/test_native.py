@@ -1,8 +1,11 @@
 # Copyright (c) 2023 The InterpretML Contributors
 # Distributed under the MIT software license
 
+import json
+
 import numpy as np
-from interpret.utils._native import Native
+import pytest
+from interpret.utils._native import Booster, DataSetBuilder, Native
 from scipy.stats import normaltest, shapiro
 
 
@@ -63,6 +66,209 @@ def test_cut_winsorized():
     assert bin_counts[0] == 1
 
 
+def test_cut_quantile_sketch():
+    rng = np.random.default_rng(0)
+    X_col = rng.lognormal(size=100000)
+    X_col[::97] = np.nan
+
+    native = Native.get_native_singleton()
+
+    # small columns are cut exactly like cut_quantile
+    sketch = native.make_quantile_sketch(1024)
+    native.add_quantile_sketch(sketch, X_col[:500])
+    expected = native.cut_quantile(X_col[:500], 1, 0, 10)
+    assert np.array_equal(expected, native.cut_quantile_sketch(sketch, 1, 0, 10))
+
+    # sketches of separate chunks can be merged
+    sketch = native.make_quantile_sketch(1024)
+    for start in range(0, len(X_col), 10000):
+        partial = native.make_quantile_sketch(1024)
+        native.add_quantile_sketch(partial, X_col[start : start + 10000])
+        native.merge_quantile_sketch(sketch, partial)
+
+    cuts = native.cut_quantile_sketch(sketch, 1, 0, 9)
+    bin_indexes = native.discretize(X_col, cuts)
+    bin_counts = np.bincount(bin_indexes, minlength=len(cuts) + 2)
+
+    assert len(cuts) == 9
+    assert bin_counts[0] == np.sum(np.isnan(X_col))
+    expected_count = (len(X_col) - bin_counts[0]) / 10
+    assert np.all(np.abs(bin_counts[1:-1] - expected_count) < 0.05 * expected_count)
+
+
+def test_cut_quantile_many_discretize_many():
+    rng = np.random.default_rng(0)
+    X_cols = [rng.normal(size=1000), rng.integers(0, 5, 1000).astype(np.float64)]
+    X_cols[0][::7] = np.nan
+
+    native = Native.get_native_singleton()
+
+    cuts_list = native.cut_quantile_many(X_cols, [1, 3], 0, [10, 20])
+    bin_indexes = native.discretize_many(X_cols, cuts_list)
+
+    assert bin_indexes.shape == (2, 1000)
+    for X_col, cuts, bins, min_samples_bin, max_cuts in zip(
+        X_cols, cuts_list, bin_indexes, [1, 3], [10, 20]
+    ):
+        expected = native.cut_quantile(X_col, min_samples_bin, 0, max_cuts)
+        assert np.array_equal(expected, cuts)
+        assert np.array_equal(native.discretize(X_col, cuts), bins)
+
+
+def test_purify_many():
+    rng = np.random.default_rng(0)
+    scores_list = [
+        rng.normal(size=(3, 4)),
+        rng.normal(size=(2, 2, 3)),
+        rng.normal(size=(3, 4, 3)),
+        rng.normal(size=5),
+    ]
+    weights_list = [rng.random(scores.shape) + 0.1 for scores in scores_list[:2]]
+    weights_list.append(rng.random((3, 4)) + 0.1)  # multiclass scores have 3 classes
+    weights_list.append(rng.random(5) + 0.1)
+
+    native = Native.get_native_singleton()
+
+    purified_list = [scores.copy() for scores in scores_list]
+    with pytest.raises(ValueError):
+        # the multiclass tensor needs the same number of scores as the others
+        native.purify_many(purified_list, weights_list, 0.0, True)
+
+    del scores_list[2], weights_list[2]
+    purified_list = [scores.copy() for scores in scores_list]
+    results, iterations, converged = native.purify_many(
+        purified_list, weights_list, 0.0, True
+    )
+    for scores, weights, purified, (impurities, intercept) in zip(
+        scores_list, weights_list, purified_list, results
+    ):
+        expected = scores.copy()
+        expected_impurities, expected_intercept = native.purify(
+            expected, weights, 0.0, True
+        )
+        assert np.array_equal(expected, purified)
+        assert np.array_equal(expected_intercept, intercept)
+        assert len(expected_impurities) == len(impurities)
+        for expected_impurity, impurity in zip(expected_impurities, impurities):
+            assert np.array_equal(expected_impurity, impurity)
+    assert np.all(converged)
+    assert np.all(iterations[:2] >= 1)
+    assert iterations[2] == 0
+
+    # opting into the thread pool purifies the tensors in parallel with the same results
+    try:
+        native.set_thread_pool(2)
+        parallel_list = [scores.copy() for scores in scores_list]
+        _, parallel_iterations, _ = native.purify_many(
+            parallel_list, weights_list, 0.0, True
+        )
+    finally:
+        native.set_thread_pool(1)
+    for purified, parallel in zip(purified_list, parallel_list):
+        assert np.array_equal(purified, parallel)
+    assert np.array_equal(iterations, parallel_iterations)
+
+    _, iterations, converged = native.purify_many(
+        [scores_list[1].copy()], [weights_list[1]], 0.0, True, max_iterations=1
+    )
+    assert iterations[0] == 1
+    assert not converged[0]
+
+
+def test_harmonize_tensors():
+    native = Native.get_native_singleton()
+
+    # old bins: missing, below the cut, above the cut, unknown.  The new grid splits
+    # the old upper bin in two, and each half takes half of the weight
+    projection = (
+        np.array([0, 1, 2, 3, 4, 5], np.int64),
+        np.array([0, 1, 2, 2, 3], np.int64),
+        np.array([1.0, 1.0, 0.5, 0.5, 1.0], np.float64),
+    )
+    weights = np.array([1.0, 4.0, 6.0, 0.0], np.float64)
+    (harmonized,) = native.harmonize_tensors((5,), 1, [projection], [weights], [None])
+    assert np.array_equal(harmonized, [1.0, 4.0, 3.0, 3.0, 0.0])
+
+    # the middle new bin of the second dimension covers both old bins, so its
+    # scores are the average weighted by the old bin weights
+    projection = (
+        np.array([0, 1, 2, 3, 5, 6], np.int64),
+        np.array([0, 1, 0, 0, 1, 1], np.int64),
+        np.ones(5, np.float64),
+    )
+    scores = np.array(
+        [[[1.0, 10.0], [3.0, 30.0]], [[5.0, 50.0], [7.0, 70.0]]], np.float64
+    )
+    weights = np.array([[1.0, 3.0], [2.0, 0.0]], np.float64)
+    harmonized_list = native.harmonize_tensors(
+        (2, 3), 2, [projection, projection], [scores, scores], [weights, weights]
+    )
+    expected = [
+        [[1.0, 10.0], [2.5, 25.0], [3.0, 30.0]],
+        [[5.0, 50.0], [5.0, 50.0], [7.0, 70.0]],
+    ]
+    for harmonized in harmonized_list:
+        assert np.array_equal(harmonized, expected)
+
+    # opting into the thread pool re-bins the tensors in parallel with the same results
+    try:
+        native.set_thread_pool(2)
+        harmonized_list = native.harmonize_tensors(
+            (2, 3), 2, [projection] * 3, [scores] * 3, [weights] * 3
+        )
+    finally:
+        native.set_thread_pool(1)
+    for harmonized in harmonized_list:
+        assert np.array_equal(harmonized, expected)
+
+
+def test_thread_pool_and_parallel_for():
+    from concurrent.futures import ThreadPoolExecutor
+
+    rng = np.random.default_rng(0)
+    X_cols = [rng.normal(size=1000) for _ in range(4)]
+
+    native = Native.get_native_singleton()
+    expected_cuts = native.cut_quantile_many(X_cols, [1] * 4, 0, [10] * 4)
+    expected_bins = native.discretize_many(X_cols, expected_cuts)
+
+    try:
+        native.set_thread_pool(2, pin_cores=True)
+        cuts_list = native.cut_quantile_many(X_cols, [1] * 4, 0, [10] * 4)
+        for expected, cuts in zip(expected_cuts, cuts_list):
+            assert np.array_equal(expected, cuts)
+
+        with ThreadPoolExecutor(max_workers=2) as executor:
+            native.set_parallel_for(executor)
+            bin_indexes = native.discretize_many(X_cols, cuts_list)
+            native.set_parallel_for(None)
+        assert np.array_equal(expected_bins, bin_indexes)
+    finally:
+        native.set_parallel_for(None)
+        native.set_thread_pool(1)
+
+
+def test_generate_gaussian_random_parallel():
+    native = Native.get_native_singleton()
+
+    rng = native.create_rng(42)
+    expected = native.generate_gaussian_random_parallel(rng, 10.0, 10000)
+    assert abs(np.mean(expected)) < 0.5
+    assert 9.5 < np.std(expected) < 10.5
+
+    try:
+        native.set_thread_pool(3)
+        rng = native.create_rng(42)
+        result = native.generate_gaussian_random_parallel(rng, 10.0, 10000)
+        assert np.array_equal(expected, result)
+    finally:
+        native.set_thread_pool(1)
+
+    rng = native.create_rng(42)
+    result = native.generate_gaussian_random_parallel(rng, 10.0, 7)
+    assert np.array_equal(expected[:7], result)
+
+
 def test_suggest_graph_bound():
     native = Native.get_native_singleton()
     cuts = [25, 50, 75]
@@ -105,3 +311,165 @@ def test_gaussian_random_number_generator():
 
         assert 0.9 < np.mean(norm_results) < 0.99
         assert 0.9 < np.mean(shapiro_results) < 0.99
+
+
+def test_dataset_builder_matches_fill():
+    native = Native.get_native_singleton()
+    rng = np.random.default_rng(0)
+    n_samples = 1000
+    X_cols = [rng.integers(0, 6, n_samples), rng.integers(1, 10, n_samples)]
+    y = rng.integers(0, 3, n_samples)
+
+    n_bytes = native.measure_dataset_header(2, 0, 1)
+    n_bytes += native.measure_feature(6, True, True, False, X_cols[0])
+    n_bytes += native.measure_feature(11, False, False, True, X_cols[1])
+    n_bytes += native.measure_classification_target(3, y)
+    expected = np.empty(n_bytes, np.ubyte)
+    native.fill_dataset_header(2, 0, 1, expected)
+    native.fill_feature(6, True, True, False, X_cols[0], expected)
+    native.fill_feature(11, False, False, True, X_cols[1], expected)
+    native.fill_classification_target(3, y, expected)
+
+    with DataSetBuilder([6, 11], [False, True], 0, [3]) as builder:
+        for start in range(0, n_samples, 137):
+            for feature_idx, X_col in enumerate(X_cols):
+                builder.append_feature_bins(feature_idx, X_col[start : start + 137])
+            builder.append_targets(y[start : start + 137])
+        dataset = builder.build()
+
+    assert np.array_equal(expected, dataset)
+
+
+def test_booster_stats():
+    native = Native.get_native_singleton()
+    rng = np.random.default_rng(0)
+    n_samples = 500
+    X_cols = [rng.integers(0, 6, n_samples), rng.integers(1, 10, n_samples)]
+    y = X_cols[0] * 0.5 - X_cols[1] + rng.normal(size=n_samples)
+
+    n_bytes = native.measure_dataset_header(2, 0, 1)
+    n_bytes += native.measure_feature(6, True, True, False, X_cols[0])
+    n_bytes += native.measure_feature(11, False, False, False, X_cols[1])
+    n_bytes += native.measure_regression_target(y)
+    dataset = np.empty(n_bytes, np.ubyte)
+    native.fill_dataset_header(2, 0, 1, dataset)
+    native.fill_feature(6, True, True, False, X_cols[0], dataset)
+    native.fill_feature(11, False, False, False, X_cols[1], dataset)
+    native.fill_regression_target(y, dataset)
+
+    bag = np.ones(n_samples, np.int8)
+    bag[::5] = -1
+
+    n_rounds = 4
+    with Booster(
+        dataset,
+        bag,
+        None,
+        [[0], [1], [0, 1]],
+        0,
+        None,
+        Native.CreateBoosterFlags_Default,
+        "rmse",
+        None,
+    ) as booster:
+        for _ in range(n_rounds):
+            for term_idx in range(3):
+                booster.generate_term_update(
+                    None,
+                    term_idx,
+                    Native.TermBoostFlags_Default,
+                    0.01,
+                    2,
+                    0.0,
+                    0.0,
+                    0.0,
+                    0.0,
+                    3,
+                    None,
+                )
+                booster.apply_term_update()
+
+        term_stats, zone_stats = booster.get_stats(reset=True)
+        reset_stats, _ = booster.get_stats()
+
+    calls = term_stats[:, :, Native.BoosterStatItem_Calls]
+    assert term_stats.shape == (
+        3,
+        Native.BoosterStat_COUNT,
+        Native.BoosterStatItem_COUNT,
+    )
+    # each round records one call per subset, and SIMD zones can split a set in several
+    for stat in (Native.BoosterStat_ApplyUpdate, Native.BoosterStat_Validation):
+        assert np.all(calls[:, stat] >= n_rounds)
+        assert np.all(calls[:, stat] % n_rounds == 0)
+    assert np.all(calls[:, Native.BoosterStat_BinSums] >= n_rounds)
+    assert np.all(calls[:2, Native.BoosterStat_TensorTotals] == 0)
+    assert calls[2, Native.BoosterStat_TensorTotals] >= n_rounds
+    assert np.all(
+        term_stats[:, Native.BoosterStat_BinSums, Native.BoosterStatItem_Bytes] > 0
+    )
+    zone_calls = zone_stats[:, :, Native.BoosterStatItem_Calls]
+    assert (
+        zone_calls[:, Native.BoosterStat_BinSums].sum()
+        == calls[:, Native.BoosterStat_BinSums].sum()
+    )
+    assert not reset_stats.any()
+
+
+def test_timeline():
+    native = Native.get_native_singleton()
+    rng = np.random.default_rng(0)
+    n_samples = 100
+    X_col = rng.integers(0, 4, n_samples)
+    y = X_col * 0.5 + rng.normal(size=n_samples)
+
+    n_bytes = native.measure_dataset_header(1, 0, 1)
+    n_bytes += native.measure_feature(4, True, True, False, X_col)
+    n_bytes += native.measure_regression_target(y)
+    dataset = np.empty(n_bytes, np.ubyte)
+    native.fill_dataset_header(1, 0, 1, dataset)
+    native.fill_feature(4, True, True, False, X_col, dataset)
+    native.fill_regression_target(y, dataset)
+
+    native.start_timeline()
+    try:
+        with Booster(
+            dataset,
+            None,
+            None,
+            [[0]],
+            0,
+            None,
+            Native.CreateBoosterFlags_Default,
+            "rmse",
+            None,
+        ) as booster:
+            for _ in range(2):
+                booster.generate_term_update(
+                    None,
+                    0,
+                    Native.TermBoostFlags_Default,
+                    0.01,
+                    2,
+                    0.0,
+                    0.0,
+                    0.0,
+                    0.0,
+                    3,
+                    None,
+                )
+                booster.apply_term_update()
+    finally:
+        native.stop_timeline()
+
+    timeline = json.loads(native.get_timeline_json())
+    names = [(event["name"], event["ph"]) for event in timeline["traceEvents"]]
+    assert names.count(("CreateBooster", "B")) == 1
+    assert names.count(("GenerateTermUpdate", "E")) == 2
+    assert names.count(("ApplyTermUpdate", "E")) == 2
+    ends = [
+        event
+        for event in timeline["traceEvents"]
+        if event["name"] == "GenerateTermUpdate" and event["ph"] == "E"
+    ]
+    assert ends[-1]["args"] == {"term": 0, "samples": n_samples}
@@ -19,6 +19,8 @@
 #include "Tensor.hpp"
 #include "BoosterCore.hpp"
 #include "BoosterShell.hpp"
+#include "Timeline.hpp"
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -31,6 +33,84 @@ namespace DEFINED_ZONE_NAME {
 // then we'll output this log message more times than desired, but we can live with that
 static int g_cLogApplyTermUpdate = 10;
 
+struct ApplyUpdateTaskContext final {
+   BoosterShell* m_pBoosterShell;
+   const Term* m_pTerm;
+   size_t m_iTerm;
+   FloatScore* m_aUpdateScores;
+   size_t m_cFloatSize;
+   size_t m_cTrainingSubsets;
+};
+
+static ErrorEbm ApplyUpdateSubsetTask(void* const pContext, const size_t iSubsetSlot) {
+   const ApplyUpdateTaskContext* const pTaskContext = static_cast<const ApplyUpdateTaskContext*>(pContext);
+   BoosterShell* const pBoosterShell = pTaskContext->m_pBoosterShell;
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const Term* const pTerm = pTaskContext->m_pTerm;
+
+   const bool bValidation = pTaskContext->m_cTrainingSubsets <= iSubsetSlot;
+   DataSubsetBoosting* const pSubset = bValidation ?
+         &pBoosterCore->GetValidationSet()->GetSubsets()[iSubsetSlot - pTaskContext->m_cTrainingSubsets] :
+         &pBoosterCore->GetTrainingSet()->GetSubsets()[iSubsetSlot];
+
+   SubsetStat* const pSubsetStat = &pBoosterShell->GetSubsetStats()[iSubsetSlot];
+   pSubsetStat->m_bApplied = false;
+   if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != pTaskContext->m_cFloatSize) {
+      return Error_None;
+   }
+
+   // if there is no validation set, it's pretty hard to know what the metric we'll get for our validation
+   // set we could in theory return anything from zero to infinity or possibly, NaN (probably legally the
+   // best), but we return 0 here because we want to kick our caller out of any loop it might be calling us
+   // in.  Infinity and NaN are odd values that might cause problems in a caller that isn't expecting those
+   // values, so 0 is the safest option, and our caller can avoid the situation entirely by not calling us
+   // with zero count validation sets
+
+   // if the count of training samples is zero, don't update the best term scores (it will stay as all
+   // zeros), and we don't need to update our non-existant training set either C++ doesn't define what
+   // happens when you compare NaN to annother number.  It probably follows IEEE 754, but it isn't
+   // guaranteed, so let's check for zero samples in the validation set this better way
+   // https://stackoverflow.com/questions/31225264/what-is-the-result-of-comparing-a-number-with-nan
+
+   ApplyUpdateBridge data;
+   data.m_cScores = pBoosterCore->GetCountScores();
+   data.m_cPack = 0 == pTerm->GetBitsRequiredMin() ?
+         k_cItemsPerBitPackUndefined :
+         GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+   // for the validation set we're calculating the metric and updating the scores, but we don't use
+   // the gradients, except for the special case of RMSE where the gradients are also the error
+   data.m_bHessianNeeded = !bValidation && pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
+   data.m_bDisableApprox = pBoosterCore->IsDisableApprox();
+   data.m_bValidation = bValidation ? EBM_TRUE : EBM_FALSE;
+   // a metric chosen by SetValidationMetric makes its own pass later, so the objective's metric would be thrown away
+   data.m_bMetricNeeded = bValidation && !pBoosterCore->IsValidationMetric() ? EBM_TRUE : EBM_FALSE;
+   data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp(iSubsetSlot);
+   data.m_aUpdateTensorScores = pTaskContext->m_aUpdateScores;
+   data.m_cSamples = pSubset->GetCountSamples();
+   data.m_aPacked = pSubset->GetTermData(pTaskContext->m_iTerm);
+   data.m_aTargets = pSubset->GetTargetData();
+   data.m_aWeights = bValidation ? pSubset->GetInnerBag(0)->GetWeights() : nullptr;
+   data.m_aSampleScores = pSubset->GetSampleScores();
+   data.m_aGradientsAndHessians = pSubset->GetGradHess();
+   data.m_metricOut = 0.0;
+   const uint64_t tickStart = BoosterShell::GetStatTicks();
+   const ErrorEbm error = pSubset->ObjectiveApplyUpdate(&data);
+   if(Error_None != error) {
+      return error;
+   }
+   pSubsetStat->m_cNanoseconds = BoosterShell::GetStatTicks() - tickStart;
+   // training streams through the sample scores, targets, and the gradients (plus hessians).  Validation streams
+   // through the sample scores, targets, and weights
+   pSubsetStat->m_cBytes = static_cast<uint64_t>(BoosterShell::GetStatSampleBytes(pSubset->GetObjectiveWrapper(),
+         data.m_cSamples,
+         data.m_cPack,
+         bValidation ? data.m_cScores + 1 + (nullptr != data.m_aWeights ? 1 : 0) :
+                       data.m_cScores * (EBM_FALSE != data.m_bHessianNeeded ? size_t{3} : size_t{2}) + 1));
+   pSubsetStat->m_metric = data.m_metricOut;
+   pSubsetStat->m_bApplied = true;
+   return Error_None;
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       BoosterHandle boosterHandle, double* avgValidationMetricOut) {
    ErrorEbm error;
@@ -44,6 +124,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
          static_cast<void*>(boosterHandle),
          static_cast<void*>(avgValidationMetricOut));
 
+   TimelineScope timelineScope(TimelineName_ApplyTermUpdate, IntEbm{-1}, IntEbm{0});
+
    if(LIKELY(nullptr != avgValidationMetricOut)) {
       // returning +inf means that boosting won't consider this to be an improvement.  After a few cycles
       // it should exit with the last model that was good if the error was ignored (it shouldn't be ignored though)
@@ -67,7 +149,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    EBM_ASSERT(iTerm < pBoosterCore->GetCountTerms());
    EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
 
+   timelineScope.SetArgs(
+         static_cast<IntEbm>(iTerm), static_cast<IntEbm>(pBoosterCore->GetTrainingSet()->GetCountSamples()));
+
    pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
+   // nothing from GenerateTermUpdate's scratch memory outlives the term update, so the next step can reuse all of it
+   pBoosterShell->GetScratch()->Reset();
 
    Term* const pTerm = pBoosterCore->GetTerms()[iTerm];
 
@@ -123,99 +210,57 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    // don't want to overflow the values to NaN or +-infinity there, and it's very cheap for us to check for overflows
    // when applying the term score updates
    pBoosterCore->GetCurrentModel()[iTerm]->AddExpandedWithBadValueProtection(aUpdateScores);
+   pBoosterCore->GetDirtyTerms()[iTerm] = true;
 
    double validationMetricAvg = 0.0;
 
    static_assert(std::is_same<FloatBig, FloatScore>::value || std::is_same<FloatSmall, FloatScore>::value,
          "FloatScore must be either FloatBig or FloatSmall");
+   const size_t cTrainingSubsets =
+         0 != pBoosterCore->GetTrainingSet()->GetCountSamples() ? pBoosterCore->GetTrainingSet()->GetCountSubsets() : 0;
+   const size_t cSubsetSlots = pBoosterShell->GetCountSubsetSlots();
+   EBM_ASSERT(cTrainingSubsets <= cSubsetSlots);
+
+   ApplyUpdateTaskContext context;
+   context.m_pBoosterShell = pBoosterShell;
+   context.m_pTerm = pTerm;
+   context.m_iTerm = iTerm;
+   context.m_aUpdateScores = aUpdateScores;
+   context.m_cTrainingSubsets = cTrainingSubsets;
+
    size_t cFloatSize = sizeof(aUpdateScores[0]);
-   bool bIgnored = false;
    while(true) {
-      if(0 != pBoosterCore->GetTrainingSet()->GetCountSamples()) {
-         EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSubsets());
-
-         DataSubsetBoosting* pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-         const DataSubsetBoosting* const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
-         do {
-            if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
-               bIgnored = true;
-            } else {
-               ApplyUpdateBridge data;
-               data.m_cScores = pBoosterCore->GetCountScores();
-               data.m_cPack = 0 == pTerm->GetBitsRequiredMin() ?
-                     k_cItemsPerBitPackUndefined :
-                     GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               data.m_bHessianNeeded = pBoosterCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
-               data.m_bDisableApprox = pBoosterCore->IsDisableApprox();
-               data.m_bValidation = EBM_FALSE;
-               data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
-               data.m_aUpdateTensorScores = aUpdateScores;
-               data.m_cSamples = pSubset->GetCountSamples();
-               data.m_aPacked = pSubset->GetTermData(iTerm);
-               data.m_aTargets = pSubset->GetTargetData();
-               data.m_aWeights = nullptr;
-               data.m_aSampleScores = pSubset->GetSampleScores();
-               data.m_aGradientsAndHessians = pSubset->GetGradHess();
-               data.m_metricOut = 0.0;
-               error = pSubset->ObjectiveApplyUpdate(&data);
-               if(Error_None != error) {
-                  return error;
-               }
-            }
-            ++pSubset;
-         } while(pSubsetsEnd != pSubset);
+      context.m_cFloatSize = cFloatSize;
+
+      // the subsets are independent of each other, so apply them in parallel.  There is normally only one subset
+      // though, and ParallelFor runs a single task on this thread without involving the pool
+      error = ParallelFor(cSubsetSlots, ApplyUpdateSubsetTask, &context);
+      if(Error_None != error) {
+         return error;
       }
 
-      if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
-         EBM_ASSERT(1 <= pBoosterCore->GetValidationSet()->GetCountSubsets());
-
-         DataSubsetBoosting* pSubset = pBoosterCore->GetValidationSet()->GetSubsets();
-         const DataSubsetBoosting* const pSubsetsEnd = pSubset + pBoosterCore->GetValidationSet()->GetCountSubsets();
-         do {
-            if(pSubset->GetObjectiveWrapper()->m_cFloatBytes != cFloatSize) {
-               bIgnored = true;
-            } else {
-               // if there is no validation set, it's pretty hard to know what the metric we'll get for our validation
-               // set we could in theory return anything from zero to infinity or possibly, NaN (probably legally the
-               // best), but we return 0 here because we want to kick our caller out of any loop it might be calling us
-               // in.  Infinity and NaN are odd values that might cause problems in a caller that isn't expecting those
-               // values, so 0 is the safest option, and our caller can avoid the situation entirely by not calling us
-               // with zero count validation sets
-
-               // if the count of training samples is zero, don't update the best term scores (it will stay as all
-               // zeros), and we don't need to update our non-existant training set either C++ doesn't define what
-               // happens when you compare NaN to annother number.  It probably follows IEEE 754, but it isn't
-               // guaranteed, so let's check for zero samples in the validation set this better way
-               // https://stackoverflow.com/questions/31225264/what-is-the-result-of-comparing-a-number-with-nan
-
-               ApplyUpdateBridge data;
-               data.m_cScores = pBoosterCore->GetCountScores();
-               data.m_cPack = 0 == pTerm->GetBitsRequiredMin() ?
-                     k_cItemsPerBitPackUndefined :
-                     GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               // for the validation set we're calculating the metric and updating the scores, but we don't use
-               // the gradients, except for the special case of RMSE where the gradients are also the error
-               data.m_bHessianNeeded = EBM_FALSE;
-               data.m_bDisableApprox = pBoosterCore->IsDisableApprox();
-               data.m_bValidation = EBM_TRUE;
-               data.m_aMulticlassMidwayTemp = pBoosterShell->GetMulticlassMidwayTemp();
-               data.m_aUpdateTensorScores = aUpdateScores;
-               data.m_cSamples = pSubset->GetCountSamples();
-               data.m_aPacked = pSubset->GetTermData(iTerm);
-               data.m_aTargets = pSubset->GetTargetData();
-               data.m_aWeights = pSubset->GetInnerBag(0)->GetWeights();
-               data.m_aSampleScores = pSubset->GetSampleScores();
-               data.m_aGradientsAndHessians = pSubset->GetGradHess();
-               data.m_metricOut = 0.0;
-               error = pSubset->ObjectiveApplyUpdate(&data);
-               if(Error_None != error) {
-                  return error;
-               }
-               validationMetricAvg += data.m_metricOut;
-            }
-            ++pSubset;
-         } while(pSubsetsEnd != pSubset);
+      bool bIgnored = false;
+      const SubsetStat* const aSubsetStats = pBoosterShell->GetSubsetStats();
+      for(size_t iSubsetSlot = 0; iSubsetSlot < cSubsetSlots; ++iSubsetSlot) {
+         const SubsetStat* const pSubsetStat = &aSubsetStats[iSubsetSlot];
+         if(!pSubsetStat->m_bApplied) {
+            bIgnored = true;
+         } else if(iSubsetSlot < cTrainingSubsets) {
+            pBoosterShell->RecordStatNanoseconds(BoosterStat_ApplyUpdate,
+                  iTerm,
+                  pBoosterCore->GetTrainingSet()->GetSubsets()[iSubsetSlot].GetObjectiveWrapper(),
+                  pSubsetStat->m_cNanoseconds,
+                  static_cast<size_t>(pSubsetStat->m_cBytes));
+         } else {
+            pBoosterShell->RecordStatNanoseconds(BoosterStat_Validation,
+                  iTerm,
+                  pBoosterCore->GetValidationSet()->GetSubsets()[iSubsetSlot - cTrainingSubsets].GetObjectiveWrapper(),
+                  pSubsetStat->m_cNanoseconds,
+                  static_cast<size_t>(pSubsetStat->m_cBytes));
+            validationMetricAvg += pSubsetStat->m_metric;
+         }
       }
+
       if(!bIgnored) {
          break;
       }
@@ -247,7 +292,19 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       } while(pUpdateBigEnd != pUpdateBig);
    }
 
-   if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
+   if(pBoosterCore->IsGradientSampling()) {
+      // the training gradients changed, so select the samples that the next GenerateTermUpdate will bin
+      error = pBoosterCore->SampleGradients();
+      if(Error_None != error) {
+         return error;
+      }
+   }
+
+   if(0 != pBoosterCore->GetValidationSet()->GetCountSamples() && pBoosterCore->IsValidationMetric()) {
+      // the metric chosen by SetValidationMetric makes its own pass over the validation scores updated above.  It
+      // is already a weighted average, and it is negated when it should be maximized
+      validationMetricAvg = pBoosterCore->CalcValidationMetric();
+   } else if(0 != pBoosterCore->GetValidationSet()->GetCountSamples()) {
       validationMetricAvg = pBoosterCore->FinishMetric(validationMetricAvg);
 
       if(EBM_FALSE != pBoosterCore->MaximizeMetric()) {
@@ -270,37 +327,31 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    if(LIKELY(validationMetricAvg <= pBoosterCore->GetBestModelMetric())) {
       pBoosterCore->SetBestModelMetric(validationMetricAvg);
 
-      // TODO: We're doing a lot more work here than necessary.  Typically in the early phases we improve
-      // on each boosting step, and in that case we should only need to copy over the term's tensor that
-      // we just improved on since all the other ones are up to date.  Later though we'll get into a stage
-      // where some of the terms will improve on the metric but others won't. At that point if we see
-      // two terms not improve the stopping metric, then we see one that does, we'd need to copy over the
-      // last 3 terms to maintain consistency.  That requires that we keep track of the terms we boosted
-      // on since the last improvement.  This can get even more interesting if we do more than a full boosting
-      // round where a term might have been boosted on a few times.  In that case we only need to overwrite
-      // it once.  We can do this by keeping a set that holds the terms that have been bosted on since the last
-      // improvement and then we would overwrite only those whenever we see an improvement. Instead of a set though
-      // we could instead maintan a reversed linked list of terms that we've boosted on using a flat array
-      // with 1 pointer entry for each term.  If a term is already in the linked list there is no need to add it
-      // again.  This way we can avoid a sweep of the entire list of terms on each boosting round.
-      // Or just use an array of bools (1 per term) and sweep the array of bools each time. Since it's co-located
-      // doing the sweep will be fast and resetting to zero is easy with memset
-
-      size_t iTermCopy = 0;
-      size_t iTermCopyEnd = pBoosterCore->GetCountTerms();
-      do {
-         if(nullptr != pBoosterCore->GetCurrentModel()[iTermCopy]) {
+      // only the terms boosted since the previous improvement differ between the current and best models.  Early on
+      // that is just the term we applied, and later it is the few terms that did not improve the metric plus this
+      // one.  Sweeping the flags is cheap next to copying even a single tensor, and it avoids copying every tensor
+      bool* const abDirtyTerms = pBoosterCore->GetDirtyTerms();
+      const size_t cTerms = pBoosterCore->GetCountTerms();
+      for(size_t iTermCopy = 0; iTermCopy < cTerms; ++iTermCopy) {
+         if(abDirtyTerms[iTermCopy]) {
+            EBM_ASSERT(nullptr != pBoosterCore->GetCurrentModel()[iTermCopy]);
             EBM_ASSERT(nullptr != pBoosterCore->GetBestModel()[iTermCopy]);
+            const uint64_t tickCopy = BoosterShell::GetStatTicks();
             error = pBoosterCore->GetBestModel()[iTermCopy]->Copy(*pBoosterCore->GetCurrentModel()[iTermCopy]);
             if(Error_None != error) {
                LOG_0(Trace_Verbose, "Exited ApplyTermUpdateInternal with memory allocation error in copy");
                return error;
             }
-         } else {
-            EBM_ASSERT(nullptr == pBoosterCore->GetBestModel()[iTermCopy]);
+            abDirtyTerms[iTermCopy] = false;
+            // charge the copy to the term being copied so that wide tensors stand out
+            pBoosterShell->RecordStat(BoosterStat_BestModelCopy,
+                  iTermCopy,
+                  nullptr,
+                  tickCopy,
+                  sizeof(FloatScore) * pBoosterCore->GetCountScores() *
+                        pBoosterCore->GetTerms()[iTermCopy]->GetCountTensorBins());
          }
-         ++iTermCopy;
-      } while(iTermCopy != iTermCopyEnd);
+      }
    }
 
    if(nullptr != avgValidationMetricOut) {
@@ -317,6 +368,36 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
    return Error_None;
 }
 
+static int g_cLogSetValidationMetric = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetValidationMetric(BoosterHandle boosterHandle, const char* metric) {
+   LOG_COUNTED_N(&g_cLogSetValidationMetric,
+         Trace_Info,
+         Trace_Verbose,
+         "SetValidationMetric: "
+         "boosterHandle=%p, "
+         "metric=%p",
+         static_cast<void*>(boosterHandle),
+         static_cast<const void*>(metric)); // do not print the string for security reasons
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   const ErrorEbm error = pBoosterCore->SetValidationMetric(metric);
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited SetValidationMetric");
+   return Error_None;
+}
+
 // we made this a global because if we had put this variable inside the BoosterCore object, then we would need to
 // dereference that before getting the count.  By making this global we can send a log message incase a bad BoosterCore
 // object is sent into us we only decrease the count if the count is non-zero, so at worst if there is a race condition
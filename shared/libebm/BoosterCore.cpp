@@ -6,6 +6,7 @@
 
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset
 #include <limits> // numeric_limits
 #include <thread>
 
@@ -26,6 +27,7 @@
 #include "TreeNode.hpp" // IsOverflowTreeNodeSize
 #include "SplitPosition.hpp" // IsOverflowSplitPositionSize
 #include "BoosterCore.hpp"
+#include "ThreadPool.hpp" // GetThreadPoolNodes
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -45,6 +47,9 @@ NEVER_INLINE extern ErrorEbm GetObjective(const Config* const pConfig,
       ObjectiveWrapper* const pCpuObjectiveWrapperOut,
       ObjectiveWrapper* const pSIMDObjectiveWrapperOut) noexcept;
 
+NEVER_INLINE extern ErrorEbm GetMetric(
+      const Config* const pConfig, const char* sMetric, MetricWrapper* const pMetricWrapperOut) noexcept;
+
 void BoosterCore::DeleteTensors(const size_t cTerms, Tensor** const apTensors) {
    LOG_0(Trace_Info, "Entered DeleteTensors");
 
@@ -120,9 +125,249 @@ ErrorEbm BoosterCore::InitializeTensors(
    return Error_None;
 }
 
+static size_t GetFastBinBytes(const ObjectiveWrapper* const pObjective, const bool bHessian, const size_t cScores) {
+   if(sizeof(UIntBig) == pObjective->m_cUIntBytes) {
+      if(sizeof(FloatBig) == pObjective->m_cFloatBytes) {
+         return GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pObjective->m_cFloatBytes);
+         return GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
+      }
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == pObjective->m_cUIntBytes);
+      if(sizeof(FloatBig) == pObjective->m_cFloatBytes) {
+         return GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pObjective->m_cFloatBytes);
+         return GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
+      }
+   }
+}
+
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+static size_t GetParallelBinBytesMax(const bool bHessian, const size_t cScores) {
+   if(bHessian) {
+      if(size_t{1} == cScores) {
+         // the caller can specify gradient boosting as an option for an objective with a hessian
+         return EbmMax(HESSIAN_PARALLEL_BIN_BYTES_MAX, GRADIENT_PARALLEL_BIN_BYTES_MAX);
+      } else {
+         return MULTISCORE_PARALLEL_BIN_BYTES_MAX;
+      }
+   } else {
+      if(size_t{1} == cScores) {
+         return GRADIENT_PARALLEL_BIN_BYTES_MAX;
+      } else {
+         // don't allow parallel gradient multiclass boosting. multiclass should be hessian boosting
+         return 0;
+      }
+   }
+}
+#endif
+
+static size_t AddBytes(const size_t cBytes1, const size_t cBytes2) {
+   return IsAddError(cBytes1, cBytes2) ? SIZE_MAX : cBytes1 + cBytes2;
+}
+
+static size_t MultiplyBytes(const size_t cBytes, const size_t cItems) {
+   return IsMultiplyError(cBytes, cItems) ? SIZE_MAX : cBytes * cItems;
+}
+
+static size_t AlignBytes(const size_t cBytes) {
+   return AddBytes(cBytes, SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+}
+
+size_t BoosterCore::MeasureBytes(const size_t cTargets,
+      const size_t cTrainingSamples,
+      const size_t cTrainingSubsetSamplesMax,
+      const size_t cValidationSamples,
+      const size_t cValidationSubsetSamplesMax,
+      const size_t cInnerBags,
+      const bool bPoissonBags,
+      const size_t cWeights,
+      const size_t cTensorBinsMax,
+      const size_t cMainBinsMax,
+      const size_t cSingleDimensionBinsMax) {
+   EBM_ASSERT(1 <= m_cScores);
+   EBM_ASSERT(1 <= m_cTerms);
+   EBM_ASSERT(1 <= cTrainingSubsetSamplesMax);
+   EBM_ASSERT(1 <= cValidationSubsetSamplesMax);
+   EBM_ASSERT(!bPoissonBags || size_t{0} != cInnerBags);
+
+   const size_t cScores = m_cScores;
+   const bool bHessian = IsHessian();
+   const bool bRmse = IsRmse();
+   const TaskEbm task = IdentifyTask(m_objectiveCpu.m_linkFunction);
+   const size_t cInnerBagsAfterZero = size_t{0} == cInnerBags ? size_t{1} : cInnerBags;
+
+   size_t cBytes = 0;
+
+   // the current and best models hold every term at full size, and the term update tensors of the BoosterShell grow
+   // to the largest term
+   size_t cBytesTensorMax = 0;
+   for(size_t iTerm = 0; iTerm < m_cTerms; ++iTerm) {
+      const Term* const pTerm = m_apTerms[iTerm];
+      const size_t cTensorBins = pTerm->GetCountTensorBins();
+      if(size_t{0} != cTensorBins) {
+         size_t cBytesTensor = MultiplyBytes(MultiplyBytes(sizeof(FloatScore), cScores), cTensorBins);
+         for(size_t iDimension = 0; iDimension < pTerm->GetCountDimensions(); ++iDimension) {
+            const size_t cBins = pTerm->GetTermFeatures()[iDimension].m_pFeature->GetCountBins();
+            cBytesTensor = AddBytes(cBytesTensor, MultiplyBytes(sizeof(UIntSplit), cBins));
+         }
+         cBytes = AddBytes(cBytes, MultiplyBytes(cBytesTensor, 2));
+         cBytesTensorMax = EbmMax(cBytesTensorMax, cBytesTensor);
+      }
+   }
+   cBytes = AddBytes(cBytes, MultiplyBytes(cBytesTensorMax, 2));
+
+   if(size_t{0} == cTrainingSamples && size_t{0} == cValidationSamples) {
+      return cBytes;
+   }
+
+   size_t cBytesPerFastBinMax = 0;
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+   const size_t cBytesParallelMax = GetParallelBinBytesMax(bHessian, cScores);
+   size_t cBytesParallelBoostTrainingMax = 0;
+#endif
+   size_t cBytesBagWeightsMax = 0;
+   size_t cBytesMulticlassMidwayMax = 0;
+   size_t cTrainingSubsets = 0;
+   size_t cSubsetSlots = 0;
+
+   for(size_t iSet = 0; iSet < 2; ++iSet) {
+      const bool bTraining = size_t{0} == iSet;
+      const size_t cSamples = bTraining ? cTrainingSamples : cValidationSamples;
+      if(size_t{0} == cSamples) {
+         continue;
+      }
+      const size_t cSubsetSamplesMax = bTraining ? cTrainingSubsetSamplesMax : cValidationSubsetSamplesMax;
+
+      if(size_t{0} != cWeights) {
+         // DataSetBoosting keeps a copy of the caller's weights for the life of the booster
+         cBytes = AddBytes(cBytes, MultiplyBytes(sizeof(FloatShared), cSamples));
+      }
+
+      if(bTraining) {
+         if(size_t{0} != cInnerBags) {
+            // InitBags counts the occurrences of every sample while it draws each bag
+            cBytes = AddBytes(cBytes, cSamples);
+         }
+         for(size_t iTerm = 0; iTerm < m_cTerms; ++iTerm) {
+            const size_t cTensorBins = m_apTerms[iTerm]->GetCountTensorBins();
+            if(size_t{1} != cTensorBins) {
+               const size_t cBytesTermInnerBag = MultiplyBytes(sizeof(UIntMain) + sizeof(FloatPrecomp), cTensorBins);
+               cBytes = AddBytes(cBytes, MultiplyBytes(cBytesTermInnerBag, cInnerBagsAfterZero));
+            }
+         }
+      }
+
+      // cut the subsets the same way InitDataSetBoosting does.  Ranking cuts on query boundaries instead, which only
+      // moves a few samples between subsets
+      size_t cSamplesRemaining = cSamples;
+      do {
+         size_t cSubsetSamples = EbmMin(cSamplesRemaining, cSubsetSamplesMax);
+         const ObjectiveWrapper* pObjective = &m_objectiveCpu;
+         if(size_t{0} != m_objectiveSIMD.m_cSIMDPack && m_objectiveSIMD.m_cSIMDPack <= cSubsetSamples) {
+            cSubsetSamples = cSubsetSamples - cSubsetSamples % m_objectiveSIMD.m_cSIMDPack;
+            pObjective = &m_objectiveSIMD;
+         }
+         EBM_ASSERT(1 <= cSubsetSamples);
+         cSamplesRemaining -= cSubsetSamples;
+
+         const size_t cFloatBytes = pObjective->m_cFloatBytes;
+         const size_t cUIntBytes = pObjective->m_cUIntBytes;
+         const size_t cSIMDPack = pObjective->m_cSIMDPack;
+
+         size_t cBytesPerSample = 0;
+         if(!bRmse) {
+            if(Task_GeneralClassification <= task) {
+               cBytesPerSample = MultiplyBytes(cUIntBytes, cTargets);
+            } else {
+               // ranking targets store the query sizes after the gains
+               cBytesPerSample = MultiplyBytes(cFloatBytes * (Task_Ranking == task ? 2 : 1), cTargets);
+            }
+            cBytesPerSample = AddBytes(cBytesPerSample, MultiplyBytes(cFloatBytes, cScores));
+         }
+         if(bTraining || bRmse) {
+            const size_t cBytesGradHess = cFloatBytes * (bTraining && bHessian ? 2 : 1);
+            cBytesPerSample = AddBytes(cBytesPerSample, MultiplyBytes(cBytesGradHess, cScores));
+         }
+         if(bTraining && !bPoissonBags) {
+            if(size_t{0} != cInnerBags || size_t{0} != cWeights) {
+               cBytesPerSample = AddBytes(cBytesPerSample, MultiplyBytes(cFloatBytes, cInnerBagsAfterZero));
+            }
+         } else if(size_t{0} != cWeights) {
+            cBytesPerSample = AddBytes(cBytesPerSample, cFloatBytes);
+         }
+         cBytes = AddBytes(cBytes, MultiplyBytes(cBytesPerSample, cSubsetSamples));
+
+         for(size_t iTerm = 0; iTerm < m_cTerms; ++iTerm) {
+            const Term* const pTerm = m_apTerms[iTerm];
+            if(size_t{0} != pTerm->GetCountRealDimensions()) {
+               const int cItemsPerBitPack = GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), cUIntBytes);
+               const size_t cParallelDataUnits =
+                     cSubsetSamples / cSIMDPack / static_cast<size_t>(cItemsPerBitPack) + size_t{1};
+               cBytes = AddBytes(cBytes, MultiplyBytes(cUIntBytes * cSIMDPack, cParallelDataUnits));
+            }
+         }
+
+         const size_t cBytesPerFastBin = GetFastBinBytes(pObjective, bHessian, cScores);
+         cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+         if(bTraining && size_t{1} != cSIMDPack) {
+            const size_t cBytesParallelBoostTraining =
+                  EbmMin(MultiplyBytes(MultiplyBytes(cBytesPerFastBin, cTensorBinsMax), cSIMDPack), cBytesParallelMax);
+            cBytesParallelBoostTrainingMax = EbmMax(cBytesParallelBoostTrainingMax, cBytesParallelBoostTraining);
+         }
+#endif
+         if(bTraining) {
+            if(bPoissonBags) {
+               cBytesBagWeightsMax = EbmMax(cBytesBagWeightsMax, MultiplyBytes(cFloatBytes, cSubsetSamples));
+            }
+            ++cTrainingSubsets;
+         }
+         cBytesMulticlassMidwayMax = EbmMax(cBytesMulticlassMidwayMax, MultiplyBytes(cFloatBytes * cSIMDPack, cScores));
+         ++cSubsetSlots;
+      } while(size_t{0} != cSamplesRemaining);
+   }
+
+   // the BoosterShell scratch space.  Every training subset gets its own slot of fast bins and Poisson bag weights,
+   // and every subset gets its own multiclass midway slot
+   size_t cBytesFastBins = MultiplyBytes(cBytesPerFastBinMax, cTensorBinsMax);
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+   cBytesFastBins = EbmMax(cBytesParallelBoostTrainingMax, cBytesFastBins);
+#endif
+   cBytes = AddBytes(cBytes, MultiplyBytes(AlignBytes(cBytesFastBins), EbmMax(size_t{1}, cTrainingSubsets)));
+   if(bPoissonBags) {
+      cBytes = AddBytes(cBytes, MultiplyBytes(AlignBytes(cBytesBagWeightsMax), cTrainingSubsets));
+   }
+   if(size_t{1} != cScores) {
+      cBytes = AddBytes(cBytes, MultiplyBytes(AlignBytes(cBytesMulticlassMidwayMax), cSubsetSlots));
+   }
+
+   if(IsOverflowBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores)) {
+      return SIZE_MAX;
+   }
+   const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, bHessian, cScores);
+   cBytes = AddBytes(cBytes, MultiplyBytes(cBytesPerMainBin, cMainBinsMax));
+
+   if(size_t{0} != cSingleDimensionBinsMax) {
+      if(IsOverflowTreeNodeSize(bHessian, cScores) || IsOverflowSplitPositionSize(bHessian, cScores)) {
+         return SIZE_MAX;
+      }
+      const size_t cSingleDimensionSplitsMax = cSingleDimensionBinsMax - 1;
+      cBytes = AddBytes(cBytes, MultiplyBytes(GetSplitPositionSize(bHessian, cScores), cSingleDimensionSplitsMax));
+      const size_t cTreeNodes = AddBytes(cSingleDimensionSplitsMax, cSingleDimensionBinsMax);
+      cBytes = AddBytes(cBytes, MultiplyBytes(GetTreeNodeSize(bHessian, cScores), cTreeNodes));
+   }
+
+   return cBytes;
+}
+
 BoosterCore::~BoosterCore() {
    // this only gets called after our reference count has been decremented to zero
 
+   free(m_aSampleMagnitudes);
+
    m_trainingSet.DestructDataSetBoosting(m_cTerms, m_cInnerBags);
    m_validationSet.DestructDataSetBoosting(m_cTerms, 0);
 
@@ -132,9 +377,13 @@ BoosterCore::~BoosterCore() {
 
    DeleteTensors(m_cTerms, m_apCurrentTermTensors);
    DeleteTensors(m_cTerms, m_apBestTermTensors);
+   free(m_abDirtyTerms);
 
    FreeObjectiveWrapperInternals(&m_objectiveCpu);
    FreeObjectiveWrapperInternals(&m_objectiveSIMD);
+
+   free(m_aMetricState);
+   FreeMetricWrapperInternals(&m_metric);
 };
 
 void BoosterCore::Free(BoosterCore* const pBoosterCore) {
@@ -273,6 +522,8 @@ ErrorEbm BoosterCore::Create(void* const rng,
       const CreateBoosterFlags flags,
       const AccelerationFlags acceleration,
       const char* const sObjective,
+      const size_t cBytesMax,
+      size_t* const pcBytesMeasureOut,
       BoosterCore** const ppBoosterCoreOut) {
    // experimentalParams isn't used by default.  It's meant to provide an easy way for python or other higher
    // level languages to pass EXPERIMENTAL temporary parameters easily to the C++ code.
@@ -324,12 +575,18 @@ ErrorEbm BoosterCore::Create(void* const rng,
    *ppBoosterCoreOut = pBoosterCore;
 
    pBoosterCore->m_bDisableApprox = CreateBoosterFlags_DisableApprox & flags ? EBM_TRUE : EBM_FALSE;
+   pBoosterCore->m_bHugePages = 0 != (CreateBoosterFlags_HugePages & flags);
 
    UIntShared countSamples;
    size_t cFeatures;
    size_t cWeights;
    size_t cTargets;
-   error = GetDataSetSharedHeader(pDataSetShared, &countSamples, &cFeatures, &cWeights, &cTargets);
+   error = GetDataSetSharedHeader(pDataSetShared,
+         0 != (CreateBoosterFlags_CheckedDataSet & flags),
+         &countSamples,
+         &cFeatures,
+         &cWeights,
+         &cTargets);
    if(Error_None != error) {
       // already logged
       return error;
@@ -349,8 +606,8 @@ ErrorEbm BoosterCore::Create(void* const rng,
       LOG_0(Trace_Warning, "WARNING BoosterCore::Create size_t { 1 } < cWeights");
       return Error_IllegalParamVal;
    }
-   if(size_t{1} != cTargets) {
-      LOG_0(Trace_Warning, "WARNING BoosterCore::Create 1 != cTargets");
+   if(size_t{0} == cTargets) {
+      LOG_0(Trace_Warning, "WARNING BoosterCore::Create 0 == cTargets");
       return Error_IllegalParamVal;
    }
 
@@ -593,12 +850,47 @@ ErrorEbm BoosterCore::Create(void* const rng,
       return Error_IllegalParamVal;
    }
 
+   if(size_t{1} != cTargets) {
+      // multitask models give each target one score, so the targets must all be regression or all be binary
+      // classification.  Multiclass targets would need jagged score blocks per target, which we do not support yet
+      if(CreateBoosterFlags_BinaryAsMulticlass & flags) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::Create multitask cannot use CreateBoosterFlags_BinaryAsMulticlass");
+         return Error_IllegalParamVal;
+      }
+      size_t iTarget = 0;
+      do {
+         ptrdiff_t cTargetClasses;
+         if(nullptr == GetDataSetSharedTarget(pDataSetShared, iTarget, &cTargetClasses)) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create cTargetClasses cannot fit into ptrdiff_t");
+            return Error_IllegalParamVal;
+         }
+         if((ptrdiff_t{Task_GeneralClassification} <= cClasses) !=
+               (ptrdiff_t{Task_GeneralClassification} <= cTargetClasses)) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create multitask targets must all be the same type");
+            return Error_IllegalParamVal;
+         }
+         if(ptrdiff_t{Task_BinaryClassification} < cTargetClasses) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create multitask targets cannot be multiclass");
+            return Error_IllegalParamVal;
+         }
+         if(ptrdiff_t{Task_Ranking} == cTargetClasses) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create multitask targets cannot be ranking targets");
+            return Error_IllegalParamVal;
+         }
+         // a target that has only 1 class in this data is still given a score when the other targets need one
+         cClasses = EbmMax(cClasses, cTargetClasses);
+         ++iTarget;
+      } while(cTargets != iTarget);
+   }
+
    // having 1 class means that all predictions are perfect. In the C interface we reduce this into having 0 scores,
    // which means that we do not write anything to our upper level callers, and we don't need a bunch of things
    // since they have zero memory allocated to them. Having 0 classes means there are also 0 samples.
    if(ptrdiff_t{0} != cClasses && ptrdiff_t{1} != cClasses) {
       size_t cScores;
-      if(CreateBoosterFlags_BinaryAsMulticlass & flags) {
+      if(size_t{1} != cTargets) {
+         cScores = cTargets;
+      } else if(CreateBoosterFlags_BinaryAsMulticlass & flags) {
          cScores = cClasses < ptrdiff_t{2} ? size_t{1} : static_cast<size_t>(cClasses);
       } else {
          cScores = cClasses <= ptrdiff_t{2} ? size_t{1} : static_cast<size_t>(cClasses);
@@ -608,7 +900,9 @@ ErrorEbm BoosterCore::Create(void* const rng,
       LOG_0(Trace_Info, "INFO BoosterCore::Create determining Objective");
       Config config;
       config.cOutputs = cScores;
+      config.cTargets = cTargets;
       config.isDifferentialPrivacy = CreateBoosterFlags_DifferentialPrivacy & flags ? EBM_TRUE : EBM_FALSE;
+      config.linkFunction = Link_ERROR;
       error = GetObjective(
             &config, sObjective, acceleration, &pBoosterCore->m_objectiveCpu, &pBoosterCore->m_objectiveSIMD);
       if(Error_None != error) {
@@ -623,6 +917,12 @@ ErrorEbm BoosterCore::Create(void* const rng,
             LOG_0(Trace_Error, "ERROR BoosterCore::Create mismatch in objective class model type");
             return Error_IllegalParamVal;
          }
+      } else if(ptrdiff_t{Task_Ranking} == cClasses) {
+         // ranking objectives need the query groups that only a ranking target has, and the reverse
+         if(Task_Ranking != task) {
+            LOG_0(Trace_Error, "ERROR BoosterCore::Create mismatch in objective class model type");
+            return Error_IllegalParamVal;
+         }
       } else {
          if(Task_Regression != task) {
             LOG_0(Trace_Error, "ERROR BoosterCore::Create mismatch in objective class model type");
@@ -631,10 +931,17 @@ ErrorEbm BoosterCore::Create(void* const rng,
       }
       if(0 != cTerms) {
          if(0 != cSamples) {
-            if(EBM_FALSE != pBoosterCore->CheckTargets(cSamples, aTargets)) {
-               LOG_0(Trace_Warning, "WARNING BoosterCore::Create invalid target value");
-               return Error_ObjectiveIllegalTarget;
-            }
+            size_t iTarget = 0;
+            do {
+               ptrdiff_t cTargetClasses;
+               const void* const aTargetsCheck = GetDataSetSharedTarget(pDataSetShared, iTarget, &cTargetClasses);
+               EBM_ASSERT(nullptr != aTargetsCheck); // we previously called GetDataSetSharedTarget on every target
+               if(EBM_FALSE != pBoosterCore->CheckTargets(cSamples, aTargetsCheck)) {
+                  LOG_0(Trace_Warning, "WARNING BoosterCore::Create invalid target value");
+                  return Error_ObjectiveIllegalTarget;
+               }
+               ++iTarget;
+            } while(cTargets != iTarget);
             LOG_0(Trace_Info, "INFO BoosterCore::Create Targets verified");
 
             if(CheckBoosterRestrictions(pBoosterCore, &pBoosterCore->m_objectiveCpu, cTensorBinsMax)) {
@@ -666,6 +973,72 @@ ErrorEbm BoosterCore::Create(void* const rng,
 
             const bool bHessian = pBoosterCore->IsHessian();
 
+            size_t cTrainingSubsetSamplesMax = bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX;
+            size_t cValidationSubsetSamplesMax = cTrainingSubsetSamplesMax;
+
+            // when the worker pool spans several NUMA nodes, split large sets so that every node gets subsets to
+            // work on from its own memory.  Smaller sets are not worth the cross node synchronization
+            int aNumaNodes[k_cNumaNodesMax];
+            size_t cNumaNodes = GetThreadPoolNodes(aNumaNodes);
+            if(size_t{0} != cNumaNodes) {
+               static constexpr size_t k_cNumaSubsetSamplesMin = 65536;
+               if(k_cNumaSubsetSamplesMin * cNumaNodes <= cTrainingSamples) {
+                  cTrainingSubsetSamplesMax =
+                        EbmMin(cTrainingSubsetSamplesMax, (cTrainingSamples - 1) / cNumaNodes + 1);
+               }
+               if(k_cNumaSubsetSamplesMin * cNumaNodes <= cValidationSamples) {
+                  cValidationSubsetSamplesMax =
+                        EbmMin(cValidationSubsetSamplesMax, (cValidationSamples - 1) / cNumaNodes + 1);
+               }
+            }
+
+            // with a budget, give up memory hungry choices one at a time until the booster fits.  The float width is
+            // already the narrowest that the allowed acceleration offers, since the SIMD zones are float32 and are
+            // picked whenever they are available
+            bool bPoissonBags = size_t{0} != cInnerBags && 0 != (CreateBoosterFlags_PoissonBags & flags);
+            size_t cBytes;
+            while(true) {
+               cBytes = pBoosterCore->MeasureBytes(cTargets,
+                     cTrainingSamples,
+                     cTrainingSubsetSamplesMax,
+                     cValidationSamples,
+                     cValidationSubsetSamplesMax,
+                     cInnerBags,
+                     bPoissonBags,
+                     cWeights,
+                     cTensorBinsMax,
+                     cMainBinsMax,
+                     cSingleDimensionBinsMax);
+               if(cBytes <= cBytesMax) {
+                  break;
+               }
+               if(size_t{0} != cInnerBags && !bPoissonBags) {
+                  // Poisson bags regenerate each inner bag's weights when they are used instead of storing them
+                  LOG_0(Trace_Info, "INFO BoosterCore::Create switching to Poisson bags to fit the memory budget");
+                  bPoissonBags = true;
+               } else if(size_t{0} != cNumaNodes) {
+                  // every subset needs its own slots of scratch bins, so stop splitting the sets across NUMA nodes
+                  LOG_0(Trace_Info, "INFO BoosterCore::Create dropping NUMA subsets to fit the memory budget");
+                  cNumaNodes = 0;
+                  cTrainingSubsetSamplesMax = bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX;
+                  cValidationSubsetSamplesMax = cTrainingSubsetSamplesMax;
+               } else {
+                  break;
+               }
+            }
+            if(nullptr != pcBytesMeasureOut) {
+               *pcBytesMeasureOut = cBytes;
+               LOG_0(Trace_Info, "Exited BoosterCore::Create after measuring");
+               return Error_None;
+            }
+            if(cBytesMax < cBytes) {
+               LOG_N(Trace_Warning,
+                     "WARNING BoosterCore::Create needs %zu bytes, which is more than the budget of %zu bytes",
+                     cBytes,
+                     cBytesMax);
+               return Error_OutOfMemory;
+            }
+
             pBoosterCore->m_cInnerBags = cInnerBags; // this is used to destruct m_trainingSet, so store it first
             error = pBoosterCore->m_trainingSet.InitDataSetBoosting(true,
                   bHessian,
@@ -674,7 +1047,7 @@ ErrorEbm BoosterCore::Create(void* const rng,
                   true,
                   rng,
                   cScores,
-                  bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX,
+                  cTrainingSubsetSamplesMax,
                   &pBoosterCore->m_objectiveCpu,
                   &pBoosterCore->m_objectiveSIMD,
                   pDataSetShared,
@@ -684,10 +1057,14 @@ ErrorEbm BoosterCore::Create(void* const rng,
                   aInitScores,
                   cTrainingSamples,
                   cInnerBags,
+                  bPoissonBags,
                   cWeights,
                   cTerms,
                   pBoosterCore->m_apTerms,
-                  aiTermFeatures);
+                  aiTermFeatures,
+                  cNumaNodes,
+                  aNumaNodes,
+                  0);
             if(Error_None != error) {
                return error;
             }
@@ -699,7 +1076,7 @@ ErrorEbm BoosterCore::Create(void* const rng,
                   false,
                   rng,
                   cScores,
-                  bForceMultipleSubsets ? k_cSubsetSamplesMax : SIZE_MAX,
+                  cValidationSubsetSamplesMax,
                   &pBoosterCore->m_objectiveCpu,
                   &pBoosterCore->m_objectiveSIMD,
                   pDataSetShared,
@@ -709,32 +1086,21 @@ ErrorEbm BoosterCore::Create(void* const rng,
                   aInitScores,
                   cValidationSamples,
                   0,
+                  false,
                   cWeights,
                   cTerms,
                   pBoosterCore->m_apTerms,
-                  aiTermFeatures);
+                  aiTermFeatures,
+                  cNumaNodes,
+                  aNumaNodes,
+                  pBoosterCore->m_trainingSet.GetCountSubsets());
             if(Error_None != error) {
                return error;
             }
 
             size_t cBytesPerFastBinMax = 0;
 #if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
-            size_t cBytesParallelMax;
-            if(bHessian) {
-               if(size_t {1} == cScores) {
-                  // the caller can specify gradient boosting as an option for an objective with a hessian
-                  cBytesParallelMax = EbmMax(HESSIAN_PARALLEL_BIN_BYTES_MAX, GRADIENT_PARALLEL_BIN_BYTES_MAX);
-               } else {
-                  cBytesParallelMax = MULTISCORE_PARALLEL_BIN_BYTES_MAX;
-               }
-            } else {
-               if(size_t {1} == cScores) {
-                  cBytesParallelMax = GRADIENT_PARALLEL_BIN_BYTES_MAX;
-               } else {
-                  // don't allow parallel gradient multiclass boosting. multiclass should be hessian boosting
-                  cBytesParallelMax = 0;
-               }
-            }
+            const size_t cBytesParallelMax = GetParallelBinBytesMax(bHessian, cScores);
             size_t cBytesParallelBoostTrainingMax = 0;
 #endif
 
@@ -743,23 +1109,8 @@ ErrorEbm BoosterCore::Create(void* const rng,
                const DataSubsetBoosting* const pSubsetsEnd =
                      pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
                do {
-                  size_t cBytesPerFastBin;
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
-                     }
-                  } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
-                     }
-                  }
+                  const size_t cBytesPerFastBin =
+                        GetFastBinBytes(pSubset->GetObjectiveWrapper(), bHessian, cScores);
                   cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
 
 #if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
@@ -787,23 +1138,8 @@ ErrorEbm BoosterCore::Create(void* const rng,
                const DataSubsetBoosting* const pSubsetsEnd =
                      pSubset + pBoosterCore->GetValidationSet()->GetCountSubsets();
                do {
-                  size_t cBytesPerFastBin;
-                  if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
-                     }
-                  } else {
-                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-                     if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                        cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
-                     } else {
-                        EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                        cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
-                     }
-                  }
+                  const size_t cBytesPerFastBin =
+                        GetFastBinBytes(pSubset->GetObjectiveWrapper(), bHessian, cScores);
                   cBytesPerFastBinMax = EbmMax(cBytesPerFastBinMax, cBytesPerFastBin);
                   ++pSubset;
                } while(pSubsetsEnd != pSubset);
@@ -876,6 +1212,31 @@ ErrorEbm BoosterCore::Create(void* const rng,
                EBM_ASSERT(0 == pBoosterCore->m_cBytesTreeNodes);
             }
          }
+         if(0 == cSamples) {
+            const size_t cBytes = pBoosterCore->MeasureBytes(cTargets,
+                  0,
+                  SIZE_MAX,
+                  0,
+                  SIZE_MAX,
+                  cInnerBags,
+                  false,
+                  cWeights,
+                  cTensorBinsMax,
+                  cMainBinsMax,
+                  cSingleDimensionBinsMax);
+            if(nullptr != pcBytesMeasureOut) {
+               *pcBytesMeasureOut = cBytes;
+               LOG_0(Trace_Info, "Exited BoosterCore::Create after measuring");
+               return Error_None;
+            }
+            if(cBytesMax < cBytes) {
+               LOG_N(Trace_Warning,
+                     "WARNING BoosterCore::Create needs %zu bytes, which is more than the budget of %zu bytes",
+                     cBytes,
+                     cBytesMax);
+               return Error_OutOfMemory;
+            }
+         }
          error = InitializeTensors(cTerms, pBoosterCore->m_apTerms, cScores, &pBoosterCore->m_apCurrentTermTensors);
          if(Error_None != error) {
             return error;
@@ -884,6 +1245,15 @@ ErrorEbm BoosterCore::Create(void* const rng,
          if(Error_None != error) {
             return error;
          }
+
+         // the current and best models both start at zero, so nothing is dirty yet
+         bool* const abDirtyTerms = static_cast<bool*>(malloc(sizeof(bool) * cTerms));
+         if(nullptr == abDirtyTerms) {
+            LOG_0(Trace_Warning, "WARNING BoosterCore::Create nullptr == abDirtyTerms");
+            return Error_OutOfMemory;
+         }
+         memset(abDirtyTerms, 0, sizeof(bool) * cTerms);
+         pBoosterCore->m_abDirtyTerms = abDirtyTerms;
       }
    }
 
@@ -919,6 +1289,7 @@ ErrorEbm BoosterCore::InitializeBoosterGradientsAndHessians(
          data.m_bHessianNeeded = IsHessian() ? EBM_TRUE : EBM_FALSE;
          data.m_bDisableApprox = IsDisableApprox();
          data.m_bValidation = EBM_FALSE;
+         data.m_bMetricNeeded = EBM_FALSE;
          data.m_aMulticlassMidwayTemp = aMulticlassMidwayTemp;
          // if FloatScore is type FloatSmall then some of the zones might use FloatBig as their type and then read
          // past the end of the aUpdateScores memory, which should always contain zeros.If we want to handle this
@@ -943,4 +1314,96 @@ ErrorEbm BoosterCore::InitializeBoosterGradientsAndHessians(
    return Error_None;
 }
 
+ErrorEbm BoosterCore::SetValidationMetric(const char* const sMetric) {
+   LOG_0(Trace_Info, "Entered BoosterCore::SetValidationMetric");
+
+   EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
+
+   MetricWrapper metric;
+   InitializeMetricWrapperUnfailing(&metric);
+   void* aMetricState = nullptr;
+   if(nullptr != sMetric) {
+      Config config;
+      config.cOutputs = m_cScores;
+      // multitask models have more than one score, which every metric rejects
+      config.cTargets = 1;
+      // metrics only read the validation set, which differential privacy does not protect
+      config.isDifferentialPrivacy = EBM_FALSE;
+      config.linkFunction = m_objectiveCpu.m_linkFunction;
+
+      const ErrorEbm error = GetMetric(&config, sMetric, &metric);
+      if(Error_None != error) {
+         LOG_0(Trace_Error, "ERROR BoosterCore::SetValidationMetric GetMetric failed");
+         FreeMetricWrapperInternals(&metric);
+         return error;
+      }
+
+      EBM_ASSERT(0 != metric.m_cBytesState);
+      aMetricState = malloc(metric.m_cBytesState);
+      if(nullptr == aMetricState) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::SetValidationMetric nullptr == aMetricState");
+         FreeMetricWrapperInternals(&metric);
+         return Error_OutOfMemory;
+      }
+   }
+
+   free(m_aMetricState);
+   FreeMetricWrapperInternals(&m_metric);
+   m_metric = metric;
+   m_aMetricState = aMetricState;
+
+   // the best metric so far was measured on a different scale, so the next update becomes the best model
+   m_bestModelMetric = std::numeric_limits<double>::infinity();
+
+   LOG_0(Trace_Info, "Exited BoosterCore::SetValidationMetric");
+   return Error_None;
+}
+
+double BoosterCore::CalcValidationMetric() {
+   EBM_ASSERT(nullptr != m_metric.m_pMetric);
+   EBM_ASSERT(nullptr != m_aMetricState);
+   EBM_ASSERT(0 != m_validationSet.GetCountSamples());
+
+   memset(m_aMetricState, 0, m_metric.m_cBytesState);
+
+   // rmse keeps neither the scores nor the targets, but its gradients are the residuals of the validation set too
+   const bool bRmse = IsRmse();
+
+   // metrics like AUC that bucket the scores first need the range of the scores over all of the subsets
+   BoolEbm bScoreRangePass = m_metric.m_bScoreRange;
+   EBM_ASSERT(EBM_FALSE == bScoreRangePass || !bRmse);
+   while(true) {
+      DataSubsetBoosting* pSubset = m_validationSet.GetSubsets();
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_validationSet.GetCountSubsets();
+      do {
+         MetricBridge data;
+         data.m_cSamples = pSubset->GetCountSamples();
+         data.m_cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+         data.m_cUIntBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes;
+         data.m_aSampleScores = bRmse ? nullptr : pSubset->GetSampleScores();
+         data.m_aTargets = bRmse ? nullptr : pSubset->GetTargetData();
+         data.m_aResiduals = bRmse ? pSubset->GetGradHess() : nullptr;
+         data.m_aWeights = pSubset->GetInnerBag(0)->GetWeights();
+         data.m_aState = m_aMetricState;
+         data.m_bScoreRangePass = bScoreRangePass;
+         AccumulateMetricC(&m_metric, &data);
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+      if(EBM_FALSE == bScoreRangePass) {
+         break;
+      }
+      bScoreRangePass = EBM_FALSE;
+   }
+
+   double metric = FinishMetricStateC(&m_metric, m_aMetricState);
+   if(EBM_FALSE != m_metric.m_bMaximizeMetric) {
+      metric = -metric;
+   }
+   if(std::isnan(metric)) {
+      // scores that overflowed can make the metric NaN, which should never look like an improvement
+      metric = std::numeric_limits<double>::infinity();
+   }
+   return metric;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -16,6 +16,7 @@
 #include "bridge.h" // ObjectiveWrapper
 
 #include "ebm_internal.hpp" // FloatMain
+#include "RandomCounter.hpp"
 #include "DataSetBoosting.hpp"
 
 namespace DEFINED_ZONE_NAME {
@@ -40,6 +41,7 @@ class BoosterCore final {
 
    size_t m_cScores;
    BoolEbm m_bDisableApprox;
+   bool m_bHugePages;
 
    size_t m_cFeatures;
    FeatureBoosting* m_aFeatures;
@@ -51,6 +53,9 @@ class BoosterCore final {
 
    Tensor** m_apCurrentTermTensors;
    Tensor** m_apBestTermTensors;
+   // one flag per term that is set when the current model's tensor has changed since it was last copied to the best
+   // model, so that an improvement only needs to copy the terms that were boosted since the previous improvement
+   bool* m_abDirtyTerms;
 
    double m_bestModelMetric;
 
@@ -66,17 +71,44 @@ class BoosterCore final {
    ObjectiveWrapper m_objectiveCpu;
    ObjectiveWrapper m_objectiveSIMD;
 
+   // the validation metric chosen by SetValidationMetric, or no metric when ApplyTermUpdate returns the objective's
+   MetricWrapper m_metric;
+   void* m_aMetricState;
+
+   // gradient-based one-side sampling.  m_aSampleMagnitudes holds a strided subset of the training gradient
+   // magnitudes and only exists while sampling is on
+   double m_sampleTopFraction;
+   double m_sampleOtherFraction;
+   uint64_t m_iSampleStep;
+   double* m_aSampleMagnitudes;
+   RandomCounter m_sampleRng;
+
    static void DeleteTensors(const size_t cTerms, Tensor** const apTensors);
 
    static ErrorEbm InitializeTensors(
          const size_t cTerms, const Term* const* const apTerms, const size_t cScores, Tensor*** papTensorsOut);
 
+   // predicts the bytes that Create and the BoosterShell will allocate for the given data set plan, without
+   // allocating any of it.  Saturates at SIZE_MAX so that a plan too big to address exceeds every budget
+   size_t MeasureBytes(const size_t cTargets,
+         const size_t cTrainingSamples,
+         const size_t cTrainingSubsetSamplesMax,
+         const size_t cValidationSamples,
+         const size_t cValidationSubsetSamplesMax,
+         const size_t cInnerBags,
+         const bool bPoissonBags,
+         const size_t cWeights,
+         const size_t cTensorBinsMax,
+         const size_t cMainBinsMax,
+         const size_t cSingleDimensionBinsMax);
+
    ~BoosterCore();
 
    inline BoosterCore() noexcept :
          m_REFERENCE_COUNT(1), // we're not visible on any other thread yet, so no synchronization required
          m_cScores(0),
          m_bDisableApprox(EBM_FALSE),
+         m_bHugePages(false),
          m_cFeatures(0),
          m_aFeatures(nullptr),
          m_cTerms(0),
@@ -84,15 +116,22 @@ class BoosterCore final {
          m_cInnerBags(0),
          m_apCurrentTermTensors(nullptr),
          m_apBestTermTensors(nullptr),
+         m_abDirtyTerms(nullptr),
          m_bestModelMetric(std::numeric_limits<double>::infinity()),
          m_cBytesFastBins(0),
          m_cBytesMainBins(0),
          m_cBytesSplitPositions(0),
-         m_cBytesTreeNodes(0) {
+         m_cBytesTreeNodes(0),
+         m_aMetricState(nullptr),
+         m_sampleTopFraction(1.0),
+         m_sampleOtherFraction(0.0),
+         m_iSampleStep(0),
+         m_aSampleMagnitudes(nullptr) {
       m_trainingSet.SafeInitDataSetBoosting();
       m_validationSet.SafeInitDataSetBoosting();
       InitializeObjectiveWrapperUnfailing(&m_objectiveCpu);
       InitializeObjectiveWrapperUnfailing(&m_objectiveSIMD);
+      InitializeMetricWrapperUnfailing(&m_metric);
    }
 
  public:
@@ -127,12 +166,17 @@ class BoosterCore final {
 
    inline Tensor* const* GetBestModel() const { return m_apBestTermTensors; }
 
+   inline bool* GetDirtyTerms() { return m_abDirtyTerms; }
+
    inline double GetBestModelMetric() const { return m_bestModelMetric; }
 
    inline void SetBestModelMetric(const double bestModelMetric) { m_bestModelMetric = bestModelMetric; }
 
    static void Free(BoosterCore* const pBoosterCore);
 
+   // a cBytesMax of SIZE_MAX means no budget.  With a non-null pcBytesMeasureOut, Create stops once it has planned the
+   // data sets and writes the bytes that the plan needs instead of allocating them.  It leaves the value unchanged if
+   // there are no terms or the target needs no scores
    static ErrorEbm Create(void* const rng,
          const size_t cTerms,
          const size_t cInnerBags,
@@ -145,10 +189,26 @@ class BoosterCore final {
          const CreateBoosterFlags flags,
          const AccelerationFlags acceleration,
          const char* const sObjective,
+         const size_t cBytesMax,
+         size_t* const pcBytesMeasureOut,
          BoosterCore** const ppBoosterCoreOut);
 
    ErrorEbm InitializeBoosterGradientsAndHessians(void* const aMulticlassMidwayTemp, FloatScore* const aUpdateScores);
 
+   inline bool IsGradientSampling() const { return nullptr != m_aSampleMagnitudes; }
+
+   ErrorEbm SetGradientSampling(const uint64_t seed, const double topFraction, const double otherFraction);
+   void FreeGradientSampling();
+   // selects the samples that the next GenerateTermUpdate bins.  Call after the training gradients change
+   ErrorEbm SampleGradients();
+
+   inline bool IsValidationMetric() const { return nullptr != m_metric.m_pMetric; }
+
+   // nullptr goes back to the objective's metric
+   ErrorEbm SetValidationMetric(const char* const sMetric);
+   // returns the metric chosen by SetValidationMetric over the whole validation set, negated if it is maximized
+   double CalcValidationMetric();
+
    inline double FinishMetric(const double metricSum) {
       EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
       return FinishMetricC(&m_objectiveCpu, metricSum);
@@ -172,6 +232,8 @@ class BoosterCore final {
 
    inline BoolEbm IsDisableApprox() const { return m_bDisableApprox; }
 
+   inline bool IsHugePages() const { return m_bHugePages; }
+
    inline double LearningRateAdjustmentDifferentialPrivacy() const noexcept {
       EBM_ASSERT(nullptr != m_objectiveCpu.m_pObjective);
       return m_objectiveCpu.m_learningRateAdjustmentDifferentialPrivacy;
@@ -6,7 +6,7 @@
 
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
-#include <string.h> // memcpy
+#include <string.h> // memcpy, memset
 
 #define ZONE_main
 #include "zones.h"
@@ -20,6 +20,7 @@
 
 #include "BoosterCore.hpp" // BoosterCore
 #include "BoosterShell.hpp"
+#include "Timeline.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -42,9 +43,15 @@ void BoosterShell::Free(BoosterShell* const pBoosterShell) {
       Tensor::Free(pBoosterShell->m_pInnerTermUpdate);
       AlignedFree(pBoosterShell->m_aBoostingFastBinsTemp);
       AlignedFree(pBoosterShell->m_aBoostingMainBins);
+      AlignedFree(pBoosterShell->m_aBagWeightsTemp);
+      AlignedFree(pBoosterShell->m_aSampledTermDataTemp);
+      AlignedFree(pBoosterShell->m_aSampledWeightsTemp);
       AlignedFree(pBoosterShell->m_aMulticlassMidwayTemp);
+      free(pBoosterShell->m_aSubsetStats);
       AlignedFree(pBoosterShell->m_aSplitPositionsTemp);
       AlignedFree(pBoosterShell->m_aTreeNodesTemp);
+      pBoosterShell->m_scratch.Free();
+      free(pBoosterShell->m_aTermStats);
       BoosterCore::Free(pBoosterShell->m_pBoosterCore);
 
       // before we free our memory, indicate it was freed so if our higher level language attempts to use it we have
@@ -56,6 +63,45 @@ void BoosterShell::Free(BoosterShell* const pBoosterShell) {
    LOG_0(Trace_Info, "Exited BoosterShell::Free");
 }
 
+void BoosterShell::FillStats(const bool bReset, UIntEbm* const aTermStatsOut, UIntEbm* const aZoneStatsOut) {
+   const size_t cTerms = GetBoosterCore()->GetCountTerms();
+   const size_t cTermStats = size_t{BoosterStat_COUNT} * cTerms;
+
+   if(nullptr != aTermStatsOut) {
+      UIntEbm* pStatOut = aTermStatsOut;
+      for(size_t iStat = 0; iStat < cTermStats; ++iStat) {
+         pStatOut[BoosterStatItem_Calls] = m_aTermStats[iStat].m_cCalls;
+         pStatOut[BoosterStatItem_Nanoseconds] = m_aTermStats[iStat].m_cNanoseconds;
+         pStatOut[BoosterStatItem_Bytes] = m_aTermStats[iStat].m_cBytes;
+         pStatOut += BoosterStatItem_COUNT;
+      }
+   }
+   if(nullptr != aZoneStatsOut) {
+      UIntEbm* pStatOut = aZoneStatsOut;
+      for(size_t iStat = 0; iStat < size_t{BoosterStatZone_COUNT * BoosterStat_COUNT}; ++iStat) {
+         pStatOut[BoosterStatItem_Calls] = m_aZoneStats[iStat].m_cCalls;
+         pStatOut[BoosterStatItem_Nanoseconds] = m_aZoneStats[iStat].m_cNanoseconds;
+         pStatOut[BoosterStatItem_Bytes] = m_aZoneStats[iStat].m_cBytes;
+         pStatOut += BoosterStatItem_COUNT;
+      }
+   }
+
+   if(bReset) {
+      if(size_t{0} != cTerms) {
+         memset(m_aTermStats, 0, sizeof(BoosterStat) * cTermStats);
+      }
+      memset(m_aZoneStats, 0, sizeof(m_aZoneStats));
+   }
+}
+
+static void* AlignedAllocScratch(const size_t cBytes, const bool bHugePages) {
+   void* const p = AlignedAlloc(cBytes);
+   if(bHugePages) {
+      AdviseHugePages(p, cBytes);
+   }
+   return p;
+}
+
 BoosterShell* BoosterShell::Create(BoosterCore* const pBoosterCore) {
    LOG_0(Trace_Info, "Entered BoosterShell::Create");
 
@@ -77,6 +123,16 @@ ErrorEbm BoosterShell::FillAllocations() {
 
    LOG_0(Trace_Info, "Entered BoosterShell::FillAllocations");
 
+   const bool bHugePages = m_pBoosterCore->IsHugePages();
+   m_scratch.InitializeUnfailing(bHugePages);
+
+   if(0 != m_pBoosterCore->GetTrainingSet()->GetCountSamples()) {
+      m_cSubsetSlots += m_pBoosterCore->GetTrainingSet()->GetCountSubsets();
+   }
+   if(0 != m_pBoosterCore->GetValidationSet()->GetCountSamples()) {
+      m_cSubsetSlots += m_pBoosterCore->GetValidationSet()->GetCountSubsets();
+   }
+
    const size_t cScores = m_pBoosterCore->GetCountScores();
    if(size_t{0} != cScores) {
       m_pTermUpdate = Tensor::Allocate(k_cDimensionsMax, cScores);
@@ -90,20 +146,62 @@ ErrorEbm BoosterShell::FillAllocations() {
       }
 
       if(0 != m_pBoosterCore->GetCountBytesFastBins()) {
-         m_aBoostingFastBinsTemp = static_cast<BinBase*>(AlignedAlloc(m_pBoosterCore->GetCountBytesFastBins()));
+         const size_t cFastBinsSlots = EbmMax(size_t{1}, m_pBoosterCore->GetTrainingSet()->GetCountSubsets());
+         // keep each subset's bins aligned for SIMD and on their own cache lines
+         const size_t cBytesFastBins = (m_pBoosterCore->GetCountBytesFastBins() + SIMD_BYTE_ALIGNMENT - 1) /
+               SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+         if(IsMultiplyError(cBytesFastBins, cFastBinsSlots)) {
+            goto failed_allocation;
+         }
+         m_cBytesFastBinsTemp = cBytesFastBins;
+         m_aBoostingFastBinsTemp =
+               static_cast<BinBase*>(AlignedAllocScratch(cBytesFastBins * cFastBinsSlots, bHugePages));
          if(nullptr == m_aBoostingFastBinsTemp) {
             goto failed_allocation;
          }
       }
 
+      if(0 != m_pBoosterCore->GetTrainingSet()->GetCountSamples() &&
+            m_pBoosterCore->GetTrainingSet()->GetSubsets()->IsPoissonBags()) {
+         const size_t cSubsets = m_pBoosterCore->GetTrainingSet()->GetCountSubsets();
+         const DataSubsetBoosting* pSubset = m_pBoosterCore->GetTrainingSet()->GetSubsets();
+         const DataSubsetBoosting* const pSubsetsEnd = pSubset + cSubsets;
+         size_t cBytesBagWeights = 0;
+         do {
+            const size_t cFloatBytes = pSubset->GetObjectiveWrapper()->m_cFloatBytes;
+            if(IsMultiplyError(cFloatBytes, pSubset->GetCountSamples())) {
+               goto failed_allocation;
+            }
+            cBytesBagWeights = EbmMax(cBytesBagWeights, cFloatBytes * pSubset->GetCountSamples());
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+         // keep each subset's slot aligned for SIMD loads
+         if(IsAddError(cBytesBagWeights, size_t{SIMD_BYTE_ALIGNMENT - 1})) {
+            goto failed_allocation;
+         }
+         cBytesBagWeights = (cBytesBagWeights + SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+         if(IsMultiplyError(cBytesBagWeights, cSubsets)) {
+            goto failed_allocation;
+         }
+         m_cBytesBagWeightsTemp = cBytesBagWeights;
+         m_aBagWeightsTemp = AlignedAllocScratch(cBytesBagWeights * cSubsets, bHugePages);
+         if(nullptr == m_aBagWeightsTemp) {
+            goto failed_allocation;
+         }
+      }
+
       if(0 != m_pBoosterCore->GetCountBytesMainBins()) {
-         m_aBoostingMainBins = static_cast<BinBase*>(AlignedAlloc(m_pBoosterCore->GetCountBytesMainBins()));
+         m_aBoostingMainBins =
+               static_cast<BinBase*>(AlignedAllocScratch(m_pBoosterCore->GetCountBytesMainBins(), bHugePages));
          if(nullptr == m_aBoostingMainBins) {
             goto failed_allocation;
          }
       }
 
-      if(size_t{1} != cScores) {
+      // ranking objectives keep one float per document of the query being ranked in the same scratch space
+      const size_t cQuerySamplesMax = EbmMax(GetBoosterCore()->GetTrainingSet()->GetCountQuerySamplesMax(),
+            GetBoosterCore()->GetValidationSet()->GetCountQuerySamplesMax());
+      if(size_t{1} != cScores || size_t{0} != cQuerySamplesMax) {
          size_t cBytesMulticlassMidwayMax = 0;
          if(0 != GetBoosterCore()->GetTrainingSet()->GetCountSamples()) {
             DataSubsetBoosting* pSubset = GetBoosterCore()->GetTrainingSet()->GetSubsets();
@@ -141,9 +239,21 @@ ErrorEbm BoosterShell::FillAllocations() {
             } while(pSubsetsEnd != pSubset);
          }
 
+         if(IsMultiplyError(sizeof(FloatBig), cQuerySamplesMax)) {
+            goto failed_allocation;
+         }
+         cBytesMulticlassMidwayMax = EbmMax(cBytesMulticlassMidwayMax, sizeof(FloatBig) * cQuerySamplesMax);
+
          // if there are zero samples, cFloatBytesMax will be zero
          if(0 != cBytesMulticlassMidwayMax) {
-            m_aMulticlassMidwayTemp = AlignedAlloc(cBytesMulticlassMidwayMax);
+            // keep each subset's slot aligned for SIMD loads and on its own cache lines
+            cBytesMulticlassMidwayMax =
+                  (cBytesMulticlassMidwayMax + SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+            if(IsMultiplyError(cBytesMulticlassMidwayMax, m_cSubsetSlots)) {
+               goto failed_allocation;
+            }
+            m_cBytesMulticlassMidwayTemp = cBytesMulticlassMidwayMax;
+            m_aMulticlassMidwayTemp = AlignedAllocScratch(cBytesMulticlassMidwayMax * m_cSubsetSlots, bHugePages);
             if(nullptr == m_aMulticlassMidwayTemp) {
                goto failed_allocation;
             }
@@ -151,20 +261,45 @@ ErrorEbm BoosterShell::FillAllocations() {
       }
 
       if(0 != m_pBoosterCore->GetCountBytesSplitPositions()) {
-         m_aSplitPositionsTemp = AlignedAlloc(m_pBoosterCore->GetCountBytesSplitPositions());
+         m_aSplitPositionsTemp = AlignedAllocScratch(m_pBoosterCore->GetCountBytesSplitPositions(), bHugePages);
          if(nullptr == m_aSplitPositionsTemp) {
             goto failed_allocation;
          }
       }
 
       if(0 != m_pBoosterCore->GetCountBytesTreeNodes()) {
-         m_aTreeNodesTemp = AlignedAlloc(m_pBoosterCore->GetCountBytesTreeNodes());
+         m_aTreeNodesTemp = AlignedAllocScratch(m_pBoosterCore->GetCountBytesTreeNodes(), bHugePages);
          if(nullptr == m_aTreeNodesTemp) {
             goto failed_allocation;
          }
       }
    }
 
+   if(size_t{0} != m_cSubsetSlots) {
+      if(IsMultiplyError(sizeof(SubsetStat), m_cSubsetSlots)) {
+         goto failed_allocation;
+      }
+      m_aSubsetStats = static_cast<SubsetStat*>(malloc(sizeof(SubsetStat) * m_cSubsetSlots));
+      if(nullptr == m_aSubsetStats) {
+         goto failed_allocation;
+      }
+   }
+
+   {
+      const size_t cTerms = m_pBoosterCore->GetCountTerms();
+      if(size_t{0} != cTerms) {
+         if(IsMultiplyError(sizeof(BoosterStat) * size_t{BoosterStat_COUNT}, cTerms)) {
+            goto failed_allocation;
+         }
+         const size_t cBytesTermStats = sizeof(BoosterStat) * size_t{BoosterStat_COUNT} * cTerms;
+         m_aTermStats = static_cast<BoosterStat*>(malloc(cBytesTermStats));
+         if(nullptr == m_aTermStats) {
+            goto failed_allocation;
+         }
+         memset(m_aTermStats, 0, cBytesTermStats);
+      }
+   }
+
    LOG_0(Trace_Info, "Exited BoosterShell::FillAllocations");
    return Error_None;
 
@@ -173,6 +308,165 @@ failed_allocation:;
    return Error_OutOfMemory;
 }
 
+ErrorEbm BoosterShell::AllocateSampledTemps() {
+   EBM_ASSERT(nullptr != m_pBoosterCore);
+   EBM_ASSERT(m_pBoosterCore->IsGradientSampling());
+
+   if(nullptr != m_aSampledTermDataTemp) {
+      return Error_None;
+   }
+
+   LOG_0(Trace_Info, "Entered BoosterShell::AllocateSampledTemps");
+
+   DataSetBoosting* const pTrainingSet = m_pBoosterCore->GetTrainingSet();
+   const size_t cSubsets = pTrainingSet->GetCountSubsets();
+   const DataSubsetBoosting* pSubset = pTrainingSet->GetSubsets();
+   const DataSubsetBoosting* const pSubsetsEnd = pSubset + cSubsets;
+   size_t cBytesTermData = 0;
+   size_t cBytesWeights = 0;
+   do {
+      // the compacted term data takes at most one item per word plus the empty word InitTermData leaves at the end
+      const size_t cSamples = pSubset->GetCountSamples();
+      const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+      if(IsAddError(cSamples, cSIMDPack) ||
+            IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cUIntBytes, cSamples + cSIMDPack) ||
+            IsMultiplyError(pSubset->GetObjectiveWrapper()->m_cFloatBytes, cSamples)) {
+         goto failed_allocation;
+      }
+      cBytesTermData = EbmMax(cBytesTermData, pSubset->GetObjectiveWrapper()->m_cUIntBytes * (cSamples + cSIMDPack));
+      cBytesWeights = EbmMax(cBytesWeights, pSubset->GetObjectiveWrapper()->m_cFloatBytes * cSamples);
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+
+   // keep each subset's slot aligned for SIMD loads
+   if(IsAddError(cBytesTermData, size_t{SIMD_BYTE_ALIGNMENT - 1}) ||
+         IsAddError(cBytesWeights, size_t{SIMD_BYTE_ALIGNMENT - 1})) {
+      goto failed_allocation;
+   }
+   cBytesTermData = (cBytesTermData + SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+   cBytesWeights = (cBytesWeights + SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+   if(IsMultiplyError(cBytesTermData, cSubsets) || IsMultiplyError(cBytesWeights, cSubsets)) {
+      goto failed_allocation;
+   }
+
+   m_aSampledWeightsTemp = AlignedAllocScratch(cBytesWeights * cSubsets, m_pBoosterCore->IsHugePages());
+   if(nullptr == m_aSampledWeightsTemp) {
+      goto failed_allocation;
+   }
+   m_cBytesSampledWeightsTemp = cBytesWeights;
+
+   // allocate this last since it marks the temps as allocated
+   m_aSampledTermDataTemp = AlignedAllocScratch(cBytesTermData * cSubsets, m_pBoosterCore->IsHugePages());
+   if(nullptr == m_aSampledTermDataTemp) {
+      goto failed_allocation;
+   }
+   m_cBytesSampledTermDataTemp = cBytesTermData;
+
+   LOG_0(Trace_Info, "Exited BoosterShell::AllocateSampledTemps");
+   return Error_None;
+
+failed_allocation:;
+   LOG_0(Trace_Warning, "WARNING Exited BoosterShell::AllocateSampledTemps with allocation failure");
+   return Error_OutOfMemory;
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureBooster(const void* dataSet,
+      const BagEbm* bag,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      CreateBoosterFlags flags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      IntEbm maxBytes) {
+   LOG_N(Trace_Info,
+         "Entered MeasureBooster: "
+         "dataSet=%p, "
+         "bag=%p, "
+         "countTerms=%" IntEbmPrintf ", "
+         "dimensionCounts=%p, "
+         "featureIndexes=%p, "
+         "countInnerBags=%" IntEbmPrintf ", "
+         "flags=0x%" UCreateBoosterFlagsPrintf ", "
+         "acceleration=0x%" UAccelerationFlagsPrintf ", "
+         "objective=%p, "
+         "experimentalParams=%p, "
+         "maxBytes=%" IntEbmPrintf,
+         dataSet,
+         static_cast<const void*>(bag),
+         countTerms,
+         static_cast<const void*>(dimensionCounts),
+         static_cast<const void*>(featureIndexes),
+         countInnerBags,
+         static_cast<UCreateBoosterFlags>(flags), // signed to unsigned conversion is defined behavior in C++
+         static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
+         static_cast<const void*>(objective), // do not print the string for security reasons
+         static_cast<const void*>(experimentalParams),
+         maxBytes);
+
+   if(nullptr == dataSet) {
+      LOG_0(Trace_Error, "ERROR MeasureBooster nullptr == dataSet");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR MeasureBooster IsConvertError<size_t>(countTerms)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   if(nullptr == dimensionCounts && size_t{0} != cTerms) {
+      LOG_0(Trace_Error, "ERROR MeasureBooster dimensionCounts cannot be null if 0 < countTerms");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countInnerBags)) {
+      LOG_0(Trace_Warning, "WARNING MeasureBooster IsConvertError<size_t>(countInnerBags)");
+      return Error_OutOfMemory;
+   }
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+
+   if(maxBytes < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR MeasureBooster maxBytes cannot be negative");
+      return Error_IllegalParamVal;
+   }
+   // zero means no budget, and a budget beyond the address space cannot constrain anything
+   const size_t cBytesMax =
+         IntEbm{0} == maxBytes || IsConvertError<size_t>(maxBytes) ? SIZE_MAX : static_cast<size_t>(maxBytes);
+
+   size_t cBytes = 0;
+   BoosterCore* pBoosterCore = nullptr;
+   const ErrorEbm error = BoosterCore::Create(nullptr,
+         cTerms,
+         cInnerBags,
+         experimentalParams,
+         dimensionCounts,
+         featureIndexes,
+         static_cast<const unsigned char*>(dataSet),
+         bag,
+         nullptr,
+         flags,
+         acceleration,
+         objective,
+         cBytesMax,
+         &cBytes,
+         &pBoosterCore);
+   BoosterCore::Free(pBoosterCore); // legal if nullptr
+   if(Error_None != error) {
+      return error;
+   }
+
+   if(IsConvertError<IntEbm>(cBytes)) {
+      LOG_0(Trace_Warning, "WARNING MeasureBooster IsConvertError<IntEbm>(cBytes)");
+      return Error_OutOfMemory;
+   }
+
+   LOG_N(Trace_Info, "Exited MeasureBooster: %zu bytes", cBytes);
+   return static_cast<IntEbm>(cBytes);
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       const void* dataSet,
       const BagEbm* bag,
@@ -185,6 +479,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       AccelerationFlags acceleration,
       const char* objective,
       const double* experimentalParams,
+      IntEbm maxBytes,
       BoosterHandle* boosterHandleOut) {
    LOG_N(Trace_Info,
          "Entered CreateBooster: "
@@ -200,6 +495,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
          "acceleration=0x%" UAccelerationFlagsPrintf ", "
          "objective=%p, "
          "experimentalParams=%p, "
+         "maxBytes=%" IntEbmPrintf ", "
          "boosterHandleOut=%p",
          rng,
          dataSet,
@@ -213,8 +509,11 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
          static_cast<UAccelerationFlags>(acceleration), // signed to unsigned conversion is defined behavior in C++
          static_cast<const void*>(objective), // do not print the string for security reasons
          static_cast<const void*>(experimentalParams),
+         maxBytes,
          static_cast<const void*>(boosterHandleOut));
 
+   TimelineScope timelineScope(TimelineName_CreateBooster, countTerms, IntEbm{0});
+
    ErrorEbm error;
 
    if(nullptr == boosterHandleOut) {
@@ -225,7 +524,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
 
    if(flags &
          ~(CreateBoosterFlags_DifferentialPrivacy | CreateBoosterFlags_DisableApprox |
-               CreateBoosterFlags_BinaryAsMulticlass)) {
+               CreateBoosterFlags_BinaryAsMulticlass | CreateBoosterFlags_PoissonBags |
+               CreateBoosterFlags_HugePages | CreateBoosterFlags_CheckedDataSet)) {
       LOG_0(Trace_Error, "ERROR CreateBooster flags contains unknown flags. Ignoring extras.");
    }
 
@@ -256,6 +556,14 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
    }
    const size_t cInnerBags = static_cast<size_t>(countInnerBags);
 
+   if(maxBytes < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR CreateBooster maxBytes cannot be negative");
+      return Error_IllegalParamVal;
+   }
+   // zero means no budget, and a budget beyond the address space cannot constrain anything
+   const size_t cBytesMax =
+         IntEbm{0} == maxBytes || IsConvertError<size_t>(maxBytes) ? SIZE_MAX : static_cast<size_t>(maxBytes);
+
    // TODO: since BoosterCore is a non-POD C++ class, we should probably move the call to new from inside
    //       BoosterCore::Create to here and wrap it with a try catch at this level and rely on standard C++ behavior
    BoosterCore* pBoosterCore = nullptr;
@@ -271,6 +579,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
          flags,
          acceleration,
          objective,
+         cBytesMax,
+         nullptr,
          &pBoosterCore);
    if(UNLIKELY(Error_None != error)) {
       BoosterCore::Free(pBoosterCore); // legal if nullptr.  On error we can get back a legal pBoosterCore to delete
@@ -310,6 +620,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       }
    }
 
+   timelineScope.SetArgs(countTerms, static_cast<IntEbm>(pBoosterCore->GetTrainingSet()->GetCountSamples()));
+
    const BoosterHandle handle = pBoosterShell->GetHandle();
 
    LOG_N(Trace_Info, "Exited CreateBooster: *boosterHandleOut=%p", static_cast<void*>(handle));
@@ -510,6 +822,64 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBoosterStats(
+      BoosterHandle boosterHandle, BoolEbm isReset, UIntEbm* termStatsOut, UIntEbm* zoneStatsOut) {
+   LOG_N(Trace_Info,
+         "Entered GetBoosterStats: "
+         "boosterHandle=%p, "
+         "isReset=%s, "
+         "termStatsOut=%p, "
+         "zoneStatsOut=%p",
+         static_cast<void*>(boosterHandle),
+         ObtainTruth(isReset),
+         static_cast<void*>(termStatsOut),
+         static_cast<void*>(zoneStatsOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(EBM_FALSE != isReset && EBM_TRUE != isReset) {
+      LOG_0(Trace_Error, "ERROR GetBoosterStats isReset must be EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+
+   pBoosterShell->FillStats(EBM_FALSE != isReset, termStatsOut, zoneStatsOut);
+
+   LOG_0(Trace_Info, "Exited GetBoosterStats");
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GetBoosterScratchStats(
+      BoosterHandle boosterHandle, BoolEbm isReset, UIntEbm* scratchStatsOut) {
+   LOG_N(Trace_Info,
+         "Entered GetBoosterScratchStats: "
+         "boosterHandle=%p, "
+         "isReset=%s, "
+         "scratchStatsOut=%p",
+         static_cast<void*>(boosterHandle),
+         ObtainTruth(isReset),
+         static_cast<void*>(scratchStatsOut));
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(EBM_FALSE != isReset && EBM_TRUE != isReset) {
+      LOG_0(Trace_Error, "ERROR GetBoosterScratchStats isReset must be EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+
+   pBoosterShell->GetScratch()->FillStats(EBM_FALSE != isReset, scratchStatsOut);
+
+   LOG_0(Trace_Info, "Exited GetBoosterScratchStats");
+   return Error_None;
+}
+
 EBM_API_BODY void EBM_CALLING_CONVENTION FreeBooster(BoosterHandle boosterHandle) {
    LOG_N(Trace_Info, "Entered FreeBooster: boosterHandle=%p", static_cast<void*>(boosterHandle));
 
@@ -7,11 +7,19 @@
 
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <string.h> // memset
+#include <chrono> // steady_clock
 
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
 #include "unzoned.h"
 
+#include "bridge.h" // ObjectiveWrapper
+#include "bridge.hpp" // k_cItemsPerBitPackUndefined
+
+#include "ScratchArena.hpp"
+
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
@@ -26,6 +34,30 @@ template<bool bHessian, size_t cCompilerScores> struct SplitPosition;
 
 template<bool bHessian, size_t cCompilerScores> struct TreeNode;
 
+struct BoosterStat final {
+   uint64_t m_cCalls;
+   uint64_t m_cNanoseconds;
+   uint64_t m_cBytes;
+};
+static_assert(std::is_standard_layout<BoosterStat>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<BoosterStat>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+// the per-subset results of one ApplyTermUpdate.  The subsets can be applied on different threads, so each writes to
+// its own slot and the slots are folded afterwards in subset order, which keeps the validation metric identical for
+// any number of threads
+struct SubsetStat final {
+   double m_metric;
+   uint64_t m_cNanoseconds;
+   uint64_t m_cBytes;
+   bool m_bApplied;
+};
+static_assert(std::is_standard_layout<SubsetStat>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<SubsetStat>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
 class BoosterShell final {
    static constexpr size_t k_handleVerificationOk = 10995; // random 15 bit number
    static constexpr size_t k_handleVerificationFreed = 25073; // random 15 bit number
@@ -38,17 +70,42 @@ class BoosterShell final {
    Tensor* m_pInnerTermUpdate;
 
    // TODO: try to merge some of this memory so that we get more CPU cache residency
+   // one slot of m_cBytesFastBinsTemp per training subset so that the subsets can be binned in parallel
    BinBase* m_aBoostingFastBinsTemp;
+   size_t m_cBytesFastBinsTemp;
    BinBase* m_aBoostingMainBins;
 
+   // one slot of m_cBytesBagWeightsTemp per training subset, only allocated for Poisson bags
+   void* m_aBagWeightsTemp;
+   size_t m_cBytesBagWeightsTemp;
+
+   // one slot of each per training subset for the compacted term data and weights of gradient sampling.  These are
+   // allocated the first time this shell bins a sampled booster
+   void* m_aSampledTermDataTemp;
+   size_t m_cBytesSampledTermDataTemp;
+   void* m_aSampledWeightsTemp;
+   size_t m_cBytesSampledWeightsTemp;
+
    // TODO: I think this can share memory with m_aBoostingFastBinsTemp since the GradientPair always contains a FLOAT,
    // and it always contains enough for the multiclass scores in the first bin, and we always have at least 1 bin,
    // right?
+   // one slot of m_cBytesMulticlassMidwayTemp per training and validation subset so that subsets can run in parallel
    void* m_aMulticlassMidwayTemp;
+   size_t m_cBytesMulticlassMidwayTemp;
+
+   size_t m_cSubsetSlots;
+   SubsetStat* m_aSubsetStats;
 
    void* m_aTreeNodesTemp;
    void* m_aSplitPositionsTemp;
 
+   // memory that GenerateTermUpdate needs only until the update is applied
+   ScratchArena m_scratch;
+
+   // these are per-shell instead of in the BoosterCore so that views on different threads do not race
+   BoosterStat* m_aTermStats; // [cTerms][BoosterStat_COUNT]
+   BoosterStat m_aZoneStats[BoosterStatZone_COUNT * BoosterStat_COUNT];
+
 #ifndef NDEBUG
    const BinBase* m_pDebugMainBinsEnd;
 #endif // NDEBUG
@@ -68,10 +125,23 @@ class BoosterShell final {
       m_pTermUpdate = nullptr;
       m_pInnerTermUpdate = nullptr;
       m_aBoostingFastBinsTemp = nullptr;
+      m_cBytesFastBinsTemp = 0;
       m_aBoostingMainBins = nullptr;
+      m_aBagWeightsTemp = nullptr;
+      m_cBytesBagWeightsTemp = 0;
+      m_aSampledTermDataTemp = nullptr;
+      m_cBytesSampledTermDataTemp = 0;
+      m_aSampledWeightsTemp = nullptr;
+      m_cBytesSampledWeightsTemp = 0;
       m_aMulticlassMidwayTemp = nullptr;
+      m_cBytesMulticlassMidwayTemp = 0;
+      m_cSubsetSlots = 0;
+      m_aSubsetStats = nullptr;
       m_aTreeNodesTemp = nullptr;
       m_aSplitPositionsTemp = nullptr;
+      m_scratch.InitializeUnfailing(false);
+      m_aTermStats = nullptr;
+      memset(m_aZoneStats, 0, sizeof(m_aZoneStats));
    }
 
    static void Free(BoosterShell* const pBoosterShell);
@@ -109,9 +179,26 @@ class BoosterShell final {
 
    INLINE_ALWAYS Tensor* GetInnerTermUpdate() { return m_pInnerTermUpdate; }
 
-   INLINE_ALWAYS BinBase* GetBoostingFastBinsTemp() {
+   INLINE_ALWAYS BinBase* GetBoostingFastBinsTemp(const size_t iSubset = 0) {
       // call this if the bins were already allocated and we just need the pointer
-      return m_aBoostingFastBinsTemp;
+      return nullptr == m_aBoostingFastBinsTemp ? nullptr :
+                                                  IndexByte(m_aBoostingFastBinsTemp, m_cBytesFastBinsTemp * iSubset);
+   }
+
+   INLINE_ALWAYS void* GetBagWeightsTemp(const size_t iSubset) {
+      return nullptr == m_aBagWeightsTemp ? nullptr : IndexByte(m_aBagWeightsTemp, m_cBytesBagWeightsTemp * iSubset);
+   }
+
+   ErrorEbm AllocateSampledTemps();
+
+   INLINE_ALWAYS void* GetSampledTermDataTemp(const size_t iSubset) {
+      EBM_ASSERT(nullptr != m_aSampledTermDataTemp);
+      return IndexByte(m_aSampledTermDataTemp, m_cBytesSampledTermDataTemp * iSubset);
+   }
+
+   INLINE_ALWAYS void* GetSampledWeightsTemp(const size_t iSubset) {
+      EBM_ASSERT(nullptr != m_aSampledWeightsTemp);
+      return IndexByte(m_aSampledWeightsTemp, m_cBytesSampledWeightsTemp * iSubset);
    }
 
    INLINE_ALWAYS BinBase* GetBoostingMainBins() {
@@ -119,7 +206,17 @@ class BoosterShell final {
       return m_aBoostingMainBins;
    }
 
-   INLINE_ALWAYS void* GetMulticlassMidwayTemp() { return m_aMulticlassMidwayTemp; }
+   INLINE_ALWAYS void* GetMulticlassMidwayTemp(const size_t iSubsetSlot = 0) {
+      EBM_ASSERT(size_t{0} == iSubsetSlot || iSubsetSlot < m_cSubsetSlots);
+      return nullptr == m_aMulticlassMidwayTemp ?
+            nullptr :
+            IndexByte(m_aMulticlassMidwayTemp, m_cBytesMulticlassMidwayTemp * iSubsetSlot);
+   }
+
+   // training subsets come first, followed by the validation subsets
+   INLINE_ALWAYS size_t GetCountSubsetSlots() const { return m_cSubsetSlots; }
+
+   INLINE_ALWAYS SubsetStat* GetSubsetStats() { return m_aSubsetStats; }
 
    template<bool bHessian, size_t cCompilerScores = 1>
    INLINE_ALWAYS TreeNode<bHessian, cCompilerScores>* GetTreeNodesTemp() {
@@ -131,6 +228,66 @@ class BoosterShell final {
       return static_cast<SplitPosition<bHessian, cCompilerScores>*>(m_aSplitPositionsTemp);
    }
 
+   INLINE_ALWAYS ScratchArena* GetScratch() { return &m_scratch; }
+
+   INLINE_ALWAYS static uint64_t GetStatTicks() {
+      // steady_clock is a vDSO call on the platforms we care about, so it is cheap enough to leave always enabled
+      return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+   }
+
+   INLINE_ALWAYS static size_t GetStatSampleBytes(const ObjectiveWrapper* const pObjectiveWrapper,
+         const size_t cSamples,
+         const int cPack,
+         const size_t cFloatsPerSample) {
+      // the bytes a compute zone kernel streams through in one pass over a subset. The packed bin indexes are
+      // the only part that shrinks with the term, so this is what to compare against memory bandwidth
+      EBM_ASSERT(1 <= cSamples);
+      size_t cBytes = cSamples * cFloatsPerSample * pObjectiveWrapper->m_cFloatBytes;
+      if(k_cItemsPerBitPackUndefined != cPack) {
+         cBytes += ((cSamples - 1) / static_cast<size_t>(cPack) + 1) * pObjectiveWrapper->m_cUIntBytes;
+      }
+      return cBytes;
+   }
+
+   INLINE_ALWAYS void RecordStat(const size_t iStat,
+         const size_t iTerm,
+         const ObjectiveWrapper* const pObjectiveWrapper,
+         const uint64_t tickStart,
+         const size_t cBytes) {
+      RecordStatNanoseconds(iStat, iTerm, pObjectiveWrapper, GetStatTicks() - tickStart, cBytes);
+   }
+
+   INLINE_ALWAYS void RecordStatNanoseconds(const size_t iStat,
+         const size_t iTerm,
+         const ObjectiveWrapper* const pObjectiveWrapper,
+         const uint64_t cNanoseconds,
+         const size_t cBytes) {
+      // the stats are not thread safe, so work timed on other threads is recorded afterwards on the calling thread
+      EBM_ASSERT(iStat < size_t{BoosterStat_COUNT});
+      EBM_ASSERT(nullptr != m_aTermStats);
+
+      BoosterStat* const pTermStat = &m_aTermStats[iTerm * size_t{BoosterStat_COUNT} + iStat];
+      ++pTermStat->m_cCalls;
+      pTermStat->m_cNanoseconds += cNanoseconds;
+      pTermStat->m_cBytes += static_cast<uint64_t>(cBytes);
+
+      if(nullptr != pObjectiveWrapper) {
+         // the zones are distinguishable by their SIMD register width
+         const size_t cBytesSIMD = pObjectiveWrapper->m_cSIMDPack * pObjectiveWrapper->m_cFloatBytes;
+         const size_t iZone = 64 <= cBytesSIMD ? size_t{BoosterStatZone_avx512f} :
+               32 <= cBytesSIMD                 ? size_t{BoosterStatZone_avx2} :
+                                                  size_t{BoosterStatZone_cpu_64};
+         BoosterStat* const pZoneStat = &m_aZoneStats[iZone * size_t{BoosterStat_COUNT} + iStat];
+         ++pZoneStat->m_cCalls;
+         pZoneStat->m_cNanoseconds += cNanoseconds;
+         pZoneStat->m_cBytes += static_cast<uint64_t>(cBytes);
+      }
+   }
+
+   void FillStats(const bool bReset, UIntEbm* const aTermStatsOut, UIntEbm* const aZoneStatsOut);
+
 #ifndef NDEBUG
    INLINE_ALWAYS const BinBase* GetDebugMainBinsEnd() const { return m_pDebugMainBinsEnd; }
 
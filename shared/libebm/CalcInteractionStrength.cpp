@@ -22,6 +22,8 @@
 #include "DataSetInteraction.hpp"
 #include "InteractionCore.hpp"
 #include "InteractionShell.hpp"
+#include "Timeline.hpp"
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -73,6 +75,122 @@ extern double PartitionTwoDimensionalInteraction(InteractionCore* const pInterac
 #endif // NDEBUG
 );
 
+// The subsets are binned in parallel.  Each task bins a contiguous run of subsets into its own fast bins and adds
+// them into its own main bins, which are then added together in task order.  The count of tasks depends only on the
+// count of subsets, so the sums come out the same for any thread count, and the cap bounds the scratch memory.
+static constexpr size_t k_cBinSumsTasksMax = 16;
+
+struct BinSumsInteractionTaskContext final {
+   InteractionCore* m_pInteractionCore;
+   const IntEbm* m_aFeatureIndexes;
+   const BinSumsInteractionBridge* m_pBinSums;
+   size_t m_cTensorBins;
+   size_t m_cTasks;
+   size_t m_cBytesPerMainBin;
+   size_t m_cBytesTaskStride;
+   size_t m_cBytesTaskFastBins;
+   // [fast bins][main bins] for each task, except that task 0 adds directly into m_aMainBins
+   unsigned char* m_aTaskBins;
+   BinBase* m_aMainBins;
+};
+
+static ErrorEbm BinSumsInteractionTask(void* const pContext, const size_t iTask) {
+   const BinSumsInteractionTaskContext* const pTaskContext =
+         static_cast<const BinSumsInteractionTaskContext*>(pContext);
+   InteractionCore* const pInteractionCore = pTaskContext->m_pInteractionCore;
+   const FeatureInteraction* const aFeatures = pInteractionCore->GetFeatures();
+   const bool bHessian = pInteractionCore->IsHessian();
+   const size_t cScores = pInteractionCore->GetCountScores();
+   const size_t cTensorBins = pTaskContext->m_cTensorBins;
+
+   unsigned char* const pTaskBins = pTaskContext->m_aTaskBins + iTask * pTaskContext->m_cBytesTaskStride;
+   BinBase* const aFastBins = reinterpret_cast<BinBase*>(pTaskBins);
+   BinBase* aMainBins = pTaskContext->m_aMainBins;
+   if(size_t{0} != iTask) {
+      aMainBins = reinterpret_cast<BinBase*>(pTaskBins + pTaskContext->m_cBytesTaskFastBins);
+      memset(aMainBins, 0, pTaskContext->m_cBytesPerMainBin * cTensorBins);
+   }
+
+   BinSumsInteractionBridge binSums = *pTaskContext->m_pBinSums;
+   const size_t cDimensions = binSums.m_cRuntimeRealDimensions;
+
+   const size_t cSubsets = pInteractionCore->GetDataSetInteraction()->GetCountSubsets();
+   DataSubsetInteraction* const aSubsets = pInteractionCore->GetDataSetInteraction()->GetSubsets();
+   DataSubsetInteraction* pSubset = &aSubsets[iTask * cSubsets / pTaskContext->m_cTasks];
+   const DataSubsetInteraction* const pSubsetsEnd = &aSubsets[(iTask + 1) * cSubsets / pTaskContext->m_cTasks];
+   EBM_ASSERT(pSubset < pSubsetsEnd);
+   do {
+      size_t cBytesPerFastBin;
+      if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+         if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+            cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(true, true, bHessian, cScores);
+         } else {
+            EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+            cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(true, true, bHessian, cScores);
+         }
+      } else {
+         EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+         if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+            cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(true, true, bHessian, cScores);
+         } else {
+            EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+            cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(true, true, bHessian, cScores);
+         }
+      }
+      // the task stride was sized for the widest bins, which cannot overflow
+      EBM_ASSERT(cBytesPerFastBin * cTensorBins <= pTaskContext->m_cBytesTaskFastBins);
+
+      aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
+
+#ifndef NDEBUG
+      binSums.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
+#endif // NDEBUG
+
+      size_t iDimensionLoop = 0;
+      do {
+         const IntEbm indexFeature = pTaskContext->m_aFeatureIndexes[iDimensionLoop];
+         const size_t iFeature = static_cast<size_t>(indexFeature);
+         const FeatureInteraction* const pFeature = &aFeatures[iFeature];
+
+         binSums.m_aaPacked[iDimensionLoop] = pSubset->GetFeatureData(iFeature);
+
+         EBM_ASSERT(1 <= pFeature->GetBitsRequiredMin());
+         binSums.m_acItemsPerBitPack[iDimensionLoop] =
+               GetCountItemsBitPacked(pFeature->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+
+         ++iDimensionLoop;
+      } while(cDimensions != iDimensionLoop);
+
+      binSums.m_cSamples = pSubset->GetCountSamples();
+      binSums.m_aGradientsAndHessians = pSubset->GetGradHess();
+      binSums.m_aWeights = pSubset->GetWeights();
+
+      binSums.m_aFastBins = aFastBins;
+
+      const ErrorEbm error = pSubset->BinSumsInteraction(&binSums);
+      if(Error_None != error) {
+         return error;
+      }
+
+      ConvertAddBin(cScores,
+            bHessian,
+            cTensorBins,
+            sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes,
+            sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes,
+            true,
+            true,
+            aFastBins,
+            nullptr,
+            nullptr,
+            std::is_same<UIntMain, uint64_t>::value,
+            std::is_same<FloatMain, double>::value,
+            aMainBins);
+
+      ++pSubset;
+   } while(pSubsetsEnd != pSubset);
+   return Error_None;
+}
+
 // there is a race condition for decrementing this variable, but if a thread loses the
 // race then it just doesn't get decremented as quickly, which we can live with
 static int g_cLogCalcInteractionStrength = 10;
@@ -115,6 +233,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
          maxDeltaStep,
          static_cast<void*>(avgInteractionStrengthOut));
 
+   TimelineScope timelineScope(TimelineName_CalcInteractionStrength, countDimensions, IntEbm{0});
+
    ErrorEbm error;
 
    if(LIKELY(nullptr != avgInteractionStrengthOut)) {
@@ -226,6 +346,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
    const DataSetInteraction* const pDataSet = pInteractionCore->GetDataSetInteraction();
    EBM_ASSERT(nullptr != pDataSet);
 
+   timelineScope.SetArgs(countDimensions, static_cast<IntEbm>(pDataSet->GetCountSamples()));
+
    if(size_t{0} == pDataSet->GetCountSamples()) {
       // if there are zero samples, there isn't much basis to say whether there are interactions, so just return zero
       LOG_0(Trace_Info, "INFO CalcInteractionStrength zero samples");
@@ -340,95 +462,77 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CalcInteractionStrength(Interaction
 
    memset(aMainBins, 0, cBytesPerMainBin * cTensorBins);
 
-   const bool bHessian = pInteractionCore->IsHessian();
+   binSums.m_cRuntimeRealDimensions = cDimensions;
+   binSums.m_bHessian = pInteractionCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
+   binSums.m_cScores = cScores;
 
-   EBM_ASSERT(1 <= pInteractionCore->GetDataSetInteraction()->GetCountSubsets());
-   DataSubsetInteraction* pSubset = pInteractionCore->GetDataSetInteraction()->GetSubsets();
-   const DataSubsetInteraction* const pSubsetsEnd =
-         pSubset + pInteractionCore->GetDataSetInteraction()->GetCountSubsets();
-   do {
-      size_t cBytesPerFastBin;
-      if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-         if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-            cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(true, true, bHessian, cScores);
-         } else {
-            EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-            cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(true, true, bHessian, cScores);
-         }
-      } else {
-         EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-         if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-            cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(true, true, bHessian, cScores);
-         } else {
-            EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-            cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(true, true, bHessian, cScores);
-         }
-      }
-      if(IsMultiplyError(cBytesPerFastBin, cTensorBins)) {
-         LOG_0(Trace_Warning, "WARNING CalcInteractionStrength IsMultiplyError(cBytesPerBin, cTensorBins)");
-         return Error_OutOfMemory;
-      }
-
-      // this doesn't need to be freed since it's tracked and re-used by the class InteractionShell
-      BinBase* const aFastBins = pInteractionShell->GetInteractionFastBinsTemp(cBytesPerFastBin * cTensorBins);
-      if(UNLIKELY(nullptr == aFastBins)) {
-         // already logged
-         return Error_OutOfMemory;
-      }
-
-      aFastBins->ZeroMem(cBytesPerFastBin, cTensorBins);
-
-#ifndef NDEBUG
-      binSums.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cTensorBins);
-#endif // NDEBUG
-
-      size_t iDimensionLoop = 0;
-      do {
-         const IntEbm indexFeature = featureIndexes[iDimensionLoop];
-         const size_t iFeature = static_cast<size_t>(indexFeature);
-         const FeatureInteraction* const pFeature = &aFeatures[iFeature];
-
-         binSums.m_aaPacked[iDimensionLoop] = pSubset->GetFeatureData(iFeature);
+   const size_t cSubsets = pInteractionCore->GetDataSetInteraction()->GetCountSubsets();
+   EBM_ASSERT(1 <= cSubsets);
+   const size_t cTasks = EbmMin(cSubsets, k_cBinSumsTasksMax);
 
-         EBM_ASSERT(1 <= pFeature->GetBitsRequiredMin());
-         binSums.m_acItemsPerBitPack[iDimensionLoop] =
-               GetCountItemsBitPacked(pFeature->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-
-         ++iDimensionLoop;
-      } while(cDimensions != iDimensionLoop);
-
-      binSums.m_cRuntimeRealDimensions = cDimensions;
-
-      binSums.m_bHessian = pInteractionCore->IsHessian() ? EBM_TRUE : EBM_FALSE;
-      binSums.m_cScores = cScores;
-
-      binSums.m_cSamples = pSubset->GetCountSamples();
-      binSums.m_aGradientsAndHessians = pSubset->GetGradHess();
-      binSums.m_aWeights = pSubset->GetWeights();
+   // no subset has wider fast bins than FloatBig and UIntBig
+   const size_t cBytesPerFastBinMax =
+         GetBinSize<FloatBig, UIntBig>(true, true, pInteractionCore->IsHessian(), cScores);
+   if(IsMultiplyError(cBytesPerFastBinMax, cTensorBins)) {
+      LOG_0(Trace_Warning, "WARNING CalcInteractionStrength IsMultiplyError(cBytesPerFastBinMax, cTensorBins)");
+      return Error_OutOfMemory;
+   }
+   const size_t cBytesTaskFastBins = cBytesPerFastBinMax * cTensorBins;
+   // tasks after the first need their own main bins, and each task starts on a new cache line
+   EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, cTensorBins)); // checked above for cTotalMainBins
+   const size_t cBytesTaskMainBins = size_t{1} == cTasks ? size_t{0} : cBytesPerMainBin * cTensorBins;
+   if(IsAddError(cBytesTaskFastBins, cBytesTaskMainBins, size_t{SIMD_BYTE_ALIGNMENT - 1})) {
+      LOG_0(Trace_Warning,
+            "WARNING CalcInteractionStrength IsAddError(cBytesTaskFastBins, cBytesTaskMainBins, SIMD_BYTE_ALIGNMENT - "
+            "1)");
+      return Error_OutOfMemory;
+   }
+   const size_t cBytesTaskStride = (cBytesTaskFastBins + cBytesTaskMainBins + SIMD_BYTE_ALIGNMENT - 1) /
+         SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+   if(IsMultiplyError(cBytesTaskStride, cTasks)) {
+      LOG_0(Trace_Warning, "WARNING CalcInteractionStrength IsMultiplyError(cBytesTaskStride, cTasks)");
+      return Error_OutOfMemory;
+   }
 
-      binSums.m_aFastBins = aFastBins;
+   // this doesn't need to be freed since it's tracked and re-used by the class InteractionShell
+   BinBase* const aTaskBins = pInteractionShell->GetInteractionFastBinsTemp(cBytesTaskStride * cTasks);
+   if(UNLIKELY(nullptr == aTaskBins)) {
+      // already logged
+      return Error_OutOfMemory;
+   }
 
-      error = pSubset->BinSumsInteraction(&binSums);
-      if(Error_None != error) {
-         return error;
-      }
+   BinSumsInteractionTaskContext context;
+   context.m_pInteractionCore = pInteractionCore;
+   context.m_aFeatureIndexes = featureIndexes;
+   context.m_pBinSums = &binSums;
+   context.m_cTensorBins = cTensorBins;
+   context.m_cTasks = cTasks;
+   context.m_cBytesPerMainBin = cBytesPerMainBin;
+   context.m_cBytesTaskStride = cBytesTaskStride;
+   context.m_cBytesTaskFastBins = cBytesTaskFastBins;
+   context.m_aTaskBins = reinterpret_cast<unsigned char*>(aTaskBins);
+   context.m_aMainBins = aMainBins;
+
+   error = ParallelFor(cTasks, BinSumsInteractionTask, &context);
+   if(Error_None != error) {
+      return error;
+   }
 
+   for(size_t iTask = 1; iTask < cTasks; ++iTask) {
       ConvertAddBin(cScores,
             pInteractionCore->IsHessian(),
             cTensorBins,
-            sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes,
-            sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes,
+            std::is_same<UIntMain, uint64_t>::value,
+            std::is_same<FloatMain, double>::value,
             true,
             true,
-            aFastBins,
+            IndexBin(aTaskBins, iTask * cBytesTaskStride + cBytesTaskFastBins),
             nullptr,
             nullptr,
             std::is_same<UIntMain, uint64_t>::value,
             std::is_same<FloatMain, double>::value,
             aMainBins);
-
-      ++pSubset;
-   } while(pSubsetsEnd != pSubset);
+   }
 
    // TODO: we can exit here back to python to allow caller modification to our bins
 
@@ -11,7 +11,8 @@
 #include <vector> // std::vector (used in std::priority_queue)
 #include <queue> // std::priority_queue
 #include <set> // std::set
-#include <string.h> // strchr, memmove
+#include <string.h> // strchr, memmove, memset
+#include <type_traits> // std::is_standard_layout
 
 #include "libebm.h" // EBM_API_BODY
 #include "logging.h" // EBM_ASSERT
@@ -23,6 +24,7 @@
 #include "common.hpp" // IsConvertError
 
 #include "RandomDeterministic.hpp"
+#include "ThreadPool.hpp"
 
 // TODO: check this file for how we handle subnormal numbers.  NEVER RETURN SUBNORMALS!
 
@@ -3193,4 +3195,591 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
    return error;
 }
 
+struct CutQuantileManyContext final {
+   IntEbm m_countSamples;
+   const double* const* m_aFeatureCols;
+   const IntEbm* m_aMinSamplesBin;
+   const BoolEbm* m_aIsRounded;
+   const IntEbm* m_aCutOffsetsMax;
+   IntEbm* m_aCountCuts;
+   double* m_aCuts;
+};
+
+static ErrorEbm CutQuantileManyTask(void* const pContext, const size_t iFeature) {
+   const CutQuantileManyContext* const p = static_cast<const CutQuantileManyContext*>(pContext);
+   return CutQuantile(p->m_countSamples,
+         p->m_aFeatureCols[iFeature],
+         p->m_aMinSamplesBin[iFeature],
+         p->m_aIsRounded[iFeature],
+         &p->m_aCountCuts[iFeature],
+         p->m_aCuts + static_cast<size_t>(p->m_aCutOffsetsMax[iFeature]));
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantileMany(IntEbm countFeatures,
+      IntEbm countSamples,
+      const double* const* featureCols,
+      const IntEbm* minSamplesBin,
+      const BoolEbm* isRounded,
+      const IntEbm* countCutsMax,
+      IntEbm* cutOffsetsOut,
+      double* cutsLowerBoundInclusiveOut) {
+   LOG_N(Trace_Info,
+         "Entered CutQuantileMany: "
+         "countFeatures=%" IntEbmPrintf ", "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureCols=%p, "
+         "minSamplesBin=%p, "
+         "isRounded=%p, "
+         "countCutsMax=%p, "
+         "cutOffsetsOut=%p, "
+         "cutsLowerBoundInclusiveOut=%p",
+         countFeatures,
+         countSamples,
+         static_cast<const void*>(featureCols),
+         static_cast<const void*>(minSamplesBin),
+         static_cast<const void*>(isRounded),
+         static_cast<const void*>(countCutsMax),
+         static_cast<void*>(cutOffsetsOut),
+         static_cast<void*>(cutsLowerBoundInclusiveOut));
+
+   if(IsConvertError<size_t>(countFeatures)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileMany countFeatures is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   if(IsAddError(cFeatures, size_t{1}) || IsMultiplyError(sizeof(IntEbm), cFeatures + size_t{1})) {
+      LOG_0(Trace_Error, "ERROR CutQuantileMany countFeatures too large");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == cutOffsetsOut) {
+      LOG_0(Trace_Error, "ERROR CutQuantileMany nullptr == cutOffsetsOut");
+      return Error_IllegalParamVal;
+   }
+   if(size_t{0} == cFeatures) {
+      cutOffsetsOut[0] = IntEbm{0};
+      return Error_None;
+   }
+   if(nullptr == featureCols || nullptr == minSamplesBin || nullptr == isRounded || nullptr == countCutsMax) {
+      LOG_0(Trace_Error, "ERROR CutQuantileMany the per-feature arrays cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   // cutOffsetsOut holds the maximum extents while cutting.  We pack the cuts together afterwards
+   size_t cCutsTotalMax = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const IntEbm countCuts = countCutsMax[iFeature];
+      if(IsConvertError<size_t>(countCuts)) {
+         LOG_0(Trace_Error, "ERROR CutQuantileMany countCutsMax is outside the range of a valid size");
+         return Error_IllegalParamVal;
+      }
+      cutOffsetsOut[iFeature] = static_cast<IntEbm>(cCutsTotalMax);
+      if(IsAddError(cCutsTotalMax, static_cast<size_t>(countCuts)) ||
+            IsConvertError<IntEbm>(cCutsTotalMax + static_cast<size_t>(countCuts))) {
+         LOG_0(Trace_Error, "ERROR CutQuantileMany the total of countCutsMax is too large");
+         return Error_IllegalParamVal;
+      }
+      cCutsTotalMax += static_cast<size_t>(countCuts);
+   }
+   cutOffsetsOut[cFeatures] = static_cast<IntEbm>(cCutsTotalMax);
+   if(size_t{0} != cCutsTotalMax && nullptr == cutsLowerBoundInclusiveOut) {
+      LOG_0(Trace_Error, "ERROR CutQuantileMany nullptr == cutsLowerBoundInclusiveOut");
+      return Error_IllegalParamVal;
+   }
+
+   IntEbm* const aCountCuts = static_cast<IntEbm*>(malloc(sizeof(IntEbm) * cFeatures));
+   if(nullptr == aCountCuts) {
+      LOG_0(Trace_Error, "ERROR CutQuantileMany nullptr == aCountCuts");
+      return Error_OutOfMemory;
+   }
+   memcpy(aCountCuts, countCutsMax, sizeof(IntEbm) * cFeatures);
+
+   CutQuantileManyContext context;
+   context.m_countSamples = countSamples;
+   context.m_aFeatureCols = featureCols;
+   context.m_aMinSamplesBin = minSamplesBin;
+   context.m_aIsRounded = isRounded;
+   context.m_aCutOffsetsMax = cutOffsetsOut;
+   context.m_aCountCuts = aCountCuts;
+   context.m_aCuts = cutsLowerBoundInclusiveOut;
+
+   const ErrorEbm error = ParallelFor(cFeatures, CutQuantileManyTask, &context);
+   if(Error_None != error) {
+      free(aCountCuts);
+      return error;
+   }
+
+   size_t iCutPacked = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const size_t iCutMax = static_cast<size_t>(cutOffsetsOut[iFeature]);
+      const size_t cCuts = static_cast<size_t>(aCountCuts[iFeature]);
+      EBM_ASSERT(iCutPacked <= iCutMax);
+      if(iCutPacked != iCutMax && size_t{0} != cCuts) {
+         memmove(cutsLowerBoundInclusiveOut + iCutPacked,
+               cutsLowerBoundInclusiveOut + iCutMax,
+               sizeof(*cutsLowerBoundInclusiveOut) * cCuts);
+      }
+      cutOffsetsOut[iFeature] = static_cast<IntEbm>(iCutPacked);
+      iCutPacked += cCuts;
+   }
+   cutOffsetsOut[cFeatures] = static_cast<IntEbm>(iCutPacked);
+
+   free(aCountCuts);
+
+   return Error_None;
+}
+
+// The quantile sketch is a mergeable summary of a column that can replace the full sorted copy that CutQuantile
+// makes.  Each level holds up to cItemsPerLevel values, and a value at level h stands in for 2^h samples.  When a
+// level fills, we sort it and promote every other value to the next level, alternating which half survives so that
+// the rank errors tend to cancel.  Sketches from different chunks, threads, or processes can be merged as long as
+// they have the same cItemsPerLevel.  The sketch is a flat buffer so that it can be passed between processes.
+static constexpr uint64_t k_quantileSketchId = 0x2B91; // random 15 bit number
+static constexpr size_t k_cQuantileSketchLevels = 48;
+// CutQuantileSketch resamples the weighted summary into this many values per item in a level
+static constexpr size_t k_cResamplesPerLevelItem = 4;
+
+struct QuantileSketchHeader final {
+   uint64_t m_id;
+   uint64_t m_cItemsPerLevel;
+   uint64_t m_cSamples;
+   uint64_t m_iParity;
+   double m_min;
+   double m_max;
+   uint64_t m_acLevelItems[k_cQuantileSketchLevels];
+   // followed by k_cQuantileSketchLevels arrays of m_cItemsPerLevel doubles
+};
+static_assert(std::is_standard_layout<QuantileSketchHeader>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<QuantileSketchHeader>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(0 == sizeof(QuantileSketchHeader) % sizeof(double), "the levels need to be aligned");
+
+struct SketchItem final {
+   double m_val;
+   uint64_t m_weight;
+};
+
+class CompareSketchItem final {
+ public:
+   INLINE_ALWAYS bool operator()(const SketchItem& lhs, const SketchItem& rhs) const noexcept {
+      return lhs.m_val < rhs.m_val;
+   }
+};
+
+INLINE_ALWAYS static double* GetSketchLevel(QuantileSketchHeader* const pHeader, const size_t iLevel) noexcept {
+   return reinterpret_cast<double*>(pHeader + 1) + static_cast<size_t>(pHeader->m_cItemsPerLevel) * iLevel;
+}
+
+INLINE_ALWAYS static const double* GetSketchLevel(
+      const QuantileSketchHeader* const pHeader, const size_t iLevel) noexcept {
+   return reinterpret_cast<const double*>(pHeader + 1) + static_cast<size_t>(pHeader->m_cItemsPerLevel) * iLevel;
+}
+
+static ErrorEbm CheckQuantileSketch(const QuantileSketchHeader* const pHeader) noexcept {
+   if(nullptr == pHeader) {
+      LOG_0(Trace_Error, "ERROR CheckQuantileSketch nullptr == pHeader");
+      return Error_IllegalParamVal;
+   }
+   if(k_quantileSketchId != pHeader->m_id) {
+      LOG_0(Trace_Error, "ERROR CheckQuantileSketch k_quantileSketchId != pHeader->m_id");
+      return Error_IllegalParamVal;
+   }
+   const uint64_t cItemsPerLevel = pHeader->m_cItemsPerLevel;
+   if(cItemsPerLevel < uint64_t{2} || uint64_t{0} != (cItemsPerLevel & uint64_t{1}) ||
+         IsConvertError<size_t>(cItemsPerLevel)) {
+      LOG_0(Trace_Error, "ERROR CheckQuantileSketch m_cItemsPerLevel must be an even number of at least 2");
+      return Error_IllegalParamVal;
+   }
+   uint64_t cSamples = 0;
+   for(size_t iLevel = 0; iLevel < k_cQuantileSketchLevels; ++iLevel) {
+      const uint64_t cLevelItems = pHeader->m_acLevelItems[iLevel];
+      if(cItemsPerLevel <= cLevelItems) {
+         LOG_0(Trace_Error, "ERROR CheckQuantileSketch cItemsPerLevel <= cLevelItems");
+         return Error_IllegalParamVal;
+      }
+      if(uint64_t{0} != cLevelItems) {
+         if((std::numeric_limits<uint64_t>::max() >> iLevel) < cLevelItems ||
+               IsAddError(cSamples, cLevelItems << iLevel)) {
+            LOG_0(Trace_Error, "ERROR CheckQuantileSketch too many samples");
+            return Error_IllegalParamVal;
+         }
+         cSamples += cLevelItems << iLevel;
+      }
+   }
+   if(cSamples != pHeader->m_cSamples) {
+      LOG_0(Trace_Error, "ERROR CheckQuantileSketch cSamples != pHeader->m_cSamples");
+      return Error_IllegalParamVal;
+   }
+   return Error_None;
+}
+
+static ErrorEbm CompactSketchLevel(QuantileSketchHeader* const pHeader, const size_t iLevel) noexcept;
+
+static ErrorEbm AppendSketchLevel(QuantileSketchHeader* const pHeader, const size_t iLevel, const double val) noexcept {
+   if(k_cQuantileSketchLevels <= iLevel) {
+      LOG_0(Trace_Error, "ERROR AppendSketchLevel the sketch has too many samples for its cItemsPerLevel");
+      return Error_IllegalParamVal;
+   }
+   double* const aLevel = GetSketchLevel(pHeader, iLevel);
+   aLevel[pHeader->m_acLevelItems[iLevel]] = val;
+   ++pHeader->m_acLevelItems[iLevel];
+   if(pHeader->m_cItemsPerLevel == pHeader->m_acLevelItems[iLevel]) {
+      return CompactSketchLevel(pHeader, iLevel);
+   }
+   return Error_None;
+}
+
+static ErrorEbm CompactSketchLevel(QuantileSketchHeader* const pHeader, const size_t iLevel) noexcept {
+   const size_t cItemsPerLevel = static_cast<size_t>(pHeader->m_cItemsPerLevel);
+   EBM_ASSERT(cItemsPerLevel == pHeader->m_acLevelItems[iLevel]);
+
+   double* const aLevel = GetSketchLevel(pHeader, iLevel);
+   std::sort(aLevel, aLevel + cItemsPerLevel);
+
+   const size_t iParity = static_cast<size_t>(pHeader->m_iParity & uint64_t{1});
+   pHeader->m_iParity = static_cast<uint64_t>(iParity ^ size_t{1});
+
+   // the surviving half is promoted to the next level where each value counts twice.  Promotion can cascade
+   // upwards, but never back into this level, so we can keep reading from aLevel while appending
+   for(size_t i = iParity; i < cItemsPerLevel; i += size_t{2}) {
+      const ErrorEbm error = AppendSketchLevel(pHeader, iLevel + size_t{1}, aLevel[i]);
+      if(Error_None != error) {
+         return error;
+      }
+   }
+   pHeader->m_acLevelItems[iLevel] = 0;
+   return Error_None;
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureQuantileSketch(IntEbm countItemsPerLevel) {
+   if(countItemsPerLevel < IntEbm{2} || IntEbm{0} != (countItemsPerLevel & IntEbm{1})) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch countItemsPerLevel must be an even number of at least 2");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countItemsPerLevel)) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch IsConvertError<size_t>(countItemsPerLevel)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cItemsPerLevel = static_cast<size_t>(countItemsPerLevel);
+   if(IsMultiplyError(sizeof(double), k_cQuantileSketchLevels, cItemsPerLevel)) {
+      LOG_0(Trace_Error,
+            "ERROR MeasureQuantileSketch IsMultiplyError(sizeof(double), k_cQuantileSketchLevels, cItemsPerLevel)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesLevels = sizeof(double) * k_cQuantileSketchLevels * cItemsPerLevel;
+   if(IsAddError(sizeof(QuantileSketchHeader), cBytesLevels)) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch IsAddError(sizeof(QuantileSketchHeader), cBytesLevels)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytes = sizeof(QuantileSketchHeader) + cBytesLevels;
+   if(IsConvertError<IntEbm>(cBytes)) {
+      LOG_0(Trace_Error, "ERROR MeasureQuantileSketch IsConvertError<IntEbm>(cBytes)");
+      return Error_IllegalParamVal;
+   }
+   return static_cast<IntEbm>(cBytes);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION InitQuantileSketch(
+      IntEbm countItemsPerLevel, IntEbm countBytesAllocated, void* sketchOut) {
+   LOG_N(Trace_Info,
+         "Entered InitQuantileSketch: "
+         "countItemsPerLevel=%" IntEbmPrintf ", "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "sketchOut=%p",
+         countItemsPerLevel,
+         countBytesAllocated,
+         sketchOut);
+
+   const IntEbm countBytes = MeasureQuantileSketch(countItemsPerLevel);
+   if(countBytes < IntEbm{0}) {
+      return static_cast<ErrorEbm>(countBytes);
+   }
+   if(countBytesAllocated < countBytes) {
+      LOG_0(Trace_Error, "ERROR InitQuantileSketch countBytesAllocated < countBytes");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == sketchOut) {
+      LOG_0(Trace_Error, "ERROR InitQuantileSketch nullptr == sketchOut");
+      return Error_IllegalParamVal;
+   }
+
+   // only the header needs initializing since the levels are written before they are read
+   QuantileSketchHeader* const pHeader = reinterpret_cast<QuantileSketchHeader*>(sketchOut);
+   memset(pHeader, 0, sizeof(*pHeader));
+   pHeader->m_id = k_quantileSketchId;
+   pHeader->m_cItemsPerLevel = static_cast<uint64_t>(countItemsPerLevel);
+   pHeader->m_min = std::numeric_limits<double>::max();
+   pHeader->m_max = std::numeric_limits<double>::lowest();
+
+   return Error_None;
+}
+
+// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
+static int g_cLogEnterAddQuantileSketch = 25;
+static int g_cLogExitAddQuantileSketch = 25;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AddQuantileSketch(
+      IntEbm countSamples, const double* featureVals, void* sketchInOut) {
+   LOG_COUNTED_N(&g_cLogEnterAddQuantileSketch,
+         Trace_Info,
+         Trace_Verbose,
+         "Entered AddQuantileSketch: "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureVals=%p, "
+         "sketchInOut=%p",
+         countSamples,
+         static_cast<const void*>(featureVals),
+         sketchInOut);
+
+   QuantileSketchHeader* const pHeader = reinterpret_cast<QuantileSketchHeader*>(sketchInOut);
+   ErrorEbm error = CheckQuantileSketch(pHeader);
+   if(Error_None != error) {
+      return error;
+   }
+   if(countSamples <= IntEbm{0}) {
+      if(countSamples < IntEbm{0}) {
+         LOG_0(Trace_Error, "ERROR AddQuantileSketch countSamples < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      }
+      return Error_None;
+   }
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR AddQuantileSketch IsConvertError<size_t>(countSamples)");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == featureVals) {
+      LOG_0(Trace_Error, "ERROR AddQuantileSketch nullptr == featureVals");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+
+   const size_t cItemsPerLevel = static_cast<size_t>(pHeader->m_cItemsPerLevel);
+   double* const aLevel0 = GetSketchLevel(pHeader, 0);
+   size_t cLevel0 = static_cast<size_t>(pHeader->m_acLevelItems[0]);
+   uint64_t cSamplesAdded = 0;
+   double minVal = pHeader->m_min;
+   double maxVal = pHeader->m_max;
+
+   const double* pVal = featureVals;
+   const double* const pValsEnd = featureVals + cSamples;
+   do {
+      double val = *pVal;
+      ++pVal;
+      if(UNLIKELY(std::isnan(val))) {
+         // missing values go into their own bin and do not participate in the cuts
+         continue;
+      }
+      // the same treatment as RemoveMissingValsAndReplaceInfinities
+      val = std::numeric_limits<double>::max() < val ? std::numeric_limits<double>::max() : val;
+      val = val < std::numeric_limits<double>::lowest() ? std::numeric_limits<double>::lowest() : val;
+      minVal = val < minVal ? val : minVal;
+      maxVal = maxVal < val ? val : maxVal;
+      ++cSamplesAdded;
+
+      aLevel0[cLevel0] = val;
+      ++cLevel0;
+      if(UNLIKELY(cItemsPerLevel == cLevel0)) {
+         pHeader->m_acLevelItems[0] = static_cast<uint64_t>(cLevel0);
+         error = CompactSketchLevel(pHeader, 0);
+         if(Error_None != error) {
+            // the sketch is no longer consistent.  Mark it so that it will not be used again
+            pHeader->m_id = 0;
+            return error;
+         }
+         cLevel0 = 0;
+      }
+   } while(pValsEnd != pVal);
+
+   pHeader->m_acLevelItems[0] = static_cast<uint64_t>(cLevel0);
+   pHeader->m_cSamples += cSamplesAdded;
+   pHeader->m_min = minVal;
+   pHeader->m_max = maxVal;
+
+   LOG_COUNTED_N(&g_cLogExitAddQuantileSketch,
+         Trace_Info,
+         Trace_Verbose,
+         "Exited AddQuantileSketch: "
+         "cSamplesAdded=%" PRIu64,
+         cSamplesAdded);
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION MergeQuantileSketch(const void* sketch, void* sketchInOut) {
+   LOG_N(Trace_Info, "Entered MergeQuantileSketch: sketch=%p, sketchInOut=%p", sketch, sketchInOut);
+
+   const QuantileSketchHeader* const pHeaderFrom = reinterpret_cast<const QuantileSketchHeader*>(sketch);
+   ErrorEbm error = CheckQuantileSketch(pHeaderFrom);
+   if(Error_None != error) {
+      return error;
+   }
+   QuantileSketchHeader* const pHeader = reinterpret_cast<QuantileSketchHeader*>(sketchInOut);
+   error = CheckQuantileSketch(pHeader);
+   if(Error_None != error) {
+      return error;
+   }
+   if(pHeaderFrom == pHeader) {
+      LOG_0(Trace_Error, "ERROR MergeQuantileSketch a sketch cannot be merged into itself");
+      return Error_IllegalParamVal;
+   }
+   if(pHeaderFrom->m_cItemsPerLevel != pHeader->m_cItemsPerLevel) {
+      LOG_0(Trace_Error, "ERROR MergeQuantileSketch the sketches have different cItemsPerLevel");
+      return Error_IllegalParamVal;
+   }
+   if(IsAddError(pHeader->m_cSamples, pHeaderFrom->m_cSamples)) {
+      LOG_0(Trace_Error, "ERROR MergeQuantileSketch IsAddError(pHeader->m_cSamples, pHeaderFrom->m_cSamples)");
+      return Error_IllegalParamVal;
+   }
+
+   for(size_t iLevel = 0; iLevel < k_cQuantileSketchLevels; ++iLevel) {
+      const double* const aLevelFrom = GetSketchLevel(pHeaderFrom, iLevel);
+      const size_t cLevelItemsFrom = static_cast<size_t>(pHeaderFrom->m_acLevelItems[iLevel]);
+      for(size_t i = 0; i < cLevelItemsFrom; ++i) {
+         error = AppendSketchLevel(pHeader, iLevel, aLevelFrom[i]);
+         if(Error_None != error) {
+            pHeader->m_id = 0;
+            return error;
+         }
+      }
+   }
+   pHeader->m_cSamples += pHeaderFrom->m_cSamples;
+   pHeader->m_min = pHeaderFrom->m_min < pHeader->m_min ? pHeaderFrom->m_min : pHeader->m_min;
+   pHeader->m_max = pHeader->m_max < pHeaderFrom->m_max ? pHeaderFrom->m_max : pHeader->m_max;
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CutQuantileSketch(const void* sketch,
+      IntEbm minSamplesBin,
+      BoolEbm isRounded,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut) {
+   LOG_N(Trace_Info,
+         "Entered CutQuantileSketch: "
+         "sketch=%p, "
+         "minSamplesBin=%" IntEbmPrintf ", "
+         "isRounded=%s, "
+         "countCutsInOut=%p, "
+         "cutsLowerBoundInclusiveOut=%p",
+         sketch,
+         minSamplesBin,
+         ObtainTruth(isRounded),
+         static_cast<void*>(countCutsInOut),
+         static_cast<void*>(cutsLowerBoundInclusiveOut));
+
+   if(nullptr == countCutsInOut) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == countCutsInOut");
+      return Error_IllegalParamVal;
+   }
+
+   const QuantileSketchHeader* const pHeader = reinterpret_cast<const QuantileSketchHeader*>(sketch);
+   ErrorEbm error = CheckQuantileSketch(pHeader);
+   if(Error_None != error) {
+      *countCutsInOut = IntEbm{0};
+      return error;
+   }
+
+   const uint64_t cSamples = pHeader->m_cSamples;
+   if(cSamples <= uint64_t{1} || IsConvertError<size_t>(cSamples)) {
+      // can't cut 1 sample
+      *countCutsInOut = IntEbm{0};
+      return Error_None;
+   }
+
+   minSamplesBin = minSamplesBin <= IntEbm{0} ? IntEbm{1} : minSamplesBin;
+   if(static_cast<uint64_t>(cSamples >> 1) < static_cast<UIntEbm>(minSamplesBin)) {
+      // the same check as CutQuantile, but on the true number of samples instead of the resampled count
+      *countCutsInOut = IntEbm{0};
+      return Error_None;
+   }
+
+   size_t cItems = 0;
+   for(size_t iLevel = 0; iLevel < k_cQuantileSketchLevels; ++iLevel) {
+      cItems += static_cast<size_t>(pHeader->m_acLevelItems[iLevel]);
+   }
+   EBM_ASSERT(size_t{1} <= cItems); // since 1 < cSamples
+
+   if(IsMultiplyError(sizeof(SketchItem), cItems)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch IsMultiplyError(sizeof(SketchItem), cItems)");
+      *countCutsInOut = IntEbm{0};
+      return Error_OutOfMemory;
+   }
+   SketchItem* const aItems = static_cast<SketchItem*>(malloc(sizeof(SketchItem) * cItems));
+   if(nullptr == aItems) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == aItems");
+      *countCutsInOut = IntEbm{0};
+      return Error_OutOfMemory;
+   }
+
+   SketchItem* pItem = aItems;
+   for(size_t iLevel = 0; iLevel < k_cQuantileSketchLevels; ++iLevel) {
+      const double* const aLevel = GetSketchLevel(pHeader, iLevel);
+      const size_t cLevelItems = static_cast<size_t>(pHeader->m_acLevelItems[iLevel]);
+      const uint64_t weight = uint64_t{1} << iLevel;
+      for(size_t i = 0; i < cLevelItems; ++i) {
+         pItem->m_val = aLevel[i];
+         pItem->m_weight = weight;
+         ++pItem;
+      }
+   }
+   std::sort(aItems, aItems + cItems, CompareSketchItem());
+
+   // CutQuantile works on sorted values where long runs of identical values are uncuttable, so we turn the
+   // weighted summary back into equally weighted values.  If the sketch has never been compacted then every
+   // weight is 1 and we recover the original sorted column exactly, giving identical cuts to CutQuantile.
+   const size_t cResampledMax = static_cast<size_t>(pHeader->m_cItemsPerLevel) * k_cResamplesPerLevelItem;
+   const size_t cResampled =
+         static_cast<size_t>(cSamples) < cResampledMax ? static_cast<size_t>(cSamples) : cResampledMax;
+
+   if(IsMultiplyError(sizeof(double), cResampled)) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch IsMultiplyError(sizeof(double), cResampled)");
+      free(aItems);
+      *countCutsInOut = IntEbm{0};
+      return Error_OutOfMemory;
+   }
+   double* const aResampled = static_cast<double*>(malloc(sizeof(double) * cResampled));
+   if(nullptr == aResampled) {
+      LOG_0(Trace_Error, "ERROR CutQuantileSketch nullptr == aResampled");
+      free(aItems);
+      *countCutsInOut = IntEbm{0};
+      return Error_OutOfMemory;
+   }
+
+   const double samplesPerResample = static_cast<double>(cSamples) / static_cast<double>(cResampled);
+   const SketchItem* pItemCur = aItems;
+   const SketchItem* const pItemLast = aItems + cItems - 1;
+   double rankHigh = static_cast<double>(pItemCur->m_weight);
+   for(size_t iResampled = 0; iResampled < cResampled; ++iResampled) {
+      const double rank = (static_cast<double>(iResampled) + 0.5) * samplesPerResample;
+      while(rankHigh <= rank && pItemLast != pItemCur) {
+         ++pItemCur;
+         rankHigh += static_cast<double>(pItemCur->m_weight);
+      }
+      aResampled[iResampled] = pItemCur->m_val;
+   }
+   free(aItems);
+
+   // the sketch knows the exact extremes even if compaction discarded them
+   aResampled[0] = pHeader->m_min;
+   aResampled[cResampled - 1] = pHeader->m_max;
+
+   // scale minSamplesBin to the resampled count, rounding up so that bins do not drop below the requested size
+   const double minSamplesBinResampled = std::ceil(static_cast<double>(minSamplesBin) / samplesPerResample);
+   const size_t cResampledHalf = cResampled >> 1;
+   const IntEbm minSamplesBinScaled = static_cast<double>(cResampledHalf) < minSamplesBinResampled ?
+         static_cast<IntEbm>(cResampledHalf) :
+         static_cast<IntEbm>(minSamplesBinResampled);
+
+   error = CutQuantile(static_cast<IntEbm>(cResampled),
+         aResampled,
+         minSamplesBinScaled,
+         isRounded,
+         countCutsInOut,
+         cutsLowerBoundInclusiveOut);
+
+   free(aResampled);
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
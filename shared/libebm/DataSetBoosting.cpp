@@ -6,12 +6,16 @@
 
 #include <stdlib.h> // free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <cmath> // std::exp2, std::log2
+#include <algorithm> // std::sort
+#include <functional> // std::greater
 
 #define ZONE_main
 #include "zones.h"
 
 #include "ebm_internal.hpp"
 #include "RandomDeterministic.hpp" // RandomDeterministic
+#include "RandomCounter.hpp" // RandomCounter
 #include "RandomNondeterministic.hpp" // RandomNondeterministic
 #include "Feature.hpp" // Feature
 #include "Term.hpp" // Term
@@ -39,6 +43,8 @@ void DataSubsetBoosting::DestructDataSubsetBoosting(const size_t cTerms, const s
       free(m_aaTermData);
    }
 
+   FreeGradientSample();
+   AlignedFree(m_aSampleWeights);
    AlignedFree(m_aTargetData);
    AlignedFree(m_aSampleScores);
    AlignedFree(m_aGradHess);
@@ -46,6 +52,47 @@ void DataSubsetBoosting::DestructDataSubsetBoosting(const size_t cTerms, const s
    LOG_0(Trace_Info, "Exited DataSubsetBoosting::DestructDataSubsetBoosting");
 }
 
+template<typename TFloat>
+static void FillPoissonBagWeightsInternal(
+      RandomCounter& rng, const size_t cSamples, const TFloat* pSampleWeight, TFloat* pWeightTo) {
+   const TFloat* const pWeightToEnd = pWeightTo + cSamples;
+   do {
+      const uint8_t cOccurrences = InnerBag::NextPoissonOccurrences(rng);
+      double weight = static_cast<double>(cOccurrences);
+      if(nullptr != pSampleWeight) {
+         weight *= static_cast<double>(*pSampleWeight);
+         ++pSampleWeight;
+      }
+      *pWeightTo = static_cast<TFloat>(weight);
+      ++pWeightTo;
+   } while(pWeightToEnd != pWeightTo);
+}
+
+void DataSubsetBoosting::FillPoissonBagWeights(const size_t iBag, void* const aWeightsOut) const {
+   EBM_ASSERT(m_bPoissonBags);
+   EBM_ASSERT(nullptr != aWeightsOut);
+   EBM_ASSERT(1 <= m_cSamples);
+
+   // the stream position is the sample's index within the whole DataSetBoosting, so the result does not depend on
+   // how the samples were split into subsets, and InitBags reproduces the same counts when it totals the bag
+   RandomCounter rng;
+   rng.Initialize(m_bagRng);
+   rng.Seek(GetInnerBag(iBag)->GetPoissonStream(), static_cast<uint64_t>(m_iSampleFirst));
+
+   if(sizeof(FloatBig) == m_pObjective->m_cFloatBytes) {
+      FillPoissonBagWeightsInternal(rng,
+            m_cSamples,
+            static_cast<const FloatBig*>(m_aSampleWeights),
+            static_cast<FloatBig*>(aWeightsOut));
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == m_pObjective->m_cFloatBytes);
+      FillPoissonBagWeightsInternal(rng,
+            m_cSamples,
+            static_cast<const FloatSmall*>(m_aSampleWeights),
+            static_cast<FloatSmall*>(aWeightsOut));
+   }
+}
+
 ErrorEbm DataSetBoosting::InitGradHess(const bool bAllocateHessians, const size_t cScores) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitGradHess");
 
@@ -76,7 +123,7 @@ ErrorEbm DataSetBoosting::InitGradHess(const bool bAllocateHessians, const size_
       const size_t cBytesGradHess = pSubset->m_pObjective->m_cFloatBytes * cTotalScores * cSubsetSamples;
       ANALYSIS_ASSERT(0 != cBytesGradHess);
 
-      void* const aGradHess = AlignedAlloc(cBytesGradHess);
+      void* const aGradHess = pSubset->AlignedAllocPlaced(cBytesGradHess);
       if(nullptr == aGradHess) {
          LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitGradHess nullptr == aGradHess");
          return Error_OutOfMemory;
@@ -120,7 +167,7 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cScores * cSubsetSamples;
          ANALYSIS_ASSERT(0 != cBytes);
-         void* pSampleScore = AlignedAlloc(cBytes);
+         void* pSampleScore = pSubset->AlignedAllocPlaced(cBytes);
          if(nullptr == pSampleScore) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSampleScores nullptr == pSampleScore");
             return Error_OutOfMemory;
@@ -153,7 +200,7 @@ ErrorEbm DataSetBoosting::InitSampleScores(
          }
          const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cScores * cSubsetSamples;
          ANALYSIS_ASSERT(0 != cBytes);
-         void* pSampleScore = AlignedAlloc(cBytes);
+         void* pSampleScore = pSubset->AlignedAllocPlaced(cBytes);
          if(nullptr == pSampleScore) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitSampleScores nullptr == pSampleScore");
             return Error_OutOfMemory;
@@ -214,149 +261,278 @@ ErrorEbm DataSetBoosting::InitSampleScores(
 }
 WARNING_POP
 
+template<typename TFloat, typename TUInt>
+static void InitQueryTargets(const size_t cSamples,
+      void* const aTargetData,
+      const size_t** const ppQuerySamples,
+      double* const aGainsSorted) {
+   // Ranking objectives read the normalized gain (2^relevance - 1) / IDCG of each document, followed by the number
+   // of documents in the document's query.  The ideal DCG only depends on the relevances, so we compute it once here
+   // instead of on every boosting step.  A query without any relevant documents gets zero gains.
+   TFloat* const aGains = static_cast<TFloat*>(aTargetData);
+   TUInt* const aCounts = reinterpret_cast<TUInt*>(aGains + cSamples);
+
+   size_t iSample = 0;
+   do {
+      const size_t cQuerySamples = **ppQuerySamples;
+      ++*ppQuerySamples;
+      EBM_ASSERT(1 <= cQuerySamples);
+      EBM_ASSERT(cQuerySamples <= cSamples - iSample);
+
+      for(size_t i = 0; i < cQuerySamples; ++i) {
+         aGainsSorted[i] = std::exp2(static_cast<double>(aGains[iSample + i])) - 1.0;
+      }
+      std::sort(aGainsSorted, aGainsSorted + cQuerySamples, std::greater<double>());
+      double idcg = 0.0;
+      for(size_t i = 0; i < cQuerySamples; ++i) {
+         idcg += aGainsSorted[i] / std::log2(static_cast<double>(i + 2));
+      }
+      const double scale = 0.0 < idcg ? 1.0 / idcg : 0.0;
+
+      for(size_t i = 0; i < cQuerySamples; ++i) {
+         const double gain = std::exp2(static_cast<double>(aGains[iSample + i])) - 1.0;
+         aGains[iSample + i] = static_cast<TFloat>(gain * scale);
+         aCounts[iSample + i] = static_cast<TUInt>(cQuerySamples);
+      }
+      iSample += cQuerySamples;
+   } while(cSamples != iSample);
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
-ErrorEbm DataSetBoosting::InitTargetData(
-      const unsigned char* const pDataSetShared, const BagEbm direction, const BagEbm* const aBag) {
+ErrorEbm DataSetBoosting::InitTargetData(const unsigned char* const pDataSetShared,
+      const BagEbm direction,
+      const BagEbm* const aBag,
+      const size_t* const aQuerySamples) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitTargetData");
 
    EBM_ASSERT(nullptr != pDataSetShared);
    EBM_ASSERT(BagEbm{-1} == direction || BagEbm{1} == direction);
 
-   ptrdiff_t cClasses;
-   const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, 0, &cClasses);
-   EBM_ASSERT(nullptr != aTargets); // we previously called GetDataSetSharedTarget and got back non-null result
+   UIntShared countSamples;
+   size_t cFeatures;
+   size_t cWeights;
+   size_t cTargets;
+   // BoosterCore::Create checked the dataset before building the data sets
+   ErrorEbm error = GetDataSetSharedHeader(pDataSetShared, true, &countSamples, &cFeatures, &cWeights, &cTargets);
+   if(Error_None != error) {
+      // already logged
+      return error;
+   }
+   EBM_ASSERT(1 <= cTargets);
 
    EBM_ASSERT(nullptr != m_aSubsets);
    EBM_ASSERT(1 <= m_cSubsets);
-   DataSubsetBoosting* pSubset = m_aSubsets;
-   const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_cSubsets;
+   const DataSubsetBoosting* const pSubsetsEnd = m_aSubsets + m_cSubsets;
 
-   const BagEbm* pSampleReplication = aBag;
    const bool isLoopValidation = direction < BagEbm{0};
    EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if aBag is nullptr then we have no validation samples
 
-   BagEbm replication = 0;
-   if(ptrdiff_t{Task_GeneralClassification} <= cClasses) {
-      const UIntShared* pTargetFrom = static_cast<const UIntShared*>(aTargets);
-      UIntShared iData;
-      do {
-         const size_t cSubsetSamples = pSubset->m_cSamples;
-         EBM_ASSERT(1 <= cSubsetSamples);
+   // multitask targets are interleaved per SIMD pack as [target][lane] so that the objective can read the targets
+   // of each sample right after it reads the packed bin index.  With a single target this is just sample order.
+   size_t iTarget = 0;
+   do {
+      ptrdiff_t cClasses;
+      const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses);
+      EBM_ASSERT(nullptr != aTargets); // we previously called GetDataSetSharedTarget and got back non-null result
 
-         if(IsMultiplyError(pSubset->m_pObjective->m_cUIntBytes, cSubsetSamples)) {
-            LOG_0(Trace_Warning,
-                  "WARNING DataSetBoosting::InitTargetData IsMultiplyError(pSubset->m_pObjective->m_cUIntBytes, "
-                  "cSubsetSamples)");
-            return Error_OutOfMemory;
-         }
-         const size_t cBytes = pSubset->m_pObjective->m_cUIntBytes * cSubsetSamples;
-         void* pTargetTo = AlignedAlloc(cBytes);
-         if(nullptr == pTargetTo) {
-            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == pTargetTo");
-            return Error_OutOfMemory;
-         }
-         pSubset->m_aTargetData = pTargetTo;
-         const void* const pTargetToEnd = IndexByte(pTargetTo, cBytes);
+      DataSubsetBoosting* pSubset = m_aSubsets;
+      const BagEbm* pSampleReplication = aBag;
+      BagEbm replication = 0;
+      if(ptrdiff_t{Task_GeneralClassification} <= cClasses) {
+         const UIntShared* pTargetFrom = static_cast<const UIntShared*>(aTargets);
+         UIntShared iData;
          do {
-            if(BagEbm{0} == replication) {
-               replication = 1;
-               if(nullptr != pSampleReplication) {
-                  bool isItemValidation;
-                  do {
-                     do {
-                        replication = *pSampleReplication;
-                        ++pSampleReplication;
-                        ++pTargetFrom;
-                     } while(BagEbm{0} == replication);
-                     isItemValidation = replication < BagEbm{0};
-                  } while(isLoopValidation != isItemValidation);
-                  --pTargetFrom;
+            const size_t cSubsetSamples = pSubset->m_cSamples;
+            EBM_ASSERT(1 <= cSubsetSamples);
+
+            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+            EBM_ASSERT(1 <= cSIMDPack);
+            EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+
+            if(size_t{0} == iTarget) {
+               if(IsMultiplyError(pSubset->m_pObjective->m_cUIntBytes, cTargets, cSubsetSamples)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING DataSetBoosting::InitTargetData IsMultiplyError(pSubset->m_pObjective->m_cUIntBytes, "
+                        "cTargets, cSubsetSamples)");
+                  return Error_OutOfMemory;
                }
-               iData = *pTargetFrom;
-               ++pTargetFrom;
+               const size_t cBytes = pSubset->m_pObjective->m_cUIntBytes * cTargets * cSubsetSamples;
+               void* const aTargetTo = pSubset->AlignedAllocPlaced(cBytes);
+               if(nullptr == aTargetTo) {
+                  LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == aTargetTo");
+                  return Error_OutOfMemory;
+               }
+               pSubset->m_aTargetData = aTargetTo;
+            }
+            size_t iTo = iTarget * cSIMDPack;
+            const size_t iToEnd = iTo + cTargets * cSubsetSamples;
+            do {
+               size_t iPartition = 0;
+               do {
+                  if(BagEbm{0} == replication) {
+                     replication = 1;
+                     if(nullptr != pSampleReplication) {
+                        bool isItemValidation;
+                        do {
+                           do {
+                              replication = *pSampleReplication;
+                              ++pSampleReplication;
+                              ++pTargetFrom;
+                           } while(BagEbm{0} == replication);
+                           isItemValidation = replication < BagEbm{0};
+                        } while(isLoopValidation != isItemValidation);
+                        --pTargetFrom;
+                     }
+                     iData = *pTargetFrom;
+                     ++pTargetFrom;
+
+                     // CheckDataSet skips this scan for datasets created with CreateBoosterFlags_CheckedDataSet
+                     if(static_cast<UIntShared>(cClasses) <= iData) {
+                        LOG_0(Trace_Error,
+                              "ERROR DataSetBoosting::InitTargetData static_cast<UIntShared>(cClasses) <= iData");
+                        return Error_IllegalParamVal;
+                     }
 
 #ifndef NDEBUG
-               // this was checked when creating the shared dataset
-               EBM_ASSERT(iData < static_cast<UIntShared>(cClasses));
-               EBM_ASSERT(!IsConvertError<size_t>(iData)); // since cClasses came from size_t
-               if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
-                  // we checked earlier that cClasses - 1 would fit into UIntBig
-                  EBM_ASSERT(!IsConvertError<UIntBig>(iData));
-               } else {
-                  EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
-                  // we checked earlier that cClasses - 1 would fit into UIntSmall
-                  EBM_ASSERT(!IsConvertError<UIntSmall>(iData));
-               }
+                     EBM_ASSERT(!IsConvertError<size_t>(iData)); // since cClasses came from size_t
+                     if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
+                        // we checked earlier that cClasses - 1 would fit into UIntBig
+                        EBM_ASSERT(!IsConvertError<UIntBig>(iData));
+                     } else {
+                        EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
+                        // we checked earlier that cClasses - 1 would fit into UIntSmall
+                        EBM_ASSERT(!IsConvertError<UIntSmall>(iData));
+                     }
 #endif // NDEBUG
+                  }
+                  if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
+                     reinterpret_cast<UIntBig*>(pSubset->m_aTargetData)[iTo + iPartition] = static_cast<UIntBig>(iData);
+                  } else {
+                     EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
+                     reinterpret_cast<UIntSmall*>(pSubset->m_aTargetData)[iTo + iPartition] =
+                           static_cast<UIntSmall>(iData);
+                  }
+
+                  replication -= direction;
+
+                  ++iPartition;
+               } while(cSIMDPack != iPartition);
+               iTo += cTargets * cSIMDPack;
+            } while(iToEnd != iTo);
+
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+      } else {
+         const FloatShared* pTargetFrom = static_cast<const FloatShared*>(aTargets);
+         FloatShared data;
+         do {
+            const size_t cSubsetSamples = pSubset->m_cSamples;
+            EBM_ASSERT(1 <= cSubsetSamples);
+
+            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+            EBM_ASSERT(1 <= cSIMDPack);
+            EBM_ASSERT(0 == cSubsetSamples % cSIMDPack);
+
+            if(size_t{0} == iTarget) {
+               if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cTargets, cSubsetSamples)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING DataSetBoosting::InitTargetData IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, "
+                        "cTargets, cSubsetSamples)");
+                  return Error_OutOfMemory;
+               }
+               size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cTargets * cSubsetSamples;
+               if(ptrdiff_t{Task_Ranking} == cClasses) {
+                  // the query sizes follow the gains, so both need the same width to keep the sizes aligned
+                  EBM_ASSERT(size_t{1} == cTargets);
+                  EBM_ASSERT(pSubset->m_pObjective->m_cUIntBytes == pSubset->m_pObjective->m_cFloatBytes);
+                  if(IsAddError(cBytes, cBytes)) {
+                     LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData IsAddError(cBytes, cBytes)");
+                     return Error_OutOfMemory;
+                  }
+                  cBytes += cBytes;
+               }
+               void* const aTargetTo = pSubset->AlignedAllocPlaced(cBytes);
+               if(nullptr == aTargetTo) {
+                  LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == aTargetTo");
+                  return Error_OutOfMemory;
+               }
+               pSubset->m_aTargetData = aTargetTo;
             }
-            if(sizeof(UIntBig) == pSubset->m_pObjective->m_cUIntBytes) {
-               *reinterpret_cast<UIntBig*>(pTargetTo) = static_cast<UIntBig>(iData);
-            } else {
-               EBM_ASSERT(sizeof(UIntSmall) == pSubset->m_pObjective->m_cUIntBytes);
-               *reinterpret_cast<UIntSmall*>(pTargetTo) = static_cast<UIntSmall>(iData);
-            }
-            pTargetTo = IndexByte(pTargetTo, pSubset->m_pObjective->m_cUIntBytes);
+            size_t iTo = iTarget * cSIMDPack;
+            const size_t iToEnd = iTo + cTargets * cSubsetSamples;
+            do {
+               size_t iPartition = 0;
+               do {
+                  if(BagEbm{0} == replication) {
+                     replication = 1;
+                     if(nullptr != pSampleReplication) {
+                        bool isItemValidation;
+                        do {
+                           do {
+                              replication = *pSampleReplication;
+                              ++pSampleReplication;
+                              ++pTargetFrom;
+                           } while(BagEbm{0} == replication);
+                           isItemValidation = replication < BagEbm{0};
+                        } while(isLoopValidation != isItemValidation);
+                        --pTargetFrom;
+                     }
+                     data = *pTargetFrom;
+                     ++pTargetFrom;
+                  }
+                  if(sizeof(FloatBig) == pSubset->m_pObjective->m_cFloatBytes) {
+                     reinterpret_cast<FloatBig*>(pSubset->m_aTargetData)[iTo + iPartition] = static_cast<FloatBig>(data);
+                  } else {
+                     EBM_ASSERT(sizeof(FloatSmall) == pSubset->m_pObjective->m_cFloatBytes);
+                     reinterpret_cast<FloatSmall*>(pSubset->m_aTargetData)[iTo + iPartition] =
+                           static_cast<FloatSmall>(data);
+                  }
 
-            replication -= direction;
-         } while(pTargetToEnd != pTargetTo);
+                  replication -= direction;
 
-         ++pSubset;
-      } while(pSubsetsEnd != pSubset);
-   } else {
-      const FloatShared* pTargetFrom = static_cast<const FloatShared*>(aTargets);
-      FloatShared data;
-      do {
-         const size_t cSubsetSamples = pSubset->m_cSamples;
-         EBM_ASSERT(1 <= cSubsetSamples);
+                  ++iPartition;
+               } while(cSIMDPack != iPartition);
+               iTo += cTargets * cSIMDPack;
+            } while(iToEnd != iTo);
 
-         if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cSubsetSamples)) {
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+      }
+      EBM_ASSERT(0 == replication);
+
+      if(ptrdiff_t{Task_Ranking} == cClasses) {
+         EBM_ASSERT(nullptr != aQuerySamples);
+         EBM_ASSERT(1 <= m_cQuerySamplesMax);
+         if(IsMultiplyError(sizeof(double), m_cQuerySamplesMax)) {
             LOG_0(Trace_Warning,
-                  "WARNING DataSetBoosting::InitTargetData IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, "
-                  "cSubsetSamples)");
+                  "WARNING DataSetBoosting::InitTargetData IsMultiplyError(sizeof(double), m_cQuerySamplesMax)");
             return Error_OutOfMemory;
          }
-         const size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-         void* pTargetTo = AlignedAlloc(cBytes);
-         if(nullptr == pTargetTo) {
-            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == pTargetTo");
+         double* const aGainsSorted = static_cast<double*>(malloc(sizeof(double) * m_cQuerySamplesMax));
+         if(nullptr == aGainsSorted) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTargetData nullptr == aGainsSorted");
             return Error_OutOfMemory;
          }
-         pSubset->m_aTargetData = pTargetTo;
-         const void* const pTargetToEnd = IndexByte(pTargetTo, cBytes);
+         const size_t* pQuerySamples = aQuerySamples;
+         pSubset = m_aSubsets;
          do {
-            if(BagEbm{0} == replication) {
-               replication = 1;
-               if(nullptr != pSampleReplication) {
-                  bool isItemValidation;
-                  do {
-                     do {
-                        replication = *pSampleReplication;
-                        ++pSampleReplication;
-                        ++pTargetFrom;
-                     } while(BagEbm{0} == replication);
-                     isItemValidation = replication < BagEbm{0};
-                  } while(isLoopValidation != isItemValidation);
-                  --pTargetFrom;
-               }
-               data = *pTargetFrom;
-               ++pTargetFrom;
-            }
             if(sizeof(FloatBig) == pSubset->m_pObjective->m_cFloatBytes) {
-               *reinterpret_cast<FloatBig*>(pTargetTo) = static_cast<FloatBig>(data);
+               InitQueryTargets<FloatBig, UIntBig>(
+                     pSubset->m_cSamples, pSubset->m_aTargetData, &pQuerySamples, aGainsSorted);
             } else {
                EBM_ASSERT(sizeof(FloatSmall) == pSubset->m_pObjective->m_cFloatBytes);
-               *reinterpret_cast<FloatSmall*>(pTargetTo) = static_cast<FloatSmall>(data);
+               InitQueryTargets<FloatSmall, UIntSmall>(
+                     pSubset->m_cSamples, pSubset->m_aTargetData, &pQuerySamples, aGainsSorted);
             }
-            pTargetTo = IndexByte(pTargetTo, pSubset->m_pObjective->m_cFloatBytes);
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+         free(aGainsSorted);
+      }
 
-            replication -= direction;
-         } while(pTargetToEnd != pTargetTo);
+      ++iTarget;
+   } while(cTargets != iTarget);
 
-         ++pSubset;
-      } while(pSubsetsEnd != pSubset);
-   }
-   EBM_ASSERT(0 == replication);
    LOG_0(Trace_Info, "Exited DataSetBoosting::InitTargetData");
    return Error_None;
 }
@@ -526,7 +702,7 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
                return Error_OutOfMemory;
             }
             const size_t cBytes = pSubset->GetObjectiveWrapper()->m_cUIntBytes * cDataUnitsTo;
-            void* pTermDataTo = AlignedAlloc(cBytes);
+            void* pTermDataTo = pSubset->AlignedAllocPlaced(cBytes);
             if(nullptr == pTermDataTo) {
                LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitTermData nullptr == pTermDataTo");
                return Error_OutOfMemory;
@@ -590,8 +766,12 @@ ErrorEbm DataSetBoosting::InitTermData(const unsigned char* const pDataSetShared
                                  static_cast<size_t>(bitsFrom >> (iShiftFrom * pDimensionInfo->m_cBitsPerItemMaxFrom)) &
                                  pDimensionInfo->m_maskBitsFrom;
 
-                           // we check our dataSet when we get the header, and cBins has been checked to fit into size_t
-                           EBM_ASSERT(iFeatureBin < pDimensionInfo->m_cBins);
+                           // CheckDataSet skips this scan for datasets created with CreateBoosterFlags_CheckedDataSet
+                           if(pDimensionInfo->m_cBins <= iFeatureBin) {
+                              LOG_0(Trace_Error,
+                                    "ERROR DataSetBoosting::InitTermData pDimensionInfo->m_cBins <= iFeatureBin");
+                              return Error_IllegalParamVal;
+                           }
 
                            --iShiftFrom;
                            pDimensionInfo->m_iShiftFrom = iShiftFrom;
@@ -730,8 +910,11 @@ WARNING_POP
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 WARNING_DISABLE_UNINITIALIZED_LOCAL_POINTER
-ErrorEbm DataSetBoosting::InitBags(
-      void* const rng, const size_t cInnerBags, const size_t cTerms, const Term* const* const apTerms) {
+ErrorEbm DataSetBoosting::InitBags(void* const rng,
+      const size_t cInnerBags,
+      const bool bPoissonBags,
+      const size_t cTerms,
+      const Term* const* const apTerms) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitBags");
 
    EBM_ASSERT(1 <= cTerms);
@@ -792,9 +975,86 @@ ErrorEbm DataSetBoosting::InitBags(
    EBM_ASSERT(1 <= m_cSubsets);
    const DataSubsetBoosting* const pSubsetsEnd = m_aSubsets + m_cSubsets;
 
+   RandomCounter bagRng;
+   if(bPoissonBags) {
+      EBM_ASSERT(size_t{0} != cInnerBags);
+      EBM_ASSERT(nullptr != aOccurrencesFrom);
+
+      // Poisson bags keep only the key, plus the caller's weights if there are any, instead of cInnerBags weight
+      // arrays.  The BoosterShell provides the buffer that each bag's weights are regenerated into
+      bagRng.Initialize(cpuRng);
+
+      DataSubsetBoosting* pSubset = m_aSubsets;
+      const FloatShared* pWeightFrom = m_aOriginalWeights;
+      do {
+         const size_t cSubsetSamples = pSubset->GetCountSamples();
+         const size_t cFloatBytes = pSubset->m_pObjective->m_cFloatBytes;
+         if(IsMultiplyError(cFloatBytes, cSubsetSamples)) {
+            LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags IsMultiplyError(cFloatBytes, cSubsetSamples)");
+            free(aOccurrencesFrom);
+            return Error_OutOfMemory;
+         }
+         const size_t cBytes = cFloatBytes * cSubsetSamples;
+
+         pSubset->m_bagRng.Initialize(bagRng);
+         pSubset->m_bPoissonBags = true;
+
+         if(nullptr != pWeightFrom) {
+            void* pSampleWeight = pSubset->AlignedAllocPlaced(cBytes);
+            if(nullptr == pSampleWeight) {
+               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags nullptr == pSampleWeight");
+               free(aOccurrencesFrom);
+               return Error_OutOfMemory;
+            }
+            pSubset->m_aSampleWeights = pSampleWeight;
+            const void* const pSampleWeightEnd = IndexByte(pSampleWeight, cBytes);
+            do {
+               if(sizeof(FloatBig) == cFloatBytes) {
+                  *reinterpret_cast<FloatBig*>(pSampleWeight) = static_cast<FloatBig>(*pWeightFrom);
+               } else {
+                  EBM_ASSERT(sizeof(FloatSmall) == cFloatBytes);
+                  *reinterpret_cast<FloatSmall*>(pSampleWeight) = static_cast<FloatSmall>(*pWeightFrom);
+               }
+               ++pWeightFrom;
+               pSampleWeight = IndexByte(pSampleWeight, cFloatBytes);
+            } while(pSampleWeightEnd != pSampleWeight);
+         }
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+
    size_t iBag = 0;
    do {
-      if(nullptr != aOccurrencesFrom) {
+      size_t cTotalOccurrences = cIncludedSamples;
+      if(bPoissonBags) {
+         EBM_ASSERT(nullptr != aOccurrencesFrom);
+         uint64_t iStream = static_cast<uint64_t>(iBag);
+         while(true) {
+            RandomCounter rngBag;
+            rngBag.Initialize(bagRng);
+            rngBag.Seek(iStream, 0);
+            cTotalOccurrences = 0;
+            uint8_t* pOccurrences = aOccurrencesFrom;
+            const uint8_t* const pOccurrencesEnd = aOccurrencesFrom + cIncludedSamples;
+            do {
+               const uint8_t cOccurrences = InnerBag::NextPoissonOccurrences(rngBag);
+               *pOccurrences = cOccurrences;
+               cTotalOccurrences += static_cast<size_t>(cOccurrences);
+               ++pOccurrences;
+            } while(pOccurrencesEnd != pOccurrences);
+            if(size_t{0} != cTotalOccurrences) {
+               break;
+            }
+            // every sample drew zero, which is only likely with a handful of samples.  Streams iBag + k * cInnerBags
+            // are not used by any other bag, so move to the next of those
+            iStream += static_cast<uint64_t>(cInnerBags);
+         }
+         DataSubsetBoosting* pSubset = m_aSubsets;
+         do {
+            pSubset->m_aInnerBags[iBag].m_iPoissonStream = iStream;
+            ++pSubset;
+         } while(pSubsetsEnd != pSubset);
+      } else if(nullptr != aOccurrencesFrom) {
          EBM_ASSERT(size_t{0} != cInnerBags);
          memset(aOccurrencesFrom, 0, sizeof(*aOccurrencesFrom) * cIncludedSamples);
 
@@ -825,23 +1085,26 @@ ErrorEbm DataSetBoosting::InitBags(
          double subsetWeight = 0.0;
 
          if(nullptr != pOccurrencesFrom || nullptr != pWeightFrom) {
-            if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cSubsetSamples)) {
-               LOG_0(Trace_Warning,
-                     "WARNING DataSetBoosting::InitBags IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, "
-                     "cSubsetSamples)");
-               free(aOccurrencesFrom);
-               return Error_OutOfMemory;
-            }
-            size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
-            void* pWeightTo = AlignedAlloc(cBytes);
-            if(nullptr == pWeightTo) {
-               LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags nullptr == pWeightTo");
-               free(aOccurrencesFrom);
-               return Error_OutOfMemory;
+            void* pWeightTo = nullptr;
+            if(!bPoissonBags) {
+               if(IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, cSubsetSamples)) {
+                  LOG_0(Trace_Warning,
+                        "WARNING DataSetBoosting::InitBags IsMultiplyError(pSubset->m_pObjective->m_cFloatBytes, "
+                        "cSubsetSamples)");
+                  free(aOccurrencesFrom);
+                  return Error_OutOfMemory;
+               }
+               size_t cBytes = pSubset->m_pObjective->m_cFloatBytes * cSubsetSamples;
+               pWeightTo = pSubset->AlignedAllocPlaced(cBytes);
+               if(nullptr == pWeightTo) {
+                  LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitBags nullptr == pWeightTo");
+                  free(aOccurrencesFrom);
+                  return Error_OutOfMemory;
+               }
+               pInnerBag->m_aWeights = pWeightTo;
             }
-            pInnerBag->m_aWeights = pWeightTo;
 
-            const void* const pWeightToEnd = IndexByte(pWeightTo, cBytes);
+            size_t cSamplesRemaining = cSubsetSamples;
             do {
                double weight = double{1};
                if(nullptr != pWeightFrom) {
@@ -864,14 +1127,17 @@ ErrorEbm DataSetBoosting::InitBags(
 
                subsetWeight += weight;
 
-               if(sizeof(FloatBig) == pSubset->m_pObjective->m_cFloatBytes) {
-                  *reinterpret_cast<FloatBig*>(pWeightTo) = static_cast<FloatBig>(weight);
-               } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->m_pObjective->m_cFloatBytes);
-                  *reinterpret_cast<FloatSmall*>(pWeightTo) = static_cast<FloatSmall>(weight);
+               if(nullptr != pWeightTo) {
+                  if(sizeof(FloatBig) == pSubset->m_pObjective->m_cFloatBytes) {
+                     *reinterpret_cast<FloatBig*>(pWeightTo) = static_cast<FloatBig>(weight);
+                  } else {
+                     EBM_ASSERT(sizeof(FloatSmall) == pSubset->m_pObjective->m_cFloatBytes);
+                     *reinterpret_cast<FloatSmall*>(pWeightTo) = static_cast<FloatSmall>(weight);
+                  }
+                  pWeightTo = IndexByte(pWeightTo, pSubset->m_pObjective->m_cFloatBytes);
                }
-               pWeightTo = IndexByte(pWeightTo, pSubset->m_pObjective->m_cFloatBytes);
-            } while(pWeightToEnd != pWeightTo);
+               --cSamplesRemaining;
+            } while(size_t{0} != cSamplesRemaining);
          }
 
          totalWeight += subsetWeight;
@@ -881,7 +1147,7 @@ ErrorEbm DataSetBoosting::InitBags(
 
       if(nullptr == pWeightFrom) {
          // use this more accurate non-floating point version if we can
-         totalWeight = static_cast<double>(cIncludedSamples);
+         totalWeight = static_cast<double>(cTotalOccurrences);
       }
 
       EBM_ASSERT(!std::isnan(totalWeight));
@@ -901,7 +1167,7 @@ ErrorEbm DataSetBoosting::InitBags(
          do {
             const Term* const pTerm = apTerms[iTerm];
 
-            *TermInnerBag::GetCounts(true, iTerm, iBag, m_aaTermInnerBags) = cIncludedSamples;
+            *TermInnerBag::GetCounts(true, iTerm, iBag, m_aaTermInnerBags) = cTotalOccurrences;
             *TermInnerBag::GetWeights(true, iTerm, iBag, m_aaTermInnerBags) = totalWeight;
 
             if(1 != pTerm->GetCountTensorBins()) {
@@ -1027,6 +1293,70 @@ ErrorEbm DataSetBoosting::InitBags(
 }
 WARNING_POP
 
+static size_t* AllocateQuerySamples(const unsigned char* const pDataSetShared,
+      const BagEbm direction,
+      const size_t cSharedSamples,
+      const BagEbm* const aBag,
+      const size_t cIncludedSamples,
+      size_t* const pcQueries) {
+   // Ranking objectives need all the documents of a query in the same subset.  The query ids are sorted in the shared
+   // dataset and the bag keeps the sample order, so the included documents of each query form one contiguous run.
+   // We return the length of each run, which cannot have more entries than there are included samples.
+   const UIntShared* const aQueryGroups = GetDataSetSharedQueryGroups(pDataSetShared, 0);
+   EBM_ASSERT(nullptr != aQueryGroups);
+
+   if(IsMultiplyError(sizeof(size_t), cIncludedSamples)) {
+      LOG_0(Trace_Warning, "WARNING AllocateQuerySamples IsMultiplyError(sizeof(size_t), cIncludedSamples)");
+      return nullptr;
+   }
+   size_t* const aQuerySamples = static_cast<size_t*>(malloc(sizeof(size_t) * cIncludedSamples));
+   if(nullptr == aQuerySamples) {
+      LOG_0(Trace_Warning, "WARNING AllocateQuerySamples nullptr == aQuerySamples");
+      return nullptr;
+   }
+
+   const bool isLoopValidation = direction < BagEbm{0};
+   EBM_ASSERT(nullptr != aBag || !isLoopValidation); // if aBag is nullptr then we have no validation samples
+
+   size_t cQueries = 0;
+   UIntShared queryPrev = 0;
+   size_t iSample = 0;
+   do {
+      const BagEbm replication = nullptr == aBag ? BagEbm{1} : aBag[iSample];
+      if(BagEbm{0} != replication && isLoopValidation == (replication < BagEbm{0})) {
+         const UIntShared query = aQueryGroups[iSample];
+         if(size_t{0} == cQueries || queryPrev != query) {
+            EBM_ASSERT(cQueries < cIncludedSamples);
+            aQuerySamples[cQueries] = 0;
+            ++cQueries;
+            queryPrev = query;
+         }
+         aQuerySamples[cQueries - 1] += static_cast<size_t>(replication * direction);
+      }
+      ++iSample;
+   } while(cSharedSamples != iSample);
+   EBM_ASSERT(1 <= cQueries);
+
+   *pcQueries = cQueries;
+   return aQuerySamples;
+}
+
+static size_t TakeQuerySamples(
+      const size_t* const aQuerySamples, const size_t cQueries, size_t* const piQuery, const size_t cSubsetItemsMax) {
+   // fill the subset with whole queries.  A query larger than cSubsetItemsMax gets a subset of its own
+   size_t iQuery = *piQuery;
+   EBM_ASSERT(iQuery < cQueries);
+   size_t cSubsetSamples = aQuerySamples[iQuery];
+   ++iQuery;
+   while(cQueries != iQuery && cSubsetSamples <= cSubsetItemsMax &&
+         aQuerySamples[iQuery] <= cSubsetItemsMax - cSubsetSamples) {
+      cSubsetSamples += aQuerySamples[iQuery];
+      ++iQuery;
+   }
+   *piQuery = iQuery;
+   return cSubsetSamples;
+}
+
 ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
       const bool bAllocateHessians,
       const bool bAllocateSampleScores,
@@ -1044,10 +1374,14 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
       const double* const aInitScores,
       const size_t cIncludedSamples,
       const size_t cInnerBags,
+      const bool bPoissonBags,
       const size_t cWeights,
       const size_t cTerms,
       const Term* const* const apTerms,
-      const IntEbm* const aiTermFeatures) {
+      const IntEbm* const aiTermFeatures,
+      const size_t cNumaNodes,
+      const int* const aNumaNodes,
+      const size_t iSubsetSlotFirst) {
    LOG_0(Trace_Info, "Entered DataSetBoosting::InitDataSetBoosting");
 
    ErrorEbm error;
@@ -1077,10 +1411,36 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
             nullptr != pObjectiveSIMD->m_pObjective && 2 <= pObjectiveSIMD->m_cSIMDPack);
       const size_t cSIMDPack = pObjectiveSIMD->m_cSIMDPack;
 
+      size_t* aQuerySamples = nullptr;
+      size_t cQueries = 0;
+      ptrdiff_t cClasses;
+      const void* const aTargets = GetDataSetSharedTarget(pDataSetShared, 0, &cClasses);
+      EBM_ASSERT(nullptr != aTargets); // we previously called GetDataSetSharedTarget and got back non-null result
+      UNUSED(aTargets);
+      if(ptrdiff_t{Task_Ranking} == cClasses) {
+         // ranking objectives only run in the CPU zone, which lets us cut the subsets on query boundaries
+         EBM_ASSERT(size_t{0} == cSIMDPack);
+         aQuerySamples =
+               AllocateQuerySamples(pDataSetShared, direction, cSharedSamples, aBag, cIncludedSamples, &cQueries);
+         if(nullptr == aQuerySamples) {
+            // already logged
+            return Error_OutOfMemory;
+         }
+         size_t iQuery = 0;
+         do {
+            m_cQuerySamplesMax = EbmMax(m_cQuerySamplesMax, aQuerySamples[iQuery]);
+            ++iQuery;
+         } while(cQueries != iQuery);
+      }
+
       size_t cSubsets = 0;
+      size_t iQueryInit = 0;
       size_t cIncludedSamplesRemainingInit = cIncludedSamples;
       do {
          size_t cSubsetSamples = EbmMin(cIncludedSamplesRemainingInit, cSubsetItemsMax);
+         if(nullptr != aQuerySamples) {
+            cSubsetSamples = TakeQuerySamples(aQuerySamples, cQueries, &iQueryInit, cSubsetItemsMax);
+         }
 
          if(size_t{0} == cSIMDPack || cSubsetSamples < cSIMDPack) {
             // these remaing items cannot be processed with the SIMD compute, so they go into the CPU compute
@@ -1098,11 +1458,13 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
       if(IsMultiplyError(sizeof(DataSubsetBoosting), cSubsets)) {
          LOG_0(Trace_Warning,
                "WARNING DataSetBoosting::InitDataSetBoosting IsMultiplyError(sizeof(DataSubsetBoosting), cSubsets)");
+         free(aQuerySamples);
          return Error_OutOfMemory;
       }
       DataSubsetBoosting* pSubset = static_cast<DataSubsetBoosting*>(malloc(sizeof(DataSubsetBoosting) * cSubsets));
       if(nullptr == pSubset) {
          LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == pSubset");
+         free(aQuerySamples);
          return Error_OutOfMemory;
       }
       m_aSubsets = pSubset;
@@ -1116,11 +1478,15 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          ++pSubsetInit;
       } while(pSubsetsEnd != pSubsetInit);
 
+      size_t iQuery = 0;
       size_t cIncludedSamplesRemaining = cIncludedSamples;
       do {
          EBM_ASSERT(1 <= cIncludedSamplesRemaining);
 
          size_t cSubsetSamples = EbmMin(cIncludedSamplesRemaining, cSubsetItemsMax);
+         if(nullptr != aQuerySamples) {
+            cSubsetSamples = TakeQuerySamples(aQuerySamples, cQueries, &iQuery, cSubsetItemsMax);
+         }
 
          if(size_t{0} == cSIMDPack || cSubsetSamples < cSIMDPack) {
             // these remaing items cannot be processed with the SIMD compute, so they go into the CPU compute
@@ -1134,19 +1500,30 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          EBM_ASSERT(1 <= cSubsetSamples);
          EBM_ASSERT(0 == cSubsetSamples % pSubset->m_pObjective->m_cSIMDPack);
          EBM_ASSERT(cSubsetSamples <= cIncludedSamplesRemaining);
+         pSubset->m_iSampleFirst = cIncludedSamples - cIncludedSamplesRemaining;
          cIncludedSamplesRemaining -= cSubsetSamples;
 
          pSubset->m_cSamples = cSubsetSamples;
 
+         if(size_t{0} != cNumaNodes) {
+            // ParallelFor runs subset slot iSlot on node aNumaNodes[iSlot % cNumaNodes] when it can, so put the
+            // subset's memory there.  Every later allocation for this subset goes through AlignedAllocPlaced
+            EBM_ASSERT(nullptr != aNumaNodes);
+            const size_t iSubsetSlot = iSubsetSlotFirst + static_cast<size_t>(pSubset - m_aSubsets);
+            pSubset->m_iNumaNode = aNumaNodes[iSubsetSlot % cNumaNodes];
+         }
+
          EBM_ASSERT(1 <= cTerms);
          if(IsMultiplyError(sizeof(void*), cTerms)) {
             LOG_0(Trace_Warning,
                   "WARNING DataSetBoosting::InitDataSetBoosting IsMultiplyError(sizeof(void *), cTerms)");
+            free(aQuerySamples);
             return Error_OutOfMemory;
          }
          void** paTermData = static_cast<void**>(malloc(sizeof(void*) * cTerms));
          if(nullptr == paTermData) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == paTermData");
+            free(aQuerySamples);
             return Error_OutOfMemory;
          }
          pSubset->m_aaTermData = paTermData;
@@ -1160,6 +1537,7 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          InnerBag* const aInnerBags = InnerBag::AllocateInnerBags(cInnerBags);
          if(nullptr == aInnerBags) {
             LOG_0(Trace_Warning, "WARNING DataSetBoosting::InitDataSetBoosting nullptr == aInnerBags");
+            free(aQuerySamples);
             return Error_OutOfMemory;
          }
          pSubset->m_aInnerBags = aInnerBags;
@@ -1167,6 +1545,18 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          ++pSubset;
       } while(pSubsetsEnd != pSubset);
       EBM_ASSERT(0 == cIncludedSamplesRemaining);
+      EBM_ASSERT(nullptr == aQuerySamples || cQueries == iQuery);
+
+      if(bAllocateTargetData) {
+         error = InitTargetData(pDataSetShared, direction, aBag, aQuerySamples);
+      } else {
+         EBM_ASSERT(nullptr == aQuerySamples);
+         error = Error_None;
+      }
+      free(aQuerySamples);
+      if(Error_None != error) {
+         return error;
+      }
 
       if(bAllocateGradients) {
          error = InitGradHess(bAllocateHessians, cScores);
@@ -1184,13 +1574,6 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          }
       }
 
-      if(bAllocateTargetData) {
-         error = InitTargetData(pDataSetShared, direction, aBag);
-         if(Error_None != error) {
-            return error;
-         }
-      }
-
       error = InitTermData(pDataSetShared, direction, cSharedSamples, aBag, cTerms, apTerms, aiTermFeatures);
       if(Error_None != error) {
          return error;
@@ -1217,7 +1600,7 @@ ErrorEbm DataSetBoosting::InitDataSetBoosting(const bool bAllocateGradients,
          }
       }
 
-      error = InitBags(rng, cInnerBags, cTerms, apTerms);
+      error = InitBags(rng, cInnerBags, bPoissonBags, cTerms, apTerms);
       if(Error_None != error) {
          return error;
       }
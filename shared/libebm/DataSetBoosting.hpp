@@ -13,8 +13,10 @@
 
 #include "bridge.h" // UIntMain
 
+#include "RandomCounter.hpp" // RandomCounter
 #include "InnerBag.hpp" // InnerBag
 #include "TermInnerBag.hpp" // TermInnerBag
+#include "ThreadPool.hpp" // BindNumaNode
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -40,6 +42,14 @@ struct DataSubsetBoosting final {
       m_aTargetData = nullptr;
       m_aaTermData = nullptr;
       m_aInnerBags = nullptr;
+      m_aSampleWeights = nullptr;
+      m_iSampleFirst = 0;
+      m_bPoissonBags = false;
+      m_iNumaNode = -1;
+      m_cSampled = 0;
+      m_aiSampled = nullptr;
+      m_aSampledGradHess = nullptr;
+      m_aSampledFactors = nullptr;
    }
 
    void DestructDataSubsetBoosting(const size_t cTerms, const size_t cInnerBags);
@@ -83,6 +93,39 @@ struct DataSubsetBoosting final {
       return &m_aInnerBags[iBag];
    }
 
+   inline bool IsPoissonBags() const { return m_bPoissonBags; }
+
+   // returns the sample weights of bag iBag, or nullptr if every sample has weight 1.  Poisson bags are regenerated
+   // into aBagWeightsTemp, which the caller owns so that booster views on different threads do not share it
+   inline const void* GetBagWeights(const size_t iBag, void* const aBagWeightsTemp) const {
+      if(!m_bPoissonBags) {
+         return GetInnerBag(iBag)->GetWeights();
+      }
+      EBM_ASSERT(nullptr != aBagWeightsTemp);
+      FillPoissonBagWeights(iBag, aBagWeightsTemp);
+      return aBagWeightsTemp;
+   }
+
+   // gradient-based one-side sampling (GOSS) keeps a compacted copy of the gradients and hessians of the samples
+   // selected on the current boosting step.  The count is padded to a multiple of the SIMD pack with zero weight
+   // samples, and is zero when sampling is off and BinSums should see every sample
+   inline size_t GetCountSampled() const { return m_cSampled; }
+   inline const void* GetSampledGradHess() const { return m_aSampledGradHess; }
+
+   ErrorEbm AllocateGradientSample(const size_t cScores, const bool bHessian);
+   void FreeGradientSample();
+   void FillGradientMagnitudes(
+         const size_t cScores, const bool bHessian, const size_t cStride, double* const aMagnitudesOut) const;
+   void SelectGradientSample(const size_t cScores,
+         const bool bHessian,
+         const double thresholdTop,
+         const uint32_t cutoffOther,
+         const double factorOther,
+         RandomCounter rng,
+         const uint64_t iStream);
+   void GatherSampledTermData(const size_t iTerm, const int cItemsPerBitPack, void* const aPackedOut) const;
+   void GatherSampledWeights(const void* const aBagWeights, void* const aWeightsOut) const;
+
  private:
    size_t m_cSamples;
    const ObjectiveWrapper* m_pObjective;
@@ -91,6 +134,24 @@ struct DataSubsetBoosting final {
    void* m_aTargetData;
    void** m_aaTermData;
    InnerBag* m_aInnerBags;
+   void* m_aSampleWeights; // the caller's weights, kept only for Poisson bags.  nullptr if unweighted
+   size_t m_iSampleFirst; // index of our first sample within the DataSetBoosting, which positions the Poisson stream
+   RandomCounter m_bagRng;
+   bool m_bPoissonBags;
+   int m_iNumaNode; // -1 when the subset is not placed on a particular NUMA node
+
+   size_t m_cSampled;
+   size_t* m_aiSampled; // index of each sampled sample within this subset.  Padding repeats index 0
+   void* m_aSampledGradHess;
+   void* m_aSampledFactors; // 1 for the top gradients, (1 - a) / b for the random others, 0 for padding
+
+   void FillPoissonBagWeights(const size_t iBag, void* const aWeightsOut) const;
+
+   inline void* AlignedAllocPlaced(const size_t cBytes) const {
+      void* const p = AlignedAlloc(cBytes);
+      BindNumaNode(p, cBytes, m_iNumaNode);
+      return p;
+   }
 };
 static_assert(std::is_standard_layout<DataSubsetBoosting>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
@@ -110,6 +171,7 @@ struct DataSetBoosting final {
       m_aBagWeightTotals = nullptr;
       m_aOriginalWeights = nullptr;
       m_aaTermInnerBags = nullptr;
+      m_cQuerySamplesMax = 0;
    }
 
    ErrorEbm InitDataSetBoosting(const bool bAllocateGradients,
@@ -129,10 +191,14 @@ struct DataSetBoosting final {
          const double* const aInitScores,
          const size_t cIncludedSamples,
          const size_t cInnerBags,
+         const bool bPoissonBags,
          const size_t cWeights,
          const size_t cTerms,
          const Term* const* const apTerms,
-         const IntEbm* const aiTermFeatures);
+         const IntEbm* const aiTermFeatures,
+         const size_t cNumaNodes,
+         const int* const aNumaNodes,
+         const size_t iSubsetSlotFirst);
 
    void DestructDataSetBoosting(const size_t cTerms, const size_t cInnerBags);
 
@@ -150,6 +216,8 @@ struct DataSetBoosting final {
       EBM_ASSERT(nullptr != m_aaTermInnerBags);
       return m_aaTermInnerBags;
    }
+   // the count of documents in the largest query, or 0 if the target is not a ranking target
+   inline size_t GetCountQuerySamplesMax() const { return m_cQuerySamplesMax; }
 
  private:
    ErrorEbm InitGradHess(const bool bAllocateHessians, const size_t cScores);
@@ -157,7 +225,10 @@ struct DataSetBoosting final {
    ErrorEbm InitSampleScores(
          const size_t cScores, const BagEbm direction, const BagEbm* const aBag, const double* const aInitScores);
 
-   ErrorEbm InitTargetData(const unsigned char* const pDataSetShared, const BagEbm direction, const BagEbm* const aBag);
+   ErrorEbm InitTargetData(const unsigned char* const pDataSetShared,
+         const BagEbm direction,
+         const BagEbm* const aBag,
+         const size_t* const aQuerySamples);
 
    ErrorEbm InitTermData(const unsigned char* const pDataSetShared,
          const BagEbm direction,
@@ -169,7 +240,11 @@ struct DataSetBoosting final {
 
    ErrorEbm CopyWeights(const unsigned char* const pDataSetShared, const BagEbm direction, const BagEbm* const aBag);
 
-   ErrorEbm InitBags(void* const rng, const size_t cInnerBags, const size_t cTerms, const Term* const* const apTerms);
+   ErrorEbm InitBags(void* const rng,
+         const size_t cInnerBags,
+         const bool bPoissonBags,
+         const size_t cTerms,
+         const Term* const* const apTerms);
 
    size_t m_cSamples;
    size_t m_cSubsets;
@@ -177,6 +252,7 @@ struct DataSetBoosting final {
    double* m_aBagWeightTotals;
    FloatShared* m_aOriginalWeights;
    TermInnerBag** m_aaTermInnerBags;
+   size_t m_cQuerySamplesMax;
 };
 static_assert(std::is_standard_layout<DataSetBoosting>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
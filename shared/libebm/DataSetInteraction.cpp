@@ -232,8 +232,14 @@ ErrorEbm DataSetInteraction::InitFeatureData(const unsigned char* const pDataSet
                         EBM_ASSERT(iShiftFrom * cBitsPerItemMaxFrom < COUNT_BITS(UIntShared));
                         iFeatureBin = (bitsFrom >> (iShiftFrom * cBitsPerItemMaxFrom)) & maskBitsFrom;
 
+                        // CheckDataSet skips this scan for datasets created with CreateInteractionFlags_CheckedDataSet
+                        if(static_cast<UIntShared>(cBins) <= iFeatureBin) {
+                           LOG_0(Trace_Error,
+                                 "ERROR DataSetInteraction::InitFeatureData "
+                                 "static_cast<UIntShared>(cBins) <= iFeatureBin");
+                           return Error_IllegalParamVal;
+                        }
                         EBM_ASSERT(!IsConvertError<size_t>(iFeatureBin));
-                        EBM_ASSERT(static_cast<size_t>(iFeatureBin) < cBins);
 
                         --iShiftFrom;
                         if(iShiftFrom < 0) {
@@ -37,7 +37,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DetermineTask(const char* objective
 
    Config config;
    config.cOutputs = 1;
+   config.cTargets = 1;
    config.isDifferentialPrivacy = EBM_FALSE;
+   config.linkFunction = Link_ERROR;
    const ErrorEbm error = GetObjective(&config, objective, AccelerationFlags_NONE, &objectiveWrapper, nullptr);
    if(Error_None != error) {
       LOG_0(Trace_Error, "ERROR DetermineTask GetObjective failed");
@@ -106,7 +108,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DetermineLinkFunction(
 
    Config config;
    config.cOutputs = cScores;
+   config.cTargets = 1;
    config.isDifferentialPrivacy = LinkFlags_DifferentialPrivacy & flags ? EBM_TRUE : EBM_FALSE;
+   config.linkFunction = Link_ERROR;
    const ErrorEbm error = GetObjective(&config, objective, AccelerationFlags_NONE, &objectiveWrapper, nullptr);
    if(Error_None != error) {
       LOG_0(Trace_Error, "ERROR DetermineLinkFunction GetObjective failed");
@@ -22,6 +22,8 @@
 
 #include "common.hpp" // IsConvertError
 
+#include "ThreadPool.hpp"
+
 // TODO: check this file for how we handle subnormal numbers!  It's tricky if we get them
 
 namespace DEFINED_ZONE_NAME {
@@ -1075,4 +1077,107 @@ exit_with_log:;
    return error;
 }
 
+// large columns are split into blocks so that a few tall columns can still use all the threads
+static constexpr size_t k_cSamplesPerDiscretizeTask = 65536;
+
+struct DiscretizeManyContext final {
+   size_t m_cSamples;
+   size_t m_cBlocksPerFeature;
+   const double* const* m_aFeatureCols;
+   const IntEbm* m_aCutOffsets;
+   const double* m_aCuts;
+   IntEbm* m_aBinIndexes;
+};
+
+static ErrorEbm DiscretizeManyTask(void* const pContext, const size_t iTask) {
+   const DiscretizeManyContext* const p = static_cast<const DiscretizeManyContext*>(pContext);
+   const size_t iFeature = iTask / p->m_cBlocksPerFeature;
+   const size_t iSampleStart = (iTask % p->m_cBlocksPerFeature) * k_cSamplesPerDiscretizeTask;
+   const size_t cSamplesRemaining = p->m_cSamples - iSampleStart;
+   const size_t cSamples =
+         k_cSamplesPerDiscretizeTask < cSamplesRemaining ? k_cSamplesPerDiscretizeTask : cSamplesRemaining;
+   const IntEbm iCutFirst = p->m_aCutOffsets[iFeature];
+   return Discretize(static_cast<IntEbm>(cSamples),
+         p->m_aFeatureCols[iFeature] + iSampleStart,
+         p->m_aCutOffsets[iFeature + size_t{1}] - iCutFirst,
+         p->m_aCuts + static_cast<size_t>(iCutFirst),
+         p->m_aBinIndexes + iFeature * p->m_cSamples + iSampleStart);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION DiscretizeMany(IntEbm countFeatures,
+      IntEbm countSamples,
+      const double* const* featureCols,
+      const IntEbm* cutOffsets,
+      const double* cutsLowerBoundInclusive,
+      IntEbm* binIndexesOut) {
+   LOG_N(Trace_Info,
+         "Entered DiscretizeMany: "
+         "countFeatures=%" IntEbmPrintf ", "
+         "countSamples=%" IntEbmPrintf ", "
+         "featureCols=%p, "
+         "cutOffsets=%p, "
+         "cutsLowerBoundInclusive=%p, "
+         "binIndexesOut=%p",
+         countFeatures,
+         countSamples,
+         static_cast<const void*>(featureCols),
+         static_cast<const void*>(cutOffsets),
+         static_cast<const void*>(cutsLowerBoundInclusive),
+         static_cast<void*>(binIndexesOut));
+
+   if(IsConvertError<size_t>(countFeatures)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany countFeatures is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany countSamples is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   if(size_t{0} == cFeatures || size_t{0} == cSamples) {
+      return Error_None;
+   }
+   if(IsMultiplyError(sizeof(*binIndexesOut), cFeatures, cSamples)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany IsMultiplyError(sizeof(*binIndexesOut), cFeatures, cSamples)");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == featureCols || nullptr == cutOffsets || nullptr == binIndexesOut) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany featureCols, cutOffsets, and binIndexesOut cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   // check the offsets here so that the tasks can trust them
+   if(IntEbm{0} != cutOffsets[0]) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany cutOffsets must start at zero");
+      return Error_IllegalParamVal;
+   }
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      if(cutOffsets[iFeature + size_t{1}] < cutOffsets[iFeature]) {
+         LOG_0(Trace_Error, "ERROR DiscretizeMany cutOffsets must be non-decreasing");
+         return Error_IllegalParamVal;
+      }
+   }
+   if(IntEbm{0} != cutOffsets[cFeatures] && nullptr == cutsLowerBoundInclusive) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany nullptr == cutsLowerBoundInclusive");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cBlocksPerFeature = (cSamples - size_t{1}) / k_cSamplesPerDiscretizeTask + size_t{1};
+   if(IsMultiplyError(cFeatures, cBlocksPerFeature)) {
+      LOG_0(Trace_Error, "ERROR DiscretizeMany IsMultiplyError(cFeatures, cBlocksPerFeature)");
+      return Error_IllegalParamVal;
+   }
+
+   DiscretizeManyContext context;
+   context.m_cSamples = cSamples;
+   context.m_cBlocksPerFeature = cBlocksPerFeature;
+   context.m_aFeatureCols = featureCols;
+   context.m_aCutOffsets = cutOffsets;
+   context.m_aCuts = cutsLowerBoundInclusive;
+   context.m_aBinIndexes = binIndexesOut;
+
+   return ParallelFor(cFeatures * cBlocksPerFeature, DiscretizeManyTask, &context);
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -29,12 +29,20 @@
 #include "Tensor.hpp"
 #include "BoosterCore.hpp"
 #include "BoosterShell.hpp"
+#include "Timeline.hpp"
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+extern bool PurifyPairInternal(const size_t cScores,
+      const size_t cBins0,
+      const size_t cBins1,
+      const double* const aWeights,
+      double* const pScores);
+
 extern ErrorEbm PurifyInternal(const double tolerance,
       const size_t cScores,
       const size_t cTensorBins,
@@ -45,7 +53,10 @@ extern ErrorEbm PurifyInternal(const double tolerance,
       const double* const aWeights,
       double* const pScores,
       double* const pImpurities,
-      double* const pIntercept);
+      double* const pIntercept,
+      const size_t cIterationsMax,
+      size_t* const pcIterationsOut,
+      bool* const pbConvergedOut);
 
 extern void ConvertAddBin(const size_t cScores,
       const bool bHessian,
@@ -186,6 +197,7 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
       BoosterShell* const pBoosterShell,
       const TermBoostFlags flags,
       const size_t cBins,
+      const size_t cSamplesTotal,
       const FloatMain weightTotal,
       const size_t iDimension,
       const size_t cSamplesLeafMin,
@@ -208,9 +220,7 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
       cSplitsMax = std::numeric_limits<size_t>::max();
    }
 
-   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
-
-   EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSamples());
+   EBM_ASSERT(1 <= cSamplesTotal);
 
    error = PartitionOneDimensionalBoosting(pRng,
          pBoosterShell,
@@ -224,7 +234,7 @@ static ErrorEbm BoostSingleDimensional(RandomDeterministic* const pRng,
          deltaStepMax,
          cSplitsMax,
          direction,
-         pBoosterCore->GetTrainingSet()->GetCountSamples(),
+         cSamplesTotal,
          weightTotal,
          pTotalGain);
 
@@ -305,6 +315,7 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
 
    BinBase* aAuxiliaryBins = IndexBin(aMainBins, cBytesPerMainBin * cTensorBins);
 
+   const uint64_t tickTensorTotals = BoosterShell::GetStatTicks();
    TensorTotalsBuild(pBoosterCore->IsHessian(),
          cScores,
          pTerm->GetCountRealDimensions(),
@@ -317,6 +328,13 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
          pBoosterShell->GetDebugMainBinsEnd()
 #endif // NDEBUG
    );
+   pBoosterShell->RecordStat(BoosterStat_TensorTotals,
+         iTerm,
+         nullptr,
+         tickTensorTotals,
+         cBytesPerMainBin * (cTensorBins + cAuxillaryBins));
+
+   const uint64_t tickPartition = BoosterShell::GetStatTicks();
 
    // permutation0
    // gain_permute0
@@ -412,11 +430,21 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
    //   move_next_permutation:
    //} while(std::next_permutation(aiDimensionPermutation, &aiDimensionPermutation[cDimensions]));
 
+   // PartitionTwoDimensionalBoosting cuts one dimension into at most 3 slices and the other into 2, so we only
+   // need weights for a 6 bin tensor instead of the full term tensor
+   static constexpr size_t k_cPairUpdateBinsMax = 6;
+
    double* aWeights = nullptr;
    if(0 != (TermBoostFlags_PurifyUpdate & flags)) {
-      // allocate the biggest tensor that is possible to split into
-      // TODO: cache this memory allocation so that we don't do it each time
-      aWeights = static_cast<double*>(malloc(sizeof(double) * cScores * cTensorBins));
+      aWeights = static_cast<double*>(
+            pBoosterShell->GetScratch()->Allocate(sizeof(double) * cScores * k_cPairUpdateBinsMax));
+      if(nullptr == aWeights) {
+#ifndef NDEBUG
+         free(aDebugCopyBins);
+#endif // NDEBUG
+         LOG_0(Trace_Warning, "WARNING BoostMultiDimensional nullptr == aWeights");
+         return Error_OutOfMemory;
+      }
    }
 
    if(2 == pTerm->GetCountRealDimensions()) {
@@ -438,7 +466,6 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
 #endif // NDEBUG
       );
       if(Error_None != error) {
-         free(aWeights);
 #ifndef NDEBUG
          free(aDebugCopyBins);
 #endif // NDEBUG
@@ -451,8 +478,6 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
       EBM_ASSERT(!std::isnan(*pTotalGain));
       EBM_ASSERT(0 <= *pTotalGain);
    } else {
-      free(aWeights);
-
       LOG_0(Trace_Warning, "WARNING BoostMultiDimensional 2 != pTerm->GetCountSignificantFeatures()");
 
       // TODO: eventually handle this in our caller and this function can specialize in handling just 2 dimensional
@@ -467,66 +492,67 @@ static ErrorEbm BoostMultiDimensional(BoosterShell* const pBoosterShell,
    if(0 != (TermBoostFlags_PurifyUpdate & flags)) {
       Tensor* const pTensor = pBoosterShell->GetInnerTermUpdate();
 
-      size_t cDimensions = pTerm->GetCountDimensions();
+      // dimensions that were not cut have 1 slice and do not change the memory layout, so ignore them
+      const size_t cDimensions = pTerm->GetCountDimensions();
+      size_t acPurifyBins[k_cDimensionsMax];
+      size_t cPurifyDimensions = 0;
       size_t cTensorBinsPurify = 1;
       size_t iDimension = 0;
       do {
          const size_t cBins = pTensor->GetCountSlices(iDimension);
          cTensorBinsPurify *= cBins;
-         ++iDimension;
-      } while(cDimensions != iDimension);
-
-      size_t acPurifyBins[k_cDimensionsMax];
-      size_t* pcPurifyBins = acPurifyBins;
-      const size_t* const pcPurifyBinsEnd = &acPurifyBins[pTerm->GetCountRealDimensions()];
-      size_t cSurfaceBinsTotal = 0;
-      iDimension = 0;
-      do {
-         const size_t cBins = pTensor->GetCountSlices(iDimension);
          if(size_t{1} < cBins) {
-            *pcPurifyBins = cBins;
-            EBM_ASSERT(0 == cTensorBinsPurify % cBins);
-            const size_t cExcludeSurfaceBins = cTensorBinsPurify / cBins;
-            cSurfaceBinsTotal += cExcludeSurfaceBins;
-            ++pcPurifyBins;
+            acPurifyBins[cPurifyDimensions] = cBins;
+            ++cPurifyDimensions;
          }
          ++iDimension;
-      } while(pcPurifyBinsEnd != pcPurifyBins);
-
-      constexpr double tolerance = 0.0; // TODO: for now purify to the max, but test tolerances and profile them
+      } while(cDimensions != iDimension);
 
-      // TODO: in the future try randomizing the purification order.  It probably doesn't make much difference
-      //       though if we're purifying to the 0.0 tolerance, and it might make things slower, although we
-      //       could see a speed increase if it allows us to use bigger tolerance values.
+      // If no cuts were made the update is a single bin that has nothing to purify. Otherwise the partition cuts
+      // both dimensions, and one of them in two, which PurifyPairInternal purifies exactly in one pass.
+      if(size_t{0} != cPurifyDimensions) {
+         EBM_ASSERT(size_t{2} == cPurifyDimensions);
+         EBM_ASSERT(size_t{2} == acPurifyBins[0] || size_t{2} == acPurifyBins[1]);
+         EBM_ASSERT(cTensorBinsPurify <= k_cPairUpdateBinsMax);
 
-      double* pScores = pTensor->GetTensorScoresPointer();
-      const double* const pScoreMulticlassEnd = &pScores[cScores];
-      double* pWeights = aWeights;
-      do {
-         // ignore the return from PurifyInternal since we should check for NaN in the weights
-         // earlier and the checks in PurifyInternal are only for the stand-alone purification API
-         PurifyInternal(tolerance,
-               cScores,
-               cTensorBinsPurify,
-               cSurfaceBinsTotal,
-               nullptr,
-               nullptr,
-               acPurifyBins,
-               pWeights,
-               pScores,
-               nullptr,
-               nullptr);
-         pWeights += cTensorBinsPurify;
-         ++pScores;
-      } while(pScoreMulticlassEnd != pScores);
-
-      free(aWeights);
+         double* pScores = pTensor->GetTensorScoresPointer();
+         const double* const pScoreMulticlassEnd = &pScores[cScores];
+         const double* pWeights = aWeights;
+         do {
+            if(!PurifyPairInternal(cScores, acPurifyBins[0], acPurifyBins[1], pWeights, pScores)) {
+               // zero weights or extreme values, so fall back to the iterative algorithm which handles those
+
+               constexpr double tolerance = 0.0; // TODO: for now purify to the max, but test tolerances and profile them
+
+               // ignore the return from PurifyInternal since we should check for NaN in the weights
+               // earlier and the checks in PurifyInternal are only for the stand-alone purification API
+               PurifyInternal(tolerance,
+                     cScores,
+                     cTensorBinsPurify,
+                     acPurifyBins[0] + acPurifyBins[1],
+                     nullptr,
+                     nullptr,
+                     acPurifyBins,
+                     pWeights,
+                     pScores,
+                     nullptr,
+                     nullptr,
+                     std::numeric_limits<size_t>::max(),
+                     nullptr,
+                     nullptr);
+            }
+            pWeights += cTensorBinsPurify;
+            ++pScores;
+         } while(pScoreMulticlassEnd != pScores);
+      }
    }
 
 #ifndef NDEBUG
    free(aDebugCopyBins);
 #endif // NDEBUG
 
+   pBoosterShell->RecordStat(BoosterStat_Partition, iTerm, nullptr, tickPartition, cBytesPerMainBin * cTensorBins);
+
    LOG_0(Trace_Verbose, "Exited BoostMultiDimensional");
    return Error_None;
 }
@@ -577,6 +603,158 @@ static ErrorEbm BoostRandom(RandomDeterministic* const pRng,
 // dereference that before getting the count.  By making this global we can send a log message incase a bad BoosterCore
 // object is sent into us we only decrease the count if the count is non-zero, so at worst if there is a race condition
 // then we'll output this log message more times than desired, but we can live with that
+static void GetFastBinLayout(const DataSubsetBoosting* const pSubset,
+      const bool bHessian,
+      const size_t cScores,
+      const size_t cTensorBins,
+      size_t* const pcBytesPerFastBinOut,
+      bool* const pbParallelBinsOut) {
+   size_t cBytesPerFastBin;
+   if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, bHessian, cScores);
+      }
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+      if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
+         cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, bHessian, cScores);
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
+         cBytesPerFastBin = GetBinSize<FloatSmall, UIntSmall>(false, false, bHessian, cScores);
+      }
+   }
+   EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
+
+   bool bParallelBins = false;
+
+   // in the future use TermBoostFlags_DisableNewtonGain and TermBoostFlags_DisableNewtonUpdate and
+   // TermBoostFlags_GradientSums flags in addition to what the objective allows when setting bHessian
+#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
+   const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+   size_t cBytesParallelMax;
+   if(bHessian) {
+      if(size_t {1} == cScores) {
+         cBytesParallelMax = HESSIAN_PARALLEL_BIN_BYTES_MAX;
+      } else {
+         cBytesParallelMax = MULTISCORE_PARALLEL_BIN_BYTES_MAX;
+      }
+   } else {
+      if(size_t {1} == cScores) {
+         cBytesParallelMax = GRADIENT_PARALLEL_BIN_BYTES_MAX;
+      } else {
+         // don't allow parallel gradient multiclass boosting. multiclass should be hessian boosting
+         cBytesParallelMax = 0;
+      }
+   }
+   if(1 != cSIMDPack && 1 != cTensorBins) {
+      const size_t cBytesParallel = cBytesPerFastBin * cTensorBins * cSIMDPack;
+      if(cBytesParallel <= cBytesParallelMax) {
+         // use parallel bins
+         bParallelBins = true;
+      }
+   }
+#endif
+
+   *pcBytesPerFastBinOut = cBytesPerFastBin;
+   *pbParallelBinsOut = bParallelBins;
+}
+
+struct BinSumsTaskContext final {
+   BoosterShell* m_pBoosterShell;
+   const Term* m_pTerm;
+   size_t m_iTerm;
+   size_t m_iBag;
+   size_t m_cTensorBins;
+   bool m_bSharedFastBins;
+};
+
+static ErrorEbm BinSumsSubsetTask(void* const pContext, const size_t iSubset) {
+   const BinSumsTaskContext* const pTaskContext = static_cast<const BinSumsTaskContext*>(pContext);
+   BoosterShell* const pBoosterShell = pTaskContext->m_pBoosterShell;
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   const size_t cScores = pBoosterCore->GetCountScores();
+   const size_t cTensorBins = pTaskContext->m_cTensorBins;
+
+   DataSubsetBoosting* const pSubset = &pBoosterCore->GetTrainingSet()->GetSubsets()[iSubset];
+
+   int cPack;
+   if(1 == cTensorBins) {
+      // this is kind of hacky where if any one of a number of things occurs (like we have only 1 leaf)
+      // we sum everything into a single bin. The alternative would be to always sum into the tensor bins
+      // but then collapse them afterwards into a single bin, but that's more work.
+      cPack = k_cItemsPerBitPackUndefined;
+   } else {
+      EBM_ASSERT(1 <= pTaskContext->m_pTerm->GetBitsRequiredMin());
+      cPack = GetCountItemsBitPacked(
+            pTaskContext->m_pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+   }
+
+   const bool bHessian = pBoosterCore->IsHessian();
+   size_t cBytesPerFastBin;
+   bool bParallelBins;
+   GetFastBinLayout(pSubset, bHessian, cScores, cTensorBins, &cBytesPerFastBin, &bParallelBins);
+   const size_t cParallelTensorBins =
+         bParallelBins ? cTensorBins * pSubset->GetObjectiveWrapper()->m_cSIMDPack : cTensorBins;
+
+   BinBase* const aFastBins =
+         pBoosterShell->GetBoostingFastBinsTemp(pTaskContext->m_bSharedFastBins ? size_t{0} : iSubset);
+   EBM_ASSERT(nullptr != aFastBins);
+   aFastBins->ZeroMem(cBytesPerFastBin, cParallelTensorBins);
+
+   const uint64_t tickStart = BoosterShell::GetStatTicks();
+
+   BinSumsBoostingBridge params;
+   params.m_bParallelBins = bParallelBins ? EBM_TRUE : EBM_FALSE;
+   params.m_bHessian = bHessian ? EBM_TRUE : EBM_FALSE;
+   params.m_cScores = cScores;
+   params.m_cPack = cPack;
+   params.m_cBytesFastBins = cBytesPerFastBin * cTensorBins;
+   const void* const aBagWeights =
+         pSubset->GetBagWeights(pTaskContext->m_iBag, pBoosterShell->GetBagWeightsTemp(iSubset));
+   if(0 == pSubset->GetCountSampled()) {
+      params.m_cSamples = pSubset->GetCountSamples();
+      params.m_aGradientsAndHessians = pSubset->GetGradHess();
+      params.m_aWeights = aBagWeights;
+      params.m_aPacked = pSubset->GetTermData(pTaskContext->m_iTerm);
+   } else {
+      // gradient sampling bins only the selected samples.  Their gradients were compacted when they were selected,
+      // but the weights depend on the bag and the term data on the term, so gather those here.  The gathered
+      // weights are never nullptr since they include the sampling factors
+      void* const aSampledWeights = pBoosterShell->GetSampledWeightsTemp(iSubset);
+      pSubset->GatherSampledWeights(aBagWeights, aSampledWeights);
+      void* aSampledTermData = nullptr;
+      if(k_cItemsPerBitPackUndefined != cPack) {
+         aSampledTermData = pBoosterShell->GetSampledTermDataTemp(iSubset);
+         pSubset->GatherSampledTermData(pTaskContext->m_iTerm, cPack, aSampledTermData);
+      }
+      params.m_cSamples = pSubset->GetCountSampled();
+      params.m_aGradientsAndHessians = pSubset->GetSampledGradHess();
+      params.m_aWeights = aSampledWeights;
+      params.m_aPacked = aSampledTermData;
+   }
+   params.m_aFastBins = aFastBins;
+#ifndef NDEBUG
+   params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cParallelTensorBins);
+#endif // NDEBUG
+   const ErrorEbm error = pSubset->BinSumsBoosting(&params);
+   if(Error_None != error) {
+      return error;
+   }
+
+   SubsetStat* const pSubsetStat = &pBoosterShell->GetSubsetStats()[iSubset];
+   pSubsetStat->m_cNanoseconds = BoosterShell::GetStatTicks() - tickStart;
+   pSubsetStat->m_cBytes = static_cast<uint64_t>(BoosterShell::GetStatSampleBytes(pSubset->GetObjectiveWrapper(),
+         params.m_cSamples,
+         cPack,
+         cScores * (bHessian ? size_t{2} : size_t{1}) + (nullptr != params.m_aWeights ? 1 : 0)));
+   pSubsetStat->m_metric = 0.0;
+   pSubsetStat->m_bApplied = true;
+   return Error_None;
+}
+
 static int g_cLogGenerateTermUpdate = 10;
 
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
@@ -625,6 +803,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
          static_cast<const void*>(direction),
          static_cast<void*>(avgGainOut));
 
+   TimelineScope timelineScope(TimelineName_GenerateTermUpdate, indexTerm, IntEbm{0});
+
    if(LIKELY(nullptr != avgGainOut)) {
       *avgGainOut = k_illegalGainDouble;
    }
@@ -637,6 +817,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
 
    // set this to illegal so if we exit with an error we have an invalid index
    pBoosterShell->SetTermIndex(BoosterShell::k_illegalTermIndex);
+   // callers can generate several updates before applying one, so do not let the scratch memory pile up
+   pBoosterShell->GetScratch()->Reset();
 
    if(indexTerm < 0) {
       LOG_0(Trace_Error, "ERROR GenerateTermUpdate indexTerm must be positive");
@@ -652,6 +834,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
    }
    size_t iTerm = static_cast<size_t>(indexTerm);
 
+   timelineScope.SetArgs(indexTerm, static_cast<IntEbm>(pBoosterCore->GetTrainingSet()->GetCountSamples()));
+
    // this is true because 0 < pBoosterCore->m_cTerms since our caller needs to pass in a valid indexTerm to this
    // function
    EBM_ASSERT(nullptr != pBoosterCore->GetTerms());
@@ -878,8 +1062,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
          cTensorBins = 1;
       }
 
-      BinBase* const aFastBins = pBoosterShell->GetBoostingFastBinsTemp();
-      EBM_ASSERT(nullptr != aFastBins);
+      EBM_ASSERT(nullptr != pBoosterShell->GetBoostingFastBinsTemp());
 
       const size_t cBytesPerMainBin = GetBinSize<FloatMain, UIntMain>(true, true, pBoosterCore->IsHessian(), cScores);
       EBM_ASSERT(!IsMultiplyError(cBytesPerMainBin, cTensorBins));
@@ -899,111 +1082,71 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
       pBoosterShell->SetDebugMainBinsEnd(IndexBin(aMainBins, cBytesPerMainBin * (cTensorBins + cAuxillaryBins)));
 #endif // NDEBUG
 
+      if(pBoosterCore->IsGradientSampling()) {
+         error = pBoosterShell->AllocateSampledTemps();
+         if(Error_None != error) {
+            return error;
+         }
+      }
+
       size_t iBag = 0;
       EBM_ASSERT(1 <= cInnerBagsAfterZero);
       do {
          memset(aMainBins, 0, cBytesMainBins);
 
          EBM_ASSERT(1 <= pBoosterCore->GetTrainingSet()->GetCountSubsets());
-         DataSubsetBoosting* pSubset = pBoosterCore->GetTrainingSet()->GetSubsets();
-         const DataSubsetBoosting* const pSubsetsEnd = pSubset + pBoosterCore->GetTrainingSet()->GetCountSubsets();
-         do {
-            int cPack;
-            if(1 == cTensorBins) {
-               // this is kind of hacky where if any one of a number of things occurs (like we have only 1 leaf)
-               // we sum everything into a single bin. The alternative would be to always sum into the tensor bins
-               // but then collapse them afterwards into a single bin, but that's more work.
-               cPack = k_cItemsPerBitPackUndefined;
-            } else {
-               EBM_ASSERT(1 <= pTerm->GetBitsRequiredMin());
-               cPack =
-                     GetCountItemsBitPacked(pTerm->GetBitsRequiredMin(), pSubset->GetObjectiveWrapper()->m_cUIntBytes);
+         const size_t cSubsets = pBoosterCore->GetTrainingSet()->GetCountSubsets();
+
+         BinSumsTaskContext context;
+         context.m_pBoosterShell = pBoosterShell;
+         context.m_pTerm = pTerm;
+         context.m_iTerm = iTerm;
+         context.m_iBag = iBag;
+         context.m_cTensorBins = cTensorBins;
+
+         // when the caller configured a thread pool, each subset sums into its own fast bins so the subsets can be
+         // binned in parallel.  Otherwise each subset is binned into the first fast bins just before being folded,
+         // which keeps them in cache.  Folding in subset order keeps the sums identical either way
+         const bool bParallel = size_t{1} < cSubsets && IsParallelForEnabled();
+         context.m_bSharedFastBins = !bParallel;
+         if(bParallel) {
+            error = ParallelFor(cSubsets, BinSumsSubsetTask, &context);
+            if(Error_None != error) {
+               return error;
             }
+         }
 
-            size_t cBytesPerFastBin;
-            if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
-               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                  cBytesPerFastBin = GetBinSize<FloatBig, UIntBig>(false, false, pBoosterCore->IsHessian(), cScores);
-               } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                  cBytesPerFastBin = GetBinSize<FloatSmall, UIntBig>(false, false, pBoosterCore->IsHessian(), cScores);
-               }
-            } else {
-               EBM_ASSERT(sizeof(UIntSmall) == pSubset->GetObjectiveWrapper()->m_cUIntBytes);
-               if(sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes) {
-                  cBytesPerFastBin = GetBinSize<FloatBig, UIntSmall>(false, false, pBoosterCore->IsHessian(), cScores);
-               } else {
-                  EBM_ASSERT(sizeof(FloatSmall) == pSubset->GetObjectiveWrapper()->m_cFloatBytes);
-                  cBytesPerFastBin =
-                        GetBinSize<FloatSmall, UIntSmall>(false, false, pBoosterCore->IsHessian(), cScores);
+         for(size_t iSubset = 0; iSubset < cSubsets; ++iSubset) {
+            if(!bParallel) {
+               error = BinSumsSubsetTask(&context, iSubset);
+               if(Error_None != error) {
+                  return error;
                }
             }
-            EBM_ASSERT(!IsMultiplyError(cBytesPerFastBin, cTensorBins));
 
-            size_t cParallelTensorBins = cTensorBins;
-            bool bParallelBins = false;
-            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
+            const DataSubsetBoosting* const pSubset = &pBoosterCore->GetTrainingSet()->GetSubsets()[iSubset];
+            const SubsetStat* const pSubsetStat = &pBoosterShell->GetSubsetStats()[iSubset];
+            EBM_ASSERT(pSubsetStat->m_bApplied);
+            pBoosterShell->RecordStatNanoseconds(BoosterStat_BinSums,
+                  iTerm,
+                  pSubset->GetObjectiveWrapper(),
+                  pSubsetStat->m_cNanoseconds,
+                  static_cast<size_t>(pSubsetStat->m_cBytes));
 
-            // in the future use TermBoostFlags_DisableNewtonGain and TermBoostFlags_DisableNewtonUpdate and
-            // TermBoostFlags_GradientSums flags in addition to what the objective allows when setting bHessian
-            const bool bHessian = pBoosterCore->IsHessian();
-#if 0 < HESSIAN_PARALLEL_BIN_BYTES_MAX || 0 < GRADIENT_PARALLEL_BIN_BYTES_MAX || 0 < MULTISCORE_PARALLEL_BIN_BYTES_MAX
-            size_t cBytesParallelMax;
-            if(bHessian) {
-               if(size_t {1} == cScores) {
-                  cBytesParallelMax = HESSIAN_PARALLEL_BIN_BYTES_MAX;
-               } else {
-                  cBytesParallelMax = MULTISCORE_PARALLEL_BIN_BYTES_MAX;
-               }
-            } else {
-               if(size_t {1} == cScores) {
-                  cBytesParallelMax = GRADIENT_PARALLEL_BIN_BYTES_MAX;
-               } else {
-                  // don't allow parallel gradient multiclass boosting. multiclass should be hessian boosting
-                  cBytesParallelMax = 0;
-               }
-            }
-            if(1 != cSIMDPack && 1 != cTensorBins) {
-               const size_t cBytesParallel = cBytesPerFastBin * cTensorBins * cSIMDPack;
-               if(cBytesParallel <= cBytesParallelMax) {
-                  // use parallel bins
-                  bParallelBins = true;
-                  cParallelTensorBins *= cSIMDPack;
-               }
-            }
-#endif
-
-            aFastBins->ZeroMem(cBytesPerFastBin, cParallelTensorBins);
-
-            BinSumsBoostingBridge params;
-            params.m_bParallelBins = bParallelBins ? EBM_TRUE : EBM_FALSE;
-            params.m_bHessian = bHessian ? EBM_TRUE : EBM_FALSE;
-            params.m_cScores = cScores;
-            params.m_cPack = cPack;
-            params.m_cSamples = pSubset->GetCountSamples();
-            params.m_cBytesFastBins = cBytesPerFastBin * cTensorBins;
-            params.m_aGradientsAndHessians = pSubset->GetGradHess();
-            params.m_aWeights = pSubset->GetInnerBag(iBag)->GetWeights();
-            params.m_aPacked = pSubset->GetTermData(iTerm);
-            params.m_aFastBins = aFastBins;
-#ifndef NDEBUG
-            params.m_pDebugFastBinsEnd = IndexBin(aFastBins, cBytesPerFastBin * cParallelTensorBins);
-#endif // NDEBUG
-            error = pSubset->BinSumsBoosting(&params);
-            if(Error_None != error) {
-               return error;
-            }
+            size_t cBytesPerFastBin;
+            bool bParallelBins;
+            GetFastBinLayout(
+                  pSubset, pBoosterCore->IsHessian(), cScores, cTensorBins, &cBytesPerFastBin, &bParallelBins);
+            const size_t cSIMDPack = pSubset->GetObjectiveWrapper()->m_cSIMDPack;
 
             const bool bUInt64Src = sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes;
             const bool bDoubleSrc = sizeof(FloatBig) == pSubset->GetObjectiveWrapper()->m_cFloatBytes;
 
-            ++pSubset;
-
-            BinBase* pFastBins = aFastBins;
+            BinBase* pFastBins = pBoosterShell->GetBoostingFastBinsTemp(bParallel ? iSubset : size_t{0});
             for(size_t i = 0; i < cSIMDPack; ++i) {
                const UIntMain* aCounts = nullptr;
                const FloatPrecomp* aWeights = nullptr;
-               if(pSubsetsEnd == pSubset && (!bParallelBins || i == cSIMDPack - 1)) {
+               if(cSubsets - 1 == iSubset && (!bParallelBins || i == cSIMDPack - 1)) {
                   // the aCounts and aWeights tensors contain the final counts and weights, so when calling
                   // ConvertAddBin we only want to call it once with these tensors since otherwise they
                   // would be added multiple times
@@ -1032,7 +1175,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
                }
                pFastBins = IndexBin(pFastBins, cBytesPerFastBin * cTensorBins);
             }
-         } while(pSubsetsEnd != pSubset);
+         }
 
          // TODO: we can exit here back to python to allow caller modification to our histograms
          //       although having inner bags makes this complicated since each inner bag has it's own
@@ -1044,15 +1187,22 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
 
          if(1 == cTensorBins) {
             LOG_0(Trace_Warning, "WARNING GenerateTermUpdate boosting zero dimensional");
+            const uint64_t tickPartition = BoosterShell::GetStatTicks();
             BoostZeroDimensional(pBoosterShell, flags, regAlphaCalc, regLambdaCalc, deltaStepMax);
+            pBoosterShell->RecordStat(BoosterStat_Partition, iTerm, nullptr, tickPartition, cBytesPerMainBin);
          } else {
             const double weightTotal = pBoosterCore->GetTrainingSet()->GetBagWeightTotal(iBag);
             EBM_ASSERT(0 < weightTotal); // if all are zeros we assume there are no weights and use the count
 
+            // the draws in this bag, which differ from the training set's sample count for Poisson bags
+            const size_t cSamplesTotal = static_cast<size_t>(
+                  *TermInnerBag::GetCounts(true, iTerm, iBag, pBoosterCore->GetTrainingSet()->GetTermInnerBags()));
+
             double gain;
             if(0 != (TermBoostFlags_RandomSplits & flags) || 2 < cRealDimensions) {
                // THIS RANDOM SPLIT OPTION IS PRIMARILY USED FOR DIFFERENTIAL PRIVACY EBMs
 
+               const uint64_t tickPartition = BoosterShell::GetStatTicks();
                error = BoostRandom(pRng,
                      pBoosterShell,
                      iTerm,
@@ -1066,6 +1216,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
                if(Error_None != error) {
                   return error;
                }
+               pBoosterShell->RecordStat(BoosterStat_Partition, iTerm, nullptr, tickPartition, cBytesMainBins);
             } else if(1 == cRealDimensions) {
                EBM_ASSERT(nullptr != leavesMax); // otherwise we'd use BoostZeroDimensional above
                EBM_ASSERT(IntEbm{2} <= lastDimensionLeavesMax); // otherwise we'd use BoostZeroDimensional above
@@ -1075,10 +1226,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
                EBM_ASSERT(cSignificantBinCount == pTerm->GetCountTensorBins());
                EBM_ASSERT(0 == pTerm->GetCountAuxillaryBins());
 
+               const uint64_t tickPartition = BoosterShell::GetStatTicks();
                error = BoostSingleDimensional(pRng,
                      pBoosterShell,
                      flags,
                      cSignificantBinCount,
+                     cSamplesTotal,
                      static_cast<FloatMain>(weightTotal),
                      iDimensionImportant,
                      cSamplesLeafMin,
@@ -1092,6 +1245,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
                if(Error_None != error) {
                   return error;
                }
+               pBoosterShell->RecordStat(BoosterStat_Partition, iTerm, nullptr, tickPartition, cBytesMainBins);
             } else {
                error = BoostMultiDimensional(pBoosterShell,
                      flags,
@@ -0,0 +1,610 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memset, memcpy
+#include <cmath> // std::abs
+#include <limits> // numeric_limits
+#include <algorithm> // std::nth_element, std::min
+
+#include "libebm.h" // EBM_API_BODY
+#include "logging.h" // EBM_ASSERT
+
+#define ZONE_main
+#include "zones.h"
+
+#include "bridge.h" // UIntBig
+#include "common.hpp" // MakeLowMask
+#include "ebm_internal.hpp"
+#include "RandomDeterministic.hpp"
+#include "RandomNondeterministic.hpp"
+#include "RandomCounter.hpp"
+#include "BoosterCore.hpp"
+#include "BoosterShell.hpp"
+#include "ThreadPool.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// the most gradient magnitudes that BoosterCore::SampleGradients looks at to find the top fraction threshold
+static constexpr size_t k_cSampleMagnitudesMax = size_t{65536};
+
+// Gradient-based one-side sampling (GOSS) from "LightGBM: A Highly Efficient Gradient Boosting Decision Tree"
+// (Ke et al. 2017).  Each time the training gradients change we keep the fraction a of the samples that have the
+// largest gradients plus a random fraction b of all samples drawn from the rest, and scale the random ones by
+// (1 - a) / b so that the bin sums remain unbiased estimates of the full sums.  BinSums then runs over a compacted
+// copy of the selected samples.  The counts and weights that BinSums does not produce still come from the
+// TermInnerBag tensors, so minSamplesLeaf and the gain normalization continue to see the whole bag.
+
+ErrorEbm DataSubsetBoosting::AllocateGradientSample(const size_t cScores, const bool bHessian) {
+   EBM_ASSERT(1 <= m_cSamples);
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(nullptr != m_pObjective);
+
+   if(nullptr != m_aiSampled) {
+      return Error_None;
+   }
+
+   const size_t cFloatBytes = m_pObjective->m_cFloatBytes;
+   const size_t cValues = bHessian ? cScores << 1 : cScores;
+   // InitGradHess allocated the same number of gradients and hessians, so this cannot overflow
+   EBM_ASSERT(!IsMultiplyError(cFloatBytes, cValues, m_cSamples));
+
+   // m_cSamples is a multiple of the SIMD pack, so padding the sampled count never takes it past m_cSamples
+   if(IsMultiplyError(sizeof(*m_aiSampled), m_cSamples)) {
+      LOG_0(Trace_Warning,
+            "WARNING DataSubsetBoosting::AllocateGradientSample IsMultiplyError(sizeof(*m_aiSampled), m_cSamples)");
+      return Error_OutOfMemory;
+   }
+   m_aiSampled = static_cast<size_t*>(AlignedAllocPlaced(sizeof(*m_aiSampled) * m_cSamples));
+   if(nullptr == m_aiSampled) {
+      LOG_0(Trace_Warning, "WARNING DataSubsetBoosting::AllocateGradientSample nullptr == m_aiSampled");
+      return Error_OutOfMemory;
+   }
+   m_aSampledGradHess = AlignedAllocPlaced(cFloatBytes * cValues * m_cSamples);
+   if(nullptr == m_aSampledGradHess) {
+      LOG_0(Trace_Warning, "WARNING DataSubsetBoosting::AllocateGradientSample nullptr == m_aSampledGradHess");
+      return Error_OutOfMemory;
+   }
+   m_aSampledFactors = AlignedAllocPlaced(cFloatBytes * m_cSamples);
+   if(nullptr == m_aSampledFactors) {
+      LOG_0(Trace_Warning, "WARNING DataSubsetBoosting::AllocateGradientSample nullptr == m_aSampledFactors");
+      return Error_OutOfMemory;
+   }
+   return Error_None;
+}
+
+void DataSubsetBoosting::FreeGradientSample() {
+   AlignedFree(m_aSampledFactors);
+   AlignedFree(m_aSampledGradHess);
+   AlignedFree(m_aiSampled);
+   m_aSampledFactors = nullptr;
+   m_aSampledGradHess = nullptr;
+   m_aiSampled = nullptr;
+   m_cSampled = 0;
+}
+
+template<typename TFloat>
+INLINE_ALWAYS static double GradientMagnitude(
+      const size_t cScores, const size_t cValuesPerScore, const size_t cSIMDPack, const TFloat* const pGradient) {
+   // multiclass uses the sum over the scores of each sample
+   double magnitude = 0.0;
+   size_t iScore = 0;
+   do {
+      magnitude += std::abs(static_cast<double>(pGradient[iScore * cValuesPerScore * cSIMDPack]));
+      ++iScore;
+   } while(cScores != iScore);
+   return magnitude;
+}
+
+template<typename TFloat>
+static void FillGradientMagnitudesInternal(const size_t cSamples,
+      const size_t cSIMDPack,
+      const size_t cScores,
+      const size_t cValuesPerScore,
+      const size_t iSampleFirst,
+      const size_t cStride,
+      const TFloat* const aGradHess,
+      double* const aMagnitudesOut) {
+   // the gradients and hessians of each SIMD pack of samples are stored together as
+   // [score][gradient, hessian][lane], so a sample's values are cSIMDPack apart
+   const size_t cValuesPerPack = cScores * cValuesPerScore * cSIMDPack;
+
+   // aMagnitudesOut holds every cStride-th sample of the whole DataSetBoosting
+   size_t iSample = (cStride - iSampleFirst % cStride) % cStride;
+   double* pMagnitude = &aMagnitudesOut[(iSampleFirst + iSample) / cStride];
+   while(iSample < cSamples) {
+      *pMagnitude = GradientMagnitude(cScores,
+            cValuesPerScore,
+            cSIMDPack,
+            &aGradHess[iSample / cSIMDPack * cValuesPerPack + iSample % cSIMDPack]);
+      ++pMagnitude;
+      iSample += cStride;
+   }
+}
+
+void DataSubsetBoosting::FillGradientMagnitudes(
+      const size_t cScores, const bool bHessian, const size_t cStride, double* const aMagnitudesOut) const {
+   EBM_ASSERT(1 <= m_cSamples);
+   EBM_ASSERT(nullptr != m_aGradHess);
+   EBM_ASSERT(1 <= cStride);
+   EBM_ASSERT(nullptr != aMagnitudesOut);
+
+   const size_t cValuesPerScore = bHessian ? size_t{2} : size_t{1};
+   if(sizeof(FloatBig) == m_pObjective->m_cFloatBytes) {
+      FillGradientMagnitudesInternal(m_cSamples,
+            m_pObjective->m_cSIMDPack,
+            cScores,
+            cValuesPerScore,
+            m_iSampleFirst,
+            cStride,
+            static_cast<const FloatBig*>(m_aGradHess),
+            aMagnitudesOut);
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == m_pObjective->m_cFloatBytes);
+      FillGradientMagnitudesInternal(m_cSamples,
+            m_pObjective->m_cSIMDPack,
+            cScores,
+            cValuesPerScore,
+            m_iSampleFirst,
+            cStride,
+            static_cast<const FloatSmall*>(m_aGradHess),
+            aMagnitudesOut);
+   }
+}
+
+template<typename TFloat>
+static size_t SelectGradientSampleInternal(RandomCounter& rng,
+      const size_t cSamples,
+      const size_t cSIMDPack,
+      const size_t cScores,
+      const size_t cValuesPerScore,
+      const double thresholdTop,
+      const uint32_t cutoffOther,
+      const double factorOther,
+      const TFloat* const aGradHess,
+      size_t* const aiSampled,
+      TFloat* const aSampledGradHess,
+      TFloat* const aSampledFactors) {
+   const size_t cValues = cScores * cValuesPerScore;
+   const size_t cValuesPerPack = cValues * cSIMDPack;
+
+   size_t cSampled = 0;
+   size_t iSample = 0;
+   const TFloat* pGradHess = aGradHess;
+   do {
+      size_t iLane = 0;
+      do {
+         // every sample consumes one draw, so a sample's draw is at a fixed position in the stream no matter how
+         // the samples are divided into subsets
+         const uint32_t rand = rng.Next<uint32_t>();
+         const double magnitude = GradientMagnitude(cScores, cValuesPerScore, cSIMDPack, &pGradHess[iLane]);
+         double factor;
+         if(thresholdTop <= magnitude) {
+            factor = 1.0;
+         } else if(rand < cutoffOther) {
+            factor = factorOther;
+         } else {
+            goto next_sample;
+         }
+         {
+            aiSampled[cSampled] = iSample;
+            aSampledFactors[cSampled] = static_cast<TFloat>(factor);
+            TFloat* const pSampledGradHess =
+                  &aSampledGradHess[cSampled / cSIMDPack * cValuesPerPack + cSampled % cSIMDPack];
+            size_t iValue = 0;
+            do {
+               pSampledGradHess[iValue * cSIMDPack] = pGradHess[iValue * cSIMDPack + iLane];
+               ++iValue;
+            } while(cValues != iValue);
+            ++cSampled;
+         }
+      next_sample:;
+         ++iSample;
+         ++iLane;
+      } while(cSIMDPack != iLane);
+      pGradHess += cValuesPerPack;
+   } while(cSamples != iSample);
+
+   // BinSums needs at least one full SIMD pack.  The padding has zero gradients and zero weight, so it does not
+   // matter which bin it lands in.  Repeating the last index keeps the gathers reading memory that is already cached
+   const size_t iSamplePadding = 0 == cSampled ? size_t{0} : aiSampled[cSampled - 1];
+   while(0 == cSampled || 0 != cSampled % cSIMDPack) {
+      aiSampled[cSampled] = iSamplePadding;
+      aSampledFactors[cSampled] = 0;
+      TFloat* const pSampledGradHess = &aSampledGradHess[cSampled / cSIMDPack * cValuesPerPack + cSampled % cSIMDPack];
+      size_t iValue = 0;
+      do {
+         pSampledGradHess[iValue * cSIMDPack] = 0;
+         ++iValue;
+      } while(cValues != iValue);
+      ++cSampled;
+   }
+   EBM_ASSERT(cSampled <= cSamples);
+   return cSampled;
+}
+
+void DataSubsetBoosting::SelectGradientSample(const size_t cScores,
+      const bool bHessian,
+      const double thresholdTop,
+      const uint32_t cutoffOther,
+      const double factorOther,
+      RandomCounter rng,
+      const uint64_t iStream) {
+   EBM_ASSERT(1 <= m_cSamples);
+   EBM_ASSERT(nullptr != m_aGradHess);
+   EBM_ASSERT(nullptr != m_aiSampled);
+   EBM_ASSERT(nullptr != m_aSampledGradHess);
+   EBM_ASSERT(nullptr != m_aSampledFactors);
+
+   rng.Seek(iStream, static_cast<uint64_t>(m_iSampleFirst));
+
+   const size_t cValuesPerScore = bHessian ? size_t{2} : size_t{1};
+   if(sizeof(FloatBig) == m_pObjective->m_cFloatBytes) {
+      m_cSampled = SelectGradientSampleInternal(rng,
+            m_cSamples,
+            m_pObjective->m_cSIMDPack,
+            cScores,
+            cValuesPerScore,
+            thresholdTop,
+            cutoffOther,
+            factorOther,
+            static_cast<const FloatBig*>(m_aGradHess),
+            m_aiSampled,
+            static_cast<FloatBig*>(m_aSampledGradHess),
+            static_cast<FloatBig*>(m_aSampledFactors));
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == m_pObjective->m_cFloatBytes);
+      m_cSampled = SelectGradientSampleInternal(rng,
+            m_cSamples,
+            m_pObjective->m_cSIMDPack,
+            cScores,
+            cValuesPerScore,
+            thresholdTop,
+            cutoffOther,
+            factorOther,
+            static_cast<const FloatSmall*>(m_aGradHess),
+            m_aiSampled,
+            static_cast<FloatSmall*>(m_aSampledGradHess),
+            static_cast<FloatSmall*>(m_aSampledFactors));
+   }
+}
+
+template<typename TUInt>
+static void GatherSampledTermDataInternal(const int cItemsPerBitPack,
+      const size_t cSIMDPack,
+      const size_t cSamples,
+      const TUInt* const aPackedFrom,
+      const size_t cSampled,
+      const size_t* piSampled,
+      TUInt* pPackedTo) {
+   const int cBitsPerItemMax = GetCountBits<TUInt>(cItemsPerBitPack);
+   const TUInt maskBits = MakeLowMask<TUInt>(cBitsPerItemMax);
+   const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+   const int cSIMDShift = CountBitsRequired(cSIMDPack - size_t{1});
+   EBM_ASSERT(size_t{1} << cSIMDShift == cSIMDPack);
+   const size_t maskLane = cSIMDPack - size_t{1};
+
+   // InitTermData fills each lane from the high bits down, starting part way through the first word so that the
+   // last item lands in the lowest bits of its word.  Offsetting the row by the unused items of the first word
+   // turns that into a plain division.  Walking the source word by word instead would avoid the division, but the
+   // unpredictable number of steps between selected samples makes that several times slower
+   const size_t cItems = static_cast<size_t>(cItemsPerBitPack);
+   const size_t cRowOffset = cItems - size_t{1} - (cSamples >> cSIMDShift) % cItems;
+
+   int cShiftTo = static_cast<int>((cSampled >> cSIMDShift) % static_cast<size_t>(cItemsPerBitPack)) * cBitsPerItemMax;
+   memset(pPackedTo,
+         0,
+         sizeof(TUInt) * ((cSampled >> cSIMDShift) / static_cast<size_t>(cItemsPerBitPack) + size_t{1}) * cSIMDPack);
+
+   const size_t* const piSampledEnd = piSampled + cSampled;
+   do {
+      size_t iLane = 0;
+      do {
+         const size_t iSample = *piSampled;
+         const size_t iItem = (iSample >> cSIMDShift) + cRowOffset;
+         const size_t iWord = iItem / cItems;
+         const int cShiftFrom = cShiftReset - static_cast<int>(iItem - iWord * cItems) * cBitsPerItemMax;
+         const TUInt iBin = (aPackedFrom[(iWord << cSIMDShift) + (iSample & maskLane)] >> cShiftFrom) & maskBits;
+         pPackedTo[iLane] |= iBin << cShiftTo;
+         ++piSampled;
+         ++iLane;
+      } while(cSIMDPack != iLane);
+      cShiftTo -= cBitsPerItemMax;
+      if(cShiftTo < 0) {
+         cShiftTo = cShiftReset;
+         pPackedTo += cSIMDPack;
+      }
+   } while(piSampledEnd != piSampled);
+}
+
+void DataSubsetBoosting::GatherSampledTermData(
+      const size_t iTerm, const int cItemsPerBitPack, void* const aPackedOut) const {
+   EBM_ASSERT(1 <= cItemsPerBitPack);
+   EBM_ASSERT(0 != m_cSampled);
+   EBM_ASSERT(0 == m_cSampled % m_pObjective->m_cSIMDPack);
+   EBM_ASSERT(nullptr != aPackedOut);
+
+   if(sizeof(UIntBig) == m_pObjective->m_cUIntBytes) {
+      GatherSampledTermDataInternal(cItemsPerBitPack,
+            m_pObjective->m_cSIMDPack,
+            m_cSamples,
+            static_cast<const UIntBig*>(GetTermData(iTerm)),
+            m_cSampled,
+            m_aiSampled,
+            static_cast<UIntBig*>(aPackedOut));
+   } else {
+      EBM_ASSERT(sizeof(UIntSmall) == m_pObjective->m_cUIntBytes);
+      GatherSampledTermDataInternal(cItemsPerBitPack,
+            m_pObjective->m_cSIMDPack,
+            m_cSamples,
+            static_cast<const UIntSmall*>(GetTermData(iTerm)),
+            m_cSampled,
+            m_aiSampled,
+            static_cast<UIntSmall*>(aPackedOut));
+   }
+}
+
+template<typename TFloat>
+static void GatherSampledWeightsInternal(const size_t cSampled,
+      const size_t* piSampled,
+      const TFloat* pFactor,
+      const TFloat* const aBagWeights,
+      TFloat* pWeightOut) {
+   const TFloat* const pWeightOutEnd = pWeightOut + cSampled;
+   if(nullptr == aBagWeights) {
+      memcpy(pWeightOut, pFactor, sizeof(*pWeightOut) * cSampled);
+      return;
+   }
+   do {
+      *pWeightOut = *pFactor * aBagWeights[*piSampled];
+      ++piSampled;
+      ++pFactor;
+      ++pWeightOut;
+   } while(pWeightOutEnd != pWeightOut);
+}
+
+void DataSubsetBoosting::GatherSampledWeights(const void* const aBagWeights, void* const aWeightsOut) const {
+   EBM_ASSERT(0 != m_cSampled);
+   EBM_ASSERT(nullptr != aWeightsOut);
+
+   if(sizeof(FloatBig) == m_pObjective->m_cFloatBytes) {
+      GatherSampledWeightsInternal(m_cSampled,
+            m_aiSampled,
+            static_cast<const FloatBig*>(m_aSampledFactors),
+            static_cast<const FloatBig*>(aBagWeights),
+            static_cast<FloatBig*>(aWeightsOut));
+   } else {
+      EBM_ASSERT(sizeof(FloatSmall) == m_pObjective->m_cFloatBytes);
+      GatherSampledWeightsInternal(m_cSampled,
+            m_aiSampled,
+            static_cast<const FloatSmall*>(m_aSampledFactors),
+            static_cast<const FloatSmall*>(aBagWeights),
+            static_cast<FloatSmall*>(aWeightsOut));
+   }
+}
+
+struct SampleGradientsTaskContext final {
+   BoosterCore* m_pBoosterCore;
+   size_t m_cMagnitudeStride;
+   double* m_aMagnitudes;
+   double m_thresholdTop;
+   uint32_t m_cutoffOther;
+   double m_factorOther;
+   const RandomCounter* m_pRng;
+   uint64_t m_iStream;
+};
+
+static ErrorEbm FillGradientMagnitudesTask(void* const pContext, const size_t iSubset) {
+   const SampleGradientsTaskContext* const pTaskContext = static_cast<const SampleGradientsTaskContext*>(pContext);
+   BoosterCore* const pBoosterCore = pTaskContext->m_pBoosterCore;
+   const DataSubsetBoosting* const pSubset = &pBoosterCore->GetTrainingSet()->GetSubsets()[iSubset];
+   pSubset->FillGradientMagnitudes(pBoosterCore->GetCountScores(),
+         pBoosterCore->IsHessian(),
+         pTaskContext->m_cMagnitudeStride,
+         pTaskContext->m_aMagnitudes);
+   return Error_None;
+}
+
+static ErrorEbm SelectGradientSampleTask(void* const pContext, const size_t iSubset) {
+   const SampleGradientsTaskContext* const pTaskContext = static_cast<const SampleGradientsTaskContext*>(pContext);
+   BoosterCore* const pBoosterCore = pTaskContext->m_pBoosterCore;
+   DataSubsetBoosting* const pSubset = &pBoosterCore->GetTrainingSet()->GetSubsets()[iSubset];
+   pSubset->SelectGradientSample(pBoosterCore->GetCountScores(),
+         pBoosterCore->IsHessian(),
+         pTaskContext->m_thresholdTop,
+         pTaskContext->m_cutoffOther,
+         pTaskContext->m_factorOther,
+         *pTaskContext->m_pRng,
+         pTaskContext->m_iStream);
+   return Error_None;
+}
+
+ErrorEbm BoosterCore::SampleGradients() {
+   EBM_ASSERT(IsGradientSampling());
+
+   DataSetBoosting* const pTrainingSet = GetTrainingSet();
+   const size_t cSamples = pTrainingSet->GetCountSamples();
+   EBM_ASSERT(1 <= cSamples);
+   const size_t cSubsets = pTrainingSet->GetCountSubsets();
+
+   // finding the exact top fraction would need a selection over every sample on every boosting step.  The threshold
+   // from an evenly strided subset of the magnitudes is close enough and keeps this cost independent of cSamples
+   const size_t cStride = (cSamples - size_t{1}) / k_cSampleMagnitudesMax + size_t{1};
+   const size_t cMagnitudes = (cSamples - size_t{1}) / cStride + size_t{1};
+   EBM_ASSERT(cMagnitudes <= k_cSampleMagnitudesMax);
+
+   SampleGradientsTaskContext context;
+   context.m_pBoosterCore = this;
+   context.m_cMagnitudeStride = cStride;
+   context.m_aMagnitudes = m_aSampleMagnitudes;
+
+   ErrorEbm error = ParallelFor(cSubsets, FillGradientMagnitudesTask, &context);
+   if(Error_None != error) {
+      return error;
+   }
+
+   // the top fraction is taken over the whole training set rather than per subset, so the selection does not
+   // depend on how the samples were divided into subsets
+   const size_t cTop = static_cast<size_t>(m_sampleTopFraction * static_cast<double>(cMagnitudes));
+   double thresholdTop = std::numeric_limits<double>::infinity();
+   if(size_t{0} != cTop) {
+      double* const pThreshold = &m_aSampleMagnitudes[cMagnitudes - cTop];
+      std::nth_element(m_aSampleMagnitudes, pThreshold, &m_aSampleMagnitudes[cMagnitudes]);
+      thresholdTop = *pThreshold;
+   }
+
+   // the others are drawn from the remaining 1 - a of the samples, so keeping each one with probability b / (1 - a)
+   // gives the fraction b of all samples.  SetGradientSampling ensures that a + b < 1
+   EBM_ASSERT(m_sampleTopFraction + m_sampleOtherFraction < 1.0);
+   const double probabilityOther = m_sampleOtherFraction / (1.0 - m_sampleTopFraction);
+   EBM_ASSERT(0.0 <= probabilityOther && probabilityOther < 1.0);
+
+   context.m_thresholdTop = thresholdTop;
+   context.m_cutoffOther = static_cast<uint32_t>(probabilityOther * 4294967296.0);
+   context.m_factorOther = 0.0 == m_sampleOtherFraction ? 0.0 : (1.0 - m_sampleTopFraction) / m_sampleOtherFraction;
+   context.m_pRng = &m_sampleRng;
+   context.m_iStream = m_iSampleStep;
+
+   error = ParallelFor(cSubsets, SelectGradientSampleTask, &context);
+   if(Error_None != error) {
+      return error;
+   }
+
+   ++m_iSampleStep;
+   return Error_None;
+}
+
+void BoosterCore::FreeGradientSampling() {
+   free(m_aSampleMagnitudes);
+   m_aSampleMagnitudes = nullptr;
+
+   if(size_t{0} != m_trainingSet.GetCountSamples()) {
+      DataSubsetBoosting* pSubset = m_trainingSet.GetSubsets();
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_trainingSet.GetCountSubsets();
+      do {
+         pSubset->FreeGradientSample();
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+}
+
+ErrorEbm BoosterCore::SetGradientSampling(const uint64_t seed, const double topFraction, const double otherFraction) {
+   const size_t cSamples = m_trainingSet.GetCountSamples();
+   EBM_ASSERT(1 <= cSamples);
+   EBM_ASSERT(1 <= m_cScores);
+
+   if(nullptr == m_aSampleMagnitudes) {
+      const size_t cMagnitudes = std::min(cSamples, k_cSampleMagnitudesMax);
+      double* const aSampleMagnitudes = static_cast<double*>(malloc(sizeof(*m_aSampleMagnitudes) * cMagnitudes));
+      if(nullptr == aSampleMagnitudes) {
+         LOG_0(Trace_Warning, "WARNING BoosterCore::SetGradientSampling nullptr == aSampleMagnitudes");
+         return Error_OutOfMemory;
+      }
+      m_aSampleMagnitudes = aSampleMagnitudes;
+
+      DataSubsetBoosting* pSubset = m_trainingSet.GetSubsets();
+      const DataSubsetBoosting* const pSubsetsEnd = pSubset + m_trainingSet.GetCountSubsets();
+      do {
+         const ErrorEbm error = pSubset->AllocateGradientSample(m_cScores, IsHessian());
+         if(Error_None != error) {
+            FreeGradientSampling();
+            return error;
+         }
+         ++pSubset;
+      } while(pSubsetsEnd != pSubset);
+   }
+
+   m_sampleTopFraction = topFraction;
+   m_sampleOtherFraction = otherFraction;
+   m_iSampleStep = 0;
+   m_sampleRng.Initialize(seed);
+
+   const ErrorEbm error = SampleGradients();
+   if(Error_None != error) {
+      FreeGradientSampling();
+      return error;
+   }
+   return Error_None;
+}
+
+static int g_cLogSetGradientSampling = 10;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetGradientSampling(
+      void* rng, BoosterHandle boosterHandle, double topFraction, double otherFraction) {
+   LOG_COUNTED_N(&g_cLogSetGradientSampling,
+         Trace_Info,
+         Trace_Verbose,
+         "SetGradientSampling: "
+         "rng=%p, "
+         "boosterHandle=%p, "
+         "topFraction=%le, "
+         "otherFraction=%le",
+         rng,
+         static_cast<void*>(boosterHandle),
+         topFraction,
+         otherFraction);
+
+   BoosterShell* const pBoosterShell = BoosterShell::GetBoosterShellFromHandle(boosterHandle);
+   if(nullptr == pBoosterShell) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   // the negated comparisons also reject NaN
+   if(!(0.0 <= topFraction && topFraction <= 1.0)) {
+      LOG_0(Trace_Error, "ERROR SetGradientSampling topFraction must be between 0.0 and 1.0");
+      return Error_IllegalParamVal;
+   }
+   if(!(0.0 <= otherFraction && otherFraction <= 1.0)) {
+      LOG_0(Trace_Error, "ERROR SetGradientSampling otherFraction must be between 0.0 and 1.0");
+      return Error_IllegalParamVal;
+   }
+   if(0.0 == topFraction && 0.0 == otherFraction) {
+      LOG_0(Trace_Error, "ERROR SetGradientSampling topFraction and otherFraction cannot both be zero");
+      return Error_IllegalParamVal;
+   }
+
+   BoosterCore* const pBoosterCore = pBoosterShell->GetBoosterCore();
+   EBM_ASSERT(nullptr != pBoosterCore);
+
+   if(1.0 <= topFraction + otherFraction || size_t{0} == pBoosterCore->GetTrainingSet()->GetCountSamples() ||
+         size_t{0} == pBoosterCore->GetCountScores()) {
+      // every sample would be kept, so go back to binning the whole training set
+      pBoosterCore->FreeGradientSampling();
+      LOG_0(Trace_Info, "Exited SetGradientSampling with sampling off");
+      return Error_None;
+   }
+
+   uint64_t seed;
+   if(nullptr != rng) {
+      // like BranchRNG, this advances rng by exactly one draw
+      seed = reinterpret_cast<RandomDeterministic*>(rng)->Next(std::numeric_limits<uint64_t>::max());
+   } else {
+      try {
+         RandomNondeterministic<uint64_t> randomGenerator;
+         seed = randomGenerator.Next(std::numeric_limits<uint64_t>::max());
+      } catch(const std::bad_alloc&) {
+         LOG_0(Trace_Warning, "WARNING SetGradientSampling Out of memory in std::random_device");
+         return Error_OutOfMemory;
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING SetGradientSampling Unknown error in std::random_device");
+         return Error_UnexpectedInternal;
+      }
+   }
+
+   const ErrorEbm error = pBoosterCore->SetGradientSampling(seed, topFraction, otherFraction);
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_0(Trace_Info, "Exited SetGradientSampling");
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,348 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "libebm.h" // EBM_API_BODY
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // k_cDimensionsMax
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+
+#include "ThreadPool.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// When models are merged each term is re-binned onto the union of the cuts from all the models.  Working out which
+// old bins a new bin covers is cheap and is done per axis by the caller, which hands us for every new bin of every
+// dimension the list of old bins it draws from, and the fraction of the old bin that it covers.  Here we expand those
+// per axis descriptions into the full tensor, which is the part that grows with the product of the bin counts.
+//
+// For each new cell we visit every combination of the old bins listed for its coordinates.  Without bin weights we
+// are re-binning the weights themselves, so the old values are summed and then scaled by the product of the
+// fractions.  With bin weights we are re-binning scores, so we take the average of the old scores weighted by the
+// old bin weights.  If there is exactly one old cell we copy it to avoid any floating point loss.
+
+struct HarmonizeTensorsContext final {
+   size_t m_cScores;
+   size_t m_cDimensions;
+   size_t m_acBins[k_cDimensionsMax];
+   size_t m_cBinsTotal;
+   size_t m_cCells;
+   const IntEbm* const* m_aaOldBinCounts;
+   const IntEbm* const* m_aaOldBinOffsets;
+   const IntEbm* const* m_aaOldBinIndexes;
+   const double* const* m_aaPercentages;
+   const double* const* m_aaOldTensors;
+   const double* const* m_aaOldBinWeights;
+   double* const* m_aaTensorsOut;
+};
+
+static ErrorEbm HarmonizeTensorsTask(void* const pContext, const size_t iTensor) {
+   const HarmonizeTensorsContext* const p = static_cast<const HarmonizeTensorsContext*>(pContext);
+
+   const size_t cScores = p->m_cScores;
+   const size_t cDimensions = p->m_cDimensions;
+
+   const IntEbm* const oldBinCounts = p->m_aaOldBinCounts[iTensor];
+   const IntEbm* const oldBinOffsets = p->m_aaOldBinOffsets[iTensor];
+   const IntEbm* const oldBinIndexes = p->m_aaOldBinIndexes[iTensor];
+   const double* const aPercentages = p->m_aaPercentages[iTensor];
+   const double* const aOldTensor = p->m_aaOldTensors[iTensor];
+   const double* const aOldBinWeights = nullptr == p->m_aaOldBinWeights ? nullptr : p->m_aaOldBinWeights[iTensor];
+   double* const aTensorOut = p->m_aaTensorsOut[iTensor];
+
+   if(nullptr == oldBinCounts || nullptr == oldBinOffsets || nullptr == oldBinIndexes || nullptr == aPercentages ||
+         nullptr == aOldTensor || nullptr == aTensorOut) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors the per-tensor arrays cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   // the old tensor is in C order with any multiclass scores as the last dimension
+   size_t aOldStrides[k_cDimensionsMax];
+   size_t cOldCells = 1;
+   size_t iDimension = cDimensions;
+   while(size_t{0} != iDimension) {
+      --iDimension;
+      const IntEbm countOldBins = oldBinCounts[iDimension];
+      if(countOldBins <= IntEbm{0} || IsConvertError<size_t>(countOldBins)) {
+         LOG_0(Trace_Error, "ERROR HarmonizeTensors oldBinCounts must be positive");
+         return Error_IllegalParamVal;
+      }
+      aOldStrides[iDimension] = cOldCells;
+      if(IsMultiplyError(cOldCells, static_cast<size_t>(countOldBins))) {
+         LOG_0(Trace_Error, "ERROR HarmonizeTensors IsMultiplyError(cOldCells, countOldBins)");
+         return Error_IllegalParamVal;
+      }
+      cOldCells *= static_cast<size_t>(countOldBins);
+   }
+
+   // check that every list of old bins is in range for its dimension before we start indexing with them
+   if(IntEbm{0} != oldBinOffsets[0]) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors oldBinOffsets must start at zero");
+      return Error_IllegalParamVal;
+   }
+   size_t iBin = 0;
+   iDimension = 0;
+   while(cDimensions != iDimension) {
+      const IntEbm countOldBins = oldBinCounts[iDimension];
+      const size_t iBinEnd = iBin + p->m_acBins[iDimension];
+      do {
+         const IntEbm iOldFirst = oldBinOffsets[iBin];
+         const IntEbm iOldLast = oldBinOffsets[iBin + 1];
+         if(iOldLast < iOldFirst || IsConvertError<size_t>(iOldLast)) {
+            LOG_0(Trace_Error, "ERROR HarmonizeTensors oldBinOffsets must be non-decreasing");
+            return Error_IllegalParamVal;
+         }
+         for(IntEbm iOld = iOldFirst; iOld != iOldLast; ++iOld) {
+            const IntEbm iOldBin = oldBinIndexes[static_cast<size_t>(iOld)];
+            if(iOldBin < IntEbm{0} || countOldBins <= iOldBin) {
+               LOG_0(Trace_Error, "ERROR HarmonizeTensors oldBinIndexes contains an index outside of its dimension");
+               return Error_IllegalParamVal;
+            }
+         }
+         ++iBin;
+      } while(iBinEnd != iBin);
+      ++iDimension;
+   }
+   EBM_ASSERT(p->m_cBinsTotal == iBin);
+
+   size_t aiBins[k_cDimensionsMax];
+   size_t aiOld[k_cDimensionsMax];
+   const IntEbm* apOldFirst[k_cDimensionsMax];
+   size_t acOld[k_cDimensionsMax];
+
+   iDimension = 0;
+   while(cDimensions != iDimension) {
+      aiBins[iDimension] = 0;
+      ++iDimension;
+   }
+
+   double* pOut = aTensorOut;
+   const double* const pOutEnd = aTensorOut + p->m_cCells * cScores;
+   do {
+      double frac = 1.0;
+      size_t cOldCombinations = 1;
+      size_t iBinsStart = p->m_cBinsTotal;
+      iDimension = cDimensions;
+      while(size_t{0} != iDimension) {
+         --iDimension;
+         iBinsStart -= p->m_acBins[iDimension];
+         const size_t iBinFlat = iBinsStart + aiBins[iDimension];
+         frac *= aPercentages[iBinFlat];
+         const size_t iOldFirst = static_cast<size_t>(oldBinOffsets[iBinFlat]);
+         const size_t cOld = static_cast<size_t>(oldBinOffsets[iBinFlat + 1]) - iOldFirst;
+         apOldFirst[iDimension] = &oldBinIndexes[iOldFirst];
+         acOld[iDimension] = cOld;
+         aiOld[iDimension] = 0;
+         cOldCombinations *= cOld;
+      }
+      EBM_ASSERT(size_t{0} == iBinsStart);
+
+      for(size_t iScore = 0; iScore < cScores; ++iScore) {
+         pOut[iScore] = 0.0;
+      }
+
+      double totalWeight = 0.0;
+      // visit the old cells in C order, which is the order that the sums were historically made in
+      for(size_t iCombination = 0; iCombination < cOldCombinations; ++iCombination) {
+         size_t iOldCell = 0;
+         for(iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            iOldCell += static_cast<size_t>(apOldFirst[iDimension][aiOld[iDimension]]) * aOldStrides[iDimension];
+         }
+         const double* const pOld = &aOldTensor[iOldCell * cScores];
+         if(size_t{1} == cOldCombinations) {
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pOut[iScore] = pOld[iScore];
+            }
+         } else if(nullptr != aOldBinWeights) {
+            const double weight = aOldBinWeights[iOldCell];
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pOut[iScore] += pOld[iScore] * weight;
+            }
+            totalWeight += weight;
+         } else {
+            for(size_t iScore = 0; iScore < cScores; ++iScore) {
+               pOut[iScore] += pOld[iScore];
+            }
+         }
+
+         iDimension = cDimensions;
+         while(size_t{0} != iDimension) {
+            --iDimension;
+            ++aiOld[iDimension];
+            if(acOld[iDimension] != aiOld[iDimension]) {
+               break;
+            }
+            aiOld[iDimension] = 0;
+         }
+      }
+
+      if(nullptr == aOldBinWeights) {
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            pOut[iScore] *= frac;
+         }
+      } else if(0.0 != totalWeight) {
+         // if the total weight is zero then the weighted sum is also zero, which is what we want to leave
+         for(size_t iScore = 0; iScore < cScores; ++iScore) {
+            pOut[iScore] /= totalWeight;
+         }
+      }
+      pOut += cScores;
+
+      iDimension = cDimensions;
+      while(size_t{0} != iDimension) {
+         --iDimension;
+         ++aiBins[iDimension];
+         if(p->m_acBins[iDimension] != aiBins[iDimension]) {
+            break;
+         }
+         aiBins[iDimension] = 0;
+      }
+   } while(pOutEnd != pOut);
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION HarmonizeTensors(IntEbm countScores,
+      IntEbm countDimensions,
+      const IntEbm* binCounts,
+      IntEbm countTensors,
+      const IntEbm* const* oldBinCounts,
+      const IntEbm* const* oldBinOffsets,
+      const IntEbm* const* oldBinIndexes,
+      const double* const* percentages,
+      const double* const* oldTensors,
+      const double* const* oldBinWeights,
+      double* const* tensorsOut) {
+   LOG_N(Trace_Info,
+         "Entered HarmonizeTensors: "
+         "countScores=%" IntEbmPrintf ", "
+         "countDimensions=%" IntEbmPrintf ", "
+         "binCounts=%p, "
+         "countTensors=%" IntEbmPrintf ", "
+         "oldBinCounts=%p, "
+         "oldBinOffsets=%p, "
+         "oldBinIndexes=%p, "
+         "percentages=%p, "
+         "oldTensors=%p, "
+         "oldBinWeights=%p, "
+         "tensorsOut=%p",
+         countScores,
+         countDimensions,
+         static_cast<const void*>(binCounts),
+         countTensors,
+         static_cast<const void*>(oldBinCounts),
+         static_cast<const void*>(oldBinOffsets),
+         static_cast<const void*>(oldBinIndexes),
+         static_cast<const void*>(percentages),
+         static_cast<const void*>(oldTensors),
+         static_cast<const void*>(oldBinWeights),
+         static_cast<const void*>(tensorsOut));
+
+   if(countScores <= IntEbm{0}) {
+      if(IntEbm{0} == countScores) {
+         LOG_0(Trace_Info, "INFO HarmonizeTensors zero scores");
+         return Error_None;
+      } else {
+         LOG_0(Trace_Error, "ERROR HarmonizeTensors countScores must be positive");
+         return Error_IllegalParamVal;
+      }
+   }
+   if(IsConvertError<size_t>(countScores)) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors IsConvertError<size_t>(countScores)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cScores = static_cast<size_t>(countScores);
+
+   if(countDimensions < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors countDimensions cannot be negative");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm{k_cDimensionsMax} < countDimensions) {
+      LOG_0(Trace_Warning, "WARNING HarmonizeTensors countDimensions too large and would cause out of memory condition");
+      return Error_OutOfMemory;
+   }
+   const size_t cDimensions = static_cast<size_t>(countDimensions);
+
+   if(IsConvertError<size_t>(countTensors)) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors countTensors is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTensors = static_cast<size_t>(countTensors);
+   if(size_t{0} == cTensors) {
+      LOG_0(Trace_Info, "INFO HarmonizeTensors zero tensors");
+      return Error_None;
+   }
+
+   if(size_t{0} != cDimensions && nullptr == binCounts) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors nullptr == binCounts");
+      return Error_IllegalParamVal;
+   }
+   if(nullptr == oldBinCounts || nullptr == oldBinOffsets || nullptr == oldBinIndexes || nullptr == percentages ||
+         nullptr == oldTensors || nullptr == tensorsOut) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors the per-tensor arrays cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   HarmonizeTensorsContext context;
+   context.m_cScores = cScores;
+   context.m_cDimensions = cDimensions;
+
+   size_t cBinsTotal = 0;
+   size_t cCells = 1;
+   for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+      const IntEbm countBins = binCounts[iDimension];
+      if(countBins <= IntEbm{0}) {
+         if(IntEbm{0} == countBins) {
+            LOG_0(Trace_Info, "INFO HarmonizeTensors empty tensor");
+            return Error_None;
+         }
+         LOG_0(Trace_Error, "ERROR HarmonizeTensors binCounts cannot be negative");
+         return Error_IllegalParamVal;
+      }
+      if(IsConvertError<size_t>(countBins)) {
+         LOG_0(Trace_Error, "ERROR HarmonizeTensors IsConvertError<size_t>(countBins)");
+         return Error_IllegalParamVal;
+      }
+      const size_t cBins = static_cast<size_t>(countBins);
+      context.m_acBins[iDimension] = cBins;
+      if(IsMultiplyError(cCells, cBins)) {
+         LOG_0(Trace_Error, "ERROR HarmonizeTensors IsMultiplyError(cCells, cBins)");
+         return Error_IllegalParamVal;
+      }
+      cCells *= cBins;
+      cBinsTotal += cBins;
+   }
+   if(IsMultiplyError(cCells, cScores) || IsMultiplyError(sizeof(double), cCells * cScores)) {
+      LOG_0(Trace_Error, "ERROR HarmonizeTensors IsMultiplyError(sizeof(double), cCells, cScores)");
+      return Error_IllegalParamVal;
+   }
+   context.m_cBinsTotal = cBinsTotal;
+   context.m_cCells = cCells;
+
+   context.m_aaOldBinCounts = oldBinCounts;
+   context.m_aaOldBinOffsets = oldBinOffsets;
+   context.m_aaOldBinIndexes = oldBinIndexes;
+   context.m_aaPercentages = percentages;
+   context.m_aaOldTensors = oldTensors;
+   context.m_aaOldBinWeights = oldBinWeights;
+   context.m_aaTensorsOut = tensorsOut;
+
+   const ErrorEbm error = ParallelFor(cTensors, HarmonizeTensorsTask, &context);
+
+   LOG_0(Trace_Info, "Exited HarmonizeTensors");
+
+   return error;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -42,6 +42,7 @@ InnerBag* InnerBag::AllocateInnerBags(const size_t cInnerBags) {
    const InnerBag* const pInnerBagsEnd = &aInnerBag[cInnerBagsAfterZero];
    do {
       pInnerBag->m_aWeights = nullptr;
+      pInnerBag->m_iPoissonStream = 0;
       ++pInnerBag;
    } while(pInnerBagsEnd != pInnerBag);
 
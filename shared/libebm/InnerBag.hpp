@@ -6,9 +6,12 @@
 #define INNER_BAG_HPP
 
 #include <stddef.h> // size_t, ptrdiff_t
+#include <inttypes.h> // uint64_t, uint32_t, uint8_t
 
 #include "unzoned.h"
 
+#include "RandomCounter.hpp" // RandomCounter
+
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
 #error DEFINED_ZONE_NAME must be defined
@@ -28,6 +31,35 @@ struct InnerBag final {
    static void FreeInnerBags(const size_t cInnerBags, InnerBag* const aInnerBags);
 
    inline const void* GetWeights() const { return m_aWeights; }
+   inline uint64_t GetPoissonStream() const { return m_iPoissonStream; }
+
+   // Poisson bags give every sample an independent Poisson(1) count instead of drawing exactly cSamples samples with
+   // replacement.  The two converge as cSamples grows, but only the independent version lets any thread regenerate
+   // the count of sample i from the counter stream without seeing the samples before it.
+   INLINE_ALWAYS static uint8_t NextPoissonOccurrences(RandomCounter& rng) {
+      // inverse CDF of Poisson(1) on a 32 bit uniform.  Entry k is round(P(X <= k) * 2^32).  Counts above 12 have
+      // a probability below 2^-32, so they are folded into 12
+      static constexpr uint32_t k_aCumulative[] = {0x5E2D58D9,
+            0xBC5AB1B1,
+            0xEB715E1E,
+            0xFB239797,
+            0xFF1025F6,
+            0xFFD90F3C,
+            0xFFFA8B72,
+            0xFFFF540C,
+            0xFFFFED1F,
+            0xFFFFFE21,
+            0xFFFFFFD5,
+            0xFFFFFFFC};
+      static constexpr size_t k_cCumulative = sizeof(k_aCumulative) / sizeof(k_aCumulative[0]);
+
+      const uint32_t rand = rng.Next<uint32_t>();
+      size_t cOccurrences = 0;
+      while(k_cCumulative != cOccurrences && k_aCumulative[cOccurrences] <= rand) {
+         ++cOccurrences;
+      }
+      return static_cast<uint8_t>(cOccurrences);
+   }
 
  private:
    // Sampling with replacement is the more theoretically correct method of sampling, but it has the drawback that
@@ -36,7 +68,9 @@ struct InnerBag final {
    // we wouldn't need to use float weights. We could use a branchless comparison to get either 0.0 or the
    // gradient or hessian
 
+   // nullptr for Poisson bags, which regenerate their weights for each use from m_iPoissonStream
    void* m_aWeights;
+   uint64_t m_iPoissonStream;
 };
 static_assert(std::is_standard_layout<InnerBag>::value,
       "We use the struct hack in several places, so disallow non-standard_layout types in general");
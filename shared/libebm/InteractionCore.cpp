@@ -253,6 +253,11 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
       LOG_0(Trace_Warning, "WARNING InteractionCore::Create cClasses cannot fit into ptrdiff_t");
       return Error_IllegalParamVal;
    }
+   if(ptrdiff_t{Task_Ranking} == cClasses) {
+      // the pairwise ranking gradients depend on every document in a query, which the interaction gain does not model
+      LOG_0(Trace_Warning, "WARNING InteractionCore::Create interaction detection does not support ranking targets");
+      return Error_IllegalParamVal;
+   }
 
    if(ptrdiff_t{0} != cClasses && ptrdiff_t{1} != cClasses) {
       size_t cScores;
@@ -266,7 +271,9 @@ ErrorEbm InteractionCore::Create(const unsigned char* const pDataSetShared,
       LOG_0(Trace_Info, "INFO InteractionCore::Create determining Objective");
       Config config;
       config.cOutputs = cScores;
+      config.cTargets = 1;
       config.isDifferentialPrivacy = CreateInteractionFlags_DifferentialPrivacy & flags ? EBM_TRUE : EBM_FALSE;
+      config.linkFunction = Link_ERROR;
       error = GetObjective(
             &config, sObjective, acceleration, &pInteractionCore->m_objectiveCpu, &pInteractionCore->m_objectiveSIMD);
       if(Error_None != error) {
@@ -509,10 +516,14 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
                      ++pTargetFrom; // target data is shared so unlike init scores we must keep them even if replication
                                     // is zero
 
-                     // the shared data storage structure ensures that all target values are less than the number of
-                     // classes we also check that the number of classes can be converted to a ptrdiff_t and also a
-                     // UIntMain so we do not need the runtime to check this
-                     EBM_ASSERT(target < static_cast<UIntShared>(cClasses));
+                     // CheckDataSet skips this scan for datasets created with CreateInteractionFlags_CheckedDataSet.
+                     // We also check that the number of classes can be converted to a ptrdiff_t and also a UIntMain
+                     if(static_cast<UIntShared>(cClasses) <= target) {
+                        LOG_0(Trace_Error,
+                              "ERROR InteractionCore::InitializeInteractionGradientsAndHessians "
+                              "static_cast<UIntShared>(cClasses) <= target");
+                        return Error_IllegalParamVal;
+                     }
                   }
 
                   if(sizeof(UIntBig) == pSubset->GetObjectiveWrapper()->m_cUIntBytes) {
@@ -552,6 +563,7 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
             data.m_bHessianNeeded = IsHessian() ? EBM_TRUE : EBM_FALSE;
             data.m_bDisableApprox = IsDisableApprox();
             data.m_bValidation = EBM_FALSE;
+            data.m_bMetricNeeded = EBM_FALSE;
             data.m_cSamples = pSubset->GetCountSamples();
             data.m_aPacked = nullptr;
             data.m_aWeights = nullptr;
@@ -642,6 +654,7 @@ ErrorEbm InteractionCore::InitializeInteractionGradientsAndHessians(const unsign
             data.m_bHessianNeeded = IsHessian() ? EBM_TRUE : EBM_FALSE;
             data.m_bDisableApprox = IsDisableApprox();
             data.m_bValidation = EBM_FALSE;
+            data.m_bMetricNeeded = EBM_FALSE;
             data.m_cSamples = pSubset->GetCountSamples();
             data.m_aPacked = nullptr;
             data.m_aWeights = nullptr;
@@ -16,6 +16,7 @@
 #include "dataset_shared.hpp" // GetDataSetSharedHeader
 #include "InteractionCore.hpp"
 #include "InteractionShell.hpp"
+#include "Timeline.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -149,6 +150,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
          static_cast<const void*>(experimentalParams),
          static_cast<const void*>(interactionHandleOut));
 
+   TimelineScope timelineScope(TimelineName_CreateInteractionDetector, IntEbm{0}, IntEbm{0});
+
    ErrorEbm error;
 
    if(nullptr == interactionHandleOut) {
@@ -159,7 +162,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
 
    if(flags &
          ~(CreateInteractionFlags_DifferentialPrivacy | CreateInteractionFlags_DisableApprox |
-               CreateInteractionFlags_BinaryAsMulticlass)) {
+               CreateInteractionFlags_BinaryAsMulticlass | CreateInteractionFlags_CheckedDataSet)) {
       LOG_0(Trace_Error, "ERROR CreateInteractionDetector flags contains unknown flags. Ignoring extras.");
    }
 
@@ -172,8 +175,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
    size_t cFeatures;
    size_t cWeights;
    size_t cTargets;
-   error = GetDataSetSharedHeader(
-         static_cast<const unsigned char*>(dataSet), &countSamples, &cFeatures, &cWeights, &cTargets);
+   error = GetDataSetSharedHeader(static_cast<const unsigned char*>(dataSet),
+         0 != (CreateInteractionFlags_CheckedDataSet & flags),
+         &countSamples,
+         &cFeatures,
+         &cWeights,
+         &cTargets);
    if(Error_None != error) {
       // already logged
       return error;
@@ -237,6 +244,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const voi
       }
    }
 
+   timelineScope.SetArgs(static_cast<IntEbm>(cFeatures),
+         static_cast<IntEbm>(pInteractionCore->GetDataSetInteraction()->GetCountSamples()));
+
    const InteractionHandle handle = pInteractionShell->GetHandle();
 
    LOG_N(Trace_Info, "Exited CreateInteractionDetector: *interactionHandleOut=%p", static_cast<void*>(handle));
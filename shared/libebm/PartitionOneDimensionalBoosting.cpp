@@ -7,8 +7,7 @@
 #include <type_traits> // std::is_standard_layout
 #include <stddef.h> // size_t, ptrdiff_t
 #include <string.h> // memcpy
-#include <vector>
-#include <queue>
+#include <algorithm> // push_heap, pop_heap
 
 #include "libebm.h" // ErrorEbm
 #include "logging.h" // EBM_ASSERT
@@ -692,114 +691,118 @@ template<bool bHessian, size_t cCompilerScores> class PartitionOneDimensionalBoo
          EBM_ASSERT(!std::isinf(pRootTreeNode->AFTER_GetSplitGain()));
          EBM_ASSERT(0 <= pRootTreeNode->AFTER_GetSplitGain());
 
-         try {
-            // TODO: someday see if we can replace this with an in-class priority queue that stores it's info inside
-            //       the TreeNode datastructure
-            std::priority_queue<TreeNode<bHessian>*, std::vector<TreeNode<bHessian>*>, CompareNodeGain<bHessian>>
-                  nodeGainRanking;
-
-            auto* pTreeNode = pRootTreeNode;
-
-            // The root node used a left and right leaf, so reserve it here
-            pTreeNodeScratchSpace = IndexTreeNode(pTreeNodeScratchSpace, cBytesPerTreeNode << 1);
-
-            goto skip_first_push_pop;
-
-            do {
-               // there is no way to get the top and pop at the same time.. would be good to get a better queue, but our
-               // code isn't bottlenecked by it
-               pTreeNode = nodeGainRanking.top()->template Upgrade<GetArrayScores(cCompilerScores)>();
-               // In theory we can have nodes with equal gain values here, but this is very very rare to occur in
-               // practice We handle equal gain values in FindBestSplitGain because we can have zero instances in bins,
-               // in which case it occurs, but those equivalent situations have been cleansed by the time we reach this
-               // code, so the only realistic scenario where we might get equivalent gains is if we had an almost
-               // symetric distribution samples bin distributions AND two tail ends that happen to have the same
-               // statistics AND either this is our first split, or we've only made a single split in the center in the
-               // case where there is symetry in the center Even if all of these things are true, after one non-symetric
-               // split, we won't see that scenario anymore since the gradients won't be symetric anymore.  This is so
-               // rare, and limited to one split, so we shouldn't bother to handle it since the complexity of doing so
-               // outweights the benefits.
-               nodeGainRanking.pop();
-
-            skip_first_push_pop:
-
-               // pTreeNode had the highest gain of all the available Nodes, so we will split it.
-
-               // get the gain first, since calling AFTER_SplitNode destroys it
-               const FloatCalc totalGainUpdate = pTreeNode->AFTER_GetSplitGain();
-               EBM_ASSERT(!std::isnan(totalGainUpdate));
-               EBM_ASSERT(!std::isinf(totalGainUpdate));
-               EBM_ASSERT(0 <= totalGainUpdate);
-               totalGain += totalGainUpdate;
-
-               pTreeNode->AFTER_SplitNode();
-
-               auto* const pLeftChild = GetLeftNode(pTreeNode->AFTER_GetChildren());
-
-               retFind = FindBestSplitGain<bHessian, cCompilerScores>(pRng,
-                     pBoosterShell,
-                     flags,
-                     pLeftChild,
-                     pTreeNodeScratchSpace,
-                     cSamplesLeafMin,
-                     hessianMin,
-                     regAlpha,
-                     regLambda,
-                     deltaStepMax,
-                     direction);
-               // if FindBestSplitGain returned -1 to indicate an
-               // overflow ignore it here. We successfully made a root node split, so we might as well continue
-               // with the successful tree that we have which can make progress in boosting down the residuals
-               if(0 == retFind) {
-                  pTreeNodeScratchSpace = IndexTreeNode(pTreeNodeScratchSpace, cBytesPerTreeNode << 1);
-                  // our priority queue comparison function cannot handle NaN gains so we filter out before
-                  EBM_ASSERT(!std::isnan(pLeftChild->AFTER_GetSplitGain()));
-                  EBM_ASSERT(!std::isinf(pLeftChild->AFTER_GetSplitGain()));
-                  EBM_ASSERT(0 <= pLeftChild->AFTER_GetSplitGain());
-                  nodeGainRanking.push(pLeftChild->Downgrade());
-               }
+         // every node in the heap is a leaf that can still be split, so there are at most half as many as there are
+         // bins, and each split pops one node and pushes at most two
+         const size_t cHeapMax = EbmMin(cSplitsMax, cBins) + size_t{1};
+         EBM_ASSERT(!IsMultiplyError(sizeof(TreeNode<bHessian>*), cHeapMax));
+         TreeNode<bHessian>** const aHeap = static_cast<TreeNode<bHessian>**>(
+               pBoosterShell->GetScratch()->Allocate(sizeof(TreeNode<bHessian>*) * cHeapMax));
+         if(UNLIKELY(nullptr == aHeap)) {
+            LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting nullptr == aHeap");
+            return Error_OutOfMemory;
+         }
+         // the same heap operations that std::priority_queue uses, so the order of equal gains is unchanged
+         TreeNode<bHessian>** pHeapEnd = aHeap;
+         const CompareNodeGain<bHessian> compareNodeGain;
 
-               auto* const pRightChild = GetRightNode(pTreeNode->AFTER_GetChildren(), cBytesPerTreeNode);
+         auto* pTreeNode = pRootTreeNode;
 
-               retFind = FindBestSplitGain<bHessian, cCompilerScores>(pRng,
-                     pBoosterShell,
-                     flags,
-                     pRightChild,
-                     pTreeNodeScratchSpace,
-                     cSamplesLeafMin,
-                     hessianMin,
-                     regAlpha,
-                     regLambda,
-                     deltaStepMax,
-                     direction);
-               // if FindBestSplitGain returned -1 to indicate an
-               // overflow ignore it here. We successfully made a root node split, so we might as well continue
-               // with the successful tree that we have which can make progress in boosting down the residuals
-               if(0 == retFind) {
-                  pTreeNodeScratchSpace = IndexTreeNode(pTreeNodeScratchSpace, cBytesPerTreeNode << 1);
-                  // our priority queue comparison function cannot handle NaN gains so we filter out before
-                  EBM_ASSERT(!std::isnan(pRightChild->AFTER_GetSplitGain()));
-                  EBM_ASSERT(!std::isinf(pRightChild->AFTER_GetSplitGain()));
-                  EBM_ASSERT(0 <= pRightChild->AFTER_GetSplitGain());
-                  nodeGainRanking.push(pRightChild->Downgrade());
-               }
+         // The root node used a left and right leaf, so reserve it here
+         pTreeNodeScratchSpace = IndexTreeNode(pTreeNodeScratchSpace, cBytesPerTreeNode << 1);
 
-               --cSplitsRemaining;
-            } while(0 != cSplitsRemaining && UNLIKELY(!nodeGainRanking.empty()));
+         goto skip_first_push_pop;
 
-            EBM_ASSERT(!std::isnan(totalGain));
-            EBM_ASSERT(0 <= totalGain);
+         do {
+            pTreeNode = aHeap[0]->template Upgrade<GetArrayScores(cCompilerScores)>();
+            // In theory we can have nodes with equal gain values here, but this is very very rare to occur in
+            // practice We handle equal gain values in FindBestSplitGain because we can have zero instances in bins,
+            // in which case it occurs, but those equivalent situations have been cleansed by the time we reach this
+            // code, so the only realistic scenario where we might get equivalent gains is if we had an almost
+            // symetric distribution samples bin distributions AND two tail ends that happen to have the same
+            // statistics AND either this is our first split, or we've only made a single split in the center in the
+            // case where there is symetry in the center Even if all of these things are true, after one non-symetric
+            // split, we won't see that scenario anymore since the gradients won't be symetric anymore.  This is so
+            // rare, and limited to one split, so we shouldn't bother to handle it since the complexity of doing so
+            // outweights the benefits.
+            std::pop_heap(aHeap, pHeapEnd, compareNodeGain);
+            --pHeapEnd;
+
+         skip_first_push_pop:
+
+            // pTreeNode had the highest gain of all the available Nodes, so we will split it.
+
+            // get the gain first, since calling AFTER_SplitNode destroys it
+            const FloatCalc totalGainUpdate = pTreeNode->AFTER_GetSplitGain();
+            EBM_ASSERT(!std::isnan(totalGainUpdate));
+            EBM_ASSERT(!std::isinf(totalGainUpdate));
+            EBM_ASSERT(0 <= totalGainUpdate);
+            totalGain += totalGainUpdate;
+
+            pTreeNode->AFTER_SplitNode();
+
+            auto* const pLeftChild = GetLeftNode(pTreeNode->AFTER_GetChildren());
+
+            retFind = FindBestSplitGain<bHessian, cCompilerScores>(pRng,
+                  pBoosterShell,
+                  flags,
+                  pLeftChild,
+                  pTreeNodeScratchSpace,
+                  cSamplesLeafMin,
+                  hessianMin,
+                  regAlpha,
+                  regLambda,
+                  deltaStepMax,
+                  direction);
+            // if FindBestSplitGain returned -1 to indicate an
+            // overflow ignore it here. We successfully made a root node split, so we might as well continue
+            // with the successful tree that we have which can make progress in boosting down the residuals
+            if(0 == retFind) {
+               pTreeNodeScratchSpace = IndexTreeNode(pTreeNodeScratchSpace, cBytesPerTreeNode << 1);
+               // our heap comparison function cannot handle NaN gains so we filter out before
+               EBM_ASSERT(!std::isnan(pLeftChild->AFTER_GetSplitGain()));
+               EBM_ASSERT(!std::isinf(pLeftChild->AFTER_GetSplitGain()));
+               EBM_ASSERT(0 <= pLeftChild->AFTER_GetSplitGain());
+               EBM_ASSERT(pHeapEnd < aHeap + cHeapMax);
+               *pHeapEnd = pLeftChild->Downgrade();
+               ++pHeapEnd;
+               std::push_heap(aHeap, pHeapEnd, compareNodeGain);
+            }
 
-            EBM_ASSERT(CountBytes(pTreeNodeScratchSpace, pRootTreeNode) <= pBoosterCore->GetCountBytesTreeNodes());
-         } catch(const std::bad_alloc&) {
-            // calling anything inside nodeGainRanking can throw exceptions
-            LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting out of memory exception");
-            return Error_OutOfMemory;
-         } catch(...) {
-            // calling anything inside nodeGainRanking can throw exceptions
-            LOG_0(Trace_Warning, "WARNING PartitionOneDimensionalBoosting exception");
-            return Error_UnexpectedInternal;
-         }
+            auto* const pRightChild = GetRightNode(pTreeNode->AFTER_GetChildren(), cBytesPerTreeNode);
+
+            retFind = FindBestSplitGain<bHessian, cCompilerScores>(pRng,
+                  pBoosterShell,
+                  flags,
+                  pRightChild,
+                  pTreeNodeScratchSpace,
+                  cSamplesLeafMin,
+                  hessianMin,
+                  regAlpha,
+                  regLambda,
+                  deltaStepMax,
+                  direction);
+            // if FindBestSplitGain returned -1 to indicate an
+            // overflow ignore it here. We successfully made a root node split, so we might as well continue
+            // with the successful tree that we have which can make progress in boosting down the residuals
+            if(0 == retFind) {
+               pTreeNodeScratchSpace = IndexTreeNode(pTreeNodeScratchSpace, cBytesPerTreeNode << 1);
+               // our heap comparison function cannot handle NaN gains so we filter out before
+               EBM_ASSERT(!std::isnan(pRightChild->AFTER_GetSplitGain()));
+               EBM_ASSERT(!std::isinf(pRightChild->AFTER_GetSplitGain()));
+               EBM_ASSERT(0 <= pRightChild->AFTER_GetSplitGain());
+               EBM_ASSERT(pHeapEnd < aHeap + cHeapMax);
+               *pHeapEnd = pRightChild->Downgrade();
+               ++pHeapEnd;
+               std::push_heap(aHeap, pHeapEnd, compareNodeGain);
+            }
+
+            --cSplitsRemaining;
+         } while(0 != cSplitsRemaining && UNLIKELY(aHeap != pHeapEnd));
+
+         EBM_ASSERT(!std::isnan(totalGain));
+         EBM_ASSERT(0 <= totalGain);
+
+         EBM_ASSERT(CountBytes(pTreeNodeScratchSpace, pRootTreeNode) <= pBoosterCore->GetCountBytesTreeNodes());
       }
       *pTotalGain = static_cast<double>(totalGain);
       const size_t cSplits = cSplitsMax - cSplitsRemaining;
@@ -167,8 +167,7 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
 
       const size_t cBytesBuffer = EbmMax(cBytesSlicesAndCollapsedTensor, cBytesSlicesPlusRandom);
 
-      // TODO: use GrowThreadByteBuffer2 for this, but first we need to change that to allocate void or bytes
-      char* const pBuffer = static_cast<char*>(malloc(cBytesBuffer));
+      char* const pBuffer = static_cast<char*>(pBoosterShell->GetScratch()->Allocate(cBytesBuffer));
       if(UNLIKELY(nullptr == pBuffer)) {
          LOG_0(Trace_Warning, "WARNING PartitionRandomBoostingInternal nullptr == pBuffer");
          return Error_OutOfMemory;
@@ -464,7 +463,6 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
       error = pInnerTermUpdate->SetCountSlices(iDimensionWrite, cFirstSlices);
       if(UNLIKELY(Error_None != error)) {
          // already logged
-         free(pBuffer);
          return error;
       }
       const size_t* pcBytesInSlice2 = acItemsInNextSliceOrBytesInCurrentSlice;
@@ -502,7 +500,6 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
             error = pInnerTermUpdate->SetCountSlices(iDimensionWrite, pcItemsInNextSliceEnd - pcBytesInSlice2);
             if(Error_None != error) {
                // already logged
-               free(pBuffer);
                return error;
             }
             const size_t* pcItemsInNextSliceLast = pcItemsInNextSliceEnd - size_t{1};
@@ -638,7 +635,6 @@ template<bool bHessian, size_t cCompilerScores> class PartitionRandomBoostingInt
          }
       }
 
-      free(pBuffer);
       *pTotalGain = static_cast<double>(gain);
       return Error_None;
    }
@@ -21,6 +21,7 @@
 #include "bridge.hpp" // k_dynamicScores
 
 #include "RandomDeterministic.hpp" // RandomDeterministic
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -215,6 +216,98 @@ EBM_API_BODY double EBM_CALLING_CONVENTION MeasureImpurity(IntEbm countMultiScor
    return impurityTotal;
 }
 
+extern bool PurifyPairInternal(const size_t cScores,
+      const size_t cBins0,
+      const size_t cBins1,
+      const double* const aWeights,
+      double* const pScores) {
+   // When one of the two dimensions has exactly 2 bins, which is always the case for the updates that
+   // PartitionTwoDimensionalBoosting makes since its first cut divides one dimension in two, the purified tensor
+   // has a closed form.  Call the two bins of that dimension "a" and "b" and index the other dimension by j.
+   // Removing any row and column impurities leaves each column j with a difference e_j between its a and b cells.
+   // The column constraint wa*ga + wb*gb = 0 then fixes ga = wb/(wa+wb)*e_j and gb = -wa/(wa+wb)*e_j, and both row
+   // constraints reduce to sum(h_j * e_j) = 0 where h_j = wa*wb/(wa+wb).  So e_j is the original difference
+   // fa - fb minus its h weighted average.  This gives the same result as PurifyInternal with a zero tolerance
+   // in a single pass.  We return false without modifying the scores if any weight is zero, infinite, or NaN,
+   // or if any score or intermediate value is not finite, and leave those cases to PurifyInternal.
+
+   EBM_ASSERT(1 <= cScores);
+   EBM_ASSERT(2 <= cBins0);
+   EBM_ASSERT(2 <= cBins1);
+   EBM_ASSERT(2 == cBins0 || 2 == cBins1);
+   EBM_ASSERT(nullptr != aWeights);
+   EBM_ASSERT(nullptr != pScores);
+
+   size_t cColumns;
+   size_t iRowStride;
+   size_t iColumnStride;
+   if(size_t{2} == cBins0) {
+      cColumns = cBins1;
+      iRowStride = 1;
+      iColumnStride = 2;
+   } else {
+      cColumns = cBins0;
+      iRowStride = cBins0;
+      iColumnStride = 1;
+   }
+
+   double sumH = 0.0;
+   double sumHDiff = 0.0;
+   size_t iColumn = 0;
+   do {
+      const size_t iBinA = iColumn * iColumnStride;
+      const size_t iBinB = iBinA + iRowStride;
+
+      const double weightA = aWeights[iBinA];
+      const double weightB = aWeights[iBinB];
+      if(!(0.0 < weightA) || std::isinf(weightA) || !(0.0 < weightB) || std::isinf(weightB)) {
+         return false;
+      }
+      const double weightTotal = weightA + weightB;
+      if(std::isinf(weightTotal)) {
+         return false;
+      }
+
+      const double diff = pScores[iBinA * cScores] - pScores[iBinB * cScores];
+      if(std::isnan(diff) || std::isinf(diff)) {
+         return false;
+      }
+
+      // weightB / weightTotal is at most 1, so this cannot overflow
+      const double h = weightA * (weightB / weightTotal);
+      sumH += h;
+      sumHDiff += h * diff;
+
+      ++iColumn;
+   } while(cColumns != iColumn);
+
+   if(!(std::numeric_limits<double>::min() <= sumH) || std::isinf(sumH) || std::isnan(sumHDiff) ||
+         std::isinf(sumHDiff)) {
+      return false;
+   }
+   const double diffAvg = sumHDiff / sumH;
+
+   iColumn = 0;
+   do {
+      const size_t iBinA = iColumn * iColumnStride;
+      const size_t iBinB = iBinA + iRowStride;
+
+      const double weightA = aWeights[iBinA];
+      const double weightB = aWeights[iBinB];
+      const double weightTotal = weightA + weightB;
+
+      double* const pScoreA = &pScores[iBinA * cScores];
+      double* const pScoreB = &pScores[iBinB * cScores];
+      const double diff = *pScoreA - *pScoreB - diffAvg;
+      *pScoreA = weightB / weightTotal * diff;
+      *pScoreB = -(weightA / weightTotal * diff);
+
+      ++iColumn;
+   } while(cColumns != iColumn);
+
+   return true;
+}
+
 extern ErrorEbm PurifyInternal(const double tolerance,
       const size_t cScores,
       const size_t cTensorBins,
@@ -225,7 +318,10 @@ extern ErrorEbm PurifyInternal(const double tolerance,
       const double* const aWeights,
       double* const pScores,
       double* const pImpurities,
-      double* const pIntercept) {
+      double* const pIntercept,
+      const size_t cIterationsMax,
+      size_t* const pcIterationsOut,
+      bool* const pbConvergedOut) {
    EBM_ASSERT(!std::isnan(tolerance));
    EBM_ASSERT(!std::isinf(tolerance));
    EBM_ASSERT(0.0 <= tolerance);
@@ -235,6 +331,15 @@ extern ErrorEbm PurifyInternal(const double tolerance,
    EBM_ASSERT(nullptr != aDimensionLengths);
    EBM_ASSERT(nullptr != aWeights);
    EBM_ASSERT(nullptr != pScores);
+   EBM_ASSERT(1 <= cIterationsMax);
+
+   // tensors that are already pure, or have no surface, are converged without any sweeps
+   if(nullptr != pcIterationsOut) {
+      *pcIterationsOut = 0;
+   }
+   if(nullptr != pbConvergedOut) {
+      *pbConvergedOut = true;
+   }
 
    const size_t cBytesScoreClasses = sizeof(double) * cScores;
    const size_t iScoresEnd = cBytesScoreClasses * cTensorBins;
@@ -422,6 +527,7 @@ extern ErrorEbm PurifyInternal(const double tolerance,
             double impurityPrev;
             double impurityCur = std::numeric_limits<double>::infinity();
             bool bRetry;
+            size_t cIterations = 0;
             do {
                // if any non-infinite value was flipped to an infinite value, it could increase the impurity
                // so we set impurityCur to NaN. We need to reset it to +inf to avoid stopping early
@@ -666,10 +772,19 @@ extern ErrorEbm PurifyInternal(const double tolerance,
                   }
                   ++iRandom;
                } while(cSurfaceBins != iRandom);
+               ++cIterations;
                // this loops on std::isnan(impurityCur)
-            } while(bRetry && !(impurityPrev <= impurityCur));
+            } while(bRetry && !(impurityPrev <= impurityCur) && cIterationsMax != cIterations);
             EBM_ASSERT(!std::isnan(impurityCur));
 
+            if(nullptr != pcIterationsOut) {
+               *pcIterationsOut = cIterations;
+            }
+            if(nullptr != pbConvergedOut) {
+               // we stopped early if another sweep would still have been made
+               *pbConvergedOut = !bRetry || impurityPrev <= impurityCur;
+            }
+
             if(nullptr != pIntercept) {
                double factorPost = 1.0;
 
@@ -1067,13 +1182,22 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
       const double* const aWeights,
       double* const aScoresInOut,
       double* const aImpuritiesOut,
-      double* const aInterceptOut) {
+      double* const aInterceptOut,
+      const size_t cIterationsMax,
+      size_t* const pcIterationsOut,
+      bool* const pbConvergedOut) {
    EBM_ASSERT(1 <= cScores);
    EBM_ASSERT(1 <= cTensorBins);
    EBM_ASSERT(nullptr != pRng || aRandomize == nullptr);
    EBM_ASSERT(nullptr != aDimensionLengths);
    EBM_ASSERT(nullptr != aWeights);
    EBM_ASSERT(nullptr != aScoresInOut);
+   EBM_ASSERT(1 <= cIterationsMax);
+   EBM_ASSERT(nullptr != pcIterationsOut);
+   EBM_ASSERT(nullptr != pbConvergedOut);
+
+   *pcIterationsOut = 0;
+   *pbConvergedOut = true;
 
    const size_t cBytesScoreClasses = sizeof(double) * cScores;
 
@@ -1254,6 +1378,7 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
       const double impuritySumOverflowPreventer = 0.5 / static_cast<double>(cScores * cSurfaceBins);
       double impurityPrev;
       double impurityCur = std::numeric_limits<double>::infinity();
+      size_t cIterations = 0;
       do {
          // if any non-infinite value was flipped to an infinite value, it could increase the impurity
          // so we set impurityCur to NaN. We need to reset it to +inf to avoid stopping early
@@ -1504,10 +1629,15 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
             }
             ++iRandom;
          } while(cSurfaceBins != iRandom);
+         ++cIterations;
          // this loops on std::isnan(impurityCur)
-      } while(!(impurityPrev <= impurityCur));
+      } while(!(impurityPrev <= impurityCur) && cIterationsMax != cIterations);
       EBM_ASSERT(!std::isnan(impurityCur));
 
+      *pcIterationsOut = cIterations;
+      // we stopped early if another sweep would still have been made
+      *pbConvergedOut = impurityPrev <= impurityCur;
+
       if(nullptr != aInterceptOut) {
          pScores = aScoresInOut;
          pImpurities = aImpuritiesOut;
@@ -1666,38 +1796,27 @@ static ErrorEbm PurifyNormalizedMulticlass(const size_t cScores,
    return Error_None;
 }
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
-      BoolEbm isRandomized,
-      BoolEbm isMulticlassNormalization,
-      IntEbm countMultiScores,
-      IntEbm countDimensions,
-      const IntEbm* dimensionLengths,
-      const double* weights,
-      double* scoresInOut,
-      double* impuritiesOut,
-      double* interceptOut) {
-   LOG_N(Trace_Info,
-         "Entered Purify: "
-         "tolerance=%le, "
-         "isRandomized=%s, "
-         "isMulticlassNormalization=%s, "
-         "countMultiScores=%" IntEbmPrintf ", "
-         "countDimensions=%" IntEbmPrintf ", "
-         "dimensionLengths=%p, "
-         "weights=%p, "
-         "scoresInOut=%p, "
-         "impuritiesOut=%p, "
-         "interceptOut=%p",
-         tolerance,
-         ObtainTruth(isRandomized),
-         ObtainTruth(isMulticlassNormalization),
-         countMultiScores,
-         countDimensions,
-         static_cast<const void*>(dimensionLengths),
-         static_cast<const void*>(weights),
-         static_cast<const void*>(scoresInOut),
-         static_cast<const void*>(impuritiesOut),
-         static_cast<const void*>(interceptOut));
+static ErrorEbm PurifyTensor(const double tolerance,
+      const BoolEbm isRandomized,
+      const BoolEbm isMulticlassNormalization,
+      const IntEbm countMultiScores,
+      const IntEbm countDimensions,
+      const IntEbm* const dimensionLengths,
+      const double* const weights,
+      double* const scoresInOut,
+      double* const impuritiesOut,
+      double* const interceptOut,
+      const size_t cIterationsMax,
+      IntEbm* const iterationsOut,
+      BoolEbm* const isConvergedOut) {
+   EBM_ASSERT(1 <= cIterationsMax);
+
+   if(nullptr != iterationsOut) {
+      *iterationsOut = IntEbm{0};
+   }
+   if(nullptr != isConvergedOut) {
+      *isConvergedOut = EBM_TRUE;
+   }
 
    ErrorEbm error;
 
@@ -1862,6 +1981,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
    //   but the caller can get this guarantee by passing NULL for the intercept pointer since we guarantee that the
    //   impurities are non-overflowing
 
+   size_t cIterations = 0;
+   bool bConverged = true;
    if(1 != cScores && EBM_FALSE != isMulticlassNormalization) {
       error = PurifyNormalizedMulticlass(cScores,
             cTensorBins,
@@ -1872,7 +1993,10 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
             weights,
             scoresInOut,
             impuritiesOut,
-            interceptOut);
+            interceptOut,
+            cIterationsMax,
+            &cIterations,
+            &bConverged);
    } else {
       const size_t cBytesScoreClasses = sizeof(double) * cScores;
       if(nullptr != impuritiesOut) {
@@ -1884,6 +2008,9 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
       double* pImpurities = impuritiesOut;
       double* pIntercept = interceptOut;
       do {
+         // each score is purified separately, so report the most sweeps that any score needed
+         size_t cIterationsScore;
+         bool bConvergedScore;
          error = PurifyInternal(tolerance,
                cScores,
                cTensorBins,
@@ -1894,7 +2021,12 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
                weights,
                pScores,
                pImpurities,
-               pIntercept);
+               pIntercept,
+               cIterationsMax,
+               &cIterationsScore,
+               &bConvergedScore);
+         cIterations = cIterations < cIterationsScore ? cIterationsScore : cIterations;
+         bConverged = bConverged && bConvergedScore;
 
          ++pScores;
          if(nullptr != pImpurities) {
@@ -1908,9 +2040,191 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
 
    free(aRandomize);
 
+   if(nullptr != iterationsOut) {
+      *iterationsOut = IsConvertError<IntEbm>(cIterations) ? std::numeric_limits<IntEbm>::max() :
+                                                             static_cast<IntEbm>(cIterations);
+   }
+   if(nullptr != isConvergedOut) {
+      *isConvergedOut = bConverged ? EBM_TRUE : EBM_FALSE;
+   }
+
+   return error;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
+      BoolEbm isRandomized,
+      BoolEbm isMulticlassNormalization,
+      IntEbm countMultiScores,
+      IntEbm countDimensions,
+      const IntEbm* dimensionLengths,
+      const double* weights,
+      double* scoresInOut,
+      double* impuritiesOut,
+      double* interceptOut) {
+   LOG_N(Trace_Info,
+         "Entered Purify: "
+         "tolerance=%le, "
+         "isRandomized=%s, "
+         "isMulticlassNormalization=%s, "
+         "countMultiScores=%" IntEbmPrintf ", "
+         "countDimensions=%" IntEbmPrintf ", "
+         "dimensionLengths=%p, "
+         "weights=%p, "
+         "scoresInOut=%p, "
+         "impuritiesOut=%p, "
+         "interceptOut=%p",
+         tolerance,
+         ObtainTruth(isRandomized),
+         ObtainTruth(isMulticlassNormalization),
+         countMultiScores,
+         countDimensions,
+         static_cast<const void*>(dimensionLengths),
+         static_cast<const void*>(weights),
+         static_cast<const void*>(scoresInOut),
+         static_cast<const void*>(impuritiesOut),
+         static_cast<const void*>(interceptOut));
+
+   const ErrorEbm error = PurifyTensor(tolerance,
+         isRandomized,
+         isMulticlassNormalization,
+         countMultiScores,
+         countDimensions,
+         dimensionLengths,
+         weights,
+         scoresInOut,
+         impuritiesOut,
+         interceptOut,
+         std::numeric_limits<size_t>::max(),
+         nullptr,
+         nullptr);
+
    LOG_0(Trace_Info, "Exited Purify");
 
    return error;
 }
 
+struct PurifyManyContext final {
+   double m_tolerance;
+   BoolEbm m_isRandomized;
+   BoolEbm m_isMulticlassNormalization;
+   IntEbm m_countMultiScores;
+   size_t m_cIterationsMax;
+   const IntEbm* m_aCountDimensions;
+   const IntEbm* const* m_aDimensionLengths;
+   const double* const* m_aWeights;
+   double* const* m_aScores;
+   double* const* m_aImpurities;
+   double* const* m_aIntercepts;
+   IntEbm* m_aIterations;
+   BoolEbm* m_aIsConverged;
+};
+
+static ErrorEbm PurifyManyTask(void* const pContext, const size_t iTensor) {
+   const PurifyManyContext* const p = static_cast<const PurifyManyContext*>(pContext);
+   return PurifyTensor(p->m_tolerance,
+         p->m_isRandomized,
+         p->m_isMulticlassNormalization,
+         p->m_countMultiScores,
+         p->m_aCountDimensions[iTensor],
+         p->m_aDimensionLengths[iTensor],
+         p->m_aWeights[iTensor],
+         p->m_aScores[iTensor],
+         nullptr == p->m_aImpurities ? nullptr : p->m_aImpurities[iTensor],
+         nullptr == p->m_aIntercepts ? nullptr : p->m_aIntercepts[iTensor],
+         p->m_cIterationsMax,
+         nullptr == p->m_aIterations ? nullptr : &p->m_aIterations[iTensor],
+         nullptr == p->m_aIsConverged ? nullptr : &p->m_aIsConverged[iTensor]);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION PurifyMany(double tolerance,
+      BoolEbm isRandomized,
+      BoolEbm isMulticlassNormalization,
+      IntEbm countMultiScores,
+      IntEbm countIterationsMax,
+      IntEbm countTensors,
+      const IntEbm* countDimensions,
+      const IntEbm* const* dimensionLengths,
+      const double* const* weights,
+      double* const* scoresInOut,
+      double* const* impuritiesOut,
+      double* const* interceptOut,
+      IntEbm* iterationsOut,
+      BoolEbm* isConvergedOut) {
+   LOG_N(Trace_Info,
+         "Entered PurifyMany: "
+         "tolerance=%le, "
+         "isRandomized=%s, "
+         "isMulticlassNormalization=%s, "
+         "countMultiScores=%" IntEbmPrintf ", "
+         "countIterationsMax=%" IntEbmPrintf ", "
+         "countTensors=%" IntEbmPrintf ", "
+         "countDimensions=%p, "
+         "dimensionLengths=%p, "
+         "weights=%p, "
+         "scoresInOut=%p, "
+         "impuritiesOut=%p, "
+         "interceptOut=%p, "
+         "iterationsOut=%p, "
+         "isConvergedOut=%p",
+         tolerance,
+         ObtainTruth(isRandomized),
+         ObtainTruth(isMulticlassNormalization),
+         countMultiScores,
+         countIterationsMax,
+         countTensors,
+         static_cast<const void*>(countDimensions),
+         static_cast<const void*>(dimensionLengths),
+         static_cast<const void*>(weights),
+         static_cast<const void*>(scoresInOut),
+         static_cast<const void*>(impuritiesOut),
+         static_cast<const void*>(interceptOut),
+         static_cast<const void*>(iterationsOut),
+         static_cast<const void*>(isConvergedOut));
+
+   if(countIterationsMax < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR PurifyMany countIterationsMax cannot be negative");
+      return Error_IllegalParamVal;
+   }
+   // zero means sweep until the tolerance is met or the purity stops improving, like Purify does
+   size_t cIterationsMax = std::numeric_limits<size_t>::max();
+   if(IntEbm{0} != countIterationsMax && !IsConvertError<size_t>(countIterationsMax)) {
+      cIterationsMax = static_cast<size_t>(countIterationsMax);
+   }
+
+   if(IsConvertError<size_t>(countTensors)) {
+      LOG_0(Trace_Error, "ERROR PurifyMany countTensors is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTensors = static_cast<size_t>(countTensors);
+   if(size_t{0} == cTensors) {
+      LOG_0(Trace_Info, "INFO PurifyMany zero tensors");
+      return Error_None;
+   }
+   if(nullptr == countDimensions || nullptr == dimensionLengths || nullptr == weights || nullptr == scoresInOut) {
+      LOG_0(Trace_Error, "ERROR PurifyMany the per-tensor arrays cannot be nullptr");
+      return Error_IllegalParamVal;
+   }
+
+   PurifyManyContext context;
+   context.m_tolerance = tolerance;
+   context.m_isRandomized = isRandomized;
+   context.m_isMulticlassNormalization = isMulticlassNormalization;
+   context.m_countMultiScores = countMultiScores;
+   context.m_cIterationsMax = cIterationsMax;
+   context.m_aCountDimensions = countDimensions;
+   context.m_aDimensionLengths = dimensionLengths;
+   context.m_aWeights = weights;
+   context.m_aScores = scoresInOut;
+   context.m_aImpurities = impuritiesOut;
+   context.m_aIntercepts = interceptOut;
+   context.m_aIterations = iterationsOut;
+   context.m_aIsConverged = isConvergedOut;
+
+   const ErrorEbm error = ParallelFor(cTensors, PurifyManyTask, &context);
+
+   LOG_0(Trace_Info, "Exited PurifyMany");
+
+   return error;
+}
+
 } // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,229 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef RANDOM_COUNTER_HPP
+#define RANDOM_COUNTER_HPP
+
+#include <inttypes.h> // uint64_t, uint_fast64_t, uint32_t, uint_fast32_t
+#include <stddef.h> // size_t, ptrdiff_t
+#include <type_traits>
+
+#include "libebm.h" // SeedEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS, COUNT_BITS
+
+#include "common.hpp" // MakeLowMask
+#include "RandomDeterministic.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+class RandomCounter final {
+   // RandomDeterministic is sequential, so the Nth random number can only be reached by generating the N-1 before it.
+   // RandomCounter is the counter based Philox4x32-10 generator from "Parallel Random Numbers: As Easy as 1, 2, 3"
+   // (Salmon et al. 2011).  Each block of 4 random 32 bit numbers is a pure function of the key and a 128 bit
+   // counter, so any thread can Seek directly to the position it needs.  We split the counter into a 64 bit stream
+   // and a 64 bit position within that stream.  Parallel work that gives item i its own stream i gets identical
+   // results no matter how the items are divided between threads.
+   //
+   // The interface matches RandomDeterministic, so templated consumers like GaussianDistribution accept either.
+   // Like RandomDeterministic, copy it to the stack before using it inside a hotspot loop.
+
+   static constexpr uint32_t k_multiplier0 = 0xD2511F53;
+   static constexpr uint32_t k_multiplier1 = 0xCD9E8D57;
+   static constexpr uint32_t k_weyl0 = 0x9E3779B9;
+   static constexpr uint32_t k_weyl1 = 0xBB67AE85;
+   static constexpr int k_cRounds = 10;
+   static constexpr size_t k_cBlockItems = 4;
+
+   uint32_t m_key[2];
+   uint32_t m_counter[k_cBlockItems];
+   uint32_t m_block[k_cBlockItems];
+   size_t m_iBlock;
+
+   INLINE_ALWAYS void GenerateBlock() {
+      uint_fast32_t key0 = m_key[0];
+      uint_fast32_t key1 = m_key[1];
+      uint_fast32_t c0 = m_counter[0];
+      uint_fast32_t c1 = m_counter[1];
+      uint_fast32_t c2 = m_counter[2];
+      uint_fast32_t c3 = m_counter[3];
+      for(int iRound = 0; iRound < k_cRounds; ++iRound) {
+         const uint_fast64_t product0 = uint_fast64_t{k_multiplier0} * static_cast<uint_fast64_t>(c0);
+         const uint_fast64_t product1 = uint_fast64_t{k_multiplier1} * static_cast<uint_fast64_t>(c2);
+         c0 = static_cast<uint_fast32_t>(static_cast<uint32_t>(product1 >> 32)) ^ c1 ^ key0;
+         c1 = static_cast<uint_fast32_t>(static_cast<uint32_t>(product1));
+         c2 = static_cast<uint_fast32_t>(static_cast<uint32_t>(product0 >> 32)) ^ c3 ^ key1;
+         c3 = static_cast<uint_fast32_t>(static_cast<uint32_t>(product0));
+         key0 = static_cast<uint_fast32_t>(static_cast<uint32_t>(key0 + k_weyl0));
+         key1 = static_cast<uint_fast32_t>(static_cast<uint32_t>(key1 + k_weyl1));
+      }
+      m_block[0] = static_cast<uint32_t>(c0);
+      m_block[1] = static_cast<uint32_t>(c1);
+      m_block[2] = static_cast<uint32_t>(c2);
+      m_block[3] = static_cast<uint32_t>(c3);
+   }
+
+   INLINE_ALWAYS uint_fast32_t Rand32() {
+      if(UNLIKELY(k_cBlockItems == m_iBlock)) {
+         // the position is the low 64 bits of the counter.  Overflowing it would take 2^66 random numbers
+         ++m_counter[0];
+         if(UNLIKELY(0 == m_counter[0])) {
+            ++m_counter[1];
+         }
+         GenerateBlock();
+         m_iBlock = 0;
+      }
+      const uint_fast32_t rand = m_block[m_iBlock];
+      ++m_iBlock;
+      return rand;
+   }
+
+ public:
+   RandomCounter() = default; // preserve our POD status
+   ~RandomCounter() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   INLINE_ALWAYS void Initialize(const uint64_t key) {
+      m_key[0] = static_cast<uint32_t>(key);
+      m_key[1] = static_cast<uint32_t>(key >> 32);
+      Seek(0, 0);
+   }
+
+   INLINE_ALWAYS void Initialize(RandomDeterministic& rng) {
+      // consume one number from rng to make the key, the same way BranchRNG seeds a new RandomDeterministic
+      Initialize(rng.Next(std::numeric_limits<uint64_t>::max()));
+   }
+
+   INLINE_ALWAYS void Initialize(const RandomCounter& other) {
+      m_key[0] = other.m_key[0];
+      m_key[1] = other.m_key[1];
+      m_counter[0] = other.m_counter[0];
+      m_counter[1] = other.m_counter[1];
+      m_counter[2] = other.m_counter[2];
+      m_counter[3] = other.m_counter[3];
+      m_block[0] = other.m_block[0];
+      m_block[1] = other.m_block[1];
+      m_block[2] = other.m_block[2];
+      m_block[3] = other.m_block[3];
+      m_iBlock = other.m_iBlock;
+   }
+
+   // iPosition counts 32 bit random numbers from the start of the stream
+   INLINE_ALWAYS void Seek(const uint64_t iStream, const uint64_t iPosition) {
+      const uint64_t iCounter = iPosition / k_cBlockItems;
+      m_counter[0] = static_cast<uint32_t>(iCounter);
+      m_counter[1] = static_cast<uint32_t>(iCounter >> 32);
+      m_counter[2] = static_cast<uint32_t>(iStream);
+      m_counter[3] = static_cast<uint32_t>(iStream >> 32);
+      GenerateBlock();
+      m_iBlock = static_cast<size_t>(iPosition % k_cBlockItems);
+   }
+
+   template<typename T>
+   INLINE_ALWAYS typename std::enable_if<std::is_unsigned<T>::value &&
+               std::numeric_limits<uint32_t>::max() < std::numeric_limits<T>::max(),
+         T>::type
+   NextFast(const T maxPlusOne) {
+      EBM_ASSERT(T{1} <= maxPlusOne);
+
+      // see RandomDeterministic::NextFast for a description of how we reject the unbalanced top of the range
+      if(T{std::numeric_limits<uint32_t>::max()} < maxPlusOne) {
+         const T max = maxPlusOne - T{1};
+         T rand;
+         T randMult;
+         do {
+            T maxContent = T{std::numeric_limits<uint32_t>::max()};
+            rand = static_cast<T>(Rand32());
+            while(maxContent < max) {
+               maxContent = (maxContent << 32) | T{std::numeric_limits<uint32_t>::max()};
+               rand = (rand << 32) | static_cast<T>(Rand32());
+            }
+            const T randDivided = rand / maxPlusOne;
+            randMult = randDivided * maxPlusOne;
+         } while(UNLIKELY(T{0} - maxPlusOne < randMult));
+         EBM_ASSERT(randMult <= rand);
+         return rand - randMult;
+      } else {
+         return static_cast<T>(NextFast(static_cast<uint32_t>(maxPlusOne)));
+      }
+   }
+
+   template<typename T>
+   INLINE_ALWAYS typename std::enable_if<std::is_unsigned<T>::value &&
+               std::numeric_limits<T>::max() <= std::numeric_limits<uint32_t>::max(),
+         T>::type
+   NextFast(const T maxPlusOne) {
+      EBM_ASSERT(T{1} <= maxPlusOne);
+
+      const uint32_t maxPlusOneConverted = static_cast<uint32_t>(maxPlusOne);
+      uint32_t rand;
+      uint32_t randMult;
+      do {
+         rand = static_cast<uint32_t>(Rand32());
+         const uint32_t randDivided = rand / maxPlusOneConverted;
+         randMult = randDivided * maxPlusOneConverted;
+      } while(UNLIKELY(uint32_t{0} - maxPlusOneConverted < randMult));
+      EBM_ASSERT(randMult <= rand);
+      return static_cast<T>(rand - randMult);
+   }
+
+   template<typename T>
+   INLINE_ALWAYS typename std::enable_if<std::is_unsigned<T>::value &&
+               std::numeric_limits<uint32_t>::max() < std::numeric_limits<T>::max(),
+         T>::type
+   Next(const T max) {
+      if(std::numeric_limits<T>::max() == max) {
+         static constexpr int k_bitsT = COUNT_BITS(T);
+         static_assert(MakeLowMask<T>(k_bitsT) == std::numeric_limits<T>::max(), "T max must be all 1s");
+         int count = (k_bitsT + 31) / 32 - 1;
+         EBM_ASSERT(1 <= count);
+         T rand = static_cast<T>(Rand32());
+         do {
+            rand = (rand << 32) | static_cast<T>(Rand32());
+            --count;
+         } while(0 != count);
+         return rand;
+      }
+      return NextFast(max + T{1});
+   }
+
+   template<typename T>
+   INLINE_ALWAYS typename std::enable_if<std::is_unsigned<T>::value &&
+               std::numeric_limits<T>::max() <= std::numeric_limits<uint32_t>::max(),
+         T>::type
+   Next(const T max) {
+      if(std::numeric_limits<T>::max() == max) {
+         return static_cast<T>(Rand32());
+      }
+      return NextFast(max + T{1});
+   }
+
+   template<typename T>
+   INLINE_ALWAYS typename std::enable_if<std::is_unsigned<T>::value && !std::is_same<T, bool>::value, T>::type Next() {
+      return Next(std::numeric_limits<T>::max());
+   }
+
+   template<typename T> INLINE_ALWAYS typename std::enable_if<std::is_signed<T>::value, T>::type Next() {
+      static_assert(is_twos_complement<T>::value, "we only support twos complement negative numbers");
+
+      return TwosComplementConvert(Next<typename std::make_unsigned<T>::type>());
+   }
+
+   template<typename T> INLINE_ALWAYS typename std::enable_if<std::is_same<T, bool>::value, T>::type Next() {
+      return uint_fast32_t{0} != (uint_fast32_t{1} & Rand32());
+   }
+};
+static_assert(std::is_standard_layout<RandomCounter>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<RandomCounter>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+static_assert(std::is_pod<RandomCounter>::value, "We use a lot of C constructs, so disallow non-POD types in general");
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // RANDOM_COUNTER_HPP
@@ -0,0 +1,174 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uintptr_t
+#include <limits> // numeric_limits
+
+#ifdef __linux__
+#include <sys/mman.h> // madvise
+#endif // __linux__
+
+#include "libebm.h"
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // AlignedAlloc
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsAddError
+#include "ScratchArena.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+static int g_cLogAdviseHugePages = 10;
+
+extern void AdviseHugePages(void* const p, const size_t cBytes) noexcept {
+   if(nullptr == p) {
+      return;
+   }
+   // transparent huge pages are 2MB on x64 and on 4K page arm64 kernels.  Smaller allocations contain no whole huge
+   // page, which is fine since their TLB misses are not what we are trying to avoid
+   static constexpr uintptr_t k_cBytesHugePage = uintptr_t{2} * 1024 * 1024;
+   const uintptr_t mask = k_cBytesHugePage - 1;
+   const uintptr_t start = (reinterpret_cast<uintptr_t>(p) + mask) & ~mask;
+   const uintptr_t end = (reinterpret_cast<uintptr_t>(p) + cBytes) & ~mask;
+   if(end <= start) {
+      return;
+   }
+   if(0 != madvise(reinterpret_cast<void*>(start), static_cast<size_t>(end - start), MADV_HUGEPAGE)) {
+      LOG_COUNTED_0(&g_cLogAdviseHugePages, Trace_Info, Trace_Verbose, "AdviseHugePages madvise failed");
+   }
+}
+#else // __linux__ && MADV_HUGEPAGE
+extern void AdviseHugePages(void* const p, const size_t cBytes) noexcept {
+   UNUSED(p);
+   UNUSED(cBytes);
+}
+#endif // __linux__ && MADV_HUGEPAGE
+
+struct ScratchBlock final {
+   ScratchBlock* m_pPrev;
+   size_t m_cBytes; // excludes the header
+};
+
+// keep the data that follows the header aligned for SIMD
+static constexpr size_t k_cBytesBlockHeader =
+      (sizeof(ScratchBlock) + SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+
+// big enough for the split heap of a few thousand bins and the purification weights of any pair
+static constexpr size_t k_cBytesBlockMin = size_t{64} * 1024;
+
+static ScratchBlock* AllocateBlock(const size_t cBytes, const bool bHugePages) {
+   EBM_ASSERT(0 != cBytes);
+   if(IsAddError(k_cBytesBlockHeader, cBytes)) {
+      return nullptr;
+   }
+   void* const p = AlignedAlloc(k_cBytesBlockHeader + cBytes);
+   if(nullptr == p) {
+      return nullptr;
+   }
+   if(bHugePages) {
+      AdviseHugePages(p, k_cBytesBlockHeader + cBytes);
+   }
+   ScratchBlock* const pBlock = static_cast<ScratchBlock*>(p);
+   pBlock->m_pPrev = nullptr;
+   pBlock->m_cBytes = cBytes;
+   return pBlock;
+}
+
+static unsigned char* GetBlockData(ScratchBlock* const pBlock) {
+   return reinterpret_cast<unsigned char*>(pBlock) + k_cBytesBlockHeader;
+}
+
+void* ScratchArena::Allocate(const size_t cBytes) {
+   EBM_ASSERT(0 != cBytes);
+
+   if(IsAddError(cBytes, size_t{SIMD_BYTE_ALIGNMENT - 1})) {
+      LOG_0(Trace_Warning, "WARNING ScratchArena::Allocate IsAddError(cBytes, SIMD_BYTE_ALIGNMENT - 1)");
+      return nullptr;
+   }
+   const size_t cBytesAligned = (cBytes + SIMD_BYTE_ALIGNMENT - 1) / SIMD_BYTE_ALIGNMENT * SIMD_BYTE_ALIGNMENT;
+
+   if(static_cast<size_t>(m_pEnd - m_pNext) < cBytesAligned) {
+      // double the blocks so that a step which keeps asking needs few of them before Reset merges them
+      size_t cBytesBlock = EbmMax(k_cBytesBlockMin, cBytesAligned);
+      if(nullptr != m_pBlock && m_pBlock->m_cBytes <= std::numeric_limits<size_t>::max() / 2) {
+         cBytesBlock = EbmMax(cBytesBlock, m_pBlock->m_cBytes * 2);
+      }
+      ScratchBlock* const pBlock = AllocateBlock(cBytesBlock, m_bHugePages);
+      if(nullptr == pBlock) {
+         LOG_0(Trace_Warning, "WARNING ScratchArena::Allocate nullptr == pBlock");
+         return nullptr;
+      }
+      pBlock->m_pPrev = m_pBlock;
+      m_pBlock = pBlock;
+      m_pNext = GetBlockData(pBlock);
+      m_pEnd = m_pNext + cBytesBlock;
+      m_cBytesReserved += cBytesBlock;
+      ++m_cBlocks;
+   }
+
+   void* const p = m_pNext;
+   m_pNext += cBytesAligned;
+   m_cBytesUsed += cBytesAligned;
+   m_cBytesPeak = EbmMax(m_cBytesPeak, m_cBytesUsed);
+   return p;
+}
+
+void ScratchArena::Reset() {
+   m_cBytesUsed = 0;
+   if(nullptr == m_pBlock) {
+      return;
+   }
+   if(nullptr != m_pBlock->m_pPrev) {
+      // the step overflowed its first block, so trade all of them for one block that holds what they held together
+      const size_t cBytesBlock = m_cBytesReserved;
+      Free();
+      ScratchBlock* const pBlock = AllocateBlock(cBytesBlock, m_bHugePages);
+      if(nullptr == pBlock) {
+         // the next Allocate starts over with a small block
+         return;
+      }
+      m_pBlock = pBlock;
+      m_pEnd = GetBlockData(pBlock) + cBytesBlock;
+      m_cBytesReserved = cBytesBlock;
+      ++m_cBlocks;
+   }
+   m_pNext = GetBlockData(m_pBlock);
+}
+
+void ScratchArena::Free() {
+   ScratchBlock* pBlock = m_pBlock;
+   while(nullptr != pBlock) {
+      ScratchBlock* const pPrev = pBlock->m_pPrev;
+      AlignedFree(pBlock);
+      pBlock = pPrev;
+   }
+   m_pBlock = nullptr;
+   m_pNext = nullptr;
+   m_pEnd = nullptr;
+   m_cBytesUsed = 0;
+   m_cBytesReserved = 0;
+}
+
+void ScratchArena::FillStats(const bool bReset, UIntEbm* const aScratchStatsOut) {
+   if(nullptr != aScratchStatsOut) {
+      aScratchStatsOut[ScratchStat_PeakBytes] = static_cast<UIntEbm>(m_cBytesPeak);
+      aScratchStatsOut[ScratchStat_ReservedBytes] = static_cast<UIntEbm>(m_cBytesReserved);
+      aScratchStatsOut[ScratchStat_Blocks] = static_cast<UIntEbm>(m_cBlocks);
+   }
+   if(bReset) {
+      m_cBytesPeak = m_cBytesUsed;
+      m_cBlocks = 0;
+   }
+}
+
+} // namespace DEFINED_ZONE_NAME
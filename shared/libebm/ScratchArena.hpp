@@ -0,0 +1,71 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef SCRATCH_ARENA_HPP
+#define SCRATCH_ARENA_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <type_traits> // std::is_standard_layout
+
+#include "libebm.h" // UIntEbm
+#include "unzoned.h"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// AdviseHugePages asks the OS to back the whole huge pages inside an allocation with transparent huge pages.  Like
+// BindNumaNode it is a hint that does nothing on platforms without them.
+extern void AdviseHugePages(void* const p, const size_t cBytes) noexcept;
+
+struct ScratchBlock;
+
+// A bump allocator for the memory that one boosting step needs only until it returns.  Allocations are never freed
+// one at a time.  Reset hands everything back at once, and when the step overflowed into more blocks it replaces
+// them with one block big enough for all of them, so once the steps have seen their largest term no step allocates.
+struct ScratchArena final {
+   ScratchArena() = default; // preserve our POD status
+   ~ScratchArena() = default; // preserve our POD status
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   inline void InitializeUnfailing(const bool bHugePages) {
+      m_pBlock = nullptr;
+      m_pNext = nullptr;
+      m_pEnd = nullptr;
+      m_cBytesUsed = 0;
+      m_cBytesPeak = 0;
+      m_cBytesReserved = 0;
+      m_cBlocks = 0;
+      m_bHugePages = bHugePages;
+   }
+
+   // returns SIMD_BYTE_ALIGNMENT aligned memory that stays valid until the next Reset, or nullptr when out of memory
+   void* Allocate(const size_t cBytes);
+   void Reset();
+   void Free();
+
+   // fills ScratchStat_COUNT items
+   void FillStats(const bool bReset, UIntEbm* const aScratchStatsOut);
+
+ private:
+   ScratchBlock* m_pBlock; // the block being filled, which links back to the blocks filled earlier in the step
+   unsigned char* m_pNext;
+   unsigned char* m_pEnd;
+   size_t m_cBytesUsed; // bytes handed out since the last Reset
+   size_t m_cBytesPeak;
+   size_t m_cBytesReserved;
+   uint64_t m_cBlocks; // blocks allocated since the stats were last reset
+   bool m_bHugePages;
+};
+static_assert(std::is_standard_layout<ScratchArena>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<ScratchArena>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // SCRATCH_ARENA_HPP
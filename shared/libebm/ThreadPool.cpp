@@ -0,0 +1,755 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // FILE, fopen, fgets, fclose
+#include <stdlib.h> // strtol
+#include <atomic> // std::atomic
+#include <thread> // std::thread
+#include <mutex> // std::mutex, std::unique_lock
+#include <condition_variable> // std::condition_variable
+#include <new> // placement new
+
+#ifndef _WIN32
+#include <pthread.h> // pthread_atfork, pthread_setaffinity_np
+#endif // _WIN32
+
+#ifdef __linux__
+#include <sched.h> // sched_getaffinity, cpu_set_t
+#include <unistd.h> // syscall, sysconf
+#include <sys/syscall.h> // SYS_mbind
+#endif // __linux__
+
+#include "libebm.h"
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // LIKELY
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+#include "ThreadPool.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+static constexpr size_t k_cThreadsMax = 256;
+// same as CPU_SETSIZE on Linux
+static constexpr size_t k_cCpusMax = 1024;
+
+// Tasks are dealt out in k_cNumaNodesMax stripes where stripe iStripe holds tasks iStripe, iStripe + cStripes, ...
+// Each worker drains the stripe of its own NUMA node before helping with the others, so task iTask lands on node
+// iTask % cStripes whenever that node has idle workers.  Without ThreadPoolFlags_SpreadNodes there is one stripe.
+struct ParallelForState final {
+   std::atomic<size_t> m_aiStripeNext[k_cNumaNodesMax];
+   std::atomic<ErrorEbm> m_error;
+   size_t m_cStripes;
+   size_t m_cTasks;
+   ParallelTask m_task;
+   void* m_pContext;
+};
+
+// The pool is serial until SetThreadPool or SetParallelForCallback is called, so by default libebm never starts a
+// thread.  Hosts like joblib that already run one process per core would otherwise be oversubscribed.  Once
+// configured, the workers start on the first ParallelFor that has more than one task.  They are joined when the
+// configuration changes and when the library is unloaded, and a forked child starts over with no workers.
+struct ThreadPoolState final {
+   // held by the thread that is dispatching work so that only one ParallelFor uses the workers at a time
+   std::mutex m_mutexDispatch;
+
+   std::mutex m_mutexWork;
+   std::condition_variable m_cvWork;
+   std::condition_variable m_cvDone;
+   ParallelForState* m_pState;
+   size_t m_iJob;
+   size_t m_cWorkersAlive;
+   size_t m_cWorkersBusy;
+   bool m_bStop;
+
+   // the workers we started, which m_mutexDispatch protects
+   size_t m_cThreads;
+   std::thread m_aThreads[k_cThreadsMax];
+
+   // true once SetThreadPool asked for more than one thread or a host took over the dispatch.  Read without the
+   // lock by ParallelFor to stay serial by default
+   std::atomic<bool> m_bParallel;
+
+   // configuration, which is only changed while holding m_mutexDispatch with no workers alive
+   bool m_bConfigured;
+   bool m_bWorkersStarted;
+   size_t m_cThreadsRequested;
+   ThreadPoolFlags m_flags;
+   IntEbm m_numaNode;
+
+   // the cpus we may run on grouped by NUMA node.  With ThreadPoolFlags_SpreadNodes there is one group per node that
+   // has allowed cpus, otherwise there is at most one group
+   size_t m_cCpus;
+   int m_aCpus[k_cCpusMax];
+   size_t m_cNodes;
+   int m_aNodes[k_cNumaNodesMax];
+   size_t m_aiNodeCpuFirst[k_cNumaNodesMax];
+   size_t m_acNodeCpus[k_cNumaNodesMax];
+
+   ParallelForFunction m_parallelFor;
+   void* m_parallelForContext;
+};
+
+// workers are always inside a ParallelFor, and so is the calling thread while it dispatches.  Any ParallelFor
+// started from there runs inline since the workers are already taken.
+static thread_local bool g_bInsideParallelFor = false;
+
+// set once the pool exists, so that the fork handlers and the unload cleanup do not create it
+static std::atomic<bool> g_bThreadPoolCreated{false};
+
+#ifndef _WIN32
+static void ForkPrepare() noexcept;
+static void ForkParent() noexcept;
+static void ForkChild() noexcept;
+#endif // _WIN32
+
+static ThreadPoolState* GetThreadPool() noexcept {
+   alignas(ThreadPoolState) static unsigned char s_storage[sizeof(ThreadPoolState)];
+   // function local static initialization is thread safe, and keeping a pointer means no destructor runs at exit
+   static ThreadPoolState* const s_pPool = [] {
+      ThreadPoolState* const pPool = new(s_storage) ThreadPoolState();
+      pPool->m_pState = nullptr;
+      pPool->m_iJob = 0;
+      pPool->m_cWorkersAlive = 0;
+      pPool->m_cWorkersBusy = 0;
+      pPool->m_bStop = false;
+      pPool->m_cThreads = 0;
+      pPool->m_bParallel.store(false, std::memory_order_relaxed);
+      pPool->m_bConfigured = false;
+      pPool->m_bWorkersStarted = false;
+      pPool->m_cThreadsRequested = 0;
+      pPool->m_flags = ThreadPoolFlags_Default;
+      pPool->m_numaNode = -1;
+      pPool->m_cCpus = 0;
+      pPool->m_cNodes = 0;
+      pPool->m_parallelFor = nullptr;
+      pPool->m_parallelForContext = nullptr;
+#ifndef _WIN32
+      // glibc drops handlers that a shared library registered when the library is unloaded
+      if(0 != pthread_atfork(ForkPrepare, ForkParent, ForkChild)) {
+         LOG_0(Trace_Warning, "WARNING GetThreadPool pthread_atfork failed");
+      }
+#endif // _WIN32
+      g_bThreadPoolCreated.store(true, std::memory_order_release);
+      return pPool;
+   }();
+   return s_pPool;
+}
+
+static void InitParallelForState(ParallelForState* const pState,
+      const size_t cStripes,
+      const size_t cTasks,
+      const ParallelTask task,
+      void* const pContext) noexcept {
+   EBM_ASSERT(1 <= cStripes && cStripes <= k_cNumaNodesMax);
+   for(size_t iStripe = 0; iStripe < cStripes; ++iStripe) {
+      pState->m_aiStripeNext[iStripe].store(size_t{0}, std::memory_order_relaxed);
+   }
+   pState->m_error.store(Error_None, std::memory_order_relaxed);
+   pState->m_cStripes = cStripes;
+   pState->m_cTasks = cTasks;
+   pState->m_task = task;
+   pState->m_pContext = pContext;
+}
+
+static void RunParallelTasks(ParallelForState* const pState, const size_t iStripeHome) noexcept {
+   const size_t cStripes = pState->m_cStripes;
+   EBM_ASSERT(iStripeHome < cStripes);
+   for(size_t iStripeOffset = 0; iStripeOffset < cStripes; ++iStripeOffset) {
+      size_t iStripe = iStripeHome + iStripeOffset;
+      iStripe = cStripes <= iStripe ? iStripe - cStripes : iStripe;
+      while(true) {
+         if(UNLIKELY(Error_None != pState->m_error.load(std::memory_order_relaxed))) {
+            return;
+         }
+         if(pState->m_cTasks <= iStripe) {
+            break;
+         }
+         const size_t iStripeTask = pState->m_aiStripeNext[iStripe].fetch_add(size_t{1}, std::memory_order_relaxed);
+         // the tasks in a stripe are iStripe + iStripeTask * cStripes, and checking before multiplying avoids overflow
+         if((pState->m_cTasks - iStripe + cStripes - 1) / cStripes <= iStripeTask) {
+            break;
+         }
+         const size_t iTask = iStripe + iStripeTask * cStripes;
+         EBM_ASSERT(iTask < pState->m_cTasks);
+         const ErrorEbm error = pState->m_task(pState->m_pContext, iTask);
+         if(UNLIKELY(Error_None != error)) {
+            ErrorEbm errorNone = Error_None;
+            pState->m_error.compare_exchange_strong(errorNone, error);
+            return;
+         }
+      }
+   }
+}
+
+#ifdef __linux__
+static size_t ReadNodeCpus(
+      const size_t iNode, const cpu_set_t* const pAllowed, int* const aCpus, const size_t cCpusMax) noexcept {
+   char path[64];
+   snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", iNode);
+   FILE* const pFile = fopen(path, "r");
+   if(nullptr == pFile) {
+      return 0;
+   }
+   char line[4096];
+   const char* pLine = fgets(line, sizeof(line), pFile);
+   fclose(pFile);
+   if(nullptr == pLine) {
+      return 0;
+   }
+
+   size_t cCpus = 0;
+   // the cpulist format is comma separated ranges like "0-15,32-47"
+   while(true) {
+      char* pEnd;
+      const long iFirst = strtol(pLine, &pEnd, 10);
+      if(pEnd == pLine) {
+         break;
+      }
+      long iLast = iFirst;
+      pLine = pEnd;
+      if('-' == *pLine) {
+         ++pLine;
+         iLast = strtol(pLine, &pEnd, 10);
+         if(pEnd == pLine) {
+            break;
+         }
+         pLine = pEnd;
+      }
+      for(long iCpu = iFirst; iCpu <= iLast && iCpu < static_cast<long>(CPU_SETSIZE) && cCpus < cCpusMax; ++iCpu) {
+         if(0 <= iCpu && CPU_ISSET(static_cast<int>(iCpu), pAllowed)) {
+            aCpus[cCpus] = static_cast<int>(iCpu);
+            ++cCpus;
+         }
+      }
+      if(',' != *pLine) {
+         break;
+      }
+      ++pLine;
+   }
+   return cCpus;
+}
+
+// requires m_mutexDispatch
+static void LoadTopology(ThreadPoolState* const pPool) noexcept {
+   pPool->m_cCpus = 0;
+   pPool->m_cNodes = 0;
+
+   cpu_set_t allowed;
+   CPU_ZERO(&allowed);
+   if(0 != sched_getaffinity(0, sizeof(allowed), &allowed)) {
+      LOG_0(Trace_Warning, "WARNING LoadTopology sched_getaffinity failed");
+      return;
+   }
+
+   if(IntEbm{0} <= pPool->m_numaNode) {
+      if(static_cast<IntEbm>(k_cNumaNodesMax) <= pPool->m_numaNode) {
+         LOG_0(Trace_Warning, "WARNING LoadTopology numaNode too large");
+         return;
+      }
+      const size_t iNode = static_cast<size_t>(pPool->m_numaNode);
+      const size_t cCpus = ReadNodeCpus(iNode, &allowed, pPool->m_aCpus, k_cCpusMax);
+      if(size_t{0} == cCpus) {
+         LOG_N(Trace_Warning, "WARNING LoadTopology NUMA node %zu has no cpus that we are allowed to use", iNode);
+         return;
+      }
+      pPool->m_cCpus = cCpus;
+      pPool->m_cNodes = 1;
+      pPool->m_aNodes[0] = static_cast<int>(iNode);
+      pPool->m_aiNodeCpuFirst[0] = 0;
+      pPool->m_acNodeCpus[0] = cCpus;
+   } else if(0 != (ThreadPoolFlags_SpreadNodes & pPool->m_flags)) {
+      for(size_t iNode = 0; iNode < k_cNumaNodesMax; ++iNode) {
+         const size_t cCpus =
+               ReadNodeCpus(iNode, &allowed, &pPool->m_aCpus[pPool->m_cCpus], k_cCpusMax - pPool->m_cCpus);
+         if(size_t{0} != cCpus) {
+            pPool->m_aNodes[pPool->m_cNodes] = static_cast<int>(iNode);
+            pPool->m_aiNodeCpuFirst[pPool->m_cNodes] = pPool->m_cCpus;
+            pPool->m_acNodeCpus[pPool->m_cNodes] = cCpus;
+            ++pPool->m_cNodes;
+            pPool->m_cCpus += cCpus;
+         }
+      }
+      if(size_t{0} == pPool->m_cNodes) {
+         LOG_0(Trace_Warning, "WARNING LoadTopology no NUMA nodes found");
+      }
+   } else if(0 != (ThreadPoolFlags_PinCores & pPool->m_flags)) {
+      for(int iCpu = 0; iCpu < static_cast<int>(CPU_SETSIZE) && pPool->m_cCpus < k_cCpusMax; ++iCpu) {
+         if(CPU_ISSET(iCpu, &allowed)) {
+            pPool->m_aCpus[pPool->m_cCpus] = iCpu;
+            ++pPool->m_cCpus;
+         }
+      }
+      pPool->m_cNodes = 1;
+      pPool->m_aNodes[0] = -1;
+      pPool->m_aiNodeCpuFirst[0] = 0;
+      pPool->m_acNodeCpus[0] = pPool->m_cCpus;
+   }
+}
+
+static void PinThread(const ThreadPoolState* const pPool, const size_t iThread) noexcept {
+   if(size_t{0} == pPool->m_cCpus) {
+      return;
+   }
+   EBM_ASSERT(1 <= pPool->m_cNodes);
+   // workers alternate between the nodes so that any thread count is spread as evenly as possible
+   const size_t iNode = iThread % pPool->m_cNodes;
+   const size_t iCpuFirst = pPool->m_aiNodeCpuFirst[iNode];
+   const size_t cNodeCpus = pPool->m_acNodeCpus[iNode];
+
+   cpu_set_t cpus;
+   CPU_ZERO(&cpus);
+   if(0 != (ThreadPoolFlags_PinCores & pPool->m_flags)) {
+      CPU_SET(pPool->m_aCpus[iCpuFirst + iThread / pPool->m_cNodes % cNodeCpus], &cpus);
+   } else {
+      for(size_t iCpu = iCpuFirst; iCpu < iCpuFirst + cNodeCpus; ++iCpu) {
+         CPU_SET(pPool->m_aCpus[iCpu], &cpus);
+      }
+   }
+   if(0 != pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus)) {
+      LOG_0(Trace_Warning, "WARNING PinThread pthread_setaffinity_np failed");
+   }
+}
+
+static int g_cLogBindNumaNode = 10;
+
+extern void BindNumaNode(void* const p, const size_t cBytes, const int iNode) noexcept {
+   if(iNode < 0 || nullptr == p) {
+      return;
+   }
+   const long cBytesPage = sysconf(_SC_PAGESIZE);
+   if(cBytesPage <= 0) {
+      return;
+   }
+   // mbind works on whole pages.  Pages shared with the allocator's bookkeeping or other allocations are left to the
+   // default policy, which only matters for small buffers where placement does not matter anyways
+   const uintptr_t mask = static_cast<uintptr_t>(cBytesPage) - 1;
+   const uintptr_t start = (reinterpret_cast<uintptr_t>(p) + mask) & ~mask;
+   const uintptr_t end = (reinterpret_cast<uintptr_t>(p) + cBytes) & ~mask;
+   if(end <= start) {
+      return;
+   }
+
+   // numaif.h belongs to libnuma which we do not depend on, so define the one policy we use.  MPOL_PREFERRED falls
+   // back to other nodes instead of failing when the preferred node is full
+   static constexpr int k_MPOL_PREFERRED = 1;
+   unsigned long nodeMask[k_cNumaNodesMax / (sizeof(unsigned long) * 8) + 1] = {};
+   nodeMask[static_cast<size_t>(iNode) / (sizeof(unsigned long) * 8)] |= 1UL
+         << (static_cast<size_t>(iNode) % (sizeof(unsigned long) * 8));
+   if(0 != syscall(SYS_mbind,
+                  reinterpret_cast<void*>(start),
+                  static_cast<unsigned long>(end - start),
+                  k_MPOL_PREFERRED,
+                  nodeMask,
+                  static_cast<unsigned long>(sizeof(nodeMask) * 8),
+                  0U)) {
+      LOG_COUNTED_0(&g_cLogBindNumaNode, Trace_Info, Trace_Verbose, "BindNumaNode mbind failed");
+   }
+}
+#else // __linux__
+static void LoadTopology(ThreadPoolState* const pPool) noexcept {
+   pPool->m_cCpus = 0;
+   pPool->m_cNodes = 0;
+   if(IntEbm{0} <= pPool->m_numaNode ||
+         0 != ((ThreadPoolFlags_PinCores | ThreadPoolFlags_SpreadNodes) & pPool->m_flags)) {
+      LOG_0(Trace_Warning, "WARNING LoadTopology core pinning and NUMA placement are only supported on Linux");
+   }
+}
+
+static void PinThread(const ThreadPoolState* const pPool, const size_t iThread) noexcept {
+   UNUSED(pPool);
+   UNUSED(iThread);
+}
+
+extern void BindNumaNode(void* const p, const size_t cBytes, const int iNode) noexcept {
+   UNUSED(p);
+   UNUSED(cBytes);
+   UNUSED(iNode);
+}
+#endif // __linux__
+
+static size_t GetStripeCount(const ThreadPoolState* const pPool) noexcept {
+   return 0 != (ThreadPoolFlags_SpreadNodes & pPool->m_flags) && size_t{2} <= pPool->m_cNodes ? pPool->m_cNodes :
+                                                                                                 size_t{1};
+}
+
+extern size_t GetThreadPoolNodes(int* const aNodesOut) noexcept {
+   const ThreadPoolState* const pPool = GetThreadPool();
+   const size_t cStripes = GetStripeCount(pPool);
+   if(size_t{1} == cStripes) {
+      return 0;
+   }
+   for(size_t iNode = 0; iNode < cStripes; ++iNode) {
+      aNodesOut[iNode] = pPool->m_aNodes[iNode];
+   }
+   return cStripes;
+}
+
+static void RunWorker(ThreadPoolState* const pPool, const size_t iThread, size_t iJobSeen) noexcept {
+   g_bInsideParallelFor = true;
+   PinThread(pPool, iThread);
+   const size_t iStripeHome = iThread % GetStripeCount(pPool);
+
+   std::unique_lock<std::mutex> lock(pPool->m_mutexWork);
+   while(true) {
+      pPool->m_cvWork.wait(lock, [&] { return pPool->m_bStop || iJobSeen != pPool->m_iJob; });
+      if(pPool->m_bStop) {
+         break;
+      }
+      iJobSeen = pPool->m_iJob;
+      ParallelForState* const pState = pPool->m_pState;
+      lock.unlock();
+
+      RunParallelTasks(pState, iStripeHome);
+
+      lock.lock();
+      EBM_ASSERT(size_t{1} <= pPool->m_cWorkersBusy);
+      --pPool->m_cWorkersBusy;
+      if(size_t{0} == pPool->m_cWorkersBusy) {
+         pPool->m_cvDone.notify_all();
+      }
+   }
+   --pPool->m_cWorkersAlive;
+   pPool->m_cvDone.notify_all();
+}
+
+// requires m_mutexDispatch
+static size_t GetThreadCount(const ThreadPoolState* const pPool) noexcept {
+   size_t cThreads = pPool->m_cThreadsRequested;
+   if(size_t{0} == cThreads) {
+      if(size_t{0} != pPool->m_cCpus) {
+         cThreads = pPool->m_cCpus;
+      } else {
+         // hardware_concurrency can return 0 if it is unable to determine the number of cores
+         cThreads = static_cast<size_t>(std::thread::hardware_concurrency());
+      }
+   }
+   cThreads = size_t{0} == cThreads ? size_t{1} : cThreads;
+   return k_cThreadsMax < cThreads ? k_cThreadsMax : cThreads;
+}
+
+// requires m_mutexDispatch
+static void UpdateParallel(ThreadPoolState* const pPool) noexcept {
+   const bool bParallel = nullptr != pPool->m_parallelFor || pPool->m_bConfigured && size_t{1} < GetThreadCount(pPool);
+   pPool->m_bParallel.store(bParallel, std::memory_order_release);
+}
+
+// requires m_mutexDispatch
+static void StartWorkers(ThreadPoolState* const pPool) noexcept {
+   EBM_ASSERT(!pPool->m_bWorkersStarted);
+   EBM_ASSERT(size_t{0} == pPool->m_cWorkersAlive);
+   EBM_ASSERT(size_t{0} == pPool->m_cThreads);
+
+   pPool->m_bWorkersStarted = true;
+
+   const size_t cThreads = GetThreadCount(pPool);
+
+   // the calling thread participates in the work but belongs to the host, so we leave its affinity alone
+   for(size_t iThread = 1; iThread < cThreads; ++iThread) {
+      size_t iJob;
+      {
+         std::lock_guard<std::mutex> lock(pPool->m_mutexWork);
+         ++pPool->m_cWorkersAlive;
+         // a new worker might not reach the condition variable until after the next job is published, so tell it
+         // which job was last so that it does not skip the next one
+         iJob = pPool->m_iJob;
+      }
+      try {
+         pPool->m_aThreads[pPool->m_cThreads] = std::thread(RunWorker, pPool, iThread, iJob);
+         ++pPool->m_cThreads;
+      } catch(...) {
+         // the C++ standard doesn't really seem to say what kind of exceptions we'd get for various errors.  If we
+         // cannot start more threads then the threads we already have, including this one, will do all the work
+         LOG_0(Trace_Warning, "WARNING StartWorkers thread start failed");
+         std::lock_guard<std::mutex> lock(pPool->m_mutexWork);
+         --pPool->m_cWorkersAlive;
+         break;
+      }
+   }
+}
+
+// requires m_mutexDispatch
+static void StopWorkers(ThreadPoolState* const pPool, const bool bJoin) noexcept {
+   {
+      std::unique_lock<std::mutex> lock(pPool->m_mutexWork);
+      pPool->m_bStop = true;
+      pPool->m_cvWork.notify_all();
+      pPool->m_cvDone.wait(lock, [&] { return size_t{0} == pPool->m_cWorkersAlive; });
+      pPool->m_bStop = false;
+   }
+   // every worker has left RunWorker's loop, so all that remains of each is returning from the thread function
+   for(size_t iThread = 0; iThread < pPool->m_cThreads; ++iThread) {
+      try {
+         if(bJoin) {
+            pPool->m_aThreads[iThread].join();
+         } else {
+            pPool->m_aThreads[iThread].detach();
+         }
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING StopWorkers thread join failed");
+      }
+   }
+   pPool->m_cThreads = 0;
+   pPool->m_bWorkersStarted = false;
+}
+
+#ifndef _WIN32
+// fork only copies the calling thread, so the child would see workers that do not exist and wait for them forever.
+// Holding both locks across the fork gives the child a consistent pool, which it then resets to having no workers.
+// A fork from inside a parallel task cannot take the locks since this thread or its dispatcher already holds them
+static bool g_bForkLocked = false;
+
+static void ForkPrepare() noexcept {
+   g_bForkLocked = false;
+   if(!g_bThreadPoolCreated.load(std::memory_order_acquire) || g_bInsideParallelFor) {
+      return;
+   }
+   ThreadPoolState* const pPool = GetThreadPool();
+   pPool->m_mutexDispatch.lock();
+   pPool->m_mutexWork.lock();
+   g_bForkLocked = true;
+}
+
+static void ForkParent() noexcept {
+   if(g_bForkLocked) {
+      ThreadPoolState* const pPool = GetThreadPool();
+      pPool->m_mutexWork.unlock();
+      pPool->m_mutexDispatch.unlock();
+      g_bForkLocked = false;
+   }
+}
+
+static void ForkChild() noexcept {
+   if(!g_bThreadPoolCreated.load(std::memory_order_acquire)) {
+      return;
+   }
+   ThreadPoolState* const pPool = GetThreadPool();
+   if(g_bForkLocked) {
+      pPool->m_mutexWork.unlock();
+      pPool->m_mutexDispatch.unlock();
+      g_bForkLocked = false;
+   } else {
+      // the owners of these locks were not copied into the child
+      new(&pPool->m_mutexDispatch) std::mutex();
+      new(&pPool->m_mutexWork) std::mutex();
+   }
+   // the parent's workers may have been waiting on these.  The old objects cannot be destroyed normally: a joinable
+   // std::thread ends the process when destroyed, so build fresh ones over them
+   new(&pPool->m_cvWork) std::condition_variable();
+   new(&pPool->m_cvDone) std::condition_variable();
+   for(size_t iThread = 0; iThread < pPool->m_cThreads; ++iThread) {
+      new(&pPool->m_aThreads[iThread]) std::thread();
+   }
+   pPool->m_cThreads = 0;
+   pPool->m_cWorkersAlive = 0;
+   pPool->m_cWorkersBusy = 0;
+   pPool->m_bStop = false;
+   // the configuration carries over, so the next ParallelFor in the child starts its own workers
+   pPool->m_bWorkersStarted = false;
+}
+#endif // _WIN32
+
+// joins the workers when the library is unloaded or the process exits, before the code they run goes away
+struct ThreadPoolShutdown final {
+   ~ThreadPoolShutdown() {
+      if(!g_bThreadPoolCreated.load(std::memory_order_acquire)) {
+         return;
+      }
+      ThreadPoolState* const pPool = GetThreadPool();
+      std::unique_lock<std::mutex> lockDispatch(pPool->m_mutexDispatch, std::try_to_lock);
+      if(!lockDispatch.owns_lock()) {
+         // exit was called while another thread is inside a ParallelFor.  Its workers are busy with the job, and
+         // waiting for them here could deadlock, so leave them to the OS
+         return;
+      }
+      if(pPool->m_bWorkersStarted) {
+#ifdef _WIN32
+         // static destructors run under the loader lock on Windows, where a thread cannot finish exiting, so join
+         // would never return.  The workers have left RunWorker's loop by the time StopWorkers returns
+         StopWorkers(pPool, false);
+#else // _WIN32
+         StopWorkers(pPool, true);
+#endif // _WIN32
+      }
+   }
+};
+static ThreadPoolShutdown g_threadPoolShutdown;
+
+static ErrorEbm EBM_CALLING_CONVENTION RunHostTask(void* taskContext, IntEbm indexTask) {
+   ParallelForState* const pState = static_cast<ParallelForState*>(taskContext);
+   if(IsConvertError<size_t>(indexTask) || pState->m_cTasks <= static_cast<size_t>(indexTask)) {
+      LOG_0(Trace_Error, "ERROR RunHostTask indexTask out of range");
+      return Error_IllegalParamVal;
+   }
+   bool bInsideParallelForPrev = g_bInsideParallelFor;
+   g_bInsideParallelFor = true;
+   const ErrorEbm error = pState->m_task(pState->m_pContext, static_cast<size_t>(indexTask));
+   g_bInsideParallelFor = bInsideParallelForPrev;
+   return error;
+}
+
+extern bool IsParallelForEnabled() noexcept {
+   if(g_bInsideParallelFor) {
+      return false;
+   }
+   return GetThreadPool()->m_bParallel.load(std::memory_order_acquire);
+}
+
+extern ErrorEbm ParallelFor(const size_t cTasks, const ParallelTask task, void* const pContext) noexcept {
+   EBM_ASSERT(nullptr != task);
+
+   if(size_t{0} == cTasks) {
+      return Error_None;
+   }
+
+   ParallelForState state;
+
+   if(size_t{1} == cTasks || g_bInsideParallelFor) {
+      InitParallelForState(&state, 1, cTasks, task, pContext);
+      RunParallelTasks(&state, 0);
+      return state.m_error.load(std::memory_order_relaxed);
+   }
+
+   ThreadPoolState* const pPool = GetThreadPool();
+
+   if(!pPool->m_bParallel.load(std::memory_order_acquire)) {
+      // nobody asked for threads, so stay on the caller's thread
+      InitParallelForState(&state, 1, cTasks, task, pContext);
+      RunParallelTasks(&state, 0);
+      return state.m_error.load(std::memory_order_relaxed);
+   }
+
+   std::unique_lock<std::mutex> lockDispatch(pPool->m_mutexDispatch, std::try_to_lock);
+   if(!lockDispatch.owns_lock()) {
+      // another thread has the workers.  Waiting for it would serialize both callers anyways, so run on this thread
+      InitParallelForState(&state, 1, cTasks, task, pContext);
+      RunParallelTasks(&state, 0);
+      return state.m_error.load(std::memory_order_relaxed);
+   }
+
+   InitParallelForState(&state, GetStripeCount(pPool), cTasks, task, pContext);
+
+   if(nullptr != pPool->m_parallelFor) {
+      if(IsConvertError<IntEbm>(cTasks)) {
+         LOG_0(Trace_Error, "ERROR ParallelFor IsConvertError<IntEbm>(cTasks)");
+         return Error_IllegalParamVal;
+      }
+      const ErrorEbm error =
+            (*pPool->m_parallelFor)(pPool->m_parallelForContext, static_cast<IntEbm>(cTasks), RunHostTask, &state);
+      if(Error_None != error) {
+         return error;
+      }
+      return state.m_error.load(std::memory_order_relaxed);
+   }
+
+   if(!pPool->m_bWorkersStarted) {
+      StartWorkers(pPool);
+   }
+
+   g_bInsideParallelFor = true;
+   {
+      std::lock_guard<std::mutex> lock(pPool->m_mutexWork);
+      pPool->m_pState = &state;
+      ++pPool->m_iJob;
+      pPool->m_cWorkersBusy = pPool->m_cWorkersAlive;
+   }
+   pPool->m_cvWork.notify_all();
+
+   RunParallelTasks(&state, 0);
+
+   {
+      std::unique_lock<std::mutex> lock(pPool->m_mutexWork);
+      pPool->m_cvDone.wait(lock, [&] { return size_t{0} == pPool->m_cWorkersBusy; });
+      pPool->m_pState = nullptr;
+   }
+   g_bInsideParallelFor = false;
+
+   return state.m_error.load(std::memory_order_relaxed);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetThreadPool(
+      IntEbm countThreads, ThreadPoolFlags flags, IntEbm numaNode) {
+   LOG_N(Trace_Info,
+         "Entered SetThreadPool: countThreads=%" IntEbmPrintf ", flags=0x%" UThreadPoolFlagsPrintf
+         ", numaNode=%" IntEbmPrintf,
+         countThreads,
+         static_cast<UThreadPoolFlags>(flags),
+         numaNode);
+
+   if(countThreads < IntEbm{0}) {
+      LOG_0(Trace_Error, "ERROR SetThreadPool countThreads < 0");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countThreads)) {
+      LOG_0(Trace_Error, "ERROR SetThreadPool IsConvertError<size_t>(countThreads)");
+      return Error_IllegalParamVal;
+   }
+   if(0 !=
+         (static_cast<UThreadPoolFlags>(flags) &
+               ~(static_cast<UThreadPoolFlags>(ThreadPoolFlags_PinCores) |
+                     static_cast<UThreadPoolFlags>(ThreadPoolFlags_SpreadNodes)))) {
+      LOG_0(Trace_Error, "ERROR SetThreadPool flags contains unknown flags. Ignoring extras.");
+   }
+   if(numaNode < IntEbm{-1}) {
+      LOG_0(Trace_Error, "ERROR SetThreadPool numaNode < -1");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm{0} <= numaNode && 0 != (ThreadPoolFlags_SpreadNodes & flags)) {
+      LOG_0(Trace_Error, "ERROR SetThreadPool ThreadPoolFlags_SpreadNodes cannot be combined with a numaNode");
+      return Error_IllegalParamVal;
+   }
+   if(g_bInsideParallelFor) {
+      LOG_0(Trace_Error, "ERROR SetThreadPool cannot be called from inside a parallel task");
+      return Error_IllegalParamVal;
+   }
+   ThreadPoolState* const pPool = GetThreadPool();
+   std::lock_guard<std::mutex> lockDispatch(pPool->m_mutexDispatch);
+   if(pPool->m_bWorkersStarted) {
+      StopWorkers(pPool, true);
+   }
+   pPool->m_cThreadsRequested = static_cast<size_t>(countThreads);
+   pPool->m_flags = flags;
+   pPool->m_numaNode = numaNode;
+   LoadTopology(pPool);
+   pPool->m_bConfigured = true;
+   UpdateParallel(pPool);
+   // the workers are started again lazily by the next ParallelFor
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION SetParallelForCallback(
+      ParallelForFunction parallelFor, void* callbackContext) {
+   LOG_N(Trace_Info,
+         "Entered SetParallelForCallback: parallelFor=%p, callbackContext=%p",
+         reinterpret_cast<void*>(parallelFor),
+         callbackContext);
+
+   if(g_bInsideParallelFor) {
+      LOG_0(Trace_Error, "ERROR SetParallelForCallback cannot be called from inside a parallel task");
+      return Error_IllegalParamVal;
+   }
+
+   ThreadPoolState* const pPool = GetThreadPool();
+   std::lock_guard<std::mutex> lockDispatch(pPool->m_mutexDispatch);
+   if(nullptr != parallelFor && pPool->m_bWorkersStarted) {
+      // the host pool replaces ours, so don't leave idle threads around
+      StopWorkers(pPool, true);
+   }
+   pPool->m_parallelFor = parallelFor;
+   pPool->m_parallelForContext = callbackContext;
+   UpdateParallel(pPool);
+
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
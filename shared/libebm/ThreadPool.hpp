@@ -0,0 +1,44 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "libebm.h" // ErrorEbm
+#include "unzoned.h"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+static constexpr size_t k_cNumaNodesMax = 64;
+
+// A ParallelTask is called exactly once for each iTask in [0, cTasks) unless a task fails.  The calls can happen on
+// any thread and in any order, so tasks should only write to memory that no other iTask touches.
+typedef ErrorEbm (*ParallelTask)(void* const pContext, const size_t iTask);
+
+// ParallelFor returns once all tasks have completed.  If any tasks fail, the remaining tasks are skipped and the error
+// from one of the failed tasks is returned.
+extern ErrorEbm ParallelFor(const size_t cTasks, const ParallelTask task, void* const pContext) noexcept;
+
+// IsParallelForEnabled returns false when ParallelFor would run every task on the calling thread, which is the case
+// until SetThreadPool asks for more than 1 thread or a ParallelFor callback is installed.
+extern bool IsParallelForEnabled() noexcept;
+
+// With ThreadPoolFlags_SpreadNodes, GetThreadPoolNodes fills aNodesOut with the NUMA node of each of the pool's
+// stripes and returns the count, which is at least 2.  ParallelFor prefers to run task iTask on a worker of node
+// aNodesOut[iTask % count], so data for iTask should be placed there.  Returns 0 when the pool is not spread.
+// aNodesOut must have room for k_cNumaNodesMax items.
+extern size_t GetThreadPoolNodes(int* const aNodesOut) noexcept;
+
+// BindNumaNode asks the OS to place the pages of a fresh allocation on iNode when they are first touched.  It is a
+// hint that does nothing for iNode < 0 or on platforms without NUMA placement.
+extern void BindNumaNode(void* const p, const size_t cBytes, const int iNode) noexcept;
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,331 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stdlib.h> // malloc
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint32_t, uint64_t
+#include <stdio.h> // snprintf
+#include <string.h> // memcpy
+#include <atomic> // std::atomic
+#include <chrono> // std::chrono::steady_clock
+
+#ifdef _WIN32
+#include <process.h> // _getpid
+#else // _WIN32
+#include <unistd.h> // getpid
+#endif // _WIN32
+
+#include "libebm.h"
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // LIKELY
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+
+#include "Timeline.hpp"
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// Each thread that calls into libebm while recording gets its own ring of the most recent events.  The owning thread
+// is the only writer, so recording needs no locks.  Rings are never freed since FillTimelineJson can read them at any
+// time, but a ring is handed to the next new thread once its thread exits, so short lived threads do not leak.
+static constexpr size_t k_cTimelineEventsPerThread = size_t{1} << 16;
+static_assert(0 == (k_cTimelineEventsPerThread & (k_cTimelineEventsPerThread - 1)), "must be a power of two");
+
+// more than enough for the longest name, the tick in microseconds, the pid, the tid, and two 64 bit args
+static constexpr size_t k_cTimelineCharsPerEventMax = 256;
+static constexpr size_t k_cTimelineCharsExtra = 128;
+
+struct TimelineEvent {
+   uint64_t m_tick;
+   IntEbm m_arg0;
+   IntEbm m_arg1;
+   uint32_t m_iThread;
+   unsigned char m_iName;
+   char m_phase;
+};
+static_assert(std::is_standard_layout<TimelineEvent>::value && std::is_trivial<TimelineEvent>::value,
+      "We allocate this with malloc, so it needs to be POD");
+
+struct TimelineRing {
+   TimelineRing* m_pNext; // set before the ring is published and never changed afterwards
+   std::atomic<bool> m_bClaimed;
+   std::atomic<uint64_t> m_cWritten;
+   TimelineEvent m_aEvents[k_cTimelineEventsPerThread];
+};
+
+struct TimelineThread {
+   TimelineRing* m_pRing;
+   uint32_t m_iThread;
+   bool m_bFailed;
+
+   ~TimelineThread() {
+      if(nullptr != m_pRing) {
+         m_pRing->m_bClaimed.store(false, std::memory_order_release);
+      }
+   }
+};
+
+static const struct {
+   const char* m_sName;
+   const char* m_sArg0;
+   const char* m_sArg1;
+} k_timelineNames[TimelineName_COUNT] = {
+      {"CreateBooster", "terms", "samples"},
+      {"GenerateTermUpdate", "term", "samples"},
+      {"ApplyTermUpdate", "term", "samples"},
+      {"CreateInteractionDetector", "features", "samples"},
+      {"CalcInteractionStrength", "dimensions", "samples"},
+};
+
+std::atomic<bool> g_bTimelineRecording{false};
+
+static std::atomic<TimelineRing*> g_pTimelineRings{nullptr};
+static std::atomic<uint32_t> g_cTimelineThreads{0};
+static std::atomic<uint64_t> g_timelineStartTick{0};
+
+static thread_local TimelineThread g_timelineThread{nullptr, 0, false};
+
+static uint64_t GetTimelineTick() {
+   // steady_clock is CLOCK_MONOTONIC on Linux, so timelines from separate processes line up when merged
+   return static_cast<uint64_t>(
+         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+               .count());
+}
+
+static TimelineRing* ClaimTimelineRing() {
+   TimelineRing* pRing = g_pTimelineRings.load(std::memory_order_acquire);
+   while(nullptr != pRing) {
+      bool bClaimed = false;
+      if(pRing->m_bClaimed.compare_exchange_strong(bClaimed, true, std::memory_order_acq_rel)) {
+         return pRing;
+      }
+      pRing = pRing->m_pNext;
+   }
+
+   pRing = static_cast<TimelineRing*>(malloc(sizeof(TimelineRing)));
+   if(UNLIKELY(nullptr == pRing)) {
+      LOG_0(Trace_Warning, "WARNING ClaimTimelineRing nullptr == pRing");
+      return nullptr;
+   }
+   pRing->m_bClaimed.store(true, std::memory_order_relaxed);
+   pRing->m_cWritten.store(0, std::memory_order_relaxed);
+
+   TimelineRing* pHead = g_pTimelineRings.load(std::memory_order_relaxed);
+   do {
+      pRing->m_pNext = pHead;
+   } while(!g_pTimelineRings.compare_exchange_weak(
+         pHead, pRing, std::memory_order_release, std::memory_order_relaxed));
+   return pRing;
+}
+
+extern void RecordTimelineEvent(
+      const TimelineName iName, const char phase, const IntEbm arg0, const IntEbm arg1) noexcept {
+   EBM_ASSERT(iName < TimelineName_COUNT);
+   EBM_ASSERT('B' == phase || 'E' == phase);
+
+   TimelineThread* const pThread = &g_timelineThread;
+   TimelineRing* pRing = pThread->m_pRing;
+   if(UNLIKELY(nullptr == pRing)) {
+      if(pThread->m_bFailed) {
+         return;
+      }
+      pRing = ClaimTimelineRing();
+      if(UNLIKELY(nullptr == pRing)) {
+         // do not retry the allocation on every event
+         pThread->m_bFailed = true;
+         return;
+      }
+      pThread->m_pRing = pRing;
+      pThread->m_iThread = g_cTimelineThreads.fetch_add(uint32_t{1}, std::memory_order_relaxed) + uint32_t{1};
+   }
+
+   const uint64_t cWritten = pRing->m_cWritten.load(std::memory_order_relaxed);
+   TimelineEvent* const pEvent =
+         &pRing->m_aEvents[static_cast<size_t>(cWritten) & (k_cTimelineEventsPerThread - size_t{1})];
+   pEvent->m_tick = GetTimelineTick();
+   pEvent->m_arg0 = arg0;
+   pEvent->m_arg1 = arg1;
+   pEvent->m_iThread = pThread->m_iThread;
+   pEvent->m_iName = static_cast<unsigned char>(iName);
+   pEvent->m_phase = phase;
+   // publish the event only after it is fully written
+   pRing->m_cWritten.store(cWritten + uint64_t{1}, std::memory_order_release);
+}
+
+static size_t CountTimelineEvents() {
+   size_t cEvents = 0;
+   const TimelineRing* pRing = g_pTimelineRings.load(std::memory_order_acquire);
+   while(nullptr != pRing) {
+      const uint64_t cWritten = pRing->m_cWritten.load(std::memory_order_acquire);
+      cEvents += static_cast<uint64_t>(k_cTimelineEventsPerThread) < cWritten ? k_cTimelineEventsPerThread :
+                                                                                static_cast<size_t>(cWritten);
+      pRing = pRing->m_pNext;
+   }
+   return cEvents;
+}
+
+static size_t FillTimelineRing(const TimelineRing* const pRing,
+      const unsigned long long pid,
+      const uint64_t tickStart,
+      bool* const pbFirst,
+      char* const pFill,
+      const size_t cCharsRemaining) {
+   const uint64_t cWrittenBefore = pRing->m_cWritten.load(std::memory_order_acquire);
+   const uint64_t iStart = static_cast<uint64_t>(k_cTimelineEventsPerThread) < cWrittenBefore ?
+         cWrittenBefore - static_cast<uint64_t>(k_cTimelineEventsPerThread) :
+         uint64_t{0};
+
+   size_t cChars = 0;
+   size_t cDepth = 0;
+   for(uint64_t iEvent = iStart; iEvent < cWrittenBefore; ++iEvent) {
+      const TimelineEvent event =
+            pRing->m_aEvents[static_cast<size_t>(iEvent) & (k_cTimelineEventsPerThread - size_t{1})];
+
+      // the owning thread may have overwritten this slot while we were copying it
+      std::atomic_thread_fence(std::memory_order_acquire);
+      const uint64_t cWrittenAfter = pRing->m_cWritten.load(std::memory_order_relaxed);
+      if(static_cast<uint64_t>(k_cTimelineEventsPerThread) <= cWrittenAfter - iEvent) {
+         cDepth = 0;
+         continue;
+      }
+
+      if(event.m_tick < tickStart || TimelineName_COUNT <= event.m_iName) {
+         continue;
+      }
+      if('B' == event.m_phase) {
+         ++cDepth;
+      } else {
+         if(size_t{0} == cDepth) {
+            // the begin event was overwritten, and an unmatched end event confuses the trace viewers
+            continue;
+         }
+         --cDepth;
+      }
+
+      EBM_ASSERT(cChars <= cCharsRemaining);
+      if(cCharsRemaining - cChars < k_cTimelineCharsPerEventMax) {
+         return k_cTimelineCharsPerEventMax + cCharsRemaining; // signal that the buffer is too small
+      }
+      const auto& names = k_timelineNames[event.m_iName];
+      const int cPrinted = snprintf(pFill + cChars,
+            cCharsRemaining - cChars,
+            "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":%llu,\"tid\":%lu,"
+            "\"args\":{\"%s\":%lld,\"%s\":%lld}}",
+            *pbFirst ? "" : ",",
+            names.m_sName,
+            event.m_phase,
+            static_cast<unsigned long long>(event.m_tick / uint64_t{1000}),
+            static_cast<unsigned int>(event.m_tick % uint64_t{1000}),
+            pid,
+            static_cast<unsigned long>(event.m_iThread),
+            names.m_sArg0,
+            static_cast<long long>(event.m_arg0),
+            names.m_sArg1,
+            static_cast<long long>(event.m_arg1));
+      EBM_ASSERT(0 < cPrinted && static_cast<size_t>(cPrinted) < k_cTimelineCharsPerEventMax);
+      cChars += static_cast<size_t>(cPrinted);
+      *pbFirst = false;
+   }
+   return cChars;
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION StartTimeline(void) {
+   LOG_0(Trace_Info, "Entered StartTimeline");
+
+   // events from before this point are left in the rings, but FillTimelineJson skips them
+   g_timelineStartTick.store(GetTimelineTick(), std::memory_order_relaxed);
+   g_bTimelineRecording.store(true, std::memory_order_release);
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION StopTimeline(void) {
+   LOG_0(Trace_Info, "Entered StopTimeline");
+
+   g_bTimelineRecording.store(false, std::memory_order_release);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureTimelineJson(void) {
+   LOG_0(Trace_Info, "Entered MeasureTimelineJson");
+
+   // allow for events recorded on threads that keep running between this call and FillTimelineJson
+   size_t cEvents = CountTimelineEvents();
+   cEvents = cEvents < std::numeric_limits<size_t>::max() - size_t{1024} ? cEvents + size_t{1024} : cEvents;
+
+   if(IsMultiplyError(k_cTimelineCharsPerEventMax, cEvents)) {
+      LOG_0(Trace_Error, "ERROR MeasureTimelineJson IsMultiplyError(k_cTimelineCharsPerEventMax, cEvents)");
+      return Error_OutOfMemory;
+   }
+   const size_t cChars = k_cTimelineCharsPerEventMax * cEvents + k_cTimelineCharsExtra;
+   if(IsConvertError<IntEbm>(cChars)) {
+      LOG_0(Trace_Error, "ERROR MeasureTimelineJson IsConvertError<IntEbm>(cChars)");
+      return Error_OutOfMemory;
+   }
+   return static_cast<IntEbm>(cChars);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillTimelineJson(IntEbm countBytesAllocated, char* jsonOut) {
+   LOG_N(Trace_Info,
+         "Entered FillTimelineJson: countBytesAllocated=%" IntEbmPrintf ", jsonOut=%p",
+         countBytesAllocated,
+         static_cast<void*>(jsonOut));
+
+   if(nullptr == jsonOut) {
+      LOG_0(Trace_Error, "ERROR FillTimelineJson nullptr == jsonOut");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillTimelineJson IsConvertError<size_t>(countBytesAllocated)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cChars = static_cast<size_t>(countBytesAllocated);
+   if(cChars < k_cTimelineCharsExtra) {
+      LOG_0(Trace_Error, "ERROR FillTimelineJson cChars < k_cTimelineCharsExtra");
+      return Error_IllegalParamVal;
+   }
+
+#ifdef _WIN32
+   const unsigned long long pid = static_cast<unsigned long long>(_getpid());
+#else // _WIN32
+   const unsigned long long pid = static_cast<unsigned long long>(getpid());
+#endif // _WIN32
+
+   const uint64_t tickStart = g_timelineStartTick.load(std::memory_order_relaxed);
+
+   // k_cTimelineCharsExtra holds the header, the footer, and the null terminator
+   static constexpr char k_sHeader[] = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+   static constexpr char k_sFooter[] = "\n]}\n";
+   static_assert(sizeof(k_sHeader) + sizeof(k_sFooter) <= k_cTimelineCharsExtra, "k_cTimelineCharsExtra too small");
+   const size_t cCharsEvents = cChars - k_cTimelineCharsExtra;
+
+   memcpy(jsonOut, k_sHeader, sizeof(k_sHeader) - 1);
+   char* const pEvents = jsonOut + sizeof(k_sHeader) - 1;
+   size_t iChar = 0;
+
+   bool bFirst = true;
+   const TimelineRing* pRing = g_pTimelineRings.load(std::memory_order_acquire);
+   while(nullptr != pRing) {
+      const size_t cCharsRing =
+            FillTimelineRing(pRing, pid, tickStart, &bFirst, pEvents + iChar, cCharsEvents - iChar);
+      if(cCharsEvents - iChar < cCharsRing) {
+         LOG_0(Trace_Error, "ERROR FillTimelineJson countBytesAllocated is too small for the recorded events");
+         jsonOut[0] = '\0';
+         return Error_IllegalParamVal;
+      }
+      iChar += cCharsRing;
+      pRing = pRing->m_pNext;
+   }
+
+   memcpy(pEvents + iChar, k_sFooter, sizeof(k_sFooter)); // includes the null terminator
+
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -0,0 +1,73 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+#include <stddef.h> // size_t
+#include <atomic> // std::atomic
+
+#include "libebm.h" // IntEbm
+#include "unzoned.h" // UNLIKELY
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+enum TimelineName : unsigned char {
+   TimelineName_CreateBooster,
+   TimelineName_GenerateTermUpdate,
+   TimelineName_ApplyTermUpdate,
+   TimelineName_CreateInteractionDetector,
+   TimelineName_CalcInteractionStrength,
+   TimelineName_COUNT
+};
+
+extern std::atomic<bool> g_bTimelineRecording;
+
+extern void RecordTimelineEvent(
+      const TimelineName iName, const char phase, const IntEbm arg0, const IntEbm arg1) noexcept;
+
+// TimelineScope records a begin event when constructed and the matching end event when it goes out of scope, so every
+// return path of an API function is covered.  When recording is off, the only cost is one relaxed atomic load.  The
+// args can be updated after construction once they are known, and the end event carries the updated values.
+class TimelineScope final {
+   TimelineName m_iName;
+   bool m_bRecording;
+   IntEbm m_arg0;
+   IntEbm m_arg1;
+
+ public:
+   TimelineScope() = delete;
+   TimelineScope(const TimelineScope&) = delete;
+   void operator=(const TimelineScope&) = delete;
+   void* operator new(std::size_t) = delete; // we only use malloc/free in this library
+   void operator delete(void*) = delete; // we only use malloc/free in this library
+
+   inline TimelineScope(const TimelineName iName, const IntEbm arg0, const IntEbm arg1) noexcept :
+         m_iName(iName),
+         m_bRecording(g_bTimelineRecording.load(std::memory_order_relaxed)),
+         m_arg0(arg0),
+         m_arg1(arg1) {
+      if(UNLIKELY(m_bRecording)) {
+         RecordTimelineEvent(iName, 'B', arg0, arg1);
+      }
+   }
+
+   inline ~TimelineScope() noexcept {
+      if(UNLIKELY(m_bRecording)) {
+         RecordTimelineEvent(m_iName, 'E', m_arg0, m_arg1);
+      }
+   }
+
+   inline void SetArgs(const IntEbm arg0, const IntEbm arg1) noexcept {
+      m_arg0 = arg0;
+      m_arg1 = arg1;
+   }
+};
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // TIMELINE_HPP
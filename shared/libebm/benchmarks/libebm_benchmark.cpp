@@ -0,0 +1,735 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// Microbenchmarks for the compute kernels.  Everything is driven through the public libebm API so the same source
+// measures any build of the shared library (default, x64 with the SIMD zones, debug).  The kernels inside the boosting
+// loop are timed with GetBoosterStats so that only the kernel itself is measured, and those counters also tell us
+// which compute zone actually ran.  Results go to stdout as one JSON document so that runs can be diffed over time.
+//
+// usage: libebm_benchmark [-quick]
+
+#include <stddef.h> // size_t
+#include <stdio.h> // printf, fprintf, snprintf
+#include <stdlib.h> // exit, strtod
+#include <string.h> // strcmp
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "libebm.h"
+
+struct ZoneInfo {
+   const char* m_sName;
+   AccelerationFlags m_flags;
+   size_t m_iStatZone;
+};
+
+static const ZoneInfo k_zones[] = {
+      {"cpu_64", AccelerationFlags_NONE, BoosterStatZone_cpu_64},
+      {"avx2", AccelerationFlags_AVX2, BoosterStatZone_avx2},
+      {"avx512f", AccelerationFlags_AVX512F, BoosterStatZone_avx512f},
+};
+
+struct ObjectiveInfo {
+   const char* m_sName;
+   TaskEbm m_cClasses; // Task_Regression for regression
+};
+
+// one entry per objective registration, with the multiclass one swept over several compiled score counts and one
+// score count above k_cCompilerScoresMax that runs the runtime sized path
+static const ObjectiveInfo k_objectives[] = {
+      {"rmse", Task_Regression},
+      {"rmse_log", Task_Regression},
+      {"poisson_deviance", Task_Regression},
+      {"tweedie_deviance", Task_Regression},
+      {"gamma_deviance", Task_Regression},
+      {"pseudo_huber", Task_Regression},
+      {"log_loss", Task_BinaryClassification},
+      {"log_loss", 3},
+      {"log_loss", 5},
+      {"log_loss", 8},
+      {"log_loss", 16},
+};
+
+static bool g_bQuick = false;
+static bool g_bFirstResult = true;
+
+static void Check(const ErrorEbm error, const char* const sWhat) {
+   if(Error_None != error) {
+      fprintf(stderr, "libebm_benchmark: %s failed with error %d\n", sWhat, static_cast<int>(error));
+      exit(1);
+   }
+}
+
+static double GetSeconds() {
+   return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double GetMinSeconds() { return g_bQuick ? 0.02 : 0.25; }
+
+static void StartResult(const char* const sBenchmark, const char* const sZone) {
+   printf("%s\n    {\"benchmark\": \"%s\", \"zone\": \"%s\"", g_bFirstResult ? "" : ",", sBenchmark, sZone);
+   g_bFirstResult = false;
+}
+
+static void AddField(const char* const sName, const size_t val) {
+   printf(", \"%s\": %llu", sName, static_cast<unsigned long long>(val));
+}
+
+static void AddField(const char* const sName, const char* const sVal) { printf(", \"%s\": \"%s\"", sName, sVal); }
+
+static void AddField(const char* const sName, const bool bVal) {
+   printf(", \"%s\": %s", sName, bVal ? "true" : "false");
+}
+
+static void FinishResult(const size_t cCalls, const double nanoseconds, const double cBytes) {
+   const double nsPerCall = 0 == cCalls ? 0.0 : nanoseconds / static_cast<double>(cCalls);
+   const double bytesPerSecond = 0.0 == nanoseconds ? 0.0 : cBytes / nanoseconds * 1e9;
+   printf(", \"calls\": %llu, \"ns_per_call\": %.1f, \"bytes_per_second\": %.4g}",
+         static_cast<unsigned long long>(cCalls),
+         nsPerCall,
+         bytesPerSecond);
+}
+
+template<typename TFunc> static void TimeCalls(TFunc func, size_t* const pcCallsOut, double* const pNanosecondsOut) {
+   func(); // warm the caches and any lazy allocations
+   size_t cCalls = 0;
+   const double start = GetSeconds();
+   double elapsed;
+   do {
+      func();
+      ++cCalls;
+      elapsed = GetSeconds() - start;
+   } while(elapsed < GetMinSeconds() || cCalls < 3);
+   *pcCallsOut = cCalls;
+   *pNanosecondsOut = elapsed * 1e9;
+}
+
+static std::vector<unsigned char> MakeDataSet(const size_t cSamples,
+      const std::vector<IntEbm>& binCounts,
+      const TaskEbm cClasses,
+      const bool bWeights,
+      std::mt19937_64& rng) {
+   const IntEbm cFeatures = static_cast<IntEbm>(binCounts.size());
+   const IntEbm countSamples = static_cast<IntEbm>(cSamples);
+
+   // the features have both a missing and an unknown bin so that every index from 0 to cBins - 1 is legal
+   std::vector<std::vector<IntEbm>> features;
+   for(const IntEbm cBins : binCounts) {
+      std::uniform_int_distribution<IntEbm> distribution(0, cBins - 1);
+      std::vector<IntEbm> bins(cSamples);
+      for(IntEbm& bin : bins) {
+         bin = distribution(rng);
+      }
+      features.push_back(bins);
+   }
+
+   std::vector<double> weights(cSamples);
+   std::uniform_real_distribution<double> weightDistribution(0.5, 2.0);
+   for(double& weight : weights) {
+      weight = weightDistribution(rng);
+   }
+
+   std::vector<IntEbm> classes(cSamples);
+   std::vector<double> targets(cSamples);
+   if(Task_Regression == cClasses) {
+      // keep the targets positive so that the log link and deviance objectives accept them
+      std::uniform_real_distribution<double> targetDistribution(0.5, 10.0);
+      for(double& target : targets) {
+         target = targetDistribution(rng);
+      }
+   } else {
+      std::uniform_int_distribution<IntEbm> classDistribution(0, cClasses - 1);
+      for(IntEbm& target : classes) {
+         target = classDistribution(rng);
+      }
+   }
+
+   IntEbm cBytes = MeasureDataSetHeader(cFeatures, bWeights ? 1 : 0, 1);
+   for(size_t iFeature = 0; iFeature < binCounts.size(); ++iFeature) {
+      cBytes += MeasureFeature(binCounts[iFeature], EBM_TRUE, EBM_TRUE, EBM_FALSE, countSamples, &features[iFeature][0]);
+   }
+   if(bWeights) {
+      cBytes += MeasureWeight(countSamples, &weights[0]);
+   }
+   if(Task_Regression == cClasses) {
+      cBytes += MeasureRegressionTarget(countSamples, &targets[0]);
+   } else {
+      cBytes += MeasureClassificationTarget(cClasses, countSamples, &classes[0]);
+   }
+
+   std::vector<unsigned char> dataSet(static_cast<size_t>(cBytes));
+   Check(FillDataSetHeader(cFeatures, bWeights ? 1 : 0, 1, cBytes, &dataSet[0]), "FillDataSetHeader");
+   for(size_t iFeature = 0; iFeature < binCounts.size(); ++iFeature) {
+      Check(FillFeature(binCounts[iFeature],
+                  EBM_TRUE,
+                  EBM_TRUE,
+                  EBM_FALSE,
+                  countSamples,
+                  &features[iFeature][0],
+                  cBytes,
+                  &dataSet[0]),
+            "FillFeature");
+   }
+   if(bWeights) {
+      Check(FillWeight(countSamples, &weights[0], cBytes, &dataSet[0]), "FillWeight");
+   }
+   if(Task_Regression == cClasses) {
+      Check(FillRegressionTarget(countSamples, &targets[0], cBytes, &dataSet[0]), "FillRegressionTarget");
+   } else {
+      Check(FillClassificationTarget(cClasses, countSamples, &classes[0], cBytes, &dataSet[0]),
+            "FillClassificationTarget");
+   }
+   return dataSet;
+}
+
+static std::vector<BagEbm> MakeBag(const size_t cSamples) {
+   // hold out every 5th sample for validation so that the metric kernel also runs
+   std::vector<BagEbm> bag(cSamples, BagEbm{1});
+   for(size_t iSample = 0; iSample < cSamples; iSample += 5) {
+      bag[iSample] = BagEbm{-1};
+   }
+   return bag;
+}
+
+static size_t GetCountScores(const TaskEbm cClasses) {
+   return Task_Regression == cClasses || Task_BinaryClassification == cClasses ? size_t{1} :
+                                                                                   static_cast<size_t>(cClasses);
+}
+
+static BoosterHandle CreateBench(const std::vector<unsigned char>& dataSet,
+      const std::vector<BagEbm>& bag,
+      const std::vector<IntEbm>& dimensionCounts,
+      const std::vector<IntEbm>& featureIndexes,
+      const ZoneInfo& zone,
+      const char* const sObjective) {
+   BoosterHandle boosterHandle = nullptr;
+   Check(CreateBooster(nullptr,
+               &dataSet[0],
+               &bag[0],
+               nullptr,
+               static_cast<IntEbm>(dimensionCounts.size()),
+               &dimensionCounts[0],
+               &featureIndexes[0],
+               0,
+               CreateBoosterFlags_Default,
+               zone.m_flags,
+               sObjective,
+               nullptr,
+               0,
+               &boosterHandle),
+         "CreateBooster");
+   return boosterHandle;
+}
+
+static void BoostRound(BoosterHandle boosterHandle, const IntEbm iTerm) {
+   const IntEbm leavesMax[]{3, 3};
+   double gain;
+   double metric;
+   Check(GenerateTermUpdate(nullptr,
+               boosterHandle,
+               iTerm,
+               TermBoostFlags_Default,
+               0.01,
+               2,
+               0.0,
+               0.0,
+               0.0,
+               0.0,
+               leavesMax,
+               nullptr,
+               &gain),
+         "GenerateTermUpdate");
+   Check(ApplyTermUpdate(boosterHandle, &metric), "ApplyTermUpdate");
+}
+
+static bool IsZoneAvailable(const ZoneInfo& zone) {
+   // asking for a zone that this CPU or this build of libebm lacks silently falls back to cpu_64, so check which
+   // zone the kernels actually ran in
+   std::mt19937_64 rng(0);
+   static constexpr size_t k_cSamples = 1000;
+   const std::vector<unsigned char> dataSet = MakeDataSet(k_cSamples, {4}, Task_Regression, false, rng);
+   const std::vector<BagEbm> bag = MakeBag(k_cSamples);
+   BoosterHandle boosterHandle = CreateBench(dataSet, bag, {1}, {0}, zone, "rmse");
+   BoostRound(boosterHandle, 0);
+   std::vector<UIntEbm> zoneStats(BoosterStatZone_COUNT * BoosterStat_COUNT * BoosterStatItem_COUNT);
+   Check(GetBoosterStats(boosterHandle, EBM_FALSE, nullptr, &zoneStats[0]), "GetBoosterStats");
+   FreeBooster(boosterHandle);
+   const size_t iCalls = (zone.m_iStatZone * BoosterStat_COUNT + BoosterStat_BinSums) * BoosterStatItem_COUNT +
+         BoosterStatItem_Calls;
+   return 0 != zoneStats[iCalls];
+}
+
+static void BenchBoosting(const ZoneInfo& zone) {
+   // BinSumsBoosting, ApplyUpdate, and the validation metric for every objective
+   const std::vector<size_t> sampleCounts =
+         g_bQuick ? std::vector<size_t>{10000} : std::vector<size_t>{1000, 100000, 1000000};
+   // the bits per bin index selects the cCompilerPack template instantiation inside the zone
+   const std::vector<size_t> bitCounts = g_bQuick ? std::vector<size_t>{1, 8} : std::vector<size_t>{1, 2, 4, 8, 12};
+   const size_t cRounds = g_bQuick ? 3 : 10;
+
+   for(const ObjectiveInfo& objective : k_objectives) {
+      for(const size_t cSamples : sampleCounts) {
+         for(const size_t cBits : bitCounts) {
+            for(const bool bWeights : {false, true}) {
+               std::mt19937_64 rng(cSamples + cBits);
+               const IntEbm cBins = IntEbm{1} << cBits;
+               const std::vector<unsigned char> dataSet =
+                     MakeDataSet(cSamples, {cBins}, objective.m_cClasses, bWeights, rng);
+               const std::vector<BagEbm> bag = MakeBag(cSamples);
+
+               BoosterHandle boosterHandle = CreateBench(dataSet, bag, {1}, {0}, zone, objective.m_sName);
+               BoostRound(boosterHandle, 0);
+               Check(GetBoosterStats(boosterHandle, EBM_TRUE, nullptr, nullptr), "GetBoosterStats");
+               const double start = GetSeconds();
+               size_t iRound = 0;
+               do {
+                  BoostRound(boosterHandle, 0);
+                  ++iRound;
+               } while(iRound < cRounds || GetSeconds() - start < GetMinSeconds());
+
+               std::vector<UIntEbm> zoneStats(BoosterStatZone_COUNT * BoosterStat_COUNT * BoosterStatItem_COUNT);
+               Check(GetBoosterStats(boosterHandle, EBM_FALSE, nullptr, &zoneStats[0]), "GetBoosterStats");
+               FreeBooster(boosterHandle);
+
+               static const struct {
+                  size_t m_iStat;
+                  const char* m_sName;
+               } k_kernels[] = {{BoosterStat_BinSums, "BinSumsBoosting"},
+                     {BoosterStat_ApplyUpdate, "ApplyUpdate"},
+                     {BoosterStat_Validation, "ApplyUpdateValidation"}};
+               for(const auto& kernel : k_kernels) {
+                  const UIntEbm* const pStat =
+                        &zoneStats[(zone.m_iStatZone * BoosterStat_COUNT + kernel.m_iStat) * BoosterStatItem_COUNT];
+                  StartResult(kernel.m_sName, zone.m_sName);
+                  AddField("objective", objective.m_sName);
+                  AddField("samples", cSamples);
+                  AddField("bits", cBits);
+                  AddField("scores", GetCountScores(objective.m_cClasses));
+                  AddField("weights", bWeights);
+                  FinishResult(static_cast<size_t>(pStat[BoosterStatItem_Calls]),
+                        static_cast<double>(pStat[BoosterStatItem_Nanoseconds]),
+                        static_cast<double>(pStat[BoosterStatItem_Bytes]));
+               }
+            }
+         }
+      }
+   }
+}
+
+static void BenchTensorTotals() {
+   // TensorTotalsBuild only runs for pairs and does not depend on the samples or the zone
+   const std::vector<IntEbm> binCounts = g_bQuick ? std::vector<IntEbm>{16} : std::vector<IntEbm>{4, 16, 64, 256};
+   const std::vector<TaskEbm> classCounts{Task_Regression, 8};
+   for(const IntEbm cBins : binCounts) {
+      for(const TaskEbm cClasses : classCounts) {
+         static constexpr size_t k_cSamples = 10000;
+         std::mt19937_64 rng(static_cast<uint64_t>(cBins));
+         const std::vector<unsigned char> dataSet = MakeDataSet(k_cSamples, {cBins, cBins}, cClasses, false, rng);
+         const std::vector<BagEbm> bag = MakeBag(k_cSamples);
+
+         BoosterHandle boosterHandle =
+               CreateBench(dataSet, bag, {2}, {0, 1}, k_zones[0], Task_Regression == cClasses ? "rmse" : "log_loss");
+         const double start = GetSeconds();
+         do {
+            BoostRound(boosterHandle, 0);
+         } while(GetSeconds() - start < GetMinSeconds());
+
+         std::vector<UIntEbm> termStats(BoosterStat_COUNT * BoosterStatItem_COUNT);
+         Check(GetBoosterStats(boosterHandle, EBM_FALSE, &termStats[0], nullptr), "GetBoosterStats");
+         FreeBooster(boosterHandle);
+
+         const UIntEbm* const pStat = &termStats[BoosterStat_TensorTotals * BoosterStatItem_COUNT];
+         StartResult("TensorTotalsBuild", "main");
+         AddField("bins", static_cast<size_t>(cBins * cBins));
+         AddField("scores", GetCountScores(cClasses));
+         FinishResult(static_cast<size_t>(pStat[BoosterStatItem_Calls]),
+               static_cast<double>(pStat[BoosterStatItem_Nanoseconds]),
+               static_cast<double>(pStat[BoosterStatItem_Bytes]));
+      }
+   }
+}
+
+static void BenchBestModelCopy() {
+   // every improvement in the validation metric copies the changed terms from the current model to the best model.
+   // Without a validation set every step counts as an improvement, which makes this the worst case.  Boosting a
+   // single term should cost the same no matter how many other wide terms the model holds
+   const std::vector<size_t> termCounts = g_bQuick ? std::vector<size_t>{1, 16} : std::vector<size_t>{1, 16, 256};
+   const IntEbm cBins = 64;
+   const TaskEbm cClasses = 3;
+   for(const size_t cTerms : termCounts) {
+      static constexpr size_t k_cSamples = 1000;
+      std::mt19937_64 rng(cTerms);
+      const std::vector<unsigned char> dataSet = MakeDataSet(k_cSamples, {cBins, cBins}, cClasses, false, rng);
+      const std::vector<BagEbm> bag(k_cSamples, BagEbm{1});
+
+      std::vector<IntEbm> featureIndexes;
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         featureIndexes.push_back(0);
+         featureIndexes.push_back(1);
+      }
+      BoosterHandle boosterHandle =
+            CreateBench(dataSet, bag, std::vector<IntEbm>(cTerms, 2), featureIndexes, k_zones[0], "log_loss");
+      // the tensors only expand to their full size once they are boosted
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         BoostRound(boosterHandle, static_cast<IntEbm>(iTerm));
+      }
+      Check(GetBoosterStats(boosterHandle, EBM_TRUE, nullptr, nullptr), "GetBoosterStats");
+
+      size_t cRounds = 0;
+      const double start = GetSeconds();
+      do {
+         BoostRound(boosterHandle, 0);
+         ++cRounds;
+      } while(cRounds < 3 || GetSeconds() - start < GetMinSeconds());
+
+      std::vector<UIntEbm> termStats(cTerms * BoosterStat_COUNT * BoosterStatItem_COUNT);
+      Check(GetBoosterStats(boosterHandle, EBM_FALSE, &termStats[0], nullptr), "GetBoosterStats");
+      FreeBooster(boosterHandle);
+
+      double nanoseconds = 0.0;
+      double cBytes = 0.0;
+      for(size_t iTerm = 0; iTerm < cTerms; ++iTerm) {
+         const UIntEbm* const pStat =
+               &termStats[(iTerm * BoosterStat_COUNT + BoosterStat_BestModelCopy) * BoosterStatItem_COUNT];
+         nanoseconds += static_cast<double>(pStat[BoosterStatItem_Nanoseconds]);
+         cBytes += static_cast<double>(pStat[BoosterStatItem_Bytes]);
+      }
+      // report per boosting step rather than per copy, since the point is how the step cost scales with cTerms
+      StartResult("BestModelCopy", "main");
+      AddField("terms", cTerms);
+      AddField("bins", static_cast<size_t>(cBins * cBins));
+      AddField("scores", GetCountScores(cClasses));
+      FinishResult(cRounds, nanoseconds, cBytes);
+   }
+}
+
+static void BenchInteraction(const ZoneInfo& zone) {
+   // BinSumsInteraction dominates CalcInteractionStrength, so time the whole call
+   const std::vector<size_t> sampleCounts =
+         g_bQuick ? std::vector<size_t>{10000} : std::vector<size_t>{1000, 100000, 1000000};
+   const std::vector<IntEbm> binCounts = g_bQuick ? std::vector<IntEbm>{16} : std::vector<IntEbm>{4, 16, 64};
+   const std::vector<TaskEbm> classCounts{Task_Regression, Task_BinaryClassification, 8};
+   for(const size_t cSamples : sampleCounts) {
+      for(const IntEbm cBins : binCounts) {
+         for(const TaskEbm cClasses : classCounts) {
+            for(const bool bWeights : {false, true}) {
+               std::mt19937_64 rng(cSamples + static_cast<size_t>(cBins));
+               const std::vector<unsigned char> dataSet =
+                     MakeDataSet(cSamples, {cBins, cBins}, cClasses, bWeights, rng);
+
+               const char* const sObjective = Task_Regression == cClasses ? "rmse" : "log_loss";
+               InteractionHandle interactionHandle = nullptr;
+               Check(CreateInteractionDetector(&dataSet[0],
+                           nullptr,
+                           nullptr,
+                           CreateInteractionFlags_Default,
+                           zone.m_flags,
+                           sObjective,
+                           nullptr,
+                           &interactionHandle),
+                     "CreateInteractionDetector");
+
+               const IntEbm featureIndexes[]{0, 1};
+               size_t cCalls;
+               double nanoseconds;
+               TimeCalls(
+                     [&]() {
+                        double strength;
+                        Check(CalcInteractionStrength(interactionHandle,
+                                    2,
+                                    featureIndexes,
+                                    CalcInteractionFlags_Default,
+                                    0,
+                                    1,
+                                    0.0,
+                                    0.0,
+                                    0.0,
+                                    0.0,
+                                    &strength),
+                              "CalcInteractionStrength");
+                     },
+                     &cCalls,
+                     &nanoseconds);
+               FreeInteractionDetector(interactionHandle);
+
+               const size_t cScores = GetCountScores(cClasses);
+               StartResult("BinSumsInteraction", zone.m_sName);
+               AddField("objective", sObjective);
+               AddField("samples", cSamples);
+               AddField("bins", static_cast<size_t>(cBins * cBins));
+               AddField("scores", cScores);
+               AddField("weights", bWeights);
+               // gradients and hessians plus the two packed features
+               const double cBytes = static_cast<double>(cCalls) * static_cast<double>(cSamples) *
+                     (static_cast<double>(cScores * 2 + (bWeights ? 1 : 0)) * sizeof(double) + 2.0);
+               FinishResult(cCalls, nanoseconds, cBytes);
+            }
+         }
+      }
+   }
+}
+
+static void BenchDiscretize() {
+   const std::vector<size_t> sampleCounts =
+         g_bQuick ? std::vector<size_t>{10000} : std::vector<size_t>{1000, 100000, 1000000};
+   const std::vector<size_t> cutCounts = g_bQuick ? std::vector<size_t>{255} : std::vector<size_t>{3, 255, 4095};
+   for(const size_t cSamples : sampleCounts) {
+      std::mt19937_64 rng(cSamples);
+      std::normal_distribution<double> distribution(0.0, 10.0);
+      std::vector<double> vals(cSamples);
+      for(double& val : vals) {
+         val = distribution(rng);
+      }
+      std::vector<IntEbm> bins(cSamples);
+      for(const size_t cCuts : cutCounts) {
+         std::vector<double> cuts(cCuts);
+         for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+            cuts[iCut] = -30.0 + 60.0 * static_cast<double>(iCut + 1) / static_cast<double>(cCuts + 1);
+         }
+         size_t cCalls;
+         double nanoseconds;
+         TimeCalls(
+               [&]() {
+                  Check(Discretize(static_cast<IntEbm>(cSamples),
+                              &vals[0],
+                              static_cast<IntEbm>(cCuts),
+                              &cuts[0],
+                              &bins[0]),
+                        "Discretize");
+               },
+               &cCalls,
+               &nanoseconds);
+         StartResult("Discretize", "main");
+         AddField("samples", cSamples);
+         AddField("cuts", cCuts);
+         FinishResult(cCalls,
+               nanoseconds,
+               static_cast<double>(cCalls) * static_cast<double>(cSamples) * (sizeof(double) + sizeof(IntEbm)));
+      }
+   }
+}
+
+static void BenchCutQuantile() {
+   const std::vector<size_t> sampleCounts =
+         g_bQuick ? std::vector<size_t>{10000} : std::vector<size_t>{1000, 100000, 1000000};
+   const std::vector<size_t> cutCounts = g_bQuick ? std::vector<size_t>{255} : std::vector<size_t>{16, 255, 1023};
+   for(const size_t cSamples : sampleCounts) {
+      std::mt19937_64 rng(cSamples);
+      // round to get plenty of ties, which is the slow path inside CutQuantile
+      std::normal_distribution<double> distribution(0.0, 10.0);
+      std::vector<double> vals(cSamples);
+      for(double& val : vals) {
+         val = static_cast<double>(static_cast<long long>(distribution(rng) * 100.0)) / 100.0;
+      }
+      for(const size_t cCuts : cutCounts) {
+         std::vector<double> cuts(cCuts);
+         size_t cCalls;
+         double nanoseconds;
+         TimeCalls(
+               [&]() {
+                  IntEbm countCuts = static_cast<IntEbm>(cCuts);
+                  Check(CutQuantile(static_cast<IntEbm>(cSamples), &vals[0], 1, EBM_FALSE, &countCuts, &cuts[0]),
+                        "CutQuantile");
+               },
+               &cCalls,
+               &nanoseconds);
+         StartResult("CutQuantile", "main");
+         AddField("samples", cSamples);
+         AddField("cuts", cCuts);
+         FinishResult(cCalls, nanoseconds, static_cast<double>(cCalls) * static_cast<double>(cSamples) * sizeof(double));
+      }
+   }
+}
+
+static void BenchPurify() {
+   const std::vector<IntEbm> binCounts = g_bQuick ? std::vector<IntEbm>{16} : std::vector<IntEbm>{4, 16, 64, 256};
+   const std::vector<IntEbm> scoreCounts{1, 3};
+   for(const IntEbm cBins : binCounts) {
+      for(const IntEbm cScores : scoreCounts) {
+         const size_t cCells = static_cast<size_t>(cBins * cBins);
+         std::mt19937_64 rng(cCells);
+         std::uniform_real_distribution<double> distribution(0.5, 2.0);
+         std::vector<double> weights(cCells);
+         for(double& weight : weights) {
+            weight = distribution(rng);
+         }
+         std::vector<double> original(cCells * static_cast<size_t>(cScores));
+         for(double& score : original) {
+            score = distribution(rng);
+         }
+         std::vector<double> scores;
+         const IntEbm dimensionLengths[]{cBins, cBins};
+         size_t cCalls;
+         double nanoseconds;
+         TimeCalls(
+               [&]() {
+                  scores = original;
+                  Check(Purify(0.0,
+                              EBM_FALSE,
+                              EBM_FALSE,
+                              cScores,
+                              2,
+                              dimensionLengths,
+                              &weights[0],
+                              &scores[0],
+                              nullptr,
+                              nullptr),
+                        "Purify");
+               },
+               &cCalls,
+               &nanoseconds);
+         StartResult("Purify", "main");
+         AddField("bins", cCells);
+         AddField("scores", static_cast<size_t>(cScores));
+         FinishResult(cCalls,
+               nanoseconds,
+               static_cast<double>(cCalls) * static_cast<double>(cCells) * static_cast<double>(cScores + 1) *
+                     sizeof(double));
+      }
+   }
+}
+
+static std::string MakeFullText(const std::vector<double>& vals) {
+   // the fixed 17 significant digit layout that the cut point helpers use, which is what we had before FloatsToString
+   std::string text;
+   char buffer[64];
+   for(const double val : vals) {
+      snprintf(buffer, sizeof(buffer), "%+.16le ", val);
+      text += buffer;
+   }
+   return text;
+}
+
+static std::string MakeShortestText(const std::vector<double>& vals) {
+   std::vector<char> text(vals.size() * static_cast<size_t>(GetCountCharactersPerFloat()));
+   Check(FloatsToString(static_cast<IntEbm>(vals.size()), &vals[0], &text[0]), "FloatsToString");
+   return std::string(&text[0]);
+}
+
+static void BenchFloatString() {
+   const size_t cFloats = g_bQuick ? size_t{10000} : size_t{1000000};
+
+   std::mt19937_64 rng(cFloats);
+   std::normal_distribution<double> distribution(0.0, 3.0);
+   std::vector<double> vals(cFloats);
+   for(double& val : vals) {
+      val = distribution(rng);
+   }
+   // values like 1.234 have short shortest text, which is the case the fast parser path is built for
+   std::vector<double> shortVals(cFloats);
+   for(size_t i = 0; i < cFloats; ++i) {
+      shortVals[i] = static_cast<double>(static_cast<long long>(vals[i] * 1000.0)) / 1000.0;
+   }
+
+   // room for either the snprintf layout or the FloatsToString layout
+   static constexpr size_t k_cCharsFullFloat = 32;
+   std::vector<char> text(cFloats * std::max(k_cCharsFullFloat, static_cast<size_t>(GetCountCharactersPerFloat())));
+   std::vector<double> parsed(cFloats);
+   size_t cCalls;
+   double nanoseconds;
+
+   TimeCalls(
+         [&]() {
+            char* pText = &text[0];
+            for(const double val : vals) {
+               pText += snprintf(pText, k_cCharsFullFloat, "%+.16le ", val);
+            }
+         },
+         &cCalls,
+         &nanoseconds);
+   StartResult("FloatToText", "main");
+   AddField("method", "snprintf");
+   AddField("floats", cFloats);
+   FinishResult(cCalls, nanoseconds, static_cast<double>(cCalls) * static_cast<double>(cFloats) * sizeof(double));
+
+   TimeCalls([&]() { Check(FloatsToString(static_cast<IntEbm>(cFloats), &vals[0], &text[0]), "FloatsToString"); },
+         &cCalls,
+         &nanoseconds);
+   StartResult("FloatToText", "main");
+   AddField("method", "FloatsToString");
+   AddField("floats", cFloats);
+   FinishResult(cCalls, nanoseconds, static_cast<double>(cCalls) * static_cast<double>(cFloats) * sizeof(double));
+
+   struct ParseCase {
+      const char* m_sMethod;
+      const char* m_sText;
+      bool m_bStrtod;
+      std::string m_text;
+   };
+   const ParseCase parseCases[]{
+         {"strtod", "full", true, MakeFullText(vals)},
+         {"StringToFloats", "shortest", false, MakeShortestText(vals)},
+         {"strtod", "short", true, MakeShortestText(shortVals)},
+         {"StringToFloats", "short", false, MakeShortestText(shortVals)},
+   };
+   for(const ParseCase& parseCase : parseCases) {
+      const char* const sText = parseCase.m_text.c_str();
+      if(parseCase.m_bStrtod) {
+         TimeCalls(
+               [&]() {
+                  const char* pText = sText;
+                  for(double& val : parsed) {
+                     char* pNext;
+                     val = strtod(pText, &pNext);
+                     pText = pNext;
+                  }
+               },
+               &cCalls,
+               &nanoseconds);
+      } else {
+         TimeCalls(
+               [&]() {
+                  Check(StringToFloats(sText, static_cast<IntEbm>(cFloats), &parsed[0]), "StringToFloats");
+               },
+               &cCalls,
+               &nanoseconds);
+      }
+      StartResult("TextToFloat", "main");
+      AddField("method", parseCase.m_sMethod);
+      AddField("text", parseCase.m_sText);
+      AddField("floats", cFloats);
+      FinishResult(cCalls, nanoseconds, static_cast<double>(cCalls) * static_cast<double>(parseCase.m_text.size()));
+   }
+}
+
+int main(int argc, char** argv) {
+   for(int iArg = 1; iArg < argc; ++iArg) {
+      if(0 == strcmp(argv[iArg], "-quick")) {
+         g_bQuick = true;
+      } else {
+         fprintf(stderr, "usage: libebm_benchmark [-quick]\n");
+         return 1;
+      }
+   }
+
+   std::vector<const ZoneInfo*> zones;
+   for(const ZoneInfo& zone : k_zones) {
+      if(IsZoneAvailable(zone)) {
+         zones.push_back(&zone);
+      }
+   }
+
+   printf("{\n  \"quick\": %s,\n  \"zones\": [", g_bQuick ? "true" : "false");
+   for(size_t iZone = 0; iZone < zones.size(); ++iZone) {
+      printf("%s\"%s\"", 0 == iZone ? "" : ", ", zones[iZone]->m_sName);
+   }
+   printf("],\n  \"results\": [");
+
+   for(const ZoneInfo* const pZone : zones) {
+      BenchBoosting(*pZone);
+      BenchInteraction(*pZone);
+   }
+   BenchTensorTotals();
+   BenchBestModelCopy();
+   BenchDiscretize();
+   BenchCutQuantile();
+   BenchPurify();
+   BenchFloatString();
+
+   printf("\n  ]\n}\n");
+   return 0;
+}
@@ -52,6 +52,8 @@ struct ApplyUpdateBridge {
    BoolEbm m_bHessianNeeded;
 
    BoolEbm m_bValidation;
+   // validation also sums the objective's metric unless SetValidationMetric chose another metric
+   BoolEbm m_bMetricNeeded;
    BoolEbm m_bDisableApprox;
    void* m_aMulticlassMidwayTemp; // float or double
    const void* m_aUpdateTensorScores; // float or double
@@ -182,10 +184,51 @@ inline static void FreeObjectiveWrapperInternals(ObjectiveWrapper* const pObject
    free(pObjectiveWrapper->m_pFunctionPointersCpp);
 }
 
+struct MetricBridge {
+   size_t m_cSamples;
+   size_t m_cFloatBytes;
+   size_t m_cUIntBytes;
+   const void* m_aSampleScores; // float or double.  NULL for rmse, which keeps only the residuals
+   const void* m_aTargets; // uint64_t or uint32_t or float or double.  NULL for rmse
+   const void* m_aResiduals; // float or double.  For rmse the gradients hold score - target, otherwise NULL
+   const void* m_aWeights; // float or double
+   void* m_aState; // double.  Each call accumulates into this, and FinishMetricStateC reduces it to the metric
+   BoolEbm m_bScoreRangePass; // only the range of the scores goes into the state during this pass
+};
+
+struct MetricWrapper {
+   // this needs to be void for the same reasons as ObjectiveWrapper::m_pObjective
+   void* m_pMetric;
+
+   BoolEbm m_bMaximizeMetric;
+   // the metric needs a pass over all of the validation subsets to find the range of the scores before it
+   // accumulates them
+   BoolEbm m_bScoreRange;
+   size_t m_cBytesState;
+
+   // these are C++ function pointer definitions that exist per-zone, and must remain hidden in the C interface
+   void* m_pFunctionPointersCpp;
+};
+
+inline static void InitializeMetricWrapperUnfailing(MetricWrapper* const pMetricWrapper) {
+   pMetricWrapper->m_pMetric = NULL;
+   pMetricWrapper->m_bMaximizeMetric = EBM_FALSE;
+   pMetricWrapper->m_bScoreRange = EBM_FALSE;
+   pMetricWrapper->m_cBytesState = 0;
+   pMetricWrapper->m_pFunctionPointersCpp = NULL;
+}
+
+inline static void FreeMetricWrapperInternals(MetricWrapper* const pMetricWrapper) {
+   AlignedFree(pMetricWrapper->m_pMetric);
+   free(pMetricWrapper->m_pFunctionPointersCpp);
+}
+
 struct Config {
    // don't use m_ notation here, mostly to make it cleaner for people writing *Objective classes
    size_t cOutputs;
+   size_t cTargets; // multitask objectives have more than 1 target, and cOutputs counts the scores of all of them
    BoolEbm isDifferentialPrivacy;
+   LinkEbm linkFunction; // metrics turn scores into predictions with the objective's link.  Objectives ignore this
 };
 
 INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateObjective_Cpu_64(const Config* const pConfig,
@@ -208,16 +251,21 @@ INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateObjective_Cuda_32(const Config* co
       const char* const sObjectiveEnd,
       ObjectiveWrapper* const pObjectiveWrapperOut);
 
-INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateMetric_Cpu_64(
-      const Config* const pConfig, const char* const sMetric, const char* const sMetricEnd
-      //   MetricWrapper * const pMetricWrapperOut,
-);
+INTERNAL_IMPORT_EXPORT_INCLUDE ErrorEbm CreateMetric_Cpu_64(const Config* const pConfig,
+      const char* const sMetric,
+      const char* const sMetricEnd,
+      MetricWrapper* const pMetricWrapperOut);
 
 INTERNAL_IMPORT_EXPORT_INCLUDE double FinishMetricC(
       const ObjectiveWrapper* const pObjectiveWrapper, const double metricSum);
 INTERNAL_IMPORT_EXPORT_INCLUDE BoolEbm CheckTargetsC(
       const ObjectiveWrapper* const pObjectiveWrapper, const size_t c, const void* const aTargets);
 
+INTERNAL_IMPORT_EXPORT_INCLUDE void AccumulateMetricC(
+      const MetricWrapper* const pMetricWrapper, MetricBridge* const pData);
+INTERNAL_IMPORT_EXPORT_INCLUDE double FinishMetricStateC(
+      const MetricWrapper* const pMetricWrapper, const void* const aState);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif // __cplusplus
@@ -0,0 +1,318 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !!! NOTE: To add a new metric in C++, follow the steps listed at the top of the "metric_registrations.hpp" file !!!
+
+#ifndef METRIC_HPP
+#define METRIC_HPP
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <memory> // shared_ptr, unique_ptr
+#include <type_traits> // is_same
+#include <vector>
+
+#include "libebm.h" // ErrorEbm
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h" // INLINE_ALWAYS
+
+#include "bridge.hpp" // IsClassificationLink
+
+#include "zoned_bridge_cpp_functions.hpp" // MetricFunctionPointersCpp
+#include "registration_exceptions.hpp"
+#include "Registration.hpp"
+
+struct MetricBridge;
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+template<typename TFloat> static const std::vector<std::shared_ptr<const Registration>> RegisterMetrics();
+
+struct BinaryMetric;
+struct RegressionMetric;
+
+// Metrics measure the validation set after ApplyTermUpdate has updated its scores.  Unlike the Objective classes they
+// are only registered for the CPU zone, but they read the validation subsets of every zone, so the subset data can be
+// float or double with 32 or 64 bit targets.  Each metric accumulates per-sample sufficient statistics into a state
+// array of doubles, and FinishState reduces the state accumulated over all the subsets into the metric value.
+struct Metric : public Registrable {
+ private:
+   template<typename TMetric> constexpr static bool IsEdgeMetric() {
+      return std::is_base_of<BinaryMetric, TMetric>::value || std::is_base_of<RegressionMetric, TMetric>::value;
+   }
+
+   template<typename TMetric,
+         typename TFloatData,
+         typename TUIntData,
+         typename std::enable_if<std::is_base_of<BinaryMetric, TMetric>::value, int>::type = 0>
+   INLINE_RELEASE_TEMPLATED void TypedAccumulate(MetricBridge* const pData) const {
+      const TMetric* const pMetric = static_cast<const TMetric*>(this);
+
+      const TFloatData* const aSampleScores = static_cast<const TFloatData*>(pData->m_aSampleScores);
+      const TUIntData* const aTargets = static_cast<const TUIntData*>(pData->m_aTargets);
+      const TFloatData* const aWeights = static_cast<const TFloatData*>(pData->m_aWeights);
+      EBM_ASSERT(nullptr != aSampleScores);
+      EBM_ASSERT(nullptr != aTargets);
+
+      double* const aState = static_cast<double*>(pData->m_aState);
+      const size_t cSamples = pData->m_cSamples;
+      if(EBM_FALSE != pData->m_bScoreRangePass) {
+         EBM_ASSERT(EBM_FALSE != TMetric::k_bScoreRange);
+         for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+            pMetric->RangeSample(aState, static_cast<double>(aSampleScores[iSample]));
+         }
+         return;
+      }
+      for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+         const double weight = nullptr == aWeights ? 1.0 : static_cast<double>(aWeights[iSample]);
+         pMetric->AccumulateSample(
+               aState, static_cast<double>(aSampleScores[iSample]), TUIntData{0} != aTargets[iSample], weight);
+      }
+   }
+
+   template<typename TMetric,
+         typename TFloatData,
+         typename TUIntData,
+         typename std::enable_if<std::is_base_of<RegressionMetric, TMetric>::value, int>::type = 0>
+   INLINE_RELEASE_TEMPLATED void TypedAccumulate(MetricBridge* const pData) const {
+      const TMetric* const pMetric = static_cast<const TMetric*>(this);
+
+      const TFloatData* const aWeights = static_cast<const TFloatData*>(pData->m_aWeights);
+      EBM_ASSERT(EBM_FALSE == pData->m_bScoreRangePass);
+
+      double* const aState = static_cast<double*>(pData->m_aState);
+      const size_t cSamples = pData->m_cSamples;
+      if(nullptr != pData->m_aResiduals) {
+         // the rmse objective keeps only the residuals, which are the errors of its identity link predictions
+         EBM_ASSERT(Link_identity == pMetric->m_linkFunction);
+         const TFloatData* const aResiduals = static_cast<const TFloatData*>(pData->m_aResiduals);
+         for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+            const double weight = nullptr == aWeights ? 1.0 : static_cast<double>(aWeights[iSample]);
+            pMetric->AccumulateSample(aState, static_cast<double>(aResiduals[iSample]), weight);
+         }
+      } else {
+         const TFloatData* const aSampleScores = static_cast<const TFloatData*>(pData->m_aSampleScores);
+         const TFloatData* const aTargets = static_cast<const TFloatData*>(pData->m_aTargets);
+         EBM_ASSERT(nullptr != aSampleScores);
+         EBM_ASSERT(nullptr != aTargets);
+         const bool bLogLink = Link_log == pMetric->m_linkFunction;
+         for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+            const double weight = nullptr == aWeights ? 1.0 : static_cast<double>(aWeights[iSample]);
+            const double score = static_cast<double>(aSampleScores[iSample]);
+            const double prediction = bLogLink ? std::exp(score) : score;
+            pMetric->AccumulateSample(aState, prediction - static_cast<double>(aTargets[iSample]), weight);
+         }
+      }
+   }
+
+ protected:
+   template<typename TMetric> INLINE_RELEASE_TEMPLATED void ParentAccumulate(MetricBridge* const pData) const {
+      static_assert(IsEdgeMetric<TMetric>(), "TMetric must inherit from one of the children of the Metric class");
+
+      EBM_ASSERT(nullptr != pData);
+      EBM_ASSERT(nullptr != pData->m_aState);
+
+      if(sizeof(FloatBig) == pData->m_cFloatBytes) {
+         if(sizeof(UIntBig) == pData->m_cUIntBytes) {
+            TypedAccumulate<TMetric, FloatBig, UIntBig>(pData);
+         } else {
+            EBM_ASSERT(sizeof(UIntSmall) == pData->m_cUIntBytes);
+            TypedAccumulate<TMetric, FloatBig, UIntSmall>(pData);
+         }
+      } else {
+         EBM_ASSERT(sizeof(FloatSmall) == pData->m_cFloatBytes);
+         if(sizeof(UIntBig) == pData->m_cUIntBytes) {
+            TypedAccumulate<TMetric, FloatSmall, UIntBig>(pData);
+         } else {
+            EBM_ASSERT(sizeof(UIntSmall) == pData->m_cUIntBytes);
+            TypedAccumulate<TMetric, FloatSmall, UIntSmall>(pData);
+         }
+      }
+   }
+
+   template<typename TMetric>
+   INLINE_RELEASE_TEMPLATED void FillMetricWrapper(const AccelerationFlags zones, void* const pWrapperOut) noexcept {
+      UNUSED(zones);
+      EBM_ASSERT(nullptr != pWrapperOut);
+      MetricWrapper* const pMetricWrapperOut = static_cast<MetricWrapper*>(pWrapperOut);
+      MetricFunctionPointersCpp* const pFunctionPointers =
+            static_cast<MetricFunctionPointersCpp*>(pMetricWrapperOut->m_pFunctionPointersCpp);
+      EBM_ASSERT(nullptr != pFunctionPointers);
+
+      pFunctionPointers->m_pAccumulateMetricCpp = &TMetric::StaticAccumulateMetric;
+      pFunctionPointers->m_pFinishMetricStateCpp = &TMetric::StaticFinishMetricState;
+
+      const auto bMaximizeMetric = TMetric::k_bMaximizeMetric;
+      constexpr bool bMaximizeMetricGood = std::is_same<decltype(bMaximizeMetric), const BoolEbm>::value;
+      static_assert(bMaximizeMetricGood, "TMetric::k_bMaximizeMetric should be a BoolEbm");
+      pMetricWrapperOut->m_bMaximizeMetric = bMaximizeMetric;
+
+      const auto bScoreRange = TMetric::k_bScoreRange;
+      constexpr bool bScoreRangeGood = std::is_same<decltype(bScoreRange), const BoolEbm>::value;
+      static_assert(bScoreRangeGood, "TMetric::k_bScoreRange should be a BoolEbm");
+      pMetricWrapperOut->m_bScoreRange = bScoreRange;
+
+      static_assert(1 <= TMetric::k_cStateItems, "metrics need some state to accumulate into");
+      pMetricWrapperOut->m_cBytesState = sizeof(double) * TMetric::k_cStateItems;
+
+      pMetricWrapperOut->m_pMetric = this;
+   }
+
+   Metric() = default;
+   ~Metric() = default;
+
+ public:
+   template<typename TFloat>
+   static ErrorEbm CreateMetric(const Config* const pConfig,
+         const char* const sMetric,
+         const char* const sMetricEnd,
+         MetricWrapper* const pMetricWrapperOut) noexcept {
+      EBM_ASSERT(nullptr != pConfig);
+      EBM_ASSERT(nullptr != sMetric);
+      EBM_ASSERT(nullptr != sMetricEnd);
+      EBM_ASSERT(sMetric < sMetricEnd); // empty string not allowed
+      EBM_ASSERT('\0' != *sMetric);
+      EBM_ASSERT(!(0x20 == *sMetric || (0x9 <= *sMetric && *sMetric <= 0xd)));
+      EBM_ASSERT('\0' == *sMetricEnd || k_registrationSeparator == *sMetricEnd);
+      EBM_ASSERT(nullptr != pMetricWrapperOut);
+      EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+      EBM_ASSERT(nullptr != pMetricWrapperOut->m_pFunctionPointersCpp);
+
+      LOG_0(Trace_Info, "Entered Metric::CreateMetric");
+
+      // metric strings are parsed exactly like objective strings, so we return the same errors
+      ErrorEbm error;
+
+      try {
+         const std::vector<std::shared_ptr<const Registration>> registrations = RegisterMetrics<TFloat>();
+         const bool bFailed =
+               Registration::CreateRegistrable(pConfig, sMetric, sMetricEnd, pMetricWrapperOut, registrations);
+         if(!bFailed) {
+            EBM_ASSERT(nullptr != pMetricWrapperOut->m_pMetric);
+
+            LOG_0(Trace_Info, "Exited Metric::CreateMetric");
+            return Error_None;
+         }
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Info, "Exited Metric::CreateMetric unknown metric");
+         error = Error_ObjectiveUnknown;
+      } catch(const ParamValMalformedException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamValMalformedException");
+         error = Error_ObjectiveParamValMalformed;
+      } catch(const ParamUnknownException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamUnknownException");
+         error = Error_ObjectiveParamUnknown;
+      } catch(const RegistrationConstructorException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric RegistrationConstructorException");
+         error = Error_ObjectiveConstructorException;
+      } catch(const ParamValOutOfRangeException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamValOutOfRangeException");
+         error = Error_ObjectiveParamValOutOfRange;
+      } catch(const ParamMismatchWithConfigException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric ParamMismatchWithConfigException");
+         error = Error_ObjectiveParamMismatchWithConfig;
+      } catch(const IllegalRegistrationNameException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric IllegalRegistrationNameException");
+         error = Error_ObjectiveIllegalRegistrationName;
+      } catch(const IllegalParamNameException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric IllegalParamNameException");
+         error = Error_ObjectiveIllegalParamName;
+      } catch(const DuplicateParamNameException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric DuplicateParamNameException");
+         error = Error_ObjectiveDuplicateParamName;
+      } catch(const NonPrivateRegistrationException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric NonPrivateRegistrationException");
+         error = Error_ObjectiveNonPrivate;
+      } catch(const NonPrivateParamException&) {
+         EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric NonPrivateParamException");
+         error = Error_ObjectiveParamNonPrivate;
+      } catch(const std::bad_alloc&) {
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric Out of Memory");
+         error = Error_OutOfMemory;
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING Metric::CreateMetric internal error, unknown exception");
+         error = Error_UnexpectedInternal;
+      }
+
+      return error;
+   }
+};
+static_assert(std::is_standard_layout<Metric>::value && std::is_trivially_copyable<Metric>::value,
+      "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
+
+struct BinaryMetric : public Metric {
+   // binary metrics see the logit score and whether the target is the positive class of each sample
+
+   // metrics that set k_bScoreRange see each score in RangeSample before any of them reach AccumulateSample
+   static constexpr BoolEbm k_bScoreRange = EBM_FALSE;
+   inline void RangeSample(double* const aState, const double score) const noexcept {
+      UNUSED(aState);
+      UNUSED(score);
+   }
+
+ protected:
+   BinaryMetric() = default;
+   ~BinaryMetric() = default;
+
+   static void CheckBinaryConfig(const Config& config) {
+      if(1 != config.cOutputs || 1 != config.cTargets || !IsClassificationLink(config.linkFunction)) {
+         throw ParamMismatchWithConfigException();
+      }
+   }
+};
+
+struct RegressionMetric : public Metric {
+   // regression metrics see the error of each prediction, which is the inverse link of the score minus the target
+   static constexpr BoolEbm k_bScoreRange = EBM_FALSE;
+
+ protected:
+   RegressionMetric() = default;
+   ~RegressionMetric() = default;
+
+   static LinkEbm CheckRegressionConfig(const Config& config) {
+      if(1 != config.cOutputs || 1 != config.cTargets) {
+         throw ParamMismatchWithConfigException();
+      }
+      if(Link_identity != config.linkFunction && Link_log != config.linkFunction) {
+         // the other regression links are not used by any of our objectives yet
+         throw ParamMismatchWithConfigException();
+      }
+      return config.linkFunction;
+   }
+};
+
+#define METRIC_BOILERPLATE(__EBM_TYPE, __MAXIMIZE_METRIC, cStateItems)                                                 \
+ public:                                                                                                               \
+   using TFloatInternal = TFloat;                                                                                      \
+   static constexpr BoolEbm k_bMaximizeMetric = (__MAXIMIZE_METRIC);                                                   \
+   static constexpr size_t k_cStateItems = (cStateItems);                                                              \
+   static constexpr int k_cItemsPerBitPackMax = k_cItemsPerBitPackUndefined;                                           \
+   static constexpr int k_cItemsPerBitPackMin = k_cItemsPerBitPackUndefined;                                           \
+   static void StaticAccumulateMetric(const Metric* const pThis, MetricBridge* const pData) {                          \
+      (static_cast<const __EBM_TYPE<TFloat>*>(pThis))->ParentAccumulate<const __EBM_TYPE<TFloat>>(pData);              \
+   }                                                                                                                   \
+   static double StaticFinishMetricState(const Metric* const pThis, const void* const aState) {                        \
+      return (static_cast<const __EBM_TYPE<TFloat>*>(pThis))->FinishState(static_cast<const double*>(aState));         \
+   }                                                                                                                   \
+   void FillWrapper(const AccelerationFlags zones, void* const pWrapperOut) noexcept {                                 \
+      static_assert(std::is_same<__EBM_TYPE<TFloat>, typename std::remove_pointer<decltype(this)>::type>::value,       \
+            "*Metric types mismatch");                                                                                 \
+      FillMetricWrapper<typename std::remove_pointer<decltype(this)>::type>(zones, pWrapperOut);                       \
+   }
+
+} // namespace DEFINED_ZONE_NAME
+
+#endif // METRIC_HPP
@@ -37,6 +37,7 @@ struct SingletaskObjective;
 struct BinaryObjective;
 struct MulticlassObjective;
 struct RegressionObjective;
+struct RankingObjective;
 
 struct MultitaskObjective;
 struct BinaryMultitaskObjective;
@@ -282,13 +283,6 @@ GPU_GLOBAL static void RemoteApplyUpdate(const Objective* const pObjective, Appl
          pObjective, pData);
 }
 
-struct Registrable {
-   // TODO: move this into its own file once we create Metric classes that are also Registrable
- protected:
-   Registrable() = default;
-   ~Registrable() = default;
-};
-
 struct Objective : public Registrable {
  private:
    // Welcome to the demented hall of mirrors.. a prison for your mind
@@ -298,6 +292,7 @@ struct Objective : public Registrable {
       return std::is_base_of<BinaryObjective, TObjective>::value ||
             std::is_base_of<MulticlassObjective, TObjective>::value ||
             std::is_base_of<RegressionObjective, TObjective>::value ||
+            std::is_base_of<RankingObjective, TObjective>::value ||
             std::is_base_of<BinaryMultitaskObjective, TObjective>::value ||
             std::is_base_of<MulticlassMultitaskObjective, TObjective>::value ||
             std::is_base_of<RegressionMultitaskObjective, TObjective>::value;
@@ -635,6 +630,8 @@ struct Objective : public Registrable {
       typename TFloat::T* pGradientAndHessian;
       const typename TFloat::T* pWeight;
       TFloat metricSum;
+      // when SetValidationMetric chose another metric the validation scores are updated without ours
+      const bool bMetric = bValidation && EBM_FALSE != pData->m_bMetricNeeded;
       if(bValidation) {
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
@@ -696,14 +693,14 @@ struct Objective : public Registrable {
             sampleScore.Store(pSampleScore);
             pSampleScore += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetric) {
                TFloat metric = pObjective->CalcMetric(sampleScore, target);
                if(bWeight) {
                   metricSum = FusedMultiplyAdd(metric, weight, metricSum);
                } else {
                   metricSum += metric;
                }
-            } else {
+            } else if(!bValidation) {
                pGradientAndHessian =
                      HandleGradHess<TObjective, TFloat, bHessian>(pGradientAndHessian, sampleScore, target);
             }
@@ -727,7 +724,7 @@ struct Objective : public Registrable {
          }
       } while(pSampleScoresEnd != pSampleScore);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
@@ -776,9 +773,17 @@ struct Objective : public Registrable {
                      TObjective::k_task == Task_Ranking,
                int>::type = 0>
    INLINE_RELEASE_TEMPLATED BoolEbm TypeCheckTargets(const size_t c, const void* const aTargets) const noexcept {
-      // classification
-      UNUSED(c);
-      UNUSED(aTargets);
+      // ranking relevance labels are stored like regression targets
+      EBM_ASSERT(1 <= c);
+      const TObjective* const pObjective = static_cast<const TObjective*>(this);
+      const FloatShared* pTarget = static_cast<const FloatShared*>(aTargets);
+      const FloatShared* const pTargetEnd = &pTarget[c];
+      do {
+         if(pObjective->CheckRankingTarget(static_cast<double>(*pTarget))) {
+            return EBM_TRUE;
+         }
+         ++pTarget;
+      } while(pTargetEnd != pTarget);
       return EBM_FALSE;
    }
    template<typename TObjective,
@@ -896,6 +901,7 @@ struct Objective : public Registrable {
          ObjectiveWrapper* const pObjectiveWrapperOut) noexcept {
       EBM_ASSERT(nullptr != pConfig);
       EBM_ASSERT(1 <= pConfig->cOutputs);
+      EBM_ASSERT(1 <= pConfig->cTargets);
       EBM_ASSERT(EBM_FALSE == pConfig->isDifferentialPrivacy || EBM_TRUE == pConfig->isDifferentialPrivacy);
       EBM_ASSERT(nullptr != sObjective);
       EBM_ASSERT(nullptr != sObjectiveEnd);
@@ -978,8 +984,6 @@ struct Objective : public Registrable {
 static_assert(std::is_standard_layout<Objective>::value && std::is_trivially_copyable<Objective>::value,
       "This allows offsetof, memcpy, memset, inter-language, GPU and cross-machine use where needed");
 
-// TODO: include ranking
-//
 // We use the following terminology:
 // Target      : the thing we're trying to predict.  For classification this is the label.  For regression this
 //               is what we're predicting directly.  Target and Output seem to be used interchangeably in other
@@ -994,6 +998,8 @@ static_assert(std::is_standard_layout<Objective>::value && std::is_trivially_cop
 // Binary      : binary classification.  Target is 0 or 1
 // Multiclass  : multiclass classification.  Target is 0, 1, 2, ...
 // Regression  : regression
+// Ranking     : samples are documents grouped into queries.  Target is a relevance label, and the scores only need
+//               to order the documents within each query.
 // Multioutput : a model that can predict multiple different things.  A single model could predict binary,
 //               multiclass, regression, etc. different targets.
 // Multitask   : A slightly more restricted form of multioutput where training jointly optimizes the targets.
@@ -1041,6 +1047,15 @@ struct RegressionObjective : public SingletaskObjective {
    static constexpr bool IsMultiScore = false;
 };
 
+struct RankingObjective : public SingletaskObjective {
+ protected:
+   RankingObjective() = default;
+   ~RankingObjective() = default;
+
+ public:
+   static constexpr bool IsMultiScore = false;
+};
+
 struct MultitaskObjective : public Objective {
  protected:
    MultitaskObjective() = default;
@@ -24,6 +24,13 @@ namespace DEFINED_ZONE_NAME {
 #error DEFINED_ZONE_NAME must be defined
 #endif // DEFINED_ZONE_NAME
 
+struct Registrable {
+   // the common base of the Objective and Metric classes
+ protected:
+   Registrable() = default;
+   ~Registrable() = default;
+};
+
 class ParamBase {
    const char* const m_sParamName;
 
@@ -21,6 +21,7 @@
 
 #include "Registration.hpp"
 #include "Objective.hpp"
+#include "Metric.hpp"
 
 #include "math.hpp"
 #include "approximate_math.hpp"
@@ -48,6 +49,7 @@ inline Cpu_64_Float Log(const Cpu_64_Float& val) noexcept;
 
 // this is super-special and included inside the zone namespace
 #include "objective_registrations.hpp"
+#include "metric_registrations.hpp"
 
 struct Cpu_64_Int final {
    friend Cpu_64_Float;
@@ -508,15 +510,41 @@ INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateObjective_Cpu_64(const Config* const
    return Objective::CreateObjective<Cpu_64_Float>(pConfig, sObjective, sObjectiveEnd, pObjectiveWrapperOut);
 }
 
-INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateMetric_Cpu_64(
-      const Config* const pConfig, const char* const sMetric, const char* const sMetricEnd
-      //   MetricWrapper * const pMetricWrapperOut,
-) {
-   UNUSED(pConfig);
-   UNUSED(sMetric);
-   UNUSED(sMetricEnd);
+INTERNAL_IMPORT_EXPORT_BODY ErrorEbm CreateMetric_Cpu_64(const Config* const pConfig,
+      const char* const sMetric,
+      const char* const sMetricEnd,
+      MetricWrapper* const pMetricWrapperOut) {
+   MetricFunctionPointersCpp* const pFunctionPointersCpp =
+         reinterpret_cast<MetricFunctionPointersCpp*>(malloc(sizeof(MetricFunctionPointersCpp)));
+   if(nullptr == pFunctionPointersCpp) {
+      return Error_OutOfMemory;
+   }
+   pMetricWrapperOut->m_pFunctionPointersCpp = pFunctionPointersCpp;
+   return Metric::CreateMetric<Cpu_64_Float>(pConfig, sMetric, sMetricEnd, pMetricWrapperOut);
+}
+
+INTERNAL_IMPORT_EXPORT_BODY void AccumulateMetricC(
+      const MetricWrapper* const pMetricWrapper, MetricBridge* const pData) {
+   EBM_ASSERT(nullptr != pMetricWrapper);
+   EBM_ASSERT(nullptr != pData);
+   const Metric* const pMetric = static_cast<const Metric*>(pMetricWrapper->m_pMetric);
+   EBM_ASSERT(nullptr != pMetric);
+   const ACCUMULATE_METRIC_CPP pAccumulateMetricCpp =
+         (static_cast<const MetricFunctionPointersCpp*>(pMetricWrapper->m_pFunctionPointersCpp))
+               ->m_pAccumulateMetricCpp;
+   (*pAccumulateMetricCpp)(pMetric, pData);
+}
 
-   return Error_UnexpectedInternal;
+INTERNAL_IMPORT_EXPORT_BODY double FinishMetricStateC(
+      const MetricWrapper* const pMetricWrapper, const void* const aState) {
+   EBM_ASSERT(nullptr != pMetricWrapper);
+   EBM_ASSERT(nullptr != aState);
+   const Metric* const pMetric = static_cast<const Metric*>(pMetricWrapper->m_pMetric);
+   EBM_ASSERT(nullptr != pMetric);
+   const FINISH_METRIC_STATE_CPP pFinishMetricStateCpp =
+         (static_cast<const MetricFunctionPointersCpp*>(pMetricWrapper->m_pFunctionPointersCpp))
+               ->m_pFinishMetricStateCpp;
+   return (*pFinishMetricStateCpp)(pMetric, aState);
 }
 
 } // namespace DEFINED_ZONE_NAME
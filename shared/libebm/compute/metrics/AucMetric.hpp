@@ -2,4 +2,99 @@
 // Licensed under the MIT license.
 // Author: Paul Koch <code@koch.ninja>
 
-// mirror the format of the Objective classes here
+// !! To add a new metric in C++ follow the steps at the top of the "metric_registrations.hpp" file !!
+
+template<typename TFloat> struct AucMetric : BinaryMetric {
+   // This AUC is approximate and is recomputed from scratch on each validation.  Sorting the validation set on every
+   // boosting step would cost more than applying the update, and an incremental version would not be cheaper since
+   // each step changes the score of nearly every sample, so all of them would need to be re-ranked anyway.  Instead
+   // we drop each sample into one of k_cBuckets equal width buckets between the lowest and highest validation scores,
+   // keeping the total weight of the negative and positive samples per bucket.  Sweeping the buckets from the lowest
+   // score upwards then counts the negative weight ranked below each positive, and pairs that share a bucket are
+   // counted as ties.  The range comes from a first pass over the scores, so scores that cluster together early in
+   // boosting still spread over all of the buckets.  Scores outside of [-k_scoreMax, k_scoreMax] are clipped to it
+   // since their predicted probabilities are within about 1e-7 of 0 or 1, which also keeps a few extreme scores from
+   // widening the buckets.  NaN scores land in the first bucket.
+   //
+   // The result is the exact AUC of the scores after rounding them down to 1/k_cBuckets of their range.  Pairs in
+   // different buckets are ordered correctly, so the only error comes from a positive and a negative that share a
+   // bucket but have different scores.  Those pairs count as 1/2 instead of 0 or 1.  With P_b and N_b the positive
+   // and negative weight in bucket b, and P and N the totals, the error is at most
+   //    0.5 * sum_b(P_b * N_b) / (P * N) <= 0.5 * max_b(N_b) / N
+   // which is half of the largest share of the negative weight that any one bucket holds.  The same bound holds with
+   // the positive weight.  Clipped scores fall into the first or last bucket and are covered by it too.  As an example,
+   // scores spread evenly over their range put about 1/4096 of the weight in each bucket, so the AUC is within about
+   // 1.2e-4 of the exact value.
+   static constexpr size_t k_cBuckets = 4096;
+   static constexpr double k_scoreMax = 16.0;
+
+   // the state starts with [lowest score][highest score][1.0 once any score is seen]
+   static constexpr size_t k_cRangeItems = 3;
+
+   // after the range the state is [negative weight per bucket][positive weight per bucket]
+   METRIC_BOILERPLATE(AucMetric, MAXIMIZE_METRIC, k_cRangeItems + 2 * k_cBuckets)
+
+   static constexpr BoolEbm k_bScoreRange = EBM_TRUE;
+
+   inline AucMetric(const Config& config) { CheckBinaryConfig(config); }
+
+   inline void RangeSample(double* const aState, const double score) const noexcept {
+      double clipped = score;
+      if(!(-k_scoreMax <= clipped)) {
+         if(std::isnan(clipped)) {
+            // NaN scores do not widen the range, and they land in the first bucket
+            return;
+         }
+         clipped = -k_scoreMax;
+      } else if(k_scoreMax < clipped) {
+         clipped = k_scoreMax;
+      }
+      if(0.0 == aState[2]) {
+         aState[0] = clipped;
+         aState[1] = clipped;
+         aState[2] = 1.0;
+      } else if(clipped < aState[0]) {
+         aState[0] = clipped;
+      } else if(aState[1] < clipped) {
+         aState[1] = clipped;
+      }
+   }
+
+   inline void AccumulateSample(
+         double* const aState, const double score, const bool bPositive, const double weight) const noexcept {
+      const double lowest = aState[0];
+      const double range = aState[1] - lowest;
+      // when every score is the same they all tie in the first bucket
+      const double position = 0.0 < range ? (score - lowest) * (static_cast<double>(k_cBuckets) / range) : 0.0;
+      // NaN scores fail both comparisons below and land in the first bucket
+      size_t iBucket = 0;
+      if(static_cast<double>(k_cBuckets) <= position) {
+         iBucket = k_cBuckets - 1;
+      } else if(0.0 < position) {
+         iBucket = static_cast<size_t>(position);
+      }
+      double* const aBuckets = aState + k_cRangeItems;
+      aBuckets[bPositive ? k_cBuckets + iBucket : iBucket] += weight;
+   }
+
+   inline double FinishState(const double* const aState) const noexcept {
+      const double* const aNegatives = aState + k_cRangeItems;
+      const double* const aPositives = aNegatives + k_cBuckets;
+
+      double negativesBelow = 0.0;
+      double positivesTotal = 0.0;
+      double area = 0.0;
+      for(size_t iBucket = 0; iBucket < k_cBuckets; ++iBucket) {
+         const double negatives = aNegatives[iBucket];
+         const double positives = aPositives[iBucket];
+         area += positives * (negativesBelow + 0.5 * negatives);
+         negativesBelow += negatives;
+         positivesTotal += positives;
+      }
+      if(0.0 == negativesBelow || 0.0 == positivesTotal) {
+         // with a single class in the validation set every ordering is equally good
+         return 0.5;
+      }
+      return area / (negativesBelow * positivesTotal);
+   }
+};
@@ -0,0 +1,31 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !! To add a new metric in C++ follow the steps at the top of the "metric_registrations.hpp" file !!
+
+template<typename TFloat> struct LogLossMetric : BinaryMetric {
+   // the state is [weighted log loss sum][weight sum]
+   METRIC_BOILERPLATE(LogLossMetric, MINIMIZE_METRIC, 2)
+
+   inline LogLossMetric(const Config& config) {
+      CheckBinaryConfig(config);
+      if(Link_logit != config.linkFunction) {
+         // the score must be a logit to turn it into a probability
+         throw ParamMismatchWithConfigException();
+      }
+   }
+
+   inline void AccumulateSample(
+         double* const aState, const double score, const bool bPositive, const double weight) const noexcept {
+      // -log(sigmoid(+-score)) written as softplus(-+score), which does not overflow for large scores
+      const double x = bPositive ? -score : score;
+      const double loss = 0.0 < x ? x + std::log1p(std::exp(-x)) : std::log1p(std::exp(x));
+      aState[0] += weight * loss;
+      aState[1] += weight;
+   }
+
+   inline double FinishState(const double* const aState) const noexcept {
+      return 0.0 < aState[1] ? aState[0] / aState[1] : 0.0;
+   }
+};
@@ -0,0 +1,23 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !! To add a new metric in C++ follow the steps at the top of the "metric_registrations.hpp" file !!
+
+template<typename TFloat> struct MaeMetric : RegressionMetric {
+   // the state is [weighted absolute error sum][weight sum]
+   METRIC_BOILERPLATE(MaeMetric, MINIMIZE_METRIC, 2)
+
+   LinkEbm m_linkFunction;
+
+   inline MaeMetric(const Config& config) { m_linkFunction = CheckRegressionConfig(config); }
+
+   inline void AccumulateSample(double* const aState, const double error, const double weight) const noexcept {
+      aState[0] += weight * std::abs(error);
+      aState[1] += weight;
+   }
+
+   inline double FinishState(const double* const aState) const noexcept {
+      return 0.0 < aState[1] ? aState[0] / aState[1] : 0.0;
+   }
+};
@@ -0,0 +1,38 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !! To add a new metric in C++ follow the steps at the top of the "metric_registrations.hpp" file !!
+
+template<typename TFloat> struct PinballMetric : RegressionMetric {
+   // The pinball (quantile) loss of the alpha quantile.  Predictions below the target cost alpha per unit of error
+   // and predictions above it cost 1 - alpha, so alpha = 0.5 gives half the MAE.
+   // the state is [weighted pinball loss sum][weight sum]
+   METRIC_BOILERPLATE(PinballMetric, MINIMIZE_METRIC, 2)
+
+   LinkEbm m_linkFunction;
+   double m_alpha;
+
+   // The constructor parameters following config must match the RegisterMetric parameters in
+   // metric_registrations.hpp
+   inline PinballMetric(const Config& config, const double alpha) {
+      m_linkFunction = CheckRegressionConfig(config);
+
+      // the negated comparison also rejects NaN
+      if(!(0.0 < alpha && alpha < 1.0)) {
+         throw ParamValOutOfRangeException();
+      }
+      m_alpha = alpha;
+   }
+
+   inline void AccumulateSample(double* const aState, const double error, const double weight) const noexcept {
+      // error is the prediction minus the target
+      const double loss = error < 0.0 ? -m_alpha * error : (1.0 - m_alpha) * error;
+      aState[0] += weight * loss;
+      aState[1] += weight;
+   }
+
+   inline double FinishState(const double* const aState) const noexcept {
+      return 0.0 < aState[1] ? aState[0] / aState[1] : 0.0;
+   }
+};
@@ -0,0 +1,23 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !! To add a new metric in C++ follow the steps at the top of the "metric_registrations.hpp" file !!
+
+template<typename TFloat> struct RmseMetric : RegressionMetric {
+   // the state is [weighted squared error sum][weight sum]
+   METRIC_BOILERPLATE(RmseMetric, MINIMIZE_METRIC, 2)
+
+   LinkEbm m_linkFunction;
+
+   inline RmseMetric(const Config& config) { m_linkFunction = CheckRegressionConfig(config); }
+
+   inline void AccumulateSample(double* const aState, const double error, const double weight) const noexcept {
+      aState[0] += weight * error * error;
+      aState[1] += weight;
+   }
+
+   inline double FinishState(const double* const aState) const noexcept {
+      return 0.0 < aState[1] ? std::sqrt(aState[0] / aState[1]) : 0.0;
+   }
+};
@@ -0,0 +1,34 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// Steps for adding a new metric in C++:
+//   1) Copy one of the existing "*Metric.hpp" include files into a newly renamed "*Metric.hpp" file.
+//      Binary metrics inherit from BinaryMetric and regression metrics from RegressionMetric.
+//   2) Change the name of the class and the constructor name to fit the new metric.
+//   3) Update the parameters to the METRIC_BOILERPLATE macro for the new metric.  The last parameter is the number
+//      of doubles of state that AccumulateSample sums over the validation samples.
+//   4) Modify AccumulateSample to accumulate the new metric, and FinishState to turn the state into the metric.
+//   5) Add [#include "*Metric.hpp"] to the list of other include files right below this guide.
+//   6) Add the new Metric type to the list of metric registrations in the RegisterMetrics() function below, with
+//      the list of optional public parameters needed for the new Metric class.  Metrics only run in the CPU zone.
+//   7) Recompile the C++ with either build.sh or build.bat depending on the operating system.
+
+// Add new "*Metric.hpp" include files here:
+#include "AucMetric.hpp"
+#include "LogLossMetric.hpp"
+#include "RmseMetric.hpp"
+#include "MaeMetric.hpp"
+#include "PinballMetric.hpp"
+
+// Add new *Metric type registrations to this list:
+template<typename TFloat> static const std::vector<std::shared_ptr<const Registration>> RegisterMetrics() {
+   // IMPORTANT: the parameter types listed here must match the parameters types in the Metric class constructor
+   return {
+         Register<TFloat, AucMetric, AccelerationFlags_NONE>("auc"),
+         Register<TFloat, LogLossMetric, AccelerationFlags_NONE>("log_loss"),
+         Register<TFloat, RmseMetric, AccelerationFlags_NONE>("rmse"),
+         Register<TFloat, MaeMetric, AccelerationFlags_NONE>("mae"),
+         Register<TFloat, PinballMetric, AccelerationFlags_NONE>("pinball", FloatParam("alpha", 0.5)),
+   };
+}
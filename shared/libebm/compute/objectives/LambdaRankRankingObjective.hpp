@@ -0,0 +1,282 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// !! To add a new objective in C++ follow the steps at the top of the "objective_registrations.hpp" file !!
+
+// Do not use this file as a reference for other objectives. LambdaRank is pairwise within each query.
+
+// TFloat could be double, float, or some SIMD intrinsic type
+template<typename TFloat> struct LambdaRankRankingObjective : RankingObjective {
+   // LambdaRank gradients depend on every document in a query, so we cannot use the per-sample CalcGradientHessian
+   // functions that the other objectives have.  DataSetBoosting keeps every query inside a single subset and stores
+   // the targets as [normalized gain][query size] where the normalized gain of each document is
+   // (2^relevance - 1) / IDCG and the query size is repeated for every document of the query.  The queries are
+   // contiguous, so after updating the scores we walk them one at a time.  The documents of a query are ranked by
+   // their current scores and each pair of documents with different relevance contributes a RankNet gradient weighted
+   // by the change in NDCG that swapping the pair would cause.  This objective is registered for the CPU zone only.
+   // The metric is the sum over queries of (1 - NDCG) weighted by the number of documents, or their total weight,
+   // which after dividing by the total weight of the documents is the weighted average of 1 - NDCG.
+
+   OBJECTIVE_CONSTANTS_BOILERPLATE(LambdaRankRankingObjective,
+         MINIMIZE_METRIC,
+         Link_custom_ranking,
+         true,
+         false,
+         k_cItemsPerBitPackUndefined,
+         k_cItemsPerBitPackUndefined)
+
+   double m_sigma;
+
+   // The constructor parameters following config must match the RegisterObjective parameters in
+   // objective_registrations.hpp
+   inline LambdaRankRankingObjective(const Config& config, const double sigma) {
+      if(config.cOutputs != 1) {
+         throw ParamMismatchWithConfigException();
+      }
+
+      if(config.isDifferentialPrivacy) {
+         throw NonPrivateRegistrationException();
+      }
+
+      if(std::isnan(sigma) || sigma <= 0.0 || std::isinf(sigma)) {
+         throw ParamValOutOfRangeException();
+      }
+
+      m_sigma = sigma;
+   }
+
+   inline bool CheckRankingTarget(const double target) const noexcept {
+      // the gain 2^relevance - 1 loses its integer precision in float32 above 2^24, so cap the relevance well below
+      return std::isnan(target) || std::isinf(target) || target < 0.0 || 31.0 < target;
+   }
+
+   inline double LinkParam() const noexcept { return std::numeric_limits<double>::quiet_NaN(); }
+
+   inline double LearningRateAdjustmentDifferentialPrivacy() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double LearningRateAdjustmentGradientBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double LearningRateAdjustmentHessianBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GainAdjustmentGradientBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GainAdjustmentHessianBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GradientConstant() const noexcept { return 1.0; }
+
+   inline double HessianConstant() const noexcept { return 1.0; }
+
+   inline double FinishMetric(const double metricSum) const noexcept { return metricSum; }
+
+   template<bool bCollapsed,
+         bool bValidation,
+         bool bWeight,
+         bool bHessian,
+         bool bDisableApprox,
+         size_t cCompilerScores,
+         int cCompilerPack>
+   GPU_DEVICE NEVER_INLINE void InjectedApplyUpdate(ApplyUpdateBridge* const pData) const {
+      static_assert(k_oneScore == cCompilerScores, "LambdaRank has one score per document");
+      static_assert(1 == TFloat::k_cSIMDPack, "LambdaRank is only registered for the CPU zone");
+      static_assert(!bValidation || !bHessian, "bHessian can only be true if bValidation is false");
+      static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
+      static_assert(!bDisableApprox, "Approximations cannot be disabled on LambdaRank since there are none");
+
+      static_assert(k_cItemsPerBitPackUndefined == cCompilerPack, "The CPU zone does not specialize the bit packing");
+
+#ifndef GPU_COMPILE
+      EBM_ASSERT(nullptr != pData);
+      EBM_ASSERT(nullptr != pData->m_aUpdateTensorScores);
+      EBM_ASSERT(1 <= pData->m_cSamples);
+      EBM_ASSERT(nullptr != pData->m_aSampleScores);
+      EBM_ASSERT(1 == pData->m_cScores);
+      EBM_ASSERT(nullptr != pData->m_aTargets);
+      EBM_ASSERT(nullptr != pData->m_aMulticlassMidwayTemp);
+#endif // GPU_COMPILE
+
+      using T = typename TFloat::T;
+      using TUInt = typename TFloat::TInt::T;
+      static_assert(sizeof(T) == sizeof(TUInt), "the query sizes are stored right after the gains");
+
+      const T* const aUpdateTensorScores = reinterpret_cast<const T*>(pData->m_aUpdateTensorScores);
+
+      const size_t cSamples = pData->m_cSamples;
+
+      T* const aSampleScores = reinterpret_cast<T*>(pData->m_aSampleScores);
+      T* pSampleScore = aSampleScores;
+      const T* const pSampleScoresEnd = pSampleScore + cSamples;
+
+      // first update all the scores in the subset, which is the same loop that the single score objectives use
+      if(bCollapsed) {
+         const T updateScore = aUpdateTensorScores[0];
+         do {
+            *pSampleScore += updateScore;
+            ++pSampleScore;
+         } while(pSampleScoresEnd != pSampleScore);
+      } else {
+         const int cItemsPerBitPack = GET_ITEMS_PER_BIT_PACK(cCompilerPack, pData->m_cPack);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(1 <= cItemsPerBitPack);
+         EBM_ASSERT(cItemsPerBitPack <= COUNT_BITS(TUInt));
+#endif // GPU_COMPILE
+
+         const int cBitsPerItemMax = GetCountBits<TUInt>(cItemsPerBitPack);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(1 <= cBitsPerItemMax);
+         EBM_ASSERT(cBitsPerItemMax <= COUNT_BITS(TUInt));
+#endif // GPU_COMPILE
+
+         const TUInt maskBits = MakeLowMask<TUInt>(cBitsPerItemMax);
+
+         const TUInt* pInputData = reinterpret_cast<const TUInt*>(pData->m_aPacked);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(nullptr != pInputData);
+#endif // GPU_COMPILE
+
+         const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+         int cShift = static_cast<int>(cSamples % static_cast<size_t>(cItemsPerBitPack)) * cBitsPerItemMax;
+         T updateScore = aUpdateTensorScores[static_cast<size_t>((*pInputData >> cShift) & maskBits)];
+         cShift -= cBitsPerItemMax;
+         if(cShift < 0) {
+            cShift = cShiftReset;
+            ++pInputData;
+         }
+         do {
+            const TUInt iTensorBinCombined = *pInputData;
+            ++pInputData;
+            while(true) {
+               const size_t iTensorBin = static_cast<size_t>((iTensorBinCombined >> cShift) & maskBits);
+               *pSampleScore += updateScore;
+               ++pSampleScore;
+               updateScore = aUpdateTensorScores[iTensorBin];
+
+               cShift -= cBitsPerItemMax;
+               if(cShift < 0) {
+                  break;
+               }
+            }
+            cShift = cShiftReset;
+         } while(pSampleScoresEnd != pSampleScore);
+      }
+
+      const T* const aGains = reinterpret_cast<const T*>(pData->m_aTargets);
+      const TUInt* const aQuerySamples = reinterpret_cast<const TUInt*>(aGains + cSamples);
+
+      // the discount 1 / log2(2 + rank) of each document in the query being processed
+      T* const aDiscounts = reinterpret_cast<T*>(pData->m_aMulticlassMidwayTemp);
+
+      const T sigma = static_cast<T>(m_sigma);
+
+      const T* pWeight;
+      double metricSum;
+      T* pGradientAndHessian;
+      if(bValidation) {
+         if(bWeight) {
+            pWeight = reinterpret_cast<const T*>(pData->m_aWeights);
+#ifndef GPU_COMPILE
+            EBM_ASSERT(nullptr != pWeight);
+#endif // GPU_COMPILE
+         }
+         metricSum = 0.0;
+      } else {
+         pGradientAndHessian = reinterpret_cast<T*>(pData->m_aGradientsAndHessians);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(nullptr != pGradientAndHessian);
+#endif // GPU_COMPILE
+      }
+
+      static constexpr size_t cStride = bHessian ? size_t{2} : size_t{1};
+
+      size_t iQueryFirst = 0;
+      do {
+         const size_t cQuerySamples = static_cast<size_t>(aQuerySamples[iQueryFirst]);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(1 <= cQuerySamples);
+         EBM_ASSERT(cQuerySamples <= cSamples - iQueryFirst);
+#endif // GPU_COMPILE
+
+         const T* const aQueryScores = &aSampleScores[iQueryFirst];
+         const T* const aQueryGains = &aGains[iQueryFirst];
+
+         // ties are broken by document order so that equal scores still give a permutation of the ranks
+         for(size_t i = 0; i < cQuerySamples; ++i) {
+            const T score = aQueryScores[i];
+            size_t iRank = 0;
+            for(size_t j = 0; j < cQuerySamples; ++j) {
+               const T other = aQueryScores[j];
+               if(score < other || (score == other && j < i)) {
+                  ++iRank;
+               }
+            }
+            aDiscounts[i] = static_cast<T>(1.0 / std::log2(static_cast<double>(iRank + 2)));
+         }
+
+         if(bValidation) {
+            double dcg = 0.0;
+            bool bRelevant = false;
+            double weightQuery = 0.0;
+            for(size_t i = 0; i < cQuerySamples; ++i) {
+               dcg += static_cast<double>(aQueryGains[i]) * static_cast<double>(aDiscounts[i]);
+               bRelevant = bRelevant || T{0} != aQueryGains[i];
+               if(bWeight) {
+                  weightQuery += static_cast<double>(*pWeight);
+                  ++pWeight;
+               }
+            }
+            if(!bWeight) {
+               weightQuery = static_cast<double>(cQuerySamples);
+            }
+            // a query without any relevant documents is ranked perfectly by any ordering
+            if(bRelevant) {
+               metricSum += weightQuery * (1.0 - dcg);
+            }
+         } else {
+            T* const aQueryGradHess = pGradientAndHessian;
+            for(size_t i = 0; i < cStride * cQuerySamples; ++i) {
+               aQueryGradHess[i] = T{0};
+            }
+            for(size_t i = 0; i < cQuerySamples; ++i) {
+               for(size_t j = i + 1; j < cQuerySamples; ++j) {
+                  const T gainI = aQueryGains[i];
+                  const T gainJ = aQueryGains[j];
+                  if(gainI == gainJ) {
+                     continue;
+                  }
+                  const size_t iHigh = gainJ < gainI ? i : j;
+                  const size_t iLow = gainJ < gainI ? j : i;
+
+                  const T deltaNdcg = std::abs(gainI - gainJ) * std::abs(aDiscounts[i] - aDiscounts[j]);
+                  const T rho = T{1} / (T{1} + std::exp(sigma * (aQueryScores[iHigh] - aQueryScores[iLow])));
+
+                  const T lambda = sigma * rho * deltaNdcg;
+                  aQueryGradHess[cStride * iHigh] -= lambda;
+                  aQueryGradHess[cStride * iLow] += lambda;
+                  if(bHessian) {
+                     const T hessian = sigma * sigma * rho * (T{1} - rho) * deltaNdcg;
+                     aQueryGradHess[cStride * iHigh + 1] += hessian;
+                     aQueryGradHess[cStride * iLow + 1] += hessian;
+                  }
+               }
+            }
+            pGradientAndHessian += cStride * cQuerySamples;
+         }
+
+         iQueryFirst += cQuerySamples;
+      } while(cSamples != iQueryFirst);
+
+      if(bValidation) {
+         pData->m_metricOut += metricSum;
+      }
+   }
+};
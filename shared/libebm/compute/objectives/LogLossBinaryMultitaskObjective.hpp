@@ -4,11 +4,306 @@
 
 // !! To add a new objective in C++ follow the steps at the top of the "objective_registrations.hpp" file !!
 
+// Do not use this file as a reference for other objectives. LogLoss is special.
+
 // TFloat could be double, float, or some SIMD intrinsic type
 template<typename TFloat> struct LogLossBinaryMultitaskObjective : BinaryMultitaskObjective {
    // this one would more popularily be called LogLossMultilabelObjective.  We're currently calling this
    // LogLossBinaryMultitaskObjective since it fits better into our ontology of Multitask* types having
    // multiple targets, but consider chaning this to multilabel since it would be more widely recognized that way
 
-   // this one needs to be special cased!
+   // Each target gets its own logit, so the tensors hold cTargets scores per cell, exactly like multiclass holds
+   // cClasses scores per cell.  Unlike multiclass the scores do not interact, so each score gets the binary log loss
+   // gradient and hessian of its own target.  The targets are stored per SIMD pack as [target][lane], the same
+   // way the sample scores are stored.  The metric is the sum of the per-target log losses.
+
+   OBJECTIVE_CONSTANTS_BOILERPLATE(LogLossBinaryMultitaskObjective,
+         MINIMIZE_METRIC,
+         Link_logit,
+         true,
+         true,
+         k_cItemsPerBitPackUndefined,
+         k_cItemsPerBitPackUndefined)
+
+   inline LogLossBinaryMultitaskObjective(const Config& config) {
+      if(1 == config.cTargets) {
+         // we share the tag "log_loss" with single target binary and multiclass classification
+         throw SkipRegistrationException();
+      }
+
+      if(config.cOutputs != config.cTargets) {
+         throw ParamMismatchWithConfigException();
+      }
+   }
+
+   inline double LinkParam() const noexcept { return std::numeric_limits<double>::quiet_NaN(); }
+
+   inline double LearningRateAdjustmentDifferentialPrivacy() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double LearningRateAdjustmentGradientBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double LearningRateAdjustmentHessianBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GainAdjustmentGradientBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GainAdjustmentHessianBoosting() const noexcept {
+      return 1.0; // typically leave this at 1.0 (unmodified)
+   }
+
+   inline double GradientConstant() const noexcept { return 1.0; }
+
+   inline double HessianConstant() const noexcept { return 1.0; }
+
+   inline double FinishMetric(const double metricSum) const noexcept { return metricSum; }
+
+   GPU_DEVICE inline TFloat CalcMetric(const TFloat& score, const TFloat& target) const noexcept {
+      // This function is here to signal the LogLossBinaryMultitaskObjective class abilities, but it will not be called
+      UNUSED(score);
+      UNUSED(target);
+   }
+
+   GPU_DEVICE inline TFloat CalcGradient(const TFloat& score, const TFloat& target) const noexcept {
+      // This function is here to signal the LogLossBinaryMultitaskObjective class abilities, but it will not be called
+      UNUSED(score);
+      UNUSED(target);
+   }
+
+   GPU_DEVICE inline GradientHessian<TFloat> CalcGradientHessian(
+         const TFloat& score, const TFloat& target) const noexcept {
+      // This function is here to signal the LogLossBinaryMultitaskObjective class abilities, but it will not be called
+      UNUSED(score);
+      UNUSED(target);
+   }
+
+   template<bool bCollapsed,
+         bool bValidation,
+         bool bWeight,
+         bool bHessian,
+         bool bDisableApprox,
+         size_t cCompilerScores,
+         int cCompilerPack>
+   GPU_DEVICE NEVER_INLINE void InjectedApplyUpdate(ApplyUpdateBridge* const pData) const {
+      static_assert(k_dynamicScores == cCompilerScores || 2 <= cCompilerScores, "Multitask needs more than 1 score");
+      static_assert(!bValidation || !bHessian, "bHessian can only be true if bValidation is false");
+      static_assert(bValidation || !bWeight, "bWeight can only be true if bValidation is true");
+
+      static constexpr bool bFixedSizePack = k_cItemsPerBitPackUndefined != cCompilerPack;
+
+#ifndef GPU_COMPILE
+      EBM_ASSERT(nullptr != pData);
+      EBM_ASSERT(nullptr != pData->m_aUpdateTensorScores);
+      EBM_ASSERT(1 <= pData->m_cSamples);
+      EBM_ASSERT(0 == pData->m_cSamples % size_t{TFloat::k_cSIMDPack});
+      EBM_ASSERT(0 == pData->m_cSamples % size_t{(bFixedSizePack ? cCompilerPack : 1) * TFloat::k_cSIMDPack});
+      EBM_ASSERT(nullptr != pData->m_aSampleScores);
+      EBM_ASSERT(2 <= pData->m_cScores);
+      EBM_ASSERT(k_dynamicScores == cCompilerScores || cCompilerScores == pData->m_cScores);
+      EBM_ASSERT(nullptr != pData->m_aTargets);
+#endif // GPU_COMPILE
+
+      const size_t cScores = GET_COUNT_SCORES(cCompilerScores, pData->m_cScores);
+
+      const typename TFloat::T* const aUpdateTensorScores =
+            reinterpret_cast<const typename TFloat::T*>(pData->m_aUpdateTensorScores);
+
+      const size_t cSamples = pData->m_cSamples;
+
+      typename TFloat::T* pSampleScore = reinterpret_cast<typename TFloat::T*>(pData->m_aSampleScores);
+      const typename TFloat::T* const pSampleScoresEnd = pSampleScore + cSamples * cScores;
+
+      int cBitsPerItemMax;
+      int cShift;
+      int cShiftReset;
+      typename TFloat::TInt maskBits;
+      const typename TFloat::TInt::T* pInputData;
+      typename TFloat::TInt::T cCastScores;
+      typename TFloat::TInt iTensorBin;
+
+      if(!bCollapsed) {
+         const int cItemsPerBitPack = GET_ITEMS_PER_BIT_PACK(cCompilerPack, pData->m_cPack);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(1 <= cItemsPerBitPack);
+         EBM_ASSERT(cItemsPerBitPack <= COUNT_BITS(typename TFloat::TInt::T));
+#endif // GPU_COMPILE
+
+         cBitsPerItemMax = GetCountBits<typename TFloat::TInt::T>(cItemsPerBitPack);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(1 <= cBitsPerItemMax);
+         EBM_ASSERT(cBitsPerItemMax <= COUNT_BITS(typename TFloat::TInt::T));
+#endif // GPU_COMPILE
+
+         maskBits = MakeLowMask<typename TFloat::TInt::T>(cBitsPerItemMax);
+
+         pInputData = reinterpret_cast<const typename TFloat::TInt::T*>(pData->m_aPacked);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(nullptr != pInputData);
+#endif // GPU_COMPILE
+
+         cCastScores = static_cast<typename TFloat::TInt::T>(cScores);
+
+         cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+         if(bFixedSizePack) {
+            iTensorBin = TFloat::TInt::Load(pInputData) & maskBits;
+
+            iTensorBin = Multiply < typename TFloat::TInt, typename TFloat::TInt::T,
+            k_dynamicScores != cCompilerScores && 1 != TFloat::k_cSIMDPack,
+            static_cast<typename TFloat::TInt::T>(cCompilerScores) > (iTensorBin, cCastScores);
+
+            pInputData += TFloat::TInt::k_cSIMDPack;
+         } else {
+            cShift = static_cast<int>((cSamples >> TFloat::k_cSIMDShift) % static_cast<size_t>(cItemsPerBitPack)) *
+                  cBitsPerItemMax;
+            iTensorBin = (TFloat::TInt::Load(pInputData) >> cShift) & maskBits;
+
+            iTensorBin = Multiply < typename TFloat::TInt, typename TFloat::TInt::T,
+            k_dynamicScores != cCompilerScores && 1 != TFloat::k_cSIMDPack,
+            static_cast<typename TFloat::TInt::T>(cCompilerScores) > (iTensorBin, cCastScores);
+
+            cShift -= cBitsPerItemMax;
+            if(cShift < 0) {
+               cShift = cShiftReset;
+               pInputData += TFloat::TInt::k_cSIMDPack;
+            }
+         }
+      }
+
+      const typename TFloat::TInt::T* pTargetData =
+            reinterpret_cast<const typename TFloat::TInt::T*>(pData->m_aTargets);
+
+      const typename TFloat::T* pWeight;
+      TFloat metricSum;
+      typename TFloat::T* pGradientAndHessian;
+      if(bValidation) {
+         if(bWeight) {
+            pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
+#ifndef GPU_COMPILE
+            EBM_ASSERT(nullptr != pWeight);
+#endif // GPU_COMPILE
+         }
+         metricSum = 0.0;
+      } else {
+         pGradientAndHessian = reinterpret_cast<typename TFloat::T*>(pData->m_aGradientsAndHessians);
+#ifndef GPU_COMPILE
+         EBM_ASSERT(nullptr != pGradientAndHessian);
+#endif // GPU_COMPILE
+      }
+      do {
+         typename TFloat::TInt iTensorBinCombined;
+         if(!bCollapsed) {
+            iTensorBinCombined = TFloat::TInt::Load(pInputData);
+            pInputData += TFloat::TInt::k_cSIMDPack;
+         }
+         if(bFixedSizePack) {
+            // If we have a fixed sized cCompilerPack then the compiler should be able to unroll
+            // the loop below. The compiler can only do that though if it can guarantee that all
+            // iterations of the loop have the name number of loops.  Setting cShift here allows this
+            cShift = cShiftReset;
+         }
+         while(true) {
+            // the bin index was unpacked once above and is shared by all the targets of these samples
+
+            TFloat sampleMetric;
+            if(bValidation) {
+               sampleMetric = 0.0;
+            }
+
+            size_t iScore = 0;
+            do {
+               TFloat updateScore;
+               if(!bCollapsed) {
+                  updateScore = TFloat::Load(aUpdateTensorScores, iTensorBin);
+                  iTensorBin = iTensorBin + 1;
+               } else {
+                  updateScore = aUpdateTensorScores[iScore];
+               }
+
+               TFloat sampleScore = TFloat::Load(pSampleScore);
+               sampleScore += updateScore;
+               sampleScore.Store(pSampleScore);
+               pSampleScore += TFloat::k_cSIMDPack;
+
+               const typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
+               pTargetData += TFloat::TInt::k_cSIMDPack;
+
+               if(bValidation) {
+                  // see LogLossBinaryObjective for the derivation of the metric, gradient, and hessian below
+                  TFloat metric = IfThenElse(typename TFloat::TInt(0) == target, sampleScore, -sampleScore);
+                  metric = TFloat::template ApproxExp<bDisableApprox, false>(metric);
+                  metric += 1.0;
+                  // zero and negative are impossible since 1.0 is the lowest possible value
+                  metric = TFloat::template ApproxLog<bDisableApprox, false, true, false, false>(metric);
+                  sampleMetric += metric;
+               } else {
+                  auto cmp = typename TFloat::TInt(0) == target;
+                  const TFloat numerator = IfThenElse(cmp, TFloat(1), TFloat(-1));
+                  TFloat denominator = IfThenElse(cmp, -sampleScore, sampleScore);
+                  denominator = TFloat::template ApproxExp<bDisableApprox, false>(denominator);
+                  denominator += 1.0;
+
+                  const TFloat gradient = FastApproxDivide(numerator, denominator);
+
+                  if(bHessian) {
+                     const TFloat hessian = FusedNegateMultiplyAdd(gradient, gradient, Abs(gradient));
+
+                     gradient.Store(pGradientAndHessian);
+                     hessian.Store(pGradientAndHessian + TFloat::k_cSIMDPack);
+                     pGradientAndHessian += TFloat::k_cSIMDPack + TFloat::k_cSIMDPack;
+                  } else {
+                     gradient.Store(pGradientAndHessian);
+                     pGradientAndHessian += TFloat::k_cSIMDPack;
+                  }
+               }
+
+               ++iScore;
+            } while(cScores != iScore);
+
+            if(bValidation) {
+               if(bWeight) {
+                  const TFloat weight = TFloat::Load(pWeight);
+                  pWeight += TFloat::k_cSIMDPack;
+                  metricSum = FusedMultiplyAdd(sampleMetric, weight, metricSum);
+               } else {
+                  metricSum += sampleMetric;
+               }
+            }
+
+            if(!bCollapsed) {
+               iTensorBin = (iTensorBinCombined >> cShift) & maskBits;
+
+               iTensorBin = Multiply < typename TFloat::TInt, typename TFloat::TInt::T,
+               k_dynamicScores != cCompilerScores && 1 != TFloat::k_cSIMDPack,
+               static_cast<typename TFloat::TInt::T>(cCompilerScores) > (iTensorBin, cCastScores);
+            }
+
+            if(bCollapsed) {
+               if(pSampleScoresEnd == pSampleScore) {
+                  break;
+               }
+            } else {
+               cShift -= cBitsPerItemMax;
+               if(cShift < 0) {
+                  break;
+               }
+            }
+         }
+         if(bCollapsed) {
+            break;
+         }
+         if(!bFixedSizePack) {
+            cShift = cShiftReset;
+         }
+      } while(pSampleScoresEnd != pSampleScore);
+
+      if(bValidation) {
+         pData->m_metricOut += static_cast<double>(Sum(metricSum));
+      }
+   }
 };
@@ -148,6 +148,8 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
       const typename TFloat::T* pWeight;
       TFloat metricSum;
       typename TFloat::T* pGradientAndHessian;
+      // false when SetValidationMetric chose another metric, which leaves only the scores to update
+      const bool bMetric = bValidation && EBM_FALSE != pData->m_bMetricNeeded;
       if(bValidation) {
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
@@ -211,7 +213,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
             sampleScore.Store(pSampleScore);
             pSampleScore += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetric) {
                // TODO: similar to the gradient calculation above, once we sort our data by the target values we
                //       will be able to pass all the targets==0 and target==1 in to a single call to this function
                //       and we can therefore template the target value.  We can then call ExpForBinaryClassification
@@ -229,7 +231,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
                } else {
                   metricSum += metric;
                }
-            } else {
+            } else if(!bValidation) {
                // gradient will be 0.0 if we perfectly predict the target with 100% certainty.
                //    To do so, sampleScore would need to be either +infinity or -infinity
                // gradient will be +1.0 if actual value was 1 but we incorrectly predicted with
@@ -368,7 +370,7 @@ template<typename TFloat> struct LogLossBinaryObjective : BinaryObjective {
          }
       } while(pSampleScoresEnd != pSampleScore);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
@@ -23,6 +23,11 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
          throw SkipRegistrationException();
       }
 
+      if(1 != config.cTargets) {
+         // we share the tag "log_loss" with multitask binary classification
+         throw SkipRegistrationException();
+      }
+
       if(config.cOutputs <= 0) {
          throw ParamMismatchWithConfigException();
       }
@@ -109,14 +114,30 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
       EBM_ASSERT(nullptr != pData->m_aSampleScores);
       EBM_ASSERT(2 <= pData->m_cScores);
       EBM_ASSERT(k_dynamicScores == cCompilerScores || cCompilerScores == pData->m_cScores);
-      EBM_ASSERT(nullptr != pData->m_aMulticlassMidwayTemp);
       EBM_ASSERT(nullptr != pData->m_aTargets);
 #endif // GPU_COMPILE
 
+      // Each exp is needed twice, once for the sum and once when normalizing.  With a compile time number of classes
+      // they are kept in aLocalExpVector.  With a runtime number of classes there can be hundreds of them, so during
+      // training each exp is written directly into the gradient slot of its class and then normalized in place.
+      //
+      // The target class needs its exp for the metric and has 1 subtracted from its gradient.  We can do that with
+      // a gathered load and a scattered store at the target index, which costs about one operation per SIMD lane,
+      // or we can compare and select on every class as it goes by, which keeps everything in registers but costs
+      // about one operation per class.  AVX-512 compares into mask registers and has 16 lanes, so selecting was
+      // faster there in the ApplyUpdate benchmark for 3 to 16 classes.  With 8 or fewer lanes the indexed version
+      // was as fast or faster, so we keep it for those zones during training.  Validation with a runtime number of
+      // classes always selects since the gathered load would need every exp kept in memory, and there is no
+      // gradient slot to hold them when validating.
+      //
+      // There is no single pass version.  The exps can only be normalized once their sum is known, so a second
+      // pass is needed whether the exps are held in registers or memory.  With a compile time number of classes the
+      // loops are unrolled and aLocalExpVector lives in registers, so the second pass does not touch memory.
+      static constexpr bool bSelectTarget = 16 <= TFloat::k_cSIMDPack;
+      static constexpr bool bSelectTargetExp = bSelectTarget || bDynamic;
+
       alignas(alignof(TFloat))
             typename TFloat::T aLocalExpVector[bDynamic ? size_t{1} : (cCompilerScores * size_t{TFloat::k_cSIMDPack})];
-      typename TFloat::T* const aExps =
-            bDynamic ? reinterpret_cast<typename TFloat::T*>(pData->m_aMulticlassMidwayTemp) : aLocalExpVector;
 
       const size_t cScores = GET_COUNT_SCORES(cCompilerScores, pData->m_cScores);
 
@@ -228,7 +249,15 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
             // Probably we want to put the code below inside the loop into an inline function that we can call
             // either at the start during init or the end once the rest is done.. not sure which.
 
+            typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
+            pTargetData += TFloat::TInt::k_cSIMDPack;
+
             TFloat sumExp = 0.0;
+            TFloat targetExp;
+            if(bValidation && bSelectTargetExp) {
+               targetExp = 0.0;
+            }
+            typename TFloat::TInt iClass = 0;
             size_t iScore1 = 0;
             do {
                TFloat updateScore;
@@ -246,28 +275,30 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
                pSampleScore += TFloat::k_cSIMDPack;
 
                const TFloat oneExp = TFloat::template ApproxExp<bDisableApprox, false>(sampleScore);
-               oneExp.Store(&aExps[iScore1 << TFloat::k_cSIMDShift]);
+               if(bValidation && bSelectTargetExp) {
+                  targetExp = IfThenElse(target == iClass, oneExp, targetExp);
+                  iClass = iClass + 1;
+               } else if(!bValidation && bDynamic) {
+                  oneExp.Store(&pGradientAndHessian[iScore1
+                        << (bHessian ? (TFloat::k_cSIMDShift + 1) : TFloat::k_cSIMDShift)]);
+               } else {
+                  oneExp.Store(&aLocalExpVector[iScore1 << TFloat::k_cSIMDShift]);
+               }
                sumExp += oneExp;
 
                ++iScore1;
             } while(cScores != iScore1);
 
-            typename TFloat::TInt target = TFloat::TInt::Load(pTargetData);
-            pTargetData += TFloat::TInt::k_cSIMDPack;
-
             if(bValidation) {
-               // TODO: instead of writing the exp values to memory, since we just need 1 and the sum,
-               // we could use an if selector to keep only the one that matches our target and we don't need
-               // to store (or re-load) from memory.  This also saves us a gathering load, which will be expensive
-               // in latency
-
-               target = target << TFloat::k_cSIMDShift;
-               target = target + TFloat::TInt::MakeIndexes();
-
-               // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
-               // identical, so instead of calling LoadScattered we'll be able to call LoadAligned
-               const TFloat itemExp = TFloat::Load(aExps, target);
-               const TFloat invertedProbability = FastApproxDivide(sumExp, itemExp);
+               if(!bSelectTargetExp) {
+                  target = target << TFloat::k_cSIMDShift;
+                  target = target + TFloat::TInt::MakeIndexes();
+
+                  // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
+                  // identical, so instead of calling LoadScattered we'll be able to call LoadAligned
+                  targetExp = TFloat::Load(aLocalExpVector, target);
+               }
+               const TFloat invertedProbability = FastApproxDivide(sumExp, targetExp);
                // zero and negative are impossible since 1.0 is the lowest possible value
                TFloat metric =
                      TFloat::template ApproxLog<bDisableApprox, false, true, false, false>(invertedProbability);
@@ -295,11 +326,23 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
 
                size_t iScore2 = 0;
                do {
-                  const TFloat itemExp = TFloat::Load(&aExps[iScore2 << TFloat::k_cSIMDShift]);
-                  const TFloat gradient = itemExp * sumExpInverted;
+                  const TFloat itemExp = bDynamic ?
+                        TFloat::Load(&pGradientAndHessian[iScore2
+                              << (bHessian ? (TFloat::k_cSIMDShift + 1) : TFloat::k_cSIMDShift)]) :
+                        TFloat::Load(&aLocalExpVector[iScore2 << TFloat::k_cSIMDShift]);
+                  TFloat gradient = itemExp * sumExpInverted;
+
+                  TFloat hessian;
+                  if(bHessian) {
+                     hessian = FusedNegateMultiplyAdd(gradient, gradient, gradient);
+                  }
+
+                  if(bSelectTarget) {
+                     gradient = IfThenElse(target == iClass, gradient - 1.0, gradient);
+                     iClass = iClass + 1;
+                  }
 
                   if(bHessian) {
-                     const TFloat hessian = FusedNegateMultiplyAdd(gradient, gradient, gradient);
                      gradient.Store(&pGradientAndHessian[iScore2 << (TFloat::k_cSIMDShift + 1)]);
                      hessian.Store(&pGradientAndHessian[(iScore2 << (TFloat::k_cSIMDShift + 1)) + TFloat::k_cSIMDPack]);
                   } else {
@@ -309,19 +352,21 @@ template<typename TFloat> struct LogLossMulticlassObjective : MulticlassObjectiv
                   ++iScore2;
                } while(cScores != iScore2);
 
-               if(bHessian) {
-                  target = target << (TFloat::k_cSIMDShift + 1);
-               } else {
-                  target = target << TFloat::k_cSIMDShift;
+               if(!bSelectTarget) {
+                  if(bHessian) {
+                     target = target << (TFloat::k_cSIMDShift + 1);
+                  } else {
+                     target = target << TFloat::k_cSIMDShift;
+                  }
+                  target = target + TFloat::TInt::MakeIndexes();
+
+                  // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
+                  // identical, so instead of calling LoadScattered and SaveScattered we'll be able to call
+                  // LoadAligned and SaveAligned
+                  TFloat adjust = TFloat::Load(pGradientAndHessian, target);
+                  adjust -= 1.0;
+                  adjust.Store(pGradientAndHessian, target);
                }
-               target = target + TFloat::TInt::MakeIndexes();
-
-               // TODO: after we finish sorting our dataset, all the target values in this datasubset will be
-               // identical, so instead of calling LoadScattered and SaveScattered we'll be able to call
-               // LoadAligned and SaveAligned
-               TFloat adjust = TFloat::Load(pGradientAndHessian, target);
-               adjust -= 1.0;
-               adjust.Store(pGradientAndHessian, target);
 
                pGradientAndHessian += cScores << (bHessian ? (TFloat::k_cSIMDShift + 1) : TFloat::k_cSIMDShift);
             }
@@ -34,6 +34,11 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
    }
 
    inline RmseRegressionObjective(const Config& config) {
+      if(1 != config.cTargets) {
+         // we share the tag "rmse" with multitask RMSE regression
+         throw SkipRegistrationException();
+      }
+
       if(1 != config.cOutputs) {
          throw ParamMismatchWithConfigException();
       }
@@ -187,6 +192,8 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
 
       const typename TFloat::T* pWeight;
       TFloat metricSum;
+      // SetValidationMetric can choose its own metric, but the residuals are still updated for it
+      const bool bMetric = bValidation && EBM_FALSE != pData->m_bMetricNeeded;
       if(bValidation) {
          if(bWeight) {
             pWeight = reinterpret_cast<const typename TFloat::T*>(pData->m_aWeights);
@@ -241,7 +248,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
             gradient.Store(pGradient);
             pGradient += TFloat::k_cSIMDPack;
 
-            if(bValidation) {
+            if(bMetric) {
                // we use RMSE so get the squared error part here
                if(bWeight) {
                   metricSum = FusedMultiplyAdd(gradient * gradient, weight, metricSum);
@@ -269,7 +276,7 @@ template<typename TFloat> struct RmseRegressionObjective : RegressionObjective {
          }
       } while(pGradientsEnd != pGradient);
 
-      if(bValidation) {
+      if(bMetric) {
          pData->m_metricOut += static_cast<double>(Sum(metricSum));
       }
    }
@@ -33,6 +33,9 @@
 #include "PseudoHuberRegressionObjective.hpp"
 #include "LogLossBinaryObjective.hpp"
 #include "LogLossMulticlassObjective.hpp"
+#include "RmseRegressionMultitaskObjective.hpp"
+#include "LogLossBinaryMultitaskObjective.hpp"
+#include "LambdaRankRankingObjective.hpp"
 
 // Add new *Objective type registrations to this list:
 template<typename TFloat> static const std::vector<std::shared_ptr<const Registration>> RegisterObjectives() {
@@ -50,5 +53,8 @@ template<typename TFloat> static const std::vector<std::shared_ptr<const Registr
                "pseudo_huber", FloatParam("delta", 1.0)),
          Register<TFloat, LogLossBinaryObjective, AccelerationFlags_ALL>("log_loss"),
          Register<TFloat, LogLossMulticlassObjective, AccelerationFlags_ALL>("log_loss"),
+         Register<TFloat, RmseRegressionMultitaskObjective, AccelerationFlags_ALL>("rmse"),
+         Register<TFloat, LogLossBinaryMultitaskObjective, AccelerationFlags_ALL>("log_loss"),
+         Register<TFloat, LambdaRankRankingObjective, AccelerationFlags_NONE>("lambdarank", FloatParam("sigma", 1.0)),
    };
 }
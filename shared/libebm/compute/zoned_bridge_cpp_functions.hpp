@@ -10,6 +10,7 @@
 struct ApplyUpdateBridge;
 struct BinSumsBoostingBridge;
 struct BinSumsInteractionBridge;
+struct MetricBridge;
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -17,6 +18,7 @@ namespace DEFINED_ZONE_NAME {
 #endif // DEFINED_ZONE_NAME
 
 struct Objective;
+struct Metric;
 
 // these are going to be extern "C++", which we require to call our static member functions per:
 // https://www.drdobbs.com/c-theory-and-practice/184403437
@@ -25,6 +27,8 @@ typedef double (*FINISH_METRIC_CPP)(const Objective* const pObjective, const dou
 typedef BoolEbm (*CHECK_TARGETS_CPP)(const Objective* const pObjective, const size_t c, const void* const aTargets);
 typedef ErrorEbm (*BIN_SUMS_BOOSTING_CPP)(BinSumsBoostingBridge* const pParams);
 typedef ErrorEbm (*BIN_SUMS_INTERACTION_CPP)(BinSumsInteractionBridge* const pParams);
+typedef void (*ACCUMULATE_METRIC_CPP)(const Metric* const pMetric, MetricBridge* const pData);
+typedef double (*FINISH_METRIC_STATE_CPP)(const Metric* const pMetric, const void* const aState);
 
 struct FunctionPointersCpp {
    // unfortunately, function pointers are not interchangable with data pointers since in some architectures
@@ -39,6 +43,11 @@ struct FunctionPointersCpp {
    BIN_SUMS_INTERACTION_CPP m_pBinSumsInteractionCpp;
 };
 
+struct MetricFunctionPointersCpp {
+   ACCUMULATE_METRIC_CPP m_pAccumulateMetricCpp;
+   FINISH_METRIC_STATE_CPP m_pFinishMetricStateCpp;
+};
+
 } // namespace DEFINED_ZONE_NAME
 
 #endif // ZONED_BRIDGE_CPP_FUNCTIONS_HPP
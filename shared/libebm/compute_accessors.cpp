@@ -236,48 +236,25 @@ extern ErrorEbm GetObjective(const Config* const pConfig,
    return Error_None;
 }
 
-#ifdef NEVER
-// TODO: eventually enable metrics
-INLINE_RELEASE_UNTEMPLATED static ErrorEbm GetMetrics(const Config* const pConfig, const char* sMetric
-      //   MetricWrapper * const aMetricWrapperOut
-      ) noexcept {
+extern ErrorEbm GetMetric(
+      const Config* const pConfig, const char* sMetric, MetricWrapper* const pMetricWrapperOut) noexcept {
    EBM_ASSERT(nullptr != pConfig);
-   // EBM_ASSERT(nullptr != pMetricWrapperOut);
-   // aMetricWrapperOut->m_pMetric = nullptr;
-   // aMetricWrapperOut->m_pFunctionPointersCpp = nullptr;
+   EBM_ASSERT(nullptr != pMetricWrapperOut);
+   EBM_ASSERT(nullptr == pMetricWrapperOut->m_pMetric);
+   EBM_ASSERT(nullptr == pMetricWrapperOut->m_pFunctionPointersCpp);
 
    if(nullptr == sMetric) {
-      // it's legal to have no metrics
-      return Error_None;
+      return Error_ObjectiveUnknown;
+   }
+   sMetric = SkipWhitespace(sMetric);
+   if('\0' == *sMetric) {
+      return Error_ObjectiveUnknown;
    }
-   while(true) {
-      sMetric = SkipWhitespace(sMetric);
-      const char* sMetricEnd = strchr(sMetric, k_registrationSeparator);
-      if(nullptr == sMetricEnd) {
-         // find the null terminator then
-         sMetricEnd = sMetric + strlen(sMetric);
-      }
-      if(sMetricEnd != sMetric) {
-         // we allow empty registrations like ",,,something_legal,,,  something_else  , " since the intent is clear
-         ErrorEbm error;
-
-         error = CreateMetric_Cpu_64(pConfig, sMetric, sMetricEnd);
-         if(Error_None != error) {
-            return error;
-         }
 
-         // TODO: for now let's return after we find the first metric, but in the future we'll want to return
-         //       some kind of list of them
-         return error;
-      }
-      if('\0' == *sMetricEnd) {
-         return Error_None;
-      }
-      EBM_ASSERT(k_registrationSeparator == *sMetricEnd);
+   const char* const sMetricEnd = sMetric + strlen(sMetric);
 
-      sMetric = sMetricEnd + 1;
-   }
+   // metrics only exist in the CPU zone.  They read the validation subsets of the SIMD zones directly
+   return CreateMetric_Cpu_64(pConfig, sMetric, sMetricEnd, pMetricWrapperOut);
 }
-#endif // NEVER
 
 } // namespace DEFINED_ZONE_NAME
@@ -4,7 +4,7 @@
 
 #include "pch.hpp"
 
-#include <stdlib.h> // free
+#include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <string.h> // memcpy
 
@@ -75,7 +75,8 @@ static constexpr UIntShared k_weightId = 0x31FB; // random 15 bit number
 
 // target ids
 static constexpr UIntShared k_classificationBit = 0x1;
-static constexpr UIntShared k_targetId = 0x5A92; // random 15 bit number with lowest bit set to zero
+static constexpr UIntShared k_rankingBit = 0x4;
+static constexpr UIntShared k_targetId = 0x5A92; // random 15 bit number with the classification and ranking bits zero
 
 INLINE_ALWAYS static bool IsFeature(const UIntShared id) noexcept {
    return (k_missingFeatureBit | k_unknownFeatureBit | k_nominalFeatureBit | k_sparseFeatureBit | k_featureId) ==
@@ -109,15 +110,24 @@ INLINE_ALWAYS static UIntShared GetFeatureId(
 }
 
 INLINE_ALWAYS static bool IsTarget(const UIntShared id) noexcept {
-   return (k_classificationBit | k_targetId) == (k_classificationBit | id);
+   // ranking targets are relevance labels, so they cannot also be classification targets
+   return (k_classificationBit | k_rankingBit | k_targetId) == (k_classificationBit | k_rankingBit | id) &&
+         (k_classificationBit | k_rankingBit) != ((k_classificationBit | k_rankingBit) & id);
 }
 INLINE_ALWAYS static bool IsClassificationTarget(const UIntShared id) noexcept {
    static_assert(0 == (k_classificationBit & k_targetId), "k_targetId should not be classification");
    EBM_ASSERT(IsTarget(id));
    return 0 != (k_classificationBit & id);
 }
-INLINE_ALWAYS static UIntShared GetTargetId(const bool bClassification) noexcept {
-   return k_targetId | (bClassification ? k_classificationBit : UIntShared{0});
+INLINE_ALWAYS static bool IsRankingTarget(const UIntShared id) noexcept {
+   static_assert(0 == (k_rankingBit & k_targetId), "k_targetId should not be ranking");
+   EBM_ASSERT(IsTarget(id));
+   return 0 != (k_rankingBit & id);
+}
+INLINE_ALWAYS static UIntShared GetTargetId(const bool bClassification, const bool bRanking) noexcept {
+   EBM_ASSERT(!bClassification || !bRanking);
+   return k_targetId | (bClassification ? k_classificationBit : UIntShared{0}) |
+         (bRanking ? k_rankingBit : UIntShared{0});
 }
 
 struct HeaderDataSetShared {
@@ -189,6 +199,9 @@ static_assert(std::is_trivial<ClassificationTargetDataSetShared>::value,
 
 // No RegressionTargetDataSetShared required
 
+// No RankingTargetDataSetShared required.  Ranking targets store the relevance labels like regression targets and
+// follow them with one UIntShared query id per sample.  Query ids never decrease, so each query is a contiguous run
+
 static bool IsHeaderError(
       const UIntShared countSamples, const size_t cBytesAllocated, const unsigned char* const pFillMem) {
    EBM_ASSERT(nullptr != pFillMem);
@@ -336,7 +349,11 @@ static bool IsHeaderError(
    return false;
 }
 
-EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAllocated, const void* dataSet) {
+// bScanSamples false keeps every check of the header, offsets, ids, bin counts, and lengths but skips the O(samples)
+// scans of the bin indexes, classification targets, and query ids.  The bin indexes and classification targets are
+// checked again wherever they are unpacked, so a corrupt value that slips through is still caught if it is used
+static ErrorEbm CheckDataSetInternal(
+      const IntEbm countBytesAllocated, const void* const dataSet, const bool bScanSamples) {
    // if countBytesAllocated is 0 then we do not check the bytes allocated
    // if countBytesAllocated is positive then countBytesAllocated must exactly equal the dataSet size
    // if countBytesAllocated is negative then -countBytesAllocated must equal or exceed the dataSet size
@@ -512,7 +529,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAlloc
 
             const SparseFeatureDataSetSharedEntry* pNonDefault =
                   ArrayToPointer(pSparseFeatureDataSetShared->m_nonDefaults);
-            const SparseFeatureDataSetSharedEntry* const pNonDefaultEnd = &pNonDefault[cNonDefaults];
+            const SparseFeatureDataSetSharedEntry* const pNonDefaultEnd =
+                  bScanSamples ? &pNonDefault[cNonDefaults] : pNonDefault;
             while(pNonDefaultEnd != pNonDefault) {
                if(countSamples <= pNonDefault->m_iSample) {
                   LOG_0(Trace_Error, "ERROR CheckDataSet countSamples <= pNonDefault->m_iSample");
@@ -579,21 +597,23 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAlloc
                const UIntShared* const pInputDataEnd =
                      reinterpret_cast<const UIntShared*>(pDataSetShared + iOffsetNext);
 
-               do {
-                  const UIntShared iBinCombined = *pInputData;
-                  ++pInputData;
+               if(bScanSamples) {
                   do {
-                     const UIntShared indexBin = (iBinCombined >> cShift) & maskBits;
-
-                     if(countBins <= indexBin) {
-                        LOG_0(Trace_Error, "ERROR CheckDataSet countBins <= indexBin");
-                        return Error_IllegalParamVal;
-                     }
+                     const UIntShared iBinCombined = *pInputData;
+                     ++pInputData;
+                     do {
+                        const UIntShared indexBin = (iBinCombined >> cShift) & maskBits;
+
+                        if(countBins <= indexBin) {
+                           LOG_0(Trace_Error, "ERROR CheckDataSet countBins <= indexBin");
+                           return Error_IllegalParamVal;
+                        }
 
-                     cShift -= cBitsPerItemMax;
-                  } while(0 <= cShift);
-                  cShift = cShiftReset;
-               } while(pInputDataEnd != pInputData);
+                        cShift -= cBitsPerItemMax;
+                     } while(0 <= cShift);
+                     cShift = cShiftReset;
+                  } while(pInputDataEnd != pInputData);
+               }
             }
          }
          ++pOffset;
@@ -766,7 +786,8 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAlloc
             }
 
             const UIntShared* pInputData = reinterpret_cast<const UIntShared*>(pDataSetShared + iOffsetCur);
-            const UIntShared* const pInputDataEnd = reinterpret_cast<const UIntShared*>(pDataSetShared + iOffsetNext);
+            const UIntShared* const pInputDataEnd =
+                  bScanSamples ? reinterpret_cast<const UIntShared*>(pDataSetShared + iOffsetNext) : pInputData;
             while(pInputDataEnd != pInputData) {
                const UIntShared target = *pInputData;
                if(countClasses <= target) {
@@ -800,6 +821,41 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAlloc
                return Error_IllegalParamVal;
             }
 
+            if(IsRankingTarget(id)) {
+               if(IsMultiplyError(sizeof(UIntShared), cSamples)) {
+                  LOG_0(Trace_Error, "ERROR CheckDataSet IsMultiplyError(sizeof(UIntShared), cSamples)");
+                  return Error_IllegalParamVal;
+               }
+               const size_t cTotalQueryMem = sizeof(UIntShared) * cSamples;
+
+               iOffsetCur = iOffsetNext;
+               if(IsAddError(iOffsetNext, cTotalQueryMem)) {
+                  LOG_0(Trace_Error, "ERROR CheckDataSet IsAddError(iOffsetNext, cTotalQueryMem)");
+                  return Error_IllegalParamVal;
+               }
+               iOffsetNext += cTotalQueryMem;
+
+               if(cBytesMax < iOffsetNext) {
+                  LOG_0(Trace_Error, "ERROR CheckDataSet Not enough space to access the ranking query ids");
+                  return Error_IllegalParamVal;
+               }
+
+               // the boosting data subsets rely on each query being a contiguous run of samples
+               const UIntShared* pQuery = reinterpret_cast<const UIntShared*>(pDataSetShared + iOffsetCur);
+               const UIntShared* const pQueryEnd =
+                     bScanSamples ? reinterpret_cast<const UIntShared*>(pDataSetShared + iOffsetNext) : pQuery;
+               UIntShared queryPrev = 0;
+               while(pQueryEnd != pQuery) {
+                  const UIntShared query = *pQuery;
+                  if(query < queryPrev) {
+                     LOG_0(Trace_Error, "ERROR CheckDataSet ranking query ids must not decrease");
+                     return Error_IllegalParamVal;
+                  }
+                  queryPrev = query;
+                  ++pQuery;
+               }
+            }
+
             // TODO: should I be checking for these bad regression targets here or somewhere else?
             // const FloatShared * pInputData =
             //   reinterpret_cast<const FloatShared *>(pDataSetShared + iOffsetCur);
@@ -832,6 +888,210 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAlloc
    return Error_None;
 }
 
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAllocated, const void* dataSet) {
+   return CheckDataSetInternal(countBytesAllocated, dataSet, true);
+}
+
+// A dataset file is a DataSetFileHeader followed by the dataset bytes.  The header pads to 64 bytes so that the
+// dataset stays aligned when the file is memory mapped.  The dataset is fully checked by CheckDataSet once when
+// the file header is created, and that result is recorded in the header so that every process mapping the file can
+// skip the O(samples) scan and only verify the header.  The checksum guards against corruption on disk and is only
+// recomputed on request.
+
+static constexpr UIntShared k_dataSetFileMagic = 0x00415441444D4245; // "EBMDATA\0" read as a little endian integer
+static constexpr UIntShared k_dataSetFileVersion = 1;
+static constexpr UIntShared k_dataSetFileCheckedSalt = 0x6A1F3C92D7B84E05; // random 64 bit number
+
+struct DataSetFileHeader {
+   UIntShared m_magic;
+   UIntShared m_version;
+   UIntShared m_cBytesHeader;
+   UIntShared m_cBytesDataSet;
+   UIntShared m_checksum;
+   UIntShared m_checked; // m_checksum ^ k_dataSetFileCheckedSalt if CheckDataSet passed when the file was written
+   UIntShared m_unused[2];
+};
+static_assert(std::is_standard_layout<DataSetFileHeader>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<DataSetFileHeader>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(64 == sizeof(DataSetFileHeader), "keep the dataset 64 byte aligned within the file");
+
+static UIntShared ChecksumBytes(const unsigned char* const pBytes, const size_t cBytes) {
+   // not cryptographic, but detects truncation, torn writes and bit flips. Four independent lanes keep the
+   // multiplies from serializing so this runs near memory bandwidth.
+   static constexpr uint64_t k_prime1 = 0x9E3779B185EBCA87;
+   static constexpr uint64_t k_prime2 = 0xC2B2AE3D27D4EB4F;
+
+   uint64_t lanes[4]{k_prime1, k_prime2, ~k_prime1, ~k_prime2};
+   const unsigned char* p = pBytes;
+   const unsigned char* const pBlocksEnd = pBytes + (cBytes & ~size_t{31});
+   while(pBlocksEnd != p) {
+      for(size_t iLane = 0; iLane < size_t{4}; ++iLane) {
+         uint64_t word;
+         memcpy(&word, p + sizeof(word) * iLane, sizeof(word));
+         uint64_t lane = lanes[iLane] ^ word;
+         lane *= k_prime1;
+         lanes[iLane] = (lane << 31) | (lane >> 33);
+      }
+      p += 32;
+   }
+   uint64_t hash = static_cast<uint64_t>(cBytes) * k_prime2;
+   for(size_t iLane = 0; iLane < size_t{4}; ++iLane) {
+      hash = (hash ^ lanes[iLane]) * k_prime1;
+      hash ^= hash >> 29;
+   }
+   const unsigned char* const pEnd = pBytes + cBytes;
+   while(pEnd != p) {
+      hash = (hash ^ uint64_t{*p}) * k_prime2;
+      ++p;
+   }
+   hash ^= hash >> 32;
+   hash *= k_prime2;
+   hash ^= hash >> 29;
+   return static_cast<UIntShared>(hash);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureDataSetFileHeader(void) {
+   return static_cast<IntEbm>(sizeof(DataSetFileHeader));
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillDataSetFileHeader(
+      IntEbm countBytesDataSet, const void* dataSet, IntEbm countBytesAllocated, void* fillMem) {
+   LOG_N(Trace_Info,
+         "Entered FillDataSetFileHeader: "
+         "countBytesDataSet=%" IntEbmPrintf ", "
+         "dataSet=%p, "
+         "countBytesAllocated=%" IntEbmPrintf ", "
+         "fillMem=%p",
+         countBytesDataSet,
+         dataSet,
+         countBytesAllocated,
+         fillMem);
+
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillDataSetFileHeader nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countBytesAllocated) ||
+         static_cast<size_t>(countBytesAllocated) != sizeof(DataSetFileHeader)) {
+      LOG_0(Trace_Error, "ERROR FillDataSetFileHeader countBytesAllocated must be MeasureDataSetFileHeader()");
+      return Error_IllegalParamVal;
+   }
+   if(IntEbm{0} == countBytesDataSet || IsConvertError<size_t>(countBytesDataSet) ||
+         IsConvertError<UIntShared>(countBytesDataSet)) {
+      LOG_0(Trace_Error, "ERROR FillDataSetFileHeader countBytesDataSet is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesDataSet = static_cast<size_t>(countBytesDataSet);
+
+   // CheckDataSet handles nullptr == dataSet
+   const ErrorEbm error = CheckDataSet(countBytesDataSet, dataSet);
+   if(Error_None != error) {
+      return error;
+   }
+
+   const UIntShared checksum = ChecksumBytes(static_cast<const unsigned char*>(dataSet), cBytesDataSet);
+
+   DataSetFileHeader header;
+   header.m_magic = k_dataSetFileMagic;
+   header.m_version = k_dataSetFileVersion;
+   header.m_cBytesHeader = static_cast<UIntShared>(sizeof(DataSetFileHeader));
+   header.m_cBytesDataSet = static_cast<UIntShared>(cBytesDataSet);
+   header.m_checksum = checksum;
+   header.m_checked = checksum ^ k_dataSetFileCheckedSalt;
+   header.m_unused[0] = 0;
+   header.m_unused[1] = 0;
+
+   // the caller's buffer might come from a file writer without any alignment guarantees
+   memcpy(fillMem, &header, sizeof(header));
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckDataSetFile(
+      IntEbm countBytesFile, const void* dataSetFile, BoolEbm isVerifyChecksum, IntEbm* offsetDataSetOut) {
+   LOG_N(Trace_Info,
+         "Entered CheckDataSetFile: "
+         "countBytesFile=%" IntEbmPrintf ", "
+         "dataSetFile=%p, "
+         "isVerifyChecksum=%s, "
+         "offsetDataSetOut=%p",
+         countBytesFile,
+         dataSetFile,
+         ObtainTruth(isVerifyChecksum),
+         static_cast<void*>(offsetDataSetOut));
+
+   if(nullptr != offsetDataSetOut) {
+      *offsetDataSetOut = 0;
+   }
+
+   if(nullptr == dataSetFile) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile nullptr == dataSetFile");
+      return Error_IllegalParamVal;
+   }
+   if(EBM_FALSE != isVerifyChecksum && EBM_TRUE != isVerifyChecksum) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile isVerifyChecksum is not EBM_FALSE or EBM_TRUE");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countBytesFile)) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile countBytesFile is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesFile = static_cast<size_t>(countBytesFile);
+
+   if(cBytesFile < sizeof(DataSetFileHeader) + k_cBytesHeaderNoOffset) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile the file is too short to hold a dataset");
+      return Error_IllegalParamVal;
+   }
+
+   const unsigned char* const pFile = static_cast<const unsigned char*>(dataSetFile);
+   DataSetFileHeader header;
+   memcpy(&header, pFile, sizeof(header));
+
+   if(k_dataSetFileMagic != header.m_magic) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile not a dataset file, or written on a machine with different endianness");
+      return Error_IllegalParamVal;
+   }
+   if(k_dataSetFileVersion != header.m_version) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile unsupported dataset file version");
+      return Error_IllegalParamVal;
+   }
+   if(static_cast<UIntShared>(sizeof(DataSetFileHeader)) != header.m_cBytesHeader) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile unexpected file header size");
+      return Error_IllegalParamVal;
+   }
+   if(static_cast<UIntShared>(cBytesFile - sizeof(DataSetFileHeader)) != header.m_cBytesDataSet) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile the file length does not match the dataset length");
+      return Error_IllegalParamVal;
+   }
+   if((header.m_checksum ^ k_dataSetFileCheckedSalt) != header.m_checked) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile the dataset was not checked when the file was written");
+      return Error_IllegalParamVal;
+   }
+
+   const unsigned char* const pDataSetShared = pFile + sizeof(DataSetFileHeader);
+   const size_t cBytesDataSet = cBytesFile - sizeof(DataSetFileHeader);
+
+   const HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<const HeaderDataSetShared*>(pDataSetShared);
+   if(k_sharedDataSetDoneId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR CheckDataSetFile k_sharedDataSetDoneId != pHeaderDataSetShared->m_id");
+      return Error_IllegalParamVal;
+   }
+
+   if(EBM_FALSE != isVerifyChecksum) {
+      if(header.m_checksum != ChecksumBytes(pDataSetShared, cBytesDataSet)) {
+         LOG_0(Trace_Error, "ERROR CheckDataSetFile the dataset checksum does not match");
+         return Error_IllegalParamVal;
+      }
+   }
+
+   if(nullptr != offsetDataSetOut) {
+      *offsetDataSetOut = static_cast<IntEbm>(sizeof(DataSetFileHeader));
+   }
+   return Error_None;
+}
+
 static ErrorEbm LockDataSetShared(const size_t cBytesAllocated, unsigned char* const pFillMem) {
    HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(pFillMem);
    EBM_ASSERT(k_sharedDataSetWorkingId == pHeaderDataSetShared->m_id);
@@ -968,12 +1228,56 @@ static IntEbm AppendHeader(const IntEbm countFeatures,
 }
 WARNING_POP
 
-static bool DecideIfSparse(const size_t cSamples, const IntEbm* binIndexes) {
+// AppendFeature reads the bin indexes through one of these so that the one shot FillFeature and the chunked
+// DataSetBuilder share the same validation and bit packing code
+class BinIndexesReader final {
+   const IntEbm* m_pBinIndex;
+
+ public:
+   inline BinIndexesReader(const IntEbm* const binIndexes) : m_pBinIndex(binIndexes) {}
+   inline bool IsNull() const { return nullptr == m_pBinIndex; }
+   inline IntEbm Next() {
+      const IntEbm indexBin = *m_pBinIndex;
+      ++m_pBinIndex;
+      return indexBin;
+   }
+};
+
+class StagedBinsReader final {
+   const UIntShared* m_pData;
+   UIntShared m_bits;
+   UIntShared m_maskBits;
+   int m_cShift;
+   int m_cShiftReset;
+   int m_cBitsPerItemMax;
+
+ public:
+   inline StagedBinsReader(const UIntShared* const aData, const int cItemsPerBitPack, const int cBitsPerItemMax) :
+         m_pData(aData),
+         m_bits(0),
+         m_maskBits(MakeLowMask<UIntShared>(cBitsPerItemMax)),
+         m_cShift(-1),
+         m_cShiftReset((cItemsPerBitPack - 1) * cBitsPerItemMax),
+         m_cBitsPerItemMax(cBitsPerItemMax) {}
+   inline bool IsNull() const { return nullptr == m_pData; }
+   inline IntEbm Next() {
+      if(m_cShift < 0) {
+         m_bits = *m_pData;
+         ++m_pData;
+         m_cShift = m_cShiftReset;
+      }
+      const UIntShared indexBin = (m_bits >> m_cShift) & m_maskBits;
+      m_cShift -= m_cBitsPerItemMax;
+      return static_cast<IntEbm>(indexBin);
+   }
+};
+
+template<typename TBinReader> static bool DecideIfSparse(const size_t cSamples, const TBinReader& binReader) {
    // For sparsity in the data set shared memory the only thing that matters is compactness since we don't use
    // this memory in any high performance loops
 
    UNUSED(cSamples);
-   UNUSED(binIndexes);
+   UNUSED(binReader);
 
    // TODO: evalute the data to decide if the feature should be sparse or not
    return false;
@@ -981,12 +1285,13 @@ static bool DecideIfSparse(const size_t cSamples, const IntEbm* binIndexes) {
 
 WARNING_PUSH
 WARNING_REDUNDANT_CODE
+template<typename TBinReader>
 static IntEbm AppendFeature(const IntEbm countBins,
       const BoolEbm isMissing,
       const BoolEbm isUnknown,
       const BoolEbm isNominal,
       const IntEbm countSamples,
-      const IntEbm* binIndexes,
+      TBinReader binReader,
       const size_t cBytesAllocated,
       unsigned char* const pFillMem) {
    EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem ||
@@ -999,7 +1304,6 @@ static IntEbm AppendFeature(const IntEbm countBins,
          "isUnknown=%s, "
          "isNominal=%s, "
          "countSamples=%" IntEbmPrintf ", "
-         "binIndexes=%p, "
          "cBytesAllocated=%zu, "
          "pFillMem=%p",
          countBins,
@@ -1007,7 +1311,6 @@ static IntEbm AppendFeature(const IntEbm countBins,
          ObtainTruth(isUnknown),
          ObtainTruth(isNominal),
          countSamples,
-         static_cast<const void*>(binIndexes),
          cBytesAllocated,
          static_cast<void*>(pFillMem));
 
@@ -1045,13 +1348,13 @@ static IntEbm AppendFeature(const IntEbm countBins,
 
       bool bSparse = false;
       if(size_t{0} != cSamples) {
-         if(nullptr == binIndexes) {
+         if(binReader.IsNull()) {
             LOG_0(Trace_Error, "ERROR AppendFeature nullptr == binIndexes");
             goto return_bad;
          }
 
          // TODO: handle sparse data someday
-         bSparse = DecideIfSparse(cSamples, binIndexes);
+         bSparse = DecideIfSparse(cSamples, binReader);
       }
 
       size_t iOffset = 0;
@@ -1101,8 +1404,7 @@ static IntEbm AppendFeature(const IntEbm countBins,
 
       // if there is only 1 bin we always know what it will be and we do not need to store anything
       if(size_t{0} != cSamples) {
-         const IntEbm* pBinIndex = binIndexes;
-         const IntEbm* const pBinIndexsEnd = binIndexes + cSamples;
+         size_t cRemaining = cSamples;
          if(cBins <= UIntShared{1}) {
             if(UIntShared{0} == cBins) {
                LOG_0(Trace_Error, "ERROR AppendFeature UIntShared { 0 } == cBins");
@@ -1110,13 +1412,13 @@ static IntEbm AppendFeature(const IntEbm countBins,
             }
             const IntEbm indexBinLegal = EBM_FALSE != isMissing ? IntEbm{0} : IntEbm{1};
             do {
-               const IntEbm indexBin = *pBinIndex;
+               const IntEbm indexBin = binReader.Next();
                if(indexBinLegal != indexBin) {
                   LOG_0(Trace_Error, "ERROR AppendFeature indexBinLegal != indexBin");
                   goto return_bad;
                }
-               ++pBinIndex;
-            } while(pBinIndexsEnd != pBinIndex);
+               --cRemaining;
+            } while(size_t{0} != cRemaining);
          } else {
             const int cBitsRequiredMin = CountBitsRequired(cBins - UIntShared{1});
             EBM_ASSERT(1 <= cBitsRequiredMin);
@@ -1151,8 +1453,8 @@ static IntEbm AppendFeature(const IntEbm countBins,
                   goto return_bad;
                }
 
-               if(IsMultiplyError(sizeof(binIndexes[0]), cSamples)) {
-                  LOG_0(Trace_Error, "ERROR AppendFeature IsMultiplyError(sizeof(binIndexes[0]), cSamples)");
+               if(IsMultiplyError(sizeof(IntEbm), cSamples)) {
+                  LOG_0(Trace_Error, "ERROR AppendFeature IsMultiplyError(sizeof(IntEbm), cSamples)");
                   goto return_bad;
                }
                UIntShared* pFillData = reinterpret_cast<UIntShared*>(pFillMem + iByteCur);
@@ -1164,7 +1466,7 @@ static IntEbm AppendFeature(const IntEbm countBins,
                do {
                   UIntShared bits = 0;
                   do {
-                     IntEbm indexBin = *pBinIndex;
+                     IntEbm indexBin = binReader.Next();
                      if(indexBinIllegal <= indexBin) {
                         LOG_0(Trace_Error, "ERROR AppendFeature indexBinIllegal <= indexBin");
                         goto return_bad;
@@ -1181,7 +1483,7 @@ static IntEbm AppendFeature(const IntEbm countBins,
                         }
                         --indexBin;
                      }
-                     ++pBinIndex;
+                     --cRemaining;
 
                      // since countBins can be converted to these, so now can indexBin
                      EBM_ASSERT(!IsConvertError<UIntShared>(indexBin));
@@ -1194,7 +1496,7 @@ static IntEbm AppendFeature(const IntEbm countBins,
                   cShift = cShiftReset;
                   *pFillData = bits;
                   ++pFillData;
-               } while(pBinIndexsEnd != pBinIndex);
+               } while(size_t{0} != cRemaining);
                EBM_ASSERT(reinterpret_cast<unsigned char*>(pFillData) == pFillMem + iByteNext);
             }
             iByteCur = iByteNext;
@@ -1453,6 +1755,7 @@ static IntEbm AppendTarget(const bool bClassification,
       const IntEbm countClasses,
       const IntEbm countSamples,
       const void* aTargets,
+      const IntEbm* const aQueryGroups,
       const size_t cBytesAllocated,
       unsigned char* const pFillMem) {
    EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem ||
@@ -1464,15 +1767,21 @@ static IntEbm AppendTarget(const bool bClassification,
          "countClasses=%" IntEbmPrintf ", "
          "countSamples=%" IntEbmPrintf ", "
          "aTargets=%p, "
+         "aQueryGroups=%p, "
          "cBytesAllocated=%zu, "
          "pFillMem=%p",
          ObtainTruth(bClassification ? EBM_TRUE : EBM_FALSE),
          countClasses,
          countSamples,
          static_cast<const void*>(aTargets),
+         static_cast<const void*>(aQueryGroups),
          cBytesAllocated,
          static_cast<void*>(pFillMem));
 
+   // ranking targets are regression style relevance labels with a query id per sample
+   EBM_ASSERT(!bClassification || nullptr == aQueryGroups);
+   const bool bRanking = nullptr != aQueryGroups;
+
    {
       if(IsConvertError<UIntShared>(countClasses)) {
          LOG_0(Trace_Error, "ERROR AppendTarget countClasses is outside the range of a valid index");
@@ -1526,7 +1835,7 @@ static IntEbm AppendTarget(const bool bClassification,
 
          unsigned char* const pFillMemTemp = pFillMem + iHighestOffset;
          TargetDataSetShared* const pTargetDataSetShared = reinterpret_cast<TargetDataSetShared*>(pFillMemTemp);
-         pTargetDataSetShared->m_id = GetTargetId(bClassification);
+         pTargetDataSetShared->m_id = GetTargetId(bClassification, bRanking);
 
          if(bClassification) {
             ClassificationTargetDataSetShared* pClassificationTargetDataSetShared =
@@ -1556,6 +1865,18 @@ static IntEbm AppendTarget(const bool bClassification,
                goto return_bad;
             }
             cBytesAllSamples = sizeof(FloatShared) * cSamples;
+            if(bRanking) {
+               if(IsMultiplyError(EbmMax(sizeof(IntEbm), sizeof(UIntShared)), cSamples)) {
+                  LOG_0(Trace_Error,
+                        "ERROR AppendTarget IsMultiplyError(EbmMax(sizeof(IntEbm), sizeof(UIntShared)), cSamples)");
+                  goto return_bad;
+               }
+               if(IsAddError(cBytesAllSamples, sizeof(UIntShared) * cSamples)) {
+                  LOG_0(Trace_Error, "ERROR AppendTarget IsAddError(cBytesAllSamples, sizeof(UIntShared) * cSamples)");
+                  goto return_bad;
+               }
+               cBytesAllSamples += sizeof(UIntShared) * cSamples;
+            }
          }
          if(IsAddError(iByteCur, cBytesAllSamples)) {
             LOG_0(Trace_Error, "ERROR AppendTarget IsAddError(iByteCur, cBytesAllSamples)");
@@ -1625,6 +1946,27 @@ static IntEbm AppendTarget(const bool bClassification,
                   ++pFill;
                   ++pTarget;
                } while(pTargetsEnd != pTarget);
+
+               if(bRanking) {
+                  UIntShared* pFillQuery = reinterpret_cast<UIntShared*>(pFill);
+                  const IntEbm* pQueryGroup = aQueryGroups;
+                  const IntEbm* const pQueryGroupsEnd = aQueryGroups + cSamples;
+                  IntEbm queryGroupPrev = 0;
+                  do {
+                     const IntEbm queryGroup = *pQueryGroup;
+                     if(queryGroup < queryGroupPrev) {
+                        // this also rejects negative query ids
+                        LOG_0(Trace_Error, "ERROR AppendTarget query groups must be sorted and non-negative");
+                        goto return_bad;
+                     }
+                     EBM_ASSERT(!IsConvertError<UIntShared>(queryGroup));
+                     *pFillQuery = static_cast<UIntShared>(queryGroup);
+                     queryGroupPrev = queryGroup;
+                     ++pFillQuery;
+                     ++pQueryGroup;
+                  } while(pQueryGroupsEnd != pQueryGroup);
+                  EBM_ASSERT(reinterpret_cast<unsigned char*>(pFillQuery) == pFillMem + iByteNext);
+               }
             }
          }
          iByteCur = iByteNext;
@@ -1716,7 +2058,8 @@ EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureFeature(IntEbm countBins,
       BoolEbm isNominal,
       IntEbm countSamples,
       const IntEbm* binIndexes) {
-   return AppendFeature(countBins, isMissing, isUnknown, isNominal, countSamples, binIndexes, 0, nullptr);
+   return AppendFeature(
+         countBins, isMissing, isUnknown, isNominal, countSamples, BinIndexesReader(binIndexes), 0, nullptr);
 }
 
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillFeature(IntEbm countBins,
@@ -1757,7 +2100,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillFeature(IntEbm countBins,
          isUnknown,
          isNominal,
          countSamples,
-         binIndexes,
+         BinIndexesReader(binIndexes),
          cBytesAllocated,
          static_cast<unsigned char*>(fillMem));
    return static_cast<ErrorEbm>(ret);
@@ -1800,7 +2143,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillWeight(
 
 EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureClassificationTarget(
       IntEbm countClasses, IntEbm countSamples, const IntEbm* targets) {
-   return AppendTarget(true, countClasses, countSamples, targets, 0, nullptr);
+   return AppendTarget(true, countClasses, countSamples, targets, nullptr, 0, nullptr);
 }
 
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillClassificationTarget(
@@ -1830,13 +2173,13 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillClassificationTarget(
       return Error_IllegalParamVal;
    }
 
-   const IntEbm ret =
-         AppendTarget(true, countClasses, countSamples, targets, cBytesAllocated, static_cast<unsigned char*>(fillMem));
+   const IntEbm ret = AppendTarget(
+         true, countClasses, countSamples, targets, nullptr, cBytesAllocated, static_cast<unsigned char*>(fillMem));
    return static_cast<ErrorEbm>(ret);
 }
 
 EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureRegressionTarget(IntEbm countSamples, const double* targets) {
-   return AppendTarget(false, 0, countSamples, targets, 0, nullptr);
+   return AppendTarget(false, 0, countSamples, targets, nullptr, 0, nullptr);
 }
 
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillRegressionTarget(
@@ -1867,11 +2210,654 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillRegressionTarget(
    }
 
    const IntEbm ret =
-         AppendTarget(false, 0, countSamples, targets, cBytesAllocated, static_cast<unsigned char*>(fillMem));
+         AppendTarget(false, 0, countSamples, targets, nullptr, cBytesAllocated, static_cast<unsigned char*>(fillMem));
    return static_cast<ErrorEbm>(ret);
 }
 
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureRankingTarget(
+      IntEbm countSamples, const double* relevances, const IntEbm* queryGroups) {
+   if(nullptr == queryGroups) {
+      LOG_0(Trace_Error, "ERROR MeasureRankingTarget nullptr == queryGroups");
+      return Error_IllegalParamVal;
+   }
+   return AppendTarget(false, 0, countSamples, relevances, queryGroups, 0, nullptr);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillRankingTarget(IntEbm countSamples,
+      const double* relevances,
+      const IntEbm* queryGroups,
+      IntEbm countBytesAllocated,
+      void* fillMem) {
+   if(nullptr == queryGroups) {
+      LOG_0(Trace_Error, "ERROR FillRankingTarget nullptr == queryGroups");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillRankingTarget nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillRankingTarget countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   if(cBytesAllocated < k_cBytesHeaderId) {
+      LOG_0(Trace_Error, "ERROR FillRankingTarget cBytesAllocated < k_cBytesHeaderId");
+      // don't check or set the header to bad if we don't have enough memory for the header id itself
+      return Error_IllegalParamVal;
+   }
+
+   HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<HeaderDataSetShared*>(fillMem);
+   if(k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id) {
+      LOG_0(Trace_Error, "ERROR FillRankingTarget k_sharedDataSetWorkingId != pHeaderDataSetShared->m_id");
+      // don't set the header to bad since it's already set to something invalid and we don't know why
+      return Error_IllegalParamVal;
+   }
+
+   const IntEbm ret = AppendTarget(
+         false, 0, countSamples, relevances, queryGroups, cBytesAllocated, static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+// The DataSetBuilder accepts the dataset in chunks of samples so that callers that stream their data from disk never
+// need to hold an entire column of raw values or IntEbm bin indexes.  Feature bins are bit packed into a per feature
+// staging buffer as they arrive.  The shared layout depends on the total number of samples and on whether any
+// missing or unknown values exist, which a streaming caller only knows at the end, so the shared memory is written
+// in one final pass through the same Append functions used by the one shot Fill functions.
+
+static constexpr size_t k_handleVerificationBuilderOk = 17339; // random 15 bit number
+static constexpr size_t k_handleVerificationBuilderFreed = 9422; // random 15 bit number
+
+struct BuilderColumn {
+   // for features this is the number of bins including the missing and unknown bins. For targets it holds the number
+   // of classes, or Task_Regression.  Weights do not use it.
+   IntEbm m_countBinsOrClasses;
+   bool m_bNominal;
+   bool m_bMissing;
+   bool m_bUnknown;
+
+   int m_cItemsPerBitPack;
+   int m_cBitsPerItemMax;
+
+   size_t m_cSamples;
+   size_t m_cCapacity; // in bit packs for features, in samples for weights and targets
+   void* m_aData;
+};
+static_assert(std::is_standard_layout<BuilderColumn>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<BuilderColumn>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+struct DataSetBuilder {
+   size_t m_handleVerification; // this needs to be at the top and make it pointer sized to keep best alignment
+   size_t m_cFeatures;
+   size_t m_cWeights;
+   size_t m_cTargets;
+   size_t m_cSamplesHint;
+
+   // use the "struct hack" since Flexible array member method is not available in C++
+   // m_aColumns must be the last item in this struct
+   BuilderColumn m_aColumns[1];
+};
+static_assert(std::is_standard_layout<DataSetBuilder>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<DataSetBuilder>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+static DataSetBuilder* GetDataSetBuilderFromHandle(const DataSetBuilderHandle dataSetBuilderHandle) {
+   if(nullptr == dataSetBuilderHandle) {
+      LOG_0(Trace_Error, "ERROR GetDataSetBuilderFromHandle null dataSetBuilderHandle");
+      return nullptr;
+   }
+   DataSetBuilder* const pDataSetBuilder = reinterpret_cast<DataSetBuilder*>(dataSetBuilderHandle);
+   if(k_handleVerificationBuilderOk == pDataSetBuilder->m_handleVerification) {
+      return pDataSetBuilder;
+   }
+   if(k_handleVerificationBuilderFreed == pDataSetBuilder->m_handleVerification) {
+      LOG_0(Trace_Error, "ERROR GetDataSetBuilderFromHandle attempt to use freed DataSetBuilderHandle");
+   } else {
+      LOG_0(Trace_Error, "ERROR GetDataSetBuilderFromHandle attempt to use invalid DataSetBuilderHandle");
+   }
+   return nullptr;
+}
+
+static ErrorEbm EnsureColumnCapacity(
+      BuilderColumn* const pColumn, const size_t cUnitsNeeded, const size_t cUnitsHint, const size_t cBytesPerUnit) {
+   const size_t cCapacity = pColumn->m_cCapacity;
+   if(cCapacity < cUnitsNeeded) {
+      if(IsAddError(cCapacity, cCapacity >> 1)) {
+         LOG_0(Trace_Warning, "WARNING EnsureColumnCapacity IsAddError(cCapacity, cCapacity >> 1)");
+         return Error_OutOfMemory;
+      }
+      // grow by 50% like our other growable buffers, but jump straight to the hint if the caller gave us one
+      size_t cNewCapacity = cCapacity + (cCapacity >> 1);
+      cNewCapacity = EbmMax(cNewCapacity, cUnitsNeeded);
+      cNewCapacity = EbmMax(cNewCapacity, cUnitsHint);
+
+      if(IsMultiplyError(cBytesPerUnit, cNewCapacity)) {
+         LOG_0(Trace_Warning, "WARNING EnsureColumnCapacity IsMultiplyError(cBytesPerUnit, cNewCapacity)");
+         return Error_OutOfMemory;
+      }
+      LOG_N(Trace_Info, "EnsureColumnCapacity Growing to size %zu", cNewCapacity);
+
+      void* const aNewData = realloc(pColumn->m_aData, cBytesPerUnit * cNewCapacity);
+      if(nullptr == aNewData) {
+         // according to the realloc spec, if realloc fails to allocate the new memory, it returns nullptr BUT the old
+         // memory is valid, so leave m_aData alone and free it when the builder is freed
+         LOG_0(Trace_Warning, "WARNING EnsureColumnCapacity nullptr == aNewData");
+         return Error_OutOfMemory;
+      }
+      pColumn->m_aData = aNewData;
+      pColumn->m_cCapacity = cNewCapacity;
+   }
+   return Error_None;
+}
+
+static ErrorEbm AppendColumnSamples(DataSetBuilder* const pDataSetBuilder,
+      const size_t iColumn,
+      const IntEbm countSamples,
+      const void* const aSamples,
+      const char* const sFunctionName) {
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_N(Trace_Error, "ERROR %s countSamples is outside the range of a valid index", sFunctionName);
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   if(size_t{0} == cSamples) {
+      return Error_None;
+   }
+   if(nullptr == aSamples) {
+      LOG_N(Trace_Error, "ERROR %s nullptr == samples", sFunctionName);
+      return Error_IllegalParamVal;
+   }
+
+   BuilderColumn* const pColumn = &ArrayToPointer(pDataSetBuilder->m_aColumns)[iColumn];
+   const size_t cSamplesBefore = pColumn->m_cSamples;
+   if(IsAddError(cSamplesBefore, cSamples)) {
+      LOG_N(Trace_Error, "ERROR %s IsAddError(cSamplesBefore, cSamples)", sFunctionName);
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamplesAfter = cSamplesBefore + cSamples;
+   if(IsConvertError<UIntShared>(cSamplesAfter) || IsConvertError<IntEbm>(cSamplesAfter)) {
+      LOG_N(Trace_Error, "ERROR %s too many samples", sFunctionName);
+      return Error_IllegalParamVal;
+   }
+
+   static_assert(sizeof(IntEbm) == sizeof(double), "weights and targets are staged in 8 byte items");
+   const ErrorEbm error = EnsureColumnCapacity(pColumn, cSamplesAfter, pDataSetBuilder->m_cSamplesHint, sizeof(double));
+   if(Error_None != error) {
+      return error;
+   }
+
+   // the values are checked by AppendWeight or AppendTarget when the shared dataset is filled
+   memcpy(static_cast<unsigned char*>(pColumn->m_aData) + sizeof(double) * cSamplesBefore,
+         aSamples,
+         sizeof(double) * cSamples);
+   pColumn->m_cSamples = cSamplesAfter;
+   return Error_None;
+}
+
+WARNING_PUSH
+WARNING_REDUNDANT_CODE
+static IntEbm AppendBuilder(
+      const DataSetBuilder* const pDataSetBuilder, const size_t cBytesAllocated, unsigned char* const pFillMem) {
+   const size_t cFeatures = pDataSetBuilder->m_cFeatures;
+   const size_t cWeights = pDataSetBuilder->m_cWeights;
+   const size_t cTargets = pDataSetBuilder->m_cTargets;
+   const size_t cColumns = cFeatures + cWeights + cTargets;
+
+   const BuilderColumn* const aColumns = ArrayToPointer(pDataSetBuilder->m_aColumns);
+
+   size_t cSamples = 0;
+   if(size_t{0} != cColumns) {
+      cSamples = aColumns[0].m_cSamples;
+      for(size_t iColumn = 1; iColumn < cColumns; ++iColumn) {
+         if(cSamples != aColumns[iColumn].m_cSamples) {
+            LOG_0(Trace_Error, "ERROR AppendBuilder the columns do not have the same number of samples");
+            return Error_IllegalParamVal;
+         }
+      }
+   }
+   // AppendColumnSamples and AppendFeatureBins ensure these are convertible
+   EBM_ASSERT(!IsConvertError<IntEbm>(cSamples));
+   const IntEbm countSamples = static_cast<IntEbm>(cSamples);
+
+   IntEbm ret = AppendHeader(static_cast<IntEbm>(cFeatures),
+         static_cast<IntEbm>(cWeights),
+         static_cast<IntEbm>(cTargets),
+         cBytesAllocated,
+         pFillMem);
+   if(ret < IntEbm{0}) {
+      return ret;
+   }
+   size_t cBytesSum = static_cast<size_t>(ret);
+
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      const BuilderColumn* const pColumn = &aColumns[iColumn];
+      if(iColumn < cFeatures) {
+         ret = AppendFeature(pColumn->m_countBinsOrClasses,
+               pColumn->m_bMissing ? EBM_TRUE : EBM_FALSE,
+               pColumn->m_bUnknown ? EBM_TRUE : EBM_FALSE,
+               pColumn->m_bNominal ? EBM_TRUE : EBM_FALSE,
+               countSamples,
+               StagedBinsReader(static_cast<const UIntShared*>(pColumn->m_aData),
+                     pColumn->m_cItemsPerBitPack,
+                     pColumn->m_cBitsPerItemMax),
+               cBytesAllocated,
+               pFillMem);
+      } else if(iColumn < cFeatures + cWeights) {
+         ret = AppendWeight(countSamples, static_cast<const double*>(pColumn->m_aData), cBytesAllocated, pFillMem);
+      } else {
+         const IntEbm countClasses = pColumn->m_countBinsOrClasses;
+         const bool bClassification = IntEbm{Task_Regression} != countClasses;
+         ret = AppendTarget(bClassification,
+               bClassification ? countClasses : IntEbm{0},
+               countSamples,
+               pColumn->m_aData,
+               nullptr,
+               cBytesAllocated,
+               pFillMem);
+      }
+      if(ret < IntEbm{0}) {
+         return ret;
+      }
+      if(nullptr == pFillMem) {
+         if(IsAddError(cBytesSum, static_cast<size_t>(ret))) {
+            LOG_0(Trace_Error, "ERROR AppendBuilder IsAddError(cBytesSum, static_cast<size_t>(ret))");
+            return Error_IllegalParamVal;
+         }
+         cBytesSum += static_cast<size_t>(ret);
+      }
+   }
+
+   if(nullptr != pFillMem) {
+      return Error_None;
+   }
+   if(IsConvertError<IntEbm>(cBytesSum)) {
+      LOG_0(Trace_Error, "ERROR AppendBuilder IsConvertError<IntEbm>(cBytesSum)");
+      return Error_IllegalParamVal;
+   }
+   return static_cast<IntEbm>(cBytesSum);
+}
+WARNING_POP
+
+static void FreeDataSetBuilderInternal(DataSetBuilder* const pDataSetBuilder, const size_t cColumns) {
+   BuilderColumn* const aColumns = ArrayToPointer(pDataSetBuilder->m_aColumns);
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      free(aColumns[iColumn].m_aData);
+   }
+   // before we free our memory, indicate it was freed so if our higher level language attempts to use it we have
+   // a chance to detect the error
+   pDataSetBuilder->m_handleVerification = k_handleVerificationBuilderFreed;
+   free(pDataSetBuilder);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CreateDataSetBuilder(IntEbm countFeatures,
+      const IntEbm* binCounts,
+      const BoolEbm* nominals,
+      IntEbm countWeights,
+      IntEbm countTargets,
+      const IntEbm* classCounts,
+      IntEbm countSamplesHint,
+      DataSetBuilderHandle* dataSetBuilderHandleOut) {
+   LOG_N(Trace_Info,
+         "Entered CreateDataSetBuilder: "
+         "countFeatures=%" IntEbmPrintf ", "
+         "binCounts=%p, "
+         "nominals=%p, "
+         "countWeights=%" IntEbmPrintf ", "
+         "countTargets=%" IntEbmPrintf ", "
+         "classCounts=%p, "
+         "countSamplesHint=%" IntEbmPrintf ", "
+         "dataSetBuilderHandleOut=%p",
+         countFeatures,
+         static_cast<const void*>(binCounts),
+         static_cast<const void*>(nominals),
+         countWeights,
+         countTargets,
+         static_cast<const void*>(classCounts),
+         countSamplesHint,
+         static_cast<void*>(dataSetBuilderHandleOut));
+
+   if(nullptr == dataSetBuilderHandleOut) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder nullptr == dataSetBuilderHandleOut");
+      return Error_IllegalParamVal;
+   }
+   *dataSetBuilderHandleOut = nullptr; // set this to nullptr as soon as possible so the caller doesn't attempt to free it
+
+   if(IsConvertError<size_t>(countFeatures) || IsConvertError<UIntShared>(countFeatures)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countFeatures is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   if(IsConvertError<size_t>(countWeights) || IsConvertError<UIntShared>(countWeights)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countWeights is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cWeights = static_cast<size_t>(countWeights);
+   if(IsConvertError<size_t>(countTargets) || IsConvertError<UIntShared>(countTargets)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countTargets is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTargets = static_cast<size_t>(countTargets);
+   if(IsConvertError<size_t>(countSamplesHint)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countSamplesHint is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamplesHint = static_cast<size_t>(countSamplesHint);
+
+   if(size_t{0} != cFeatures && (nullptr == binCounts || nullptr == nominals)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder nullptr == binCounts || nullptr == nominals");
+      return Error_IllegalParamVal;
+   }
+   if(size_t{0} != cTargets && nullptr == classCounts) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder nullptr == classCounts");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsAddError(cFeatures, cWeights, cTargets)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder IsAddError(cFeatures, cWeights, cTargets)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cColumns = cFeatures + cWeights + cTargets;
+
+   if(IsMultiplyError(sizeof(BuilderColumn), cColumns)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder IsMultiplyError(sizeof(BuilderColumn), cColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesColumns = sizeof(BuilderColumn) * cColumns;
+   static constexpr size_t k_cBytesBuilderNoColumns = offsetof(DataSetBuilder, m_aColumns);
+   if(IsAddError(k_cBytesBuilderNoColumns, cBytesColumns)) {
+      LOG_0(Trace_Error, "ERROR CreateDataSetBuilder IsAddError(k_cBytesBuilderNoColumns, cBytesColumns)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesBuilder = EbmMax(sizeof(DataSetBuilder), k_cBytesBuilderNoColumns + cBytesColumns);
+
+   DataSetBuilder* const pDataSetBuilder = static_cast<DataSetBuilder*>(malloc(cBytesBuilder));
+   if(nullptr == pDataSetBuilder) {
+      LOG_0(Trace_Warning, "WARNING CreateDataSetBuilder nullptr == pDataSetBuilder");
+      return Error_OutOfMemory;
+   }
+   pDataSetBuilder->m_handleVerification = k_handleVerificationBuilderOk;
+   pDataSetBuilder->m_cFeatures = cFeatures;
+   pDataSetBuilder->m_cWeights = cWeights;
+   pDataSetBuilder->m_cTargets = cTargets;
+   pDataSetBuilder->m_cSamplesHint = cSamplesHint;
+
+   BuilderColumn* const aColumns = ArrayToPointer(pDataSetBuilder->m_aColumns);
+   for(size_t iColumn = 0; iColumn < cColumns; ++iColumn) {
+      BuilderColumn* const pColumn = &aColumns[iColumn];
+      pColumn->m_countBinsOrClasses = 0;
+      pColumn->m_bNominal = false;
+      pColumn->m_bMissing = false;
+      pColumn->m_bUnknown = false;
+      pColumn->m_cItemsPerBitPack = 0;
+      pColumn->m_cBitsPerItemMax = 0;
+      pColumn->m_cSamples = 0;
+      pColumn->m_cCapacity = 0;
+      pColumn->m_aData = nullptr;
+   }
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const IntEbm countBins = binCounts[iFeature];
+      if(countBins <= IntEbm{1}) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countBins must be 2 or larger");
+         FreeDataSetBuilderInternal(pDataSetBuilder, cColumns);
+         return Error_IllegalParamVal;
+      }
+      if(IsConvertError<UIntShared>(countBins)) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countBins is outside the range of a valid index");
+         FreeDataSetBuilderInternal(pDataSetBuilder, cColumns);
+         return Error_IllegalParamVal;
+      }
+      const BoolEbm isNominal = nominals[iFeature];
+      if(EBM_FALSE != isNominal && EBM_TRUE != isNominal) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilder isNominal is not EBM_FALSE or EBM_TRUE");
+         FreeDataSetBuilderInternal(pDataSetBuilder, cColumns);
+         return Error_IllegalParamVal;
+      }
+
+      // stage the bins with enough bits for every bin including missing and unknown since we don't know yet if
+      // either of those will be dropped
+      const int cBitsRequiredMin = CountBitsRequired(static_cast<UIntShared>(countBins) - UIntShared{1});
+      const int cItemsPerBitPack = GetCountItemsBitPacked<UIntShared>(cBitsRequiredMin);
+
+      BuilderColumn* const pColumn = &aColumns[iFeature];
+      pColumn->m_countBinsOrClasses = countBins;
+      pColumn->m_bNominal = EBM_FALSE != isNominal;
+      pColumn->m_cItemsPerBitPack = cItemsPerBitPack;
+      pColumn->m_cBitsPerItemMax = GetCountBits<UIntShared>(cItemsPerBitPack);
+   }
+
+   for(size_t iTarget = 0; iTarget < cTargets; ++iTarget) {
+      const IntEbm countClasses = classCounts[iTarget];
+      if(IntEbm{Task_Regression} != countClasses && IsConvertError<UIntShared>(countClasses)) {
+         LOG_0(Trace_Error, "ERROR CreateDataSetBuilder countClasses must be Task_Regression or a valid index");
+         FreeDataSetBuilderInternal(pDataSetBuilder, cColumns);
+         return Error_IllegalParamVal;
+      }
+      aColumns[cFeatures + cWeights + iTarget].m_countBinsOrClasses = countClasses;
+   }
+
+   *dataSetBuilderHandleOut = reinterpret_cast<DataSetBuilderHandle>(pDataSetBuilder);
+
+   LOG_0(Trace_Info, "Exited CreateDataSetBuilder");
+
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AppendFeatureBins(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexFeature, IntEbm countSamples, const IntEbm* binIndexes) {
+   DataSetBuilder* const pDataSetBuilder = GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(indexFeature) || pDataSetBuilder->m_cFeatures <= static_cast<size_t>(indexFeature)) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureBins indexFeature is outside the range of the features");
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(countSamples)) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureBins countSamples is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamples = static_cast<size_t>(countSamples);
+   if(size_t{0} == cSamples) {
+      return Error_None;
+   }
+   if(nullptr == binIndexes) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureBins nullptr == binIndexes");
+      return Error_IllegalParamVal;
+   }
+
+   BuilderColumn* const pColumn = &ArrayToPointer(pDataSetBuilder->m_aColumns)[static_cast<size_t>(indexFeature)];
+   const size_t cSamplesBefore = pColumn->m_cSamples;
+   if(IsAddError(cSamplesBefore, cSamples)) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureBins IsAddError(cSamplesBefore, cSamples)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cSamplesAfter = cSamplesBefore + cSamples;
+   if(IsConvertError<UIntShared>(cSamplesAfter) || IsConvertError<IntEbm>(cSamplesAfter)) {
+      LOG_0(Trace_Error, "ERROR AppendFeatureBins too many samples");
+      return Error_IllegalParamVal;
+   }
+
+   const int cItemsPerBitPack = pColumn->m_cItemsPerBitPack;
+   const int cBitsPerItemMax = pColumn->m_cBitsPerItemMax;
+   const size_t cItemsPerBitPackSize = static_cast<size_t>(cItemsPerBitPack);
+
+   const size_t cDataUnits = (cSamplesAfter - size_t{1}) / cItemsPerBitPackSize + size_t{1};
+   const size_t cDataUnitsHint = size_t{0} == pDataSetBuilder->m_cSamplesHint ?
+         size_t{0} :
+         (pDataSetBuilder->m_cSamplesHint - size_t{1}) / cItemsPerBitPackSize + size_t{1};
+   const ErrorEbm error = EnsureColumnCapacity(pColumn, cDataUnits, cDataUnitsHint, sizeof(UIntShared));
+   if(Error_None != error) {
+      return error;
+   }
+
+   // the staged items are packed starting from the top bits of the first UIntShared, which lets us continue the
+   // previous chunk without knowing the final number of samples
+   UIntShared* pFillData = static_cast<UIntShared*>(pColumn->m_aData) + cSamplesBefore / cItemsPerBitPackSize;
+   const int cShiftReset = (cItemsPerBitPack - 1) * cBitsPerItemMax;
+   int cShift = cShiftReset - static_cast<int>(cSamplesBefore % cItemsPerBitPackSize) * cBitsPerItemMax;
+   // keep the items from the previous chunk and clear anything a failed chunk might have left behind
+   UIntShared bits = cShiftReset == cShift ? UIntShared{0} :
+                                             *pFillData & ~MakeLowMask<UIntShared>(cShift + cBitsPerItemMax);
+
+   const IntEbm countBins = pColumn->m_countBinsOrClasses;
+   const IntEbm indexUnknown = countBins - IntEbm{1};
+   bool bMissing = false;
+   bool bUnknown = false;
+
+   const IntEbm* pBinIndex = binIndexes;
+   const IntEbm* const pBinIndexesEnd = binIndexes + cSamples;
+   do {
+      const IntEbm indexBin = *pBinIndex;
+      if(indexBin < IntEbm{0}) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureBins indexBin can't be negative");
+         return Error_IllegalParamVal;
+      }
+      if(countBins <= indexBin) {
+         LOG_0(Trace_Error, "ERROR AppendFeatureBins countBins <= indexBin");
+         return Error_IllegalParamVal;
+      }
+      bMissing |= IntEbm{0} == indexBin;
+      bUnknown |= indexUnknown == indexBin;
+
+      EBM_ASSERT(0 <= cShift);
+      EBM_ASSERT(cShift < COUNT_BITS(UIntShared));
+      bits |= static_cast<UIntShared>(indexBin) << cShift;
+      cShift -= cBitsPerItemMax;
+      if(cShift < 0) {
+         *pFillData = bits;
+         ++pFillData;
+         bits = 0;
+         cShift = cShiftReset;
+      }
+      ++pBinIndex;
+   } while(pBinIndexesEnd != pBinIndex);
+   if(cShiftReset != cShift) {
+      *pFillData = bits;
+   }
+
+   pColumn->m_bMissing |= bMissing;
+   pColumn->m_bUnknown |= bUnknown;
+   pColumn->m_cSamples = cSamplesAfter;
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AppendWeights(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexWeight, IntEbm countSamples, const double* weights) {
+   DataSetBuilder* const pDataSetBuilder = GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(indexWeight) || pDataSetBuilder->m_cWeights <= static_cast<size_t>(indexWeight)) {
+      LOG_0(Trace_Error, "ERROR AppendWeights indexWeight is outside the range of the weights");
+      return Error_IllegalParamVal;
+   }
+   return AppendColumnSamples(pDataSetBuilder,
+         pDataSetBuilder->m_cFeatures + static_cast<size_t>(indexWeight),
+         countSamples,
+         weights,
+         "AppendWeights");
+}
+
+static ErrorEbm AppendTargetSamples(const DataSetBuilderHandle dataSetBuilderHandle,
+      const bool bClassification,
+      const IntEbm indexTarget,
+      const IntEbm countSamples,
+      const void* const aTargets,
+      const char* const sFunctionName) {
+   DataSetBuilder* const pDataSetBuilder = GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   if(IsConvertError<size_t>(indexTarget) || pDataSetBuilder->m_cTargets <= static_cast<size_t>(indexTarget)) {
+      LOG_N(Trace_Error, "ERROR %s indexTarget is outside the range of the targets", sFunctionName);
+      return Error_IllegalParamVal;
+   }
+   const size_t iColumn =
+         pDataSetBuilder->m_cFeatures + pDataSetBuilder->m_cWeights + static_cast<size_t>(indexTarget);
+   const IntEbm countClasses = ArrayToPointer(pDataSetBuilder->m_aColumns)[iColumn].m_countBinsOrClasses;
+   if(bClassification == (IntEbm{Task_Regression} == countClasses)) {
+      LOG_N(Trace_Error, "ERROR %s the target was created with a different task", sFunctionName);
+      return Error_IllegalParamVal;
+   }
+   return AppendColumnSamples(pDataSetBuilder, iColumn, countSamples, aTargets, sFunctionName);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AppendClassificationTargets(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexTarget, IntEbm countSamples, const IntEbm* targets) {
+   return AppendTargetSamples(
+         dataSetBuilderHandle, true, indexTarget, countSamples, targets, "AppendClassificationTargets");
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION AppendRegressionTargets(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexTarget, IntEbm countSamples, const double* targets) {
+   return AppendTargetSamples(
+         dataSetBuilderHandle, false, indexTarget, countSamples, targets, "AppendRegressionTargets");
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureDataSetBuilder(DataSetBuilderHandle dataSetBuilderHandle) {
+   const DataSetBuilder* const pDataSetBuilder = GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+   return AppendBuilder(pDataSetBuilder, 0, nullptr);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillDataSetBuilder(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm countBytesAllocated, void* fillMem) {
+   const DataSetBuilder* const pDataSetBuilder = GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr == pDataSetBuilder) {
+      // already logged
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillDataSetBuilder nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillDataSetBuilder countBytesAllocated is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   const IntEbm ret = AppendBuilder(pDataSetBuilder, cBytesAllocated, static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+EBM_API_BODY void EBM_CALLING_CONVENTION FreeDataSetBuilder(DataSetBuilderHandle dataSetBuilderHandle) {
+   LOG_N(Trace_Info,
+         "Entered FreeDataSetBuilder: dataSetBuilderHandle=%p",
+         static_cast<void*>(dataSetBuilderHandle));
+
+   if(nullptr == dataSetBuilderHandle) {
+      // like free(), freeing nullptr is legal
+      return;
+   }
+   DataSetBuilder* const pDataSetBuilder = GetDataSetBuilderFromHandle(dataSetBuilderHandle);
+   if(nullptr != pDataSetBuilder) {
+      FreeDataSetBuilderInternal(pDataSetBuilder,
+            pDataSetBuilder->m_cFeatures + pDataSetBuilder->m_cWeights + pDataSetBuilder->m_cTargets);
+   }
+
+   LOG_0(Trace_Info, "Exited FreeDataSetBuilder");
+}
+
 extern ErrorEbm GetDataSetSharedHeader(const unsigned char* const pDataSetShared,
+      const bool bChecked,
       UIntShared* const pcSamplesOut,
       size_t* const pcFeaturesOut,
       size_t* const pcWeightsOut,
@@ -1881,7 +2867,8 @@ extern ErrorEbm GetDataSetSharedHeader(const unsigned char* const pDataSetShared
    EBM_ASSERT(nullptr != pcWeightsOut);
    EBM_ASSERT(nullptr != pcTargetsOut);
 
-   const ErrorEbm error = CheckDataSet(0, pDataSetShared);
+   // a checked dataset still gets every structural check, but its samples were already scanned when it was checked
+   const ErrorEbm error = CheckDataSetInternal(0, pDataSetShared, !bChecked);
    if(Error_None != error) {
       return error;
    }
@@ -1919,7 +2906,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractDataSetHeader(const void* da
    size_t cTargets;
 
    const ErrorEbm error = GetDataSetSharedHeader(
-         static_cast<const unsigned char*>(dataSet), &countSamples, &cFeatures, &cWeights, &cTargets);
+         static_cast<const unsigned char*>(dataSet), false, &countSamples, &cFeatures, &cWeights, &cTargets);
    if(Error_None != error) {
       // already logged
       return error;
@@ -2215,11 +3202,29 @@ extern const void* GetDataSetSharedTarget(
       cClasses = static_cast<ptrdiff_t>(countClasses);
       EBM_ASSERT(0 <= cClasses); // 0 is possible with 0 samples
       pRet = reinterpret_cast<const void*>(pClassificationTargetDataSetShared + 1);
+   } else if(IsRankingTarget(id)) {
+      cClasses = ptrdiff_t{Task_Ranking};
    }
    *pcClassesOut = cClasses;
    return pRet;
 }
 
+extern const UIntShared* GetDataSetSharedQueryGroups(const unsigned char* const pDataSetShared, const size_t iTarget) {
+   const HeaderDataSetShared* const pHeaderDataSetShared = reinterpret_cast<const HeaderDataSetShared*>(pDataSetShared);
+   EBM_ASSERT(k_sharedDataSetDoneId == pHeaderDataSetShared->m_id);
+
+   ptrdiff_t cClasses;
+   const FloatShared* const aRelevances =
+         static_cast<const FloatShared*>(GetDataSetSharedTarget(pDataSetShared, iTarget, &cClasses));
+   EBM_ASSERT(nullptr != aRelevances); // ranking targets have no class count that could fail the conversion
+   EBM_ASSERT(ptrdiff_t{Task_Ranking} == cClasses);
+
+   // the query ids follow the relevance label of every sample
+   const UIntShared countSamples = pHeaderDataSetShared->m_cSamples;
+   EBM_ASSERT(!IsConvertError<size_t>(countSamples));
+   return reinterpret_cast<const UIntShared*>(aRelevances + static_cast<size_t>(countSamples));
+}
+
 EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractTargetClasses(
       const void* dataSet, IntEbm countTargetsVerify, IntEbm* classCountsOut) {
    if(nullptr == dataSet) {
@@ -2279,7 +3284,7 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractTargetClasses(
          const UIntShared id = pTargetDataSetShared->m_id;
          EBM_ASSERT(IsTarget(id));
 
-         IntEbm countClasses = IntEbm{Task_Regression};
+         IntEbm countClasses = IsRankingTarget(id) ? IntEbm{Task_Ranking} : IntEbm{Task_Regression};
          if(IsClassificationTarget(id)) {
             const ClassificationTargetDataSetShared* const pClassificationTargetDataSetShared =
                   reinterpret_cast<const ClassificationTargetDataSetShared*>(pTargetDataSetShared + 1);
@@ -28,7 +28,10 @@ static_assert(std::is_standard_layout<SparseFeatureDataSetSharedEntry>::value,
 static_assert(std::is_trivial<SparseFeatureDataSetSharedEntry>::value,
       "These structs are shared between processes, so they definetly need to be standard layout and trivial");
 
+// bChecked skips the O(samples) CheckDataSet scan for a dataset that was already checked, either earlier in the same
+// call or when its dataset file header was written.  The header, offsets, and bin counts are checked either way
 extern ErrorEbm GetDataSetSharedHeader(const unsigned char* const pDataSetShared,
+      const bool bChecked,
       UIntShared* const pcSamplesOut,
       size_t* const pcFeaturesOut,
       size_t* const pcWeightsOut,
@@ -47,10 +50,13 @@ extern const void* GetDataSetSharedFeature(const unsigned char* const pDataSetSh
 
 extern const FloatShared* GetDataSetSharedWeight(const unsigned char* const pDataSetShared, const size_t iWeight);
 
-// GetDataSetSharedTarget returns (FloatShared *) for regression and (UIntShared *) for classification
+// GetDataSetSharedTarget returns (FloatShared *) for regression and ranking and (UIntShared *) for classification
 extern const void* GetDataSetSharedTarget(
       const unsigned char* const pDataSetShared, const size_t iTarget, ptrdiff_t* const pcClassesOut);
 
+// only valid for ranking targets, where every query's samples are contiguous and the query ids never decrease
+extern const UIntShared* GetDataSetSharedQueryGroups(const unsigned char* const pDataSetShared, const size_t iTarget);
+
 } // namespace DEFINED_ZONE_NAME
 
 #endif // DATASET_SHARED_HPP
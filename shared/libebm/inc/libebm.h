@@ -120,10 +120,16 @@ typedef int32_t AccelerationFlags;
 // printf hexidecimals must be unsigned, so convert first to unsigned before calling printf
 typedef uint32_t UAccelerationFlags;
 #define UAccelerationFlagsPrintf PRIx32
+typedef int32_t ThreadPoolFlags;
+// printf hexidecimals must be unsigned, so convert first to unsigned before calling printf
+typedef uint32_t UThreadPoolFlags;
+#define UThreadPoolFlagsPrintf PRIx32
 typedef int32_t LinkEbm;
 #define LinkEbmPrintf PRId32
 typedef int64_t TaskEbm;
 #define TaskEbmPrintf PRId64
+typedef int32_t StatEbm;
+#define StatEbmPrintf PRId32
 
 typedef struct _BoosterHandle {
    uint32_t handleVerification; // should be 10995 if ok. Do not use size_t since that requires an additional header.
@@ -133,6 +139,10 @@ typedef struct _InteractionHandle {
    uint32_t handleVerification; // should be 21773 if ok. Do not use size_t since that requires an additional header.
 }* InteractionHandle;
 
+typedef struct _DataSetBuilderHandle {
+   uint32_t handleVerification; // should be 17339 if ok. Do not use size_t since that requires an additional header.
+}* DataSetBuilderHandle;
+
 #define BOOL_CAST(val)                     (STATIC_CAST(BoolEbm, (val)))
 #define MONOTONE_CAST(val)                 (STATIC_CAST(MonotoneDirection, (val)))
 #define ERROR_CAST(val)                    (STATIC_CAST(ErrorEbm, (val)))
@@ -142,9 +152,11 @@ typedef struct _InteractionHandle {
 #define TERM_BOOST_FLAGS_CAST(val)         (STATIC_CAST(TermBoostFlags, (val)))
 #define CALC_INTERACTION_FLAGS_CAST(val)   (STATIC_CAST(CalcInteractionFlags, (val)))
 #define ACCELERATION_CAST(val)             (STATIC_CAST(AccelerationFlags, (val)))
+#define THREAD_POOL_FLAGS_CAST(val)        (STATIC_CAST(ThreadPoolFlags, (val)))
 #define TRACE_CAST(val)                    (STATIC_CAST(TraceEbm, (val)))
 #define LINK_CAST(val)                     (STATIC_CAST(LinkEbm, (val)))
 #define TASK_CAST(val)                     (STATIC_CAST(TaskEbm, (val)))
+#define STAT_CAST(val)                     (STATIC_CAST(StatEbm, (val)))
 
 // TODO: look through our code for places where SAFE_FLOAT64_AS_INT64_MAX or FLOAT64_TO_INT64_MAX would be useful
 
@@ -213,6 +225,12 @@ typedef struct _InteractionHandle {
 #define CreateBoosterFlags_DifferentialPrivacy (CREATE_BOOSTER_FLAGS_CAST(0x00000001))
 #define CreateBoosterFlags_DisableApprox       (CREATE_BOOSTER_FLAGS_CAST(0x00000002))
 #define CreateBoosterFlags_BinaryAsMulticlass  (CREATE_BOOSTER_FLAGS_CAST(0x00000004))
+#define CreateBoosterFlags_PoissonBags         (CREATE_BOOSTER_FLAGS_CAST(0x00000008))
+// asks the OS for transparent huge pages under the bins, tree nodes and other boosting scratch memory.  Linux only
+#define CreateBoosterFlags_HugePages           (CREATE_BOOSTER_FLAGS_CAST(0x00000010))
+// the dataset passed CheckDataSetFile, so skip the per sample scan of CheckDataSet.  The structure is still checked
+// and the bins and targets that are used are checked as they are read
+#define CreateBoosterFlags_CheckedDataSet      (CREATE_BOOSTER_FLAGS_CAST(0x00000020))
 
 #define TermBoostFlags_Default             (TERM_BOOST_FLAGS_CAST(0x00000000))
 #define TermBoostFlags_DisableNewtonGain   (TERM_BOOST_FLAGS_CAST(0x00000001))
@@ -226,6 +244,9 @@ typedef struct _InteractionHandle {
 #define CreateInteractionFlags_DifferentialPrivacy (CREATE_INTERACTION_FLAGS_CAST(0x00000001))
 #define CreateInteractionFlags_DisableApprox       (CREATE_INTERACTION_FLAGS_CAST(0x00000002))
 #define CreateInteractionFlags_BinaryAsMulticlass  (CREATE_INTERACTION_FLAGS_CAST(0x00000004))
+// the dataset passed CheckDataSetFile, so skip the per sample scan of CheckDataSet.  The structure is still checked
+// and the bins and targets that are used are checked as they are read
+#define CreateInteractionFlags_CheckedDataSet      (CREATE_INTERACTION_FLAGS_CAST(0x00000008))
 
 #define CalcInteractionFlags_Default       (CALC_INTERACTION_FLAGS_CAST(0x00000000))
 #define CalcInteractionFlags_DisableNewton (CALC_INTERACTION_FLAGS_CAST(0x00000001))
@@ -240,6 +261,10 @@ typedef struct _InteractionHandle {
 #define AccelerationFlags_GPU       (AccelerationFlags_Nvidia)
 #define AccelerationFlags_ALL       (ACCELERATION_CAST(~ACCELERATION_CAST(0)))
 
+#define ThreadPoolFlags_Default     (THREAD_POOL_FLAGS_CAST(0x00000000))
+#define ThreadPoolFlags_PinCores    (THREAD_POOL_FLAGS_CAST(0x00000001))
+#define ThreadPoolFlags_SpreadNodes (THREAD_POOL_FLAGS_CAST(0x00000002))
+
 // No messages will be logged. This is the default.
 #define Trace_Off (TRACE_CAST(0))
 // Invalid inputs to the C interface, internal errors, or assert failures before exiting. Cannot continue afterwards.
@@ -290,6 +315,32 @@ typedef struct _InteractionHandle {
 #define Task_BinaryClassification  (TASK_CAST(2)) // 2 classes
 #define Task_MulticlassPlus        (TASK_CAST(3)) // 3+ classes (the value is the # of classes)
 
+// GetBoosterStats reports BoosterStatItem_COUNT counters for each of these phases, per term and per compute zone
+#define BoosterStat_BinSums       (STAT_CAST(0)) // histogram building over the training samples
+#define BoosterStat_TensorTotals  (STAT_CAST(1)) // prefix sums over multi-dimensional histograms
+#define BoosterStat_Partition     (STAT_CAST(2)) // choosing splits and calculating the update tensor
+#define BoosterStat_ApplyUpdate   (STAT_CAST(3)) // updating the training sample scores and gradients
+#define BoosterStat_Validation    (STAT_CAST(4)) // updating the validation sample scores and calculating the metric
+#define BoosterStat_BestModelCopy (STAT_CAST(5)) // copying the current model to the best model after an improvement
+#define BoosterStat_COUNT         (STAT_CAST(6))
+
+#define BoosterStatZone_cpu_64  (STAT_CAST(0))
+#define BoosterStatZone_avx2    (STAT_CAST(1))
+#define BoosterStatZone_avx512f (STAT_CAST(2))
+#define BoosterStatZone_COUNT   (STAT_CAST(3))
+
+#define BoosterStatItem_Calls       (STAT_CAST(0))
+#define BoosterStatItem_Nanoseconds (STAT_CAST(1))
+// bytes of sample data or tensor memory that the phase streamed through
+#define BoosterStatItem_Bytes (STAT_CAST(2))
+#define BoosterStatItem_COUNT       (STAT_CAST(3))
+
+// GetBoosterScratchStats reports on the memory that each GenerateTermUpdate and ApplyTermUpdate step borrows
+#define ScratchStat_PeakBytes     (STAT_CAST(0)) // the most scratch bytes that one step used at once
+#define ScratchStat_ReservedBytes (STAT_CAST(1)) // the scratch bytes that the booster holds on to between steps
+#define ScratchStat_Blocks        (STAT_CAST(2)) // the number of times the scratch memory had to be allocated
+#define ScratchStat_COUNT         (STAT_CAST(3))
+
 // All our logging messages are pure ASCII (127 values), and therefore also conform to UTF-8
 typedef void(EBM_CALLING_CONVENTION* LogCallbackFunction)(TraceEbm traceLevel, const char* message);
 
@@ -298,6 +349,40 @@ EBM_API_INCLUDE void EBM_CALLING_CONVENTION SetLogCallback(LogCallbackFunction l
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION SetTraceLevel(TraceEbm traceLevel);
 EBM_API_INCLUDE const char* EBM_CALLING_CONVENTION GetTraceLevelString(TraceEbm traceLevel);
 
+// The timeline records begin/end events for CreateBooster, GenerateTermUpdate, ApplyTermUpdate,
+// CreateInteractionDetector, and CalcInteractionStrength, tagged with the term index and sample counts.  Each thread
+// keeps its most recent events.  FillTimelineJson writes a null terminated Chrome trace-event JSON document of the
+// events since the last StartTimeline, which can be loaded into chrome://tracing or ui.perfetto.dev.  Recording can
+// continue while filling, but FillTimelineJson fails if more events arrive than MeasureTimelineJson left room for.
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION StartTimeline(void);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION StopTimeline(void);
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureTimelineJson(void);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillTimelineJson(IntEbm countBytesAllocated, char* jsonOut);
+
+// The heavy loops (multi-column binning, the per-subset score updates, and the per-subset interaction bin sums) can run
+// on a library-wide worker pool.  The pool is off until SetThreadPool or SetParallelForCallback is called, so by
+// default libebm does all work on the calling thread and never starts threads of its own.  SetThreadPool replaces the
+// pool configuration and joins any workers it had.  countThreads includes the calling thread, 1 returns to serial work,
+// and 0 means one thread per core (or per core on numaNode when numaNode is not -1).  The workers start on the first
+// parallel loop, are joined when the library is unloaded, and do not exist in a forked child, which starts its own
+// workers when it next needs them.  ThreadPoolFlags_PinCores pins each worker to a single core.
+// ThreadPoolFlags_SpreadNodes spreads the workers over every NUMA node instead, and boosters created afterwards place
+// each data subset's memory on the node whose workers process it.  Pinning and NUMA placement are only honored on Linux
+// and are ignored elsewhere.  SetThreadPool cannot be called while other threads are inside libebm, or from inside a
+// ParallelTaskFunction.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetThreadPool(
+      IntEbm countThreads, ThreadPoolFlags flags, IntEbm numaNode);
+
+// Hosts that already own a thread pool can take over the dispatch instead.  parallelFor must call
+// task(taskContext, indexTask) exactly once for each indexTask in [0, countTasks) on any threads in any order, return
+// once they have all completed, and return the first non-zero ErrorEbm that a task returned, or Error_None.  Passing a
+// null parallelFor returns to the internal pool.
+typedef ErrorEbm(EBM_CALLING_CONVENTION* ParallelTaskFunction)(void* taskContext, IntEbm indexTask);
+typedef ErrorEbm(EBM_CALLING_CONVENTION* ParallelForFunction)(
+      void* callbackContext, IntEbm countTasks, ParallelTaskFunction task, void* taskContext);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetParallelForCallback(
+      ParallelForFunction parallelFor, void* callbackContext);
+
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION CleanFloats(IntEbm count, double* valsInOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SafeMean(
       IntEbm countBags, IntEbm countTensorBins, const double* vals, const double* weights, double* tensorOut);
@@ -311,6 +396,13 @@ EBM_API_INCLUDE void EBM_CALLING_CONVENTION BranchRNG(void* rng, void* rngOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateSeed(void* rng, SeedEbm* seedOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateGaussianRandom(
       void* rng, double stddev, IntEbm count, double* randomOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateGaussianRandomParallel(
+      void* rng, double stddev, IntEbm count, double* randomOut);
+// GenerateCounterRandom writes count 32 bit numbers, each widened to UIntEbm, from the counter based Philox4x32-10
+// generator that the parallel functions use.  The output is a pure function of key, stream and position, where position
+// counts 32 bit numbers from the start of the stream.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateCounterRandom(
+      UIntEbm key, UIntEbm stream, UIntEbm position, IntEbm count, UIntEbm* randomOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION Shuffle(void* rng, IntEbm count, IntEbm* randomOut);
 
 EBM_API_INCLUDE double EBM_CALLING_CONVENTION MeasureImpurity(IntEbm countMultiScores,
@@ -329,6 +421,49 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION Purify(double tolerance,
       double* scoresInOut,
       double* impuritiesOut,
       double* interceptOut);
+// PurifyMany calls Purify on countTensors tensors.  The tensors are purified one after another on the calling thread
+// unless SetThreadPool or SetParallelForCallback was used to opt into parallelism.  Each tensor has its own
+// countDimensions, dimensionLengths, weights, and scores, and they all share countMultiScores.  impuritiesOut and
+// interceptOut can be nullptr, or hold nullptr for the tensors that do not need them.  If iterationsOut is not nullptr
+// it receives the number of sweeps over each tensor's surface.  A tensor is converged in isConvergedOut when
+// purification ended because the tolerance was met or the purity stopped improving rather than by reaching
+// countIterationsMax.  A countIterationsMax of 0 means no limit, which makes each tensor purify exactly as Purify
+// would.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION PurifyMany(double tolerance,
+      BoolEbm isRandomized,
+      BoolEbm isMulticlassNormalization,
+      IntEbm countMultiScores,
+      IntEbm countIterationsMax,
+      IntEbm countTensors,
+      const IntEbm* countDimensions,
+      const IntEbm* const* dimensionLengths,
+      const double* const* weights,
+      double* const* scoresInOut,
+      double* const* impuritiesOut,
+      double* const* interceptOut,
+      IntEbm* iterationsOut,
+      BoolEbm* isConvergedOut);
+
+// HarmonizeTensors re-bins countTensors tensors from their own bin grids onto a shared new grid of binCounts.  Like
+// PurifyMany, the tensors are only re-binned in parallel after SetThreadPool or SetParallelForCallback.  For tensor t,
+// the old tensor has oldBinCounts[t] bins in each dimension and countScores scores per bin.  The bins of the new grid
+// are numbered dimension by dimension, so bin i of dimension d is flat bin i + binCounts[0] + ... + binCounts[d - 1].
+// Flat bin b draws from the old bins of its dimension listed in oldBinIndexes[t] from oldBinOffsets[t][b] to
+// oldBinOffsets[t][b + 1] and covers percentages[t][b] of them.  If oldBinWeights is nullptr, or holds nullptr for a
+// tensor, the old values in each new cell are summed and scaled by the product of the percentages, which is how bin
+// weights are re-binned.  Otherwise the scores are averaged, weighted by oldBinWeights[t], which has the old tensor's
+// shape without the scores.  All tensors are in C order.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION HarmonizeTensors(IntEbm countScores,
+      IntEbm countDimensions,
+      const IntEbm* binCounts,
+      IntEbm countTensors,
+      const IntEbm* const* oldBinCounts,
+      const IntEbm* const* oldBinOffsets,
+      const IntEbm* const* oldBinIndexes,
+      const double* const* percentages,
+      const double* const* oldTensors,
+      const double* const* oldBinWeights,
+      double* const* tensorsOut);
 
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION GetHistogramCutCount(IntEbm countSamples, const double* featureVals);
 // CutUniform does not fail with valid inputs, so we return the number of cuts generated
@@ -341,6 +476,32 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantile(IntEbm countSamples,
       BoolEbm isRounded,
       IntEbm* countCutsInOut,
       double* cutsLowerBoundInclusiveOut);
+// CutQuantileMany calls CutQuantile on each column using all cores.  Each column has countSamples values.  The cuts
+// for column i are packed into cutsLowerBoundInclusiveOut from cutOffsetsOut[i] to cutOffsetsOut[i + 1], and
+// cutsLowerBoundInclusiveOut needs room for the sum of countCutsMax.  cutOffsetsOut has countFeatures + 1 items.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantileMany(IntEbm countFeatures,
+      IntEbm countSamples,
+      const double* const* featureCols,
+      const IntEbm* minSamplesBin,
+      const BoolEbm* isRounded,
+      const IntEbm* countCutsMax,
+      IntEbm* cutOffsetsOut,
+      double* cutsLowerBoundInclusiveOut);
+// A quantile sketch is a bounded size, mergeable summary of a column for columns too large for CutQuantile to sort.
+// The sketch is a flat buffer of MeasureQuantileSketch bytes that can be built per chunk or per thread, merged, and
+// then cut.  Larger countItemsPerLevel values give more accurate cuts.  If fewer than countItemsPerLevel
+// non-missing samples were added, CutQuantileSketch returns the same cuts as CutQuantile.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureQuantileSketch(IntEbm countItemsPerLevel);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION InitQuantileSketch(
+      IntEbm countItemsPerLevel, IntEbm countBytesAllocated, void* sketchOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AddQuantileSketch(
+      IntEbm countSamples, const double* featureVals, void* sketchInOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION MergeQuantileSketch(const void* sketch, void* sketchInOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutQuantileSketch(const void* sketch,
+      IntEbm minSamplesBin,
+      BoolEbm isRounded,
+      IntEbm* countCutsInOut,
+      double* cutsLowerBoundInclusiveOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CutWinsorized(
       IntEbm countSamples, const double* featureVals, IntEbm* countCutsInOut, double* cutsLowerBoundInclusiveOut);
 
@@ -357,6 +518,23 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION Discretize(IntEbm countSamples,
       IntEbm countCuts,
       const double* cutsLowerBoundInclusive,
       IntEbm* binIndexesOut);
+// DiscretizeMany calls Discretize on each column using all cores with the cuts packed as CutQuantileMany returns them.
+// binIndexesOut holds countFeatures * countSamples items with the bins for column i starting at i * countSamples.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DiscretizeMany(IntEbm countFeatures,
+      IntEbm countSamples,
+      const double* const* featureCols,
+      const IntEbm* cutOffsets,
+      const double* cutsLowerBoundInclusive,
+      IntEbm* binIndexesOut);
+
+// FloatsToString writes the shortest text that converts back to the identical float, formatted identically to
+// python's repr except that integers up to 2^53 - 1 have no decimal point, eg: "4" instead of "4.0".  The floats are
+// separated by single spaces.  strOut needs countFloats * GetCountCharactersPerFloat() characters, or 1 character if
+// countFloats is zero.  StringToFloats reads exactly countFloats whitespace separated numbers and is exact for any
+// text that FloatsToString can produce.  Neither depends on the current C locale.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION GetCountCharactersPerFloat(void);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FloatsToString(IntEbm countFloats, const double* vals, char* strOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION StringToFloats(const char* str, IntEbm countFloats, double* valsOut);
 
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureDataSetHeader(
       IntEbm countFeatures, IntEbm countWeights, IntEbm countTargets);
@@ -370,6 +548,8 @@ EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureWeight(IntEbm countSamples,
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureClassificationTarget(
       IntEbm countClasses, IntEbm countSamples, const IntEbm* targets);
 EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureRegressionTarget(IntEbm countSamples, const double* targets);
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureRankingTarget(
+      IntEbm countSamples, const double* relevances, const IntEbm* queryGroups);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillDataSetHeader(
       IntEbm countFeatures, IntEbm countWeights, IntEbm countTargets, IntEbm countBytesAllocated, void* fillMem);
@@ -387,9 +567,52 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillClassificationTarget(
       IntEbm countClasses, IntEbm countSamples, const IntEbm* targets, IntEbm countBytesAllocated, void* fillMem);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillRegressionTarget(
       IntEbm countSamples, const double* targets, IntEbm countBytesAllocated, void* fillMem);
+// A ranking target holds a relevance label and a query group id per sample.  The query group ids must be
+// non-negative and sorted so that the documents of each query are contiguous.  ExtractTargetClasses reports
+// Task_Ranking for it.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillRankingTarget(IntEbm countSamples,
+      const double* relevances,
+      const IntEbm* queryGroups,
+      IntEbm countBytesAllocated,
+      void* fillMem);
+
+// The DataSetBuilder constructs the same dataset as the Measure/Fill functions above from chunks of samples.  Chunks
+// can be appended per feature or as row blocks across all the columns.  The missing and unknown bins are kept only
+// if a bin index of 0 or countBins - 1 was appended.  classCounts uses Task_Regression for regression targets.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateDataSetBuilder(IntEbm countFeatures,
+      const IntEbm* binCounts,
+      const BoolEbm* nominals,
+      IntEbm countWeights,
+      IntEbm countTargets,
+      const IntEbm* classCounts,
+      IntEbm countSamplesHint,
+      DataSetBuilderHandle* dataSetBuilderHandleOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AppendFeatureBins(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexFeature, IntEbm countSamples, const IntEbm* binIndexes);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AppendWeights(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexWeight, IntEbm countSamples, const double* weights);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AppendClassificationTargets(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexTarget, IntEbm countSamples, const IntEbm* targets);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION AppendRegressionTargets(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm indexTarget, IntEbm countSamples, const double* targets);
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureDataSetBuilder(DataSetBuilderHandle dataSetBuilderHandle);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillDataSetBuilder(
+      DataSetBuilderHandle dataSetBuilderHandle, IntEbm countBytesAllocated, void* fillMem);
+EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeDataSetBuilder(DataSetBuilderHandle dataSetBuilderHandle);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CheckDataSet(IntEbm countBytesAllocated, const void* dataSet);
 
+// A dataset file is the MeasureDataSetFileHeader() bytes from FillDataSetFileHeader followed by the dataset bytes.
+// FillDataSetFileHeader runs the full CheckDataSet once and records the result, so CheckDataSetFile only inspects
+// the header unless isVerifyChecksum is set.  The dataset starts at offsetDataSetOut bytes into a mapped file and
+// can be passed directly to CreateBooster or CreateInteractionDetector.  Pass CreateBoosterFlags_CheckedDataSet or
+// CreateInteractionFlags_CheckedDataSet with it so that they do not scan the whole dataset again.
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureDataSetFileHeader(void);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillDataSetFileHeader(
+      IntEbm countBytesDataSet, const void* dataSet, IntEbm countBytesAllocated, void* fillMem);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CheckDataSetFile(
+      IntEbm countBytesFile, const void* dataSetFile, BoolEbm isVerifyChecksum, IntEbm* offsetDataSetOut);
+
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractDataSetHeader(const void* dataSet,
       IntEbm* countSamplesOut,
       IntEbm* countFeaturesOut,
@@ -402,6 +625,54 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractBinCounts(
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractTargetClasses(
       const void* dataSet, IntEbm countTargetsVerify, IntEbm* classCountsOut);
 
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureModelHeader(IntEbm countFeatures, IntEbm countTerms);
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureModelCuts(IntEbm countCuts);
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureModelCategories(IntEbm countCategories, IntEbm countBytesStrings);
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureModelTerm(
+      IntEbm countScores, IntEbm countDimensions, const IntEbm* dimensionLengths, BoolEbm hasWeights);
+
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillModelHeader(
+      IntEbm countFeatures, IntEbm countTerms, IntEbm countScores, IntEbm countBytesAllocated, void* fillMem);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillModelCuts(
+      IntEbm countCuts, const double* cuts, IntEbm countBytesAllocated, void* fillMem);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillModelCategories(IntEbm countCategories,
+      const IntEbm* binIndexes,
+      IntEbm countBytesStrings,
+      const char* strings,
+      IntEbm countBytesAllocated,
+      void* fillMem);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION FillModelTerm(IntEbm countScores,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      const IntEbm* dimensionLengths,
+      const double* scores,
+      const double* binWeights,
+      IntEbm countBytesAllocated,
+      void* fillMem);
+
+// CheckModel must be called on any model that did not come directly from the Fill* functions (eg: a memory mapped
+// file) before calling the Extract* functions.  The Extract* functions return byte offsets from the start of the
+// model so that callers can create views directly over the mapped memory without copying.
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CheckModel(IntEbm countBytesAllocated, const void* model);
+
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractModelHeader(
+      const void* model, IntEbm* countFeaturesOut, IntEbm* countTermsOut, IntEbm* countScoresOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractModelFeature(const void* model,
+      IntEbm indexFeature,
+      BoolEbm* isNominalOut,
+      IntEbm* countItemsOut,
+      IntEbm* offsetItemsOut,
+      IntEbm* countBytesStringsOut,
+      IntEbm* offsetStringsOut);
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ExtractModelTerm(const void* model,
+      IntEbm indexTerm,
+      IntEbm* countDimensionsOut,
+      IntEbm* countTensorBinsOut,
+      IntEbm* offsetFeatureIndexesOut,
+      IntEbm* offsetDimensionLengthsOut,
+      IntEbm* offsetScoresOut,
+      IntEbm* offsetBinWeightsOut);
+
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacement(
       void* rng, IntEbm countTrainingSamples, IntEbm countValidationSamples, BagEbm* bagOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SampleWithoutReplacementStratified(void* rng,
@@ -420,6 +691,29 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION DetermineLinkFunction(
 EBM_API_INCLUDE const char* EBM_CALLING_CONVENTION GetLinkFunctionStr(LinkEbm link);
 EBM_API_INCLUDE LinkEbm EBM_CALLING_CONVENTION GetLinkFunctionInt(const char* link);
 
+// MeasureBooster returns the bytes that CreateBooster would allocate for the same arguments, including the scratch
+// space of the returned booster, without allocating the data.  Views from CreateBoosterView and gradient sampling from
+// SetGradientSampling add to this.  A non-zero maxBytes is a budget: when the booster would not fit, CreateBooster
+// switches the inner bags to CreateBoosterFlags_PoissonBags and then stops splitting the data across NUMA nodes,
+// and fails with Error_OutOfMemory if it still does not fit.  MeasureBooster returns the bytes after the same choices,
+// even when they exceed maxBytes.  The data is already stored as float32 whenever the acceleration flags allow a SIMD
+// zone.  Zero means no budget
+EBM_API_INCLUDE IntEbm EBM_CALLING_CONVENTION MeasureBooster(const void* dataSet,
+      const BagEbm* bag,
+      IntEbm countTerms,
+      const IntEbm* dimensionCounts,
+      const IntEbm* featureIndexes,
+      IntEbm countInnerBags,
+      CreateBoosterFlags flags,
+      AccelerationFlags acceleration,
+      const char* objective,
+      const double* experimentalParams,
+      IntEbm maxBytes);
+// A dataSet with more than one target trains a multitask model with the "log_loss" or "rmse" objective.  The targets
+// must all be binary classification or all be regression.  Each target gets one score, so the initScores and the
+// term tensors hold countTargets scores per sample and per tensor cell.  A ranking target trains with the
+// "lambdarank" objective.  The documents of a query that the bag splits between the training and validation sets are
+// ranked as separate queries in each set, so bags should normally keep or drop a query's documents together.
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       const void* dataSet,
       const BagEbm* bag,
@@ -433,10 +727,18 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBooster(void* rng,
       AccelerationFlags acceleration,
       const char* objective,
       const double* experimentalParams,
+      IntEbm maxBytes,
       BoosterHandle* boosterHandleOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateBoosterView(
       BoosterHandle boosterHandle, BoosterHandle* boosterHandleViewOut);
 EBM_API_INCLUDE void EBM_CALLING_CONVENTION FreeBooster(BoosterHandle boosterHandle);
+// gradient-based one-side sampling: after each ApplyTermUpdate, GenerateTermUpdate bins only the topFraction of
+// training samples with the largest gradients plus a random otherFraction of all samples taken from the rest, which
+// are upweighted by (1 - topFraction) / otherFraction.  On large datasets the largest gradient threshold is estimated
+// from a subset of the samples.  topFraction + otherFraction >= 1.0 turns sampling off.
+// This changes the booster and all of its views, so it must not run concurrently with any of their other calls
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetGradientSampling(
+      void* rng, BoosterHandle boosterHandle, double topFraction, double otherFraction);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GenerateTermUpdate(void* rng,
       BoosterHandle boosterHandle,
       IntEbm indexTerm,
@@ -457,12 +759,35 @@ EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetTermUpdate(
       BoosterHandle boosterHandle, double* updateScoresTensorOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetTermUpdate(
       BoosterHandle boosterHandle, IntEbm indexTerm, const double* updateScoresTensor);
+// By default ApplyTermUpdate returns the objective's own loss averaged over the validation set.  SetValidationMetric
+// replaces it with one of: "auc", "log_loss", "rmse", "mae", or "pinball:alpha=0.5", computed natively over the
+// validation set after each update and used to choose the best model.  Metrics apply to single score models.  "auc"
+// and "log_loss" need a binary classification objective ("log_loss" a logit link), and the others need a regression
+// objective with an identity or log link.  "auc" is approximate.  It is calculated from 4096 equal width buckets over
+// the range of the validation scores, with scores clipped to [-16, 16], and pairs sharing a bucket count as ties.  Its
+// error is at most half of the largest share of either class's weight that falls into one bucket.  Maximized metrics
+// like "auc" are returned negated so that lower is always better.  The metric strings return the same errors as the
+// objective strings.  A nullptr metric goes back to the objective's loss.  Changing the metric resets the best model
+// metric so that the next update becomes the best model.  This changes the booster and all of its views, so it must
+// not run concurrently with any of their other calls
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION SetValidationMetric(BoosterHandle boosterHandle, const char* metric);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION ApplyTermUpdate(
       BoosterHandle boosterHandle, double* avgValidationMetricOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBestTermScores(
       BoosterHandle boosterHandle, IntEbm indexTerm, double* termScoresTensorOut);
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetCurrentTermScores(
       BoosterHandle boosterHandle, IntEbm indexTerm, double* termScoresTensorOut);
+// termStatsOut is [countTerms][BoosterStat_COUNT][BoosterStatItem_COUNT] and zoneStatsOut is
+// [BoosterStatZone_COUNT][BoosterStat_COUNT][BoosterStatItem_COUNT]. Either can be NULL. The counters accumulate over
+// all calls made through this boosterHandle (views have their own) until they are read with isReset set.
+// The zone counters only include the phases that run inside a compute zone (BinSums, ApplyUpdate, Validation).
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBoosterStats(
+      BoosterHandle boosterHandle, BoolEbm isReset, UIntEbm* termStatsOut, UIntEbm* zoneStatsOut);
+// scratchStatsOut is [ScratchStat_COUNT].  The scratch memory is per boosterHandle (views have their own) and is
+// handed back after each ApplyTermUpdate for the next step to reuse.  The peak and block counters accumulate until
+// they are read with isReset set, so a zero ScratchStat_Blocks means that the steps since then did not allocate
+EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION GetBoosterScratchStats(
+      BoosterHandle boosterHandle, BoolEbm isReset, UIntEbm* scratchStatsOut);
 
 EBM_API_INCLUDE ErrorEbm EBM_CALLING_CONVENTION CreateInteractionDetector(const void* dataSet,
       const BagEbm* bag,
@@ -247,84 +247,6 @@ static bool FloatToFullString(const double val, char* const str) noexcept {
    return false;
 }
 
-#if 0
-
-// TODO: this entire section below!
-
-// We have a problem in that converting from a float to a string has many possible legal outputs.
-// IEEE-754 requires that if we output 17 to 20 digits for a double that the result can be converted from the
-// string back to the original double, but no guarantees are made that 16 digits or 21 digits will work,
-// and some language implementations output shorter strings like 0.25 which have exact representations in IEEE-754
-// or strings like 0.1 when 0.1 converts back to the original float representation in their representation
-// There are odd corner cases that rely on the type of rounding (IEEE-754 requires bankers' rounding for strings
-// I believe).  There are legals and illegal ways to format IEEE-754 in text specifically:
-// ISO 6093:1985 -> https://www.titanwolf.org/Network/q/4d680399-6711-4742-9900-74a42ad9f5d7/y
-// 
-// We desire cross-language identical results, so when we have cut points or categorical strings
-// of floats we want these to be identical between languages for both converting to strings and when strings
-// are converted back to floats.  This also applies to serialization to JSON and other text.  To support this
-// we implement our own converters that are guararanteed to be identical between languages.  
-// 
-// The gold standard for float/string conversion is this: https://www.netlib.org/fp/dtoa.c
-// It is used in python: https://github.com/python/cpython/blob/main/Python/dtoa.c
-// Microsoft Edge for Android uses it: https://www.microsoft.com/en-us/legal/products/notices/msedgeandroid
-// Java uses a port of this made to the Java language
-// Other languages also use this code, but not any C++ built-in libraries yet.
-// Some languages don't round trip properly with less than 17 digits.
-// Some languages are buggy and don't correctly round when outputting 17 digits.
-//
-// This implementation will progressively shorten the string until it reaches the point where the conversion
-// back won't be identical which is a stronger guarantee than IEEE-754.
-// 
-// Outputting 17 digits should be guaranteed to have a unique conversion back to float, but when shortening
-// to 16 digits there are oddities where incrementing the 16th digit upwards yields a good result but
-// chopping the 17th digit doesn't work.  I assume there are numbers where both chopping the 17th digit and
-// either moving the 16th digit up or keeping it the same yield the same result, so we need a consistent
-// policy with regards to the 16th digit.  For the 15th digit we can always chop since there are no numbers
-// where moving the 15th digit up yields the same number. One example is:
-// 2e-44 which is 5.684341886080801486968994140625e-14.  Rounded to 15 digits (5.68434188608080e-14) doesn't work.
-// Rounding down to 16 digits down doesn't work (5.684341886080801e-14), but rounding up to (5.684341886080802e-14) does work.
-// as described in: https://www.exploringbinary.com/the-shortest-decimal-string-that-round-trips-may-not-be-the-nearest/
-
-// for cut points we should always use float64 values since that gives us the best resolution, and our caller
-// could have float64 values or float32 values and cuts points that are float64 can work on both of them
-// Also, float64 is the most cross-language compatible format, and in JSON it's the only option.
-
-// for scores we should always use float64 values.  Unlike cut points, we'll be using float32 internally within
-// the booster, BUT we only need to turn scores into text for serialization to JSON, and JSON only supports
-// float64 values, so we need to output that.  We should get 100% reproducibility by turning float32 scores
-// into float64, then text, then back to float64, then back to float32, so this is fine.  The only thing
-// we loose is a bit of simplicity since our JSON scores will have more digits, but we don't have the equivalent
-// of rounded cuts anyways, so the scores will have as many decimals as we get via boosting anywyas
-
-// lastly, since there are no integers in JSON (everything is a double), we should eliminate the difference
-// between float64 and integers when numbers can be represented as unique integers.  WE should convert the float
-// 4.0 therefore to "4" for any number that meets the criteria: "floor(x) == x && abs(x) <= SAFE_FLOAT64_AS_INT64_MAX"
-
-extern IntEbm GetCountCharactersPerFloat() {
-   // for calling FloatsToStrings the caller needs to allocate this many bytes per float in the string buffer
-   // after every float is either a space separator or a null-terminator
-   return k_cCharsFloatPrint;
-}
-
-extern ErrorEbm FloatsToString(IntEbm count, const double * vals, char * str) {
-   // TODO: implement this:
-   // 
-   // This code takes an array of floats and converts them to a single string separated by spaces and a null-terminator
-   // at the end
-}
-
-extern ErrorEbm StringToFloats(const char * str, double * vals) {
-   // TODO: implement this:
-   //
-   // This code takes a single string with the floats separated by spaces and a null-terminator at the end
-   // and converts these into an array of floats.  The caller had better be carefull in allocating, but they
-   // should know how many float values they put into the string so they should know how many values they'll
-   // get back and therefore how big to make the buffer
-}
-
-#endif
-
 INLINE_RELEASE_UNTEMPLATED static long GetExponent(const char* const str) noexcept {
    // we previously checked that this converted to a long in FloatToFullString
    return strtol(&str[k_iExp + size_t{1}], nullptr, int{10});
@@ -0,0 +1,1172 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch.hpp"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy, memset
+
+#include "logging.h" // EBM_ASSERT
+#include "unzoned.h"
+
+#define ZONE_main
+#include "zones.h"
+
+#include "common.hpp" // IsConvertError
+
+#include "ebm_internal.hpp"
+#include "dataset_shared.hpp" // UIntShared
+
+namespace DEFINED_ZONE_NAME {
+#ifndef DEFINED_ZONE_NAME
+#error DEFINED_ZONE_NAME must be defined
+#endif // DEFINED_ZONE_NAME
+
+// The shared model is a flat, position independent binary container for a fitted EBM.  Text formats like JSON
+// require parsing every float on load, which for models with thousands of pair tensors takes seconds.  This format
+// is designed to be written once to a file and then mapped into memory with mmap by any number of scoring processes
+// which then share a single copy of the model in the page cache.
+//
+// Layout (all offsets are in bytes from the start of the model and every section begins on a 64 byte boundary):
+//   HeaderModelShared                 : id, version, total size, counts, and the offset of each section
+//   per feature, in order             : either cuts (continuous) or categories (nominal)
+//     FeatureModelShared
+//     continuous: double cuts[m_cItems] (strictly increasing, so it can be passed directly to Discretize)
+//     nominal:    UIntShared binIndexes[m_cItems] then m_cItems null terminated UTF-8 strings
+//   per term, in order
+//     TermModelShared
+//     UIntShared featureIndexes[m_cDimensions] then UIntShared dimensionLengths[m_cDimensions]
+//     double scores[m_cTensorBins * cScores]           (64 byte aligned)
+//     double binWeights[m_cTensorBins]                 (64 byte aligned, only if the term has weights)
+//
+// A term with zero dimensions has exactly one tensor bin, which is how an intercept can be stored.
+//
+// CheckModel only reads the header and the per-section headers, so it is O(cFeatures + cTerms) and does not touch
+// the pages holding the cut, score, or weight arrays.  Those arrays are fully validated when the model is filled.
+
+// header ids
+static constexpr UIntShared k_sharedModelWorkingId = 0x3C5D; // random 15 bit number
+static constexpr UIntShared k_sharedModelErrorId = 0x0107; // anything other than our normal id will work
+static constexpr UIntShared k_sharedModelDoneId = 0x5E27; // random 15 bit number
+
+// increment this whenever the layout changes in a way that older readers cannot handle
+static constexpr UIntShared k_sharedModelVersion = 1;
+
+// feature ids
+static constexpr UIntShared k_nominalModelBit = 0x1;
+static constexpr UIntShared k_featureModelId = 0x1A6C; // random 15 bit number with lowest bit set to zero
+
+// term ids
+static constexpr UIntShared k_weightsModelBit = 0x1;
+static constexpr UIntShared k_termModelId = 0x6D94; // random 15 bit number with lowest bit set to zero
+
+static constexpr size_t k_cBytesModelAlignment = size_t{64};
+static_assert(0 == (k_cBytesModelAlignment & (k_cBytesModelAlignment - 1)), "must be a power of 2");
+static_assert(0 == k_cBytesModelAlignment % sizeof(double), "doubles must stay aligned");
+static_assert(0 == k_cBytesModelAlignment % sizeof(UIntShared), "UIntShared must stay aligned");
+static_assert(sizeof(UIntShared) == sizeof(double), "we store UIntShared and double arrays interchangeably");
+
+INLINE_ALWAYS static bool IsFeatureModel(const UIntShared id) noexcept {
+   return (k_nominalModelBit | k_featureModelId) == (k_nominalModelBit | id);
+}
+INLINE_ALWAYS static bool IsNominalFeatureModel(const UIntShared id) noexcept {
+   static_assert(0 == (k_nominalModelBit & k_featureModelId), "k_featureModelId should not be nominal");
+   EBM_ASSERT(IsFeatureModel(id));
+   return 0 != (k_nominalModelBit & id);
+}
+INLINE_ALWAYS static bool IsTermModel(const UIntShared id) noexcept {
+   return (k_weightsModelBit | k_termModelId) == (k_weightsModelBit | id);
+}
+INLINE_ALWAYS static bool IsWeightsTermModel(const UIntShared id) noexcept {
+   static_assert(0 == (k_weightsModelBit & k_termModelId), "k_termModelId should not have weights");
+   EBM_ASSERT(IsTermModel(id));
+   return 0 != (k_weightsModelBit & id);
+}
+
+struct HeaderModelShared {
+   // m_id should be in the first position since we use it to mark validity
+   UIntShared m_id;
+
+   UIntShared m_version;
+   UIntShared m_cBytes;
+   UIntShared m_cFeatures;
+   UIntShared m_cTerms;
+   UIntShared m_cScores;
+   UIntShared m_cFilled;
+
+   // IMPORTANT: m_offsets must be in the last position for the struct hack and this must be standard layout
+   UIntShared m_offsets[1];
+};
+static_assert(std::is_standard_layout<HeaderModelShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<HeaderModelShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+
+static const size_t k_cBytesModelHeaderNoOffset = offsetof(HeaderModelShared, m_offsets);
+
+struct FeatureModelShared {
+   UIntShared m_id; // continuous or nominal
+   UIntShared m_cItems; // number of cuts for continuous, number of categories for nominal
+   UIntShared m_cBytesStrings; // zero for continuous
+};
+static_assert(std::is_standard_layout<FeatureModelShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<FeatureModelShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+
+struct TermModelShared {
+   UIntShared m_id; // with or without bin weights
+   UIntShared m_cDimensions;
+   UIntShared m_cTensorBins;
+};
+static_assert(std::is_standard_layout<TermModelShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+static_assert(std::is_trivial<TermModelShared>::value,
+      "These structs are shared between processes, so they definetly need to be standard layout and trivial");
+
+INLINE_ALWAYS static bool IsAlignModelError(const size_t cBytes) noexcept {
+   return std::numeric_limits<size_t>::max() - (k_cBytesModelAlignment - size_t{1}) < cBytes;
+}
+INLINE_ALWAYS static size_t AlignModel(const size_t cBytes) noexcept {
+   EBM_ASSERT(!IsAlignModelError(cBytes));
+   return (cBytes + (k_cBytesModelAlignment - size_t{1})) & ~(k_cBytesModelAlignment - size_t{1});
+}
+
+// all of the Get*Bytes functions return zero on overflow since no legal section can have zero bytes
+
+static size_t GetHeaderBytes(const size_t cFeatures, const size_t cTerms) {
+   if(IsAddError(cFeatures, cTerms)) {
+      return 0;
+   }
+   const size_t cOffsets = cFeatures + cTerms;
+   if(IsMultiplyError(sizeof(HeaderModelShared::m_offsets[0]), cOffsets)) {
+      return 0;
+   }
+   const size_t cBytesOffsets = sizeof(HeaderModelShared::m_offsets[0]) * cOffsets;
+   if(IsAddError(k_cBytesModelHeaderNoOffset, cBytesOffsets)) {
+      return 0;
+   }
+   const size_t cBytes = k_cBytesModelHeaderNoOffset + cBytesOffsets;
+   if(IsAlignModelError(cBytes)) {
+      return 0;
+   }
+   return AlignModel(cBytes);
+}
+
+static size_t GetFeatureBytes(const bool bNominal, const size_t cItems, const size_t cBytesStrings) {
+   EBM_ASSERT(bNominal || size_t{0} == cBytesStrings);
+   static_assert(sizeof(FeatureModelShared) <= k_cBytesModelAlignment, "the feature header should fit");
+   const size_t cItemBytes = bNominal ? sizeof(UIntShared) : sizeof(double);
+   if(IsMultiplyError(cItemBytes, cItems)) {
+      return 0;
+   }
+   const size_t cBytesItems = cItemBytes * cItems;
+   if(IsAddError(cBytesItems, cBytesStrings)) {
+      return 0;
+   }
+   const size_t cBytesData = cBytesItems + cBytesStrings;
+   if(IsAlignModelError(cBytesData)) {
+      return 0;
+   }
+   const size_t cBytesDataAligned = AlignModel(cBytesData);
+   if(IsAddError(k_cBytesModelAlignment, cBytesDataAligned)) {
+      return 0;
+   }
+   return k_cBytesModelAlignment + cBytesDataAligned;
+}
+
+static size_t GetTermHeaderBytes(const size_t cDimensions) {
+   if(IsMultiplyError(sizeof(UIntShared) * size_t{2}, cDimensions)) {
+      return 0;
+   }
+   const size_t cBytesDimensions = sizeof(UIntShared) * size_t{2} * cDimensions;
+   if(IsAddError(sizeof(TermModelShared), cBytesDimensions)) {
+      return 0;
+   }
+   const size_t cBytes = sizeof(TermModelShared) + cBytesDimensions;
+   if(IsAlignModelError(cBytes)) {
+      return 0;
+   }
+   return AlignModel(cBytes);
+}
+
+static size_t GetTermBytes(
+      const size_t cScores, const size_t cDimensions, const size_t cTensorBins, const bool bWeights) {
+   const size_t cBytesHeader = GetTermHeaderBytes(cDimensions);
+   if(size_t{0} == cBytesHeader) {
+      return 0;
+   }
+   if(IsMultiplyError(sizeof(double), cScores, cTensorBins)) {
+      return 0;
+   }
+   const size_t cBytesScores = sizeof(double) * cScores * cTensorBins;
+   if(IsAlignModelError(cBytesScores)) {
+      return 0;
+   }
+   const size_t cBytesWeights = bWeights ? sizeof(double) * cTensorBins : size_t{0};
+   if(IsAlignModelError(cBytesWeights)) {
+      return 0;
+   }
+   if(IsAddError(cBytesHeader, AlignModel(cBytesScores), AlignModel(cBytesWeights))) {
+      return 0;
+   }
+   return cBytesHeader + AlignModel(cBytesScores) + AlignModel(cBytesWeights);
+}
+
+// returns zero on overflow or if any dimension has zero bins
+template<typename T> static size_t GetTensorBins(const size_t cDimensions, const T* const aDimensionLengths) {
+   size_t cTensorBins = 1;
+   for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+      const T countBins = aDimensionLengths[iDimension];
+      if(countBins <= T{0} || IsConvertError<size_t>(countBins) || IsConvertError<UIntShared>(countBins) ||
+            IsConvertError<IntEbm>(countBins)) {
+         return 0;
+      }
+      const size_t cBins = static_cast<size_t>(countBins);
+      if(IsMultiplyError(cTensorBins, cBins)) {
+         return 0;
+      }
+      cTensorBins *= cBins;
+   }
+   return cTensorBins;
+}
+
+static ErrorEbm LockModelShared(const size_t cBytesAllocated, unsigned char* const pFillMem) {
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+   EBM_ASSERT(k_sharedModelWorkingId == pHeaderModelShared->m_id);
+
+   // breifly set this to done so that we can check it with our public CheckModel function
+   pHeaderModelShared->m_id = k_sharedModelDoneId;
+
+   EBM_ASSERT(!IsConvertError<IntEbm>(cBytesAllocated)); // it came from IntEbm
+   const ErrorEbm error = CheckModel(static_cast<IntEbm>(cBytesAllocated), pFillMem);
+   if(Error_None != error) {
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+   }
+   return error;
+}
+
+// Returns the position at which the next section should be written, or nullptr on error.  On error the header
+// is marked as bad so that any subsequent calls will fail.
+static unsigned char* StartSection(
+      const size_t cBytesSection, const size_t cBytesAllocated, unsigned char* const pFillMem, size_t* const piOffset) {
+   EBM_ASSERT(nullptr != pFillMem);
+   EBM_ASSERT(size_t{0} != cBytesSection);
+
+   if(cBytesAllocated < k_cBytesModelHeaderNoOffset + sizeof(HeaderModelShared::m_offsets[0])) {
+      LOG_0(Trace_Error, "ERROR StartSection not enough memory allocated for the shared model header");
+      return nullptr;
+   }
+
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+   if(k_sharedModelWorkingId != pHeaderModelShared->m_id) {
+      LOG_0(Trace_Error, "ERROR StartSection k_sharedModelWorkingId != pHeaderModelShared->m_id");
+      return nullptr;
+   }
+
+   const UIntShared countBytes = pHeaderModelShared->m_cBytes;
+   const UIntShared countFeatures = pHeaderModelShared->m_cFeatures;
+   const UIntShared countTerms = pHeaderModelShared->m_cTerms;
+   const UIntShared countFilled = pHeaderModelShared->m_cFilled;
+
+   // these were all checked when the header was filled, but the memory could have been modified since
+   if(IsConvertError<size_t>(countBytes) || static_cast<size_t>(countBytes) != cBytesAllocated ||
+         IsConvertError<size_t>(countFeatures) || IsConvertError<size_t>(countTerms) ||
+         IsConvertError<size_t>(countFilled)) {
+      LOG_0(Trace_Error, "ERROR StartSection corrupted shared model header");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return nullptr;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cTerms = static_cast<size_t>(countTerms);
+   const size_t cFilled = static_cast<size_t>(countFilled);
+
+   const size_t cBytesHeader = GetHeaderBytes(cFeatures, cTerms);
+   if(size_t{0} == cBytesHeader || cBytesAllocated < cBytesHeader || cFeatures + cTerms <= cFilled) {
+      LOG_0(Trace_Error, "ERROR StartSection corrupted shared model header");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return nullptr;
+   }
+
+   const UIntShared indexOffset = ArrayToPointer(pHeaderModelShared->m_offsets)[cFilled];
+   if(IsConvertError<size_t>(indexOffset)) {
+      LOG_0(Trace_Error, "ERROR StartSection corrupted shared model offset");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return nullptr;
+   }
+   const size_t iOffset = static_cast<size_t>(indexOffset);
+   if(iOffset < cBytesHeader || cBytesAllocated < iOffset || cBytesAllocated - iOffset < cBytesSection) {
+      LOG_0(Trace_Error, "ERROR StartSection not enough memory allocated for the shared model section");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return nullptr;
+   }
+
+   *piOffset = iOffset;
+   return pFillMem + iOffset;
+}
+
+static ErrorEbm FinishSection(const size_t iEnd, const size_t cBytesAllocated, unsigned char* const pFillMem) {
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+   EBM_ASSERT(k_sharedModelWorkingId == pHeaderModelShared->m_id);
+
+   const size_t cFilled = static_cast<size_t>(pHeaderModelShared->m_cFilled) + size_t{1};
+   pHeaderModelShared->m_cFilled = static_cast<UIntShared>(cFilled);
+
+   const size_t cOffsets =
+         static_cast<size_t>(pHeaderModelShared->m_cFeatures) + static_cast<size_t>(pHeaderModelShared->m_cTerms);
+   if(cOffsets == cFilled) {
+      if(iEnd != cBytesAllocated) {
+         LOG_0(Trace_Error, "ERROR FinishSection the shared model buffer is larger than required");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      return LockModelShared(cBytesAllocated, pFillMem);
+   }
+   EBM_ASSERT(cFilled < cOffsets);
+   if(cBytesAllocated <= iEnd) {
+      LOG_0(Trace_Error, "ERROR FinishSection not enough memory allocated for the remaining shared model sections");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+   ArrayToPointer(pHeaderModelShared->m_offsets)[cFilled] = static_cast<UIntShared>(iEnd);
+   return Error_None;
+}
+
+WARNING_PUSH
+WARNING_REDUNDANT_CODE
+static IntEbm AppendModelHeader(const IntEbm countFeatures,
+      const IntEbm countTerms,
+      const IntEbm countScores,
+      const size_t cBytesAllocated,
+      unsigned char* const pFillMem) {
+   EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem || nullptr != pFillMem);
+
+   LOG_N(Trace_Info,
+         "Entered AppendModelHeader: "
+         "countFeatures=%" IntEbmPrintf ", "
+         "countTerms=%" IntEbmPrintf ", "
+         "countScores=%" IntEbmPrintf ", "
+         "cBytesAllocated=%zu, "
+         "pFillMem=%p",
+         countFeatures,
+         countTerms,
+         countScores,
+         cBytesAllocated,
+         static_cast<void*>(pFillMem));
+
+   if(IsConvertError<size_t>(countFeatures) || IsConvertError<UIntShared>(countFeatures)) {
+      LOG_0(Trace_Error, "ERROR AppendModelHeader countFeatures is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+
+   if(IsConvertError<size_t>(countTerms) || IsConvertError<UIntShared>(countTerms)) {
+      LOG_0(Trace_Error, "ERROR AppendModelHeader countTerms is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cTerms = static_cast<size_t>(countTerms);
+
+   // pFillMem is nullptr when measuring, and countScores only matters when filling
+   if(nullptr != pFillMem &&
+         (countScores <= IntEbm{0} || IsConvertError<size_t>(countScores) || IsConvertError<UIntShared>(countScores))) {
+      LOG_0(Trace_Error, "ERROR AppendModelHeader countScores must be positive");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cBytesHeader = GetHeaderBytes(cFeatures, cTerms);
+   if(size_t{0} == cBytesHeader || IsConvertError<IntEbm>(cBytesHeader)) {
+      LOG_0(Trace_Error, "ERROR AppendModelHeader GetHeaderBytes overflow");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == pFillMem) {
+      return static_cast<IntEbm>(cBytesHeader);
+   }
+
+   if(cBytesAllocated < cBytesHeader) {
+      LOG_0(Trace_Error, "ERROR AppendModelHeader cBytesAllocated < cBytesHeader");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+
+   memset(pFillMem, 0, cBytesHeader);
+
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+   pHeaderModelShared->m_id = k_sharedModelWorkingId;
+   pHeaderModelShared->m_version = k_sharedModelVersion;
+   pHeaderModelShared->m_cBytes = static_cast<UIntShared>(cBytesAllocated);
+   pHeaderModelShared->m_cFeatures = static_cast<UIntShared>(cFeatures);
+   pHeaderModelShared->m_cTerms = static_cast<UIntShared>(cTerms);
+   pHeaderModelShared->m_cScores = static_cast<UIntShared>(countScores);
+   pHeaderModelShared->m_cFilled = 0;
+
+   if(size_t{0} == cFeatures && size_t{0} == cTerms) {
+      if(cBytesHeader != cBytesAllocated) {
+         LOG_0(Trace_Error, "ERROR AppendModelHeader cBytesHeader != cBytesAllocated");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      return LockModelShared(cBytesAllocated, pFillMem);
+   }
+
+   if(cBytesAllocated <= cBytesHeader) {
+      LOG_0(Trace_Error, "ERROR AppendModelHeader not enough memory allocated for the model sections");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   // position our first section right after the header.  The remaining offsets are filled as we go
+   pHeaderModelShared->m_offsets[0] = static_cast<UIntShared>(cBytesHeader);
+   return Error_None;
+}
+WARNING_POP
+
+static IntEbm AppendCuts(
+      const IntEbm countCuts, const double* const aCuts, const size_t cBytesAllocated, unsigned char* const pFillMem) {
+   EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem || nullptr != pFillMem);
+
+   LOG_N(Trace_Info,
+         "Entered AppendCuts: "
+         "countCuts=%" IntEbmPrintf ", "
+         "aCuts=%p, "
+         "cBytesAllocated=%zu, "
+         "pFillMem=%p",
+         countCuts,
+         static_cast<const void*>(aCuts),
+         cBytesAllocated,
+         static_cast<void*>(pFillMem));
+
+   if(IsConvertError<size_t>(countCuts) || IsConvertError<UIntShared>(countCuts)) {
+      LOG_0(Trace_Error, "ERROR AppendCuts countCuts is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cCuts = static_cast<size_t>(countCuts);
+
+   const size_t cBytesSection = GetFeatureBytes(false, cCuts, 0);
+   if(size_t{0} == cBytesSection || IsConvertError<IntEbm>(cBytesSection)) {
+      LOG_0(Trace_Error, "ERROR AppendCuts GetFeatureBytes overflow");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == pFillMem) {
+      return static_cast<IntEbm>(cBytesSection);
+   }
+
+   size_t iOffset;
+   unsigned char* const pSection = StartSection(cBytesSection, cBytesAllocated, pFillMem, &iOffset);
+   if(nullptr == pSection) {
+      return Error_IllegalParamVal;
+   }
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+
+   if(static_cast<size_t>(pHeaderModelShared->m_cFeatures) <= static_cast<size_t>(pHeaderModelShared->m_cFilled)) {
+      LOG_0(Trace_Error, "ERROR AppendCuts all features have already been filled");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   if(size_t{0} != cCuts) {
+      if(nullptr == aCuts) {
+         LOG_0(Trace_Error, "ERROR AppendCuts nullptr == aCuts");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      // cuts must be strictly increasing and finite so that readers can pass them directly to Discretize
+      double prev = -std::numeric_limits<double>::infinity();
+      const double* pCut = aCuts;
+      const double* const pCutsEnd = aCuts + cCuts;
+      do {
+         const double cut = *pCut;
+         if(!(prev < cut) || std::numeric_limits<double>::infinity() == cut) {
+            LOG_0(Trace_Error, "ERROR AppendCuts cuts must be finite and strictly increasing");
+            pHeaderModelShared->m_id = k_sharedModelErrorId;
+            return Error_IllegalParamVal;
+         }
+         prev = cut;
+         ++pCut;
+      } while(pCutsEnd != pCut);
+   }
+
+   memset(pSection, 0, cBytesSection);
+
+   FeatureModelShared* const pFeatureModelShared = reinterpret_cast<FeatureModelShared*>(pSection);
+   pFeatureModelShared->m_id = k_featureModelId;
+   pFeatureModelShared->m_cItems = static_cast<UIntShared>(cCuts);
+   pFeatureModelShared->m_cBytesStrings = 0;
+
+   if(size_t{0} != cCuts) {
+      memcpy(pSection + k_cBytesModelAlignment, aCuts, sizeof(*aCuts) * cCuts);
+   }
+
+   return FinishSection(iOffset + cBytesSection, cBytesAllocated, pFillMem);
+}
+
+static IntEbm AppendCategories(const IntEbm countCategories,
+      const IntEbm* const aBinIndexes,
+      const IntEbm countBytesStrings,
+      const char* const aStrings,
+      const size_t cBytesAllocated,
+      unsigned char* const pFillMem) {
+   EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem || nullptr != pFillMem);
+
+   LOG_N(Trace_Info,
+         "Entered AppendCategories: "
+         "countCategories=%" IntEbmPrintf ", "
+         "aBinIndexes=%p, "
+         "countBytesStrings=%" IntEbmPrintf ", "
+         "aStrings=%p, "
+         "cBytesAllocated=%zu, "
+         "pFillMem=%p",
+         countCategories,
+         static_cast<const void*>(aBinIndexes),
+         countBytesStrings,
+         static_cast<const void*>(aStrings),
+         cBytesAllocated,
+         static_cast<void*>(pFillMem));
+
+   if(IsConvertError<size_t>(countCategories) || IsConvertError<UIntShared>(countCategories)) {
+      LOG_0(Trace_Error, "ERROR AppendCategories countCategories is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cCategories = static_cast<size_t>(countCategories);
+
+   if(IsConvertError<size_t>(countBytesStrings) || IsConvertError<UIntShared>(countBytesStrings)) {
+      LOG_0(Trace_Error, "ERROR AppendCategories countBytesStrings is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesStrings = static_cast<size_t>(countBytesStrings);
+
+   const size_t cBytesSection = GetFeatureBytes(true, cCategories, cBytesStrings);
+   if(size_t{0} == cBytesSection || IsConvertError<IntEbm>(cBytesSection)) {
+      LOG_0(Trace_Error, "ERROR AppendCategories GetFeatureBytes overflow");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == pFillMem) {
+      return static_cast<IntEbm>(cBytesSection);
+   }
+
+   size_t iOffset;
+   unsigned char* const pSection = StartSection(cBytesSection, cBytesAllocated, pFillMem, &iOffset);
+   if(nullptr == pSection) {
+      return Error_IllegalParamVal;
+   }
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+
+   if(static_cast<size_t>(pHeaderModelShared->m_cFeatures) <= static_cast<size_t>(pHeaderModelShared->m_cFilled)) {
+      LOG_0(Trace_Error, "ERROR AppendCategories all features have already been filled");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   if(size_t{0} != cCategories) {
+      if(nullptr == aBinIndexes) {
+         LOG_0(Trace_Error, "ERROR AppendCategories nullptr == aBinIndexes");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      const IntEbm* pBinIndex = aBinIndexes;
+      const IntEbm* const pBinIndexesEnd = aBinIndexes + cCategories;
+      do {
+         const IntEbm indexBin = *pBinIndex;
+         if(indexBin < IntEbm{0}) {
+            LOG_0(Trace_Error, "ERROR AppendCategories indexBin < 0");
+            pHeaderModelShared->m_id = k_sharedModelErrorId;
+            return Error_IllegalParamVal;
+         }
+         ++pBinIndex;
+      } while(pBinIndexesEnd != pBinIndex);
+   }
+
+   // the strings are stored back to back, each terminated with a null, with exactly one string per category
+   size_t cNulls = 0;
+   if(size_t{0} != cBytesStrings) {
+      if(nullptr == aStrings) {
+         LOG_0(Trace_Error, "ERROR AppendCategories nullptr == aStrings");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      if('\0' != aStrings[cBytesStrings - size_t{1}]) {
+         LOG_0(Trace_Error, "ERROR AppendCategories the last category string is not null terminated");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      for(size_t iByte = 0; iByte < cBytesStrings; ++iByte) {
+         if('\0' == aStrings[iByte]) {
+            ++cNulls;
+         }
+      }
+   }
+   if(cNulls != cCategories) {
+      LOG_0(Trace_Error, "ERROR AppendCategories the number of category strings does not match countCategories");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   memset(pSection, 0, cBytesSection);
+
+   FeatureModelShared* const pFeatureModelShared = reinterpret_cast<FeatureModelShared*>(pSection);
+   pFeatureModelShared->m_id = k_featureModelId | k_nominalModelBit;
+   pFeatureModelShared->m_cItems = static_cast<UIntShared>(cCategories);
+   pFeatureModelShared->m_cBytesStrings = static_cast<UIntShared>(cBytesStrings);
+
+   UIntShared* const aBinsShared = reinterpret_cast<UIntShared*>(pSection + k_cBytesModelAlignment);
+   for(size_t iCategory = 0; iCategory < cCategories; ++iCategory) {
+      aBinsShared[iCategory] = static_cast<UIntShared>(aBinIndexes[iCategory]);
+   }
+   if(size_t{0} != cBytesStrings) {
+      memcpy(aBinsShared + cCategories, aStrings, cBytesStrings);
+   }
+
+   return FinishSection(iOffset + cBytesSection, cBytesAllocated, pFillMem);
+}
+
+static IntEbm AppendTerm(const IntEbm countScores,
+      const IntEbm countDimensions,
+      const IntEbm* const aFeatureIndexes,
+      const IntEbm* const aDimensionLengths,
+      const double* const aScores,
+      const bool bWeights,
+      const double* const aWeights,
+      const size_t cBytesAllocated,
+      unsigned char* const pFillMem) {
+   EBM_ASSERT(size_t{0} == cBytesAllocated && nullptr == pFillMem || nullptr != pFillMem);
+
+   LOG_N(Trace_Info,
+         "Entered AppendTerm: "
+         "countScores=%" IntEbmPrintf ", "
+         "countDimensions=%" IntEbmPrintf ", "
+         "aFeatureIndexes=%p, "
+         "aDimensionLengths=%p, "
+         "aScores=%p, "
+         "bWeights=%s, "
+         "aWeights=%p, "
+         "cBytesAllocated=%zu, "
+         "pFillMem=%p",
+         countScores,
+         countDimensions,
+         static_cast<const void*>(aFeatureIndexes),
+         static_cast<const void*>(aDimensionLengths),
+         static_cast<const void*>(aScores),
+         ObtainTruth(bWeights ? EBM_TRUE : EBM_FALSE),
+         static_cast<const void*>(aWeights),
+         cBytesAllocated,
+         static_cast<void*>(pFillMem));
+
+   if(countScores <= IntEbm{0} || IsConvertError<size_t>(countScores)) {
+      LOG_0(Trace_Error, "ERROR AppendTerm countScores must be positive");
+      return Error_IllegalParamVal;
+   }
+   const size_t cScores = static_cast<size_t>(countScores);
+
+   if(IsConvertError<size_t>(countDimensions) || IsConvertError<UIntShared>(countDimensions)) {
+      LOG_0(Trace_Error, "ERROR AppendTerm countDimensions is outside the range of a valid index");
+      return Error_IllegalParamVal;
+   }
+   const size_t cDimensions = static_cast<size_t>(countDimensions);
+
+   if(size_t{0} != cDimensions && nullptr == aDimensionLengths) {
+      LOG_0(Trace_Error, "ERROR AppendTerm nullptr == aDimensionLengths");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cTensorBins = GetTensorBins(cDimensions, aDimensionLengths);
+   if(size_t{0} == cTensorBins || IsConvertError<UIntShared>(cTensorBins)) {
+      LOG_0(Trace_Error, "ERROR AppendTerm dimension lengths must be positive and their product must fit in memory");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cBytesSection = GetTermBytes(cScores, cDimensions, cTensorBins, bWeights);
+   if(size_t{0} == cBytesSection || IsConvertError<IntEbm>(cBytesSection)) {
+      LOG_0(Trace_Error, "ERROR AppendTerm GetTermBytes overflow");
+      return Error_IllegalParamVal;
+   }
+
+   if(nullptr == pFillMem) {
+      return static_cast<IntEbm>(cBytesSection);
+   }
+
+   size_t iOffset;
+   unsigned char* const pSection = StartSection(cBytesSection, cBytesAllocated, pFillMem, &iOffset);
+   if(nullptr == pSection) {
+      return Error_IllegalParamVal;
+   }
+   HeaderModelShared* const pHeaderModelShared = reinterpret_cast<HeaderModelShared*>(pFillMem);
+
+   const size_t cFeatures = static_cast<size_t>(pHeaderModelShared->m_cFeatures);
+   if(static_cast<size_t>(pHeaderModelShared->m_cFilled) < cFeatures) {
+      LOG_0(Trace_Error, "ERROR AppendTerm all features must be filled before the terms");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   if(static_cast<size_t>(pHeaderModelShared->m_cScores) != cScores) {
+      LOG_0(Trace_Error, "ERROR AppendTerm countScores does not match the model header");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   if(size_t{0} != cDimensions) {
+      if(nullptr == aFeatureIndexes) {
+         LOG_0(Trace_Error, "ERROR AppendTerm nullptr == aFeatureIndexes");
+         pHeaderModelShared->m_id = k_sharedModelErrorId;
+         return Error_IllegalParamVal;
+      }
+      const IntEbm* pFeatureIndex = aFeatureIndexes;
+      const IntEbm* const pFeatureIndexesEnd = aFeatureIndexes + cDimensions;
+      do {
+         const IntEbm indexFeature = *pFeatureIndex;
+         if(indexFeature < IntEbm{0} || IsConvertError<size_t>(indexFeature) ||
+               cFeatures <= static_cast<size_t>(indexFeature)) {
+            LOG_0(Trace_Error, "ERROR AppendTerm indexFeature is not a valid feature index");
+            pHeaderModelShared->m_id = k_sharedModelErrorId;
+            return Error_IllegalParamVal;
+         }
+         ++pFeatureIndex;
+      } while(pFeatureIndexesEnd != pFeatureIndex);
+   }
+
+   if(nullptr == aScores) {
+      LOG_0(Trace_Error, "ERROR AppendTerm nullptr == aScores");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   if(bWeights && nullptr == aWeights) {
+      LOG_0(Trace_Error, "ERROR AppendTerm nullptr == aWeights");
+      pHeaderModelShared->m_id = k_sharedModelErrorId;
+      return Error_IllegalParamVal;
+   }
+
+   memset(pSection, 0, cBytesSection);
+
+   TermModelShared* const pTermModelShared = reinterpret_cast<TermModelShared*>(pSection);
+   pTermModelShared->m_id = k_termModelId | (bWeights ? k_weightsModelBit : UIntShared{0});
+   pTermModelShared->m_cDimensions = static_cast<UIntShared>(cDimensions);
+   pTermModelShared->m_cTensorBins = static_cast<UIntShared>(cTensorBins);
+
+   UIntShared* const aFeatureIndexesShared = reinterpret_cast<UIntShared*>(pTermModelShared + 1);
+   UIntShared* const aDimensionLengthsShared = aFeatureIndexesShared + cDimensions;
+   for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+      aFeatureIndexesShared[iDimension] = static_cast<UIntShared>(aFeatureIndexes[iDimension]);
+      aDimensionLengthsShared[iDimension] = static_cast<UIntShared>(aDimensionLengths[iDimension]);
+   }
+
+   unsigned char* const pScores = pSection + GetTermHeaderBytes(cDimensions);
+   const size_t cBytesScores = sizeof(*aScores) * cScores * cTensorBins;
+   memcpy(pScores, aScores, cBytesScores);
+
+   if(bWeights) {
+      memcpy(pScores + AlignModel(cBytesScores), aWeights, sizeof(*aWeights) * cTensorBins);
+   }
+
+   return FinishSection(iOffset + cBytesSection, cBytesAllocated, pFillMem);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureModelHeader(IntEbm countFeatures, IntEbm countTerms) {
+   return AppendModelHeader(countFeatures, countTerms, 0, 0, nullptr);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureModelCuts(IntEbm countCuts) {
+   return AppendCuts(countCuts, nullptr, 0, nullptr);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureModelCategories(IntEbm countCategories, IntEbm countBytesStrings) {
+   return AppendCategories(countCategories, nullptr, countBytesStrings, nullptr, 0, nullptr);
+}
+
+EBM_API_BODY IntEbm EBM_CALLING_CONVENTION MeasureModelTerm(
+      IntEbm countScores, IntEbm countDimensions, const IntEbm* dimensionLengths, BoolEbm hasWeights) {
+   return AppendTerm(countScores,
+         countDimensions,
+         nullptr,
+         dimensionLengths,
+         nullptr,
+         EBM_FALSE != hasWeights,
+         nullptr,
+         0,
+         nullptr);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillModelHeader(
+      IntEbm countFeatures, IntEbm countTerms, IntEbm countScores, IntEbm countBytesAllocated, void* fillMem) {
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillModelHeader nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillModelHeader countBytesAllocated is outside the range of a valid size");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   const IntEbm ret = AppendModelHeader(
+         countFeatures, countTerms, countScores, cBytesAllocated, static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillModelCuts(
+      IntEbm countCuts, const double* cuts, IntEbm countBytesAllocated, void* fillMem) {
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillModelCuts nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillModelCuts countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   const IntEbm ret = AppendCuts(countCuts, cuts, cBytesAllocated, static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillModelCategories(IntEbm countCategories,
+      const IntEbm* binIndexes,
+      IntEbm countBytesStrings,
+      const char* strings,
+      IntEbm countBytesAllocated,
+      void* fillMem) {
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillModelCategories nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillModelCategories countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   const IntEbm ret = AppendCategories(countCategories,
+         binIndexes,
+         countBytesStrings,
+         strings,
+         cBytesAllocated,
+         static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION FillModelTerm(IntEbm countScores,
+      IntEbm countDimensions,
+      const IntEbm* featureIndexes,
+      const IntEbm* dimensionLengths,
+      const double* scores,
+      const double* binWeights,
+      IntEbm countBytesAllocated,
+      void* fillMem) {
+   if(nullptr == fillMem) {
+      LOG_0(Trace_Error, "ERROR FillModelTerm nullptr == fillMem");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR FillModelTerm countBytesAllocated is outside the range of a valid size");
+      // don't set the header to bad if we don't have enough memory for the header itself
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   const IntEbm ret = AppendTerm(countScores,
+         countDimensions,
+         featureIndexes,
+         dimensionLengths,
+         scores,
+         nullptr != binWeights,
+         binWeights,
+         cBytesAllocated,
+         static_cast<unsigned char*>(fillMem));
+   return static_cast<ErrorEbm>(ret);
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION CheckModel(IntEbm countBytesAllocated, const void* model) {
+   if(nullptr == model) {
+      LOG_0(Trace_Error, "ERROR CheckModel nullptr == model");
+      return Error_IllegalParamVal;
+   }
+
+   if(IsConvertError<size_t>(countBytesAllocated)) {
+      LOG_0(Trace_Error, "ERROR CheckModel IsConvertError<size_t>(countBytesAllocated)");
+      return Error_IllegalParamVal;
+   }
+   const size_t cBytesAllocated = static_cast<size_t>(countBytesAllocated);
+
+   if(cBytesAllocated < k_cBytesModelHeaderNoOffset) {
+      LOG_0(Trace_Error, "ERROR CheckModel cBytesAllocated < k_cBytesModelHeaderNoOffset");
+      return Error_IllegalParamVal;
+   }
+
+   const unsigned char* const pModel = static_cast<const unsigned char*>(model);
+   const HeaderModelShared* const pHeaderModelShared = reinterpret_cast<const HeaderModelShared*>(pModel);
+
+   if(k_sharedModelDoneId != pHeaderModelShared->m_id) {
+      LOG_0(Trace_Error, "ERROR CheckModel k_sharedModelDoneId != m_id");
+      return Error_IllegalParamVal;
+   }
+
+   if(k_sharedModelVersion != pHeaderModelShared->m_version) {
+      LOG_0(Trace_Error, "ERROR CheckModel unsupported shared model version");
+      return Error_IllegalParamVal;
+   }
+
+   const UIntShared countBytes = pHeaderModelShared->m_cBytes;
+   if(IsConvertError<size_t>(countBytes) || static_cast<size_t>(countBytes) != cBytesAllocated) {
+      LOG_0(Trace_Error, "ERROR CheckModel the model size does not match the header, which could indicate truncation");
+      return Error_IllegalParamVal;
+   }
+
+   const UIntShared countFeatures = pHeaderModelShared->m_cFeatures;
+   const UIntShared countTerms = pHeaderModelShared->m_cTerms;
+   const UIntShared countScores = pHeaderModelShared->m_cScores;
+   if(IsConvertError<size_t>(countFeatures) || IsConvertError<IntEbm>(countFeatures) ||
+         IsConvertError<size_t>(countTerms) || IsConvertError<IntEbm>(countTerms) ||
+         IsConvertError<size_t>(countScores) || IsConvertError<IntEbm>(countScores) || UIntShared{0} == countScores) {
+      LOG_0(Trace_Error, "ERROR CheckModel invalid counts in the model header");
+      return Error_IllegalParamVal;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cTerms = static_cast<size_t>(countTerms);
+   const size_t cScores = static_cast<size_t>(countScores);
+
+   const size_t cBytesHeader = GetHeaderBytes(cFeatures, cTerms);
+   if(size_t{0} == cBytesHeader || cBytesAllocated < cBytesHeader) {
+      LOG_0(Trace_Error, "ERROR CheckModel not enough memory for the model header");
+      return Error_IllegalParamVal;
+   }
+
+   if(static_cast<UIntShared>(cFeatures + cTerms) != pHeaderModelShared->m_cFilled) {
+      LOG_0(Trace_Error, "ERROR CheckModel the model was not completely filled");
+      return Error_IllegalParamVal;
+   }
+
+   // every section must begin exactly where the previous one ended, so the layout is fully determined by the
+   // section headers.  This also guarantees that all arrays are within bounds and aligned.
+   size_t iExpected = cBytesHeader;
+   const UIntShared* pOffset = ArrayToPointer(pHeaderModelShared->m_offsets);
+   for(size_t iSection = 0; iSection < cFeatures + cTerms; ++iSection) {
+      const UIntShared indexOffset = *pOffset;
+      ++pOffset;
+      if(IsConvertError<size_t>(indexOffset) || static_cast<size_t>(indexOffset) != iExpected) {
+         LOG_0(Trace_Error, "ERROR CheckModel section offset is not where expected");
+         return Error_IllegalParamVal;
+      }
+      EBM_ASSERT(0 == iExpected % k_cBytesModelAlignment);
+
+      size_t cBytesSection;
+      if(iSection < cFeatures) {
+         if(cBytesAllocated - iExpected < sizeof(FeatureModelShared)) {
+            LOG_0(Trace_Error, "ERROR CheckModel not enough memory for the feature header");
+            return Error_IllegalParamVal;
+         }
+         const FeatureModelShared* const pFeatureModelShared =
+               reinterpret_cast<const FeatureModelShared*>(pModel + iExpected);
+         const UIntShared id = pFeatureModelShared->m_id;
+         if(!IsFeatureModel(id)) {
+            LOG_0(Trace_Error, "ERROR CheckModel !IsFeatureModel(id)");
+            return Error_IllegalParamVal;
+         }
+         const bool bNominal = IsNominalFeatureModel(id);
+         const UIntShared countItems = pFeatureModelShared->m_cItems;
+         const UIntShared countBytesStrings = pFeatureModelShared->m_cBytesStrings;
+         if(IsConvertError<size_t>(countItems) || IsConvertError<IntEbm>(countItems) ||
+               IsConvertError<size_t>(countBytesStrings) || IsConvertError<IntEbm>(countBytesStrings) ||
+               !bNominal && UIntShared{0} != countBytesStrings) {
+            LOG_0(Trace_Error, "ERROR CheckModel invalid feature counts");
+            return Error_IllegalParamVal;
+         }
+         cBytesSection =
+               GetFeatureBytes(bNominal, static_cast<size_t>(countItems), static_cast<size_t>(countBytesStrings));
+      } else {
+         if(cBytesAllocated - iExpected < sizeof(TermModelShared)) {
+            LOG_0(Trace_Error, "ERROR CheckModel not enough memory for the term header");
+            return Error_IllegalParamVal;
+         }
+         const TermModelShared* const pTermModelShared = reinterpret_cast<const TermModelShared*>(pModel + iExpected);
+         const UIntShared id = pTermModelShared->m_id;
+         if(!IsTermModel(id)) {
+            LOG_0(Trace_Error, "ERROR CheckModel !IsTermModel(id)");
+            return Error_IllegalParamVal;
+         }
+         const UIntShared countDimensions = pTermModelShared->m_cDimensions;
+         const UIntShared countTensorBins = pTermModelShared->m_cTensorBins;
+         if(IsConvertError<size_t>(countDimensions) || IsConvertError<IntEbm>(countDimensions) ||
+               IsConvertError<size_t>(countTensorBins) || IsConvertError<IntEbm>(countTensorBins)) {
+            LOG_0(Trace_Error, "ERROR CheckModel invalid term counts");
+            return Error_IllegalParamVal;
+         }
+         const size_t cDimensions = static_cast<size_t>(countDimensions);
+         const size_t cBytesTermHeader = GetTermHeaderBytes(cDimensions);
+         if(size_t{0} == cBytesTermHeader || cBytesAllocated - iExpected < cBytesTermHeader) {
+            LOG_0(Trace_Error, "ERROR CheckModel not enough memory for the term dimensions");
+            return Error_IllegalParamVal;
+         }
+         const UIntShared* const aFeatureIndexes = reinterpret_cast<const UIntShared*>(pTermModelShared + 1);
+         for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+            const UIntShared indexFeature = aFeatureIndexes[iDimension];
+            if(IsConvertError<size_t>(indexFeature) || cFeatures <= static_cast<size_t>(indexFeature)) {
+               LOG_0(Trace_Error, "ERROR CheckModel invalid term feature index");
+               return Error_IllegalParamVal;
+            }
+         }
+         const size_t cTensorBins = GetTensorBins(cDimensions, aFeatureIndexes + cDimensions);
+         if(size_t{0} == cTensorBins || static_cast<size_t>(countTensorBins) != cTensorBins) {
+            LOG_0(Trace_Error, "ERROR CheckModel the term dimension lengths do not match m_cTensorBins");
+            return Error_IllegalParamVal;
+         }
+         cBytesSection = GetTermBytes(cScores, cDimensions, cTensorBins, IsWeightsTermModel(id));
+      }
+      if(size_t{0} == cBytesSection || cBytesAllocated - iExpected < cBytesSection) {
+         LOG_0(Trace_Error, "ERROR CheckModel not enough memory for the section");
+         return Error_IllegalParamVal;
+      }
+      iExpected += cBytesSection;
+   }
+
+   if(iExpected != cBytesAllocated) {
+      LOG_0(Trace_Error, "ERROR CheckModel iExpected != cBytesAllocated");
+      return Error_IllegalParamVal;
+   }
+
+   return Error_None;
+}
+
+static const HeaderModelShared* GetModelHeader(const void* const model, const char* const sFunction) {
+   if(nullptr == model) {
+      LOG_N(Trace_Error, "ERROR %s nullptr == model", sFunction);
+      return nullptr;
+   }
+   const HeaderModelShared* const pHeaderModelShared = static_cast<const HeaderModelShared*>(model);
+   if(k_sharedModelDoneId != pHeaderModelShared->m_id) {
+      LOG_N(Trace_Error, "ERROR %s k_sharedModelDoneId != pHeaderModelShared->m_id", sFunction);
+      return nullptr;
+   }
+   return pHeaderModelShared;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractModelHeader(
+      const void* model, IntEbm* countFeaturesOut, IntEbm* countTermsOut, IntEbm* countScoresOut) {
+   const HeaderModelShared* const pHeaderModelShared = GetModelHeader(model, "ExtractModelHeader");
+   if(nullptr == pHeaderModelShared) {
+      return Error_IllegalParamVal;
+   }
+
+   // CheckModel guarantees all of these fit into IntEbm
+   if(nullptr != countFeaturesOut) {
+      *countFeaturesOut = static_cast<IntEbm>(pHeaderModelShared->m_cFeatures);
+   }
+   if(nullptr != countTermsOut) {
+      *countTermsOut = static_cast<IntEbm>(pHeaderModelShared->m_cTerms);
+   }
+   if(nullptr != countScoresOut) {
+      *countScoresOut = static_cast<IntEbm>(pHeaderModelShared->m_cScores);
+   }
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractModelFeature(const void* model,
+      IntEbm indexFeature,
+      BoolEbm* isNominalOut,
+      IntEbm* countItemsOut,
+      IntEbm* offsetItemsOut,
+      IntEbm* countBytesStringsOut,
+      IntEbm* offsetStringsOut) {
+   const HeaderModelShared* const pHeaderModelShared = GetModelHeader(model, "ExtractModelFeature");
+   if(nullptr == pHeaderModelShared) {
+      return Error_IllegalParamVal;
+   }
+
+   if(indexFeature < IntEbm{0} || IsConvertError<size_t>(indexFeature) ||
+         static_cast<size_t>(pHeaderModelShared->m_cFeatures) <= static_cast<size_t>(indexFeature)) {
+      LOG_0(Trace_Error, "ERROR ExtractModelFeature indexFeature is not a valid feature index");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t iOffset =
+         static_cast<size_t>(ArrayToPointer(pHeaderModelShared->m_offsets)[static_cast<size_t>(indexFeature)]);
+   const FeatureModelShared* const pFeatureModelShared =
+         reinterpret_cast<const FeatureModelShared*>(static_cast<const unsigned char*>(model) + iOffset);
+   EBM_ASSERT(IsFeatureModel(pFeatureModelShared->m_id));
+
+   const bool bNominal = IsNominalFeatureModel(pFeatureModelShared->m_id);
+   const size_t cItems = static_cast<size_t>(pFeatureModelShared->m_cItems);
+   const size_t iItems = iOffset + k_cBytesModelAlignment;
+
+   if(nullptr != isNominalOut) {
+      *isNominalOut = bNominal ? EBM_TRUE : EBM_FALSE;
+   }
+   if(nullptr != countItemsOut) {
+      *countItemsOut = static_cast<IntEbm>(cItems);
+   }
+   if(nullptr != offsetItemsOut) {
+      *offsetItemsOut = static_cast<IntEbm>(iItems);
+   }
+   if(nullptr != countBytesStringsOut) {
+      *countBytesStringsOut = static_cast<IntEbm>(pFeatureModelShared->m_cBytesStrings);
+   }
+   if(nullptr != offsetStringsOut) {
+      *offsetStringsOut = bNominal ? static_cast<IntEbm>(iItems + sizeof(UIntShared) * cItems) : IntEbm{0};
+   }
+   return Error_None;
+}
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION ExtractModelTerm(const void* model,
+      IntEbm indexTerm,
+      IntEbm* countDimensionsOut,
+      IntEbm* countTensorBinsOut,
+      IntEbm* offsetFeatureIndexesOut,
+      IntEbm* offsetDimensionLengthsOut,
+      IntEbm* offsetScoresOut,
+      IntEbm* offsetBinWeightsOut) {
+   const HeaderModelShared* const pHeaderModelShared = GetModelHeader(model, "ExtractModelTerm");
+   if(nullptr == pHeaderModelShared) {
+      return Error_IllegalParamVal;
+   }
+
+   const size_t cFeatures = static_cast<size_t>(pHeaderModelShared->m_cFeatures);
+   if(indexTerm < IntEbm{0} || IsConvertError<size_t>(indexTerm) ||
+         static_cast<size_t>(pHeaderModelShared->m_cTerms) <= static_cast<size_t>(indexTerm)) {
+      LOG_0(Trace_Error, "ERROR ExtractModelTerm indexTerm is not a valid term index");
+      return Error_IllegalParamVal;
+   }
+
+   const size_t iOffset =
+         static_cast<size_t>(ArrayToPointer(pHeaderModelShared->m_offsets)[cFeatures + static_cast<size_t>(indexTerm)]);
+   const TermModelShared* const pTermModelShared =
+         reinterpret_cast<const TermModelShared*>(static_cast<const unsigned char*>(model) + iOffset);
+   EBM_ASSERT(IsTermModel(pTermModelShared->m_id));
+
+   const size_t cScores = static_cast<size_t>(pHeaderModelShared->m_cScores);
+   const size_t cDimensions = static_cast<size_t>(pTermModelShared->m_cDimensions);
+   const size_t cTensorBins = static_cast<size_t>(pTermModelShared->m_cTensorBins);
+   const size_t iFeatureIndexes = iOffset + sizeof(TermModelShared);
+   const size_t iScores = iOffset + GetTermHeaderBytes(cDimensions);
+
+   if(nullptr != countDimensionsOut) {
+      *countDimensionsOut = static_cast<IntEbm>(cDimensions);
+   }
+   if(nullptr != countTensorBinsOut) {
+      *countTensorBinsOut = static_cast<IntEbm>(cTensorBins);
+   }
+   if(nullptr != offsetFeatureIndexesOut) {
+      *offsetFeatureIndexesOut = static_cast<IntEbm>(iFeatureIndexes);
+   }
+   if(nullptr != offsetDimensionLengthsOut) {
+      *offsetDimensionLengthsOut = static_cast<IntEbm>(iFeatureIndexes + sizeof(UIntShared) * cDimensions);
+   }
+   if(nullptr != offsetScoresOut) {
+      *offsetScoresOut = static_cast<IntEbm>(iScores);
+   }
+   if(nullptr != offsetBinWeightsOut) {
+      *offsetBinWeightsOut = IsWeightsTermModel(pTermModelShared->m_id) ?
+            static_cast<IntEbm>(iScores + AlignModel(sizeof(double) * cScores * cTensorBins)) :
+            IntEbm{0};
+   }
+   return Error_None;
+}
+
+} // namespace DEFINED_ZONE_NAME
@@ -14,7 +14,9 @@
 
 #include "RandomDeterministic.hpp"
 #include "RandomNondeterministic.hpp"
+#include "RandomCounter.hpp"
 #include "GaussianDistribution.hpp"
+#include "ThreadPool.hpp"
 
 namespace DEFINED_ZONE_NAME {
 #ifndef DEFINED_ZONE_NAME
@@ -164,6 +166,200 @@ EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateGaussianRandom(
    return Error_None;
 }
 
+// each task fills this many items.  The results do not depend on it since every item has its own counter stream
+static constexpr size_t k_cGaussianItemsPerTask = 4096;
+
+struct GaussianTaskContext {
+   RandomCounter m_rng;
+   double m_stddev;
+   size_t m_cItems;
+   double* m_aOut;
+};
+static_assert(std::is_standard_layout<GaussianTaskContext>::value,
+      "We use the struct hack in several places, so disallow non-standard_layout types in general");
+static_assert(std::is_trivial<GaussianTaskContext>::value,
+      "We use memcpy in several places, so disallow non-trivial types in general");
+
+static ErrorEbm GaussianTask(void* const pContext, const size_t iTask) {
+   const GaussianTaskContext* const pTaskContext = reinterpret_cast<const GaussianTaskContext*>(pContext);
+
+   const size_t iItemStart = iTask * k_cGaussianItemsPerTask;
+   EBM_ASSERT(iItemStart < pTaskContext->m_cItems);
+   const size_t iItemEnd = std::min(pTaskContext->m_cItems, iItemStart + k_cGaussianItemsPerTask);
+
+   RandomCounter rng;
+   rng.Initialize(pTaskContext->m_rng);
+   GaussianDistribution gaussian(pTaskContext->m_stddev);
+   double* const aOut = pTaskContext->m_aOut;
+   size_t iItem = iItemStart;
+   do {
+      // the gaussian sampler uses rejection, so item i cannot know where item i - 1 stopped.  Giving each item its
+      // own stream lets any thread start anywhere
+      rng.Seek(static_cast<uint64_t>(iItem), 0);
+      aOut[iItem] = gaussian.Sample(rng, 1.0);
+      ++iItem;
+   } while(iItemEnd != iItem);
+   return Error_None;
+}
+
+// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
+static int g_cLogEnterGenerateGaussianRandomParallel = 25;
+static int g_cLogExitGenerateGaussianRandomParallel = 25;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateGaussianRandomParallel(
+      void* rng, double stddev, IntEbm count, double* randomOut) {
+   LOG_COUNTED_N(&g_cLogEnterGenerateGaussianRandomParallel,
+         Trace_Info,
+         Trace_Verbose,
+         "Entered GenerateGaussianRandomParallel: "
+         "rng=%p, "
+         "stddev=%le, "
+         "count=%" IntEbmPrintf ", "
+         "randomOut=%p",
+         rng,
+         stddev,
+         count,
+         static_cast<const void*>(randomOut));
+
+   if(UNLIKELY(count <= IntEbm{0})) {
+      if(UNLIKELY(count < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel count < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      } else {
+         LOG_COUNTED_0(&g_cLogExitGenerateGaussianRandomParallel,
+               Trace_Info,
+               Trace_Verbose,
+               "GenerateGaussianRandomParallel zero items requested");
+         return Error_None;
+      }
+   }
+   if(UNLIKELY(IsConvertError<size_t>(count))) {
+      LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel IsConvertError<size_t>(count)");
+      return Error_IllegalParamVal;
+   }
+   const size_t c = static_cast<size_t>(count);
+   if(UNLIKELY(IsMultiplyError(sizeof(*randomOut), c))) {
+      LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel IsMultiplyError(sizeof(*randomOut), c)");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(nullptr == randomOut)) {
+      LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel nullptr == randomOut");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(std::isnan(stddev))) {
+      LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel stddev cannot be NaN");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(std::isinf(stddev))) {
+      LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel stddev cannot be +-infinity");
+      return Error_IllegalParamVal;
+   }
+   if(UNLIKELY(stddev < 0)) {
+      LOG_0(Trace_Error, "ERROR GenerateGaussianRandomParallel stddev <= 0");
+      return Error_IllegalParamVal;
+   }
+
+   GaussianTaskContext taskContext;
+   if(nullptr != rng) {
+      // like BranchRNG, this advances rng by exactly one draw regardless of count, so the caller's later draws
+      // do not depend on how many items were generated here
+      taskContext.m_rng.Initialize(*reinterpret_cast<RandomDeterministic*>(rng));
+   } else {
+      try {
+         RandomNondeterministic<uint64_t> randomGenerator;
+         taskContext.m_rng.Initialize(randomGenerator.Next(std::numeric_limits<uint64_t>::max()));
+      } catch(const std::bad_alloc&) {
+         LOG_0(Trace_Warning, "WARNING GenerateGaussianRandomParallel Out of memory allocating randomGenerator");
+         return Error_OutOfMemory;
+      } catch(...) {
+         LOG_0(Trace_Warning, "WARNING GenerateGaussianRandomParallel Unknown error");
+         return Error_UnexpectedInternal;
+      }
+   }
+   taskContext.m_stddev = stddev;
+   taskContext.m_cItems = c;
+   taskContext.m_aOut = randomOut;
+
+   const size_t cTasks = (c - size_t{1}) / k_cGaussianItemsPerTask + size_t{1};
+   const ErrorEbm error = ParallelFor(cTasks, GaussianTask, &taskContext);
+   if(Error_None != error) {
+      return error;
+   }
+
+   LOG_COUNTED_0(&g_cLogExitGenerateGaussianRandomParallel,
+         Trace_Info,
+         Trace_Verbose,
+         "Exited GenerateGaussianRandomParallel");
+
+   return Error_None;
+}
+
+// we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
+static int g_cLogEnterGenerateCounterRandom = 25;
+static int g_cLogExitGenerateCounterRandom = 25;
+
+EBM_API_BODY ErrorEbm EBM_CALLING_CONVENTION GenerateCounterRandom(
+      UIntEbm key, UIntEbm stream, UIntEbm position, IntEbm count, UIntEbm* randomOut) {
+   LOG_COUNTED_N(&g_cLogEnterGenerateCounterRandom,
+         Trace_Info,
+         Trace_Verbose,
+         "Entered GenerateCounterRandom: "
+         "key=%" UIntEbmPrintf ", "
+         "stream=%" UIntEbmPrintf ", "
+         "position=%" UIntEbmPrintf ", "
+         "count=%" IntEbmPrintf ", "
+         "randomOut=%p",
+         key,
+         stream,
+         position,
+         count,
+         static_cast<const void*>(randomOut));
+
+   if(UNLIKELY(count <= IntEbm{0})) {
+      if(UNLIKELY(count < IntEbm{0})) {
+         LOG_0(Trace_Error, "ERROR GenerateCounterRandom count < IntEbm { 0 }");
+         return Error_IllegalParamVal;
+      } else {
+         LOG_COUNTED_0(&g_cLogExitGenerateCounterRandom,
+               Trace_Info,
+               Trace_Verbose,
+               "GenerateCounterRandom zero items requested");
+         return Error_None;
+      }
+   }
+   if(UNLIKELY(IsConvertError<size_t>(count))) {
+      LOG_0(Trace_Error, "ERROR GenerateCounterRandom IsConvertError<size_t>(count)");
+      return Error_IllegalParamVal;
+   }
+   const size_t c = static_cast<size_t>(count);
+   if(UNLIKELY(IsMultiplyError(sizeof(*randomOut), c))) {
+      LOG_0(Trace_Error, "ERROR GenerateCounterRandom IsMultiplyError(sizeof(*randomOut), c)");
+      return Error_IllegalParamVal;
+   }
+
+   if(UNLIKELY(nullptr == randomOut)) {
+      LOG_0(Trace_Error, "ERROR GenerateCounterRandom nullptr == randomOut");
+      return Error_IllegalParamVal;
+   }
+
+   RandomCounter rng;
+   rng.Initialize(static_cast<uint64_t>(key));
+   rng.Seek(static_cast<uint64_t>(stream), static_cast<uint64_t>(position));
+
+   UIntEbm* pRandomOut = randomOut;
+   const UIntEbm* const pRandomOutEnd = randomOut + c;
+   do {
+      *pRandomOut = static_cast<UIntEbm>(rng.Next<uint32_t>());
+      ++pRandomOut;
+   } while(pRandomOutEnd != pRandomOut);
+
+   LOG_COUNTED_0(&g_cLogExitGenerateCounterRandom, Trace_Info, Trace_Verbose, "Exited GenerateCounterRandom");
+
+   return Error_None;
+}
+
 // we don't care if an extra log message is outputted due to the non-atomic nature of the decrement to this value
 static int g_cLogEnterShuffle = 25;
 static int g_cLogExitShuffle = 25;
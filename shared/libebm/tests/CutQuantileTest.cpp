@@ -1082,3 +1082,208 @@ TEST_CASE("CutQuantile, chunky randomized check") {
       }
    }
 }
+
+static std::vector<unsigned char> MakeQuantileSketch(
+      TestCaseHidden& testCaseHidden, const IntEbm countItemsPerLevel) {
+   const IntEbm countBytes = MeasureQuantileSketch(countItemsPerLevel);
+   CHECK(0 < countBytes);
+   std::vector<unsigned char> sketch(static_cast<size_t>(countBytes));
+   const ErrorEbm error = InitQuantileSketch(countItemsPerLevel, countBytes, &sketch[0]);
+   CHECK(Error_None == error);
+   return sketch;
+}
+
+TEST_CASE("CutQuantileSketch, uncompacted sketch matches CutQuantile") {
+   ErrorEbm error;
+
+   RandomStreamTest randomStream(k_seed);
+   if(!randomStream.IsSuccess()) {
+      throw TestException("RandomStreamTest");
+   }
+
+   static constexpr IntEbm k_countItemsPerLevel = 256;
+   static constexpr size_t cSamples = 200;
+   static constexpr size_t cCutsMax = 20;
+
+   for(size_t iIteration = 0; iIteration < 100; ++iIteration) {
+      std::vector<double> featureVals(cSamples);
+      for(size_t i = 0; i < cSamples; ++i) {
+         featureVals[i] = 0 == randomStream.Next(20) ? std::numeric_limits<double>::quiet_NaN() :
+                                                       static_cast<double>(randomStream.Next(50));
+      }
+      const IntEbm minSamplesBin = static_cast<IntEbm>(randomStream.Next(3) + 1);
+
+      double cutsExpected[cCutsMax];
+      IntEbm countCutsExpected = cCutsMax;
+      error = CutQuantile(cSamples, &featureVals[0], minSamplesBin, EBM_TRUE, &countCutsExpected, cutsExpected);
+      CHECK(Error_None == error);
+
+      // build the sketch in two chunks that get merged
+      std::vector<unsigned char> sketch1 = MakeQuantileSketch(testCaseHidden, k_countItemsPerLevel);
+      std::vector<unsigned char> sketch2 = MakeQuantileSketch(testCaseHidden, k_countItemsPerLevel);
+      error = AddQuantileSketch(cSamples / 3, &featureVals[0], &sketch1[0]);
+      CHECK(Error_None == error);
+      error = AddQuantileSketch(cSamples - cSamples / 3, &featureVals[cSamples / 3], &sketch2[0]);
+      CHECK(Error_None == error);
+      error = MergeQuantileSketch(&sketch2[0], &sketch1[0]);
+      CHECK(Error_None == error);
+
+      double cuts[cCutsMax];
+      IntEbm countCuts = cCutsMax;
+      error = CutQuantileSketch(&sketch1[0], minSamplesBin, EBM_TRUE, &countCuts, cuts);
+      CHECK(Error_None == error);
+
+      CHECK(countCutsExpected == countCuts);
+      if(countCutsExpected == countCuts) {
+         for(size_t i = 0; i < static_cast<size_t>(countCuts); ++i) {
+            CHECK(cutsExpected[i] == cuts[i]);
+         }
+      }
+   }
+}
+
+TEST_CASE("CutQuantileSketch, compacted sketch gives approximately equal bins") {
+   ErrorEbm error;
+
+   RandomStreamTest randomStream(k_seed);
+   if(!randomStream.IsSuccess()) {
+      throw TestException("RandomStreamTest");
+   }
+
+   static constexpr IntEbm k_countItemsPerLevel = 512;
+   static constexpr size_t cChunks = 8;
+   static constexpr size_t cSamplesPerChunk = 25000;
+   static constexpr size_t cSamples = cChunks * cSamplesPerChunk;
+   static constexpr size_t cCutsMax = 9;
+
+   std::vector<double> featureVals(cSamples);
+   for(size_t i = 0; i < cSamples; ++i) {
+      // skewed values with a heavy run of zeros that must remain uncut
+      const double val = static_cast<double>(randomStream.Next(1000000)) / 1000.0;
+      featureVals[i] = 0 == randomStream.Next(4) ? 0.0 : val * val;
+   }
+
+   std::vector<unsigned char> sketchTotal = MakeQuantileSketch(testCaseHidden, k_countItemsPerLevel);
+   for(size_t iChunk = 0; iChunk < cChunks; ++iChunk) {
+      std::vector<unsigned char> sketch = MakeQuantileSketch(testCaseHidden, k_countItemsPerLevel);
+      error = AddQuantileSketch(cSamplesPerChunk, &featureVals[iChunk * cSamplesPerChunk], &sketch[0]);
+      CHECK(Error_None == error);
+      error = MergeQuantileSketch(&sketch[0], &sketchTotal[0]);
+      CHECK(Error_None == error);
+   }
+
+   double cuts[cCutsMax];
+   IntEbm countCuts = cCutsMax;
+   error = CutQuantileSketch(&sketchTotal[0], 1, EBM_FALSE, &countCuts, cuts);
+   CHECK(Error_None == error);
+   CHECK(cCutsMax - 1 <= static_cast<size_t>(countCuts));
+
+   std::vector<IntEbm> binIndexes(cSamples);
+   error = Discretize(cSamples, &featureVals[0], countCuts, cuts, &binIndexes[0]);
+   CHECK(Error_None == error);
+
+   std::vector<size_t> binCounts(static_cast<size_t>(countCuts) + 2, 0);
+   for(const IntEbm iBin : binIndexes) {
+      ++binCounts[static_cast<size_t>(iBin)];
+   }
+   CHECK(0 == binCounts[0]); // no missing values
+   // the zeros are a quarter of the data and get their own bin.  The rest should be split evenly
+   CHECK(cSamples / 4 - cSamples / 100 < binCounts[1]);
+   for(size_t iBin = 2; iBin < binCounts.size(); ++iBin) {
+      const double expected = static_cast<double>(cSamples) * 0.75 / static_cast<double>(countCuts);
+      CHECK(std::abs(static_cast<double>(binCounts[iBin]) - expected) < expected * 0.1);
+   }
+}
+
+TEST_CASE("CutQuantileSketch, illegal sketches") {
+   ErrorEbm error;
+
+   CHECK(MeasureQuantileSketch(3) < 0);
+   CHECK(MeasureQuantileSketch(0) < 0);
+
+   std::vector<unsigned char> sketch16 = MakeQuantileSketch(testCaseHidden, 16);
+   std::vector<unsigned char> sketch32 = MakeQuantileSketch(testCaseHidden, 32);
+   error = MergeQuantileSketch(&sketch16[0], &sketch32[0]);
+   CHECK(Error_IllegalParamVal == error);
+   error = MergeQuantileSketch(&sketch16[0], &sketch16[0]);
+   CHECK(Error_IllegalParamVal == error);
+
+   const double vals[]{1.0, std::numeric_limits<double>::quiet_NaN(), 2.0};
+   error = AddQuantileSketch(3, vals, &sketch16[0]);
+   CHECK(Error_None == error);
+
+   std::vector<unsigned char> corrupted(sketch16);
+   corrupted[16] = 77; // m_cSamples no longer matches the levels
+   error = AddQuantileSketch(3, vals, &corrupted[0]);
+   CHECK(Error_IllegalParamVal == error);
+   IntEbm countCuts = 1;
+   double cut;
+   error = CutQuantileSketch(&corrupted[0], 1, EBM_FALSE, &countCuts, &cut);
+   CHECK(Error_IllegalParamVal == error);
+   CHECK(0 == countCuts);
+
+   countCuts = 1;
+   error = CutQuantileSketch(&sketch16[0], 1, EBM_FALSE, &countCuts, &cut);
+   CHECK(Error_None == error);
+   CHECK(1 == countCuts);
+   CHECK(1.0 < cut);
+   CHECK(cut <= 2.0);
+}
+
+TEST_CASE("CutQuantileMany, matches CutQuantile per column") {
+   ErrorEbm error;
+
+   RandomStreamTest randomStream(k_seed);
+   if(!randomStream.IsSuccess()) {
+      throw TestException("RandomStreamTest");
+   }
+
+   static constexpr size_t cFeatures = 37;
+   static constexpr size_t cSamples = 300;
+
+   std::vector<std::vector<double>> cols(cFeatures, std::vector<double>(cSamples));
+   std::vector<const double*> featureCols(cFeatures);
+   std::vector<IntEbm> minSamplesBin(cFeatures);
+   std::vector<BoolEbm> isRounded(cFeatures);
+   std::vector<IntEbm> countCutsMax(cFeatures);
+   IntEbm countCutsTotal = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const size_t cDistinct = randomStream.Next(100) + 1;
+      for(size_t i = 0; i < cSamples; ++i) {
+         cols[iFeature][i] = static_cast<double>(randomStream.Next(cDistinct)) * 0.25;
+      }
+      featureCols[iFeature] = &cols[iFeature][0];
+      minSamplesBin[iFeature] = static_cast<IntEbm>(randomStream.Next(4) + 1);
+      isRounded[iFeature] = 0 == randomStream.Next(2) ? EBM_FALSE : EBM_TRUE;
+      countCutsMax[iFeature] = static_cast<IntEbm>(randomStream.Next(30));
+      countCutsTotal += countCutsMax[iFeature];
+   }
+
+   std::vector<IntEbm> cutOffsets(cFeatures + 1);
+   std::vector<double> cuts(static_cast<size_t>(countCutsTotal));
+   error = CutQuantileMany(cFeatures,
+         cSamples,
+         &featureCols[0],
+         &minSamplesBin[0],
+         &isRounded[0],
+         &countCutsMax[0],
+         &cutOffsets[0],
+         &cuts[0]);
+   CHECK(Error_None == error);
+   CHECK(0 == cutOffsets[0]);
+
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      std::vector<double> expected(static_cast<size_t>(countCutsMax[iFeature]) + 1);
+      IntEbm countCuts = countCutsMax[iFeature];
+      error = CutQuantile(
+            cSamples, featureCols[iFeature], minSamplesBin[iFeature], isRounded[iFeature], &countCuts, &expected[0]);
+      CHECK(Error_None == error);
+
+      CHECK(countCuts == cutOffsets[iFeature + 1] - cutOffsets[iFeature]);
+      if(countCuts == cutOffsets[iFeature + 1] - cutOffsets[iFeature]) {
+         for(size_t i = 0; i < static_cast<size_t>(countCuts); ++i) {
+            CHECK(expected[i] == cuts[static_cast<size_t>(cutOffsets[iFeature]) + i]);
+         }
+      }
+   }
+}
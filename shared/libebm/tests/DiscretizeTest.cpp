@@ -113,3 +113,49 @@ TEST_CASE("Discretize, increasing lengths") {
       }
    }
 }
+
+TEST_CASE("DiscretizeMany, matches Discretize per column") {
+   ErrorEbm error;
+
+   // more samples than one task handles so that columns are split between threads
+   static constexpr size_t cSamples = 150001;
+   static constexpr size_t cFeatures = 3;
+
+   const double cuts[]{-1.0, 0.5, 0.5000001, 100.0, 1000.0};
+   const IntEbm cutOffsets[]{0, 1, 1, 5};
+
+   std::vector<std::vector<double>> cols(cFeatures, std::vector<double>(cSamples));
+   std::vector<const double*> featureCols(cFeatures);
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      for(size_t i = 0; i < cSamples; ++i) {
+         cols[iFeature][i] = 0 == i % 101 ? std::numeric_limits<double>::quiet_NaN() :
+                                            static_cast<double>((i * (iFeature + 3)) % 2003) - 3.0;
+      }
+      featureCols[iFeature] = &cols[iFeature][0];
+   }
+
+   std::vector<IntEbm> binIndexes(cFeatures * cSamples, -1);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &binIndexes[0]);
+   CHECK(Error_None == error);
+
+   std::vector<IntEbm> expected(cSamples);
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      error = Discretize(cSamples,
+            featureCols[iFeature],
+            cutOffsets[iFeature + 1] - cutOffsets[iFeature],
+            &cuts[cutOffsets[iFeature]],
+            &expected[0]);
+      CHECK(Error_None == error);
+      CHECK(std::equal(expected.begin(), expected.end(), binIndexes.begin() + iFeature * cSamples));
+   }
+}
+
+TEST_CASE("DiscretizeMany, decreasing offsets") {
+   const double vals[]{1.0};
+   const double* const featureCols[]{vals, vals};
+   const double cuts[]{0.0};
+   const IntEbm cutOffsets[]{0, 1, 0};
+   IntEbm binIndexes[2];
+   const ErrorEbm error = DiscretizeMany(2, 1, featureCols, cutOffsets, cuts, binIndexes);
+   CHECK(Error_IllegalParamVal == error);
+}
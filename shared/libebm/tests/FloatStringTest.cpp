@@ -0,0 +1,141 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch_test.hpp"
+
+#include <locale.h> // setlocale
+
+#include "libebm.h"
+#include "libebm_test.hpp"
+
+static constexpr TestPriority k_filePriority = TestPriority::FloatString;
+
+static std::string FloatsToStringTest(const std::vector<double>& vals) {
+   std::vector<char> str(std::max(size_t{1}, vals.size() * static_cast<size_t>(GetCountCharactersPerFloat())));
+   const ErrorEbm error =
+         FloatsToString(static_cast<IntEbm>(vals.size()), vals.empty() ? nullptr : &vals[0], &str[0]);
+   if(Error_None != error) {
+      return std::string("ERROR");
+   }
+   return std::string(&str[0]);
+}
+
+TEST_CASE("FloatsToString, zero floats") {
+   UNUSED(testCaseHidden);
+   CHECK(std::string() == FloatsToStringTest(std::vector<double>()));
+}
+
+TEST_CASE("FloatsToString, same text as python repr") {
+   UNUSED(testCaseHidden);
+   CHECK(std::string("0.1 0.3 12.5 -0.125") == FloatsToStringTest({0.1, 0.3, 12.5, -0.125}));
+   CHECK(std::string("0.30000000000000004") == FloatsToStringTest({0.1 + 0.2}));
+   CHECK(std::string("0.0001 1e-05 1.5e-07") == FloatsToStringTest({0.0001, 0.00001, 0.00000015}));
+   CHECK(std::string("9007199254740992.0 1e+16 1.2345e+20") ==
+         FloatsToStringTest({9007199254740992.0, 1e16, 1.2345e20}));
+   CHECK(std::string("5e-324 -1.7976931348623157e+308 2.2250738585072014e-308") ==
+         FloatsToStringTest({std::numeric_limits<double>::denorm_min(),
+               std::numeric_limits<double>::lowest(),
+               std::numeric_limits<double>::min()}));
+   // the shortest string that round trips is not always the nearest, see exploringbinary.com
+   CHECK(std::string("5.684341886080802e-14") == FloatsToStringTest({5.684341886080801486968994140625e-14}));
+   CHECK(std::string("inf -inf nan") ==
+         FloatsToStringTest({std::numeric_limits<double>::infinity(),
+               -std::numeric_limits<double>::infinity(),
+               std::numeric_limits<double>::quiet_NaN()}));
+}
+
+TEST_CASE("FloatsToString, integers have no decimal point") {
+   UNUSED(testCaseHidden);
+   // JSON has no integer type, so floats that hold an integer up to 2^53 - 1 are written like integers
+   CHECK(std::string("0 -0 1 -4 1200 1000000000000000") ==
+         FloatsToStringTest({0.0, -0.0, 1.0, -4.0, 1200.0, 1e15}));
+   CHECK(std::string("9007199254740991 -9007199254740991 9007199254740992.0") ==
+         FloatsToStringTest({9007199254740991.0, -9007199254740991.0, 9007199254740992.0}));
+}
+
+TEST_CASE("StringToFloats, round trip") {
+   UNUSED(testCaseHidden);
+
+   std::vector<double> vals;
+   // walk the entire exponent range with mantissas that have lots of significant digits
+   double val = std::numeric_limits<double>::denorm_min();
+   while(val < std::numeric_limits<double>::max() / 3.0) {
+      vals.push_back(val);
+      vals.push_back(-val * 1.0000000000000002);
+      val = val * 3.0 + std::numeric_limits<double>::denorm_min();
+   }
+   vals.push_back(std::numeric_limits<double>::max());
+   vals.push_back(9007199254740993.0);
+   vals.push_back(1.0 / 3.0);
+
+   const std::string str = FloatsToStringTest(vals);
+   CHECK(std::string("ERROR") != str);
+
+   std::vector<double> back(vals.size(), 77.0);
+   const ErrorEbm error = StringToFloats(str.c_str(), static_cast<IntEbm>(back.size()), &back[0]);
+   CHECK(Error_None == error);
+   for(size_t i = 0; i < vals.size(); ++i) {
+      CHECK(0 == memcmp(&vals[i], &back[i], sizeof(double)));
+   }
+}
+
+TEST_CASE("StringToFloats, general text") {
+   UNUSED(testCaseHidden);
+
+   double vals[10];
+   const ErrorEbm error =
+         StringToFloats("  +1. .5\t-2.50E+2 0.000000000000000000000000000001 123e25 1E400 -1e-400\n"
+                        "0.10000000000000000555111512312578270211815834045410156250001 Infinity -NaN ",
+               10,
+               vals);
+   CHECK(Error_None == error);
+   CHECK(1.0 == vals[0]);
+   CHECK(0.5 == vals[1]);
+   CHECK(-250.0 == vals[2]);
+   CHECK(1e-30 == vals[3]);
+   CHECK(1.23e27 == vals[4]);
+   CHECK(std::numeric_limits<double>::infinity() == vals[5]);
+   CHECK(0.0 == vals[6]);
+   CHECK(std::signbit(vals[6]));
+   CHECK(0.1 == vals[7]);
+   CHECK(std::numeric_limits<double>::infinity() == vals[8]);
+   CHECK(std::isnan(vals[9]));
+}
+
+TEST_CASE("StringToFloats, does not depend on the current C locale") {
+   UNUSED(testCaseHidden);
+
+   // these locales use a comma for the decimal point.  Machines without any of them just check the "C" locale
+   const char* const aLocales[] = {"de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "German_Germany.1252"};
+   const char* const sLocalePrev = setlocale(LC_NUMERIC, nullptr);
+   const std::string localePrev = nullptr == sLocalePrev ? std::string("C") : std::string(sLocalePrev);
+   for(const char* const sLocale : aLocales) {
+      if(nullptr != setlocale(LC_NUMERIC, sLocale)) {
+         break;
+      }
+   }
+
+   // the first number has too many digits for the fast path, so it goes through the strtod fallback
+   double vals[2];
+   const ErrorEbm error =
+         StringToFloats("0.10000000000000000555111512312578270211815834045410156250001 2.5", 2, vals);
+   setlocale(LC_NUMERIC, localePrev.c_str());
+
+   CHECK(Error_None == error);
+   CHECK(0.1 == vals[0]);
+   CHECK(2.5 == vals[1]);
+}
+
+TEST_CASE("StringToFloats, illegal text") {
+   UNUSED(testCaseHidden);
+
+   double vals[2];
+   CHECK(Error_IllegalParamVal == StringToFloats("1.0", 2, vals));
+   CHECK(Error_IllegalParamVal == StringToFloats("1.0 2.0 3.0", 2, vals));
+   CHECK(Error_IllegalParamVal == StringToFloats("1.0,2.0", 2, vals));
+   CHECK(Error_IllegalParamVal == StringToFloats("1.0 0x10", 2, vals));
+   CHECK(Error_IllegalParamVal == StringToFloats("1.0 .", 2, vals));
+   CHECK(Error_IllegalParamVal == StringToFloats("1.0 1e", 2, vals));
+   CHECK(Error_None == StringToFloats("", 0, nullptr));
+}
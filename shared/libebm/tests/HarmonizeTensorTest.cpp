@@ -0,0 +1,125 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch_test.hpp"
+
+#include "libebm.h"
+#include "libebm_test.hpp"
+
+static constexpr TestPriority k_filePriority = TestPriority::HarmonizeTensor;
+
+TEST_CASE("HarmonizeTensors splits bin weights by percentage") {
+   // old bins are: missing, below the cut, above the cut, unknown.  The new grid adds a cut in the middle of the old
+   // upper bin, so each half of it takes half of the weight
+   const IntEbm binCounts[]{5};
+   const IntEbm oldBinCounts[]{4};
+   const IntEbm oldBinOffsets[]{0, 1, 2, 3, 4, 5};
+   const IntEbm oldBinIndexes[]{0, 1, 2, 2, 3};
+   const double percentages[]{1.0, 1.0, 0.5, 0.5, 1.0};
+   const double oldTensor[]{1.0, 4.0, 6.0, 0.0};
+   double tensor[5];
+   const double expected[]{1.0, 4.0, 3.0, 3.0, 0.0};
+
+   const IntEbm* const aOldBinCounts[]{oldBinCounts};
+   const IntEbm* const aOldBinOffsets[]{oldBinOffsets};
+   const IntEbm* const aOldBinIndexes[]{oldBinIndexes};
+   const double* const aPercentages[]{percentages};
+   const double* const aOldTensors[]{oldTensor};
+   double* const aTensors[]{tensor};
+
+   const ErrorEbm error = HarmonizeTensors(IntEbm{1},
+         IntEbm{1},
+         binCounts,
+         IntEbm{1},
+         aOldBinCounts,
+         aOldBinOffsets,
+         aOldBinIndexes,
+         aPercentages,
+         aOldTensors,
+         nullptr,
+         aTensors);
+   CHECK(Error_None == error);
+   for(size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+      CHECK(expected[i] == tensor[i]);
+   }
+}
+
+TEST_CASE("HarmonizeTensors averages multiclass pair scores by bin weight, many tensors") {
+   const IntEbm binCounts[]{2, 3};
+
+   // the middle new bin of the second dimension covers both old bins, so its scores are the weighted average
+   const IntEbm oldBinCounts0[]{2, 2};
+   const IntEbm oldBinOffsets0[]{0, 1, 2, 3, 5, 6};
+   const IntEbm oldBinIndexes0[]{0, 1, 0, 0, 1, 1};
+   const double percentages0[]{1.0, 1.0, 1.0, 1.0, 1.0};
+   const double oldTensor0[]{1.0, 10.0, 3.0, 30.0, 5.0, 50.0, 7.0, 70.0};
+   const double oldWeights0[]{1.0, 3.0, 2.0, 0.0};
+   double tensor0[12];
+   const double expected0[]{1.0, 10.0, 2.5, 25.0, 3.0, 30.0, 5.0, 50.0, 5.0, 50.0, 7.0, 70.0};
+
+   // a term with a single old bin in each dimension spreads its scores over the entire new grid
+   const IntEbm oldBinCounts1[]{1, 1};
+   const IntEbm oldBinOffsets1[]{0, 1, 2, 3, 4, 5};
+   const IntEbm oldBinIndexes1[]{0, 0, 0, 0, 0};
+   const double percentages1[]{1.0, 1.0, 1.0, 1.0, 1.0};
+   const double oldTensor1[]{9.0, -9.0};
+   double tensor1[12];
+
+   const IntEbm* const aOldBinCounts[]{oldBinCounts0, oldBinCounts1};
+   const IntEbm* const aOldBinOffsets[]{oldBinOffsets0, oldBinOffsets1};
+   const IntEbm* const aOldBinIndexes[]{oldBinIndexes0, oldBinIndexes1};
+   const double* const aPercentages[]{percentages0, percentages1};
+   const double* const aOldTensors[]{oldTensor0, oldTensor1};
+   const double* const aOldWeights[]{oldWeights0, nullptr};
+   double* const aTensors[]{tensor0, tensor1};
+
+   const ErrorEbm error = HarmonizeTensors(IntEbm{2},
+         IntEbm{2},
+         binCounts,
+         IntEbm{2},
+         aOldBinCounts,
+         aOldBinOffsets,
+         aOldBinIndexes,
+         aPercentages,
+         aOldTensors,
+         aOldWeights,
+         aTensors);
+   CHECK(Error_None == error);
+   for(size_t i = 0; i < sizeof(expected0) / sizeof(expected0[0]); ++i) {
+      CHECK(expected0[i] == tensor0[i]);
+   }
+   for(size_t i = 0; i < sizeof(tensor1) / sizeof(tensor1[0]); ++i) {
+      CHECK(oldTensor1[i % 2] == tensor1[i]);
+   }
+}
+
+TEST_CASE("HarmonizeTensors rejects an old bin outside of its dimension") {
+   const IntEbm binCounts[]{2};
+   const IntEbm oldBinCounts[]{2};
+   const IntEbm oldBinOffsets[]{0, 1, 2};
+   const IntEbm oldBinIndexes[]{0, 2};
+   const double percentages[]{1.0, 1.0};
+   const double oldTensor[]{1.0, 2.0};
+   double tensor[2];
+
+   const IntEbm* const aOldBinCounts[]{oldBinCounts};
+   const IntEbm* const aOldBinOffsets[]{oldBinOffsets};
+   const IntEbm* const aOldBinIndexes[]{oldBinIndexes};
+   const double* const aPercentages[]{percentages};
+   const double* const aOldTensors[]{oldTensor};
+   double* const aTensors[]{tensor};
+
+   const ErrorEbm error = HarmonizeTensors(IntEbm{1},
+         IntEbm{1},
+         binCounts,
+         IntEbm{1},
+         aOldBinCounts,
+         aOldBinOffsets,
+         aOldBinIndexes,
+         aPercentages,
+         aOldTensors,
+         nullptr,
+         aTensors);
+   CHECK(Error_IllegalParamVal == error);
+}
@@ -1052,3 +1052,137 @@ TEST_CASE("Purify simple multiclass overflow the shifts, normalize classes") {
    //  const double impurity1 = MeasureImpurity(cClasses, 1, cDimensions, dimensionLengths, weights, scores);
    //  CHECK(-0.001 < impurity1 && impurity1 < 0.001);
 }
+
+TEST_CASE("PurifyMany matches Purify on each tensor") {
+   const IntEbm dimensionLengths0[]{3, 2};
+   const IntEbm dimensionLengths1[]{2, 2, 3};
+   const IntEbm dimensionLengths2[]{4};
+   const double weights0[]{1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+   const double weights1[]{1.0, 3.0, 2.0, 5.0, 4.0, 1.0, 2.0, 2.0, 3.0, 1.0, 6.0, 2.0};
+   const double weights2[]{2.0, 1.0, 4.0, 3.0};
+   const double scoresOriginal0[]{1.0, -2.0, 3.5, 0.25, 7.0, -1.0};
+   const double scoresOriginal1[]{0.5, 2.0, -3.0, 1.0, 4.0, -2.5, 0.0, 1.5, 3.0, -1.0, 2.0, 5.0};
+   const double scoresOriginal2[]{3.0, -1.0, 2.0, 0.5};
+
+   double scoresSingle0[6];
+   double scoresSingle1[12];
+   double scoresSingle2[4];
+   memcpy(scoresSingle0, scoresOriginal0, sizeof(scoresSingle0));
+   memcpy(scoresSingle1, scoresOriginal1, sizeof(scoresSingle1));
+   memcpy(scoresSingle2, scoresOriginal2, sizeof(scoresSingle2));
+   double impuritiesSingle0[2 + 3];
+   double impuritiesSingle1[6 + 6 + 4];
+   double interceptSingle[3];
+
+   CHECK(Error_None ==
+         Purify(0.0,
+               EBM_TRUE,
+               EBM_TRUE,
+               1,
+               2,
+               dimensionLengths0,
+               weights0,
+               scoresSingle0,
+               impuritiesSingle0,
+               &interceptSingle[0]));
+   CHECK(Error_None ==
+         Purify(0.0,
+               EBM_TRUE,
+               EBM_TRUE,
+               1,
+               3,
+               dimensionLengths1,
+               weights1,
+               scoresSingle1,
+               impuritiesSingle1,
+               &interceptSingle[1]));
+   CHECK(Error_None ==
+         Purify(0.0,
+               EBM_TRUE,
+               EBM_TRUE,
+               1,
+               1,
+               dimensionLengths2,
+               weights2,
+               scoresSingle2,
+               nullptr,
+               &interceptSingle[2]));
+
+   double scoresMany0[6];
+   double scoresMany1[12];
+   double scoresMany2[4];
+   memcpy(scoresMany0, scoresOriginal0, sizeof(scoresMany0));
+   memcpy(scoresMany1, scoresOriginal1, sizeof(scoresMany1));
+   memcpy(scoresMany2, scoresOriginal2, sizeof(scoresMany2));
+   double impuritiesMany0[2 + 3];
+   double impuritiesMany1[6 + 6 + 4];
+   double interceptMany[3];
+
+   const IntEbm countDimensions[]{2, 3, 1};
+   const IntEbm* const dimensionLengths[]{dimensionLengths0, dimensionLengths1, dimensionLengths2};
+   const double* const weights[]{weights0, weights1, weights2};
+   double* const scores[]{scoresMany0, scoresMany1, scoresMany2};
+   double* const impurities[]{impuritiesMany0, impuritiesMany1, nullptr};
+   double* const intercepts[]{&interceptMany[0], &interceptMany[1], &interceptMany[2]};
+   IntEbm iterations[3];
+   BoolEbm isConverged[3];
+
+   CHECK(Error_None ==
+         PurifyMany(0.0,
+               EBM_TRUE,
+               EBM_TRUE,
+               1,
+               0,
+               3,
+               countDimensions,
+               dimensionLengths,
+               weights,
+               scores,
+               impurities,
+               intercepts,
+               iterations,
+               isConverged));
+
+   for(size_t i = 0; i < 6; ++i) {
+      CHECK(scoresSingle0[i] == scoresMany0[i]);
+   }
+   for(size_t i = 0; i < 12; ++i) {
+      CHECK(scoresSingle1[i] == scoresMany1[i]);
+   }
+   for(size_t i = 0; i < 4; ++i) {
+      CHECK(scoresSingle2[i] == scoresMany2[i]);
+   }
+   for(size_t i = 0; i < 5; ++i) {
+      CHECK(impuritiesSingle0[i] == impuritiesMany0[i]);
+   }
+   for(size_t i = 0; i < 16; ++i) {
+      CHECK(impuritiesSingle1[i] == impuritiesMany1[i]);
+   }
+   for(size_t i = 0; i < 3; ++i) {
+      CHECK(interceptSingle[i] == interceptMany[i]);
+      CHECK(EBM_TRUE == isConverged[i]);
+   }
+   CHECK(IntEbm{1} <= iterations[0]);
+   CHECK(IntEbm{1} <= iterations[1]);
+   CHECK(IntEbm{0} == iterations[2]); // single dimensions only have an intercept to remove
+
+   // a single sweep cannot purify the 2x2x3 tensor, so it stops short of converging
+   memcpy(scoresMany1, scoresOriginal1, sizeof(scoresMany1));
+   CHECK(Error_None ==
+         PurifyMany(0.0,
+               EBM_TRUE,
+               EBM_TRUE,
+               1,
+               1,
+               1,
+               &countDimensions[1],
+               &dimensionLengths[1],
+               &weights[1],
+               &scores[1],
+               nullptr,
+               nullptr,
+               iterations,
+               isConverged));
+   CHECK(IntEbm{1} == iterations[0]);
+   CHECK(EBM_FALSE == isConverged[0]);
+}
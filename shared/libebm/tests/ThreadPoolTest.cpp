@@ -0,0 +1,209 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch_test.hpp"
+
+#ifdef __linux__
+#include <unistd.h> // fork, _exit, alarm
+#include <sys/wait.h> // waitpid
+#endif // __linux__
+
+#include "libebm.h"
+#include "libebm_test.hpp"
+
+static constexpr TestPriority k_filePriority = TestPriority::ThreadPool;
+
+static ErrorEbm EBM_CALLING_CONVENTION SerialParallelFor(
+      void* callbackContext, IntEbm countTasks, ParallelTaskFunction task, void* taskContext) {
+   *static_cast<IntEbm*>(callbackContext) += countTasks;
+   for(IntEbm iTask = 0; iTask < countTasks; ++iTask) {
+      const ErrorEbm error = task(taskContext, iTask);
+      if(Error_None != error) {
+         return error;
+      }
+   }
+   return Error_None;
+}
+
+TEST_CASE("DiscretizeMany, same bins for any thread pool") {
+   ErrorEbm error;
+
+   static constexpr size_t cSamples = 150001;
+   static constexpr size_t cFeatures = 4;
+
+   const double cuts[]{-1.0, 0.5, 100.0, 1000.0};
+   const IntEbm cutOffsets[]{0, 1, 2, 3, 4};
+
+   std::vector<double> col(cSamples);
+   for(size_t i = 0; i < cSamples; ++i) {
+      col[i] = static_cast<double>((i * 7) % 2003) - 3.0;
+   }
+   std::vector<const double*> featureCols(cFeatures, &col[0]);
+
+   std::vector<IntEbm> expected(cFeatures * cSamples, -1);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &expected[0]);
+   CHECK(Error_None == error);
+
+   std::vector<IntEbm> binIndexes(cFeatures * cSamples, -1);
+
+   error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &binIndexes[0]);
+   CHECK(Error_None == error);
+   CHECK(expected == binIndexes);
+
+   // pinning is ignored on platforms that do not support it
+   std::fill(binIndexes.begin(), binIndexes.end(), IntEbm{-1});
+   error = SetThreadPool(3, ThreadPoolFlags_PinCores, -1);
+   CHECK(Error_None == error);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &binIndexes[0]);
+   CHECK(Error_None == error);
+   CHECK(expected == binIndexes);
+
+   std::fill(binIndexes.begin(), binIndexes.end(), IntEbm{-1});
+   IntEbm cTasksDispatched = 0;
+   error = SetParallelForCallback(SerialParallelFor, &cTasksDispatched);
+   CHECK(Error_None == error);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &binIndexes[0]);
+   CHECK(Error_None == error);
+   CHECK(expected == binIndexes);
+   CHECK(IntEbm{cFeatures} <= cTasksDispatched);
+
+   error = SetParallelForCallback(nullptr, nullptr);
+   CHECK(Error_None == error);
+   error = SetThreadPool(0, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+
+   error = SetThreadPool(-1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_IllegalParamVal == error);
+   error = SetThreadPool(0, ThreadPoolFlags_Default, -2);
+   CHECK(Error_IllegalParamVal == error);
+
+   // back to the default of working on the calling thread
+   error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+}
+
+TEST_CASE("thread pool, spreading over NUMA nodes does not change the model") {
+   const auto boost = [&](const ThreadPoolFlags flags) {
+      ErrorEbm error = SetThreadPool(4, flags, -1);
+      CHECK(Error_None == error);
+
+      TestBoost test = TestBoost(3,
+            {FeatureTest(3), FeatureTest(4)},
+            {{0}, {1}, {0, 1}},
+            {
+                  TestSample({0, 1}, 0),
+                  TestSample({1, 3}, 1),
+                  TestSample({2, 0}, 2),
+                  TestSample({1, 2}, 1),
+                  TestSample({2, 2}, 0),
+            },
+            {TestSample({0, 0}, 1), TestSample({2, 3}, 2)});
+
+      for(size_t iRound = 0; iRound < 10; ++iRound) {
+         for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+            test.Boost(iTerm);
+         }
+      }
+
+      std::vector<double> scores;
+      for(size_t i0 = 0; i0 < 3; ++i0) {
+         for(size_t i1 = 0; i1 < 4; ++i1) {
+            for(size_t iScore = 0; iScore < 3; ++iScore) {
+               scores.push_back(test.GetCurrentTermScore(2, {i0, i1}, iScore));
+            }
+         }
+      }
+      return scores;
+   };
+
+   const std::vector<double> expected = boost(ThreadPoolFlags_Default);
+   CHECK(expected == boost(ThreadPoolFlags_SpreadNodes));
+   CHECK(expected == boost(ThreadPoolFlags_SpreadNodes | ThreadPoolFlags_PinCores));
+
+   ErrorEbm error = SetThreadPool(0, ThreadPoolFlags_SpreadNodes, 0);
+   CHECK(Error_IllegalParamVal == error);
+
+   error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+}
+
+TEST_CASE("thread pool, interaction strength does not depend on the thread count") {
+   // enough samples for several subsets when the SIMD zones are used, which are binned as separate tasks
+   static constexpr size_t cSamples = 300007;
+
+   std::vector<TestSample> samples;
+   samples.reserve(cSamples);
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      const IntEbm bin0 = static_cast<IntEbm>(iSample % 3);
+      const IntEbm bin1 = static_cast<IntEbm>(iSample * 7 % 5);
+      const double target = static_cast<double>(bin0 * bin1) + static_cast<double>(iSample % 11) * 0.125;
+      samples.push_back(TestSample({bin0, bin1}, target));
+   }
+
+   const auto calc = [&](const IntEbm countThreads) {
+      ErrorEbm error = SetThreadPool(countThreads, ThreadPoolFlags_Default, -1);
+      CHECK(Error_None == error);
+
+      TestInteraction test = TestInteraction(Task_Regression, {FeatureTest(3), FeatureTest(5)}, samples);
+      return test.TestCalcInteractionStrength({0, 1});
+   };
+
+   const double expected = calc(1);
+   CHECK(0.0 < expected);
+   CHECK(expected == calc(4));
+
+   ErrorEbm error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+}
+
+#ifdef __linux__
+TEST_CASE("thread pool, a forked child starts its own workers") {
+   static constexpr size_t cSamples = 150001;
+   static constexpr size_t cFeatures = 4;
+
+   const double cuts[]{-1.0, 0.5, 100.0, 1000.0};
+   const IntEbm cutOffsets[]{0, 1, 2, 3, 4};
+
+   std::vector<double> col(cSamples);
+   for(size_t i = 0; i < cSamples; ++i) {
+      col[i] = static_cast<double>((i * 7) % 2003) - 3.0;
+   }
+   std::vector<const double*> featureCols(cFeatures, &col[0]);
+
+   ErrorEbm error = SetThreadPool(3, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+
+   // start the parent's workers before forking
+   std::vector<IntEbm> expected(cFeatures * cSamples, -1);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &expected[0]);
+   CHECK(Error_None == error);
+
+   const pid_t pid = fork();
+   CHECK(0 <= pid);
+   if(0 == pid) {
+      // a child that waits on the parent's workers would hang, so give up after a while
+      alarm(60);
+      std::vector<IntEbm> binIndexes(cFeatures * cSamples, -1);
+      const ErrorEbm errorChild =
+            DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &binIndexes[0]);
+      _exit(Error_None == errorChild && expected == binIndexes ? 0 : 1);
+   }
+   if(0 < pid) {
+      int status = -1;
+      CHECK(pid == waitpid(pid, &status, 0));
+      CHECK(WIFEXITED(status) && 0 == WEXITSTATUS(status));
+   }
+
+   // the parent's workers are unaffected
+   std::vector<IntEbm> binIndexes(cFeatures * cSamples, -1);
+   error = DiscretizeMany(cFeatures, cSamples, &featureCols[0], cutOffsets, cuts, &binIndexes[0]);
+   CHECK(Error_None == error);
+   CHECK(expected == binIndexes);
+
+   error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+}
+#endif // __linux__
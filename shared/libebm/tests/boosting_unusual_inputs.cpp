@@ -4,6 +4,10 @@
 
 #include "pch_test.hpp"
 
+#ifdef __linux__
+#include <malloc.h> // mallinfo2
+#endif // __linux__
+
 #include "libebm.h"
 #include "libebm_test.hpp"
 
@@ -1893,3 +1897,1177 @@ TEST_CASE("purified boosting and impure boosting different for impure input, reg
       }
    }
 }
+
+TEST_CASE("purified boosting has zero weighted marginals with unequal bin counts, regression") {
+   // every bin of the 2x2 term becomes its own leaf, so the purification weights are the bin counts, which are
+   // 3 for {0, 0}, 2 for {0, 1}, 1 for {1, 0}, and 5 for {1, 1} in GetCurrentTermScore indexing
+   TestBoost test = TestBoost(Task_Regression,
+         {FeatureTest(2), FeatureTest(2)},
+         {{0, 1}},
+         {
+               TestSample({0, 0}, 2.0),
+               TestSample({0, 0}, 2.5),
+               TestSample({0, 0}, 1.5),
+               TestSample({0, 1}, -7.0),
+               TestSample({1, 0}, -3.5),
+               TestSample({1, 0}, -2.5),
+               TestSample({1, 1}, 6.0),
+               TestSample({1, 1}, 5.0),
+               TestSample({1, 1}, 4.5),
+               TestSample({1, 1}, 5.5),
+               TestSample({1, 1}, 6.5),
+         },
+         {TestSample({0, 1}, 12)});
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+         test.Boost(iTerm, TermBoostFlags_PurifyUpdate);
+
+         const double termScore00 = test.GetCurrentTermScore(iTerm, {0, 0}, 0);
+         const double termScore10 = test.GetCurrentTermScore(iTerm, {1, 0}, 0);
+         const double termScore01 = test.GetCurrentTermScore(iTerm, {0, 1}, 0);
+         const double termScore11 = test.GetCurrentTermScore(iTerm, {1, 1}, 0);
+
+         CHECK(0.0 != termScore00);
+
+         CHECK(std::abs(3.0 * termScore00 + 2.0 * termScore01) < 1e-12);
+         CHECK(std::abs(1.0 * termScore10 + 5.0 * termScore11) < 1e-12);
+         CHECK(std::abs(3.0 * termScore00 + 1.0 * termScore10) < 1e-12);
+         CHECK(std::abs(2.0 * termScore01 + 5.0 * termScore11) < 1e-12);
+      }
+   }
+}
+
+TEST_CASE("booster stats, counts each phase per term") {
+   TestBoost test = TestBoost(Task_Regression,
+         {FeatureTest(3), FeatureTest(4)},
+         {{0}, {1}, {0, 1}},
+         {
+               TestSample({0, 1}, 10),
+               TestSample({1, 3}, 11),
+               TestSample({2, 0}, 12),
+               TestSample({1, 2}, 13),
+         },
+         {TestSample({0, 0}, 10), TestSample({2, 3}, 15)});
+
+   static constexpr size_t k_cRounds = 5;
+   for(size_t iRound = 0; iRound < k_cRounds; ++iRound) {
+      for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+         test.Boost(iTerm);
+      }
+   }
+
+   static constexpr size_t k_cItems = BoosterStatItem_COUNT;
+   std::vector<UIntEbm> termStats(test.GetCountTerms() * BoosterStat_COUNT * k_cItems, 77);
+   std::vector<UIntEbm> zoneStats(BoosterStatZone_COUNT * BoosterStat_COUNT * k_cItems, 77);
+   ErrorEbm error = GetBoosterStats(test.GetBoosterHandle(), EBM_TRUE, &termStats[0], &zoneStats[0]);
+   CHECK(Error_None == error);
+
+   const auto termStat = [&](size_t iTerm, size_t iStat, size_t iItem) {
+      return termStats[(iTerm * BoosterStat_COUNT + iStat) * k_cItems + iItem];
+   };
+
+   for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+      CHECK(k_cRounds <= termStat(iTerm, BoosterStat_BinSums, BoosterStatItem_Calls));
+      CHECK(0 < termStat(iTerm, BoosterStat_BinSums, BoosterStatItem_Bytes));
+      CHECK(k_cRounds <= termStat(iTerm, BoosterStat_Partition, BoosterStatItem_Calls));
+      CHECK(k_cRounds == termStat(iTerm, BoosterStat_ApplyUpdate, BoosterStatItem_Calls));
+      CHECK(k_cRounds == termStat(iTerm, BoosterStat_Validation, BoosterStatItem_Calls));
+      CHECK(0 < termStat(iTerm, BoosterStat_Validation, BoosterStatItem_Bytes));
+   }
+   // only the pair has tensor totals
+   CHECK(0 == termStat(0, BoosterStat_TensorTotals, BoosterStatItem_Calls));
+   CHECK(0 == termStat(1, BoosterStat_TensorTotals, BoosterStatItem_Calls));
+   CHECK(k_cRounds <= termStat(2, BoosterStat_TensorTotals, BoosterStatItem_Calls));
+
+   // every zoned call is counted in exactly one zone
+   for(size_t iStat = 0; iStat < BoosterStat_COUNT; ++iStat) {
+      UIntEbm cTermCalls = 0;
+      for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+         cTermCalls += termStat(iTerm, iStat, BoosterStatItem_Calls);
+      }
+      UIntEbm cZoneCalls = 0;
+      for(size_t iZone = 0; iZone < BoosterStatZone_COUNT; ++iZone) {
+         cZoneCalls += zoneStats[(iZone * BoosterStat_COUNT + iStat) * k_cItems + BoosterStatItem_Calls];
+      }
+      if(BoosterStat_BinSums == iStat || BoosterStat_ApplyUpdate == iStat || BoosterStat_Validation == iStat) {
+         CHECK(cTermCalls == cZoneCalls);
+      } else {
+         CHECK(0 == cZoneCalls);
+      }
+   }
+
+   // the previous call reset the counters
+   error = GetBoosterStats(test.GetBoosterHandle(), EBM_FALSE, &termStats[0], nullptr);
+   CHECK(Error_None == error);
+   for(const UIntEbm stat : termStats) {
+      CHECK(0 == stat);
+   }
+
+   error = GetBoosterStats(test.GetBoosterHandle(), 2, nullptr, nullptr);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("scratch stats, boosting stops allocating once the scratch memory has grown") {
+   TestBoost test = TestBoost(Task_Regression,
+         {FeatureTest(3), FeatureTest(4)},
+         {{0}, {1}, {0, 1}},
+         {
+               TestSample({0, 1}, 10),
+               TestSample({1, 3}, 11),
+               TestSample({2, 0}, 12),
+               TestSample({1, 2}, 13),
+         },
+         {TestSample({0, 0}, 10), TestSample({2, 3}, 15)},
+         k_countInnerBagsDefault,
+         k_testCreateBoosterFlags_Default | CreateBoosterFlags_HugePages);
+
+   // the pair borrows scratch memory for purification and for random splits, and the mains for their split heaps
+   const auto boostRound = [&]() {
+      test.Boost(0);
+      test.Boost(1);
+      test.Boost(2, TermBoostFlags_PurifyUpdate);
+      test.Boost(2, TermBoostFlags_RandomSplits);
+   };
+
+   boostRound();
+   std::vector<UIntEbm> scratchStats(ScratchStat_COUNT, 77);
+   ErrorEbm error = GetBoosterScratchStats(test.GetBoosterHandle(), EBM_TRUE, &scratchStats[0]);
+   CHECK(Error_None == error);
+   CHECK(0 < scratchStats[ScratchStat_PeakBytes]);
+   CHECK(scratchStats[ScratchStat_PeakBytes] <= scratchStats[ScratchStat_ReservedBytes]);
+   CHECK(1 <= scratchStats[ScratchStat_Blocks]);
+   const UIntEbm cBytesReserved = scratchStats[ScratchStat_ReservedBytes];
+
+   for(size_t iRound = 0; iRound < 5; ++iRound) {
+      boostRound();
+   }
+   error = GetBoosterScratchStats(test.GetBoosterHandle(), EBM_FALSE, &scratchStats[0]);
+   CHECK(Error_None == error);
+   CHECK(0 < scratchStats[ScratchStat_PeakBytes]);
+   CHECK(cBytesReserved == scratchStats[ScratchStat_ReservedBytes]);
+   CHECK(0 == scratchStats[ScratchStat_Blocks]);
+
+   error = GetBoosterScratchStats(test.GetBoosterHandle(), 2, nullptr);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("timeline, records begin and end events for boosting") {
+   StartTimeline();
+
+   TestBoost test = TestBoost(Task_Regression,
+         {FeatureTest(3)},
+         {{0}},
+         {
+               TestSample({0}, 10),
+               TestSample({1}, 11),
+               TestSample({2}, 12),
+         },
+         {TestSample({1}, 12)});
+
+   static constexpr size_t k_cRounds = 3;
+   for(size_t iRound = 0; iRound < k_cRounds; ++iRound) {
+      test.Boost(0);
+   }
+
+   StopTimeline();
+
+   // nothing is recorded after StopTimeline
+   test.Boost(0);
+
+   const IntEbm cBytes = MeasureTimelineJson();
+   CHECK(0 < cBytes);
+   std::vector<char> json(static_cast<size_t>(cBytes));
+   ErrorEbm error = FillTimelineJson(cBytes, &json[0]);
+   CHECK(Error_None == error);
+   const std::string str(&json[0]);
+
+   const auto count = [&](const std::string& find) {
+      size_t c = 0;
+      for(size_t i = str.find(find); std::string::npos != i; i = str.find(find, i + 1)) {
+         ++c;
+      }
+      return c;
+   };
+
+   CHECK(0 == str.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+   CHECK(std::string::npos != str.find("]}"));
+   CHECK(2 == count("\"name\":\"CreateBooster\""));
+   CHECK(1 == count("\"name\":\"CreateBooster\",\"ph\":\"E\""));
+   CHECK(2 * k_cRounds == count("\"name\":\"GenerateTermUpdate\""));
+   CHECK(2 * k_cRounds == count("\"name\":\"ApplyTermUpdate\""));
+   CHECK(k_cRounds == count("\"name\":\"ApplyTermUpdate\",\"ph\":\"E\""));
+   CHECK(2 * k_cRounds == count("\"args\":{\"term\":0,\"samples\":3}"));
+
+   error = FillTimelineJson(16, &json[0]);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("Poisson bags, a lone sample is in every bag") {
+   const auto boost = [&](const CreateBoosterFlags flags) {
+      TestBoost test = TestBoost(Task_Regression,
+            {FeatureTest(2)},
+            {{0}},
+            {TestSample({1}, 10.0)},
+            {TestSample({1}, 12.0)},
+            8,
+            flags);
+      for(size_t iRound = 0; iRound < 5; ++iRound) {
+         test.Boost(0);
+      }
+      return test.GetCurrentTermScore(0, {1}, 0);
+   };
+
+   // a bag where every sample drew zero is redrawn, and scaling one sample's weight does not change its update
+   const double expected = boost(k_testCreateBoosterFlags_Default);
+   CHECK_APPROX(expected, boost(k_testCreateBoosterFlags_Default | CreateBoosterFlags_PoissonBags));
+}
+
+TEST_CASE("Poisson bags, weighted multiclass does not depend on the thread pool") {
+   const auto boost = [&](const IntEbm countThreads) {
+      ErrorEbm error = SetThreadPool(countThreads, ThreadPoolFlags_Default, -1);
+      CHECK(Error_None == error);
+
+      TestBoost test = TestBoost(3,
+            {FeatureTest(3), FeatureTest(4)},
+            {{0}, {1}, {0, 1}},
+            {
+                  TestSample({0, 1}, 0, 0.5),
+                  TestSample({1, 3}, 1, 2.0),
+                  TestSample({2, 0}, 2, 1.0),
+                  TestSample({1, 2}, 1, 1.5),
+                  TestSample({2, 2}, 0, 0.75),
+                  TestSample({0, 3}, 2, 1.25),
+            },
+            {TestSample({0, 0}, 1), TestSample({2, 3}, 2)},
+            5,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_PoissonBags);
+
+      for(size_t iRound = 0; iRound < 10; ++iRound) {
+         for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+            test.Boost(iTerm);
+         }
+      }
+
+      std::vector<double> scores;
+      for(size_t i0 = 0; i0 < 3; ++i0) {
+         for(size_t i1 = 0; i1 < 4; ++i1) {
+            for(size_t iScore = 0; iScore < 3; ++iScore) {
+               const double score = test.GetCurrentTermScore(2, {i0, i1}, iScore);
+               CHECK(std::isfinite(score));
+               scores.push_back(score);
+            }
+         }
+      }
+      return scores;
+   };
+
+   const std::vector<double> expected = boost(1);
+   CHECK(expected == boost(3));
+
+   ErrorEbm error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+}
+
+TEST_CASE("gradient sampling, only the largest gradients are binned when otherFraction is zero") {
+   const auto boost = [&](const bool bSample) {
+      TestBoost test = TestBoost(Task_Regression,
+            {FeatureTest(2)},
+            {{0}},
+            {
+                  TestSample({0}, 10.0),
+                  TestSample({0}, 10.0),
+                  TestSample({1}, 1.0),
+                  TestSample({1}, 1.0),
+            },
+            {TestSample({0}, 10.0)});
+      if(bSample) {
+         const ErrorEbm error = SetGradientSampling(nullptr, test.GetBoosterHandle(), 0.5, 0.0);
+         CHECK(Error_None == error);
+      }
+      test.Boost(0);
+      return std::vector<double>{test.GetCurrentTermScore(0, {0}, 0), test.GetCurrentTermScore(0, {1}, 0)};
+   };
+
+   const std::vector<double> expected = boost(false);
+   const std::vector<double> sampled = boost(true);
+   CHECK_APPROX(expected[0], sampled[0]);
+   CHECK(0.0 != expected[1]);
+   CHECK(0.0 == sampled[1]);
+}
+
+TEST_CASE("gradient sampling, illegal fractions") {
+   TestBoost test = TestBoost(Task_Regression, {FeatureTest(2)}, {{0}}, {TestSample({0}, 10.0)}, {});
+
+   CHECK(Error_IllegalParamVal == SetGradientSampling(nullptr, test.GetBoosterHandle(), -0.1, 0.5));
+   CHECK(Error_IllegalParamVal == SetGradientSampling(nullptr, test.GetBoosterHandle(), 0.5, 1.5));
+   CHECK(Error_IllegalParamVal == SetGradientSampling(nullptr, test.GetBoosterHandle(), 0.0, 0.0));
+   CHECK(Error_IllegalParamVal ==
+         SetGradientSampling(
+               nullptr, test.GetBoosterHandle(), std::numeric_limits<double>::quiet_NaN(), 0.5));
+   // keeping every sample turns sampling off
+   CHECK(Error_None == SetGradientSampling(nullptr, test.GetBoosterHandle(), 0.5, 0.5));
+   test.Boost(0);
+}
+
+TEST_CASE("gradient sampling, weighted multiclass does not depend on the thread pool") {
+   const auto boost = [&](const IntEbm countThreads) {
+      ErrorEbm error = SetThreadPool(countThreads, ThreadPoolFlags_Default, -1);
+      CHECK(Error_None == error);
+
+      std::vector<TestSample> train;
+      for(size_t iSample = 0; iSample < 100; ++iSample) {
+         train.push_back(TestSample({static_cast<IntEbm>(iSample % 3), static_cast<IntEbm>(iSample * 7 % 4)},
+               static_cast<double>(iSample * 5 % 3),
+               0.5 + static_cast<double>(iSample % 4) * 0.25));
+      }
+
+      TestBoost test = TestBoost(3,
+            {FeatureTest(3), FeatureTest(4)},
+            {{0}, {1}, {0, 1}},
+            train,
+            {TestSample({0, 0}, 1), TestSample({2, 3}, 2)},
+            2);
+
+      std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+      InitRNG(42, &rng[0]);
+      error = SetGradientSampling(&rng[0], test.GetBoosterHandle(), 0.2, 0.3);
+      CHECK(Error_None == error);
+
+      for(size_t iRound = 0; iRound < 10; ++iRound) {
+         for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+            test.Boost(iTerm);
+         }
+      }
+
+      std::vector<double> scores;
+      for(size_t i0 = 0; i0 < 3; ++i0) {
+         for(size_t i1 = 0; i1 < 4; ++i1) {
+            for(size_t iScore = 0; iScore < 3; ++iScore) {
+               const double score = test.GetCurrentTermScore(2, {i0, i1}, iScore);
+               CHECK(std::isfinite(score));
+               scores.push_back(score);
+            }
+         }
+      }
+      return scores;
+   };
+
+   const std::vector<double> expected = boost(1);
+   CHECK(expected == boost(3));
+
+   ErrorEbm error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+}
+
+TEST_CASE("best model, a term boosted without improvement is copied on the next improvement") {
+   // the validation set reverses the relationship between feature 1 and the target, so boosting term 1 makes the
+   // validation metric worse while boosting term 0 makes it better
+   TestBoost test = TestBoost(Task_Regression,
+         {FeatureTest(2), FeatureTest(2)},
+         {{0}, {1}},
+         {
+               TestSample({0, 0}, 1.0),
+               TestSample({1, 1}, -1.0),
+         },
+         {
+               TestSample({0, 1}, 1.0),
+               TestSample({1, 0}, -1.0),
+         });
+
+   const double metric0 = test.Boost(0, TermBoostFlags_Default, 0.1).validationMetric;
+   const double metric1 = test.Boost(1).validationMetric;
+   CHECK(metric0 < metric1);
+   CHECK(0.0 != test.GetCurrentTermScore(1, {0}, 0));
+   CHECK(0.0 == test.GetBestTermScore(1, {0}, 0));
+
+   const double metric2 = test.Boost(0, TermBoostFlags_Default, 0.1).validationMetric;
+   CHECK(metric2 < metric0);
+   for(size_t iTerm = 0; iTerm < test.GetCountTerms(); ++iTerm) {
+      for(size_t iBin = 0; iBin < 2; ++iBin) {
+         CHECK(test.GetCurrentTermScore(iTerm, {iBin}, 0) == test.GetBestTermScore(iTerm, {iBin}, 0));
+      }
+   }
+}
+
+static ErrorEbm CreateMultitaskBooster(const TaskEbm cClasses,
+      const IntEbm countBins,
+      const std::vector<IntEbm> binIndexes,
+      const std::vector<std::vector<double>> targets,
+      std::vector<unsigned char>& rng,
+      std::vector<unsigned char>& dataset,
+      BoosterHandle* const pBoosterHandleOut) {
+   const IntEbm cSamples = static_cast<IntEbm>(binIndexes.size());
+
+   std::vector<IntEbm> classCounts;
+   for(const std::vector<double>& target : targets) {
+      const IntEbm maxTarget = static_cast<IntEbm>(*std::max_element(target.begin(), target.end()));
+      classCounts.push_back(std::max(static_cast<IntEbm>(cClasses), maxTarget + 1));
+   }
+
+   IntEbm size = MeasureDataSetHeader(1, 0, static_cast<IntEbm>(targets.size()));
+   size += MeasureFeature(countBins, EBM_TRUE, EBM_TRUE, EBM_FALSE, cSamples, &binIndexes[0]);
+   for(size_t iTarget = 0; iTarget < targets.size(); ++iTarget) {
+      if(Task_GeneralClassification <= cClasses) {
+         const std::vector<IntEbm> classes(targets[iTarget].begin(), targets[iTarget].end());
+         size += MeasureClassificationTarget(classCounts[iTarget], cSamples, &classes[0]);
+      } else {
+         size += MeasureRegressionTarget(cSamples, &targets[iTarget][0]);
+      }
+   }
+   dataset.resize(static_cast<size_t>(size));
+
+   ErrorEbm error = FillDataSetHeader(1, 0, static_cast<IntEbm>(targets.size()), size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillDataSetHeader");
+   }
+   error = FillFeature(countBins, EBM_TRUE, EBM_TRUE, EBM_FALSE, cSamples, &binIndexes[0], size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillFeature");
+   }
+   for(size_t iTarget = 0; iTarget < targets.size(); ++iTarget) {
+      if(Task_GeneralClassification <= cClasses) {
+         const std::vector<IntEbm> classes(targets[iTarget].begin(), targets[iTarget].end());
+         error = FillClassificationTarget(classCounts[iTarget], cSamples, &classes[0], size, &dataset[0]);
+      } else {
+         error = FillRegressionTarget(cSamples, &targets[iTarget][0], size, &dataset[0]);
+      }
+      if(Error_None != error) {
+         throw TestException(error, "Fill*Target");
+      }
+   }
+
+   rng.resize(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seed, &rng[0]);
+
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {0};
+   return CreateBooster(&rng[0],
+         &dataset[0],
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         k_countInnerBagsDefault,
+         CreateBoosterFlags_Default,
+         k_testAccelerationFlags_Default,
+         Task_GeneralClassification <= cClasses ? "log_loss" : "rmse",
+         nullptr,
+         0,
+         pBoosterHandleOut);
+}
+
+static void CheckMultitaskMatchesSingleTask(
+      TestCaseHidden& testCaseHidden, const TaskEbm cClasses, const std::vector<std::vector<double>> targets) {
+   // with only 2 bins there is just one possible cut, so the shared splits of the multitask model must match the
+   // splits of separately trained models and each target's scores must come out the same
+   static constexpr IntEbm k_cBins = 2;
+   static constexpr size_t k_cRounds = 5;
+
+   std::vector<IntEbm> binIndexes;
+   for(size_t iSample = 0; iSample < targets[0].size(); ++iSample) {
+      binIndexes.push_back(static_cast<IntEbm>(iSample % 3 % 2));
+   }
+
+   std::vector<unsigned char> rng;
+   std::vector<unsigned char> dataset;
+   BoosterHandle boosterHandle = nullptr;
+   ErrorEbm error = CreateMultitaskBooster(cClasses, k_cBins, binIndexes, targets, rng, dataset, &boosterHandle);
+   if(Error_None != error) {
+      throw TestException(error, "CreateBooster");
+   }
+   for(size_t iRound = 0; iRound < k_cRounds; ++iRound) {
+      error = GenerateTermUpdate(&rng[0],
+            boosterHandle,
+            0,
+            TermBoostFlags_Default,
+            k_learningRateDefault,
+            k_minSamplesLeafDefault,
+            k_minHessianDefault,
+            k_regAlphaDefault,
+            k_regLambdaDefault,
+            k_maxDeltaStepDefault,
+            &k_leavesMaxDefault[0],
+            nullptr,
+            nullptr);
+      CHECK(Error_None == error);
+      error = ApplyTermUpdate(boosterHandle, nullptr);
+      CHECK(Error_None == error);
+   }
+   std::vector<double> multitaskScores(static_cast<size_t>(k_cBins) * targets.size());
+   error = GetCurrentTermScores(boosterHandle, 0, &multitaskScores[0]);
+   CHECK(Error_None == error);
+   FreeBooster(boosterHandle);
+
+   for(size_t iTarget = 0; iTarget < targets.size(); ++iTarget) {
+      std::vector<TestSample> samples;
+      for(size_t iSample = 0; iSample < binIndexes.size(); ++iSample) {
+         samples.push_back(TestSample({binIndexes[iSample]}, targets[iTarget][iSample]));
+      }
+      TestBoost test = TestBoost(cClasses, {FeatureTest(k_cBins)}, {{0}}, samples, {});
+      for(size_t iRound = 0; iRound < k_cRounds; ++iRound) {
+         test.Boost(0);
+      }
+      double singleScores[k_cBins];
+      test.GetCurrentTermScoresRaw(0, singleScores);
+      for(size_t iBin = 0; iBin < static_cast<size_t>(k_cBins); ++iBin) {
+         CHECK_APPROX(multitaskScores[iBin * targets.size() + iTarget], singleScores[iBin]);
+      }
+   }
+}
+
+TEST_CASE("multitask log_loss, each target matches a separately trained binary model") {
+   std::vector<std::vector<double>> targets(3);
+   for(size_t iSample = 0; iSample < 37; ++iSample) {
+      targets[0].push_back(static_cast<double>(iSample % 3 % 2));
+      targets[1].push_back(static_cast<double>(iSample % 5 < 2 ? 1 : 0));
+      targets[2].push_back(static_cast<double>(iSample % 7 % 2));
+   }
+   CheckMultitaskMatchesSingleTask(testCaseHidden, Task_BinaryClassification, targets);
+}
+
+TEST_CASE("multitask rmse, each target matches a separately trained regression model") {
+   std::vector<std::vector<double>> targets(2);
+   for(size_t iSample = 0; iSample < 37; ++iSample) {
+      targets[0].push_back(static_cast<double>(iSample % 3 % 2) * 2.5 - 1.0);
+      targets[1].push_back(static_cast<double>(iSample % 5) * -0.75);
+   }
+   CheckMultitaskMatchesSingleTask(testCaseHidden, Task_Regression, targets);
+}
+
+TEST_CASE("multitask, multiclass targets are rejected") {
+   std::vector<std::vector<double>> targets(2);
+   for(size_t iSample = 0; iSample < 6; ++iSample) {
+      targets[0].push_back(static_cast<double>(iSample % 2));
+      targets[1].push_back(static_cast<double>(iSample % 3));
+   }
+   const std::vector<IntEbm> binIndexes(targets[0].size(), 0);
+   std::vector<unsigned char> rng;
+   std::vector<unsigned char> dataset;
+   BoosterHandle boosterHandle = nullptr;
+   const ErrorEbm error = CreateMultitaskBooster(
+         Task_BinaryClassification, 2, binIndexes, targets, rng, dataset, &boosterHandle);
+   CHECK(Error_IllegalParamVal == error);
+   CHECK(nullptr == boosterHandle);
+}
+
+static ErrorEbm CreateRankingBooster(const std::vector<IntEbm> binIndexes,
+      const std::vector<double> relevances,
+      const std::vector<IntEbm> queryGroups,
+      const std::vector<BagEbm> bag,
+      const char* const sObjective,
+      std::vector<unsigned char>& rng,
+      std::vector<unsigned char>& dataset,
+      BoosterHandle* const pBoosterHandleOut) {
+   const IntEbm cSamples = static_cast<IntEbm>(binIndexes.size());
+
+   IntEbm size = MeasureDataSetHeader(1, 0, 1);
+   size += MeasureFeature(2, EBM_TRUE, EBM_TRUE, EBM_FALSE, cSamples, &binIndexes[0]);
+   size += MeasureRankingTarget(cSamples, &relevances[0], &queryGroups[0]);
+   dataset.resize(static_cast<size_t>(size));
+
+   ErrorEbm error = FillDataSetHeader(1, 0, 1, size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillDataSetHeader");
+   }
+   error = FillFeature(2, EBM_TRUE, EBM_TRUE, EBM_FALSE, cSamples, &binIndexes[0], size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillFeature");
+   }
+   error = FillRankingTarget(cSamples, &relevances[0], &queryGroups[0], size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillRankingTarget");
+   }
+
+   rng.resize(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seed, &rng[0]);
+
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {0};
+   return CreateBooster(&rng[0],
+         &dataset[0],
+         &bag[0],
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         k_countInnerBagsDefault,
+         CreateBoosterFlags_Default,
+         k_testAccelerationFlags_Default,
+         sObjective,
+         nullptr,
+         0,
+         pBoosterHandleOut);
+}
+
+TEST_CASE("lambdarank, relevant documents are ranked first") {
+   // bin 1 marks the relevant documents of each query, and they come after the irrelevant ones so that breaking the
+   // initial score ties by document order ranks them last.  Query 3 has no relevant documents and query 4 is held out
+   std::vector<IntEbm> binIndexes;
+   std::vector<double> relevances;
+   std::vector<IntEbm> queryGroups;
+   std::vector<BagEbm> bag;
+   for(IntEbm iQuery = 0; iQuery < 5; ++iQuery) {
+      for(size_t iDocument = 0; iDocument < 6; ++iDocument) {
+         const bool bRelevant = 3 != iQuery && size_t{4} <= iDocument;
+         binIndexes.push_back(bRelevant ? 1 : 0);
+         relevances.push_back(bRelevant ? 1.0 : 0.0);
+         queryGroups.push_back(iQuery * 10);
+         bag.push_back(4 == iQuery ? BagEbm{-1} : BagEbm{1});
+      }
+   }
+
+   std::vector<unsigned char> rng;
+   std::vector<unsigned char> dataset;
+   BoosterHandle boosterHandle = nullptr;
+   ErrorEbm error =
+         CreateRankingBooster(binIndexes, relevances, queryGroups, bag, "lambdarank", rng, dataset, &boosterHandle);
+   if(Error_None != error) {
+      throw TestException(error, "CreateBooster");
+   }
+   double validationMetric = std::numeric_limits<double>::quiet_NaN();
+   for(size_t iRound = 0; iRound < 10; ++iRound) {
+      error = GenerateTermUpdate(&rng[0],
+            boosterHandle,
+            0,
+            TermBoostFlags_Default,
+            k_learningRateDefault,
+            k_minSamplesLeafDefault,
+            k_minHessianDefault,
+            k_regAlphaDefault,
+            k_regLambdaDefault,
+            k_maxDeltaStepDefault,
+            &k_leavesMaxDefault[0],
+            nullptr,
+            nullptr);
+      CHECK(Error_None == error);
+      error = ApplyTermUpdate(boosterHandle, &validationMetric);
+      CHECK(Error_None == error);
+   }
+   // once the relevant documents score higher the validation query has an NDCG of 1
+   CHECK(-1e-9 < validationMetric);
+   CHECK(validationMetric < 1e-9);
+
+   double termScores[2];
+   error = GetCurrentTermScores(boosterHandle, 0, termScores);
+   CHECK(Error_None == error);
+   CHECK(termScores[0] < termScores[1]);
+   FreeBooster(boosterHandle);
+}
+
+TEST_CASE("lambdarank, ranking targets and objectives must match") {
+   const std::vector<IntEbm> binIndexes = {0, 1, 0, 1};
+   const std::vector<double> relevances = {0.0, 1.0, 1.0, 0.0};
+   const std::vector<IntEbm> queryGroups = {0, 0, 1, 1};
+   const std::vector<BagEbm> bag = {1, 1, 1, 1};
+
+   std::vector<unsigned char> rng;
+   std::vector<unsigned char> dataset;
+   BoosterHandle boosterHandle = nullptr;
+   const ErrorEbm error =
+         CreateRankingBooster(binIndexes, relevances, queryGroups, bag, "rmse", rng, dataset, &boosterHandle);
+   CHECK(Error_IllegalParamVal == error);
+   CHECK(nullptr == boosterHandle);
+
+   // a regression target cannot be ranked since it has no query groups
+   std::vector<unsigned char> datasetRegression;
+   const std::vector<double> targets = {1.0};
+   const std::vector<IntEbm> bins = {0};
+   IntEbm size = MeasureDataSetHeader(1, 0, 1);
+   size += MeasureFeature(2, EBM_TRUE, EBM_TRUE, EBM_FALSE, 1, &bins[0]);
+   size += MeasureRegressionTarget(1, &targets[0]);
+   datasetRegression.resize(static_cast<size_t>(size));
+   CHECK(Error_None == FillDataSetHeader(1, 0, 1, size, &datasetRegression[0]));
+   CHECK(Error_None == FillFeature(2, EBM_TRUE, EBM_TRUE, EBM_FALSE, 1, &bins[0], size, &datasetRegression[0]));
+   CHECK(Error_None == FillRegressionTarget(1, &targets[0], size, &datasetRegression[0]));
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {0};
+   BoosterHandle boosterHandleRegression = nullptr;
+   const ErrorEbm errorRegression = CreateBooster(&rng[0],
+         &datasetRegression[0],
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         k_countInnerBagsDefault,
+         CreateBoosterFlags_Default,
+         k_testAccelerationFlags_Default,
+         "lambdarank",
+         nullptr,
+         0,
+         &boosterHandleRegression);
+   CHECK(Error_IllegalParamVal == errorRegression);
+   CHECK(nullptr == boosterHandleRegression);
+}
+
+TEST_CASE("lambdarank, unsorted query groups are rejected") {
+   const double relevances[] = {0.0, 1.0, 2.0};
+   const IntEbm queryGroups[] = {1, 0, 1};
+   IntEbm size = MeasureDataSetHeader(0, 0, 1);
+   size += MeasureRankingTarget(3, relevances, queryGroups);
+   std::vector<unsigned char> dataset(static_cast<size_t>(size));
+   CHECK(Error_None == FillDataSetHeader(0, 0, 1, size, &dataset[0]));
+   CHECK(Error_IllegalParamVal == FillRankingTarget(3, relevances, queryGroups, size, &dataset[0]));
+}
+
+TEST_CASE("validation metric, auc counts tied scores as half") {
+   TestBoost test = TestBoost(Task_BinaryClassification,
+         {FeatureTest(2)},
+         {{0}},
+         {TestSample({0}, 0), TestSample({1}, 1)},
+         {TestSample({0}, 0), TestSample({0}, 1), TestSample({1}, 1)});
+
+   CHECK(Error_None == SetValidationMetric(test.GetBoosterHandle(), "auc"));
+
+   double validationMetric = std::numeric_limits<double>::quiet_NaN();
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      validationMetric = test.Boost(0).validationMetric;
+   }
+   // AUC is maximized, so it is returned negated.  One positive outranks the negative and the other ties with it
+   CHECK_APPROX(validationMetric, -0.75);
+}
+
+TEST_CASE("validation metric, auc separates scores that cluster together") {
+   // a small first step moves the validation scores less than 1/128 logits apart around the initial score
+   TestBoost test = TestBoost(Task_BinaryClassification,
+         {FeatureTest(2)},
+         {{0}},
+         {TestSample({0}, 0), TestSample({1}, 1)},
+         {TestSample({0}, 0, {1.003}), TestSample({1}, 1, {1.003}), TestSample({1}, 0, {1.003})});
+
+   CHECK(Error_None == SetValidationMetric(test.GetBoosterHandle(), "auc"));
+
+   const double validationMetric = test.Boost(0, TermBoostFlags_Default, 0.001).validationMetric;
+   CHECK(test.GetCurrentTermScore(0, {1}, 0) - test.GetCurrentTermScore(0, {0}, 0) < 1.0 / 256.0);
+   // the positive outranks one negative and ties with the other
+   CHECK_APPROX(validationMetric, -0.75);
+}
+
+TEST_CASE("validation metric, log_loss matches the objective") {
+   const auto boost = [&](const char* const sMetric) {
+      TestBoost test = TestBoost(Task_BinaryClassification,
+            {FeatureTest(2)},
+            {{0}},
+            {TestSample({0}, 0), TestSample({1}, 1), TestSample({1}, 0)},
+            {TestSample({0}, 0, 2.0), TestSample({1}, 1), TestSample({1}, 0, 0.5)},
+            k_countInnerBagsDefault,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_DisableApprox);
+      if(nullptr != sMetric) {
+         CHECK(Error_None == SetValidationMetric(test.GetBoosterHandle(), sMetric));
+      }
+      double validationMetric = std::numeric_limits<double>::quiet_NaN();
+      for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+         validationMetric = test.Boost(0).validationMetric;
+      }
+      return validationMetric;
+   };
+
+   CHECK_APPROX(boost("log_loss"), boost(nullptr));
+}
+
+TEST_CASE("validation metric, regression errors") {
+   const auto boost = [&](const char* const sObjective, const char* const sMetric) {
+      TestBoost test = TestBoost(Task_Regression,
+            {FeatureTest(2)},
+            {{0}},
+            {TestSample({0}, 10.0)},
+            {TestSample({0}, 12.0), TestSample({0}, 8.0, 3.0)},
+            k_countInnerBagsDefault,
+            k_testCreateBoosterFlags_Default,
+            k_testAccelerationFlags_Default,
+            sObjective);
+      CHECK(Error_None == SetValidationMetric(test.GetBoosterHandle(), sMetric));
+      const double validationMetric = test.Boost(0).validationMetric;
+      const double score = test.GetCurrentTermScore(0, {0}, 0);
+      return std::vector<double>{validationMetric, score};
+   };
+
+   // rmse keeps only the residuals, and the others keep the scores and targets
+   std::vector<double> ret = boost("rmse", "rmse");
+   CHECK_APPROX(ret[0], std::sqrt(((ret[1] - 12.0) * (ret[1] - 12.0) + 3.0 * (ret[1] - 8.0) * (ret[1] - 8.0)) / 4.0));
+
+   ret = boost("rmse", "mae");
+   CHECK_APPROX(ret[0], ((12.0 - ret[1]) + 3.0 * (8.0 - ret[1])) / 4.0);
+
+   ret = boost("rmse", "pinball:alpha=0.9");
+   CHECK_APPROX(ret[0], 0.9 * ((12.0 - ret[1]) + 3.0 * (8.0 - ret[1])) / 4.0);
+
+   // poisson scores are logs of the predictions
+   ret = boost("poisson_deviance", "mae");
+   CHECK_APPROX(ret[0], ((12.0 - std::exp(ret[1])) + 3.0 * (8.0 - std::exp(ret[1]))) / 4.0);
+}
+
+TEST_CASE("validation metric, illegal metrics") {
+   TestBoost testRegression = TestBoost(Task_Regression, {FeatureTest(2)}, {{0}}, {TestSample({0}, 10.0)}, {});
+   CHECK(Error_ObjectiveUnknown == SetValidationMetric(testRegression.GetBoosterHandle(), "something"));
+   CHECK(Error_ObjectiveUnknown == SetValidationMetric(testRegression.GetBoosterHandle(), "  "));
+   CHECK(Error_ObjectiveParamMismatchWithConfig == SetValidationMetric(testRegression.GetBoosterHandle(), "auc"));
+   CHECK(Error_ObjectiveParamValOutOfRange ==
+         SetValidationMetric(testRegression.GetBoosterHandle(), "pinball:alpha=1.5"));
+   CHECK(Error_ObjectiveParamUnknown == SetValidationMetric(testRegression.GetBoosterHandle(), "mae:alpha=0.5"));
+   // nullptr goes back to the objective's metric
+   CHECK(Error_None == SetValidationMetric(testRegression.GetBoosterHandle(), nullptr));
+
+   TestBoost testBinary =
+         TestBoost(Task_BinaryClassification, {FeatureTest(2)}, {{0}}, {TestSample({0}, 0)}, {TestSample({0}, 1)});
+   CHECK(Error_ObjectiveParamMismatchWithConfig == SetValidationMetric(testBinary.GetBoosterHandle(), "rmse"));
+
+   TestBoost testMulticlass = TestBoost(3, {FeatureTest(2)}, {{0}}, {TestSample({0}, 0)}, {TestSample({0}, 2)});
+   CHECK(Error_ObjectiveParamMismatchWithConfig == SetValidationMetric(testMulticlass.GetBoosterHandle(), "auc"));
+   CHECK(Error_ObjectiveParamMismatchWithConfig == SetValidationMetric(testMulticlass.GetBoosterHandle(), "log_loss"));
+}
+
+TEST_CASE("multiclass with more classes than the compiled score counts") {
+   static constexpr size_t cClasses = 12;
+   static constexpr size_t cShift = 5;
+
+   const auto boost = [&](const size_t iShift) {
+      std::vector<TestSample> samples;
+      for(size_t iSample = 0; iSample < 96; ++iSample) {
+         // each bin favors a different group of classes so that the updates differ between the classes
+         const size_t iBin = iSample % 3;
+         const size_t iClass = (iBin * 4 + iSample * 7 % 5 + iShift) % cClasses;
+         samples.push_back(TestSample({static_cast<IntEbm>(iBin)}, static_cast<double>(iClass)));
+      }
+
+      TestBoost test = TestBoost(static_cast<TaskEbm>(cClasses),
+            {FeatureTest(3)},
+            {{0}},
+            samples,
+            samples,
+            k_countInnerBagsDefault,
+            k_testCreateBoosterFlags_Default | CreateBoosterFlags_DisableApprox);
+
+      double validationMetric = test.Boost(0).validationMetric;
+      for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+         const double nextMetric = test.Boost(0).validationMetric;
+         CHECK(nextMetric < validationMetric);
+         validationMetric = nextMetric;
+      }
+
+      // recompute the log loss from the term scores, which checks the exp that was selected for each target
+      double metricSum = 0.0;
+      for(const TestSample& sample : samples) {
+         const size_t iBin = static_cast<size_t>(sample.m_sampleBinIndexes[0]);
+         double sumExp = 0.0;
+         for(size_t iScore = 0; iScore < cClasses; ++iScore) {
+            sumExp += std::exp(test.GetCurrentTermScore(0, {iBin}, iScore));
+         }
+         const double targetScore = test.GetCurrentTermScore(0, {iBin}, static_cast<size_t>(sample.m_target));
+         metricSum += std::log(sumExp) - targetScore;
+      }
+      CHECK_APPROX(validationMetric, metricSum / static_cast<double>(samples.size()));
+
+      std::vector<double> ret{validationMetric};
+      for(size_t iBin = 0; iBin < 3; ++iBin) {
+         for(size_t iScore = 0; iScore < cClasses; ++iScore) {
+            ret.push_back(test.GetCurrentTermScore(0, {iBin}, (iScore + iShift) % cClasses));
+         }
+      }
+      return ret;
+   };
+
+   // relabeling the classes should relabel the scores and leave the metric unchanged
+   const std::vector<double> expected = boost(0);
+   const std::vector<double> shifted = boost(cShift);
+   CHECK(expected.size() == shifted.size());
+   for(size_t i = 0; i < expected.size(); ++i) {
+      CHECK_APPROX(expected[i], shifted[i]);
+   }
+}
+
+TEST_CASE("multiclass, the AVX-512 zone matches the cpu zone") {
+   // The AVX-512 zone has 16 lanes, so during training it subtracts 1 from the target gradient by selecting in
+   // registers while the cpu zone uses an indexed store.  Without DisableApprox 3 and 8 classes use the compile time
+   // number of classes and 12 classes uses the runtime number.  When the AVX-512 zone is unavailable, either because
+   // the machine lacks AVX-512F or the library was built without SIMD zones, both boosters use the cpu zone.
+   for(const CreateBoosterFlags flags : {k_testCreateBoosterFlags_Default,
+             static_cast<CreateBoosterFlags>(k_testCreateBoosterFlags_Default | CreateBoosterFlags_DisableApprox)}) {
+      // the AVX-512 zone computes in float32, and the approximate exp differs between the zones
+      const double tolerance = 0 != (CreateBoosterFlags_DisableApprox & flags) ? double{1e-3} : double{1e-2};
+      for(const size_t cClasses : {size_t{3}, size_t{8}, size_t{12}}) {
+         std::vector<TestSample> samples;
+         for(size_t iSample = 0; iSample < 96; ++iSample) {
+            const size_t iBin = iSample % 3;
+            const size_t iClass = (iBin * 4 + iSample * 7 % 5) % cClasses;
+            samples.push_back(TestSample({static_cast<IntEbm>(iBin)}, static_cast<double>(iClass)));
+         }
+
+         TestBoost testCpu = TestBoost(static_cast<TaskEbm>(cClasses),
+               {FeatureTest(3)},
+               {{0}},
+               samples,
+               samples,
+               k_countInnerBagsDefault,
+               flags,
+               AccelerationFlags_NONE);
+
+         TestBoost testAvx512 = TestBoost(static_cast<TaskEbm>(cClasses),
+               {FeatureTest(3)},
+               {{0}},
+               samples,
+               samples,
+               k_countInnerBagsDefault,
+               flags,
+               AccelerationFlags_AVX512F);
+
+         for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+            const double metricCpu = testCpu.Boost(0).validationMetric;
+            const double metricAvx512 = testAvx512.Boost(0).validationMetric;
+            CHECK_APPROX_TOLERANCE(metricAvx512, metricCpu, tolerance);
+         }
+         for(size_t iBin = 0; iBin < 3; ++iBin) {
+            for(size_t iScore = 0; iScore < cClasses; ++iScore) {
+               CHECK_APPROX_TOLERANCE(testAvx512.GetCurrentTermScore(0, {iBin}, iScore),
+                     testCpu.GetCurrentTermScore(0, {iBin}, iScore),
+                     tolerance);
+            }
+         }
+      }
+   }
+}
+
+static std::vector<unsigned char> MakeBudgetDataSet(const size_t cSamples, const bool bWeights) {
+   std::vector<IntEbm> binIndexes;
+   std::vector<double> targets;
+   std::vector<double> weights;
+   for(size_t iSample = 0; iSample < cSamples; ++iSample) {
+      binIndexes.push_back(static_cast<IntEbm>(iSample % 3));
+      targets.push_back(static_cast<double>(iSample % 7) - 3.0);
+      weights.push_back(static_cast<double>(iSample % 2) + 1.0);
+   }
+   const IntEbm cSamplesEbm = static_cast<IntEbm>(cSamples);
+   const IntEbm cWeights = bWeights ? 1 : 0;
+
+   IntEbm size = MeasureDataSetHeader(1, cWeights, 1);
+   size += MeasureFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, cSamplesEbm, &binIndexes[0]);
+   if(bWeights) {
+      size += MeasureWeight(cSamplesEbm, &weights[0]);
+   }
+   size += MeasureRegressionTarget(cSamplesEbm, &targets[0]);
+   std::vector<unsigned char> dataset(static_cast<size_t>(size));
+
+   ErrorEbm error = FillDataSetHeader(1, cWeights, 1, size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillDataSetHeader");
+   }
+   error = FillFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, cSamplesEbm, &binIndexes[0], size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillFeature");
+   }
+   if(bWeights) {
+      error = FillWeight(cSamplesEbm, &weights[0], size, &dataset[0]);
+      if(Error_None != error) {
+         throw TestException(error, "FillWeight");
+      }
+   }
+   error = FillRegressionTarget(cSamplesEbm, &targets[0], size, &dataset[0]);
+   if(Error_None != error) {
+      throw TestException(error, "FillRegressionTarget");
+   }
+   return dataset;
+}
+
+static IntEbm MeasureBudgetBooster(const std::vector<unsigned char>& dataset,
+      const IntEbm countInnerBags,
+      const CreateBoosterFlags flags,
+      const IntEbm maxBytes) {
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {0};
+   return MeasureBooster(&dataset[0],
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         countInnerBags,
+         flags,
+         k_testAccelerationFlags_Default,
+         "rmse",
+         nullptr,
+         maxBytes);
+}
+
+static ErrorEbm BoostBudgetBooster(TestCaseHidden& testCaseHidden,
+      const std::vector<unsigned char>& dataset,
+      const IntEbm countInnerBags,
+      const CreateBoosterFlags flags,
+      const IntEbm maxBytes,
+      std::vector<double>& termScores) {
+   std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seed, &rng[0]);
+
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {0};
+   BoosterHandle boosterHandle = nullptr;
+   ErrorEbm error = CreateBooster(&rng[0],
+         &dataset[0],
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         countInnerBags,
+         flags,
+         k_testAccelerationFlags_Default,
+         "rmse",
+         nullptr,
+         maxBytes,
+         &boosterHandle);
+   if(Error_None != error) {
+      CHECK(nullptr == boosterHandle);
+      return error;
+   }
+   for(size_t iRound = 0; iRound < 5; ++iRound) {
+      error = GenerateTermUpdate(&rng[0],
+            boosterHandle,
+            0,
+            TermBoostFlags_Default,
+            k_learningRateDefault,
+            k_minSamplesLeafDefault,
+            k_minHessianDefault,
+            k_regAlphaDefault,
+            k_regLambdaDefault,
+            k_maxDeltaStepDefault,
+            &k_leavesMaxDefault[0],
+            nullptr,
+            nullptr);
+      CHECK(Error_None == error);
+      error = ApplyTermUpdate(boosterHandle, nullptr);
+      CHECK(Error_None == error);
+   }
+   termScores.resize(3);
+   error = GetCurrentTermScores(boosterHandle, 0, &termScores[0]);
+   CHECK(Error_None == error);
+   FreeBooster(boosterHandle);
+   return Error_None;
+}
+
+TEST_CASE("memory budget, MeasureBooster grows with the samples and the inner bags") {
+   const std::vector<unsigned char> small = MakeBudgetDataSet(1000, false);
+   const std::vector<unsigned char> large = MakeBudgetDataSet(2000, false);
+
+   const IntEbm cBytesSmall = MeasureBudgetBooster(small, 0, k_testCreateBoosterFlags_Default, 0);
+   CHECK(0 < cBytesSmall);
+   CHECK(cBytesSmall < MeasureBudgetBooster(large, 0, k_testCreateBoosterFlags_Default, 0));
+
+   const IntEbm cBytesBags = MeasureBudgetBooster(small, 10, k_testCreateBoosterFlags_Default, 0);
+   CHECK(cBytesSmall < cBytesBags);
+
+   // Poisson bags keep one weight per sample instead of one per sample per bag
+   const IntEbm cBytesPoisson =
+         MeasureBudgetBooster(small, 10, k_testCreateBoosterFlags_Default | CreateBoosterFlags_PoissonBags, 0);
+   CHECK(0 < cBytesPoisson);
+   CHECK(cBytesPoisson < cBytesBags);
+
+   CHECK(Error_IllegalParamVal == MeasureBudgetBooster(small, 0, k_testCreateBoosterFlags_Default, -1));
+}
+
+TEST_CASE("memory budget, a budget below the stored bags switches to Poisson bags") {
+   const std::vector<unsigned char> dataset = MakeBudgetDataSet(1000, false);
+   const CreateBoosterFlags poisson = k_testCreateBoosterFlags_Default | CreateBoosterFlags_PoissonBags;
+
+   const IntEbm cBytesBags = MeasureBudgetBooster(dataset, 10, k_testCreateBoosterFlags_Default, 0);
+   const IntEbm cBytesPoisson = MeasureBudgetBooster(dataset, 10, poisson, 0);
+   CHECK(cBytesPoisson < cBytesBags);
+
+   // a budget that fits the stored bags leaves them alone
+   CHECK(cBytesBags == MeasureBudgetBooster(dataset, 10, k_testCreateBoosterFlags_Default, cBytesBags));
+   CHECK(cBytesPoisson == MeasureBudgetBooster(dataset, 10, k_testCreateBoosterFlags_Default, cBytesPoisson));
+
+   std::vector<double> expected;
+   ErrorEbm error = BoostBudgetBooster(testCaseHidden, dataset, 10, poisson, 0, expected);
+   CHECK(Error_None == error);
+   std::vector<double> budgeted;
+   error = BoostBudgetBooster(
+         testCaseHidden, dataset, 10, k_testCreateBoosterFlags_Default, cBytesPoisson, budgeted);
+   CHECK(Error_None == error);
+   CHECK(expected == budgeted);
+}
+
+TEST_CASE("memory budget, a budget that nothing fits in is out of memory") {
+   const std::vector<unsigned char> dataset = MakeBudgetDataSet(1000, false);
+   const IntEbm cBytesPoisson =
+         MeasureBudgetBooster(dataset, 10, k_testCreateBoosterFlags_Default | CreateBoosterFlags_PoissonBags, 0);
+
+   // MeasureBooster still reports what the smallest plan needs so that the caller can raise the budget
+   CHECK(cBytesPoisson ==
+         MeasureBudgetBooster(dataset, 10, k_testCreateBoosterFlags_Default, cBytesPoisson - IntEbm{1}));
+
+   std::vector<double> termScores;
+   const ErrorEbm error = BoostBudgetBooster(
+         testCaseHidden, dataset, 10, k_testCreateBoosterFlags_Default, cBytesPoisson - IntEbm{1}, termScores);
+   CHECK(Error_OutOfMemory == error);
+}
+
+#if defined(__GLIBC__) && (2 < __GLIBC__ || 33 <= __GLIBC_MINOR__)
+static size_t GetHeapBytesInUse() {
+   // mallinfo2 sums every arena, so the allocations of the thread pool are included
+   const struct mallinfo2 info = mallinfo2();
+   return info.uordblks + info.hblkhd;
+}
+
+static void CheckBudgetPrediction(TestCaseHidden& testCaseHidden,
+      const size_t cSamples,
+      const bool bWeights,
+      const IntEbm countInnerBags,
+      const CreateBoosterFlags flags) {
+   const std::vector<unsigned char> dataset = MakeBudgetDataSet(cSamples, bWeights);
+   const IntEbm cBytesPredicted = MeasureBudgetBooster(dataset, countInnerBags, flags, 0);
+   CHECK(0 < cBytesPredicted);
+
+   std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seed, &rng[0]);
+
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {0};
+   const size_t cBytesBefore = GetHeapBytesInUse();
+   BoosterHandle boosterHandle = nullptr;
+   const ErrorEbm error = CreateBooster(&rng[0],
+         &dataset[0],
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         countInnerBags,
+         flags,
+         k_testAccelerationFlags_Default,
+         "rmse",
+         nullptr,
+         0,
+         &boosterHandle);
+   const size_t cBytesAfter = GetHeapBytesInUse();
+   CHECK(Error_None == error);
+   FreeBooster(boosterHandle);
+
+   CHECK(cBytesBefore < cBytesAfter);
+   const double actual = static_cast<double>(cBytesAfter - cBytesBefore);
+   const double predicted = static_cast<double>(cBytesPredicted);
+
+   // the heap only shows what the booster holds once CreateBooster returns.  The prediction also counts the one byte
+   // per sample that InitBags holds while it draws the bags, and it leaves out the few small fixed allocations
+   const double transient = size_t{0} == countInnerBags ? 0.0 : static_cast<double>(cSamples);
+   static constexpr double k_bytesFixed = 16384.0;
+   CHECK(actual - k_bytesFixed <= predicted);
+   CHECK(predicted <= actual + transient + k_bytesFixed);
+}
+
+TEST_CASE("memory budget, MeasureBooster predicts what CreateBooster allocates") {
+   // the first booster creates the thread pool, which later boosters reuse
+   std::vector<double> termScores;
+   const ErrorEbm error = BoostBudgetBooster(
+         testCaseHidden, MakeBudgetDataSet(1000, false), 0, k_testCreateBoosterFlags_Default, 0, termScores);
+   CHECK(Error_None == error);
+
+   static constexpr size_t k_cSamples = 200000;
+   const CreateBoosterFlags poisson = k_testCreateBoosterFlags_Default | CreateBoosterFlags_PoissonBags;
+   CheckBudgetPrediction(testCaseHidden, k_cSamples, false, 0, k_testCreateBoosterFlags_Default);
+   CheckBudgetPrediction(testCaseHidden, k_cSamples, false, 10, k_testCreateBoosterFlags_Default);
+   CheckBudgetPrediction(testCaseHidden, k_cSamples, false, 10, poisson);
+   CheckBudgetPrediction(testCaseHidden, k_cSamples, true, 0, k_testCreateBoosterFlags_Default);
+   CheckBudgetPrediction(testCaseHidden, k_cSamples, true, 10, k_testCreateBoosterFlags_Default);
+   CheckBudgetPrediction(testCaseHidden, k_cSamples, true, 10, poisson);
+}
+#endif // __GLIBC__
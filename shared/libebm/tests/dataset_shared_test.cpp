@@ -566,3 +566,393 @@ TEST_CASE("dataset_shared, two features, 3 samples, weights, classification") {
 
    CHECK(99 == buffer[static_cast<size_t>(sum)]);
 }
+
+TEST_CASE("dataset_shared, builder chunks match one shot fill, weights, classification") {
+   ErrorEbm error;
+   static constexpr size_t k_cSamples = 257;
+
+   // feature 0 uses every bin, feature 1 has no missing, feature 2 has no unknown, feature 3 has only unknowns
+   const IntEbm binCounts[]{5, 9, 300, 4};
+   const BoolEbm nominals[]{EBM_FALSE, EBM_TRUE, EBM_FALSE, EBM_TRUE};
+   static constexpr size_t k_cFeatures = sizeof(binCounts) / sizeof(binCounts[0]);
+   const IntEbm classCounts[]{3};
+
+   std::vector<IntEbm> binIndexes[k_cFeatures];
+   std::vector<double> weights;
+   std::vector<IntEbm> targets;
+   for(size_t iSample = 0; iSample < k_cSamples; ++iSample) {
+      const IntEbm i = static_cast<IntEbm>(iSample);
+      binIndexes[0].push_back(i * 7 % 5);
+      binIndexes[1].push_back(1 + i * 5 % 8);
+      binIndexes[2].push_back(i * 31 % 299);
+      binIndexes[3].push_back(3);
+      weights.push_back(0.5 + static_cast<double>(iSample % 11));
+      targets.push_back(i % 3);
+   }
+
+   IntEbm sum = MeasureDataSetHeader(k_cFeatures, 1, 1);
+   sum += MeasureFeature(binCounts[0], EBM_TRUE, EBM_TRUE, nominals[0], k_cSamples, &binIndexes[0][0]);
+   sum += MeasureFeature(binCounts[1], EBM_FALSE, EBM_TRUE, nominals[1], k_cSamples, &binIndexes[1][0]);
+   sum += MeasureFeature(binCounts[2], EBM_TRUE, EBM_FALSE, nominals[2], k_cSamples, &binIndexes[2][0]);
+   sum += MeasureFeature(binCounts[3], EBM_FALSE, EBM_TRUE, nominals[3], k_cSamples, &binIndexes[3][0]);
+   sum += MeasureWeight(k_cSamples, &weights[0]);
+   sum += MeasureClassificationTarget(classCounts[0], k_cSamples, &targets[0]);
+
+   std::vector<char> expected(static_cast<size_t>(sum));
+   error = FillDataSetHeader(k_cFeatures, 1, 1, sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(
+         binCounts[0], EBM_TRUE, EBM_TRUE, nominals[0], k_cSamples, &binIndexes[0][0], sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(
+         binCounts[1], EBM_FALSE, EBM_TRUE, nominals[1], k_cSamples, &binIndexes[1][0], sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(
+         binCounts[2], EBM_TRUE, EBM_FALSE, nominals[2], k_cSamples, &binIndexes[2][0], sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(
+         binCounts[3], EBM_FALSE, EBM_TRUE, nominals[3], k_cSamples, &binIndexes[3][0], sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillWeight(k_cSamples, &weights[0], sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillClassificationTarget(classCounts[0], k_cSamples, &targets[0], sum, &expected[0]);
+   CHECK(Error_None == error);
+
+   DataSetBuilderHandle hBuilder;
+   error = CreateDataSetBuilder(k_cFeatures, binCounts, nominals, 1, 1, classCounts, 10, &hBuilder);
+   CHECK(Error_None == error);
+
+   // append row blocks of awkward sizes so that the chunks start and stop in the middle of the bit packs
+   size_t iSample = 0;
+   size_t cChunk = 1;
+   while(iSample < k_cSamples) {
+      const size_t cSamplesChunk = std::min(cChunk, k_cSamples - iSample);
+      for(size_t iFeature = 0; iFeature < k_cFeatures; ++iFeature) {
+         error = AppendFeatureBins(
+               hBuilder, static_cast<IntEbm>(iFeature), cSamplesChunk, &binIndexes[iFeature][iSample]);
+         CHECK(Error_None == error);
+      }
+      error = AppendWeights(hBuilder, 0, cSamplesChunk, &weights[iSample]);
+      CHECK(Error_None == error);
+      error = AppendClassificationTargets(hBuilder, 0, cSamplesChunk, &targets[iSample]);
+      CHECK(Error_None == error);
+      iSample += cSamplesChunk;
+      cChunk = cChunk * 3 + 1;
+   }
+
+   const IntEbm sumBuilder = MeasureDataSetBuilder(hBuilder);
+   CHECK(sum == sumBuilder);
+
+   std::vector<char> buffer(static_cast<size_t>(sum) + 1, 77);
+   buffer[static_cast<size_t>(sum)] = 99;
+   error = FillDataSetBuilder(hBuilder, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   CHECK(99 == buffer[static_cast<size_t>(sum)]);
+   CHECK(0 == memcmp(&expected[0], &buffer[0], static_cast<size_t>(sum)));
+
+   FreeDataSetBuilder(hBuilder);
+}
+
+TEST_CASE("dataset_shared, builder per feature, regression") {
+   ErrorEbm error;
+
+   const IntEbm binCounts[]{3};
+   const BoolEbm nominals[]{EBM_FALSE};
+   const IntEbm classCounts[]{Task_Regression};
+   const IntEbm binIndexes[]{1, 2, 1, 0};
+   const double targets[]{0.5, -1.5, 2.5, 3.0};
+
+   DataSetBuilderHandle hBuilder;
+   error = CreateDataSetBuilder(1, binCounts, nominals, 0, 1, classCounts, 0, &hBuilder);
+   CHECK(Error_None == error);
+
+   error = AppendFeatureBins(hBuilder, 0, 4, binIndexes);
+   CHECK(Error_None == error);
+   error = AppendRegressionTargets(hBuilder, 0, 3, targets);
+   CHECK(Error_None == error);
+
+   // the target column is one sample short
+   CHECK(MeasureDataSetBuilder(hBuilder) < 0);
+
+   error = AppendRegressionTargets(hBuilder, 0, 1, &targets[3]);
+   CHECK(Error_None == error);
+
+   const IntEbm sum = MeasureDataSetBuilder(hBuilder);
+   CHECK(0 < sum);
+   std::vector<char> buffer(static_cast<size_t>(sum));
+   error = FillDataSetBuilder(hBuilder, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = CheckDataSet(sum, &buffer[0]);
+   CHECK(Error_None == error);
+
+   IntEbm binCountsOut[1];
+   error = ExtractBinCounts(&buffer[0], 1, binCountsOut);
+   CHECK(Error_None == error);
+   CHECK(3 == binCountsOut[0]);
+
+   FreeDataSetBuilder(hBuilder);
+}
+
+TEST_CASE("dataset_shared, builder rejects bad chunks") {
+   ErrorEbm error;
+
+   const IntEbm binCounts[]{4};
+   const BoolEbm nominals[]{EBM_TRUE};
+   const IntEbm classCounts[]{2};
+   const IntEbm goodBins[]{1, 2, 3};
+   const IntEbm badBins[]{3, 4};
+   const IntEbm targets[]{0, 1, 1};
+
+   DataSetBuilderHandle hBuilder;
+   error = CreateDataSetBuilder(1, binCounts, nominals, 0, 1, classCounts, 0, &hBuilder);
+   CHECK(Error_None == error);
+
+   error = AppendFeatureBins(hBuilder, 0, 1, goodBins);
+   CHECK(Error_None == error);
+   error = AppendFeatureBins(hBuilder, 0, 2, badBins);
+   CHECK(Error_IllegalParamVal == error);
+   error = AppendFeatureBins(hBuilder, 1, 1, goodBins);
+   CHECK(Error_IllegalParamVal == error);
+   error = AppendRegressionTargets(hBuilder, 0, 0, nullptr);
+   CHECK(Error_IllegalParamVal == error);
+
+   // a rejected chunk leaves the builder as it was
+   error = AppendFeatureBins(hBuilder, 0, 2, &goodBins[1]);
+   CHECK(Error_None == error);
+   error = AppendClassificationTargets(hBuilder, 0, 3, targets);
+   CHECK(Error_None == error);
+
+   const IntEbm sum = MeasureDataSetBuilder(hBuilder);
+   CHECK(0 < sum);
+   std::vector<char> buffer(static_cast<size_t>(sum));
+   error = FillDataSetBuilder(hBuilder, sum, &buffer[0]);
+   CHECK(Error_None == error);
+
+   IntEbm expectedSum = MeasureDataSetHeader(1, 0, 1);
+   expectedSum += MeasureFeature(4, EBM_FALSE, EBM_TRUE, EBM_TRUE, 3, goodBins);
+   expectedSum += MeasureClassificationTarget(2, 3, targets);
+   CHECK(expectedSum == sum);
+   std::vector<char> expected(static_cast<size_t>(sum));
+   error = FillDataSetHeader(1, 0, 1, sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(4, EBM_FALSE, EBM_TRUE, EBM_TRUE, 3, goodBins, sum, &expected[0]);
+   CHECK(Error_None == error);
+   error = FillClassificationTarget(2, 3, targets, sum, &expected[0]);
+   CHECK(Error_None == error);
+   CHECK(0 == memcmp(&expected[0], &buffer[0], static_cast<size_t>(sum)));
+
+   FreeDataSetBuilder(hBuilder);
+}
+
+TEST_CASE("dataset_shared, dataset file header") {
+   ErrorEbm error;
+   static constexpr IntEbm k_cSamples = 3;
+   const IntEbm binIndexes[k_cSamples]{2, 1, 0};
+   const double targets[k_cSamples]{0.3, 0.2, 0.1};
+
+   const IntEbm sum = MeasureDataSetHeader(1, 0, 1) +
+         MeasureFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, binIndexes) +
+         MeasureRegressionTarget(k_cSamples, targets);
+   std::vector<char> dataset(static_cast<size_t>(sum));
+   error = FillDataSetHeader(1, 0, 1, sum, &dataset[0]);
+   CHECK(Error_None == error);
+   error = FillFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, binIndexes, sum, &dataset[0]);
+   CHECK(Error_None == error);
+   error = FillRegressionTarget(k_cSamples, targets, sum, &dataset[0]);
+   CHECK(Error_None == error);
+
+   const IntEbm cBytesHeader = MeasureDataSetFileHeader();
+   CHECK(0 == cBytesHeader % 64);
+
+   // simulate a memory mapped file, which is page aligned
+   const size_t cBytesFile = static_cast<size_t>(cBytesHeader + sum);
+   std::vector<double> file(cBytesFile / sizeof(double) + 1);
+   char* const pFile = reinterpret_cast<char*>(&file[0]);
+   error = FillDataSetFileHeader(sum, &dataset[0], cBytesHeader, pFile);
+   CHECK(Error_None == error);
+   memcpy(pFile + cBytesHeader, &dataset[0], static_cast<size_t>(sum));
+
+   IntEbm offsetDataSet = -1;
+   error = CheckDataSetFile(static_cast<IntEbm>(cBytesFile), pFile, EBM_FALSE, &offsetDataSet);
+   CHECK(Error_None == error);
+   CHECK(cBytesHeader == offsetDataSet);
+   error = CheckDataSetFile(static_cast<IntEbm>(cBytesFile), pFile, EBM_TRUE, &offsetDataSet);
+   CHECK(Error_None == error);
+
+   IntEbm countSamples;
+   IntEbm countFeatures;
+   IntEbm countWeights;
+   IntEbm countTargets;
+   error = ExtractDataSetHeader(pFile + offsetDataSet, &countSamples, &countFeatures, &countWeights, &countTargets);
+   CHECK(Error_None == error);
+   CHECK(k_cSamples == countSamples);
+   CHECK(1 == countFeatures);
+
+   // truncated files are always rejected
+   error = CheckDataSetFile(static_cast<IntEbm>(cBytesFile - sizeof(double)), pFile, EBM_FALSE, &offsetDataSet);
+   CHECK(Error_IllegalParamVal == error);
+
+   // a flipped bit in the data is only found by the checksum
+   pFile[cBytesFile - 1] ^= 0x10;
+   error = CheckDataSetFile(static_cast<IntEbm>(cBytesFile), pFile, EBM_FALSE, &offsetDataSet);
+   CHECK(Error_None == error);
+   error = CheckDataSetFile(static_cast<IntEbm>(cBytesFile), pFile, EBM_TRUE, &offsetDataSet);
+   CHECK(Error_IllegalParamVal == error);
+
+   // an unfinished dataset cannot be written to a file
+   std::vector<char> unfinished(static_cast<size_t>(sum));
+   error = FillDataSetHeader(1, 0, 1, sum, &unfinished[0]);
+   CHECK(Error_None == error);
+   error = FillDataSetFileHeader(sum, &unfinished[0], cBytesHeader, pFile);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+static std::vector<double> MakeCheckedDataSetFile(
+      const IntEbm countBinsUnused, const IntEbm binUnused, size_t* const pcBytesFileOut) {
+   static constexpr IntEbm k_cSamples = 4;
+   const IntEbm binIndexes[k_cSamples]{2, 1, 0, 1};
+   const IntEbm binIndexesUnused[k_cSamples]{binUnused, binUnused, binUnused, binUnused};
+   const double targets[k_cSamples]{0.3, 0.2, 0.1, 0.4};
+
+   const IntEbm sum = MeasureDataSetHeader(2, 0, 1) +
+         MeasureFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, binIndexes) +
+         MeasureFeature(countBinsUnused, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, binIndexesUnused) +
+         MeasureRegressionTarget(k_cSamples, targets);
+   const IntEbm cBytesHeader = MeasureDataSetFileHeader();
+   *pcBytesFileOut = static_cast<size_t>(cBytesHeader + sum);
+
+   // simulate a memory mapped file, which is page aligned
+   std::vector<double> file(*pcBytesFileOut / sizeof(double) + 1);
+   char* const pFile = reinterpret_cast<char*>(&file[0]);
+   char* const pDataSet = pFile + cBytesHeader;
+
+   ErrorEbm error = FillDataSetHeader(2, 0, 1, sum, pDataSet);
+   if(Error_None != error) {
+      throw TestException(error, "FillDataSetHeader");
+   }
+   error = FillFeature(3, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, binIndexes, sum, pDataSet);
+   if(Error_None != error) {
+      throw TestException(error, "FillFeature");
+   }
+   error =
+         FillFeature(countBinsUnused, EBM_TRUE, EBM_TRUE, EBM_FALSE, k_cSamples, binIndexesUnused, sum, pDataSet);
+   if(Error_None != error) {
+      throw TestException(error, "FillFeature");
+   }
+   error = FillRegressionTarget(k_cSamples, targets, sum, pDataSet);
+   if(Error_None != error) {
+      throw TestException(error, "FillRegressionTarget");
+   }
+   error = FillDataSetFileHeader(sum, pDataSet, cBytesHeader, pFile);
+   if(Error_None != error) {
+      throw TestException(error, "FillDataSetFileHeader");
+   }
+   return file;
+}
+
+static ErrorEbm CreateBoosterOnFeature(
+      const void* const dataSet, const IntEbm indexFeature, const CreateBoosterFlags flags) {
+   std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seed, &rng[0]);
+
+   const IntEbm dimensionCounts[] = {1};
+   const IntEbm featureIndexes[] = {indexFeature};
+   BoosterHandle boosterHandle = nullptr;
+   const ErrorEbm error = CreateBooster(&rng[0],
+         dataSet,
+         nullptr,
+         nullptr,
+         1,
+         dimensionCounts,
+         featureIndexes,
+         0,
+         flags,
+         k_testAccelerationFlags_Default,
+         "rmse",
+         nullptr,
+         0,
+         &boosterHandle);
+   FreeBooster(boosterHandle);
+   return error;
+}
+
+static ErrorEbm CreateInteraction(const void* const dataSet, const CreateInteractionFlags flags) {
+   InteractionHandle interactionHandle = nullptr;
+   const ErrorEbm error = CreateInteractionDetector(dataSet,
+         nullptr,
+         nullptr,
+         flags,
+         k_testAccelerationFlags_Default,
+         "rmse",
+         nullptr,
+         &interactionHandle);
+   FreeInteractionDetector(interactionHandle);
+   return error;
+}
+
+TEST_CASE("dataset_shared, a checked dataset file is not scanned again") {
+   ErrorEbm error;
+   const IntEbm cBytesHeader = MeasureDataSetFileHeader();
+
+   // the two files differ only in the bin count of the second feature, which locates that count in the file
+   size_t cBytesFile;
+   const std::vector<double> fourBins = MakeCheckedDataSetFile(4, 2, &cBytesFile);
+   const std::vector<double> threeBins = MakeCheckedDataSetFile(3, 2, &cBytesFile);
+   const char* const pFourBins = reinterpret_cast<const char*>(&fourBins[0]);
+   const char* const pThreeBins = reinterpret_cast<const char*>(&threeBins[0]);
+   size_t iCountBins = 0;
+   size_t cDifferences = 0;
+   for(size_t i = static_cast<size_t>(cBytesHeader); i < cBytesFile; ++i) {
+      if(pFourBins[i] != pThreeBins[i]) {
+         iCountBins = i;
+         ++cDifferences;
+      }
+   }
+   CHECK(1 == cDifferences);
+
+   // write the file header while the second feature holds bin 3 of 4, then shrink that feature to 3 bins.  Only the
+   // full scan sees that bin 3 is now out of range
+   std::vector<double> file = MakeCheckedDataSetFile(4, 3, &cBytesFile);
+   char* const pFile = reinterpret_cast<char*>(&file[0]);
+   pFile[iCountBins] = pThreeBins[iCountBins];
+   const void* const pDataSet = pFile + cBytesHeader;
+
+   error = CheckDataSetFile(static_cast<IntEbm>(cBytesFile), pFile, EBM_FALSE, nullptr);
+   CHECK(Error_None == error);
+   error = CheckDataSet(static_cast<IntEbm>(cBytesFile) - cBytesHeader, pDataSet);
+   CHECK(Error_IllegalParamVal == error);
+
+   error = CreateBoosterOnFeature(pDataSet, 0, k_testCreateBoosterFlags_Default);
+   CHECK(Error_IllegalParamVal == error);
+   // the flag skips the scan, so a booster that never reads the second feature does not notice it
+   error = CreateBoosterOnFeature(pDataSet, 0, k_testCreateBoosterFlags_Default | CreateBoosterFlags_CheckedDataSet);
+   CHECK(Error_None == error);
+   // but the bins of the features that are used are checked as they are unpacked
+   error = CreateBoosterOnFeature(pDataSet, 1, k_testCreateBoosterFlags_Default | CreateBoosterFlags_CheckedDataSet);
+   CHECK(Error_IllegalParamVal == error);
+
+   // interaction detection reads every feature
+   error = CreateInteraction(pDataSet, k_testCreateInteractionFlags_Default);
+   CHECK(Error_IllegalParamVal == error);
+   error = CreateInteraction(pDataSet, k_testCreateInteractionFlags_Default | CreateInteractionFlags_CheckedDataSet);
+   CHECK(Error_IllegalParamVal == error);
+   error = CreateInteraction(
+         pFourBins + cBytesHeader, k_testCreateInteractionFlags_Default | CreateInteractionFlags_CheckedDataSet);
+   CHECK(Error_None == error);
+
+   // a bin count that needs a different bit packing breaks the offsets that follow, which the flag still checks
+   std::vector<double> resized = fourBins;
+   char* const pResized = reinterpret_cast<char*>(&resized[0]);
+   const size_t iCountBinsStart = iCountBins & ~(sizeof(UIntEbm) - size_t{1});
+   UIntEbm countBins;
+   memcpy(&countBins, pResized + iCountBinsStart, sizeof(countBins));
+   countBins += UIntEbm{1} << 40;
+   memcpy(pResized + iCountBinsStart, &countBins, sizeof(countBins));
+   error = CreateBoosterOnFeature(
+         pResized + cBytesHeader, 0, k_testCreateBoosterFlags_Default | CreateBoosterFlags_CheckedDataSet);
+   CHECK(Error_IllegalParamVal == error);
+
+   // the flag still rejects the file itself, which starts with the file header rather than the dataset
+   error = CreateBoosterOnFeature(pFile, 0, k_testCreateBoosterFlags_Default | CreateBoosterFlags_CheckedDataSet);
+   CHECK(Error_IllegalParamVal == error);
+}
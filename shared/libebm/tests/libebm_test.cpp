@@ -522,6 +522,7 @@ TestBoost::TestBoost(const TaskEbm cClasses,
          acceleration,
          nullptr == sObjective ? (Task_GeneralClassification <= cClasses ? "log_loss" : "rmse") : sObjective,
          nullptr,
+         0,
          &m_boosterHandle);
    if(Error_None != error) {
       throw TestException(error, "CreateBooster");
@@ -19,17 +19,21 @@
 
 enum class TestPriority {
    Purify,
+   HarmonizeTensor,
    DataSetShared,
+   ModelShared,
    BoostingUnusualInputs,
    InteractionUnusualInputs,
    Rehydration,
    BitPackingExtremes,
+   ThreadPool,
    RandomNumbers,
    SuggestGraphBounds,
    CutUniform,
    CutWinsorized,
    CutQuantile,
-   Discretize
+   Discretize,
+   FloatString
 };
 
 class TestException final : public std::exception {
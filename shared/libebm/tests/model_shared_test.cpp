@@ -0,0 +1,234 @@
+// Copyright (c) 2023 The InterpretML Contributors
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "pch_test.hpp"
+
+#include "libebm.h"
+#include "libebm_test.hpp"
+
+static constexpr TestPriority k_filePriority = TestPriority::ModelShared;
+
+TEST_CASE("model_shared, zero features, zero terms") {
+   ErrorEbm error;
+
+   const IntEbm sum = MeasureModelHeader(0, 0);
+   CHECK(0 < sum);
+
+   std::vector<double> buffer(static_cast<size_t>(sum) / sizeof(double) + 1, 77.0);
+   CHECK(0 == static_cast<size_t>(sum) % sizeof(double));
+
+   error = FillModelHeader(0, 0, 1, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   CHECK(77.0 == buffer[static_cast<size_t>(sum) / sizeof(double)]);
+
+   error = CheckModel(sum, &buffer[0]);
+   CHECK(Error_None == error);
+
+   IntEbm countFeatures = -1;
+   IntEbm countTerms = -1;
+   IntEbm countScores = -1;
+   error = ExtractModelHeader(&buffer[0], &countFeatures, &countTerms, &countScores);
+   CHECK(Error_None == error);
+   CHECK(0 == countFeatures);
+   CHECK(0 == countTerms);
+   CHECK(1 == countScores);
+}
+
+TEST_CASE("model_shared, continuous, nominal, intercept, pair") {
+   ErrorEbm error;
+
+   static constexpr IntEbm k_cScores = 1;
+
+   const double cuts[]{-1.5, 0.0, 2.25};
+   const IntEbm cCuts = static_cast<IntEbm>(sizeof(cuts) / sizeof(cuts[0]));
+
+   const IntEbm binIndexes[]{1, 2, 2};
+   const char strings[] = "a\0bb\0ccc"; // the implicit trailing null terminates the last category
+   const IntEbm cCategories = static_cast<IntEbm>(sizeof(binIndexes) / sizeof(binIndexes[0]));
+   const IntEbm cBytesStrings = static_cast<IntEbm>(sizeof(strings));
+
+   const double intercept[]{0.125};
+
+   const IntEbm featureIndexes[]{0, 1};
+   const IntEbm dimensionLengths[]{cCuts + 3, 4};
+   std::vector<double> scores(static_cast<size_t>(dimensionLengths[0] * dimensionLengths[1]));
+   std::vector<double> weights(scores.size());
+   for(size_t i = 0; i < scores.size(); ++i) {
+      scores[i] = static_cast<double>(i) * 0.5 - 3.0;
+      weights[i] = static_cast<double>(i) + 1.0;
+   }
+
+   IntEbm sum = 0;
+   IntEbm part;
+
+   part = MeasureModelHeader(2, 2);
+   CHECK(0 < part);
+   sum += part;
+   part = MeasureModelCuts(cCuts);
+   CHECK(0 < part);
+   sum += part;
+   part = MeasureModelCategories(cCategories, cBytesStrings);
+   CHECK(0 < part);
+   sum += part;
+   part = MeasureModelTerm(k_cScores, 0, nullptr, EBM_FALSE);
+   CHECK(0 < part);
+   sum += part;
+   part = MeasureModelTerm(k_cScores, 2, dimensionLengths, EBM_TRUE);
+   CHECK(0 < part);
+   sum += part;
+
+   CHECK(0 == static_cast<size_t>(sum) % 64);
+
+   std::vector<double> buffer(static_cast<size_t>(sum) / sizeof(double) + 1, 77.0);
+
+   error = FillModelHeader(2, 2, k_cScores, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelCuts(cCuts, cuts, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelCategories(cCategories, binIndexes, cBytesStrings, strings, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelTerm(k_cScores, 0, nullptr, nullptr, intercept, nullptr, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelTerm(k_cScores, 2, featureIndexes, dimensionLengths, &scores[0], &weights[0], sum, &buffer[0]);
+   CHECK(Error_None == error);
+
+   CHECK(77.0 == buffer[static_cast<size_t>(sum) / sizeof(double)]);
+
+   // simulate loading from a file by copying the bytes to a new location
+   std::vector<double> loaded(buffer.begin(), buffer.end() - 1);
+   const unsigned char* const pModel = reinterpret_cast<const unsigned char*>(&loaded[0]);
+
+   error = CheckModel(sum, pModel);
+   CHECK(Error_None == error);
+
+   IntEbm countFeatures;
+   IntEbm countTerms;
+   IntEbm countScores;
+   error = ExtractModelHeader(pModel, &countFeatures, &countTerms, &countScores);
+   CHECK(Error_None == error);
+   CHECK(2 == countFeatures);
+   CHECK(2 == countTerms);
+   CHECK(k_cScores == countScores);
+
+   BoolEbm isNominal;
+   IntEbm countItems;
+   IntEbm offsetItems;
+   IntEbm countBytesStrings;
+   IntEbm offsetStrings;
+
+   error = ExtractModelFeature(
+         pModel, 0, &isNominal, &countItems, &offsetItems, &countBytesStrings, &offsetStrings);
+   CHECK(Error_None == error);
+   CHECK(EBM_FALSE == isNominal);
+   CHECK(cCuts == countItems);
+   CHECK(0 == countBytesStrings);
+   CHECK(0 == offsetItems % 64);
+   const double* const pCuts = reinterpret_cast<const double*>(pModel + offsetItems);
+   CHECK(0 == memcmp(pCuts, cuts, sizeof(cuts)));
+
+   // the cuts can be used in place
+   const double vals[]{-2.0, 1.0, 3.0};
+   IntEbm bins[3];
+   error = Discretize(3, vals, countItems, pCuts, bins);
+   CHECK(Error_None == error);
+   CHECK(1 == bins[0]);
+   CHECK(3 == bins[1]);
+   CHECK(4 == bins[2]);
+
+   error = ExtractModelFeature(
+         pModel, 1, &isNominal, &countItems, &offsetItems, &countBytesStrings, &offsetStrings);
+   CHECK(Error_None == error);
+   CHECK(EBM_TRUE == isNominal);
+   CHECK(cCategories == countItems);
+   CHECK(cBytesStrings == countBytesStrings);
+   const IntEbm* const pBins = reinterpret_cast<const IntEbm*>(pModel + offsetItems);
+   CHECK(0 == memcmp(pBins, binIndexes, sizeof(binIndexes)));
+   CHECK(0 == memcmp(pModel + offsetStrings, strings, sizeof(strings)));
+
+   IntEbm countDimensions;
+   IntEbm countTensorBins;
+   IntEbm offsetFeatureIndexes;
+   IntEbm offsetDimensionLengths;
+   IntEbm offsetScores;
+   IntEbm offsetBinWeights;
+
+   error = ExtractModelTerm(pModel,
+         0,
+         &countDimensions,
+         &countTensorBins,
+         &offsetFeatureIndexes,
+         &offsetDimensionLengths,
+         &offsetScores,
+         &offsetBinWeights);
+   CHECK(Error_None == error);
+   CHECK(0 == countDimensions);
+   CHECK(1 == countTensorBins);
+   CHECK(0 == offsetBinWeights);
+   CHECK(intercept[0] == *reinterpret_cast<const double*>(pModel + offsetScores));
+
+   error = ExtractModelTerm(pModel,
+         1,
+         &countDimensions,
+         &countTensorBins,
+         &offsetFeatureIndexes,
+         &offsetDimensionLengths,
+         &offsetScores,
+         &offsetBinWeights);
+   CHECK(Error_None == error);
+   CHECK(2 == countDimensions);
+   CHECK(static_cast<IntEbm>(scores.size()) == countTensorBins);
+   CHECK(0 == memcmp(pModel + offsetFeatureIndexes, featureIndexes, sizeof(featureIndexes)));
+   CHECK(0 == memcmp(pModel + offsetDimensionLengths, dimensionLengths, sizeof(dimensionLengths)));
+   CHECK(0 == offsetScores % 64);
+   CHECK(0 == offsetBinWeights % 64);
+   CHECK(0 == memcmp(pModel + offsetScores, &scores[0], sizeof(scores[0]) * scores.size()));
+   CHECK(0 == memcmp(pModel + offsetBinWeights, &weights[0], sizeof(weights[0]) * weights.size()));
+
+   // a truncated file must be rejected
+   error = CheckModel(sum - 64, pModel);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("model_shared, unsorted cuts") {
+   const double cuts[]{1.0, 1.0};
+
+   const IntEbm sum = MeasureModelHeader(1, 0) + MeasureModelCuts(2);
+   std::vector<double> buffer(static_cast<size_t>(sum) / sizeof(double));
+
+   ErrorEbm error = FillModelHeader(1, 0, 1, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelCuts(2, cuts, sum, &buffer[0]);
+   CHECK(Error_IllegalParamVal == error);
+   error = CheckModel(sum, &buffer[0]);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("model_shared, category count mismatch") {
+   const IntEbm binIndexes[]{1, 2};
+   const char strings[] = "only_one";
+
+   const IntEbm sum = MeasureModelHeader(1, 0) + MeasureModelCategories(2, sizeof(strings));
+   std::vector<double> buffer(static_cast<size_t>(sum) / sizeof(double));
+
+   ErrorEbm error = FillModelHeader(1, 0, 1, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelCategories(2, binIndexes, sizeof(strings), strings, sum, &buffer[0]);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("model_shared, term feature index out of range") {
+   const IntEbm featureIndexes[]{1};
+   const IntEbm dimensionLengths[]{3};
+   const double scores[]{0.0, 1.0, 2.0};
+
+   const IntEbm sum = MeasureModelHeader(1, 1) + MeasureModelCuts(0) + MeasureModelTerm(1, 1, dimensionLengths, EBM_FALSE);
+   std::vector<double> buffer(static_cast<size_t>(sum) / sizeof(double));
+
+   ErrorEbm error = FillModelHeader(1, 1, 1, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelCuts(0, nullptr, sum, &buffer[0]);
+   CHECK(Error_None == error);
+   error = FillModelTerm(1, 1, featureIndexes, dimensionLengths, scores, nullptr, sum, &buffer[0]);
+   CHECK(Error_IllegalParamVal == error);
+}
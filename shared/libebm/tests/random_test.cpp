@@ -353,6 +353,94 @@ TEST_CASE("GenerateGaussianRandom") {
    }
 }
 
+TEST_CASE("GenerateCounterRandom, Philox4x32-10 known answer") {
+   // the zero key and zero counter vector from the Random123 distribution (kat_vectors)
+   UIntEbm result[4];
+   ErrorEbm error = GenerateCounterRandom(0, 0, 0, 4, result);
+   CHECK(Error_None == error);
+   CHECK(UIntEbm{0x6627e8d5} == result[0]);
+   CHECK(UIntEbm{0xe169c58d} == result[1]);
+   CHECK(UIntEbm{0xbc57ac4c} == result[2]);
+   CHECK(UIntEbm{0x9b00dbd8} == result[3]);
+
+   // starting part way into the block lands on the same numbers
+   error = GenerateCounterRandom(0, 0, 2, 2, result);
+   CHECK(Error_None == error);
+   CHECK(UIntEbm{0xbc57ac4c} == result[0]);
+   CHECK(UIntEbm{0x9b00dbd8} == result[1]);
+
+   // a different stream gives different numbers
+   error = GenerateCounterRandom(0, 1, 0, 1, result);
+   CHECK(Error_None == error);
+   CHECK(UIntEbm{0x6627e8d5} != result[0]);
+
+   error = GenerateCounterRandom(0, 0, 0, -1, result);
+   CHECK(Error_IllegalParamVal == error);
+}
+
+TEST_CASE("GenerateGaussianRandomParallel, same numbers for any thread pool or count") {
+   static constexpr size_t cItems = 10000;
+
+   ErrorEbm error;
+
+   std::vector<unsigned char> rng(static_cast<size_t>(MeasureRNG()));
+   InitRNG(k_seed, &rng[0]);
+   std::vector<unsigned char> rngStart(rng);
+
+   std::vector<double> expected(cItems);
+   error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+   error = GenerateGaussianRandomParallel(&rng[0], 10.0, static_cast<IntEbm>(cItems), &expected[0]);
+   CHECK(Error_None == error);
+
+   // rng advances the same as BranchRNG no matter how many items are generated
+   std::vector<unsigned char> rngExpected(rngStart);
+   std::vector<unsigned char> rngBranch(rngStart.size());
+   BranchRNG(&rngExpected[0], &rngBranch[0]);
+   CHECK(rngExpected == rng);
+
+   std::vector<double> result(cItems, 0.0);
+   rng = rngStart;
+   error = SetThreadPool(3, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+   error = GenerateGaussianRandomParallel(&rng[0], 10.0, static_cast<IntEbm>(cItems), &result[0]);
+   CHECK(Error_None == error);
+   CHECK(expected == result);
+
+   // item i comes from its own counter stream, so a shorter request is a prefix of a longer one
+   std::fill(result.begin(), result.end(), 0.0);
+   rng = rngStart;
+   error = GenerateGaussianRandomParallel(&rng[0], 10.0, 7, &result[0]);
+   CHECK(Error_None == error);
+   CHECK(std::equal(expected.begin(), expected.begin() + 7, result.begin()));
+
+   error = SetThreadPool(1, ThreadPoolFlags_Default, -1);
+   CHECK(Error_None == error);
+
+   size_t cNegative = 0;
+   double avg = 0;
+   double avgAbs = 0;
+   for(const double val : expected) {
+      if(val < 0) {
+         ++cNegative;
+      }
+      avg += val;
+      avgAbs += std::abs(val);
+   }
+   avg /= cItems;
+   avgAbs /= cItems;
+
+   // the mean absolute value of a gaussian is stddev * sqrt(2 / pi), or about 7.98
+   CHECK(std::abs(avg) <= 0.5);
+   CHECK(7.5 <= avgAbs && avgAbs <= 8.5);
+   CHECK(4500 <= cNegative && cNegative <= 5500);
+
+   error = GenerateGaussianRandomParallel(nullptr, 10.0, 5, &result[0]);
+   CHECK(Error_None == error);
+   error = GenerateGaussianRandomParallel(&rng[0], 10.0, -1, &result[0]);
+   CHECK(Error_IllegalParamVal == error);
+}
+
 TEST_CASE("Shuffle") {
    static constexpr int cIterations = 1000;
    static constexpr IntEbm cItems = 10;